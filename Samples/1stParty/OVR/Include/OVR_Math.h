@@ -121,6 +121,25 @@
 #define OVR_MATH_UNUSED(a) (a)
 #endif
 
+//-------------------------------------------------------------------------------------
+// ***** OVR_MATH_SSE2 / OVR_MATH_NEON
+//
+// Matrix4f multiplication and point transforms, and Quatf multiplication (so also Quatf and
+// Posef rotations and Posef composition) use SSE2 or NEON when the target has them. The
+// vector code adds the products in the same order as the scalar code, so it gives the same
+// results unless the compiler contracts the scalar code into fused multiply-adds.
+// Define OVR_MATH_DISABLE_SIMD to always use the scalar code.
+
+#if !defined(OVR_MATH_DISABLE_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define OVR_MATH_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define OVR_MATH_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
 namespace OVR {
 
 template <class T>
@@ -2505,6 +2524,57 @@ Vector3<T> operator*(const Vector3<T>& v, const Quat<T>& q) {
 }
 // MERGE_MOBILE_SDK
 
+#if defined(OVR_MATH_SSE2) || defined(OVR_MATH_NEON)
+// Each lane adds the terms in the order of Quat::operator*, a subtraction is the addition of
+// the product with the sign of b flipped.
+template <>
+inline Quat<float> Quat<float>::operator*(const Quat<float>& b) const {
+    Quat<float> result;
+#if defined(OVR_MATH_SSE2)
+    // from the members rather than a load, so temporaries like the one Rotate builds from a
+    // Vector3 stay in registers instead of stalling on store forwarding
+    const __m128 bv = _mm_setr_ps(b.x, b.y, b.z, b.w);
+    const __m128 b1 = _mm_xor_ps(
+        _mm_shuffle_ps(bv, bv, _MM_SHUFFLE(0, 1, 2, 3)), _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f));
+    const __m128 b2 = _mm_xor_ps(
+        _mm_shuffle_ps(bv, bv, _MM_SHUFFLE(1, 0, 3, 2)), _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f));
+    const __m128 b3 = _mm_xor_ps(
+        _mm_shuffle_ps(bv, bv, _MM_SHUFFLE(2, 3, 0, 1)), _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f));
+    __m128 r = _mm_mul_ps(_mm_set1_ps(w), bv);
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(x), b1));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(y), b2));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(z), b3));
+    _mm_storeu_ps(&result.x, r);
+#else
+    static const uint32_t signs1[4] = {0, 0x80000000u, 0, 0x80000000u};
+    static const uint32_t signs2[4] = {0, 0, 0x80000000u, 0x80000000u};
+    static const uint32_t signs3[4] = {0x80000000u, 0, 0, 0x80000000u};
+    const float32x4_t bv = vld1q_f32(&b.x);
+    const float32x4_t b3 = vrev64q_f32(bv); // y x w z
+    const float32x4_t b1 = vcombine_f32(vget_high_f32(b3), vget_low_f32(b3)); // w z y x
+    const float32x4_t b2 = vextq_f32(bv, bv, 2); // z w x y
+    float32x4_t r = vmulq_f32(vdupq_n_f32(w), bv);
+    r = vaddq_f32(
+        r,
+        vmulq_f32(
+            vdupq_n_f32(x),
+            vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(b1), vld1q_u32(signs1)))));
+    r = vaddq_f32(
+        r,
+        vmulq_f32(
+            vdupq_n_f32(y),
+            vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(b2), vld1q_u32(signs2)))));
+    r = vaddq_f32(
+        r,
+        vmulq_f32(
+            vdupq_n_f32(z),
+            vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(b3), vld1q_u32(signs3)))));
+    vst1q_f32(&result.x, r);
+#endif
+    return result;
+}
+#endif // defined(OVR_MATH_SSE2) || defined(OVR_MATH_NEON)
+
 typedef Quat<float> Quatf;
 typedef Quat<double> Quatd;
 
@@ -3066,6 +3136,13 @@ class Matrix4 {
             (M[2][0] * v.x + M[2][1] * v.y + M[2][2] * v.z + M[2][3]) * rcpW);
     }
 
+    // Transforms count points like Transform(), in and out may be the same array.
+    void TransformPoints(const Vector3<T>* in, Vector3<T>* out, const int count) const {
+        for (int i = 0; i < count; i++) {
+            out[i] = Transform(in[i]);
+        }
+    }
+
     Vector4<T> Transform(const Vector4<T>& v) const {
         return Vector4<T>(
             M[0][0] * v.x + M[0][1] * v.y + M[0][2] * v.z + M[0][3] * v.w,
@@ -3640,6 +3717,86 @@ const Matrix4<T> Matrix4<T>::IdentityValue;
 typedef Matrix4<float> Matrix4f;
 typedef Matrix4<double> Matrix4d;
 
+#if defined(OVR_MATH_SSE2) || defined(OVR_MATH_NEON)
+// Row i of d is the sum of the rows of b scaled by the elements of row i of a, added in the
+// order of the scalar Multiply.
+template <>
+inline Matrix4<float>&
+Matrix4<float>::Multiply(Matrix4<float>* d, const Matrix4<float>& a, const Matrix4<float>& b) {
+    OVR_MATH_ASSERT((d != &a) && (d != &b));
+#if defined(OVR_MATH_SSE2)
+    const __m128 b0 = _mm_loadu_ps(b.M[0]);
+    const __m128 b1 = _mm_loadu_ps(b.M[1]);
+    const __m128 b2 = _mm_loadu_ps(b.M[2]);
+    const __m128 b3 = _mm_loadu_ps(b.M[3]);
+    for (int i = 0; i < 4; i++) {
+        __m128 r = _mm_mul_ps(_mm_set1_ps(a.M[i][0]), b0);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a.M[i][1]), b1));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a.M[i][2]), b2));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a.M[i][3]), b3));
+        _mm_storeu_ps(d->M[i], r);
+    }
+#else
+    const float32x4_t b0 = vld1q_f32(b.M[0]);
+    const float32x4_t b1 = vld1q_f32(b.M[1]);
+    const float32x4_t b2 = vld1q_f32(b.M[2]);
+    const float32x4_t b3 = vld1q_f32(b.M[3]);
+    for (int i = 0; i < 4; i++) {
+        float32x4_t r = vmulq_f32(vdupq_n_f32(a.M[i][0]), b0);
+        r = vaddq_f32(r, vmulq_f32(vdupq_n_f32(a.M[i][1]), b1));
+        r = vaddq_f32(r, vmulq_f32(vdupq_n_f32(a.M[i][2]), b2));
+        r = vaddq_f32(r, vmulq_f32(vdupq_n_f32(a.M[i][3]), b3));
+        vst1q_f32(d->M[i], r);
+    }
+#endif
+    return *d;
+}
+
+// Transforms a point per iteration with the columns of the matrix, so the four rows are
+// evaluated at once and only the divide by w is scalar.
+template <>
+inline void Matrix4<float>::TransformPoints(
+    const Vector3<float>* in,
+    Vector3<float>* out,
+    const int count) const {
+#if defined(OVR_MATH_SSE2)
+    const __m128 c0 = _mm_setr_ps(M[0][0], M[1][0], M[2][0], M[3][0]);
+    const __m128 c1 = _mm_setr_ps(M[0][1], M[1][1], M[2][1], M[3][1]);
+    const __m128 c2 = _mm_setr_ps(M[0][2], M[1][2], M[2][2], M[3][2]);
+    const __m128 c3 = _mm_setr_ps(M[0][3], M[1][3], M[2][3], M[3][3]);
+#else
+    const float32x4x4_t columns = vld4q_f32(&M[0][0]);
+    const float32x4_t c0 = columns.val[0];
+    const float32x4_t c1 = columns.val[1];
+    const float32x4_t c2 = columns.val[2];
+    const float32x4_t c3 = columns.val[3];
+#endif
+    for (int i = 0; i < count; i++) {
+#if defined(OVR_MATH_SSE2)
+        __m128 v = _mm_mul_ps(c0, _mm_set1_ps(in[i].x));
+        v = _mm_add_ps(v, _mm_mul_ps(c1, _mm_set1_ps(in[i].y)));
+        v = _mm_add_ps(v, _mm_mul_ps(c2, _mm_set1_ps(in[i].z)));
+        v = _mm_add_ps(v, c3);
+        const float w = _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)));
+        OVR_MATH_ASSERT(fabs(w) >= Math<float>::SmallestNonDenormal());
+        v = _mm_mul_ps(v, _mm_set1_ps(1.0f / w));
+        _mm_storel_pi(reinterpret_cast<__m64*>(&out[i].x), v);
+        _mm_store_ss(&out[i].z, _mm_movehl_ps(v, v));
+#else
+        float32x4_t v = vmulq_f32(c0, vdupq_n_f32(in[i].x));
+        v = vaddq_f32(v, vmulq_f32(c1, vdupq_n_f32(in[i].y)));
+        v = vaddq_f32(v, vmulq_f32(c2, vdupq_n_f32(in[i].z)));
+        v = vaddq_f32(v, c3);
+        const float w = vgetq_lane_f32(v, 3);
+        OVR_MATH_ASSERT(fabs(w) >= Math<float>::SmallestNonDenormal());
+        v = vmulq_n_f32(v, 1.0f / w);
+        vst1_f32(&out[i].x, vget_low_f32(v));
+        vst1q_lane_f32(&out[i].z, v, 2);
+#endif
+    }
+}
+#endif // defined(OVR_MATH_SSE2) || defined(OVR_MATH_NEON)
+
 //-------------------------------------------------------------------------------------
 // ***** Matrix3
 //
@@ -147,7 +147,7 @@ class ovrApplFrameOut {
 };
 
 struct ovrRendererOutput {
-    FrameMatrices FrameMatrices; // view and projection transforms
+    OVRFW::FrameMatrices FrameMatrices; // view and projection transforms
     std::vector<ovrDrawSurface> Surfaces; // list of surfaces to render
 };
 
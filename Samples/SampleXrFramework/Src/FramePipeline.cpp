@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   FramePipeline.cpp
+Content     :   Simulates a frame on a worker thread while the previous one renders.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "FramePipeline.h"
+
+#if defined(ANDROID)
+#include <sys/prctl.h> // for prctl( PR_SET_NAME )
+#endif // defined(ANDROID)
+
+#include "OVR_PerfTimer.h"
+
+namespace OVRFW {
+
+void ovrFramePipeline::Start(const char* threadName, SimulateFunc simulate) {
+    if (Thread.joinable()) {
+        return;
+    }
+    Simulate = simulate;
+    Exit = false;
+    Busy = false;
+    SimulatedSlot = -1;
+    Thread = std::thread(&ovrFramePipeline::ThreadMain, this, threadName);
+}
+
+void ovrFramePipeline::Stop() {
+    if (!Thread.joinable()) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(Mutex);
+        Condition.wait(lock, [this] { return !Busy; });
+        Exit = true;
+    }
+    Condition.notify_all();
+    Thread.join();
+    SimulatedSlot = -1;
+}
+
+void ovrFramePipeline::ThreadMain(const char* threadName) {
+#if defined(ANDROID)
+    prctl(PR_SET_NAME, (long)threadName, 0, 0, 0);
+#endif // defined(ANDROID)
+    ovrPerfRecorder::SetThreadName(threadName);
+
+    std::unique_lock<std::mutex> lock(Mutex);
+    for (;;) {
+        Condition.wait(lock, [this] { return Busy || Exit; });
+        if (Exit) {
+            break;
+        }
+
+        // The calling thread does not touch this frame until Busy is cleared.
+        ovrFrame& frame = Frames[SimulationSlot];
+        lock.unlock();
+        Simulate(frame);
+        lock.lock();
+
+        SimulatedSlot = SimulationSlot;
+        Busy = false;
+        Condition.notify_all();
+    }
+}
+
+void ovrFramePipeline::Wait() {
+    std::unique_lock<std::mutex> lock(Mutex);
+    Condition.wait(lock, [this] { return !Busy; });
+}
+
+ovrFramePipeline::ovrFrame& ovrFramePipeline::Advance(
+    const ovrApplFrameIn& in,
+    const ovrRendererOutput& out) {
+    int renderSlot;
+    {
+        std::unique_lock<std::mutex> lock(Mutex);
+        Condition.wait(lock, [this] { return !Busy; });
+        renderSlot = SimulatedSlot;
+        SimulationSlot = (renderSlot == 0) ? 1 : 0;
+        ovrFrame& next = Frames[SimulationSlot];
+        next.In = in;
+        next.Out.FrameMatrices = out.FrameMatrices;
+        next.Out.Surfaces.clear();
+        Busy = true;
+    }
+    Condition.notify_all();
+
+    // Nothing to overlap with on the first frame.
+    if (renderSlot < 0) {
+        Wait();
+        renderSlot = SimulationSlot;
+    }
+    return Frames[renderSlot];
+}
+
+} // namespace OVRFW
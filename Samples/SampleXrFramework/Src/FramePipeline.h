@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   FramePipeline.h
+Content     :   Simulates a frame on a worker thread while the previous one renders.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "FrameParams.h"
+
+namespace OVRFW {
+
+// Hands frames between the calling thread, which renders, and a simulation thread, see
+// XrApp::PipelinedFrames. While frame N is simulated the calling thread renders frame N - 1.
+// Between Wait() and the next Advance() the simulation thread is idle, which is where the
+// calling thread does GL work that changes what the simulation reads, such as
+// OvrSceneView::UpdateWorldModelLoads().
+class ovrFramePipeline {
+   public:
+    // The snapshot of a frame that is passed between the threads.
+    struct ovrFrame {
+        ovrApplFrameIn In;
+        ovrRendererOutput Out;
+    };
+    typedef std::function<void(ovrFrame& frame)> SimulateFunc;
+
+    ovrFramePipeline() : SimulationSlot(0), SimulatedSlot(-1), Busy(false), Exit(false) {}
+    ~ovrFramePipeline() {
+        Stop();
+    }
+
+    // Starts the thread that calls simulate for each frame passed to Advance().
+    void Start(const char* threadName, SimulateFunc simulate);
+    // Waits for the frame being simulated, then ends the thread.
+    void Stop();
+    bool IsRunning() const {
+        return Thread.joinable();
+    }
+
+    // Waits until the simulation thread is idle.
+    void Wait();
+    // Drops the simulated frame, so a stale frame is not rendered when the app resumes. Only
+    // call while the simulation thread is idle.
+    void Discard() {
+        SimulatedSlot = -1;
+    }
+
+    // Starts simulating the frame begun with in and out and returns the frame to render, which
+    // is the one simulated before it, or this one once it is simulated if there is none. The
+    // simulation thread does not touch the returned frame until the next Advance().
+    ovrFrame& Advance(const ovrApplFrameIn& in, const ovrRendererOutput& out);
+
+   private:
+    void ThreadMain(const char* threadName);
+
+    SimulateFunc Simulate;
+    ovrFrame Frames[2];
+    std::thread Thread;
+    std::mutex Mutex;
+    std::condition_variable Condition;
+    int SimulationSlot; // frame being simulated
+    int SimulatedSlot; // frame ready to render, -1 for none
+    bool Busy;
+    bool Exit;
+};
+
+} // namespace OVRFW
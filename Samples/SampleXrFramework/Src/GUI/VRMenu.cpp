@@ -38,6 +38,7 @@ Authors     :   Jonathan E. Wright
 
 #include "OVR_FileSys.h"
 #include "Misc/Log.h"
+#include "OVR_PerfTimer.h"
 
 using OVR::Bounds3f;
 using OVR::Matrix4f;
@@ -318,7 +319,7 @@ void VRMenu::Frame(
     ovrApplFrameIn const& vrFrame,
     Matrix4f const& centerViewMatrix,
     Matrix4f const& traceMat) {
-    // OVR_PERF_TIMER( VRMenu_Frame );
+    OVR_PERF_TIMER(VRMenu_Frame);
 
     std::vector<VRMenuEvent> events;
     events.reserve(1024);
@@ -417,19 +418,19 @@ void VRMenu::Frame(
     Frame_Impl(guiSys, vrFrame);
 
     {
-        // OVR_PERF_TIMER( VRMenu_Frame_EventHandler_Frame );
+        OVR_PERF_TIMER(VRMenu_Frame_EventHandler_Frame);
         EventHandler->Frame(guiSys, vrFrame, RootHandle, MenuPose, traceMat, events);
         /// OVR_PERF_TIMER_STOP_MSG( VRMenu_Frame_EventHandler_Frame, Name.c_str() );
     }
     {
-        // OVR_PERF_TIMER( VRMenu_Frame_EventHandler_HandleEvents );
+        OVR_PERF_TIMER(VRMenu_Frame_EventHandler_HandleEvents);
         EventHandler->HandleEvents(guiSys, vrFrame, RootHandle, events);
         /// OVR_PERF_TIMER_STOP_MSG( VRMenu_Frame_EventHandler_HandleEvents, Name.c_str() );
     }
 
     VRMenuObject* root = guiSys.GetVRMenuMgr().ToObject(RootHandle);
     if (root != NULL) {
-        // OVR_PERF_TIMER( VRMenu_Frame_SubmitForRendering );
+        OVR_PERF_TIMER(VRMenu_Frame_SubmitForRendering);
         VRMenuRenderFlags_t renderFlags;
         guiSys.GetVRMenuMgr().SubmitForRendering(
             guiSys, centerViewMatrix, RootHandle, MenuPose, renderFlags);
@@ -32,6 +32,7 @@ Authors     :   Jonathan E. Wright
 #include "Render/DebugLines.h"
 #include "Render/BitmapFont.h"
 #include "Misc/Log.h"
+#include "OVR_PerfTimer.h"
 
 #include "VRMenuObject.h"
 #include "GuiSys.h"
@@ -661,7 +662,7 @@ void VRMenuMgrLocal::Shutdown() {
 // VRMenuMgrLocal::CreateObject
 // creates a new menu object
 menuHandle_t VRMenuMgrLocal::CreateObject(VRMenuObjectParms const& parms) {
-    /// OVR_PERF_TIMER( CreatObject );
+    OVR_PERF_TIMER(VRMenuMgr_CreateObject);
 
     if (!Initialized) {
         ALOGW("VRMenuMgrLocal::CreateObject - manager has not been initialized!");
@@ -1225,6 +1226,8 @@ void VRMenuMgrLocal::SubmitForRendering(
 //==============================
 // VRMenuMgrLocal::Finish
 void VRMenuMgrLocal::Finish(Matrix4f const& viewMatrix) {
+    OVR_PERF_TIMER(VRMenuMgr_Finish);
+
     // free any deleted component objects
     ExecutePendingComponentDeletions();
 
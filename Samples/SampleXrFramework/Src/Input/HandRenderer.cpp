@@ -240,7 +240,7 @@ bool HandRenderer::Init(const XrHandTrackingMeshFB* mesh, bool leftHand) {
 
     /// Create surface definition
     HandSurfaceDef.surfaceName = leftHand ? "HandSurfaceL" : "HandkSurfaceR";
-    HandSurfaceDef.geo.Create(attribs, indices);
+    HandSurfaceDef.geo.Create(attribs, indices, VertexLayout::Compact());
     HandSurfaceDef.numInstances = 0;
     /// Build the graphics command
     ovrGraphicsCommand& gc = HandSurfaceDef.graphicsCommand;
@@ -31,6 +31,7 @@ Authors     :   Federico Schliemann
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
+#include <cmath>
 #include <fstream>
 
 #include "GUI/GuiSys.h"
@@ -282,6 +283,13 @@ void TinyUI::Update(const OVRFW::ovrApplFrameIn& in) {
 
     /// Save these for later
     PreviousFrameDevices = Devices;
+
+    /// refresh the timing overlay
+    if (FrameTimingLabel != nullptr &&
+        fabs(in.PredictedDisplayTime - FrameTimingRefreshTime) >= 0.5) {
+        FrameTimingRefreshTime = in.PredictedDisplayTime;
+        FrameTimingLabel->SetText(FrameTiming->GetSummary().c_str());
+    }
 }
 
 void TinyUI::Render(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out) {
@@ -402,6 +410,9 @@ void TinyUI::SetUnhandledClickHandler(const std::function<void(void)>& postHandl
 void TinyUI::RemoveParentMenu(OVRFW::VRMenuObject* menuObject) {
     auto menuObjectIter = std::find(AllElements.begin(), AllElements.end(), menuObject);
     AllElements.erase(menuObjectIter);
+    if (menuObject == FrameTimingLabel) {
+        FrameTimingLabel = nullptr;
+    }
 
     // Destroying the menu will destroy the corresponding VRMenuObjects as well
     auto menuIter = Menus.find(menuObject);
@@ -409,6 +420,15 @@ void TinyUI::RemoveParentMenu(OVRFW::VRMenuObject* menuObject) {
     Menus.erase(menuIter);
 }
 
+OVRFW::VRMenuObject* TinyUI::AddFrameTimingLabel(
+    const OVRFW::ovrFrameTiming& timing,
+    const OVR::Vector3f& position,
+    const OVR::Vector2f& size) {
+    FrameTiming = &timing;
+    FrameTimingLabel = CreateMenu(timing.GetSummary(), position, size);
+    return FrameTimingLabel;
+}
+
 OVRFW::VRMenuObject* TinyUI::AddSlider(
     const std::string& label,
     const OVR::Vector3f& position,
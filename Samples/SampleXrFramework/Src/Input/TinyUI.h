@@ -32,6 +32,7 @@ Authors     :   Federico Schliemann
 
 #include "GUI/GuiSys.h"
 #include "Locale/OVR_Locale.h"
+#include "OVR_PerfTimer.h"
 
 #include <functional>
 #include <unordered_map>
@@ -42,7 +43,12 @@ namespace OVRFW {
 /// NOTE: this requires the app to have panel.ktx as a resource
 class TinyUI {
    public:
-    TinyUI() : GuiSys(nullptr), Locale(nullptr) {}
+    TinyUI()
+        : GuiSys(nullptr),
+          Locale(nullptr),
+          FrameTiming(nullptr),
+          FrameTimingLabel(nullptr),
+          FrameTimingRefreshTime(0.0) {}
     ~TinyUI() {}
 
     struct HitTestDevice {
@@ -93,6 +99,12 @@ class TinyUI {
         const OVR::Vector3f& position,
         const OVR::Vector2f& size = {100.0f, 50.0f},
         const std::function<void(void)>& postHandler = {});
+    /// Shows the percentiles of the frame timing, refreshed by Update() twice a second.
+    /// The timing must outlive the label, for instance XrApp::GetFrameTiming().
+    OVRFW::VRMenuObject* AddFrameTimingLabel(
+        const OVRFW::ovrFrameTiming& timing,
+        const OVR::Vector3f& position,
+        const OVR::Vector2f& size = {500.0f, 400.0f});
     void SetUnhandledClickHandler(const std::function<void(void)>& postHandler = {});
 
     void RemoveParentMenu(OVRFW::VRMenuObject* menuObject);
@@ -139,6 +151,9 @@ class TinyUI {
     std::vector<OVRFW::TinyUI::HitTestDevice> PreviousFrameDevices;
     bool UpdateColors;
     std::function<void(void)> UnhandledClickHandler;
+    const OVRFW::ovrFrameTiming* FrameTiming;
+    OVRFW::VRMenuObject* FrameTimingLabel;
+    double FrameTimingRefreshTime;
 };
 
 } // namespace OVRFW
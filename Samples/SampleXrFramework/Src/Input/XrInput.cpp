@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   XrInput.cpp
+Content     :   Per-frame reads of the default XrApp actions from the OpenXR runtime.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "XrInput.h"
+
+#include "Misc/Log.h"
+
+#define OXR(func)                                     \
+    if (XR_FAILED(func)) {                            \
+        ALOGW("OpenXR error on function: %s", #func); \
+    }
+
+namespace OVRFW {
+
+static bool GetBoolean(const ovrXrInputHandles& handles, XrAction action, XrPath subactionPath) {
+    XrActionStateGetInfo getInfo = {XR_TYPE_ACTION_STATE_GET_INFO};
+    getInfo.action = action;
+    getInfo.subactionPath = subactionPath;
+    XrActionStateBoolean state = {XR_TYPE_ACTION_STATE_BOOLEAN};
+    OXR(xrGetActionStateBoolean(handles.Session, &getInfo, &state));
+    return state.currentState != XR_FALSE;
+}
+
+static float GetFloat(const ovrXrInputHandles& handles, XrAction action, XrPath subactionPath) {
+    XrActionStateGetInfo getInfo = {XR_TYPE_ACTION_STATE_GET_INFO};
+    getInfo.action = action;
+    getInfo.subactionPath = subactionPath;
+    XrActionStateFloat state = {XR_TYPE_ACTION_STATE_FLOAT};
+    OXR(xrGetActionStateFloat(handles.Session, &getInfo, &state));
+    return state.currentState;
+}
+
+static XrVector2f
+GetVector2(const ovrXrInputHandles& handles, XrAction action, XrPath subactionPath) {
+    XrActionStateGetInfo getInfo = {XR_TYPE_ACTION_STATE_GET_INFO};
+    getInfo.action = action;
+    getInfo.subactionPath = subactionPath;
+    XrActionStateVector2f state = {XR_TYPE_ACTION_STATE_VECTOR2F};
+    OXR(xrGetActionStateVector2f(handles.Session, &getInfo, &state));
+    return state.currentState;
+}
+
+// Every call here crosses into the runtime, so the actions of hands that have no interaction
+// profile are skipped, and the pose actions are not queried: locating an action space already
+// reports no valid location bits while its action is inactive.
+void ReadXrInputSnapshot(
+    const ovrXrInputHandles& handles,
+    const XrTime time,
+    const bool handBound[2],
+    ovrXrInputSnapshot& snapshot) {
+    XrActiveActionSet activeActionSet{handles.ActionSet};
+    XrActionsSyncInfo syncInfo{XR_TYPE_ACTIONS_SYNC_INFO};
+    syncInfo.countActiveActionSets = 1;
+    syncInfo.activeActionSets = &activeActionSet;
+    OXR(xrSyncActions(handles.Session, &syncInfo));
+
+    snapshot = {};
+    snapshot.HeadLocation = {XR_TYPE_SPACE_LOCATION};
+    OXR(xrLocateSpace(handles.HeadSpace, handles.BaseSpace, time, &snapshot.HeadLocation));
+
+    bool anyHandBound = false;
+    for (int hand = 0; hand < 2; hand++) {
+        snapshot.AimLocation[hand] = {XR_TYPE_SPACE_LOCATION};
+        snapshot.GripLocation[hand] = {XR_TYPE_SPACE_LOCATION};
+        if (!handBound[hand]) {
+            continue;
+        }
+        anyHandBound = true;
+
+        const XrPath handPath = handles.HandPath[hand];
+        OXR(xrLocateSpace(
+            handles.AimSpace[hand], handles.BaseSpace, time, &snapshot.AimLocation[hand]));
+        OXR(xrLocateSpace(
+            handles.GripSpace[hand], handles.BaseSpace, time, &snapshot.GripLocation[hand]));
+        snapshot.IndexTrigger[hand] = GetFloat(handles, handles.IndexTrigger, handPath);
+        snapshot.GripTrigger[hand] = GetFloat(handles, handles.GripTrigger, handPath);
+        snapshot.Joystick[hand] = GetVector2(handles, handles.Joystick, handPath);
+        snapshot.ThumbstickClick[hand] = GetBoolean(handles, handles.ThumbstickClick, handPath);
+    }
+
+    if (anyHandBound) {
+        snapshot.ButtonA = GetBoolean(handles, handles.ButtonA, XR_NULL_PATH);
+        snapshot.ButtonB = GetBoolean(handles, handles.ButtonB, XR_NULL_PATH);
+        snapshot.ButtonX = GetBoolean(handles, handles.ButtonX, XR_NULL_PATH);
+        snapshot.ButtonY = GetBoolean(handles, handles.ButtonY, XR_NULL_PATH);
+        snapshot.ButtonMenu = GetBoolean(handles, handles.ButtonMenu, XR_NULL_PATH);
+        snapshot.ThumbstickTouch = GetBoolean(handles, handles.ThumbstickTouch, XR_NULL_PATH);
+        snapshot.ThumbRestTouch = GetBoolean(handles, handles.ThumbRestTouch, XR_NULL_PATH);
+        snapshot.TriggerTouch = GetBoolean(handles, handles.TriggerTouch, XR_NULL_PATH);
+    }
+}
+
+bool QueryXrInteractionProfiles(const ovrXrInputHandles& handles, XrPath profiles[2]) {
+    bool known = true;
+    for (int hand = 0; hand < 2; hand++) {
+        XrInteractionProfileState state{XR_TYPE_INTERACTION_PROFILE_STATE};
+        const XrResult result =
+            xrGetCurrentInteractionProfile(handles.Session, handles.HandPath[hand], &state);
+        if (XR_FAILED(result)) {
+            ALOGW("xrGetCurrentInteractionProfile failed: %d", static_cast<int>(result));
+            known = false;
+            continue;
+        }
+        profiles[hand] = state.interactionProfile;
+
+        char profile[XR_MAX_PATH_LENGTH] = "none";
+        if (state.interactionProfile != XR_NULL_PATH) {
+            uint32_t profileLength = 0;
+            OXR(xrPathToString(
+                handles.Instance,
+                state.interactionProfile,
+                sizeof(profile),
+                &profileLength,
+                profile));
+        }
+        ALOGV("Interaction profile of the %s hand is '%s'", hand == 0 ? "left" : "right", profile);
+    }
+    return known;
+}
+
+} // namespace OVRFW
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   XrInput.h
+Content     :   Per-frame reads of the default XrApp actions from the OpenXR runtime.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include <openxr/openxr.h>
+
+namespace OVRFW {
+
+// The handles the default actions are read with. Index 0 is the left hand.
+struct ovrXrInputHandles {
+    XrInstance Instance = XR_NULL_HANDLE;
+    XrSession Session = XR_NULL_HANDLE;
+    XrActionSet ActionSet = XR_NULL_HANDLE;
+    XrSpace BaseSpace = XR_NULL_HANDLE; // the spaces are located in this one
+    XrSpace HeadSpace = XR_NULL_HANDLE;
+    XrPath HandPath[2] = {XR_NULL_PATH, XR_NULL_PATH};
+    XrSpace AimSpace[2] = {XR_NULL_HANDLE, XR_NULL_HANDLE};
+    XrSpace GripSpace[2] = {XR_NULL_HANDLE, XR_NULL_HANDLE};
+    XrAction IndexTrigger = XR_NULL_HANDLE;
+    XrAction GripTrigger = XR_NULL_HANDLE;
+    XrAction Joystick = XR_NULL_HANDLE;
+    XrAction ThumbstickClick = XR_NULL_HANDLE;
+    XrAction ButtonA = XR_NULL_HANDLE;
+    XrAction ButtonB = XR_NULL_HANDLE;
+    XrAction ButtonX = XR_NULL_HANDLE;
+    XrAction ButtonY = XR_NULL_HANDLE;
+    XrAction ButtonMenu = XR_NULL_HANDLE;
+    XrAction ThumbstickTouch = XR_NULL_HANDLE;
+    XrAction ThumbRestTouch = XR_NULL_HANDLE;
+    XrAction TriggerTouch = XR_NULL_HANDLE;
+};
+
+// States of the default actions, read once per frame. The actions of a hand without an
+// interaction profile are not queried and left at rest.
+struct ovrXrInputSnapshot {
+    XrSpaceLocation HeadLocation;
+    XrSpaceLocation AimLocation[2];
+    XrSpaceLocation GripLocation[2];
+    float IndexTrigger[2];
+    float GripTrigger[2];
+    XrVector2f Joystick[2];
+    bool ThumbstickClick[2];
+    bool ButtonA;
+    bool ButtonB;
+    bool ButtonX;
+    bool ButtonY;
+    bool ButtonMenu;
+    bool ThumbstickTouch;
+    bool ThumbRestTouch;
+    bool TriggerTouch;
+};
+
+// Syncs the action set and reads everything a frame needs from the runtime. The actions of a
+// hand that is not bound are skipped, and the shared buttons too if no hand is bound.
+void ReadXrInputSnapshot(
+    const ovrXrInputHandles& handles,
+    const XrTime time,
+    const bool handBound[2],
+    ovrXrInputSnapshot& snapshot);
+
+// Asks the runtime for the interaction profile of each hand, XR_NULL_PATH for none. The
+// profile of a hand the runtime does not answer for is left unchanged. Returns false if that
+// happened for either hand.
+bool QueryXrInteractionProfiles(const ovrXrInputHandles& handles, XrPath profiles[2]);
+
+} // namespace OVRFW
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*******************************************************************************
+
+Filename	:   JobPool.cpp
+Content		:	Fixed pool of worker threads for CPU side jobs.
+Created		:
+Authors		:
+Language	:   C++
+
+*******************************************************************************/
+
+#include "JobPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace OVRFW {
+
+ovrJobPool::ovrJobPool(const int numThreads) : Exiting(false) {
+    int count = numThreads;
+    if (count <= 0) {
+        count = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+    }
+    count = std::max(count, 1);
+    for (int i = 0; i < count; i++) {
+        Threads.emplace_back(&ovrJobPool::WorkerThread, this);
+    }
+}
+
+ovrJobPool::~ovrJobPool() {
+    {
+        std::lock_guard<std::mutex> lock(JobsMutex);
+        Exiting = true;
+    }
+    JobsCondition.notify_all();
+    for (std::thread& thread : Threads) {
+        thread.join();
+    }
+}
+
+void ovrJobPool::Submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(JobsMutex);
+        Jobs.push_back(std::move(job));
+    }
+    JobsCondition.notify_one();
+}
+
+void ovrJobPool::WorkerThread() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(JobsMutex);
+            JobsCondition.wait(lock, [this]() { return Exiting || !Jobs.empty(); });
+            // finish any queued work before exiting
+            if (Jobs.empty()) {
+                return;
+            }
+            job = std::move(Jobs.front());
+            Jobs.pop_front();
+        }
+        job();
+    }
+}
+
+void ovrJobPool::ParallelFor(const int count, const std::function<void(int)>& job) {
+    if (count <= 0) {
+        return;
+    }
+
+    struct range_t {
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+    // Helpers may still be queued after the range is finished, so they share
+    // ownership of the counters.  They only call the job while they get indices,
+    // and this function does not return before all those calls are done.
+    std::shared_ptr<range_t> range = std::make_shared<range_t>();
+
+    const auto run = [range, &job, count]() {
+        for (int i = range->next++; i < count; i = range->next++) {
+            job(i);
+            if (++range->done == count) {
+                std::lock_guard<std::mutex> lock(range->mutex);
+                range->condition.notify_all();
+            }
+        }
+    };
+
+    const int numHelpers = std::min(GetThreadCount(), count - 1);
+    for (int i = 0; i < numHelpers; i++) {
+        Submit(run);
+    }
+
+    run();
+
+    std::unique_lock<std::mutex> lock(range->mutex);
+    range->condition.wait(lock, [&range, count]() { return range->done.load() == count; });
+}
+
+void ovrJobPool::ParallelFor(
+    ovrJobPool* pool,
+    const int count,
+    const std::function<void(int)>& job) {
+    if (pool != nullptr) {
+        pool->ParallelFor(count, job);
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        job(i);
+    }
+}
+
+} // namespace OVRFW
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*******************************************************************************
+
+Filename	:   JobPool.h
+Content		:	Fixed pool of worker threads for CPU side jobs.
+Created		:
+Authors		:
+Language	:   C++
+
+*******************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OVRFW {
+
+// Jobs must not touch GL, the worker threads have no context current.
+class ovrJobPool {
+   public:
+    // A thread count of 0 uses one thread less than the number of cores, leaving a
+    // core for the thread that submits the work.
+    explicit ovrJobPool(const int numThreads = 0);
+    ~ovrJobPool();
+
+    ovrJobPool(const ovrJobPool&) = delete;
+    ovrJobPool& operator=(const ovrJobPool&) = delete;
+
+    int GetThreadCount() const {
+        return static_cast<int>(Threads.size());
+    }
+
+    // Queues a job to run on one of the worker threads.
+    void Submit(std::function<void()> job);
+
+    // Calls job( i ) for every i in [0, count) and returns once all calls are done.
+    // The calling thread works on the range too, so this makes progress even when
+    // the pool is busy or has no threads.
+    void ParallelFor(const int count, const std::function<void(int)>& job);
+
+    // Same as the member, but runs everything on the calling thread if pool is nullptr.
+    static void ParallelFor(ovrJobPool* pool, const int count, const std::function<void(int)>& job);
+
+   private:
+    void WorkerThread();
+
+    std::vector<std::thread> Threads;
+    std::deque<std::function<void()>> Jobs;
+    std::mutex JobsMutex;
+    std::condition_variable JobsCondition;
+    bool Exiting;
+};
+
+} // namespace OVRFW
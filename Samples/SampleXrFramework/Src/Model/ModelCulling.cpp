@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   ModelCulling.cpp
+Content     :   Frustum culling and depth sort keys for model surface bounds.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "ModelCulling.h"
+
+#if defined(OVR_CPU_SSE) || defined(OVR_CPU_X86_64) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define OVR_CULL_SSE 1
+#elif defined(OVR_CPU_ARM_NEON) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define OVR_CULL_NEON 1
+#endif
+
+using OVR::Bounds3f;
+using OVR::Matrix4f;
+using OVR::Vector4f;
+
+namespace OVRFW {
+
+// Sorting bounds in increasing order of their farthest W value usually makes
+// characters and objects draw before the environments they are in, and draws
+// sky boxes last, which is what we want.
+float BoundsSortCullKey(const Bounds3f& bounds, const Matrix4f& mvp) {
+    // Always cull empty bounds, which can be used to disable a surface.
+    // Don't just check a single axis, or billboards would be culled.
+    if (bounds.b[1].x == bounds.b[0].x && bounds.b[1].y == bounds.b[0].y) {
+        return 0;
+    }
+
+    // Not very efficient code...
+    Vector4f c[8];
+    for (int i = 0; i < 8; i++) {
+        Vector4f world;
+        world.x = bounds.b[(i & 1)].x;
+        world.y = bounds.b[(i & 2) >> 1].y;
+        world.z = bounds.b[(i & 4) >> 2].z;
+        world.w = 1.0f;
+
+        c[i] = mvp.Transform(world);
+    }
+
+    int i;
+    for (i = 0; i < 8; i++) {
+        if (c[i].x > -c[i].w) {
+            break;
+        }
+    }
+    if (i == 8) {
+        return 0; // all off one side
+    }
+    for (i = 0; i < 8; i++) {
+        if (c[i].x < c[i].w) {
+            break;
+        }
+    }
+    if (i == 8) {
+        return 0; // all off one side
+    }
+
+    for (i = 0; i < 8; i++) {
+        if (c[i].y > -c[i].w) {
+            break;
+        }
+    }
+    if (i == 8) {
+        return 0; // all off one side
+    }
+    for (i = 0; i < 8; i++) {
+        if (c[i].y < c[i].w) {
+            break;
+        }
+    }
+    if (i == 8) {
+        return 0; // all off one side
+    }
+
+    for (i = 0; i < 8; i++) {
+        if (c[i].z > -c[i].w) {
+            break;
+        }
+    }
+    if (i == 8) {
+        return 0; // all off one side
+    }
+    for (i = 0; i < 8; i++) {
+        if (c[i].z < c[i].w) {
+            break;
+        }
+    }
+    if (i == 8) {
+        return 0; // all off one side
+    }
+
+    // calculate the farthest W point for front to back sorting
+    float maxW = 0;
+    for (i = 0; i < 8; i++) {
+        const float w = c[i].w;
+        if (w > maxW) {
+            maxW = w;
+        }
+    }
+
+    return maxW; // couldn't cull
+}
+
+void ovrBoundsCullList::Clear() {
+    MinX.clear();
+    MinY.clear();
+    MinZ.clear();
+    MaxX.clear();
+    MaxY.clear();
+    MaxZ.clear();
+    MatrixIndex.clear();
+}
+
+void ovrBoundsCullList::Add(const Bounds3f& bounds, const int matrixIndex) {
+    MinX.push_back(bounds.b[0].x);
+    MinY.push_back(bounds.b[0].y);
+    MinZ.push_back(bounds.b[0].z);
+    MaxX.push_back(bounds.b[1].x);
+    MaxY.push_back(bounds.b[1].y);
+    MaxZ.push_back(bounds.b[1].z);
+    MatrixIndex.push_back(matrixIndex);
+}
+
+#if defined(OVR_CULL_SSE)
+
+// Computes the keys of four bounds at once, one per lane, each with its own matrix.
+// The corners are visited in the order BoundsSortCullKey uses, each row is summed in
+// the same order as Matrix4f::Transform, and M[r][3] * 1.0f is exactly M[r][3], so
+// the clip coordinates are bit-identical. The farthest W is selected with a compare
+// instead of a max so zeros and NaNs resolve exactly like the scalar loop.
+static void BoundsSortCullKeys4(
+    const float* minX,
+    const float* minY,
+    const float* minZ,
+    const float* maxX,
+    const float* maxY,
+    const float* maxZ,
+    const Matrix4f* const mvp[4],
+    float* keys) {
+    __m128 m[4][4];
+    for (int r = 0; r < 4; r++) {
+        for (int c = 0; c < 4; c++) {
+            m[r][c] =
+                _mm_setr_ps(mvp[0]->M[r][c], mvp[1]->M[r][c], mvp[2]->M[r][c], mvp[3]->M[r][c]);
+        }
+    }
+    const __m128 bx[2] = {_mm_loadu_ps(minX), _mm_loadu_ps(maxX)};
+    const __m128 by[2] = {_mm_loadu_ps(minY), _mm_loadu_ps(maxY)};
+    const __m128 bz[2] = {_mm_loadu_ps(minZ), _mm_loadu_ps(maxZ)};
+
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 notAllNegative[3] = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+    __m128 notAllPositive[3] = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+    __m128 maxW = _mm_setzero_ps();
+    for (int i = 0; i < 8; i++) {
+        const __m128 x = bx[i & 1];
+        const __m128 y = by[(i & 2) >> 1];
+        const __m128 z = bz[(i & 4) >> 2];
+        __m128 c[4];
+        for (int r = 0; r < 4; r++) {
+            c[r] = _mm_add_ps(
+                _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(m[r][0], x), _mm_mul_ps(m[r][1], y)),
+                    _mm_mul_ps(m[r][2], z)),
+                m[r][3]);
+        }
+        const __m128 negW = _mm_xor_ps(c[3], signMask);
+        for (int axis = 0; axis < 3; axis++) {
+            notAllNegative[axis] = _mm_or_ps(notAllNegative[axis], _mm_cmpgt_ps(c[axis], negW));
+            notAllPositive[axis] = _mm_or_ps(notAllPositive[axis], _mm_cmplt_ps(c[axis], c[3]));
+        }
+        const __m128 farther = _mm_cmpgt_ps(c[3], maxW);
+        maxW = _mm_or_ps(_mm_and_ps(farther, c[3]), _mm_andnot_ps(farther, maxW));
+    }
+
+    // Always cull empty bounds, which can be used to disable a surface.
+    const __m128 empty = _mm_and_ps(_mm_cmpeq_ps(bx[1], bx[0]), _mm_cmpeq_ps(by[1], by[0]));
+    __m128 visible = _mm_andnot_ps(empty, _mm_and_ps(notAllNegative[0], notAllPositive[0]));
+    for (int axis = 1; axis < 3; axis++) {
+        visible = _mm_and_ps(visible, _mm_and_ps(notAllNegative[axis], notAllPositive[axis]));
+    }
+    _mm_storeu_ps(keys, _mm_and_ps(visible, maxW));
+}
+
+#elif defined(OVR_CULL_NEON)
+
+// See the SSE version. Separate multiplies and adds are used on purpose, a fused
+// multiply-add would round differently than the scalar code.
+static void BoundsSortCullKeys4(
+    const float* minX,
+    const float* minY,
+    const float* minZ,
+    const float* maxX,
+    const float* maxY,
+    const float* maxZ,
+    const Matrix4f* const mvp[4],
+    float* keys) {
+    float32x4_t m[4][4];
+    for (int r = 0; r < 4; r++) {
+        for (int c = 0; c < 4; c++) {
+            const float lanes[4] = {
+                mvp[0]->M[r][c], mvp[1]->M[r][c], mvp[2]->M[r][c], mvp[3]->M[r][c]};
+            m[r][c] = vld1q_f32(lanes);
+        }
+    }
+    const float32x4_t bx[2] = {vld1q_f32(minX), vld1q_f32(maxX)};
+    const float32x4_t by[2] = {vld1q_f32(minY), vld1q_f32(maxY)};
+    const float32x4_t bz[2] = {vld1q_f32(minZ), vld1q_f32(maxZ)};
+
+    uint32x4_t notAllNegative[3] = {vdupq_n_u32(0), vdupq_n_u32(0), vdupq_n_u32(0)};
+    uint32x4_t notAllPositive[3] = {vdupq_n_u32(0), vdupq_n_u32(0), vdupq_n_u32(0)};
+    float32x4_t maxW = vdupq_n_f32(0.0f);
+    for (int i = 0; i < 8; i++) {
+        const float32x4_t x = bx[i & 1];
+        const float32x4_t y = by[(i & 2) >> 1];
+        const float32x4_t z = bz[(i & 4) >> 2];
+        float32x4_t c[4];
+        for (int r = 0; r < 4; r++) {
+            c[r] = vaddq_f32(
+                vaddq_f32(
+                    vaddq_f32(vmulq_f32(m[r][0], x), vmulq_f32(m[r][1], y)),
+                    vmulq_f32(m[r][2], z)),
+                m[r][3]);
+        }
+        const float32x4_t negW = vnegq_f32(c[3]);
+        for (int axis = 0; axis < 3; axis++) {
+            notAllNegative[axis] = vorrq_u32(notAllNegative[axis], vcgtq_f32(c[axis], negW));
+            notAllPositive[axis] = vorrq_u32(notAllPositive[axis], vcltq_f32(c[axis], c[3]));
+        }
+        maxW = vbslq_f32(vcgtq_f32(c[3], maxW), c[3], maxW);
+    }
+
+    // Always cull empty bounds, which can be used to disable a surface.
+    const uint32x4_t empty = vandq_u32(vceqq_f32(bx[1], bx[0]), vceqq_f32(by[1], by[0]));
+    uint32x4_t visible = vbicq_u32(vandq_u32(notAllNegative[0], notAllPositive[0]), empty);
+    for (int axis = 1; axis < 3; axis++) {
+        visible = vandq_u32(visible, vandq_u32(notAllNegative[axis], notAllPositive[axis]));
+    }
+    vst1q_f32(keys, vreinterpretq_f32_u32(vandq_u32(visible, vreinterpretq_u32_f32(maxW))));
+}
+
+#endif
+
+void BoundsSortCullKeys(
+    const ovrBoundsCullList& list,
+    const Matrix4f* mvps,
+    std::vector<float>& keys) {
+    const int count = list.GetCount();
+    keys.resize(count);
+
+    const float* minX = list.MinX.data();
+    const float* minY = list.MinY.data();
+    const float* minZ = list.MinZ.data();
+    const float* maxX = list.MaxX.data();
+    const float* maxY = list.MaxY.data();
+    const float* maxZ = list.MaxZ.data();
+    const int* matrixIndex = list.MatrixIndex.data();
+
+    int i = 0;
+#if defined(OVR_CULL_SSE) || defined(OVR_CULL_NEON)
+    for (; i + 4 <= count; i += 4) {
+        const Matrix4f* const mvp[4] = {
+            &mvps[matrixIndex[i + 0]],
+            &mvps[matrixIndex[i + 1]],
+            &mvps[matrixIndex[i + 2]],
+            &mvps[matrixIndex[i + 3]]};
+        BoundsSortCullKeys4(
+            minX + i, minY + i, minZ + i, maxX + i, maxY + i, maxZ + i, mvp, &keys[i]);
+    }
+#endif
+    for (; i < count; i++) {
+        const Bounds3f bounds(
+            OVR::Vector3f(minX[i], minY[i], minZ[i]), OVR::Vector3f(maxX[i], maxY[i], maxZ[i]));
+        keys[i] = BoundsSortCullKey(bounds, mvps[matrixIndex[i]]);
+    }
+}
+
+} // namespace OVRFW
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   ModelCulling.h
+Content     :   Frustum culling and depth sort keys for model surface bounds.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include "OVR_Math.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace OVRFW {
+
+// Returns 0 if the bounds is culled by the mvp, otherwise returns the max W
+// value of the bounds corners so it can be sorted into roughly front to back
+// order for more efficient Z cull.
+float BoundsSortCullKey(const OVR::Bounds3f& bounds, const OVR::Matrix4f& mvp);
+
+// Structure-of-arrays list of local bounds, each referencing one of the
+// matrices passed to BoundsSortCullKeys.  Keep one around between frames
+// so the arrays do not need to be reallocated.
+class ovrBoundsCullList {
+   public:
+    void Clear();
+    void Add(const OVR::Bounds3f& bounds, const int matrixIndex);
+
+    int GetCount() const {
+        return static_cast<int>(MatrixIndex.size());
+    }
+
+    std::vector<float> MinX;
+    std::vector<float> MinY;
+    std::vector<float> MinZ;
+    std::vector<float> MaxX;
+    std::vector<float> MaxY;
+    std::vector<float> MaxZ;
+    std::vector<int> MatrixIndex;
+};
+
+// Computes BoundsSortCullKey for every entry of the list in one pass, four
+// bounds per register with SSE or NEON when available.  The results are bit-identical to the scalar
+// function as long as the compiler does not contract the scalar transform
+// into fused multiply-adds (use -ffp-contract=off when comparing on ARM).
+void BoundsSortCullKeys(
+    const ovrBoundsCullList& list,
+    const OVR::Matrix4f* mvps,
+    std::vector<float>& keys);
+
+} // namespace OVRFW
@@ -28,6 +28,7 @@ Authors     :   John Carmack, J.M.P. van Waveren
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 #include <cstdint>
@@ -42,6 +43,8 @@ namespace OVRFW {
 
 class ModelFile;
 class ModelState;
+class ovrJobPool;
+class ovrGlUploadQueue;
 
 struct MaterialParms {
     MaterialParms()
@@ -49,7 +52,13 @@ struct MaterialParms {
           EnableDiffuseAniso(false),
           EnableEmissiveLodClamp(true),
           Transparent(false),
-          PolygonOffset(false) {}
+          PolygonOffset(false),
+          UseBuffersInPlace(false),
+          OptimizeGeometry(false),
+          OptimizeOverdraw(false),
+          MeshletMaxVertices(0),
+          JobPool(nullptr),
+          UploadQueue(nullptr) {}
 
     bool UseSrgbTextureFormats; // use sRGB textures
     bool EnableDiffuseAniso; // enable anisotropic filtering on the diffuse texture
@@ -57,6 +66,29 @@ struct MaterialParms {
     bool Transparent; // surfaces with this material flag need to render in a transparent pass
     bool PolygonOffset; // render with polygon offset enabled
     std::function<bool(ModelFile&, const std::string&)> ImageUriHandler; // custom image URI handler
+    // Reference the binary chunk of a glB file instead of copying it.  LoadModelFile keeps the
+    // file mapped for the lifetime of the model, with LoadModelFileFromMemory the caller has to
+    // keep the memory alive.
+    bool UseBuffersInPlace;
+    // Reorder the triangles and vertices of triangle list surfaces for the vertex cache and
+    // vertex fetches while loading, and log the cache statistics from before and after.
+    bool OptimizeGeometry;
+    // Also order the triangles to reduce overdraw, at a small cost in vertex cache hits.
+    bool OptimizeOverdraw;
+    // Split glTF triangle lists with more vertices than this into clusters of at most this many
+    // vertices.  Each cluster is its own surface with its own bounds, so BuildModelSurfaceList
+    // culls the parts of a large mesh that are out of view.  Surfaces with morph targets or
+    // skins are never split.  0 keeps every primitive in one surface.
+    int MeshletMaxVertices;
+    // glTF accessors and images are decoded on these threads, nullptr decodes on the calling thread
+    ovrJobPool* JobPool;
+    // If set, glTF textures and geometry are created when the caller drains this queue on the
+    // GL thread, instead of before the load returns.  The model can't be rendered or deleted
+    // until its uploads have run.
+    ovrGlUploadQueue* UploadQueue;
+    // How the vertices of the surfaces are stored.  The default layout stores full precision
+    // floats, VertexLayout::Compact() roughly halves the vertex memory of most models.
+    VertexLayout GeometryLayout;
 };
 
 enum ModelJointAnimation {
@@ -93,13 +125,24 @@ enum ModelComponentType {
 };
 
 struct ModelBuffer {
-    ModelBuffer() : byteLength(0) {}
+    ModelBuffer() : byteLength(0), externalData(nullptr) {}
+
+    const uint8_t* GetData() const {
+        return (externalData != nullptr) ? externalData : bufferData.data();
+    }
+    bool IsEmpty() const {
+        return externalData == nullptr && bufferData.empty();
+    }
 
     std::string name;
     std::vector<uint8_t> bufferData;
     size_t byteLength;
     ModelComponentType componentType = MODEL_COMPONENT_TYPE_UNSIGNED_BYTE;
     int componentCount;
+    // Used instead of bufferData when the buffer is read in place, for instance from
+    // a memory mapped glB file.  If set, externalOwner keeps that memory alive.
+    const uint8_t* externalData;
+    std::shared_ptr<const void> externalOwner;
 };
 
 struct ModelBufferView {
@@ -428,18 +471,16 @@ class ModelNodeState {
           rotation(0.0f, 0.0f, 0.0f, 1.0f),
           translation(0.0f, 0.0f, 0.0f),
           scale(1.0f, 1.0f, 1.0f),
-          localTransform(OVR::Matrix4f::Identity()),
-          globalTransform(OVR::Matrix4f::Identity()) {}
+          transformIndex(-1) {}
 
     void GenerateStateFromNode(const ModelNode* _node, ModelState* _modelState);
+    // Both mark the global transforms of the node and its children as out of date,
+    // ModelState::UpdateTransforms() recalculates them.
     void CalculateLocalTransform();
     void SetLocalTransform(const OVR::Matrix4f matrix);
-    OVR::Matrix4f GetLocalTransform() const {
-        return localTransform;
-    }
-    OVR::Matrix4f GetGlobalTransform() const {
-        return globalTransform;
-    }
+    const OVR::Matrix4f& GetLocalTransform() const;
+    const OVR::Matrix4f& GetGlobalTransform() const;
+    // Recalculates the global transforms of the node and its children right away.
     void RecalculateMatrix();
     const ModelNode* GetNode() const {
         return node;
@@ -453,10 +494,8 @@ class ModelNodeState {
     OVR::Vector3f translation;
     OVR::Vector3f scale;
     std::vector<float> weights;
-
-   private:
-    OVR::Matrix4f localTransform;
-    OVR::Matrix4f globalTransform;
+    // index of the transforms of this node in the ModelState
+    int transformIndex;
 };
 
 enum ModelAnimationTimeType {
@@ -502,6 +541,26 @@ class ModelState {
 
     void CalculateAnimationFrameAndFraction(const ModelAnimationTimeType type, float timeInSeconds);
 
+    // Recalculates the global transforms of the nodes that were marked as changed, and
+    // their children, in a single pass.  Returns the number of recalculated nodes.
+    int UpdateTransforms();
+    // Recalculates the transform and the subtree starting at transformIndex.
+    void RecalculateTransforms(const int transformIndex);
+    void SetTransformDirty(const int transformIndex) {
+        transformDirty[transformIndex] = 1;
+    }
+
+    const OVR::Matrix4f& GetLocalTransform(const int transformIndex) const {
+        return localTransforms[transformIndex];
+    }
+    void SetLocalTransform(const int transformIndex, const OVR::Matrix4f& matrix) {
+        localTransforms[transformIndex] = matrix;
+        transformDirty[transformIndex] = 1;
+    }
+    const OVR::Matrix4f& GetGlobalTransform(const int transformIndex) const {
+        return globalTransforms[transformIndex];
+    }
+
     long long DontRenderForClientUid; // skip rendering the model if the current scene's client uid
                                       // matches this
     std::vector<ModelNodeState> nodeStates;
@@ -512,6 +571,14 @@ class ModelState {
 
    private:
     OVR::Matrix4f modelMatrix;
+
+    // The transforms of all nodes in depth first order, so every parent comes before its
+    // children and every subtree is a contiguous range.  Indexed by transformIndex.
+    std::vector<OVR::Matrix4f> localTransforms;
+    std::vector<OVR::Matrix4f> globalTransforms;
+    std::vector<int> transformParents; // -1 for root nodes
+    std::vector<int> transformSubtreeEnds; // one past the last transform of the subtree
+    std::vector<uint8_t> transformDirty;
 };
 
 struct ModelGlPrograms {
@@ -579,7 +646,7 @@ struct ModelGlPrograms {
 
 struct ModelGeo {
     std::vector<OVR::Vector3f> positions;
-    std::vector<TriangleIndex> indices;
+    std::vector<uint32_t> indices;
 };
 
 } // namespace OVRFW
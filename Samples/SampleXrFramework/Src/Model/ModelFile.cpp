@@ -35,6 +35,9 @@ Authors     :   John Carmack, J.M.P. van Waveren
 
 #include "Misc/Log.h"
 
+#include <algorithm>
+#include <utility>
+
 using OVR::Bounds3f;
 using OVR::Matrix4f;
 using OVR::Quatf;
@@ -66,6 +69,8 @@ ModelFile::~ModelFile() {
 
     for (int i = 0; i < static_cast<int>(Buffers.size()); i++) {
         Buffers[i].bufferData.clear();
+        Buffers[i].externalData = nullptr;
+        Buffers[i].externalOwner = nullptr;
     }
 }
 
@@ -128,6 +133,42 @@ Bounds3f ModelFile::GetBounds() const {
     return modelBounds;
 }
 
+void ModelFile::LogGeometryMemory() const {
+    const VertexLayout defaultLayout;
+    size_t vertexBytes = 0;
+    size_t defaultVertexBytes = 0;
+    size_t indexBytes = 0;
+    int vertexCount = 0;
+    int surfaceCount = 0;
+    for (const Model& model : Models) {
+        for (const ModelSurface& surface : model.surfaces) {
+            const GlGeometry& geo = surface.surfaceDef.geo;
+            const size_t defaultBytes = static_cast<size_t>(geo.vertexCount) *
+                defaultLayout.GetVertexSize(geo.vertexAttributeMask);
+            ALOG(
+                "%s: %d vertices %zu bytes (%zu in the default layout), %d indices",
+                surface.surfaceDef.surfaceName.c_str(),
+                geo.vertexCount,
+                static_cast<size_t>(geo.vertexBufferSize),
+                defaultBytes,
+                geo.indexCount);
+            vertexBytes += geo.vertexBufferSize;
+            defaultVertexBytes += defaultBytes;
+            indexBytes += static_cast<size_t>(geo.indexCount) * geo.GetIndexSize();
+            vertexCount += geo.vertexCount;
+            surfaceCount++;
+        }
+    }
+    ALOG(
+        "%s: %d surfaces, %d vertices in %zu bytes (%zu in the default layout), %zu index bytes",
+        FileName.c_str(),
+        surfaceCount,
+        vertexCount,
+        vertexBytes,
+        defaultVertexBytes,
+        indexBytes);
+}
+
 void CalculateTransformFromRTS(
     Matrix4f* localTransform,
     const Quatf rotation,
@@ -151,16 +192,31 @@ void LoadModelFileTexture(
     ModelTexture tex;
     tex.name = textureName;
     tex.name = tex.name.substr(0, tex.name.rfind("."));
-    int width;
-    int height;
-    tex.texid = LoadTextureFromBuffer(
-        textureName,
-        (const uint8_t*)buffer,
-        size,
+    CreateModelFileTexture(tex, textureName, buffer, size, nullptr, 0, 0, materialParms);
+    model.Textures.push_back(tex);
+}
+
+void CreateModelFileTexture(
+    ModelTexture& tex,
+    const char* textureName,
+    const char* buffer,
+    const int size,
+    unsigned char* rgbaImage,
+    const int rgbaWidth,
+    const int rgbaHeight,
+    const MaterialParms& materialParms) {
+    const TextureFlags_t flags =
         (materialParms.UseSrgbTextureFormats ? TextureFlags_t(TEXTUREFLAG_USE_SRGB)
-                                             : TextureFlags_t()),
-        width,
-        height);
+                                             : TextureFlags_t());
+    if (rgbaImage != nullptr) {
+        tex.texid =
+            LoadTextureFromRGBABuffer(textureName, rgbaImage, rgbaWidth, rgbaHeight, flags);
+    } else {
+        int width;
+        int height;
+        tex.texid =
+            LoadTextureFromBuffer(textureName, (const uint8_t*)buffer, size, flags, width, height);
+    }
 
     // ALOG( ( tex.texid.target == GL_TEXTURE_CUBE_MAP ) ? "GL_TEXTURE_CUBE_MAP: %s" :
     // "GL_TEXTURE_2D: %s", textureName );
@@ -170,8 +226,6 @@ void LoadModelFileTexture(
     if (strstr(textureName, "_c.")) {
         MakeTextureClamped(tex.texid);
     }
-
-    model.Textures.push_back(tex);
 }
 
 static ModelFile* LoadZippedModelFile(
@@ -360,20 +414,28 @@ static unzFile open_opaque(zlib_mmap_opaque& zlib_opaque, const char* fileName)
     return unzOpen2(fileName, &zlib_file_funcs);
 }
 
-ModelFile* LoadModelFileFromMemory(
+// bufferOwner keeps the buffer alive if the model ends up referencing it.
+static ModelFile* LoadModelFileFromMemory(
     const char* fileName,
     const void* buffer,
     int bufferLength,
     const ModelGlPrograms& programs,
     const MaterialParms& materialParms,
-    ModelGeo* outModelGeo) {
+    ModelGeo* outModelGeo,
+    const std::shared_ptr<const void>& bufferOwner) {
     // Open the .ModelFile file as a zip.
     ALOG("LoadModelFileFromMemory %s %i", fileName, bufferLength);
 
     // Determine wether it's a glb binary file, or if it is a zipped up ovrscene.
     if (strstr(fileName, ".glb") != nullptr) {
         return LoadModelFile_glB(
-            fileName, (char*)buffer, bufferLength, programs, materialParms, outModelGeo);
+            fileName,
+            (char*)buffer,
+            bufferLength,
+            programs,
+            materialParms,
+            outModelGeo,
+            bufferOwner);
     }
 
     zlib_mmap_opaque zlib_opaque;
@@ -392,16 +454,28 @@ ModelFile* LoadModelFileFromMemory(
         zfp, fileName, (char*)buffer, bufferLength, programs, materialParms, outModelGeo);
 }
 
+ModelFile* LoadModelFileFromMemory(
+    const char* fileName,
+    const void* buffer,
+    int bufferLength,
+    const ModelGlPrograms& programs,
+    const MaterialParms& materialParms,
+    ModelGeo* outModelGeo) {
+    return LoadModelFileFromMemory(
+        fileName, buffer, bufferLength, programs, materialParms, outModelGeo, nullptr);
+}
+
 ModelFile* LoadModelFile(
     const char* fileName,
     const ModelGlPrograms& programs,
     const MaterialParms& materialParms) {
     ALOG("LoadModelFile %s", fileName);
 
-    zlib_mmap_opaque zlib_opaque;
+    // Shared so a glB model can keep the file mapped when it uses its buffers in place.
+    std::shared_ptr<zlib_mmap_opaque> zlib_opaque = std::make_shared<zlib_mmap_opaque>();
 
     // Map and open the zip file
-    if (!mmap_open_opaque(fileName, zlib_opaque)) {
+    if (!mmap_open_opaque(fileName, *zlib_opaque)) {
         ALOGW("could not map file %s", fileName);
         return nullptr;
     }
@@ -409,33 +483,47 @@ ModelFile* LoadModelFile(
     // Determine wether it's a glb binary file, or if it is a zipped up ovrscene.
     if (strstr(fileName, ".glb") != nullptr) {
         return LoadModelFile_glB(
-            fileName, (char*)zlib_opaque.data, zlib_opaque.len, programs, materialParms);
+            fileName,
+            (char*)zlib_opaque->data,
+            zlib_opaque->len,
+            programs,
+            materialParms,
+            nullptr,
+            zlib_opaque);
     }
 
-    unzFile zfp = open_opaque(zlib_opaque, fileName);
+    unzFile zfp = open_opaque(*zlib_opaque, fileName);
     if (!zfp) {
         ALOGW("could not open file %s", fileName);
         return nullptr;
     }
 
     return LoadZippedModelFile(
-        zfp, fileName, (char*)zlib_opaque.data, zlib_opaque.len, programs, materialParms);
+        zfp, fileName, (char*)zlib_opaque->data, zlib_opaque->len, programs, materialParms);
 }
 #else
-ModelFile* LoadModelFileFromMemory(
+// bufferOwner keeps the buffer alive if the model ends up referencing it.
+static ModelFile* LoadModelFileFromMemory(
     const char* fileName,
     const void* buffer,
     int bufferLength,
     const ModelGlPrograms& programs,
     const MaterialParms& materialParms,
-    ModelGeo* outModelGeo) {
+    ModelGeo* outModelGeo,
+    const std::shared_ptr<const void>& bufferOwner) {
     // Open the .ModelFile file as a zip.
     ALOG("LoadModelFileFromMemory %s %i", fileName, bufferLength);
 
     // Determine wether it's a glb binary file, or if it is a zipped up ovrscene.
     if (strstr(fileName, ".glb") != nullptr) {
         return LoadModelFile_glB(
-            fileName, (char*)buffer, bufferLength, programs, materialParms, outModelGeo);
+            fileName,
+            (char*)buffer,
+            bufferLength,
+            programs,
+            materialParms,
+            outModelGeo,
+            bufferOwner);
     }
 
     // Mobile code defaults to zipped ovrscene files - read those here
@@ -455,6 +543,17 @@ ModelFile* LoadModelFileFromMemory(
     return nullptr;
 }
 
+ModelFile* LoadModelFileFromMemory(
+    const char* fileName,
+    const void* buffer,
+    int bufferLength,
+    const ModelGlPrograms& programs,
+    const MaterialParms& materialParms,
+    ModelGeo* outModelGeo) {
+    return LoadModelFileFromMemory(
+        fileName, buffer, bufferLength, programs, materialParms, outModelGeo, nullptr);
+}
+
 ModelFile* LoadModelFile(
     const char* fileName,
     const ModelGlPrograms& programs,
@@ -478,11 +577,10 @@ ModelFile* LoadModelFileFromOtherApplicationPackage(
         return nullptr;
     }
 
-    ModelFile* scene =
-        LoadModelFileFromMemory(nameInZip, buffer, bufferLength, programs, materialParms);
-
-    free(buffer);
-    return scene;
+    // freed when the last reference goes away, which may be the model
+    const std::shared_ptr<const void> bufferOwner(buffer, free);
+    return LoadModelFileFromMemory(
+        nameInZip, buffer, bufferLength, programs, materialParms, nullptr, bufferOwner);
 }
 
 ModelFile* LoadModelFileFromApplicationPackage(
@@ -498,22 +596,27 @@ ModelFile* LoadModelFile(
     const char* uri,
     const ModelGlPrograms& programs,
     const MaterialParms& materialParms) {
-    std::vector<uint8_t> buffer;
-    if (!fileSys.ReadFile(uri, buffer)) {
+    std::shared_ptr<std::vector<uint8_t>> buffer = std::make_shared<std::vector<uint8_t>>();
+    if (!fileSys.ReadFile(uri, *buffer)) {
         ALOGW("Failed to load model uri '%s'", uri);
         return nullptr;
     }
     ModelFile* scene = LoadModelFileFromMemory(
-        uri, buffer.data(), static_cast<int>(buffer.size()), programs, materialParms);
+        uri,
+        buffer->data(),
+        static_cast<int>(buffer->size()),
+        programs,
+        materialParms,
+        nullptr,
+        buffer);
     return scene;
 }
 
 uint8_t* ModelAccessor::BufferData() const {
-    if (bufferView == nullptr || bufferView->buffer == nullptr ||
-        bufferView->buffer->bufferData.empty()) {
+    if (bufferView == nullptr || bufferView->buffer == nullptr || bufferView->buffer->IsEmpty()) {
         return nullptr;
     }
-    return (uint8_t*)bufferView->buffer->bufferData.data() + bufferView->byteOffset + byteOffset;
+    return (uint8_t*)bufferView->buffer->GetData() + bufferView->byteOffset + byteOffset;
 }
 
 void ModelNode::SetLocalTransform(const Matrix4f matrix) {
@@ -619,28 +722,29 @@ void ModelNodeState::GenerateStateFromNode(const ModelNode* _node, ModelState* _
     weights = node->weights;
 
     // These values should be calculated already.
-    localTransform = node->GetLocalTransform();
-    globalTransform = node->GetGlobalTransform();
+    state->SetLocalTransform(transformIndex, node->GetLocalTransform());
 }
 
 void ModelNodeState::CalculateLocalTransform() {
+    Matrix4f localTransform;
     CalculateTransformFromRTS(&localTransform, rotation, translation, scale);
+    state->SetLocalTransform(transformIndex, localTransform);
 }
 
 void ModelNodeState::SetLocalTransform(const Matrix4f matrix) {
-    localTransform = matrix;
+    state->SetLocalTransform(transformIndex, matrix);
 }
 
-void ModelNodeState::RecalculateMatrix() {
-    if (node->parentIndex < 0) {
-        globalTransform = state->GetMatrix() * localTransform;
-    } else {
-        globalTransform = state->nodeStates[node->parentIndex].globalTransform * localTransform;
-    }
+const Matrix4f& ModelNodeState::GetLocalTransform() const {
+    return state->GetLocalTransform(transformIndex);
+}
 
-    for (int i = 0; i < static_cast<int>(node->children.size()); i++) {
-        state->nodeStates[node->children[i]].RecalculateMatrix();
-    }
+const Matrix4f& ModelNodeState::GetGlobalTransform() const {
+    return state->GetGlobalTransform(transformIndex);
+}
+
+void ModelNodeState::RecalculateMatrix() {
+    state->RecalculateTransforms(transformIndex);
 }
 
 void ModelNodeState::AddNodesToEmitList(std::vector<ModelNodeState*>& emitList) {
@@ -667,10 +771,98 @@ void ModelState::GenerateStateFromModelFile(const ModelFile* _mf) {
     mf = _mf;
     DontRenderForClientUid = 0;
 
-    nodeStates.resize(mf->Nodes.size());
-    for (int i = 0; i < static_cast<int>(mf->Nodes.size()); i++) {
+    // Flatten the hierarchy depth first, starting from the root nodes.
+    const int numNodes = static_cast<int>(mf->Nodes.size());
+    nodeStates.resize(numNodes);
+    localTransforms.resize(numNodes);
+    globalTransforms.resize(numNodes);
+    transformParents.resize(numNodes);
+    transformSubtreeEnds.assign(numNodes, 0);
+    transformDirty.assign(numNodes, 1);
+    for (int i = 0; i < numNodes; i++) {
+        nodeStates[i].transformIndex = -1;
+    }
+
+    // The parent index decides the parent of a node, the children lists only decide the
+    // order.  The glTF loader sets the parent from the children so they agree, but in a
+    // broken hierarchy a node can be listed by other nodes than its parent, or by none.
+    // Children their parent does not list go after the listed ones.
+    const auto parentOf = [&](const int i) {
+        const int parent = mf->Nodes[i].parentIndex;
+        return (parent >= 0 && parent < numNodes && parent != i) ? parent : -1;
+    };
+    std::vector<int> childStarts(numNodes + 1, 0);
+    for (int i = 0; i < numNodes; i++) {
+        if (parentOf(i) >= 0) {
+            childStarts[parentOf(i) + 1]++;
+        }
+    }
+    for (int i = 0; i < numNodes; i++) {
+        childStarts[i + 1] += childStarts[i];
+    }
+    std::vector<int> childNodes(childStarts[numNodes]);
+    std::vector<int> childEnds(childStarts.begin(), childStarts.end() - 1);
+    std::vector<uint8_t> placed(numNodes, 0);
+    for (int i = 0; i < numNodes; i++) {
+        for (const int child : mf->Nodes[i].children) {
+            if (child >= 0 && child < numNodes && !placed[child] && parentOf(child) == i) {
+                childNodes[childEnds[i]++] = child;
+                placed[child] = 1;
+            }
+        }
+    }
+    for (int i = 0; i < numNodes; i++) {
+        if (!placed[i] && parentOf(i) >= 0) {
+            childNodes[childEnds[parentOf(i)]++] = i;
+        }
+    }
+
+    int numTransforms = 0;
+    std::vector<std::pair<int, int>> stack; // node index and transform index of the parent
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < numNodes; i++) {
+            if (nodeStates[i].transformIndex >= 0 || (pass == 0 && parentOf(i) >= 0)) {
+                continue;
+            }
+            // The second pass only picks up nodes whose parents lead into a cycle.  Walking up
+            // numNodes parents is sure to end on the cycle, that node becomes a root node.
+            int root = i;
+            if (pass == 1) {
+                for (int j = 0; j < numNodes; j++) {
+                    root = parentOf(root);
+                }
+            }
+            stack.push_back(std::make_pair(root, -1));
+            while (!stack.empty()) {
+                const int nodeIndex = stack.back().first;
+                const int parentTransform = stack.back().second;
+                stack.pop_back();
+                if (nodeStates[nodeIndex].transformIndex >= 0) {
+                    continue;
+                }
+                const int transformIndex = numTransforms++;
+                nodeStates[nodeIndex].transformIndex = transformIndex;
+                transformParents[transformIndex] = parentTransform;
+                // pushed in reverse so the children keep their order
+                for (int j = childStarts[nodeIndex + 1] - 1; j >= childStarts[nodeIndex]; j--) {
+                    stack.push_back(std::make_pair(childNodes[j], transformIndex));
+                }
+            }
+        }
+    }
+
+    for (int i = numNodes - 1; i >= 0; i--) {
+        transformSubtreeEnds[i] = std::max(transformSubtreeEnds[i], i + 1);
+        if (transformParents[i] >= 0) {
+            int& parentEnd = transformSubtreeEnds[transformParents[i]];
+            parentEnd = std::max(parentEnd, transformSubtreeEnds[i]);
+        }
+    }
+
+    for (int i = 0; i < numNodes; i++) {
         nodeStates[i].GenerateStateFromNode(&mf->Nodes[i], this);
     }
+    UpdateTransforms();
 
     animationTimelineStates.resize(mf->AnimationTimeLines.size());
     for (int i = 0; i < static_cast<int>(mf->AnimationTimeLines.size()); i++) {
@@ -685,11 +877,38 @@ void ModelState::GenerateStateFromModelFile(const ModelFile* _mf) {
 
 void ModelState::SetMatrix(const Matrix4f matrix) {
     modelMatrix = matrix;
-    for (int i = 0; i < static_cast<int>(subSceneStates.size()); i++) {
-        for (int j = 0; j < static_cast<int>(subSceneStates[i].nodeStates.size()); j++) {
-            nodeStates[subSceneStates[i].nodeStates[j]].RecalculateMatrix();
+    for (int i = 0; i < static_cast<int>(transformParents.size()); i++) {
+        if (transformParents[i] < 0) {
+            transformDirty[i] = 1;
         }
     }
+    UpdateTransforms();
+}
+
+int ModelState::UpdateTransforms() {
+    const int numTransforms = static_cast<int>(globalTransforms.size());
+    int numUpdated = 0;
+    for (int i = 0; i < numTransforms;) {
+        if (transformDirty[i]) {
+            // skip the subtree, it was recalculated along with its root
+            RecalculateTransforms(i);
+            numUpdated += transformSubtreeEnds[i] - i;
+            i = transformSubtreeEnds[i];
+        } else {
+            i++;
+        }
+    }
+    return numUpdated;
+}
+
+void ModelState::RecalculateTransforms(const int transformIndex) {
+    const int end = transformSubtreeEnds[transformIndex];
+    for (int i = transformIndex; i < end; i++) {
+        const int parent = transformParents[i];
+        const Matrix4f& parentTransform = (parent < 0) ? modelMatrix : globalTransforms[parent];
+        Matrix4f::Multiply(&globalTransforms[i], parentTransform, localTransforms[i]);
+        transformDirty[i] = 0;
+    }
 }
 
 } // namespace OVRFW
@@ -50,6 +50,10 @@ class ModelFile {
 
     OVR::Bounds3f GetBounds() const;
 
+    // Logs the vertex and index buffer memory of the surfaces, next to what the vertices would
+    // take in the default full precision layout.
+    void LogGeometryMemory() const;
+
    public:
     std::string FileName;
     bool UsingSrgbTextures;
@@ -29,6 +29,7 @@ Authors     :   John Carmack, J.M.P. van Waveren
 #include "ModelFile.h"
 
 #include <math.h>
+#include <memory>
 #include <vector>
 
 #include "OVR_Math.h"
@@ -47,6 +48,30 @@ void CalculateTransformFromRTS(
     const OVR::Vector3f translation,
     const OVR::Vector3f scale);
 
+// Converts valueCount values of componentCount components each from srcComponentType,
+// spaced readStride bytes apart, to tightly packed values of dstComponentType.
+void ConvertAccessorComponents(
+    const char* src,
+    const int readStride,
+    const int valueCount,
+    const int componentCount,
+    const int srcComponentType,
+    const int dstComponentType,
+    char* dst);
+
+// Reads the accessor at index into out, converting the components to componentType.
+// With append the values are added after the ones already in out.  Instantiated for
+// the vertex attribute and index types.
+template <typename _type_>
+bool ReadSurfaceDataFromAccessor(
+    std::vector<_type_>& out,
+    ModelFile& modelFile,
+    const int index,
+    const ModelAccessorType type,
+    const int componentType,
+    const int count,
+    const bool append);
+
 void LoadModelFileTexture(
     ModelFile& model,
     const char* textureName,
@@ -54,6 +79,19 @@ void LoadModelFileTexture(
     const int size,
     const MaterialParms& materialParms);
 
+// Creates the GL texture for a texture that was already added to the model.
+// If rgbaImage is not nullptr it was decoded from the buffer with
+// LoadImageToRGBABuffer, which is thread safe, and is only uploaded here.
+void CreateModelFileTexture(
+    ModelTexture& tex,
+    const char* textureName,
+    const char* buffer,
+    const int size,
+    unsigned char* rgbaImage,
+    const int rgbaWidth,
+    const int rgbaHeight,
+    const MaterialParms& materialParms);
+
 bool LoadModelFile_OvrScene(
     ModelFile* modelPtr,
     unzFile zfp,
@@ -74,11 +112,14 @@ bool LoadModelFile_glTF_OvrScene(
     const MaterialParms& materialParms,
     ModelGeo* outModelGeo = NULL);
 
+// With materialParms.UseBuffersInPlace the model references the binary chunk in
+// fileData, and holds on to fileDataOwner to keep it alive.
 ModelFile* LoadModelFile_glB(
     const char* fileName,
     const char* fileData,
     const int fileDataLength,
     const ModelGlPrograms& programs,
     const MaterialParms& materialParms,
-    ModelGeo* outModelGeo = NULL);
+    ModelGeo* outModelGeo = NULL,
+    const std::shared_ptr<const void>& fileDataOwner = nullptr);
 } // namespace OVRFW
@@ -27,6 +27,7 @@ Authors     :   John Carmack, J.M.P. van Waveren
 
 #include "ModelFileLoading.h"
 
+#include "Render/GeometryOptimizer.h"
 #include "Render/GlGeometry.h"
 
 #include "OVR_Std.h"
@@ -331,10 +332,9 @@ bool LoadModelFile_OvrScene_Json(
                             modelSurface.surfaceDef.geo.localBounds,
                             surface.GetChildStringByName("bounds").c_str());
 
-                        TriangleIndex indexOffset = 0;
+                        uint32_t indexOffset = 0;
                         if (outModelGeo != nullptr) {
-                            indexOffset =
-                                static_cast<TriangleIndex>((*outModelGeo).positions.size());
+                            indexOffset = static_cast<uint32_t>((*outModelGeo).positions.size());
                         }
                         //
                         // Vertices
@@ -394,13 +394,6 @@ bool LoadModelFile_OvrScene_Json(
                                 vertices.GetChildStringByName("jointWeights").c_str(),
                                 bin,
                                 vertexCount);
-
-                            if (outModelGeo != nullptr) {
-                                for (int i = 0; i < static_cast<int>(attribs.position.size());
-                                     ++i) {
-                                    (*outModelGeo).positions.push_back(attribs.position[i]);
-                                }
-                            }
                         }
 
                         //
@@ -423,7 +416,30 @@ bool LoadModelFile_OvrScene_Json(
                                 indexCount);
                         }
 
+                        if (materialParms.OptimizeGeometry && !indices.empty()) {
+                            ovrVertexCacheStats before;
+                            ovrVertexCacheStats after;
+                            OptimizeGeometry(
+                                attribs,
+                                indices,
+                                nullptr,
+                                materialParms.OptimizeOverdraw,
+                                &before,
+                                &after);
+                            ALOG(
+                                "OptimizeGeometry: %d triangles, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+                                static_cast<int>(indices.size() / 3),
+                                before.acmr,
+                                after.acmr,
+                                before.atvr,
+                                after.atvr);
+                        }
+
+                        // after the optimization, which reorders the vertices
                         if (outModelGeo != nullptr) {
+                            for (int i = 0; i < static_cast<int>(attribs.position.size()); ++i) {
+                                (*outModelGeo).positions.push_back(attribs.position[i]);
+                            }
                             for (int i = 0; i < static_cast<int>(indices.size()); ++i) {
                                 (*outModelGeo).indices.push_back(indices[i] + indexOffset);
                             }
@@ -434,7 +450,8 @@ bool LoadModelFile_OvrScene_Json(
                         // attributes are known.
                         //
 
-                        modelSurface.surfaceDef.geo.Create(attribs, indices);
+                        modelSurface.surfaceDef.geo.Create(
+                            attribs, indices, materialParms.GeometryLayout);
 
                         const char* materialTypeString = "opaque";
                         OVR_UNUSED(
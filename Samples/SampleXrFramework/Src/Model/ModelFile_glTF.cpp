@@ -32,11 +32,24 @@ Authors     :   John Carmack, J.M.P. van Waveren
 #include "OVR_JSON.h"
 #include "StringUtils.h"
 
+#include "Misc/JobPool.h"
 #include "Misc/Log.h"
 #include "OVR_BinaryFile2.h"
+#include "Render/GeometryOptimizer.h"
+#include "Render/GlUploadQueue.h"
 
+#include <string.h>
+#include <memory>
 #include <unordered_map>
 
+#if defined(OVR_CPU_X86_64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define OVR_GLTF_SSE2 1
+#elif defined(__aarch64__) && (defined(OVR_CPU_ARM_NEON) || defined(__ARM_NEON))
+#include <arm_neon.h>
+#define OVR_GLTF_NEON 1
+#endif
+
 // #include "Render/Egl.h"
 
 /// Aliasing some GL constant for defaults and commonly used behavior
@@ -197,6 +210,303 @@ static size_t getComponentSize(int componentType) {
     }
 }
 
+// Conversions of a single component, used when an accessor is stored with a different
+// component type than the one requested.
+// For normalized signed integers, we need them to map to whole [-1.0f, 1.0f]
+// while having the 0 exactly at 0.0f for byte:
+// -128 -> - 1.0f
+//    0 ->  0.0f
+//  127 ->  1.0f
+// to achieve that we do std::max((float)value / MaxValue, -1.0f);
+static inline float ComponentToFloat(const int8_t value) {
+    return std::max(((float)value) / 127.0f, -1.0f);
+}
+static inline float ComponentToFloat(const uint8_t value) {
+    return ((float)value) / 255.0f;
+}
+static inline float ComponentToFloat(const int16_t value) {
+    return std::max(((float)value) / 32767.0f, -1.0f);
+}
+static inline float ComponentToFloat(const uint16_t value) {
+    return ((float)value) / 65535.0f;
+}
+static inline float ComponentToFloat(const uint32_t value) {
+    return (float)(((double)value) / 4294967295.0);
+}
+static inline float ComponentToFloat(const float value) {
+    return value;
+}
+
+template <typename _dst_>
+inline _dst_ FloatToComponent(const float value) {
+    // SPECIAL CASES, we don't know if the float is normalized or not normalized
+    // we assume that the float was not a normalized value when someone asks for
+    // an int16, uint16 or uint32
+    return (_dst_)value;
+}
+template <>
+inline int8_t FloatToComponent<int8_t>(const float value) {
+    // -1.0f -> -128, 1.0f -> +127, 0.0f -> 0
+    return (int8_t)(value * 128.0f);
+}
+template <>
+inline uint8_t FloatToComponent<uint8_t>(const float value) {
+    return (uint8_t)(value * 255.0f);
+}
+
+// integer to integer, no "proportional" conversion, just change of storage
+template <typename _src_, typename _dst_>
+struct ComponentConverter {
+    static inline _dst_ Convert(const _src_ value) {
+        return (_dst_)(int64_t)value;
+    }
+};
+template <typename _src_>
+struct ComponentConverter<_src_, float> {
+    static inline float Convert(const _src_ value) {
+        return ComponentToFloat(value);
+    }
+};
+template <typename _dst_>
+struct ComponentConverter<float, _dst_> {
+    static inline _dst_ Convert(const float value) {
+        return FloatToComponent<_dst_>(value);
+    }
+};
+template <>
+struct ComponentConverter<float, float> {
+    static inline float Convert(const float value) {
+        return value;
+    }
+};
+
+// The component types are resolved once per accessor, so the inner loops are
+// tight enough for the compiler to unroll and vectorize.
+template <typename _src_, typename _dst_>
+static void ConvertComponents(
+    const char* src,
+    const int readStride,
+    const int valueCount,
+    const int componentCount,
+    char* dst) {
+    _dst_* valueDst = (_dst_*)dst;
+    for (int i = 0; i < valueCount; i++) {
+        const _src_* valueSrc = (const _src_*)(src + i * readStride);
+        for (int j = 0; j < componentCount; j++) {
+            valueDst[j] = ComponentConverter<_src_, _dst_>::Convert(valueSrc[j]);
+        }
+        valueDst += componentCount;
+    }
+}
+
+#if defined(OVR_GLTF_SSE2)
+static inline __m128 LoadComponents4(const int8_t* src) {
+    int32_t bits;
+    memcpy(&bits, src, sizeof(bits));
+    __m128i v = _mm_cvtsi32_si128(bits);
+    v = _mm_unpacklo_epi8(v, v);
+    v = _mm_unpacklo_epi16(v, v);
+    return _mm_cvtepi32_ps(_mm_srai_epi32(v, 24));
+}
+static inline __m128 LoadComponents4(const uint8_t* src) {
+    int32_t bits;
+    memcpy(&bits, src, sizeof(bits));
+    const __m128i zero = _mm_setzero_si128();
+    __m128i v = _mm_cvtsi32_si128(bits);
+    v = _mm_unpacklo_epi8(v, zero);
+    v = _mm_unpacklo_epi16(v, zero);
+    return _mm_cvtepi32_ps(v);
+}
+static inline __m128 LoadComponents4(const int16_t* src) {
+    __m128i v = _mm_loadl_epi64((const __m128i*)src);
+    v = _mm_unpacklo_epi16(v, v);
+    return _mm_cvtepi32_ps(_mm_srai_epi32(v, 16));
+}
+static inline __m128 LoadComponents4(const uint16_t* src) {
+    __m128i v = _mm_loadl_epi64((const __m128i*)src);
+    v = _mm_unpacklo_epi16(v, _mm_setzero_si128());
+    return _mm_cvtepi32_ps(v);
+}
+#elif defined(OVR_GLTF_NEON)
+static inline float32x4_t LoadComponents4(const int8_t* src) {
+    int32_t bits;
+    memcpy(&bits, src, sizeof(bits));
+    const int16x8_t v = vmovl_s8(vreinterpret_s8_s32(vdup_n_s32(bits)));
+    return vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+}
+static inline float32x4_t LoadComponents4(const uint8_t* src) {
+    uint32_t bits;
+    memcpy(&bits, src, sizeof(bits));
+    const uint16x8_t v = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(bits)));
+    return vcvtq_f32_u32(vmovl_u16(vget_low_u16(v)));
+}
+static inline float32x4_t LoadComponents4(const int16_t* src) {
+    return vcvtq_f32_s32(vmovl_s16(vld1_s16(src)));
+}
+static inline float32x4_t LoadComponents4(const uint16_t* src) {
+    return vcvtq_f32_u32(vmovl_u16(vld1_u16(src)));
+}
+#endif
+
+// Normalized colors, joint weights, tangents and packed normals are almost always
+// 4 component 8 or 16 bit integers, decode those a whole value at a time.  This divides
+// like ComponentToFloat, so the results are identical to the scalar path.  Clamping the
+// unsigned types to -1.0f is a no-op.
+template <typename _src_>
+static void ConvertNormalizedComponents4(
+    const char* src,
+    const int readStride,
+    const int valueCount,
+    const float maxValue,
+    char* dst) {
+#if defined(OVR_GLTF_SSE2)
+    float* valueDst = (float*)dst;
+    const __m128 divisor = _mm_set1_ps(maxValue);
+    const __m128 minValue = _mm_set1_ps(-1.0f);
+    for (int i = 0; i < valueCount; i++) {
+        const __m128 v = LoadComponents4((const _src_*)(src + i * readStride));
+        _mm_storeu_ps(valueDst + i * 4, _mm_max_ps(_mm_div_ps(v, divisor), minValue));
+    }
+#elif defined(OVR_GLTF_NEON)
+    float* valueDst = (float*)dst;
+    const float32x4_t divisor = vdupq_n_f32(maxValue);
+    const float32x4_t minValue = vdupq_n_f32(-1.0f);
+    for (int i = 0; i < valueCount; i++) {
+        const float32x4_t v = LoadComponents4((const _src_*)(src + i * readStride));
+        vst1q_f32(valueDst + i * 4, vmaxq_f32(vdivq_f32(v, divisor), minValue));
+    }
+#else
+    (void)maxValue;
+    ConvertComponents<_src_, float>(src, readStride, valueCount, 4, dst);
+#endif
+}
+
+template <typename _src_>
+static void ConvertComponentsFrom(
+    const char* src,
+    const int readStride,
+    const int valueCount,
+    const int componentCount,
+    const int dstComponentType,
+    char* dst) {
+    switch (dstComponentType) {
+        case MODEL_COMPONENT_TYPE_BYTE:
+            ConvertComponents<_src_, int8_t>(src, readStride, valueCount, componentCount, dst);
+            break;
+        case MODEL_COMPONENT_TYPE_UNSIGNED_BYTE:
+        default:
+            ConvertComponents<_src_, uint8_t>(src, readStride, valueCount, componentCount, dst);
+            break;
+        case MODEL_COMPONENT_TYPE_SHORT:
+            ConvertComponents<_src_, int16_t>(src, readStride, valueCount, componentCount, dst);
+            break;
+        case MODEL_COMPONENT_TYPE_UNSIGNED_SHORT:
+            ConvertComponents<_src_, uint16_t>(src, readStride, valueCount, componentCount, dst);
+            break;
+        case MODEL_COMPONENT_TYPE_UNSIGNED_INT:
+            ConvertComponents<_src_, uint32_t>(src, readStride, valueCount, componentCount, dst);
+            break;
+        case MODEL_COMPONENT_TYPE_FLOAT:
+            ConvertComponents<_src_, float>(src, readStride, valueCount, componentCount, dst);
+            break;
+    }
+}
+
+void ConvertAccessorComponents(
+    const char* src,
+    const int readStride,
+    const int valueCount,
+    const int componentCount,
+    const int srcComponentType,
+    const int dstComponentType,
+    char* dst) {
+    if (dstComponentType == MODEL_COMPONENT_TYPE_FLOAT && componentCount == 4) {
+        switch (srcComponentType) {
+            case MODEL_COMPONENT_TYPE_BYTE:
+                ConvertNormalizedComponents4<int8_t>(src, readStride, valueCount, 127.0f, dst);
+                return;
+            case MODEL_COMPONENT_TYPE_UNSIGNED_BYTE:
+                ConvertNormalizedComponents4<uint8_t>(src, readStride, valueCount, 255.0f, dst);
+                return;
+            case MODEL_COMPONENT_TYPE_SHORT:
+                ConvertNormalizedComponents4<int16_t>(src, readStride, valueCount, 32767.0f, dst);
+                return;
+            case MODEL_COMPONENT_TYPE_UNSIGNED_SHORT:
+                ConvertNormalizedComponents4<uint16_t>(
+                    src, readStride, valueCount, 65535.0f, dst);
+                return;
+            default:
+                break;
+        }
+    }
+
+    switch (srcComponentType) {
+        case MODEL_COMPONENT_TYPE_BYTE:
+            ConvertComponentsFrom<int8_t>(
+                src, readStride, valueCount, componentCount, dstComponentType, dst);
+            break;
+        case MODEL_COMPONENT_TYPE_UNSIGNED_BYTE:
+        default:
+            ConvertComponentsFrom<uint8_t>(
+                src, readStride, valueCount, componentCount, dstComponentType, dst);
+            break;
+        case MODEL_COMPONENT_TYPE_SHORT:
+            ConvertComponentsFrom<int16_t>(
+                src, readStride, valueCount, componentCount, dstComponentType, dst);
+            break;
+        case MODEL_COMPONENT_TYPE_UNSIGNED_SHORT:
+            ConvertComponentsFrom<uint16_t>(
+                src, readStride, valueCount, componentCount, dstComponentType, dst);
+            break;
+        case MODEL_COMPONENT_TYPE_UNSIGNED_INT:
+            ConvertComponentsFrom<uint32_t>(
+                src, readStride, valueCount, componentCount, dstComponentType, dst);
+            break;
+        case MODEL_COMPONENT_TYPE_FLOAT:
+            ConvertComponentsFrom<float>(
+                src, readStride, valueCount, componentCount, dstComponentType, dst);
+            break;
+    }
+}
+
+// A compile time size lets the copy of each value become a few plain moves.
+template <size_t _size_>
+static void CopyStridedValues(const char* src, const int readStride, const int valueCount, char* dst) {
+    for (int i = 0; i < valueCount; i++) {
+        memcpy(dst + i * _size_, src + i * readStride, _size_);
+    }
+}
+
+static void CopyStridedValues(
+    const char* src,
+    const int readStride,
+    const int valueCount,
+    const size_t valueSize,
+    char* dst) {
+    switch (valueSize) {
+        case 2:
+            CopyStridedValues<2>(src, readStride, valueCount, dst);
+            break;
+        case 4:
+            CopyStridedValues<4>(src, readStride, valueCount, dst);
+            break;
+        case 8:
+            CopyStridedValues<8>(src, readStride, valueCount, dst);
+            break;
+        case 12:
+            CopyStridedValues<12>(src, readStride, valueCount, dst);
+            break;
+        case 16:
+            CopyStridedValues<16>(src, readStride, valueCount, dst);
+            break;
+        default:
+            for (int i = 0; i < valueCount; i++) {
+                memcpy(dst + i * valueSize, src + i * readStride, valueSize);
+            }
+            break;
+    }
+}
+
 template <typename _type_>
 bool ReadSurfaceDataFromAccessor(
     std::vector<_type_>& out,
@@ -213,7 +523,7 @@ bool ReadSurfaceDataFromAccessor(
                 "Error: Invalid index on gltfPrimitive accessor %d %d",
                 index,
                 static_cast<int>(modelFile.Accessors.size()));
-            loaded = false;
+            return false;
         }
 
         const ModelAccessor* accessor = &(modelFile.Accessors[index]);
@@ -246,10 +556,6 @@ bool ReadSurfaceDataFromAccessor(
             readStride = bufferView->byteStride;
         }
 
-        size_t dstComponentSize = getComponentSize(componentType);
-        size_t dstComponentCount = getComponentCount(type);
-        size_t dstValueSize = dstComponentSize * dstComponentCount;
-
         const size_t offset = accessor->byteOffset + bufferView->byteOffset;
 
         const size_t srcRequiredSize = accessor->count * readStride;
@@ -263,189 +569,24 @@ bool ReadSurfaceDataFromAccessor(
             loaded = false;
         }
 
-        if (loaded) {
+        if (loaded && accessor->count > 0) {
             const size_t startIndex = append ? out.size() : 0;
             out.resize(startIndex + accessor->count);
-            int valueCount = (int)(accessor->count);
-            const char* src = (char*)buffer->bufferData.data() + offset;
+            const char* src = (const char*)buffer->GetData() + offset;
+            char* dst = (char*)&out[startIndex];
             if (accessor->componentType != componentType) {
-                if (componentType == MODEL_COMPONENT_TYPE_FLOAT) {
-                    float* dst = (float*)&out[0];
-                    // for normalized signed integers, we need them to map to whole [-1.0f, 1.0f]
-                    // while having the 0 exactly at 0.0f for byte:
-                    //-128 -> - 1.0f
-                    // 0 ->  0.0f
-                    // 127 ->  1.0f
-                    // to achieve that we do std::max((float)value / MaxValue, -1.0f);
-                    switch (accessor->componentType) {
-                        case MODEL_COMPONENT_TYPE_BYTE:
-                            for (int i = 0; i < valueCount; i++) {
-                                const int8_t* valueSrc = (int8_t*)(src + i * readStride);
-                                float* valueDst = (float*)(dst + i * srcComponentCount);
-                                for (int j = 0; j < (int)srcComponentCount; j++) {
-                                    valueDst[j] = std::max(((float)valueSrc[j]) / 127.0f, -1.0f);
-                                }
-                            }
-                            break;
-                        case MODEL_COMPONENT_TYPE_UNSIGNED_BYTE:
-                        default:
-                            for (int i = 0; i < valueCount; i++) {
-                                const uint8_t* valueSrc = (uint8_t*)(src + i * readStride);
-                                float* valueDst = (float*)(dst + i * srcComponentCount);
-                                for (int j = 0; j < (int)srcComponentCount; j++) {
-                                    valueDst[j] = ((float)valueSrc[j]) / 255.0f;
-                                }
-                            }
-                            break;
-                        case MODEL_COMPONENT_TYPE_SHORT:
-                            for (int i = 0; i < valueCount; i++) {
-                                const int16_t* valueSrc = (int16_t*)(src + i * readStride);
-                                float* valueDst = (float*)(dst + i * srcComponentCount);
-                                for (int j = 0; j < (int)srcComponentCount; j++) {
-                                    valueDst[j] = std::max(((float)valueSrc[j]) / 32767.0f, -1.0f);
-                                }
-                            }
-                            break;
-                        case MODEL_COMPONENT_TYPE_UNSIGNED_SHORT:
-                            for (int i = 0; i < valueCount; i++) {
-                                const uint16_t* valueSrc = (uint16_t*)(src + i * readStride);
-                                float* valueDst = (float*)(dst + i * srcComponentCount);
-                                for (int j = 0; j < (int)srcComponentCount; j++) {
-                                    valueDst[j] = ((float)valueSrc[j]) / 65535.0f;
-                                }
-                            }
-                            break;
-                        case MODEL_COMPONENT_TYPE_UNSIGNED_INT:
-                            for (int i = 0; i < valueCount; i++) {
-                                const uint32_t* valueSrc = (uint32_t*)(src + i * readStride);
-                                float* valueDst = (float*)(dst + i * srcComponentCount);
-                                for (int j = 0; j < (int)srcComponentCount; j++) {
-                                    valueDst[j] = (float)(((double)valueSrc[j]) / 4294967295.0);
-                                }
-                            }
-                            break;
-                    }
-                } else {
-                    // slow path for rare cases
-                    if (accessor->componentType == MODEL_COMPONENT_TYPE_FLOAT ||
-                        componentType == MODEL_COMPONENT_TYPE_FLOAT) {
-                        char* dst = (char*)&out[0];
-                        for (int i = 0; i < valueCount; i++) {
-                            for (int j = 0; j < (int)srcComponentCount; j++) {
-                                float value;
-                                const char* valueSrc = src + i * readStride + j * srcComponentSize;
-                                switch (accessor->componentType) {
-                                    case MODEL_COMPONENT_TYPE_BYTE:
-                                        value =
-                                            std::max(((float)(*(int8_t*)valueSrc)) / 127.0f, -1.0f);
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_UNSIGNED_BYTE:
-                                    default:
-                                        value = ((float)(*(uint8_t*)valueSrc)) / 255.0f;
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_SHORT:
-                                        value = std::max(
-                                            ((float)(*(int16_t*)valueSrc)) / 32767.0f, -1.0f);
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_UNSIGNED_SHORT:
-                                        value = ((float)(*(uint16_t*)valueSrc)) / 65535.0f;
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_UNSIGNED_INT:
-                                        value = (float)(((double)(*(uint32_t*)valueSrc)) /
-                                                        4294967295.0);
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_FLOAT:
-                                        value = (*(float*)valueSrc);
-                                        break;
-                                }
-                                char* valueDst = dst + i * dstValueSize + j * dstComponentSize;
-                                switch (componentType) {
-                                    case MODEL_COMPONENT_TYPE_BYTE:
-                                        // -1.0f -> -128, 1.0f -> +127, 0.0f -> 0
-                                        *(int8_t*)valueDst = (int8_t)(value * 128.0f);
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_UNSIGNED_BYTE:
-                                    default:
-                                        *(uint8_t*)valueDst = (uint8_t)(value * 255.0f);
-                                        break;
-                                        // SPECIAL CASES, we don't know if the float is normalized
-                                        // or not normalized we assume that the float was not a
-                                        // normalized value when someone asks for an uint16 or
-                                        // uint32
-                                    case MODEL_COMPONENT_TYPE_SHORT:
-                                        *(int16_t*)valueDst = (int16_t)(value);
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_UNSIGNED_SHORT:
-                                        *(uint16_t*)valueDst = (uint16_t)(value);
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_UNSIGNED_INT:
-                                        *(uint32_t*)valueDst = (uint32_t)(value);
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_FLOAT:
-                                        *(float*)valueDst = value;
-                                        break;
-                                }
-                            }
-                        }
-                    } else {
-                        // integer to integer, no "proportional" conversion, just change of storage
-                        char* dst = (char*)&out[0];
-                        for (int i = 0; i < valueCount; i++) {
-                            for (int j = 0; j < (int)srcComponentCount; j++) {
-                                int64_t value;
-                                const char* valueSrc = src + i * readStride + j * srcComponentSize;
-                                switch (accessor->componentType) {
-                                    case MODEL_COMPONENT_TYPE_BYTE:
-                                        value = (int64_t)(*(int8_t*)valueSrc);
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_UNSIGNED_BYTE:
-                                    default:
-                                        value = (int64_t)(*(uint8_t*)valueSrc);
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_SHORT:
-                                        value = (int64_t)(*(int16_t*)valueSrc);
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_UNSIGNED_SHORT:
-                                        value = (int64_t)(*(uint16_t*)valueSrc);
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_UNSIGNED_INT:
-                                        value = (int64_t)(*(uint32_t*)valueSrc);
-                                        break;
-                                }
-                                char* valueDst = dst + i * dstValueSize + j * dstComponentSize;
-                                switch (componentType) {
-                                    case MODEL_COMPONENT_TYPE_BYTE:
-                                        *(int8_t*)valueDst = (int8_t)value;
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_UNSIGNED_BYTE:
-                                    default:
-                                        *(uint8_t*)valueDst = (uint8_t)value;
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_SHORT:
-                                        *(int16_t*)valueDst = (int16_t)value;
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_UNSIGNED_SHORT:
-                                        *(uint8_t*)valueDst = (uint16_t)value;
-                                        break;
-                                    case MODEL_COMPONENT_TYPE_UNSIGNED_INT:
-                                        *(uint32_t*)valueDst = (uint32_t)value;
-                                        break;
-                                }
-                            }
-                        }
-                    }
-                }
+                ConvertAccessorComponents(
+                    src,
+                    readStride,
+                    accessor->count,
+                    (int)srcComponentCount,
+                    accessor->componentType,
+                    componentType,
+                    dst);
+            } else if (readStride == (int)srcValueSize) {
+                memcpy(dst, src, srcRequiredSize);
             } else {
-                if (readStride == (int)srcValueSize) {
-                    memcpy(&out[startIndex], buffer->bufferData.data() + offset, srcRequiredSize);
-                } else {
-                    char* dst = (char*)&out[0];
-                    for (int i = 0; i < valueCount; i++) {
-                        const char* valueSrc = src + i * readStride;
-                        char* valueDst = dst + i * srcValueSize;
-                        memcpy(valueDst, valueSrc, srcValueSize);
-                    }
-                }
+                CopyStridedValues(src, readStride, accessor->count, srcValueSize, dst);
             }
         }
     }
@@ -453,6 +594,47 @@ bool ReadSurfaceDataFromAccessor(
     return loaded;
 }
 
+template bool ReadSurfaceDataFromAccessor(
+    std::vector<uint32_t>&,
+    ModelFile&,
+    const int,
+    const ModelAccessorType,
+    const int,
+    const int,
+    const bool);
+template bool ReadSurfaceDataFromAccessor(
+    std::vector<OVR::Vector2f>&,
+    ModelFile&,
+    const int,
+    const ModelAccessorType,
+    const int,
+    const int,
+    const bool);
+template bool ReadSurfaceDataFromAccessor(
+    std::vector<OVR::Vector3f>&,
+    ModelFile&,
+    const int,
+    const ModelAccessorType,
+    const int,
+    const int,
+    const bool);
+template bool ReadSurfaceDataFromAccessor(
+    std::vector<OVR::Vector4f>&,
+    ModelFile&,
+    const int,
+    const ModelAccessorType,
+    const int,
+    const int,
+    const bool);
+template bool ReadSurfaceDataFromAccessor(
+    std::vector<OVR::Vector4i>&,
+    ModelFile&,
+    const int,
+    const ModelAccessorType,
+    const int,
+    const int,
+    const bool);
+
 bool ReadVertexAttributes(
     const OVR::JsonReader& attributes,
     ModelFile& modelFile,
@@ -598,12 +780,286 @@ bool ReadVertexAttributes(
     return loaded;
 }
 
+// Image data gathered while parsing the images.  Formats handled by stb_image
+// are decoded on the job pool, all GL work goes through the upload queue.
+struct glTFImageLoad {
+    glTFImageLoad() : textureIndex(-1), buffer(nullptr), size(0), rgbaWidth(0), rgbaHeight(0) {}
+
+    int textureIndex;
+    std::string fileName; // the extension selects the decoder
+    const char* buffer;
+    int size;
+    std::shared_ptr<std::vector<char>> bufferCopy; // for buffers the model does not own
+    std::shared_ptr<unsigned char> rgbaImage;
+    int rgbaWidth;
+    int rgbaHeight;
+};
+
+// Reserves the texture so texture wrappers can point at it before it is created.
+static void AddImageLoad(
+    ModelFile& modelFile,
+    std::vector<glTFImageLoad>& imageLoads,
+    const char* fileName,
+    const char* buffer,
+    const int size,
+    const bool copyBuffer) {
+    ModelTexture tex;
+    tex.name = fileName;
+    tex.name = tex.name.substr(0, tex.name.rfind("."));
+    modelFile.Textures.push_back(tex);
+
+    glTFImageLoad load;
+    load.textureIndex = static_cast<int>(modelFile.Textures.size()) - 1;
+    load.fileName = fileName;
+    load.size = size;
+    if (copyBuffer && buffer != nullptr) {
+        load.bufferCopy = std::make_shared<std::vector<char>>(buffer, buffer + size);
+        load.buffer = load.bufferCopy->data();
+    } else {
+        load.buffer = buffer;
+    }
+    imageLoads.push_back(load);
+}
+
+static void LoadImages(
+    ModelFile& modelFile,
+    std::vector<glTFImageLoad>& imageLoads,
+    const MaterialParms& materialParms,
+    ovrGlUploadQueue& uploadQueue) {
+    ovrJobPool::ParallelFor(
+        materialParms.JobPool, static_cast<int>(imageLoads.size()), [&imageLoads](const int i) {
+            glTFImageLoad& load = imageLoads[i];
+            if (load.buffer == nullptr || load.size <= 0) {
+                return;
+            }
+            unsigned char* image = LoadImageToRGBABuffer(
+                load.fileName.c_str(),
+                (const unsigned char*)load.buffer,
+                load.size,
+                load.rgbaWidth,
+                load.rgbaHeight);
+            if (image != nullptr) {
+                load.rgbaImage = std::shared_ptr<unsigned char>(image, FreeRGBABuffer);
+                // the encoded data is no longer needed
+                load.bufferCopy = nullptr;
+            }
+        });
+
+    ModelFile* modelFilePtr = &modelFile;
+    const std::shared_ptr<MaterialParms> parms = std::make_shared<MaterialParms>(materialParms);
+    for (glTFImageLoad& load : imageLoads) {
+        uploadQueue.Push([modelFilePtr, load, parms]() {
+            CreateModelFileTexture(
+                modelFilePtr->Textures[load.textureIndex],
+                load.fileName.c_str(),
+                load.buffer,
+                load.size,
+                load.rgbaImage.get(),
+                load.rgbaWidth,
+                load.rgbaHeight,
+                *parms);
+        });
+    }
+    imageLoads.clear();
+}
+
+// Vertex and index data of a glTF primitive, decoded on the job pool before the
+// meshes are built.
+struct glTFPrimitiveData {
+    glTFPrimitiveData(const OVR::JsonReader& primitive_) : primitive(primitive_), loaded(true) {}
+
+    OVR::JsonReader primitive;
+    VertexAttribs attribs;
+    std::vector<VertexAttribs> targets;
+    std::vector<uint32_t> indices; // GlGeometry::Create picks the index size
+    std::vector<GlGeometry::Descriptor> meshlets; // one per surface if the primitive was split
+    bool loaded;
+};
+
+static void DecodePrimitive(
+    ModelFile& modelFile,
+    glTFPrimitiveData& data,
+    const MaterialParms& materialParms) {
+    const OVR::JsonReader primitive(data.primitive);
+    bool& loaded = data.loaded;
+
+    // VERTICES
+    const OVR::JsonReader attributes(primitive.GetChildByName("attributes"));
+    if (!attributes.IsObject()) {
+        loaded = false;
+        return;
+    }
+    loaded = ReadVertexAttributes(attributes, modelFile, data.attribs, false /*isMorphTarget*/);
+
+    // MORPH TARGETS
+    const OVR::JsonReader targets(primitive.GetChildByName("targets"));
+    if (targets.IsValid()) {
+        if (!targets.IsArray()) {
+            ALOGW("Error: Invalid targets on primitive");
+            loaded = false;
+        }
+
+        while (!targets.IsEndOfArray() && loaded) {
+            const OVR::JsonReader target(targets.GetNextArrayElement());
+            VertexAttribs targetAttribs;
+            loaded = ReadVertexAttributes(target, modelFile, targetAttribs, true /*isMorphTarget*/);
+            if (loaded) {
+                // for each morph target attribute, an original
+                // attribute MUST be present in the mesh primitive
+#define CHECK_ATTRIB_COUNT(ATTRIB)                                        \
+    if (!targetAttribs.ATTRIB.empty() &&                                  \
+        targetAttribs.ATTRIB.size() != data.attribs.ATTRIB.size()) {      \
+        ALOGW("Error: target " #ATTRIB " count mismatch on gltfPrimitive"); \
+        loaded = false;                                                   \
+    }
+                CHECK_ATTRIB_COUNT(position);
+                CHECK_ATTRIB_COUNT(normal);
+                CHECK_ATTRIB_COUNT(tangent);
+                CHECK_ATTRIB_COUNT(color);
+                CHECK_ATTRIB_COUNT(uv0);
+                CHECK_ATTRIB_COUNT(uv1);
+#undef CHECK_ATTRIB_COUNT
+                data.targets.emplace_back(std::move(targetAttribs));
+            }
+        }
+    }
+
+    // TRIANGLES
+    const int indicesIndex = primitive.GetChildInt32ByName("indices", -1);
+    if (loaded && indicesIndex >= 0 &&
+        indicesIndex < static_cast<int>(modelFile.Accessors.size())) {
+        ReadSurfaceDataFromAccessor(
+            data.indices, modelFile, indicesIndex, ACCESSOR_SCALAR, GL_UNSIGNED_INT, -1, false);
+    }
+
+    // only triangle lists
+    if (loaded && materialParms.OptimizeGeometry && !data.indices.empty() &&
+        primitive.GetChildInt32ByName("mode", 4) == 4) {
+        ovrVertexCacheStats before;
+        ovrVertexCacheStats after;
+        OptimizeGeometry(
+            data.attribs,
+            data.indices,
+            &data.targets,
+            materialParms.OptimizeOverdraw,
+            &before,
+            &after);
+        ALOG(
+            "OptimizeGeometry: %d triangles, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+            static_cast<int>(data.indices.size() / 3),
+            before.acmr,
+            after.acmr,
+            before.atvr,
+            after.atvr);
+    }
+
+    // Morph targets and skinning need the original vertices, so those primitives stay whole.
+    if (loaded && materialParms.MeshletMaxVertices > 0 && !data.indices.empty() &&
+        data.targets.empty() && data.attribs.jointIndices.empty() &&
+        primitive.GetChildInt32ByName("mode", 4) == 4 &&
+        static_cast<int>(data.attribs.position.size()) > materialParms.MeshletMaxVertices) {
+        data.meshlets = BuildMeshletDescriptors(
+            data.attribs,
+            data.indices,
+            materialParms.MeshletMaxVertices,
+            materialParms.MeshletMaxVertices * 2);
+        ALOG(
+            "BuildMeshletDescriptors: %d vertices split into %d clusters",
+            static_cast<int>(data.attribs.position.size()),
+            static_cast<int>(data.meshlets.size()));
+    }
+}
+
+// Creates the geometry of a surface on the GL thread, from the whole primitive or from one
+// of its clusters, and binds the material textures.
+static void CreatePrimitiveSurface(
+    ModelSurface& surface,
+    glTFPrimitiveData& data,
+    const int cluster,
+    const VertexLayout& geometryLayout) {
+    if (data.meshlets.empty()) {
+        surface.surfaceDef.geo.Create(data.attribs, data.indices, geometryLayout);
+    } else {
+        GlGeometry::Descriptor& meshlet = data.meshlets[cluster];
+        surface.surfaceDef.geo.Create(meshlet.attribs, meshlet.indices, geometryLayout);
+        meshlet = GlGeometry::Descriptor();
+    }
+
+    const ModelMaterial* material = surface.material;
+    ovrGraphicsCommand& gc = surface.surfaceDef.graphicsCommand;
+    if (material->baseColorTextureWrapper != nullptr) {
+        gc.Textures[0] = material->baseColorTextureWrapper->image->texid;
+        if (material->emissiveTextureWrapper != nullptr) {
+            gc.Textures[1] = material->emissiveTextureWrapper->image->texid;
+        } else if (material->detailTextureWrapper != nullptr) {
+            gc.Textures[1] = material->detailTextureWrapper->image->texid;
+        }
+    }
+
+    // Retain original vertex data if we use morph targets
+    if (!surface.targets.empty()) {
+        surface.attribs = std::move(data.attribs);
+    } else {
+        data.attribs = VertexAttribs();
+    }
+    data.indices = std::vector<uint32_t>();
+}
+
+// Decodes all primitives of all meshes, in the order the mesh loop visits them.
+static std::shared_ptr<std::vector<glTFPrimitiveData>> DecodePrimitives(
+    ModelFile& modelFile,
+    const OVR::JsonReader& meshes,
+    const MaterialParms& materialParms) {
+    std::shared_ptr<std::vector<glTFPrimitiveData>> primitiveData =
+        std::make_shared<std::vector<glTFPrimitiveData>>();
+    if (meshes.IsArray()) {
+        while (!meshes.IsEndOfArray()) {
+            const OVR::JsonReader mesh(meshes.GetNextArrayElement());
+            if (mesh.IsObject()) {
+                const OVR::JsonReader primitives(mesh.GetChildByName("primitives"));
+                if (primitives.IsArray()) {
+                    while (!primitives.IsEndOfArray()) {
+                        primitiveData->emplace_back(primitives.GetNextArrayElement());
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<glTFPrimitiveData>& data = *primitiveData;
+    ovrJobPool::ParallelFor(
+        materialParms.JobPool,
+        static_cast<int>(data.size()),
+        [&modelFile, &data, &materialParms](const int i) {
+            DecodePrimitive(modelFile, data[i], materialParms);
+            // don't keep the json alive until the geometry is uploaded
+            data[i].primitive = OVR::JsonReader(nullptr);
+        });
+    return primitiveData;
+}
+
+// Hands the GL work of a loaded model to the caller's queue, or runs it right away.
+static void FinishModelFileUploads(
+    ovrGlUploadQueue& uploadQueue,
+    const bool loaded,
+    const MaterialParms& materialParms) {
+    if (!loaded) {
+        // the model is about to be deleted
+        uploadQueue.Clear();
+    } else if (materialParms.UploadQueue != nullptr) {
+        materialParms.UploadQueue->Append(uploadQueue);
+    } else {
+        uploadQueue.DrainAll();
+    }
+}
+
 // Requires the buffers and images to already be loaded in the model
 bool LoadModelFile_glTF_Json(
     ModelFile& modelFile,
     const char* modelsJson,
     const ModelGlPrograms& programs,
     const MaterialParms& materialParms,
+    ovrGlUploadQueue& uploadQueue,
     ModelGeo* outModelGeo) {
     ALOG("LoadModelFile_glTF_Json parsing %s", modelFile.FileName.c_str());
     // LOGCPUTIME( "LoadModelFile_glTF_Json" );
@@ -1013,6 +1469,12 @@ bool LoadModelFile_glTF_Json(
 
             if (loaded) { // MODELS (gltf mesh)
                 LOGV("Loading meshes");
+                // Decode the vertex data of all primitives in parallel, the GL geometry is
+                // created later through the upload queue.
+                std::shared_ptr<std::vector<glTFPrimitiveData>> primitiveData = DecodePrimitives(
+                    modelFile, OVR::JsonReader(models.GetChildByName("meshes")), materialParms);
+                int primitiveIndex = 0;
+
                 const OVR::JsonReader meshes(models.GetChildByName("meshes"));
                 if (meshes.IsArray()) {
                     while (!meshes.IsEndOfArray() && loaded) {
@@ -1076,58 +1538,26 @@ bool LoadModelFile_glTF_Json(
                                         loaded = false;
                                     }
 
-                                    TriangleIndex outGeoIndexOffset = 0;
+                                    uint32_t outGeoIndexOffset = 0;
                                     if (outModelGeo != nullptr) {
-                                        outGeoIndexOffset = static_cast<TriangleIndex>(
+                                        outGeoIndexOffset = static_cast<uint32_t>(
                                             (*outModelGeo).positions.size());
                                     }
 
-                                    // VERTICES
-                                    VertexAttribs attribs;
-                                    loaded = ReadVertexAttributes(
-                                        attributes, modelFile, attribs, false /*isMorphTarget*/);
-
-                                    // MORPH TARGETS
-                                    const OVR::JsonReader targets(
-                                        primitive.GetChildByName("targets"));
-                                    if (targets.IsValid()) {
-                                        if (!targets.IsArray()) {
-                                            ALOGW("Error: Invalid targets on primitive");
-                                            loaded = false;
-                                        }
-
-                                        while (!targets.IsEndOfArray() && loaded) {
-                                            const OVR::JsonReader target(
-                                                targets.GetNextArrayElement());
-                                            VertexAttribs targetAttribs;
-                                            loaded = ReadVertexAttributes(
-                                                target,
-                                                modelFile,
-                                                targetAttribs,
-                                                true /*isMorphTarget*/);
-                                            if (loaded) {
-                                                // for each morph target attribute, an original
-                                                // attribute MUST be present in the mesh primitive
-#define CHECK_ATTRIB_COUNT(ATTRIB)                                                               \
-    if (!targetAttribs.ATTRIB.empty() && targetAttribs.ATTRIB.size() != attribs.ATTRIB.size()) { \
-        ALOGW("Error: target " #ATTRIB " count mismatch on gltfPrimitive");                      \
-        loaded = false;                                                                          \
-    }
-                                                CHECK_ATTRIB_COUNT(position);
-                                                CHECK_ATTRIB_COUNT(normal);
-                                                CHECK_ATTRIB_COUNT(tangent);
-                                                CHECK_ATTRIB_COUNT(color);
-                                                CHECK_ATTRIB_COUNT(uv0);
-                                                CHECK_ATTRIB_COUNT(uv1);
-#undef CHECK_ATTRIB_COUNT
-                                                newGltfSurface.targets.emplace_back(
-                                                    std::move(targetAttribs));
-                                            }
+                                    // VERTICES, MORPH TARGETS and TRIANGLES were decoded up front
+                                    glTFPrimitiveData& data = (*primitiveData)[primitiveIndex];
+                                    const VertexAttribs& attribs = data.attribs;
+                                    const std::vector<uint32_t>& indices = data.indices;
+                                    loaded = data.loaded;
+                                    if (outModelGeo != nullptr) {
+                                        for (int i = 0;
+                                             i < static_cast<int>(attribs.position.size());
+                                             ++i) {
+                                            (*outModelGeo).positions.push_back(attribs.position[i]);
                                         }
                                     }
+                                    newGltfSurface.targets = std::move(data.targets);
 
-                                    // TRIANGLES
-                                    std::vector<TriangleIndex> indices;
                                     const int indicesIndex =
                                         primitive.GetChildInt32ByName("indices", -1);
                                     if (indicesIndex < 0 ||
@@ -1137,28 +1567,6 @@ bool LoadModelFile_glTF_Json(
                                         loaded = false;
                                     }
 
-                                    // Reduced severity to warning: this doesn't break most data
-                                    // types, but can cause unexpected results.
-                                    if (modelFile.Accessors[indicesIndex].componentType !=
-                                        GL_UNSIGNED_SHORT) {
-                                        ALOGW(
-                                            "Warning: Currently, only componentType of %d supported for indices, %d requested",
-                                            GL_UNSIGNED_SHORT,
-                                            modelFile.Accessors[indicesIndex].componentType);
-                                    }
-
-                                    if (loaded) {
-                                        ReadSurfaceDataFromAccessor(
-                                            indices,
-                                            modelFile,
-                                            primitive.GetChildInt32ByName("indices", -1),
-                                            ACCESSOR_SCALAR,
-                                            GL_UNSIGNED_SHORT,
-                                            -1,
-                                            false);
-                                    }
-
-                                    newGltfSurface.surfaceDef.geo.Create(attribs, indices);
                                     bool skinned =
                                         (attribs.jointIndices.size() == attribs.position.size() &&
                                          attribs.jointWeights.size() == attribs.position.size());
@@ -1224,17 +1632,11 @@ bool LoadModelFile_glTF_Json(
 
                                     if (newGltfSurface.material->baseColorTextureWrapper !=
                                         nullptr) {
-                                        newGltfSurface.surfaceDef.graphicsCommand.Textures[0] =
-                                            newGltfSurface.material->baseColorTextureWrapper->image
-                                                ->texid;
                                         if (newGltfSurface.material->emissiveTextureWrapper !=
                                             nullptr) {
                                             if (programs.ProgBaseColorEmissivePBR == nullptr) {
                                                 ALOGE_FAIL("No ProgBaseColorEmissivePBR set");
                                             }
-                                            newGltfSurface.surfaceDef.graphicsCommand.Textures[1] =
-                                                newGltfSurface.material->emissiveTextureWrapper
-                                                    ->image->texid;
                                             if (skinned) {
                                                 if (programs.ProgSkinnedBaseColorEmissivePBR ==
                                                     nullptr) {
@@ -1253,14 +1655,6 @@ bool LoadModelFile_glTF_Json(
                                                     "ProgBaseColorEmissivePBR";
                                             }
                                         } else {
-                                            if (newGltfSurface.material->detailTextureWrapper !=
-                                                nullptr) {
-                                                newGltfSurface.surfaceDef.graphicsCommand
-                                                    .Textures[1] =
-                                                    newGltfSurface.material->detailTextureWrapper
-                                                        ->image->texid;
-                                            }
-
                                             if (skinned) {
                                                 if (programs.ProgSkinnedBaseColorPBR == nullptr) {
                                                     ALOGE_FAIL("No ProgSkinnedBaseColorPBR set");
@@ -1308,11 +1702,41 @@ bool LoadModelFile_glTF_Json(
                                             .cullEnable = false;
                                     }
 
-                                    // Retain original vertex data if we use morph targets
-                                    if (!newGltfSurface.targets.empty()) {
-                                        newGltfSurface.attribs = std::move(attribs);
+                                    // The geometry and texture bindings are filled in after the
+                                    // textures pushed to the upload queue earlier are created.
+                                    // A split primitive gets a surface per cluster, which all
+                                    // share the material and state.
+                                    ModelFile* modelFilePtr = &modelFile;
+                                    const int modelIndex = static_cast<int>(modelFile.Models.size());
+                                    const VertexLayout geometryLayout =
+                                        materialParms.GeometryLayout;
+                                    const int numClusters =
+                                        std::max(1, static_cast<int>(data.meshlets.size()));
+                                    for (int cluster = 0; cluster < numClusters; cluster++) {
+                                        const int surfaceIndex =
+                                            static_cast<int>(newGltfModel.surfaces.size());
+                                        uploadQueue.Push([modelFilePtr,
+                                                          modelIndex,
+                                                          surfaceIndex,
+                                                          primitiveData,
+                                                          primitiveIndex,
+                                                          cluster,
+                                                          geometryLayout]() {
+                                            CreatePrimitiveSurface(
+                                                modelFilePtr->Models[modelIndex]
+                                                    .surfaces[surfaceIndex],
+                                                (*primitiveData)[primitiveIndex],
+                                                cluster,
+                                                geometryLayout);
+                                        });
+                                        if (cluster + 1 < numClusters) {
+                                            newGltfModel.surfaces.push_back(newGltfSurface);
+                                        } else {
+                                            newGltfModel.surfaces.emplace_back(
+                                                std::move(newGltfSurface));
+                                        }
                                     }
-                                    newGltfModel.surfaces.emplace_back(std::move(newGltfSurface));
+                                    primitiveIndex++;
                                 }
                             } // END SURFACES
 
@@ -2138,6 +2562,7 @@ bool LoadModelFile_glTF_OvrScene(
     const MaterialParms& materialParms,
     ModelGeo* outModelGeo) {
     ModelFile& modelFile = *modelFilePtr;
+    ovrGlUploadQueue uploadQueue;
 
     // Since we are doing a zip file, we are going to parse through the zip file many times to find
     // the different data points.
@@ -2289,6 +2714,7 @@ bool LoadModelFile_glTF_OvrScene(
             if (loaded) { // IMAGES
                 // LOGCPUTIME( "Loading image textures" );
                 // gather all the images, and try to load them from the zip file.
+                std::vector<glTFImageLoad> imageLoads;
                 const OVR::JsonReader images(models.GetChildByName("images"));
                 if (images.IsArray()) {
                     while (!images.IsEndOfArray()) {
@@ -2302,8 +2728,8 @@ bool LoadModelFile_glTF_OvrScene(
                                 ALOGW(
                                     "Loading images from bufferView currently unsupported, defaulting image");
                                 // Create a default texture.
-                                LoadModelFileTexture(
-                                    modelFile, "DefaultImage", nullptr, 0, materialParms);
+                                AddImageLoad(
+                                    modelFile, imageLoads, "DefaultImage", nullptr, 0, false);
                             } else {
                                 // check to make sure the image is ktx.
                                 if (OVR::OVR_stricmp(uri.c_str() + (uri.length() - 4), ".ktx") !=
@@ -2319,29 +2745,34 @@ bool LoadModelFile_glTF_OvrScene(
                                         zfp, uri.c_str(), bufferLength, (const uint8_t*)fileData);
                                     const char* imageName = uri.c_str();
 
-                                    LoadModelFileTexture(
+                                    // the zip data may be gone by the time the image is decoded
+                                    AddImageLoad(
                                         modelFile,
+                                        imageLoads,
                                         imageName,
                                         (const char*)buffer,
                                         bufferLength,
-                                        materialParms);
+                                        true);
                                 } else {
                                     int bufferLength = 0;
                                     uint8_t* buffer = ReadFileBufferFromZipFile(
                                         zfp, uri.c_str(), bufferLength, (const uint8_t*)fileData);
                                     const char* imageName = uri.c_str();
 
-                                    LoadModelFileTexture(
+                                    // the zip data may be gone by the time the image is decoded
+                                    AddImageLoad(
                                         modelFile,
+                                        imageLoads,
                                         imageName,
                                         (const char*)buffer,
                                         bufferLength,
-                                        materialParms);
+                                        true);
                                 }
                             }
                         }
                     }
                 }
+                LoadImages(modelFile, imageLoads, materialParms, uploadQueue);
             } // END images
             // End of section dependent on zip file.
         } else {
@@ -2350,11 +2781,13 @@ bool LoadModelFile_glTF_OvrScene(
         }
 
         if (loaded) {
-            loaded =
-                LoadModelFile_glTF_Json(modelFile, gltfJson, programs, materialParms, outModelGeo);
+            loaded = LoadModelFile_glTF_Json(
+                modelFile, gltfJson, programs, materialParms, uploadQueue, outModelGeo);
         }
     }
 
+    FinishModelFileUploads(uploadQueue, loaded, materialParms);
+
     if (gltfJson != nullptr && (gltfJson < fileData || gltfJson > fileData + fileDataLength)) {
         delete gltfJson;
     }
@@ -2368,11 +2801,13 @@ ModelFile* LoadModelFile_glB(
     const int fileDataLength,
     const ModelGlPrograms& programs,
     const MaterialParms& materialParms,
-    ModelGeo* outModelGeo) {
+    ModelGeo* outModelGeo,
+    const std::shared_ptr<const void>& fileDataOwner) {
     // LOGCPUTIME( "LoadModelFile_glB" );
 
     ModelFile* modelFilePtr = new ModelFile;
     ModelFile& modelFile = *modelFilePtr;
+    ovrGlUploadQueue uploadQueue;
 
     modelFile.FileName = fileName;
     modelFile.UsingSrgbTextures = materialParms.UseSrgbTextureFormats;
@@ -2514,13 +2949,19 @@ ModelFile* LoadModelFile_glB(
                                     loaded = false;
                                 }
 
-                                // ensure the buffer is aligned.
-                                size_t alignedBufferSize = (bufferLength / 4 + 1) * 4;
-                                newGltfBuffer.bufferData.resize(alignedBufferSize);
-                                memcpy(
-                                    newGltfBuffer.bufferData.data(),
-                                    buffer,
-                                    newGltfBuffer.byteLength);
+                                if (materialParms.UseBuffersInPlace) {
+                                    // glB chunks are 4 byte aligned in the file
+                                    newGltfBuffer.externalData = (const uint8_t*)buffer;
+                                    newGltfBuffer.externalOwner = fileDataOwner;
+                                } else {
+                                    // ensure the buffer is aligned.
+                                    size_t alignedBufferSize = (bufferLength / 4 + 1) * 4;
+                                    newGltfBuffer.bufferData.resize(alignedBufferSize);
+                                    memcpy(
+                                        newGltfBuffer.bufferData.data(),
+                                        buffer,
+                                        newGltfBuffer.byteLength);
+                                }
 
                                 const char* bufferName;
                                 if (name.length() > 0) {
@@ -2581,6 +3022,7 @@ ModelFile* LoadModelFile_glB(
                 if (loaded) { // IMAGES
                     LOGV("Loading image textures");
                     // gather all the images, and try to load them from the zip file.
+                    std::vector<glTFImageLoad> imageLoads;
                     const OVR::JsonReader images(models.GetChildByName("images"));
                     if (images.IsArray()) {
                         while (!images.IsEndOfArray()) {
@@ -2600,9 +3042,8 @@ ModelFile* LoadModelFile_glB(
                                     ModelBufferView* pBufferView =
                                         &modelFile.BufferViews[bufferView];
                                     int imageBufferLength = (int)pBufferView->byteLength;
-                                    uint8_t* imageBuffer =
-                                        (uint8_t*)pBufferView->buffer->bufferData.data() +
-                                        pBufferView->byteOffset;
+                                    const uint8_t* imageBuffer =
+                                        pBufferView->buffer->GetData() + pBufferView->byteOffset;
 
                                     std::string path = name;
                                     const char* ext = strrchr(mimeType.c_str(), '/');
@@ -2611,12 +3052,13 @@ ModelFile* LoadModelFile_glB(
                                         path += ext + 1;
                                     }
 
-                                    LoadModelFileTexture(
+                                    AddImageLoad(
                                         modelFile,
+                                        imageLoads,
                                         path.c_str(),
                                         (const char*)imageBuffer,
                                         imageBufferLength,
-                                        materialParms);
+                                        false);
                                 } else if (
                                     materialParms.ImageUriHandler &&
                                     materialParms.ImageUriHandler(modelFile, uri)) {
@@ -2625,12 +3067,13 @@ ModelFile* LoadModelFile_glB(
                                     ALOGW(
                                         "Loading images from othen then bufferView currently unsupported in glBfd, defaulting image");
                                     // Create a default texture.
-                                    LoadModelFileTexture(
-                                        modelFile, "DefaultImage", nullptr, 0, materialParms);
+                                    AddImageLoad(
+                                        modelFile, imageLoads, "DefaultImage", nullptr, 0, false);
                                 }
                             }
                         }
                     }
+                    LoadImages(modelFile, imageLoads, materialParms, uploadQueue);
                 } // END images
 
                 // End of section dependent on buffer data in the glB file.
@@ -2638,11 +3081,13 @@ ModelFile* LoadModelFile_glB(
         }
 
         if (loaded) {
-            loaded =
-                LoadModelFile_glTF_Json(modelFile, gltfJson, programs, materialParms, outModelGeo);
+            loaded = LoadModelFile_glTF_Json(
+                modelFile, gltfJson, programs, materialParms, uploadQueue, outModelGeo);
         }
     }
 
+    FinishModelFileUploads(uploadQueue, loaded, materialParms);
+
     // delete fileData;
 
     if (!loaded) {
@@ -26,8 +26,10 @@ Authors     :   John Carmack
 ************************************************************************************/
 
 #include "ModelRender.h"
+#include "ModelCulling.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <algorithm>
 
 #include "Misc/Log.h"
@@ -41,135 +43,50 @@ using OVR::Vector4f;
 
 namespace OVRFW {
 
-// Returns 0 if the bounds is culled by the mvp, otherwise returns the max W
-// value of the bounds corners so it can be sorted into roughly front to back
-// order for more efficient Z cull.  Sorting bounds in increasing order of
-// their farthest W value usually makes characters and objects draw before
-// the environments they are in, and draws sky boxes last, which is what we want.
-static float BoundsSortCullKey(const Bounds3f& bounds, const Matrix4f& mvp) {
-    // Always cull empty bounds, which can be used to disable a surface.
-    // Don't just check a single axis, or billboards would be culled.
-    if (bounds.b[1].x == bounds.b[0].x && bounds.b[1].y == bounds.b[0].y) {
-        return 0;
-    }
-
-    // Not very efficient code...
-    Vector4f c[8];
-    for (int i = 0; i < 8; i++) {
-        Vector4f world;
-        world.x = bounds.b[(i & 1)].x;
-        world.y = bounds.b[(i & 2) >> 1].y;
-        world.z = bounds.b[(i & 4) >> 2].z;
-        world.w = 1.0f;
-
-        c[i] = mvp.Transform(world);
-    }
-
-    int i;
-    for (i = 0; i < 8; i++) {
-        if (c[i].x > -c[i].w) {
-            break;
-        }
-    }
-    if (i == 8) {
-        return 0; // all off one side
-    }
-    for (i = 0; i < 8; i++) {
-        if (c[i].x < c[i].w) {
-            break;
-        }
-    }
-    if (i == 8) {
-        return 0; // all off one side
-    }
-
-    for (i = 0; i < 8; i++) {
-        if (c[i].y > -c[i].w) {
-            break;
-        }
-    }
-    if (i == 8) {
-        return 0; // all off one side
-    }
-    for (i = 0; i < 8; i++) {
-        if (c[i].y < c[i].w) {
-            break;
-        }
-    }
-    if (i == 8) {
-        return 0; // all off one side
-    }
+// Builds a 64 bit sort key, most significant first:
+// 1 bit transparency, 23 bits quantized far W, 16 bits material id.
+// Solid surfaces sort front-to-back, transparent surfaces back-to-front,
+// and all solid surfaces are rendered before any transparent one.
+static uint64_t SurfaceSortKey(const float farW, const ovrSurfaceDef& surfaceDef) {
+    const bool transparent =
+        (surfaceDef.graphicsCommand.GpuState.blendEnable != ovrGpuState::BLEND_DISABLE);
 
-    for (i = 0; i < 8; i++) {
-        if (c[i].z > -c[i].w) {
-            break;
-        }
+    // The bit pattern of a non-negative float increases monotonically with its value,
+    // so dropping the low mantissa bits quantizes the depth while keeping its order.
+    uint32_t depthBits = 0;
+    if (farW > 0.0f) {
+        memcpy(&depthBits, &farW, sizeof(depthBits));
     }
-    if (i == 8) {
-        return 0; // all off one side
-    }
-    for (i = 0; i < 8; i++) {
-        if (c[i].z < c[i].w) {
-            break;
-        }
-    }
-    if (i == 8) {
-        return 0; // all off one side
-    }
-
-    // calculate the farthest W point for front to back sorting
-    float maxW = 0;
-    for (i = 0; i < 8; i++) {
-        const float w = c[i].w;
-        if (w > maxW) {
-            maxW = w;
-        }
+    uint64_t depth = depthBits >> 8;
+    if (transparent) {
+        depth = 0x7FFFFF - depth;
     }
+    const uint64_t materialId = surfaceDef.graphicsCommand.Program.Program & 0xFFFF;
 
-    return maxW; // couldn't cull
+    return (static_cast<uint64_t>(transparent) << 63) | (depth << 40) | (materialId << 24);
 }
 
-struct bsort_t {
-    float key;
-    Matrix4f modelMatrix;
-    const std::vector<Matrix4f>* joints;
-    const ovrSurfaceDef* surface;
-    bool transparent;
-
-    bool operator<(const bsort_t& b2) const {
-        const bsort_t& b1 = *this;
-        bool trans1 = b1.transparent;
-        bool trans2 = b2.transparent;
-        if (trans1 == trans2) {
-            float f1 = b1.key;
-            float f2 = b2.key;
-            if (!trans1) {
-                // both are solid, sort front-to-back
-                return (f1 < f2);
-            } else {
-                // both are transparent, sort back-to-front
-                return (f2 < f1);
-            }
-        }
-        // otherwise, one is solid and one is translucent... the solid is always rendered first
-        return !trans1;
-    };
-};
-
 void BuildModelSurfaceList(
     std::vector<ovrDrawSurface>& surfaceList,
     const std::vector<ModelNodeState*>& emitNodes,
     const std::vector<ovrDrawSurface>& emitSurfaces,
     const Matrix4f& viewMatrix,
-    const Matrix4f& projectionMatrix) {
-    // A mobile GPU will be in trouble if it draws more than this.
-    static const int MAX_DRAW_SURFACES = 1024;
-    bsort_t bsort[MAX_DRAW_SURFACES];
-
+    const Matrix4f& projectionMatrix,
+    ovrModelSurfaceSortList& sortList) {
     const Matrix4f vpMatrix = projectionMatrix * viewMatrix;
 
-    int numSurfaces = 0;
-
+    std::vector<ovrDrawSurface>& candidates = sortList.candidates;
+    std::vector<uint8_t>& cullable = sortList.cullable;
+    std::vector<Matrix4f>& mvps = sortList.mvps;
+    ovrBoundsCullList& cullList = sortList.cullList;
+    std::vector<ovrRadixSortItem>& sortItems = sortList.sortItems;
+    candidates.clear();
+    cullable.clear();
+    mvps.clear();
+    cullList.Clear();
+    sortItems.clear();
+
+    // Gather the bounds of every surface so they can be culled in a single batch.
     for (int nodeNum = 0; nodeNum < static_cast<int>(emitNodes.size()); nodeNum++) {
         const ModelNodeState& nodeState = *emitNodes[nodeNum];
         if (nodeState.GetNode() != NULL && nodeState.GetNode()->model != NULL) {
@@ -182,28 +99,16 @@ void BuildModelSurfaceList(
 
             if (nodeState.GetNode()->model != nullptr) {
                 const Model& modelDef = *nodeState.GetNode()->model;
+                const Matrix4f& modelMatrix = nodeState.GetGlobalTransform();
+                const int mvpIndex = static_cast<int>(mvps.size());
+                mvps.push_back(vpMatrix * modelMatrix);
                 for (int surfaceNum = 0; surfaceNum < static_cast<int>(modelDef.surfaces.size());
                      surfaceNum++) {
                     const ovrSurfaceDef& surfaceDef = modelDef.surfaces[surfaceNum].surfaceDef;
-                    const float sort = BoundsSortCullKey(
-                        surfaceDef.geo.localBounds, vpMatrix * nodeState.GetGlobalTransform());
-                    if (sort == 0) {
-                        if (allowCulling) {
-                            if (LogRenderSurfaces) {
-                                ALOG("Culled %s", surfaceDef.surfaceName.c_str());
-                            }
-                            continue;
-                        } else {
-                            if (LogRenderSurfaces) {
-                                ALOG("Skipped Culling of %s", surfaceDef.surfaceName.c_str());
-                            }
-                        }
+                    // geometry of a streamed model that hasn't been uploaded yet
+                    if (surfaceDef.geo.indexCount == 0) {
+                        continue;
                     }
-
-                    if (numSurfaces == MAX_DRAW_SURFACES) {
-                        break;
-                    }
-
                     /*
                                         // Update the Joint Uniform Buffer
                                         if ( nodeState.node->skinIndex >= 0 )
@@ -260,13 +165,9 @@ void BuildModelSurfaceList(
                                         }
                     */
 
-                    bsort[numSurfaces].key = sort;
-                    bsort[numSurfaces].modelMatrix = nodeState.GetGlobalTransform();
-                    bsort[numSurfaces].surface = &surfaceDef;
-                    bsort[numSurfaces].transparent =
-                        (surfaceDef.graphicsCommand.GpuState.blendEnable !=
-                         ovrGpuState::BLEND_DISABLE);
-                    numSurfaces++;
+                    cullList.Add(surfaceDef.geo.localBounds, mvpIndex);
+                    cullable.push_back(allowCulling ? 1 : 0);
+                    candidates.push_back(ovrDrawSurface(modelMatrix, &surfaceDef));
                 }
             }
         }
@@ -274,41 +175,57 @@ void BuildModelSurfaceList(
 
     for (int i = 0; i < static_cast<int>(emitSurfaces.size()); i++) {
         const ovrDrawSurface& drawSurf = emitSurfaces[i];
-        const ovrSurfaceDef& surfaceDef = *drawSurf.surface;
-        const float sort =
-            BoundsSortCullKey(surfaceDef.geo.localBounds, vpMatrix * drawSurf.modelMatrix);
+        cullList.Add(drawSurf.surface->geo.localBounds, static_cast<int>(mvps.size()));
+        mvps.push_back(vpMatrix * drawSurf.modelMatrix);
+        cullable.push_back(1);
+        candidates.push_back(drawSurf);
+    }
+
+    BoundsSortCullKeys(cullList, mvps.data(), sortList.cullKeys);
+
+    for (int i = 0; i < static_cast<int>(candidates.size()); i++) {
+        const ovrSurfaceDef& surfaceDef = *candidates[i].surface;
+        const float sort = sortList.cullKeys[i];
         if (sort == 0) {
-            if (LogRenderSurfaces) {
-                ALOG("Culled %s", surfaceDef.surfaceName.c_str());
+            if (cullable[i]) {
+                if (LogRenderSurfaces) {
+                    ALOG("Culled %s", surfaceDef.surfaceName.c_str());
+                }
+                continue;
+            } else {
+                if (LogRenderSurfaces) {
+                    ALOG("Skipped Culling of %s", surfaceDef.surfaceName.c_str());
+                }
             }
-            continue;
         }
 
-        if (numSurfaces == MAX_DRAW_SURFACES) {
-            break;
-        }
-
-        bsort[numSurfaces].key = sort;
-        bsort[numSurfaces].modelMatrix = drawSurf.modelMatrix;
-        bsort[numSurfaces].surface = &surfaceDef;
-        bsort[numSurfaces].transparent =
-            (surfaceDef.graphicsCommand.GpuState.blendEnable != ovrGpuState::BLEND_DISABLE);
-        numSurfaces++;
+        sortItems.push_back({SurfaceSortKey(sort, surfaceDef), static_cast<uint32_t>(i)});
     }
 
     // sort by the far W and transparency
-    // IMPORTANT: use a stable sort so surfaces with identical bounds
+    // IMPORTANT: the radix sort is stable so surfaces with identical keys
     // will sort consistently from frame to frame, rather than randomly
     // as happens with qsort.
-    std::stable_sort(bsort, bsort + numSurfaces);
+    RadixSort(sortItems, sortList.sortScratch);
 
     // ----TODO_DRAWEYEVIEW : don't overwrite surfaces which may have already been added to the
     // surfaceList.
+    const int numSurfaces = static_cast<int>(sortItems.size());
     surfaceList.resize(numSurfaces);
     for (int i = 0; i < numSurfaces; i++) {
-        surfaceList[i].modelMatrix = bsort[i].modelMatrix;
-        surfaceList[i].surface = bsort[i].surface;
+        surfaceList[i] = candidates[sortItems[i].value];
     }
 }
 
+void BuildModelSurfaceList(
+    std::vector<ovrDrawSurface>& surfaceList,
+    const std::vector<ModelNodeState*>& emitNodes,
+    const std::vector<ovrDrawSurface>& emitSurfaces,
+    const Matrix4f& viewMatrix,
+    const Matrix4f& projectionMatrix) {
+    static thread_local ovrModelSurfaceSortList sortList;
+    BuildModelSurfaceList(
+        surfaceList, emitNodes, emitSurfaces, viewMatrix, projectionMatrix, sortList);
+}
+
 } // namespace OVRFW
@@ -29,15 +29,41 @@ Authors     :   John Carmack
 
 #include "OVR_Math.h"
 #include "Render/SurfaceRender.h"
+#include "Render/RadixSort.h"
 #include "ModelFile.h"
+#include "ModelCulling.h"
 
 #include <vector>
 
 namespace OVRFW {
-// The model surfaces are culled and added to the sorted surface list.
+
+// Frame-persistent storage for BuildModelSurfaceList.  Keeping one of these
+// alive across frames lets it grow to the size of the scene once, after which
+// building the surface list does not allocate.
+struct ovrModelSurfaceSortList {
+    std::vector<ovrDrawSurface> candidates; // all emitted surfaces, in emit order
+    std::vector<uint8_t> cullable; // false for surfaces whose bounds are not reliable
+    std::vector<OVR::Matrix4f> mvps; // one per node or emit surface
+    ovrBoundsCullList cullList; // bounds of each candidate
+    std::vector<float> cullKeys; // 0 if culled, otherwise the far W of each candidate
+    std::vector<ovrRadixSortItem> sortItems; // sort key and candidate index
+    std::vector<ovrRadixSortItem> sortScratch;
+};
+
+// The model surfaces are culled one by one and added to the sorted surface list, so meshes
+// split into clusters with MaterialParms::MeshletMaxVertices are culled per cluster.
 // Application specific surfaces from the emit list are also added to the sorted surface list.
 // The surface list is sorted such that opaque surfaces come first, sorted front-to-back,
 // and transparent surfaces come last, sorted back-to-front.
+void BuildModelSurfaceList(
+    std::vector<ovrDrawSurface>& surfaceList,
+    const std::vector<ModelNodeState*>& emitNodes,
+    const std::vector<ovrDrawSurface>& emitSurfaces,
+    const OVR::Matrix4f& viewMatrix,
+    const OVR::Matrix4f& projectionMatrix,
+    ovrModelSurfaceSortList& sortList);
+
+// Same as above, using storage owned by the calling thread.
 void BuildModelSurfaceList(
     std::vector<ovrDrawSurface>& surfaceList,
     const std::vector<ModelNodeState*>& emitNodes,
@@ -173,7 +173,7 @@ bool ModelTrace::Validate(const bool fullVerify) const {
     invalid |= header.numNodes != static_cast<int>(nodes.size());
     invalid |= header.numLeafs != static_cast<int>(leafs.size());
     invalid |= header.numOverflow != static_cast<int>(overflow.size());
-    if (!invalid) {
+    if (invalid) {
         ALOG("ModelTrace::Verify - invalid header");
         return false;
     }
@@ -59,6 +59,27 @@ struct kdtree_leaf_t {
     OVR::Bounds3f bounds;
 };
 
+// Returns true if the ray intersects the bounds, with the entry and exit distances in t0 and t1.
+bool Intersect_RayBounds(
+    const OVR::Vector3f& rayStart,
+    const OVR::Vector3f& rayDir,
+    const OVR::Vector3f& mins,
+    const OVR::Vector3f& maxs,
+    float& t0,
+    float& t1);
+
+// Returns true if the ray hits the front face of the triangle, with the distance
+// along the ray in t0 and the barycentric coordinates in u and v.
+bool Intersect_RayTriangle(
+    const OVR::Vector3f& rayStart,
+    const OVR::Vector3f& rayDir,
+    const OVR::Vector3f& v0,
+    const OVR::Vector3f& v1,
+    const OVR::Vector3f& v2,
+    float& t0,
+    float& u,
+    float& v);
+
 struct traceResult_t {
     int triangleIndex;
     float fraction;
@@ -0,0 +1,638 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   ModelTraceBvh.cpp
+Content     :   Ray tracer using a bounding volume hierarchy built at load time.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "ModelTraceBvh.h"
+
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+#include "Misc/Log.h"
+#include "ModelDef.h"
+
+#if defined(OVR_CPU_SSE) || defined(OVR_CPU_X86_64) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define OVR_BVH_SSE 1
+#elif defined(OVR_CPU_ARM_NEON) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define OVR_BVH_NEON 1
+#endif
+
+using OVR::Bounds3f;
+using OVR::Vector2f;
+using OVR::Vector3f;
+
+namespace OVRFW {
+
+static const int RT_BVH_SAH_BINS = 16;
+// Past this depth the builder switches to median splits, which keeps the
+// depth, and with it the traversal stack, bounded by RT_BVH_MAX_DEPTH.
+static const int RT_BVH_MEDIAN_SPLIT_DEPTH = RT_BVH_MAX_DEPTH / 2;
+
+static float SurfaceArea(const Bounds3f& bounds) {
+    const Vector3f size = bounds.GetSize();
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+static float SafeRcp(const float x) {
+    return (fabsf(x) > MATH_FLOAT_SMALLEST_NON_DENORMAL) ? (1.0f / x) : MATH_FLOAT_HUGE_NUMBER;
+}
+
+// Same slab test as Intersect_RayBounds, with the reciprocal direction hoisted out
+// of the traversal loop.
+static bool Intersect_RayNode(
+    const Bounds3f& bounds,
+    const Vector3f& rayStart,
+    const Vector3f& rcpDir,
+    const float maxDistance,
+    float& t0) {
+    const float sX = (bounds.b[0].x - rayStart.x) * rcpDir.x;
+    const float sY = (bounds.b[0].y - rayStart.y) * rcpDir.y;
+    const float sZ = (bounds.b[0].z - rayStart.z) * rcpDir.z;
+
+    const float tX = (bounds.b[1].x - rayStart.x) * rcpDir.x;
+    const float tY = (bounds.b[1].y - rayStart.y) * rcpDir.y;
+    const float tZ = (bounds.b[1].z - rayStart.z) * rcpDir.z;
+
+    t0 = std::max(std::min(sX, tX), std::max(std::min(sY, tY), std::min(sZ, tZ)));
+    const float t1 = std::min(std::max(sX, tX), std::min(std::max(sY, tY), std::max(sZ, tZ)));
+
+    return (t0 <= t1 && t1 >= 0.0f && t0 < maxDistance);
+}
+
+/*
+================================================================================
+
+Building
+
+================================================================================
+*/
+
+void ModelTraceBvh::Build(
+    const std::vector<Vector3f>& vertices_,
+    const std::vector<Vector2f>& uvs_,
+    const std::vector<int>& indices_) {
+    vertices = vertices_;
+    uvs = uvs_;
+    indices = indices_;
+    BuildHierarchy();
+}
+
+void ModelTraceBvh::Build(const ModelGeo& geo) {
+    vertices = geo.positions;
+    uvs.clear();
+    indices.resize(geo.indices.size());
+    for (int i = 0; i < static_cast<int>(geo.indices.size()); i++) {
+        indices[i] = geo.indices[i];
+    }
+    BuildHierarchy();
+}
+
+void ModelTraceBvh::Build(const ModelTrace& trace) {
+    Build(trace.vertices, trace.uvs, trace.indices);
+}
+
+void ModelTraceBvh::BuildHierarchy() {
+    nodes.clear();
+    triangles.clear();
+
+    const int numTriangles = static_cast<int>(indices.size()) / 3;
+    if (numTriangles == 0) {
+        return;
+    }
+
+    std::vector<Bounds3f> triBounds(numTriangles);
+    std::vector<Vector3f> triCenters(numTriangles);
+    triangles.resize(numTriangles);
+    for (int i = 0; i < numTriangles; i++) {
+        Bounds3f bounds(Bounds3f::Init);
+        bounds.AddPoint(vertices[indices[i * 3 + 0]]);
+        bounds.AddPoint(vertices[indices[i * 3 + 1]]);
+        bounds.AddPoint(vertices[indices[i * 3 + 2]]);
+        triBounds[i] = bounds;
+        triCenters[i] = bounds.GetCenter();
+        triangles[i] = i;
+    }
+
+    // a binary tree with at least one triangle per leaf never has more than 2n-1 nodes
+    nodes.reserve(numTriangles * 2 - 1);
+    BuildNode(triBounds, triCenters, 0, numTriangles, 0);
+}
+
+/*
+    On fast Construction of SAH-based Bounding Volume Hierarchies
+    Ingo Wald
+    IEEE Symposium on Interactive Ray Tracing, 2007
+*/
+int ModelTraceBvh::BuildNode(
+    const std::vector<Bounds3f>& triBounds,
+    const std::vector<Vector3f>& triCenters,
+    const int first,
+    const int count,
+    const int depth) {
+    const int nodeIndex = static_cast<int>(nodes.size());
+    nodes.push_back(bvh_node_t());
+
+    Bounds3f bounds(Bounds3f::Init);
+    Bounds3f centerBounds(Bounds3f::Init);
+    for (int i = first; i < first + count; i++) {
+        bounds = Bounds3f::Union(bounds, triBounds[triangles[i]]);
+        centerBounds.AddPoint(triCenters[triangles[i]]);
+    }
+    nodes[nodeIndex].bounds = bounds;
+
+    const Vector3f centerSize = centerBounds.GetSize();
+    const int longestAxis = (centerSize.x > centerSize.y)
+        ? ((centerSize.x > centerSize.z) ? 0 : 2)
+        : ((centerSize.y > centerSize.z) ? 1 : 2);
+
+    // All centers in one spot can't be split, so they end up in one, possibly large, leaf.
+    if (count <= RT_BVH_MAX_LEAF_TRIANGLES || centerSize[longestAxis] <= 0.0f) {
+        nodes[nodeIndex].data = first;
+        nodes[nodeIndex].count = count;
+        return nodeIndex;
+    }
+
+    int splitAxis = longestAxis;
+    int splitBin = -1;
+
+    if (depth < RT_BVH_MEDIAN_SPLIT_DEPTH) {
+        float bestCost = MATH_FLOAT_MAXVALUE;
+        for (int axis = 0; axis < 3; axis++) {
+            if (centerSize[axis] <= 0.0f) {
+                continue;
+            }
+            const float binScale = RT_BVH_SAH_BINS * 0.9999f / centerSize[axis];
+
+            Bounds3f binBounds[RT_BVH_SAH_BINS];
+            int binCounts[RT_BVH_SAH_BINS] = {};
+            for (int b = 0; b < RT_BVH_SAH_BINS; b++) {
+                binBounds[b].Clear();
+            }
+            for (int i = first; i < first + count; i++) {
+                const int t = triangles[i];
+                const int b =
+                    static_cast<int>((triCenters[t][axis] - centerBounds.b[0][axis]) * binScale);
+                binBounds[b] = Bounds3f::Union(binBounds[b], triBounds[t]);
+                binCounts[b]++;
+            }
+
+            // sweep from the right to get the cost of everything right of each split plane
+            float rightCost[RT_BVH_SAH_BINS];
+            Bounds3f rightBounds(Bounds3f::Init);
+            int rightCount = 0;
+            for (int b = RT_BVH_SAH_BINS - 1; b > 0; b--) {
+                rightBounds = Bounds3f::Union(rightBounds, binBounds[b]);
+                rightCount += binCounts[b];
+                rightCost[b] = (rightCount > 0) ? SurfaceArea(rightBounds) * rightCount : 0.0f;
+            }
+
+            Bounds3f leftBounds(Bounds3f::Init);
+            int leftCount = 0;
+            for (int b = 0; b < RT_BVH_SAH_BINS - 1; b++) {
+                leftBounds = Bounds3f::Union(leftBounds, binBounds[b]);
+                leftCount += binCounts[b];
+                if (leftCount == 0 || leftCount == count) {
+                    continue;
+                }
+                const float cost = SurfaceArea(leftBounds) * leftCount + rightCost[b + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    splitAxis = axis;
+                    splitBin = b;
+                }
+            }
+        }
+    }
+
+    int middle;
+    if (splitBin >= 0) {
+        const float binScale = RT_BVH_SAH_BINS * 0.9999f / centerSize[splitAxis];
+        const float binMin = centerBounds.b[0][splitAxis];
+        int* split = std::partition(
+            triangles.data() + first, triangles.data() + first + count, [&](const int t) {
+                return static_cast<int>((triCenters[t][splitAxis] - binMin) * binScale) <=
+                    splitBin;
+            });
+        middle = static_cast<int>(split - triangles.data());
+    } else {
+        middle = first + count / 2;
+        std::nth_element(
+            triangles.data() + first,
+            triangles.data() + middle,
+            triangles.data() + first + count,
+            [&](const int a, const int b) {
+                return triCenters[a][splitAxis] < triCenters[b][splitAxis];
+            });
+    }
+
+    // the left child is always stored right after its parent
+    BuildNode(triBounds, triCenters, first, middle - first, depth + 1);
+    const int right = BuildNode(triBounds, triCenters, middle, first + count - middle, depth + 1);
+
+    nodes[nodeIndex].data = right;
+    nodes[nodeIndex].count = -1 - splitAxis;
+    return nodeIndex;
+}
+
+/*
+================================================================================
+
+Tracing
+
+================================================================================
+*/
+
+void ModelTraceBvh::FinishResult(
+    traceResult_t& result,
+    const float distance,
+    const float rayLengthRcp,
+    const Vector2f& uv) const {
+    result.fraction = distance * rayLengthRcp;
+    // return default uvs if the model has no uvs
+    if (static_cast<int>(uvs.size()) == 0) {
+        result.uv = Vector2f(0.0f, 0.0f);
+    } else {
+        result.uv = uvs[indices[result.triangleIndex + 0]] * (1.0f - uv.x - uv.y) +
+            uvs[indices[result.triangleIndex + 1]] * uv.x +
+            uvs[indices[result.triangleIndex + 2]] * uv.y;
+    }
+    const Vector3f d1 =
+        vertices[indices[result.triangleIndex + 1]] - vertices[indices[result.triangleIndex + 0]];
+    const Vector3f d2 =
+        vertices[indices[result.triangleIndex + 2]] - vertices[indices[result.triangleIndex + 0]];
+    result.normal = d1.Cross(d2).Normalized();
+}
+
+traceResult_t ModelTraceBvh::Trace(const Vector3f& start, const Vector3f& end) const {
+    traceResult_t result;
+    result.triangleIndex = -1;
+    result.fraction = 1.0f;
+    result.uv = Vector2f(0.0f);
+    result.normal = Vector3f(0.0f);
+
+    if (nodes.empty()) {
+        return result;
+    }
+
+    const Vector3f rayDelta = end - start;
+    const float rayLengthSqr = rayDelta.LengthSq();
+    const float rayLengthRcp = OVR::RcpSqrt(rayLengthSqr);
+    const float rayLength = rayLengthSqr * rayLengthRcp;
+    const Vector3f rayStart = start;
+    const Vector3f rayDir = rayDelta * rayLengthRcp;
+    const Vector3f rcpDir(SafeRcp(rayDir.x), SafeRcp(rayDir.y), SafeRcp(rayDir.z));
+
+    float bestDistance = rayLength;
+    Vector2f uv;
+
+    struct stackEntry_t {
+        int node;
+        float distance;
+    };
+    stackEntry_t stack[RT_BVH_MAX_DEPTH];
+    int stackDepth = 0;
+
+    float rootDistance;
+    if (!Intersect_RayNode(nodes[0].bounds, rayStart, rcpDir, bestDistance, rootDistance)) {
+        return result;
+    }
+    stack[stackDepth++] = {0, rootDistance};
+
+    while (stackDepth > 0) {
+        const stackEntry_t entry = stack[--stackDepth];
+        // a closer hit may have been found since this node was pushed
+        if (entry.distance >= bestDistance) {
+            continue;
+        }
+
+        const bvh_node_t& node = nodes[entry.node];
+        if (node.count > 0) {
+            for (int i = node.data; i < node.data + node.count; i++) {
+                const int triangleIndex = triangles[i] * 3;
+                float distance;
+                float u;
+                float v;
+
+                if (Intersect_RayTriangle(
+                        rayStart,
+                        rayDir,
+                        vertices[indices[triangleIndex + 0]],
+                        vertices[indices[triangleIndex + 1]],
+                        vertices[indices[triangleIndex + 2]],
+                        distance,
+                        u,
+                        v)) {
+                    if (distance >= 0.0f && distance < bestDistance) {
+                        bestDistance = distance;
+
+                        result.triangleIndex = triangleIndex;
+                        uv.x = u;
+                        uv.y = v;
+                    }
+                }
+            }
+            continue;
+        }
+
+        const int left = entry.node + 1;
+        const int right = node.data;
+        float leftDistance;
+        float rightDistance;
+        const bool hitLeft =
+            Intersect_RayNode(nodes[left].bounds, rayStart, rcpDir, bestDistance, leftDistance);
+        const bool hitRight =
+            Intersect_RayNode(nodes[right].bounds, rayStart, rcpDir, bestDistance, rightDistance);
+
+        // push the far child first so the near child is visited first
+        if (hitLeft && hitRight) {
+            if (leftDistance <= rightDistance) {
+                stack[stackDepth++] = {right, rightDistance};
+                stack[stackDepth++] = {left, leftDistance};
+            } else {
+                stack[stackDepth++] = {left, leftDistance};
+                stack[stackDepth++] = {right, rightDistance};
+            }
+        } else if (hitLeft) {
+            stack[stackDepth++] = {left, leftDistance};
+        } else if (hitRight) {
+            stack[stackDepth++] = {right, rightDistance};
+        }
+    }
+
+    if (result.triangleIndex != -1) {
+        FinishResult(result, bestDistance, rayLengthRcp, uv);
+    }
+
+    return result;
+}
+
+namespace {
+
+const int RT_BVH_PACKET_SIZE = 4;
+
+struct alignas(16) rayPacket_t {
+    float startX[RT_BVH_PACKET_SIZE];
+    float startY[RT_BVH_PACKET_SIZE];
+    float startZ[RT_BVH_PACKET_SIZE];
+    float rcpDirX[RT_BVH_PACKET_SIZE];
+    float rcpDirY[RT_BVH_PACKET_SIZE];
+    float rcpDirZ[RT_BVH_PACKET_SIZE];
+    float bestDistance[RT_BVH_PACKET_SIZE];
+};
+
+// Returns a bit mask of the rays in the packet that intersect the bounds closer
+// than their current best distance.
+#if defined(OVR_BVH_SSE)
+
+int Intersect_PacketNode(const Bounds3f& bounds, const rayPacket_t& packet) {
+    const __m128 sX = _mm_mul_ps(
+        _mm_sub_ps(_mm_set1_ps(bounds.b[0].x), _mm_load_ps(packet.startX)),
+        _mm_load_ps(packet.rcpDirX));
+    const __m128 sY = _mm_mul_ps(
+        _mm_sub_ps(_mm_set1_ps(bounds.b[0].y), _mm_load_ps(packet.startY)),
+        _mm_load_ps(packet.rcpDirY));
+    const __m128 sZ = _mm_mul_ps(
+        _mm_sub_ps(_mm_set1_ps(bounds.b[0].z), _mm_load_ps(packet.startZ)),
+        _mm_load_ps(packet.rcpDirZ));
+
+    const __m128 tX = _mm_mul_ps(
+        _mm_sub_ps(_mm_set1_ps(bounds.b[1].x), _mm_load_ps(packet.startX)),
+        _mm_load_ps(packet.rcpDirX));
+    const __m128 tY = _mm_mul_ps(
+        _mm_sub_ps(_mm_set1_ps(bounds.b[1].y), _mm_load_ps(packet.startY)),
+        _mm_load_ps(packet.rcpDirY));
+    const __m128 tZ = _mm_mul_ps(
+        _mm_sub_ps(_mm_set1_ps(bounds.b[1].z), _mm_load_ps(packet.startZ)),
+        _mm_load_ps(packet.rcpDirZ));
+
+    const __m128 t0 = _mm_max_ps(
+        _mm_min_ps(sX, tX), _mm_max_ps(_mm_min_ps(sY, tY), _mm_min_ps(sZ, tZ)));
+    const __m128 t1 = _mm_min_ps(
+        _mm_max_ps(sX, tX), _mm_min_ps(_mm_max_ps(sY, tY), _mm_max_ps(sZ, tZ)));
+
+    const __m128 hit = _mm_and_ps(
+        _mm_and_ps(_mm_cmple_ps(t0, t1), _mm_cmpge_ps(t1, _mm_setzero_ps())),
+        _mm_cmplt_ps(t0, _mm_load_ps(packet.bestDistance)));
+    return _mm_movemask_ps(hit);
+}
+
+#elif defined(OVR_BVH_NEON)
+
+int Intersect_PacketNode(const Bounds3f& bounds, const rayPacket_t& packet) {
+    const float32x4_t sX = vmulq_f32(
+        vsubq_f32(vdupq_n_f32(bounds.b[0].x), vld1q_f32(packet.startX)),
+        vld1q_f32(packet.rcpDirX));
+    const float32x4_t sY = vmulq_f32(
+        vsubq_f32(vdupq_n_f32(bounds.b[0].y), vld1q_f32(packet.startY)),
+        vld1q_f32(packet.rcpDirY));
+    const float32x4_t sZ = vmulq_f32(
+        vsubq_f32(vdupq_n_f32(bounds.b[0].z), vld1q_f32(packet.startZ)),
+        vld1q_f32(packet.rcpDirZ));
+
+    const float32x4_t tX = vmulq_f32(
+        vsubq_f32(vdupq_n_f32(bounds.b[1].x), vld1q_f32(packet.startX)),
+        vld1q_f32(packet.rcpDirX));
+    const float32x4_t tY = vmulq_f32(
+        vsubq_f32(vdupq_n_f32(bounds.b[1].y), vld1q_f32(packet.startY)),
+        vld1q_f32(packet.rcpDirY));
+    const float32x4_t tZ = vmulq_f32(
+        vsubq_f32(vdupq_n_f32(bounds.b[1].z), vld1q_f32(packet.startZ)),
+        vld1q_f32(packet.rcpDirZ));
+
+    const float32x4_t t0 =
+        vmaxq_f32(vminq_f32(sX, tX), vmaxq_f32(vminq_f32(sY, tY), vminq_f32(sZ, tZ)));
+    const float32x4_t t1 =
+        vminq_f32(vmaxq_f32(sX, tX), vminq_f32(vmaxq_f32(sY, tY), vmaxq_f32(sZ, tZ)));
+
+    const uint32x4_t hit = vandq_u32(
+        vandq_u32(vcleq_f32(t0, t1), vcgeq_f32(t1, vdupq_n_f32(0.0f))),
+        vcltq_f32(t0, vld1q_f32(packet.bestDistance)));
+
+    static const uint32_t laneBits[4] = {1, 2, 4, 8};
+    const uint32x4_t bits = vandq_u32(hit, vld1q_u32(laneBits));
+    const uint32x2_t sum = vpadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    return static_cast<int>(vget_lane_u32(vpadd_u32(sum, sum), 0));
+}
+
+#else
+
+int Intersect_PacketNode(const Bounds3f& bounds, const rayPacket_t& packet) {
+    int mask = 0;
+    for (int i = 0; i < RT_BVH_PACKET_SIZE; i++) {
+        const Vector3f start(packet.startX[i], packet.startY[i], packet.startZ[i]);
+        const Vector3f rcpDir(packet.rcpDirX[i], packet.rcpDirY[i], packet.rcpDirZ[i]);
+        float t0;
+        if (Intersect_RayNode(bounds, start, rcpDir, packet.bestDistance[i], t0)) {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+}
+
+#endif
+
+} // namespace
+
+void ModelTraceBvh::TracePacket(
+    const Vector3f* starts,
+    const Vector3f* ends,
+    const int count,
+    traceResult_t* results) const {
+    for (int first = 0; first < count; first += RT_BVH_PACKET_SIZE) {
+        const int numRays = std::min(RT_BVH_PACKET_SIZE, count - first);
+
+        rayPacket_t packet;
+        Vector3f rayDir[RT_BVH_PACKET_SIZE];
+        float rayLengthRcp[RT_BVH_PACKET_SIZE];
+        Vector2f uv[RT_BVH_PACKET_SIZE];
+        int activeMask = 0;
+
+        for (int i = 0; i < RT_BVH_PACKET_SIZE; i++) {
+            if (i >= numRays) {
+                // unused lanes never hit anything
+                packet.startX[i] = packet.startY[i] = packet.startZ[i] = 0.0f;
+                packet.rcpDirX[i] = packet.rcpDirY[i] = packet.rcpDirZ[i] = 0.0f;
+                packet.bestDistance[i] = -1.0f;
+                continue;
+            }
+
+            traceResult_t& result = results[first + i];
+            result.triangleIndex = -1;
+            result.fraction = 1.0f;
+            result.uv = Vector2f(0.0f);
+            result.normal = Vector3f(0.0f);
+
+            const Vector3f rayDelta = ends[first + i] - starts[first + i];
+            const float rayLengthSqr = rayDelta.LengthSq();
+            rayLengthRcp[i] = OVR::RcpSqrt(rayLengthSqr);
+            rayDir[i] = rayDelta * rayLengthRcp[i];
+
+            packet.startX[i] = starts[first + i].x;
+            packet.startY[i] = starts[first + i].y;
+            packet.startZ[i] = starts[first + i].z;
+            packet.rcpDirX[i] = SafeRcp(rayDir[i].x);
+            packet.rcpDirY[i] = SafeRcp(rayDir[i].y);
+            packet.rcpDirZ[i] = SafeRcp(rayDir[i].z);
+            packet.bestDistance[i] = rayLengthSqr * rayLengthRcp[i];
+            activeMask |= 1 << i;
+        }
+
+        if (nodes.empty() || activeMask == 0) {
+            continue;
+        }
+
+        // The first ray decides the order in which the children are visited.
+        const Vector3f& leadDir = rayDir[0];
+
+        int stack[RT_BVH_MAX_DEPTH];
+        int stackDepth = 0;
+        stack[stackDepth++] = 0;
+
+        while (stackDepth > 0) {
+            const int nodeIndex = stack[--stackDepth];
+            const bvh_node_t& node = nodes[nodeIndex];
+
+            const int hitMask = Intersect_PacketNode(node.bounds, packet) & activeMask;
+            if (hitMask == 0) {
+                continue;
+            }
+
+            if (node.count < 0) {
+                const int axis = -1 - node.count;
+                if (leadDir[axis] < 0.0f) {
+                    stack[stackDepth++] = nodeIndex + 1;
+                    stack[stackDepth++] = node.data;
+                } else {
+                    stack[stackDepth++] = node.data;
+                    stack[stackDepth++] = nodeIndex + 1;
+                }
+                continue;
+            }
+
+            for (int r = 0; r < RT_BVH_PACKET_SIZE; r++) {
+                if ((hitMask & (1 << r)) == 0) {
+                    continue;
+                }
+                const Vector3f rayStart(packet.startX[r], packet.startY[r], packet.startZ[r]);
+                traceResult_t& result = results[first + r];
+
+                for (int i = node.data; i < node.data + node.count; i++) {
+                    const int triangleIndex = triangles[i] * 3;
+                    float distance;
+                    float u;
+                    float v;
+
+                    if (Intersect_RayTriangle(
+                            rayStart,
+                            rayDir[r],
+                            vertices[indices[triangleIndex + 0]],
+                            vertices[indices[triangleIndex + 1]],
+                            vertices[indices[triangleIndex + 2]],
+                            distance,
+                            u,
+                            v)) {
+                        if (distance >= 0.0f && distance < packet.bestDistance[r]) {
+                            packet.bestDistance[r] = distance;
+
+                            result.triangleIndex = triangleIndex;
+                            uv[r].x = u;
+                            uv[r].y = v;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i < numRays; i++) {
+            traceResult_t& result = results[first + i];
+            if (result.triangleIndex != -1) {
+                FinishResult(result, packet.bestDistance[i], rayLengthRcp[i], uv[i]);
+            }
+        }
+    }
+}
+
+void ModelTraceBvh::PrintStatsToLog() const {
+    int numLeaves = 0;
+    int maxLeafTriangles = 0;
+    for (const bvh_node_t& node : nodes) {
+        if (node.count > 0) {
+            numLeaves++;
+            maxLeafTriangles = std::max(maxLeafTriangles, node.count);
+        }
+    }
+    ALOG("ModelTraceBvh Stats:");
+    ALOG("  Vertices : %i", static_cast<int>(vertices.size()));
+    ALOG("  UVs      : %i", static_cast<int>(uvs.size()));
+    ALOG("  Indices  : %i", static_cast<int>(indices.size()));
+    ALOG("  Nodes    : %i", static_cast<int>(nodes.size()));
+    ALOG("  Leaves   : %i", numLeaves);
+    ALOG("  Max Leaf : %i", maxLeafTriangles);
+}
+
+} // namespace OVRFW
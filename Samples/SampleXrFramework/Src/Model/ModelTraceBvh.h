@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   ModelTraceBvh.h
+Content     :   Ray tracer using a bounding volume hierarchy built at load time.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include "OVR_Math.h"
+
+#include "ModelTrace.h"
+
+#include <vector>
+
+namespace OVRFW {
+
+struct ModelGeo;
+
+const int RT_BVH_MAX_LEAF_TRIANGLES = 4;
+const int RT_BVH_MAX_DEPTH = 64;
+
+struct bvh_node_t {
+    OVR::Bounds3f bounds;
+    // leaf     : index of the first entry in triangles
+    // interior : index of the right child, the left child immediately follows this node
+    int data;
+    // leaf     : number of triangles, always > 0
+    // interior : -1 - split axis
+    int count;
+};
+
+// Unlike ModelTrace, which needs a kd-tree that was generated offline, the
+// hierarchy is built from plain triangle soup with a binned surface area
+// heuristic, so any model loaded at runtime can be traced.  The results use the
+// same conventions as ModelTrace::Trace: triangleIndex is the offset of the first
+// index of the hit triangle in 'indices'.
+class ModelTraceBvh {
+   public:
+    ModelTraceBvh() {}
+    ~ModelTraceBvh() {}
+
+    void Build(
+        const std::vector<OVR::Vector3f>& vertices,
+        const std::vector<OVR::Vector2f>& uvs,
+        const std::vector<int>& indices);
+    // Positions in the ModelGeo are in the local space of each mesh.
+    void Build(const ModelGeo& geo);
+    void Build(const ModelTrace& trace);
+
+    traceResult_t Trace(const OVR::Vector3f& start, const OVR::Vector3f& end) const;
+
+    // Traces the rays in packets of 4, testing the node bounds of all the rays in a
+    // packet at once.  Works best for coherent rays, like a fan of rays from a controller.
+    void TracePacket(
+        const OVR::Vector3f* starts,
+        const OVR::Vector3f* ends,
+        const int count,
+        traceResult_t* results) const;
+
+    void PrintStatsToLog() const;
+
+   public:
+    std::vector<OVR::Vector3f> vertices;
+    std::vector<OVR::Vector2f> uvs;
+    std::vector<int> indices;
+    std::vector<bvh_node_t> nodes;
+    std::vector<int> triangles; // triangle numbers referenced by the leaves
+
+   private:
+    int BuildNode(
+        const std::vector<OVR::Bounds3f>& triBounds,
+        const std::vector<OVR::Vector3f>& triCenters,
+        const int first,
+        const int count,
+        const int depth);
+    void BuildHierarchy();
+    void FinishResult(
+        traceResult_t& result,
+        const float distance,
+        const float rayLengthRcp,
+        const OVR::Vector2f& uv) const;
+};
+
+} // namespace OVRFW
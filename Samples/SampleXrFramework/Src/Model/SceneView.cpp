@@ -31,7 +31,13 @@ Authors     :   John Carmack
 
 #include <algorithm>
 
+#include "Misc/JobPool.h"
 #include "Misc/Log.h"
+#include "Render/GlUploadQueue.h"
+#include "System.h"
+
+#include <atomic>
+#include <string.h>
 
 using OVR::Axis_X;
 using OVR::Axis_Y;
@@ -401,17 +407,59 @@ void ModelInScene::AnimateJoints(const double timeInSeconds) {
                 ApplyAnimation(State, i);
             }
 
-            for (int i = 0; i < static_cast<int>(State.nodeStates.size()); i++) {
-                State.nodeStates[i].RecalculateMatrix();
-            }
+            State.UpdateTransforms();
         }
     }
 }
 
 //-------------------------------------------------------------------------------------
 
+// A world model load started by LoadWorldModelAsync().  Only the loader thread touches
+// the model until done is set, after that only the GL thread.
+struct ovrWorldModelLoad {
+    ovrWorldModelLoad(
+        const int handle_,
+        const char* fileName_,
+        const bool fromApk_,
+        const MaterialParms& materialParms_)
+        : handle(handle_),
+          fileName(fileName_),
+          fromApk(fromApk_),
+          materialParms(materialParms_),
+          model(nullptr),
+          done(false),
+          canceled(false) {}
+
+    const int handle;
+    const std::string fileName;
+    const bool fromApk;
+    MaterialParms materialParms;
+    ovrGlUploadQueue uploads;
+    ModelFile* model;
+    std::atomic<bool> done;
+    bool canceled;
+};
+
+// Only the glTF loaders leave all their GL work to the upload queue.
+static bool CanLoadOffGlThread(const char* fileName) {
+    return strstr(fileName, ".glb") != nullptr || strstr(fileName, ".gltf.ovrscene") != nullptr;
+}
+
+static ModelFile* LoadWorldModelFile(
+    const ovrWorldModelLoad& load,
+    const ModelGlPrograms& programs) {
+    if (load.fromApk) {
+        return LoadModelFileFromApplicationPackage(
+            load.fileName.c_str(), programs, load.materialParms);
+    }
+    return LoadModelFile(load.fileName.c_str(), programs, load.materialParms);
+}
+
 OvrSceneView::OvrSceneView()
     : FreeWorldModelOnChange(false),
+      MaxUploadsPerFrame(8),
+      MaxUploadSecondsPerFrame(0.002),
+      WorldModelLoadsInFrame(true),
       LoadedPrograms(false),
       Paused(false),
       SuppressModelsWithClientId(-1),
@@ -435,12 +483,37 @@ OvrSceneView::OvrSceneView()
     CenterEyeViewMatrix = Matrix4f::Identity();
 }
 
+OvrSceneView::~OvrSceneView() {
+    // wait for the loader thread before freeing models it may still be writing
+    LoaderPool.reset();
+    for (const std::shared_ptr<ovrWorldModelLoad>& load : WorldModelLoads) {
+        load->uploads.Clear();
+        delete load->model;
+    }
+    if (StreamingWorldModel != nullptr) {
+        StreamingWorldModel->uploads.Clear();
+    }
+    for (const ModelFile* model : RetiredWorldModels) {
+        delete model;
+    }
+}
+
+// The unskinned programs read ModelMatrix from the InstanceMatrices ubo so that
+// ovrSurfaceRender can merge consecutive draws of the same surface into one instanced draw.
+// The reflection mapped program also reads the separate Modelm uniform and stays per draw.
+static const char* InstancedModelDirectives = "#define INSTANCED_MODEL_MATRICES 1\n";
+
 ModelGlPrograms OvrSceneView::GetDefaultGLPrograms() {
     ModelGlPrograms programs;
 
     if (!LoadedPrograms) {
         ProgVertexColor = OVRFW::GlProgram::Build(
-            VertexColorVertexShaderSrc, VertexColorFragmentShaderSrc, nullptr, 0);
+            InstancedModelDirectives,
+            VertexColorVertexShaderSrc,
+            nullptr,
+            VertexColorFragmentShaderSrc,
+            nullptr,
+            0);
 
         {
             OVRFW::ovrProgramParm uniformParms[] = {
@@ -450,7 +523,9 @@ ModelGlPrograms OvrSceneView::GetDefaultGLPrograms() {
             };
             const int uniformCount = sizeof(uniformParms) / sizeof(OVRFW::ovrProgramParm);
             ProgSingleTexture = OVRFW::GlProgram::Build(
+                InstancedModelDirectives,
                 SingleTextureVertexShaderSrc,
+                nullptr,
                 SingleTextureFragmentShaderSrc,
                 uniformParms,
                 uniformCount);
@@ -465,7 +540,9 @@ ModelGlPrograms OvrSceneView::GetDefaultGLPrograms() {
             };
             const int uniformCount = sizeof(uniformParms) / sizeof(OVRFW::ovrProgramParm);
             ProgLightMapped = OVRFW::GlProgram::Build(
+                InstancedModelDirectives,
                 LightMappedVertexShaderSrc,
+                nullptr,
                 LightMappedFragmentShaderSrc,
                 uniformParms,
                 uniformCount);
@@ -498,7 +575,12 @@ ModelGlPrograms OvrSceneView::GetDefaultGLPrograms() {
             };
             const int uniformCount = sizeof(uniformParms) / sizeof(OVRFW::ovrProgramParm);
             ProgSimplePBR = OVRFW::GlProgram::Build(
-                SimplePBRVertexShaderSrc, SimplePBRFragmentShaderSrc, uniformParms, uniformCount);
+                InstancedModelDirectives,
+                SimplePBRVertexShaderSrc,
+                nullptr,
+                SimplePBRFragmentShaderSrc,
+                uniformParms,
+                uniformCount);
         }
 
         {
@@ -510,7 +592,9 @@ ModelGlPrograms OvrSceneView::GetDefaultGLPrograms() {
             };
             const int uniformCount = sizeof(uniformParms) / sizeof(OVRFW::ovrProgramParm);
             ProgBaseColorPBR = OVRFW::GlProgram::Build(
+                InstancedModelDirectives,
                 SimplePBRVertexShaderSrc,
+                nullptr,
                 BaseColorPBRFragmentShaderSrc,
                 uniformParms,
                 uniformCount);
@@ -527,7 +611,9 @@ ModelGlPrograms OvrSceneView::GetDefaultGLPrograms() {
             };
             const int uniformCount = sizeof(uniformParms) / sizeof(OVRFW::ovrProgramParm);
             ProgBaseColorEmissivePBR = OVRFW::GlProgram::Build(
+                InstancedModelDirectives,
                 SimplePBRVertexShaderSrc,
+                nullptr,
                 BaseColorEmissivePBRFragmentShaderSrc,
                 uniformParms,
                 uniformCount);
@@ -731,10 +817,23 @@ void OvrSceneView::LoadWorldModel(const char* sceneFileName, const MaterialParms
 }
 
 void OvrSceneView::SetWorldModel(ModelFile& world) {
+    CancelWorldModelLoads();
+    ReplaceWorldModel(world);
+}
+
+void OvrSceneView::ReplaceWorldModel(ModelFile& world) {
     ALOG("OvrSceneView::SetWorldModel( %s )", world.FileName.c_str());
 
+    // the pending uploads reference the model that is about to be freed
+    if (StreamingWorldModel != nullptr) {
+        StreamingWorldModel->uploads.Clear();
+        LoadStatus[StreamingWorldModel->handle] = MODEL_LOAD_STATUS_CANCELED;
+        StreamingWorldModel = nullptr;
+    }
+
     if (FreeWorldModelOnChange && static_cast<int>(Models.size()) > 0) {
-        delete WorldModel.Definition;
+        // surfaces of a frame that is still to be rendered can point into it
+        RetiredWorldModels.push_back(WorldModel.Definition);
         FreeWorldModelOnChange = false;
     }
     Models.clear();
@@ -749,6 +848,136 @@ void OvrSceneView::SetWorldModel(ModelFile& world) {
     SceneYaw = 0.0f;
 }
 
+int OvrSceneView::LoadWorldModelAsync(
+    const char* sceneFileName,
+    const MaterialParms& materialParms,
+    const bool fromApk) {
+    ALOG("OvrSceneView::LoadWorldModelAsync( %s )", sceneFileName);
+
+    // the programs are built here, on the GL thread
+    if (GlPrograms.ProgSingleTexture == NULL) {
+        GlPrograms = GetDefaultGLPrograms();
+    }
+
+    CancelWorldModelLoads();
+
+    const int handle = static_cast<int>(LoadStatus.size());
+    LoadStatus.push_back(MODEL_LOAD_STATUS_LOADING);
+
+    std::shared_ptr<ovrWorldModelLoad> load =
+        std::make_shared<ovrWorldModelLoad>(handle, sceneFileName, fromApk, materialParms);
+    WorldModelLoads.push_back(load);
+
+    if (!CanLoadOffGlThread(sceneFileName)) {
+        ALOGW("OvrSceneView::LoadWorldModelAsync( %s ) will block in Frame()", sceneFileName);
+        return handle;
+    }
+
+    load->materialParms.UploadQueue = &load->uploads;
+    if (LoaderPool == nullptr) {
+        LoaderPool = std::unique_ptr<ovrJobPool>(new ovrJobPool(1));
+    }
+    const ModelGlPrograms programs = GlPrograms;
+    LoaderPool->Submit([load, programs]() {
+        load->model = LoadWorldModelFile(*load, programs);
+        load->done.store(true, std::memory_order_release);
+    });
+
+    return handle;
+}
+
+int OvrSceneView::LoadWorldModelAsync(
+    const char* sceneFileName,
+    const MaterialParms& materialParms) {
+    return LoadWorldModelAsync(sceneFileName, materialParms, false);
+}
+
+int OvrSceneView::LoadWorldModelFromApplicationPackageAsync(
+    const char* sceneFileName,
+    const MaterialParms& materialParms) {
+    return LoadWorldModelAsync(sceneFileName, materialParms, true);
+}
+
+ModelLoadStatus OvrSceneView::GetWorldModelLoadStatus(const int handle) const {
+    if (handle < 0 || handle >= static_cast<int>(LoadStatus.size())) {
+        return MODEL_LOAD_STATUS_INVALID;
+    }
+    return LoadStatus[handle];
+}
+
+void OvrSceneView::CancelWorldModelLoads() {
+    // Loads still on the loader thread are freed once it is done with them.
+    for (const std::shared_ptr<ovrWorldModelLoad>& load : WorldModelLoads) {
+        load->canceled = true;
+    }
+}
+
+void OvrSceneView::UpdateWorldModelLoads() {
+    // the frames that drew the models replaced since the last call have been rendered
+    for (const ModelFile* model : RetiredWorldModels) {
+        delete model;
+    }
+    RetiredWorldModels.clear();
+
+    // Set finished loads as the world model, only the newest can be uncanceled.
+    for (size_t i = 0; i < WorldModelLoads.size();) {
+        const std::shared_ptr<ovrWorldModelLoad> load = WorldModelLoads[i];
+        if (load->materialParms.UploadQueue == nullptr && !load->done.load()) {
+            // a format that has to be loaded on the GL thread
+            if (!load->canceled) {
+                load->model = LoadWorldModelFile(*load, GlPrograms);
+            }
+            load->done.store(true);
+        }
+        if (!load->done.load(std::memory_order_acquire)) {
+            i++;
+            continue;
+        }
+        if (load->canceled) {
+            load->uploads.Clear();
+            delete load->model;
+            load->model = nullptr;
+            LoadStatus[load->handle] = MODEL_LOAD_STATUS_CANCELED;
+        } else if (load->model == nullptr) {
+            ALOGW("OvrSceneView::LoadWorldModelAsync( %s ) failed", load->fileName.c_str());
+            LoadStatus[load->handle] = MODEL_LOAD_STATUS_FAILED;
+        } else {
+            ReplaceWorldModel(*load->model);
+            FreeWorldModelOnChange = true;
+            StreamingWorldModel = load;
+            LoadStatus[load->handle] = MODEL_LOAD_STATUS_UPLOADING;
+        }
+        WorldModelLoads.erase(WorldModelLoads.begin() + i);
+    }
+
+    LoadCounters.numUploads = 0;
+    LoadCounters.uploadSeconds = 0.0;
+    if (StreamingWorldModel != nullptr) {
+        ovrGlUploadQueue& uploads = StreamingWorldModel->uploads;
+        const double startTime = GetTimeInSeconds();
+        do {
+            if (uploads.Drain(1) == 0) {
+                break;
+            }
+            LoadCounters.numUploads++;
+            LoadCounters.uploadSeconds = GetTimeInSeconds() - startTime;
+        } while (LoadCounters.numUploads < MaxUploadsPerFrame &&
+                 LoadCounters.uploadSeconds < MaxUploadSecondsPerFrame);
+
+        LoadCounters.numTotalUploads += LoadCounters.numUploads;
+        if (LoadCounters.uploadSeconds > MaxUploadSecondsPerFrame) {
+            LoadCounters.numFramesOverBudget++;
+        }
+        if (uploads.IsEmpty()) {
+            LoadStatus[StreamingWorldModel->handle] = MODEL_LOAD_STATUS_COMPLETE;
+            StreamingWorldModel = nullptr;
+        }
+    }
+    LoadCounters.numPendingLoads = static_cast<int>(WorldModelLoads.size());
+    LoadCounters.numPendingUploads =
+        (StreamingWorldModel != nullptr) ? StreamingWorldModel->uploads.GetPendingCount() : 0;
+}
+
 void OvrSceneView::ClearStickAngles() {
     StickYaw = 0.0f;
     StickPitch = 0.0f;
@@ -816,7 +1045,8 @@ void OvrSceneView::GenerateFrameSurfaceList(
     Matrix4f centerEyeCullViewMatrix =
         Matrix4f::Translation(0, 0, -moveBackDistance) * frameMatrices.CenterView;
 
-    std::vector<ModelNodeState*> emitNodes;
+    std::vector<ModelNodeState*>& emitNodes = EmitNodes;
+    emitNodes.clear();
     for (int i = 0; i < static_cast<int>(Models.size()); i++) {
         if (Models[i] != NULL) {
             ModelState& state = Models[i]->State;
@@ -839,7 +1069,8 @@ void OvrSceneView::GenerateFrameSurfaceList(
         emitNodes,
         EmitSurfaces,
         centerEyeCullViewMatrix,
-        symmetricEyeProjectionMatrix);
+        symmetricEyeProjectionMatrix,
+        SurfaceSortList);
 }
 
 void OvrSceneView::SetFootPos(const Vector3f& pos, bool updateCenterEye /*= true*/) {
@@ -972,6 +1203,10 @@ void OvrSceneView::Frame(
     const long long suppressModelsWithClientId_) {
     SuppressModelsWithClientId = suppressModelsWithClientId_;
     CurrentTracking = vrFrame;
+
+    if (WorldModelLoadsInFrame) {
+        UpdateWorldModelLoads();
+    }
     InterPupillaryDistance = vrFrame.IPD;
 
     // trim height to 1m at a minimum if the reported height from the API is too low
@@ -29,9 +29,42 @@ Authors     :   John Carmack
 
 #include "FrameParams.h"
 #include "ModelFile.h"
+#include "ModelRender.h"
+
+#include <memory>
 
 namespace OVRFW {
 
+class ovrJobPool;
+struct ovrWorldModelLoad;
+
+enum ModelLoadStatus {
+    MODEL_LOAD_STATUS_INVALID, // not a handle returned by OvrSceneView
+    MODEL_LOAD_STATUS_LOADING, // reading and decoding on the loader thread
+    MODEL_LOAD_STATUS_UPLOADING, // set as the world model, textures and geometry still uploading
+    MODEL_LOAD_STATUS_COMPLETE,
+    MODEL_LOAD_STATUS_FAILED,
+    MODEL_LOAD_STATUS_CANCELED // replaced by another world model before it completed
+};
+
+// GL uploads of streamed world models, updated every Frame().
+struct ovrSceneLoadCounters {
+    ovrSceneLoadCounters()
+        : numPendingLoads(0),
+          numPendingUploads(0),
+          numUploads(0),
+          uploadSeconds(0.0),
+          numTotalUploads(0),
+          numFramesOverBudget(0) {}
+
+    int numPendingLoads; // loads that haven't been set as the world model yet
+    int numPendingUploads; // uploads left for later frames
+    int numUploads; // uploads run in the last Frame()
+    double uploadSeconds; // time spent on uploads in the last Frame()
+    long long numTotalUploads;
+    int numFramesOverBudget; // frames where the uploads took longer than the time budget
+};
+
 //-----------------------------------------------------------------------------------
 // ModelInScene
 //
@@ -52,6 +85,7 @@ class ModelInScene {
 class OvrSceneView {
    public:
     OvrSceneView();
+    ~OvrSceneView();
 
     // The default view will be located at the origin, looking down the -Z axis,
     // with +X to the right and +Y up.
@@ -69,6 +103,39 @@ class OvrSceneView {
     void
     LoadWorldModel(class ovrFileSys& fileSys, const char* uri, const MaterialParms& materialParms);
 
+    // Non-blocking load of a scene, returns a handle for GetWorldModelLoadStatus().
+    // The file is read and decoded on a loader thread.  Once that is done, Frame() sets it as
+    // the world model and uploads its textures and geometry within the upload budget, so
+    // surfaces show up over the following frames.  Only glTF models (.glb and .gltf.ovrscene)
+    // can be decoded off the GL thread, other formats are loaded by a blocking load in Frame().
+    // Setting or loading another world model cancels the load.
+    int LoadWorldModelAsync(const char* sceneFileName, const MaterialParms& materialParms);
+    int LoadWorldModelFromApplicationPackageAsync(
+        const char* sceneFileName,
+        const MaterialParms& materialParms);
+    ModelLoadStatus GetWorldModelLoadStatus(const int handle) const;
+
+    // Limits the uploads of streamed world models run in a single Frame().  At least one upload
+    // is run every frame, so a single large texture can still go over the time budget.
+    void SetUploadBudget(const int maxUploadsPerFrame, const double maxUploadSecondsPerFrame) {
+        MaxUploadsPerFrame = maxUploadsPerFrame;
+        MaxUploadSecondsPerFrame = maxUploadSecondsPerFrame;
+    }
+    const ovrSceneLoadCounters& GetLoadCounters() const {
+        return LoadCounters;
+    }
+
+    // Sets the loads of LoadWorldModelAsync() as the world model and runs their uploads, which
+    // needs GL. Frame() calls it unless SetWorldModelLoadsInFrame( false ), for an owner that
+    // calls Frame() on another thread, such as XrApp with PipelinedFrames. That owner calls it on
+    // the GL thread while Frame() is not running instead. World models replaced by one call, or
+    // by SetWorldModel() before it, are freed by the next call, so they must not be drawn by
+    // surfaces rendered after that.
+    void UpdateWorldModelLoads();
+    void SetWorldModelLoadsInFrame(const bool inFrame) {
+        WorldModelLoadsInFrame = inFrame;
+    }
+
     // Set an already loaded scene, which will not be freed when a new
     // world model is set.
     void SetWorldModel(ModelFile& model);
@@ -187,18 +254,43 @@ class OvrSceneView {
         const char* sceneFileName,
         const MaterialParms& materialParms,
         const bool fromApk);
+    int LoadWorldModelAsync(
+        const char* sceneFileName,
+        const MaterialParms& materialParms,
+        const bool fromApk);
+    void ReplaceWorldModel(ModelFile& world);
+    void CancelWorldModelLoads();
 
     // The only ModelInScene that OvrSceneView actually owns.
     bool FreeWorldModelOnChange;
     ModelInScene WorldModel;
+    // Replaced world models, freed by the next UpdateWorldModelLoads().
+    std::vector<const ModelFile*> RetiredWorldModels;
 
     // Entries can be NULL.
     // None of these will be directly freed by OvrSceneView.
     std::vector<ModelInScene*> Models;
 
+    // Created on the first async load.
+    std::unique_ptr<ovrJobPool> LoaderPool;
+    // Loads that haven't been set as the world model yet, oldest first.
+    std::vector<std::shared_ptr<ovrWorldModelLoad>> WorldModelLoads;
+    // The load that is the current world model while its uploads are still pending.
+    std::shared_ptr<ovrWorldModelLoad> StreamingWorldModel;
+    // Indexed by handle.
+    std::vector<ModelLoadStatus> LoadStatus;
+    int MaxUploadsPerFrame;
+    double MaxUploadSecondsPerFrame;
+    ovrSceneLoadCounters LoadCounters;
+    bool WorldModelLoadsInFrame;
+
     // Externally generated surfaces
     std::vector<ovrDrawSurface> EmitSurfaces;
 
+    // Scratch storage reused by GenerateFrameSurfaceList() every frame.
+    mutable std::vector<ModelNodeState*> EmitNodes;
+    mutable ovrModelSurfaceSortList SurfaceSortList;
+
     GlProgram ProgVertexColor;
     GlProgram ProgSingleTexture;
     GlProgram ProgLightMapped;
@@ -44,6 +44,8 @@ Authors     :   Jonathan E. Wright
 #include "windows.h"
 #include <Shlwapi.h>
 #pragma comment(lib, "shlwapi.lib")
+#else
+#include <unistd.h> // access
 #endif
 
 namespace OVRFW {
@@ -198,7 +198,7 @@ inline bool ToRelativePath(
     char* outPath,
     const int outMaxLen) {
     // check if the path starts with any of the search paths
-    const int n = static_cast<const int>(searchPaths.size());
+    const int n = static_cast<int>(searchPaths.size());
     for (int i = 0; i < n; ++i) {
         char const* path = searchPaths[i].c_str();
         if (strstr(fullPath, path) == fullPath) {
@@ -28,7 +28,7 @@ Authors     :   Chris Taylor
 #include "OVR_MappedFile.h"
 #include "OVR_Types.h"
 
-#if defined(OVR_OS_ANDROID)
+#if defined(OVR_OS_ANDROID) || defined(OVR_OS_LINUX)
 
 #if defined(OVR_OS_ANDROID)
 // disable warnings on implicit type conversion where value may be changed by conversion for
@@ -231,4 +231,4 @@ void MappedView::Close() {
 
 } // namespace OVRFW
 
-#endif // defined(OVR_OS_ANDROID)
+#endif // defined(OVR_OS_ANDROID) || defined(OVR_OS_LINUX)
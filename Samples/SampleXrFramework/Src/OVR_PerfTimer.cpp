@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*******************************************************************************
+
+Filename	:   OVR_PerfTimer.cpp
+Content		:	Scoped CPU timers and per-phase frame timing.
+Created		:
+Authors		:
+Language	:   C++
+
+*******************************************************************************/
+
+#include "OVR_PerfTimer.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <mutex>
+
+namespace OVRFW {
+
+namespace {
+
+// The fields are relaxed atomics so the reader can copy a slot while its thread overwrites it,
+// the copy is then dropped based on Begun.
+struct ovrPerfSlot {
+    std::atomic<const char*> Name;
+    std::atomic<double> Start;
+    std::atomic<double> End;
+};
+
+struct ovrPerfThreadEvents {
+    explicit ovrPerfThreadEvents(const int threadIndex)
+        : ThreadIndex(threadIndex), ThreadName(nullptr), Begun(0), Written(0) {}
+
+    int ThreadIndex;
+    std::atomic<const char*> ThreadName;
+    std::atomic<uint64_t> Begun; // events the thread started to write
+    std::atomic<uint64_t> Written; // events the thread finished writing
+    ovrPerfSlot Slots[ovrPerfRecorder::EVENTS_PER_THREAD];
+};
+
+} // namespace
+
+// The buffers are never freed, so the events of threads that exited can still be exported.
+static std::mutex PerfThreadsMutex;
+static std::vector<ovrPerfThreadEvents*> PerfThreads;
+static thread_local ovrPerfThreadEvents* PerfThreadEvents = nullptr;
+
+static ovrPerfThreadEvents* GetPerfThreadEvents() {
+    if (PerfThreadEvents == nullptr) {
+        std::lock_guard<std::mutex> lock(PerfThreadsMutex);
+        PerfThreadEvents = new ovrPerfThreadEvents(static_cast<int>(PerfThreads.size()));
+        PerfThreads.push_back(PerfThreadEvents);
+    }
+    return PerfThreadEvents;
+}
+
+//==============================
+// ovrPerfRecorder
+
+std::atomic<bool> ovrPerfRecorder::Enabled(false);
+
+void ovrPerfRecorder::SetEnabled(const bool enabled) {
+    Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void ovrPerfRecorder::Record(const char* name, const double start, const double end) {
+    ovrPerfThreadEvents* thread = GetPerfThreadEvents();
+    const uint64_t index = thread->Written.load(std::memory_order_relaxed);
+    thread->Begun.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    ovrPerfSlot& slot = thread->Slots[index % EVENTS_PER_THREAD];
+    slot.Name.store(name, std::memory_order_relaxed);
+    slot.Start.store(start, std::memory_order_relaxed);
+    slot.End.store(end, std::memory_order_relaxed);
+
+    thread->Written.store(index + 1, std::memory_order_release);
+}
+
+void ovrPerfRecorder::SetThreadName(const char* name) {
+    GetPerfThreadEvents()->ThreadName.store(name, std::memory_order_relaxed);
+}
+
+void ovrPerfRecorder::GetEvents(std::vector<ovrPerfEvent>& events, const double sinceTime) {
+    events.clear();
+
+    std::lock_guard<std::mutex> lock(PerfThreadsMutex);
+    for (ovrPerfThreadEvents* thread : PerfThreads) {
+        const size_t first = events.size();
+        const uint64_t written = thread->Written.load(std::memory_order_acquire);
+        const uint64_t oldest = (written > EVENTS_PER_THREAD) ? written - EVENTS_PER_THREAD : 0;
+        for (uint64_t index = oldest; index < written; index++) {
+            const ovrPerfSlot& slot = thread->Slots[index % EVENTS_PER_THREAD];
+            ovrPerfEvent event;
+            event.Name = slot.Name.load(std::memory_order_relaxed);
+            event.Start = slot.Start.load(std::memory_order_relaxed);
+            event.End = slot.End.load(std::memory_order_relaxed);
+            event.ThreadIndex = thread->ThreadIndex;
+            events.push_back(event);
+        }
+
+        // Slot index is reused by event index + EVENTS_PER_THREAD, drop the events the thread
+        // may have started to overwrite while they were copied.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t begun = thread->Begun.load(std::memory_order_relaxed);
+        const uint64_t firstIntact = (begun > EVENTS_PER_THREAD) ? begun - EVENTS_PER_THREAD : 0;
+        const size_t numDropped = static_cast<size_t>(std::min(
+            (firstIntact > oldest) ? firstIntact - oldest : 0, written - oldest));
+        events.erase(events.begin() + first, events.begin() + first + numDropped);
+    }
+
+    events.erase(
+        std::remove_if(
+            events.begin(),
+            events.end(),
+            [sinceTime](const ovrPerfEvent& event) { return event.End < sinceTime; }),
+        events.end());
+}
+
+static void AppendJsonString(std::string& json, const char* s) {
+    json += '"';
+    for (; *s != '\0'; s++) {
+        if (*s == '"' || *s == '\\') {
+            json += '\\';
+        }
+        if (static_cast<unsigned char>(*s) >= 0x20) {
+            json += *s;
+        }
+    }
+    json += '"';
+}
+
+std::string ovrPerfRecorder::GetChromeTrace() {
+    std::vector<ovrPerfEvent> events;
+    GetEvents(events);
+
+    std::string json = "{\"traceEvents\":[\n";
+    bool first = true;
+    char buffer[128];
+    {
+        std::lock_guard<std::mutex> lock(PerfThreadsMutex);
+        for (const ovrPerfThreadEvents* thread : PerfThreads) {
+            const char* name = thread->ThreadName.load(std::memory_order_relaxed);
+            if (name == nullptr) {
+                continue;
+            }
+            snprintf(
+                buffer,
+                sizeof(buffer),
+                "%s{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":",
+                first ? "" : ",\n",
+                thread->ThreadIndex);
+            json += buffer;
+            AppendJsonString(json, name);
+            json += "}}";
+            first = false;
+        }
+    }
+    for (const ovrPerfEvent& event : events) {
+        // the trace format is in microseconds
+        snprintf(
+            buffer,
+            sizeof(buffer),
+            "%s{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"name\":",
+            first ? "" : ",\n",
+            event.ThreadIndex,
+            event.Start * 1e6,
+            (event.End - event.Start) * 1e6);
+        json += buffer;
+        AppendJsonString(json, event.Name);
+        json += '}';
+        first = false;
+    }
+    json += "\n]}\n";
+    return json;
+}
+
+bool ovrPerfRecorder::WriteChromeTrace(const char* fileName) {
+    const std::string json = GetChromeTrace();
+    FILE* f = fopen(fileName, "wb");
+    if (f == nullptr) {
+        ALOGW("ovrPerfRecorder::WriteChromeTrace - failed to open '%s'", fileName);
+        return false;
+    }
+    const bool written = fwrite(json.c_str(), 1, json.length(), f) == json.length();
+    fclose(f);
+    if (!written) {
+        ALOGW("ovrPerfRecorder::WriteChromeTrace - failed to write '%s'", fileName);
+    }
+    return written;
+}
+
+//==============================
+// ovrTimingHistory
+
+void ovrTimingHistory::Add(const double seconds) {
+    Samples[Next] = seconds;
+    Next = (Next + 1) % MAX_SAMPLES;
+    if (Count < MAX_SAMPLES) {
+        Count++;
+    }
+}
+
+void ovrTimingHistory::Clear() {
+    Next = 0;
+    Count = 0;
+}
+
+double ovrTimingHistory::GetPercentile(const double percentile) const {
+    if (Count == 0) {
+        return 0.0;
+    }
+    std::vector<double> sorted(Samples, Samples + Count);
+    const int rank = static_cast<int>(ceil(percentile / 100.0 * Count));
+    const int index = std::clamp(rank - 1, 0, Count - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+double ovrTimingHistory::GetMean() const {
+    double sum = 0.0;
+    for (int i = 0; i < Count; i++) {
+        sum += Samples[i];
+    }
+    return (Count > 0) ? sum / Count : 0.0;
+}
+
+double ovrTimingHistory::GetMax() const {
+    return (Count > 0) ? *std::max_element(Samples, Samples + Count) : 0.0;
+}
+
+//==============================
+// ovrFrameTiming
+
+ovrFrameTiming::ovrFrameTiming() : LastEndFrameTime(0.0) {
+    for (int i = 0; i < FRAME_PHASE_MAX; i++) {
+        PhaseNanoseconds[i] = 0;
+    }
+}
+
+const char* ovrFrameTiming::GetPhaseName(const ovrFramePhase phase) {
+    switch (phase) {
+        case FRAME_PHASE_EVENTS:
+            return "Events";
+        case FRAME_PHASE_WAIT:
+            return "Wait";
+        case FRAME_PHASE_INPUT:
+            return "Input";
+        case FRAME_PHASE_UPDATE:
+            return "Update";
+        case FRAME_PHASE_RENDER:
+            return "Render";
+        case FRAME_PHASE_END_FRAME:
+            return "EndFrame";
+        default:
+            return "Unknown";
+    }
+}
+
+void ovrFrameTiming::AddPhase(const ovrFramePhase phase, const double start, const double end) {
+    PhaseNanoseconds[phase].fetch_add(
+        static_cast<int64_t>((end - start) * 1e9), std::memory_order_relaxed);
+    if (ovrPerfRecorder::IsEnabled()) {
+        ovrPerfRecorder::Record(GetPhaseName(phase), start, end);
+    }
+}
+
+void ovrFrameTiming::EndFrame(const double gpuSeconds) {
+    const double now = GetTimeInSeconds();
+    std::lock_guard<std::mutex> lock(HistoryMutex);
+    if (LastEndFrameTime > 0.0) {
+        FrameHistory.Add(now - LastEndFrameTime);
+    }
+    LastEndFrameTime = now;
+
+    for (int i = 0; i < FRAME_PHASE_MAX; i++) {
+        const int64_t nanoseconds = PhaseNanoseconds[i].exchange(0, std::memory_order_relaxed);
+        PhaseHistory[i].Add(nanoseconds * 1e-9);
+    }
+    if (gpuSeconds >= 0.0) {
+        GpuHistory.Add(gpuSeconds);
+    }
+}
+
+void ovrFrameTiming::SkipFrame() {
+    for (int i = 0; i < FRAME_PHASE_MAX; i++) {
+        PhaseNanoseconds[i] = 0;
+    }
+    LastEndFrameTime = 0.0;
+}
+
+void ovrFrameTiming::Clear() {
+    std::lock_guard<std::mutex> lock(HistoryMutex);
+    for (int i = 0; i < FRAME_PHASE_MAX; i++) {
+        PhaseNanoseconds[i] = 0;
+        PhaseHistory[i].Clear();
+    }
+    FrameHistory.Clear();
+    GpuHistory.Clear();
+    LastEndFrameTime = 0.0;
+}
+
+static void AppendTimingLine(std::string& summary, const char* name, const ovrTimingHistory& h) {
+    char line[128];
+    snprintf(
+        line,
+        sizeof(line),
+        "%-8s p50 %5.2f p95 %5.2f p99 %5.2f ms\n",
+        name,
+        h.GetPercentile(50.0) * 1e3,
+        h.GetPercentile(95.0) * 1e3,
+        h.GetPercentile(99.0) * 1e3);
+    summary += line;
+}
+
+std::string ovrFrameTiming::GetSummary() const {
+    std::lock_guard<std::mutex> lock(HistoryMutex);
+    std::string summary;
+    AppendTimingLine(summary, "Frame", FrameHistory);
+    for (int i = 0; i < FRAME_PHASE_MAX; i++) {
+        AppendTimingLine(summary, GetPhaseName(ovrFramePhase(i)), PhaseHistory[i]);
+    }
+    if (GpuHistory.GetCount() > 0) {
+        AppendTimingLine(summary, "GPU", GpuHistory);
+    }
+    return summary;
+}
+
+} // namespace OVRFW
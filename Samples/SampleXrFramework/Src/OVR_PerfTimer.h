@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/*******************************************************************************
+
+Filename	:   OVR_PerfTimer.h
+Content		:	Scoped CPU timers and per-phase frame timing.
+Created		:
+Authors		:
+Language	:   C++
+
+*******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "System.h"
+
+namespace OVRFW {
+
+//==============================================================
+// ovrPerfEvent
+// One timed scope. Times are in seconds, from GetTimeInSeconds().
+struct ovrPerfEvent {
+    const char* Name; // not copied, so it must be a string literal or outlive the recorder
+    double Start;
+    double End;
+    int ThreadIndex; // in the order threads recorded their first event
+};
+
+//==============================================================
+// ovrPerfRecorder
+// Collects timed scopes from any thread while recording is enabled. Each thread writes to its
+// own ring buffer of the most recent events without taking a lock; only the first event of a
+// thread registers its buffer under a mutex.
+class ovrPerfRecorder {
+   public:
+    static const int EVENTS_PER_THREAD = 4096;
+
+    static void SetEnabled(const bool enabled);
+    static bool IsEnabled() {
+        return Enabled.load(std::memory_order_relaxed);
+    }
+
+    static void Record(const char* name, const double start, const double end);
+
+    // Names the calling thread in the trace, the name must be a string literal.
+    static void SetThreadName(const char* name);
+
+    // Copies the events that are still in the ring buffers and ended at or after sinceTime.
+    // Events written while copying are skipped rather than read half written.
+    static void GetEvents(std::vector<ovrPerfEvent>& events, const double sinceTime = 0.0);
+
+    // Writes the events that are still in the ring buffers in the Chrome trace event format,
+    // which chrome://tracing and Perfetto open.
+    static std::string GetChromeTrace();
+    static bool WriteChromeTrace(const char* fileName);
+
+   private:
+    static std::atomic<bool> Enabled;
+};
+
+//==============================================================
+// ovrScopedPerfTimer
+// Records the lifetime of the object as an event. Costs one relaxed load when not recording.
+class ovrScopedPerfTimer {
+   public:
+    explicit ovrScopedPerfTimer(const char* name)
+        : Name(name), Start(ovrPerfRecorder::IsEnabled() ? GetTimeInSeconds() : -1.0) {}
+    ~ovrScopedPerfTimer() {
+        if (Start >= 0.0) {
+            ovrPerfRecorder::Record(Name, Start, GetTimeInSeconds());
+        }
+    }
+
+    ovrScopedPerfTimer(const ovrScopedPerfTimer&) = delete;
+    ovrScopedPerfTimer& operator=(const ovrScopedPerfTimer&) = delete;
+
+   private:
+    const char* Name;
+    double Start;
+};
+
+#define OVR_PERF_TIMER(x) OVRFW::ovrScopedPerfTimer ovrPerfTimer_##x(#x)
+
+//==============================================================
+// ovrTimingHistory
+// Rolling window of the most recent samples, in seconds.
+class ovrTimingHistory {
+   public:
+    static const int MAX_SAMPLES = 512;
+
+    ovrTimingHistory() : Next(0), Count(0) {}
+
+    void Add(const double seconds);
+    void Clear();
+
+    int GetCount() const {
+        return Count;
+    }
+    // Nearest rank percentile with percentile in [0, 100], 0 if there are no samples.
+    double GetPercentile(const double percentile) const;
+    double GetMean() const;
+    double GetMax() const;
+
+   private:
+    double Samples[MAX_SAMPLES];
+    int Next;
+    int Count;
+};
+
+enum ovrFramePhase {
+    FRAME_PHASE_EVENTS, // OS and OpenXR events
+    FRAME_PHASE_WAIT, // xrWaitFrame, xrBeginFrame and locating the views
+    FRAME_PHASE_INPUT, // syncing the action sets
+    FRAME_PHASE_UPDATE, // Update() and simulating the scene
+    FRAME_PHASE_RENDER, // Render() and the eye buffers
+    FRAME_PHASE_END_FRAME, // composing the layers and xrEndFrame
+    FRAME_PHASE_MAX
+};
+
+//==============================================================
+// ovrFrameTiming
+// Per-phase CPU time of each frame, the time between frames and the GPU time of the eye
+// buffers, kept as rolling histories. Phases may be added from any thread, a phase that is
+// timed more than once in a frame adds up. EndFrame() and the history queries must be called on
+// the thread that runs the frame loop, GetSummary() may be called from any thread.
+class ovrFrameTiming {
+   public:
+    ovrFrameTiming();
+
+    static const char* GetPhaseName(const ovrFramePhase phase);
+
+    // Adds the span to the phase, and records it as an event when recording.
+    void AddPhase(const ovrFramePhase phase, const double start, const double end);
+    // Negative gpuSeconds means no GPU time is known for the frame.
+    void EndFrame(const double gpuSeconds);
+    // Drops the phase times of a frame that was not finished, and does not count the time
+    // until the next frame as a frame.
+    void SkipFrame();
+    void Clear();
+
+    const ovrTimingHistory& GetPhaseHistory(const ovrFramePhase phase) const {
+        return PhaseHistory[phase];
+    }
+    const ovrTimingHistory& GetFrameHistory() const {
+        return FrameHistory;
+    }
+    const ovrTimingHistory& GetGpuHistory() const {
+        return GpuHistory;
+    }
+
+    // One line per phase with the median, 95th and 99th percentile in milliseconds, for the log
+    // or a text overlay.
+    std::string GetSummary() const;
+
+   private:
+    // Guards the histories written by EndFrame() for GetSummary() on other threads, such as a
+    // text overlay updated by the simulation thread of XrApp::PipelinedFrames.
+    mutable std::mutex HistoryMutex;
+    std::atomic<int64_t> PhaseNanoseconds[FRAME_PHASE_MAX]; // of the frame in progress
+    ovrTimingHistory PhaseHistory[FRAME_PHASE_MAX];
+    ovrTimingHistory FrameHistory;
+    ovrTimingHistory GpuHistory;
+    double LastEndFrameTime;
+};
+
+//==============================================================
+// ovrScopedFramePhase
+// Adds the lifetime of the object to a phase.
+class ovrScopedFramePhase {
+   public:
+    ovrScopedFramePhase(ovrFrameTiming& timing, const ovrFramePhase phase)
+        : Timing(timing), Phase(phase), Start(GetTimeInSeconds()) {}
+    ~ovrScopedFramePhase() {
+        Timing.AddPhase(Phase, Start, GetTimeInSeconds());
+    }
+
+    ovrScopedFramePhase(const ovrScopedFramePhase&) = delete;
+    ovrScopedFramePhase& operator=(const ovrScopedFramePhase&) = delete;
+
+   private:
+    ovrFrameTiming& Timing;
+    ovrFramePhase Phase;
+    double Start;
+};
+
+} // namespace OVRFW
@@ -29,8 +29,10 @@ Authors     :   John Carmack
 
 #include "Misc/Log.h"
 #include "OVR_Std.h"
+#include "System.h"
 
 #include <unzip.h>
+#include <zlib.h>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -40,6 +42,8 @@ Authors     :   John Carmack
 #include <unistd.h>
 #endif
 
+#include <algorithm>
+#include <cstring>
 #include <thread>
 #include <mutex>
 #include <functional>
@@ -49,6 +53,235 @@ namespace OVRFW {
 // Decompressed files can be written here for faster access next launch
 static char CachePath[1024];
 
+// This process's package, see ovr_OpenApplicationPackage().
+static unzFile packageZipFile = 0;
+static ovrPackageIndex PackageIndex;
+
+//==============================================================
+// ovrPackageIndex
+//==============================================================
+
+static const uint32_t ZIP_LOCAL_HEADER_SIGNATURE = 0x04034b50;
+static const uint32_t ZIP_CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+static const uint32_t ZIP_END_OF_CENTRAL_DIR_SIGNATURE = 0x06054b50;
+static const size_t ZIP_LOCAL_HEADER_SIZE = 30;
+static const size_t ZIP_CENTRAL_HEADER_SIZE = 46;
+static const size_t ZIP_END_OF_CENTRAL_DIR_SIZE = 22;
+static const size_t ZIP_MAX_COMMENT_SIZE = 0xffff;
+
+// zip fields are little endian and not aligned
+static uint16_t ReadU16(uint8_t const* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t ReadU32(uint8_t const* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+        (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void ToLowerName(char const* name, size_t const length, std::string& lower) {
+    lower.assign(name, length);
+    for (char& c : lower) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+}
+
+bool ovrPackageIndex::Open(const char* packagePath) {
+    Close();
+
+#if !defined(OVR_OS_WIN32)
+    if (!File.OpenRead(packagePath) || !View.Open(&File)) {
+        ALOGW("ovrPackageIndex: failed to open '%s'", packagePath);
+        Close();
+        return false;
+    }
+    uint8_t const* data = View.MapView();
+    size_t const length = View.GetLength();
+    if (data == nullptr || length < ZIP_END_OF_CENTRAL_DIR_SIZE) {
+        ALOGW("ovrPackageIndex: failed to map '%s'", packagePath);
+        Close();
+        return false;
+    }
+
+    // the end of central directory record is followed by a comment of up to 64 KB
+    uint8_t const* eocd = nullptr;
+    intptr_t const lastOffset = static_cast<intptr_t>(length - ZIP_END_OF_CENTRAL_DIR_SIZE);
+    intptr_t const firstOffset = std::max<intptr_t>(0, lastOffset - ZIP_MAX_COMMENT_SIZE);
+    for (intptr_t offset = lastOffset; offset >= firstOffset; offset--) {
+        if (ReadU32(data + offset) == ZIP_END_OF_CENTRAL_DIR_SIGNATURE) {
+            eocd = data + offset;
+            break;
+        }
+    }
+    if (eocd == nullptr) {
+        ALOGW("ovrPackageIndex: '%s' is not a zip file", packagePath);
+        Close();
+        return false;
+    }
+
+    uint16_t const numEntries = ReadU16(eocd + 10);
+    uint32_t const centralDirSize = ReadU32(eocd + 12);
+    uint32_t const centralDirOffset = ReadU32(eocd + 16);
+    if (numEntries == 0xffff || centralDirOffset == 0xffffffff ||
+        static_cast<size_t>(centralDirOffset) + centralDirSize > length) {
+        ALOGW("ovrPackageIndex: '%s' is a zip64 or damaged package", packagePath);
+        Close();
+        return false;
+    }
+
+    Entries.reserve(numEntries);
+    std::string name;
+    uint8_t const* p = data + centralDirOffset;
+    uint8_t const* const end = p + centralDirSize;
+    for (int i = 0; i < numEntries; i++) {
+        if (p + ZIP_CENTRAL_HEADER_SIZE > end || ReadU32(p) != ZIP_CENTRAL_HEADER_SIGNATURE) {
+            ALOGW("ovrPackageIndex: damaged central directory in '%s'", packagePath);
+            Close();
+            return false;
+        }
+        uint16_t const flags = ReadU16(p + 8);
+        uint16_t const nameLength = ReadU16(p + 28);
+        uint16_t const extraLength = ReadU16(p + 30);
+        uint16_t const commentLength = ReadU16(p + 32);
+        if (p + ZIP_CENTRAL_HEADER_SIZE + nameLength > end) {
+            ALOGW("ovrPackageIndex: damaged central directory in '%s'", packagePath);
+            Close();
+            return false;
+        }
+
+        ovrEntry entry;
+        entry.CompressionMethod = ReadU16(p + 10);
+        entry.Crc = ReadU32(p + 16);
+        entry.CompressedSize = ReadU32(p + 20);
+        entry.UncompressedSize = ReadU32(p + 24);
+        entry.LocalHeaderOffset = ReadU32(p + 42);
+
+        // encrypted entries are left out, they could not be read anyway
+        if ((flags & 1) == 0) {
+            ToLowerName(
+                reinterpret_cast<char const*>(p + ZIP_CENTRAL_HEADER_SIZE), nameLength, name);
+            // keep the first of any duplicates, like unzLocateFile
+            Entries.emplace(name, entry);
+        }
+
+        p += ZIP_CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+    }
+
+    Data = data;
+    Length = length;
+    return true;
+#else
+    (void)packagePath;
+    return false;
+#endif // !defined(OVR_OS_WIN32)
+}
+
+void ovrPackageIndex::Close() {
+    Entries.clear();
+#if !defined(OVR_OS_WIN32)
+    View.Close();
+    File.Close();
+#endif
+    Data = nullptr;
+    Length = 0;
+}
+
+ovrPackageIndex::ovrEntry const* ovrPackageIndex::FindEntry(const char* nameInZip) const {
+    if (Data == nullptr || nameInZip == nullptr) {
+        return nullptr;
+    }
+    std::string name;
+    ToLowerName(nameInZip, strlen(nameInZip), name);
+    auto it = Entries.find(name);
+    return (it != Entries.end()) ? &it->second : nullptr;
+}
+
+uint8_t const* ovrPackageIndex::GetEntryData(ovrEntry const& entry) const {
+    // The local header repeats the name, but its extra field can differ from the one in the
+    // central directory, so the data offset is only known after reading it.
+    size_t const headerOffset = entry.LocalHeaderOffset;
+    if (headerOffset + ZIP_LOCAL_HEADER_SIZE > Length ||
+        ReadU32(Data + headerOffset) != ZIP_LOCAL_HEADER_SIGNATURE) {
+        return nullptr;
+    }
+    size_t const dataOffset = headerOffset + ZIP_LOCAL_HEADER_SIZE +
+        ReadU16(Data + headerOffset + 26) + ReadU16(Data + headerOffset + 28);
+    if (dataOffset + entry.CompressedSize > Length) {
+        return nullptr;
+    }
+    return Data + dataOffset;
+}
+
+bool ovrPackageIndex::ExtractEntry(ovrEntry const& entry, void* dest) const {
+    uint8_t const* src = GetEntryData(entry);
+    if (src == nullptr) {
+        return false;
+    }
+
+    if (entry.CompressionMethod == 0) {
+        if (entry.CompressedSize != entry.UncompressedSize) {
+            return false;
+        }
+        memcpy(dest, src, entry.UncompressedSize);
+        return true;
+    }
+    if (entry.CompressionMethod != Z_DEFLATED) {
+        return false;
+    }
+
+    // each call has its own stream, so this needs no lock
+    z_stream stream = {};
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) { // raw deflate data without a zlib header
+        return false;
+    }
+    stream.next_in = const_cast<Bytef*>(src);
+    stream.avail_in = entry.CompressedSize;
+    stream.next_out = static_cast<Bytef*>(dest);
+    stream.avail_out = entry.UncompressedSize;
+    int const ret = inflate(&stream, Z_FINISH);
+    bool const complete = (ret == Z_STREAM_END && stream.total_out == entry.UncompressedSize);
+    inflateEnd(&stream);
+    return complete;
+}
+
+bool ovrPackageIndex::FileExists(const char* nameInZip) const {
+    return FindEntry(nameInZip) != nullptr;
+}
+
+bool ovrPackageIndex::GetStoredFile(
+    const char* nameInZip,
+    const uint8_t*& data,
+    size_t& length) const {
+    data = nullptr;
+    length = 0;
+    ovrEntry const* entry = FindEntry(nameInZip);
+    if (entry == nullptr || entry->CompressionMethod != 0) {
+        return false;
+    }
+    data = GetEntryData(*entry);
+    if (data == nullptr) {
+        return false;
+    }
+    length = entry->UncompressedSize;
+    return true;
+}
+
+bool ovrPackageIndex::ReadFile(const char* nameInZip, std::vector<uint8_t>& buffer) const {
+    ovrEntry const* entry = FindEntry(nameInZip);
+    if (entry == nullptr) {
+        buffer.clear();
+        return false;
+    }
+    buffer.resize(entry->UncompressedSize);
+    if (!ExtractEntry(*entry, buffer.data())) {
+        buffer.clear();
+        return false;
+    }
+    return true;
+}
+
 const char* ovr_GetApplicationPackageCachePath() {
     return CachePath;
 }
@@ -99,6 +332,10 @@ void ovr_CloseOtherApplicationPackage(void*& zipFile) {
 static std::mutex PackageFileMutex;
 
 bool ovr_OtherPackageFileExists(void* zipFile, const char* nameInZip) {
+    if (zipFile == packageZipFile && PackageIndex.IsOpen()) {
+        return PackageIndex.FileExists(nameInZip);
+    }
+
     std::lock_guard<std::mutex> mutex(PackageFileMutex);
 
     const int locateRet = unzLocateFile(zipFile, nameInZip, 2 /* case insensitive */);
@@ -118,6 +355,130 @@ bool ovr_OtherPackageFileExists(void* zipFile, const char* nameInZip) {
     return true;
 }
 
+#if !defined(OVR_OS_WIN32)
+// Reads the copy of a compressed file that WriteCachedFile() extracted on an earlier launch.
+static bool ReadCachedFile(
+    const char* nameInZip,
+    const uint32_t crc,
+    const uint32_t uncompressedSize,
+    int& length,
+    void*& buffer,
+    std::function<void*(const size_t size)> const& allocBuffer,
+    std::function<void(void* buffer)> const& freeBuffer) {
+    char cacheName[1024];
+    snprintf(cacheName, sizeof(cacheName), "%s/%08x.bin", CachePath, (unsigned)crc);
+    const int fd = open(cacheName, O_RDONLY);
+    if (fd <= 0) {
+        return false;
+    }
+
+    bool success = false;
+    struct stat s = {};
+    if (fstat(fd, &s) != -1) {
+        //				LOG( "Loading cached file for: %s", nameInZip );
+        length = s.st_size;
+        if (length != (int)uncompressedSize) {
+            ALOG(
+                "Cached file for %s has length %i != %lu",
+                nameInZip,
+                length,
+                (unsigned long)uncompressedSize);
+        } else {
+            buffer = allocBuffer(length);
+            const int r = read(fd, buffer, length);
+            if (r != length) {
+                ALOG("Cached file for %s only read %i != %i", nameInZip, r, length);
+                freeBuffer(buffer);
+            } else { // Got the cached file.
+                success = true;
+            }
+        }
+    }
+    close(fd);
+
+    if (!success) {
+        length = 0;
+        buffer = NULL;
+    }
+    return success;
+}
+
+static void WriteCachedFile(
+    const char* nameInZip,
+    const uint32_t crc,
+    const void* buffer,
+    const int length) {
+    char tempName[1024];
+    snprintf(tempName, sizeof(tempName), "%s/%08x.tmp", CachePath, (unsigned)crc);
+
+    char cacheName[1024];
+    snprintf(cacheName, sizeof(cacheName), "%s/%08x.bin", CachePath, (unsigned)crc);
+    const int fd = open(tempName, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd > 0) {
+        const int r = write(fd, buffer, length);
+        close(fd);
+        if (r == length) {
+            if (rename(tempName, cacheName) == -1) {
+                ALOG("Failed to rename cache file for %s", nameInZip);
+            } else {
+                ALOG("Cache file generated for %s", nameInZip);
+            }
+        } else {
+            ALOG("Only wrote %i of %i for cached %s", r, length, nameInZip);
+        }
+    } else {
+        ALOG("Failed to open new cache file for %s: %s", nameInZip, tempName);
+    }
+}
+#endif // !defined(OVR_OS_WIN32)
+
+// Reads through the index without taking PackageFileMutex.
+static bool ReadFileFromPackageIndex(
+    const char* nameInZip,
+    int& length,
+    void*& buffer,
+    std::function<void*(const size_t size)> const& allocBuffer,
+    std::function<void(void* buffer)> const& freeBuffer) {
+#if !defined(OVR_OS_WIN32)
+    ovrPackageIndex::ovrEntry const* entry = PackageIndex.FindEntry(nameInZip);
+    if (entry == nullptr) {
+        ALOG("File '%s' not found in apk!", nameInZip);
+        return false;
+    }
+
+    const bool useCache = entry->CompressionMethod != 0 && CachePath[0];
+    if (useCache &&
+        ReadCachedFile(
+            nameInZip,
+            entry->Crc,
+            entry->UncompressedSize,
+            length,
+            buffer,
+            allocBuffer,
+            freeBuffer)) {
+        return true;
+    }
+
+    length = entry->UncompressedSize;
+    buffer = allocBuffer(length);
+    if (!PackageIndex.ExtractEntry(*entry, buffer)) {
+        ALOGW("Error reading file '%s' from apk!", nameInZip);
+        freeBuffer(buffer);
+        length = 0;
+        buffer = NULL;
+        return false;
+    }
+
+    // Optionally write out to the cache directory
+    if (useCache) {
+        WriteCachedFile(nameInZip, entry->Crc, buffer, length);
+    }
+    return true;
+#else
+    return false;
+#endif // !defined(OVR_OS_WIN32)
+}
+
 static bool ovr_ReadFileFromOtherApplicationPackageInternal(
     void* zipFile,
     const char* nameInZip,
@@ -132,6 +493,10 @@ static bool ovr_ReadFileFromOtherApplicationPackageInternal(
     }
 
 #if !defined(OVR_OS_WIN32)
+    if (zipFile == packageZipFile && PackageIndex.IsOpen()) {
+        return ReadFileFromPackageIndex(nameInZip, length, buffer, allocBuffer, freeBuffer);
+    }
+
     std::lock_guard<std::mutex> mutex(PackageFileMutex);
 
     const int locateRet = unzLocateFile(zipFile, nameInZip, 2 /* case insensitive */);
@@ -152,37 +517,17 @@ static bool ovr_ReadFileFromOtherApplicationPackageInternal(
     // Check for an already extracted cache file based on the CRC if
     // the file is compressed.
     if (info.compression_method != 0 && CachePath[0]) {
-        char cacheName[1024];
-        snprintf(cacheName, sizeof(cacheName), "%s/%08x.bin", CachePath, (unsigned)info.crc);
-        const int fd = open(cacheName, O_RDONLY);
-        if (fd > 0) {
-            struct stat s = {};
-
-            if (fstat(fd, &s) != -1) {
-                //				LOG( "Loading cached file for: %s", nameInZip );
-                length = s.st_size;
-                if (length != (int)info.uncompressed_size) {
-                    ALOG(
-                        "Cached file for %s has length %i != %lu",
-                        nameInZip,
-                        length,
-                        info.uncompressed_size);
-                    // Fall through to normal load.
-                } else {
-                    buffer = allocBuffer(length);
-                    const int r = read(fd, buffer, length);
-                    close(fd);
-                    if (r != length) {
-                        ALOG("Cached file for %s only read %i != %i", nameInZip, r, length);
-                        freeBuffer(buffer);
-                        // Fall through to normal load.
-                    } else { // Got the cached file.
-                        return true;
-                    }
-                }
-            }
-            close(fd);
+        if (ReadCachedFile(
+                nameInZip,
+                (uint32_t)info.crc,
+                (uint32_t)info.uncompressed_size,
+                length,
+                buffer,
+                allocBuffer,
+                freeBuffer)) {
+            return true;
         }
+        // Fall through to normal load.
     } else {
         //		LOG( "Not compressed: %s", nameInZip );
     }
@@ -209,27 +554,7 @@ static bool ovr_ReadFileFromOtherApplicationPackageInternal(
 
     // Optionally write out to the cache directory
     if (info.compression_method != 0 && CachePath[0]) {
-        char tempName[1024];
-        snprintf(tempName, sizeof(tempName), "%s/%08x.tmp", CachePath, (unsigned)info.crc);
-
-        char cacheName[1024];
-        snprintf(cacheName, sizeof(cacheName), "%s/%08x.bin", CachePath, (unsigned)info.crc);
-        const int fd = open(tempName, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
-        if (fd > 0) {
-            const int r = write(fd, buffer, length);
-            close(fd);
-            if (r == length) {
-                if (rename(tempName, cacheName) == -1) {
-                    ALOG("Failed to rename cache file for %s", nameInZip);
-                } else {
-                    ALOG("Cache file generated for %s", nameInZip);
-                }
-            } else {
-                ALOG("Only wrote %i of %i for cached %s", r, length, nameInZip);
-            }
-        } else {
-            ALOG("Failed to open new cache file for %s: %s", nameInZip, tempName);
-        }
+        WriteCachedFile(nameInZip, (uint32_t)info.crc, buffer, length);
     }
 
     return true;
@@ -277,8 +602,6 @@ bool ovr_ReadFileFromOtherApplicationPackage(
 // Functions for reading assets from this process's application package
 //--------------------------------------------------------------
 
-static unzFile packageZipFile = 0;
-
 void* ovr_GetApplicationPackageFile() {
     return packageZipFile;
 }
@@ -291,12 +614,29 @@ void ovr_OpenApplicationPackage(const char* packageCodePath, const char* cachePa
         OVR::OVR_strncpy(CachePath, sizeof(CachePath), cachePath_, sizeof(CachePath) - 1);
     }
     packageZipFile = ovr_OpenOtherApplicationPackage(packageCodePath);
+
+    // Reads of the package fall back to the serialized minizip path if this fails.
+    const double startTime = GetTimeInSeconds();
+    if (PackageIndex.Open(packageCodePath)) {
+        ALOG(
+            "Indexed %i files in '%s' in %.2f ms",
+            PackageIndex.GetNumFiles(),
+            packageCodePath,
+            (GetTimeInSeconds() - startTime) * 1000.0);
+    }
 }
 
 bool ovr_PackageFileExists(const char* nameInZip) {
     return ovr_OtherPackageFileExists(packageZipFile, nameInZip);
 }
 
+bool ovr_GetStoredFileFromApplicationPackage(
+    const char* nameInZip,
+    const uint8_t*& data,
+    size_t& length) {
+    return PackageIndex.GetStoredFile(nameInZip, data, length);
+}
+
 bool ovr_ReadFileFromApplicationPackage(const char* nameInZip, int& length, void*& buffer) {
     return ovr_ReadFileFromOtherApplicationPackage(packageZipFile, nameInZip, length, buffer);
 }
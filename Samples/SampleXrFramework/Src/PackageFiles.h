@@ -27,8 +27,14 @@ Authors     :   John Carmack
 
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "OVR_Types.h"
+#include "OVR_MappedFile.h"
+
 // The application package is the moral equivalent of the filesystem, so
 // I don't feel too bad about making it globally accessible, versus requiring
 // an App pointer to be handed around to everything that might want to load
@@ -56,6 +62,66 @@ class OvrApkFile {
     void* ZipFile;
 };
 
+//==============================================================
+// ovrPackageIndex
+// Hashed index of the central directory of a package, built once when the package is opened.
+// Lookups and reads only touch the index and a read-only memory mapping of the package, so any
+// number of threads can read at the same time without a lock. Names are case insensitive, like
+// the minizip lookups. Zip64 and encrypted packages are not supported.
+//==============================================================
+class ovrPackageIndex {
+   public:
+    ovrPackageIndex() : Data(nullptr), Length(0) {}
+    ~ovrPackageIndex() {
+        Close();
+    }
+
+    ovrPackageIndex(const ovrPackageIndex&) = delete;
+    ovrPackageIndex& operator=(const ovrPackageIndex&) = delete;
+
+    bool Open(const char* packagePath);
+    void Close();
+
+    bool IsOpen() const {
+        return Data != nullptr;
+    }
+    int GetNumFiles() const {
+        return static_cast<int>(Entries.size());
+    }
+
+    bool FileExists(const char* nameInZip) const;
+
+    // Returns a pointer into the mapping for a file stored without compression, valid until the
+    // index is closed. Returns false for compressed files.
+    bool GetStoredFile(const char* nameInZip, const uint8_t*& data, size_t& length) const;
+
+    // Copies or decompresses the file into buffer.
+    bool ReadFile(const char* nameInZip, std::vector<uint8_t>& buffer) const;
+
+    struct ovrEntry {
+        uint32_t LocalHeaderOffset;
+        uint32_t CompressedSize;
+        uint32_t UncompressedSize;
+        uint32_t Crc;
+        uint16_t CompressionMethod; // 0 = stored, 8 = deflated
+    };
+
+    ovrEntry const* FindEntry(const char* nameInZip) const;
+    // Returns the compressed (or stored) bytes of an entry.
+    uint8_t const* GetEntryData(ovrEntry const& entry) const;
+    // Decompresses or copies the entry into dest, which must hold UncompressedSize bytes.
+    bool ExtractEntry(ovrEntry const& entry, void* dest) const;
+
+   private:
+#if !defined(OVR_OS_WIN32) // MappedFile is not implemented on windows
+    MappedFile File;
+    MappedView View;
+#endif
+    uint8_t const* Data;
+    size_t Length;
+    std::unordered_map<std::string, ovrEntry> Entries; // by lower case name
+};
+
 //--------------------------------------------------------------
 // Functions for reading assets from other application packages
 //--------------------------------------------------------------
@@ -67,7 +133,7 @@ void* ovr_OpenOtherApplicationPackage(const char* packageName);
 // Call this to close another application package after loading resources from it.
 void ovr_CloseOtherApplicationPackage(void*& zipFile);
 
-// These are probably NOT thread safe!
+// These are serialized behind a single lock, unlike the functions for this process's package.
 bool ovr_OtherPackageFileExists(void* zipFile, const char* nameInZip);
 
 // Returns NULL buffer if the file is not found.
@@ -98,11 +164,21 @@ const char* ovr_GetApplicationPackageCachePath();
 // If cachePath is not NULL, compressed files that are read will be written
 // out to the cachePath with the CRC as the filename so they can be read
 // back in much faster.
+// This also builds an ovrPackageIndex for the package, so the functions below
+// can be called from any number of threads at once.
 void ovr_OpenApplicationPackage(const char* packageName, const char* cachePath);
 
-// These are probably NOT thread safe!
 bool ovr_PackageFileExists(const char* nameInZip);
 
+// Returns a pointer into the memory mapped package for a file stored without
+// compression, which saves a copy for assets that are compressed already
+// (KTX2, ASTC, audio). The pointer stays valid for the life of the process.
+// Returns false if the file is compressed or not found.
+bool ovr_GetStoredFileFromApplicationPackage(
+    const char* nameInZip,
+    const uint8_t*& data,
+    size_t& length);
+
 // Returns NULL buffer if the file is not found.
 bool ovr_ReadFileFromApplicationPackage(const char* nameInZip, int& length, void*& buffer);
 
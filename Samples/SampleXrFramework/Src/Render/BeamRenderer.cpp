@@ -148,7 +148,7 @@ void ovrBeamRenderer::Init(const int maxBeams, const bool depthTest) {
     }
 
     Surf.surfaceName = "beams";
-    Surf.geo.Create(attr, indices);
+    Surf.geo.CreateDynamic(attr, indices);
     Surf.geo.primitiveType = GlGeometry::kPrimitiveTypeTriangles;
     Surf.geo.indexCount = 0;
 
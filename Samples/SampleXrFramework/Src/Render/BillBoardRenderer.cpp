@@ -149,7 +149,7 @@ void ovrBillBoardRenderer::Init(const int maxBillBoards, const bool depthTest) {
     }
 
     Surf.surfaceName = "billboards";
-    Surf.geo.Create(attr, indices);
+    Surf.geo.CreateDynamic(attr, indices);
     Surf.geo.primitiveType = GlGeometry::kPrimitiveTypeTriangles;
     Surf.geo.indexCount = 0;
 
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   BillboardInstances.cpp
+Content     :   Compact per instance records for quads expanded in the vertex shader.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "BillboardInstances.h"
+#include "GlGeometry.h"
+#include "Egl.h"
+
+#include <math.h>
+#include <algorithm>
+
+using OVR::Vector2f;
+using OVR::Vector3f;
+using OVR::Vector4f;
+
+namespace OVRFW {
+
+uint32_t PackColorUnorm8(const Vector4f& color) {
+    const uint32_t r = static_cast<uint32_t>(std::clamp(color.x, 0.0f, 1.0f) * 255.0f + 0.5f);
+    const uint32_t g = static_cast<uint32_t>(std::clamp(color.y, 0.0f, 1.0f) * 255.0f + 0.5f);
+    const uint32_t b = static_cast<uint32_t>(std::clamp(color.z, 0.0f, 1.0f) * 255.0f + 0.5f);
+    const uint32_t a = static_cast<uint32_t>(std::clamp(color.w, 0.0f, 1.0f) * 255.0f + 0.5f);
+    return (a << 24) | (b << 16) | (g << 8) | r;
+}
+
+int16_t PackSnorm16(const float value) {
+    return static_cast<int16_t>(lrintf(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+void PackParticleInstance(
+    ovrParticleInstance& instance,
+    const Vector3f& position,
+    const float scale,
+    const float orientation,
+    const Vector4f& color,
+    const Vector2f& uvMins,
+    const Vector2f& uvMaxs) {
+    instance.Position[0] = position.x;
+    instance.Position[1] = position.y;
+    instance.Position[2] = position.z;
+    instance.Scale = scale;
+    instance.Rotation[0] = PackSnorm16(cosf(orientation));
+    instance.Rotation[1] = PackSnorm16(sinf(orientation));
+    instance.UvRect[0] = PackSnorm16(uvMins.x);
+    instance.UvRect[1] = PackSnorm16(uvMins.y);
+    instance.UvRect[2] = PackSnorm16(uvMaxs.x);
+    instance.UvRect[3] = PackSnorm16(uvMaxs.y);
+    instance.Color = PackColorUnorm8(color);
+}
+
+void PackGlyphInstance(
+    ovrGlyphInstance& instance,
+    const Vector3f& origin,
+    const Vector3f& right,
+    const Vector3f& up,
+    const Vector2f& uvUpperLeft,
+    const Vector2f& uvLowerRight,
+    const uint32_t color,
+    const uint32_t fontParms) {
+    instance.Origin[0] = origin.x;
+    instance.Origin[1] = origin.y;
+    instance.Origin[2] = origin.z;
+    instance.Right[0] = right.x;
+    instance.Right[1] = right.y;
+    instance.Right[2] = right.z;
+    instance.Up[0] = up.x;
+    instance.Up[1] = up.y;
+    instance.Up[2] = up.z;
+    instance.UvRect[0] = PackSnorm16(uvUpperLeft.x);
+    instance.UvRect[1] = PackSnorm16(uvUpperLeft.y);
+    instance.UvRect[2] = PackSnorm16(uvLowerRight.x);
+    instance.UvRect[3] = PackSnorm16(uvLowerRight.y);
+    instance.Color = color;
+    instance.FontParms = fontParms;
+}
+
+void CreateBillboardGeometry(
+    GlGeometry& geo,
+    const ovrInstanceAttribute* attributes,
+    const int attributeCount,
+    const int instanceSize,
+    const int maxInstances) {
+    // The corners are counter clockwise from the lower left, see the vertex shaders.
+    static const uint16_t quadIndices[6] = {0, 1, 2, 0, 2, 3};
+
+    geo.vertexCount = 4;
+    geo.indexCount = 6;
+    geo.IndexType = GlGeometry::GetIndexType(sizeof(quadIndices[0]));
+    geo.vertexBufferSize = std::max(maxInstances, 1) * instanceSize;
+
+    glGenVertexArrays(1, &geo.vertexArrayObject);
+    glBindVertexArray(geo.vertexArrayObject);
+
+    glGenBuffers(1, &geo.vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, geo.vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, geo.vertexBufferSize, nullptr, GL_STREAM_DRAW);
+
+    for (int i = 0; i < attributeCount; i++) {
+        const ovrInstanceAttribute& a = attributes[i];
+        glEnableVertexAttribArray(a.Location);
+        glVertexAttribPointer(
+            a.Location,
+            a.Size,
+            a.Type,
+            a.Normalized ? GL_TRUE : GL_FALSE,
+            instanceSize,
+            reinterpret_cast<void*>(static_cast<uintptr_t>(a.Offset)));
+        glVertexAttribDivisor(a.Location, 1);
+    }
+
+    glGenBuffers(1, &geo.indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geo.indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(quadIndices), quadIndices, GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void UpdateBillboardInstances(
+    GlGeometry& geo,
+    const void* instances,
+    const int instanceCount,
+    const int instanceSize) {
+    const int size = instanceCount * instanceSize;
+    if (size > geo.vertexBufferSize) {
+        geo.vertexBufferSize = std::max(size, geo.vertexBufferSize * 2);
+    }
+    // The attribute pointers refer to the buffer object, so they stay valid when its storage
+    // is replaced.
+    glBindBuffer(GL_ARRAY_BUFFER, geo.vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, geo.vertexBufferSize, nullptr, GL_STREAM_DRAW);
+    if (size > 0) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, instances);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+} // namespace OVRFW
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   BillboardInstances.h
+Content     :   Compact per instance records for quads expanded in the vertex shader.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include "OVR_Math.h"
+
+#include <cstdint>
+
+namespace OVRFW {
+
+class GlGeometry;
+
+// Instead of four vertices per quad, one of these records is uploaded per particle or glyph and
+// the vertex shader expands it to the corners of the quad, with the corner taken from
+// gl_VertexID. The packing functions do not touch GL, so they can be tested without a context.
+//
+// The corner of a quad is (x, y) with x in [0, 1] from left to right and y in [0, 1] from bottom
+// to top. Texture coordinates come from the UV rectangle in the same way the CPU paths assign
+// them: (UvRect[0], UvRect[1]) at the upper left and (UvRect[2], UvRect[3]) at the lower right.
+
+// A particle, billboarded to face the view position in the vertex shader.
+struct ovrParticleInstance {
+    float Position[3];
+    float Scale; // width and height of the quad
+    int16_t Rotation[2]; // cosine and sine of the roll, snorm16
+    int16_t UvRect[4]; // snorm16
+    uint32_t Color; // RGBA unorm8, red in the lowest byte
+};
+
+// A glyph, already transformed with the pivot and billboard rotation of its text block.
+struct ovrGlyphInstance {
+    float Origin[3]; // lower left corner
+    float Right[3]; // from the lower left to the lower right corner
+    float Up[3]; // from the lower left to the upper left corner
+    int16_t UvRect[4]; // snorm16
+    uint32_t Color; // ABGR
+    uint32_t FontParms; // same as the per vertex font parms
+};
+
+static_assert(sizeof(ovrParticleInstance) == 32, "ovrParticleInstance is not packed");
+static_assert(sizeof(ovrGlyphInstance) == 52, "ovrGlyphInstance is not packed");
+
+// Components are clamped to [0, 1].
+uint32_t PackColorUnorm8(const OVR::Vector4f& color);
+// Clamped to [-1, 1].
+int16_t PackSnorm16(const float value);
+
+void PackParticleInstance(
+    ovrParticleInstance& instance,
+    const OVR::Vector3f& position,
+    const float scale,
+    const float orientation,
+    const OVR::Vector4f& color,
+    const OVR::Vector2f& uvMins,
+    const OVR::Vector2f& uvMaxs);
+
+void PackGlyphInstance(
+    ovrGlyphInstance& instance,
+    const OVR::Vector3f& origin,
+    const OVR::Vector3f& right,
+    const OVR::Vector3f& up,
+    const OVR::Vector2f& uvUpperLeft,
+    const OVR::Vector2f& uvLowerRight,
+    const uint32_t color,
+    const uint32_t fontParms);
+
+// Where one component of the instance records is fed to the vertex shader.
+struct ovrInstanceAttribute {
+    int Location; // VERTEX_ATTRIBUTE_LOCATION_*
+    int Size; // number of components
+    uint32_t Type; // GL_FLOAT / GL_SHORT / GL_UNSIGNED_BYTE / etc
+    bool Normalized;
+    int Offset; // in bytes from the start of the record
+};
+
+// Creates a VAO with a single quad of six indices and an instance buffer with room for
+// maxInstances records of instanceSize bytes. Draw it with numInstances set to the number of
+// records written by UpdateBillboardInstances(). Free it with GlGeometry::Free().
+void CreateBillboardGeometry(
+    GlGeometry& geo,
+    const ovrInstanceAttribute* attributes,
+    const int attributeCount,
+    const int instanceSize,
+    const int maxInstances);
+
+// Replaces the instance records, orphaning the previous storage so the GPU can still read it.
+// The buffer grows when there are more records than it has room for.
+void UpdateBillboardInstances(
+    GlGeometry& geo,
+    const void* instances,
+    const int instanceCount,
+    const int instanceSize);
+
+} // namespace OVRFW
@@ -34,6 +34,19 @@ Authors     :   Jonathan E. Wright
 #include "BitmapFont.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#if defined(OVR_CPU_X86_64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define OVR_FONT_SSE2 1
+#elif defined(__aarch64__) && (defined(OVR_CPU_ARM_NEON) || defined(__ARM_NEON))
+#include <arm_neon.h>
+#define OVR_FONT_NEON 1
+#endif
 
 #include <errno.h>
 #include <math.h>
@@ -44,11 +57,16 @@ Authors     :   Jonathan E. Wright
 #include "OVR_Math.h"
 
 #include "Misc/Log.h"
+#include "Misc/JobPool.h"
+#include "System.h"
 
 #include "Egl.h"
 #include "GlProgram.h"
 #include "GlTexture.h"
 #include "GlGeometry.h"
+#include "BillboardInstances.h"
+#include "RadixSort.h"
+#include "SdfGlyphAtlas.h"
 
 #include "PackageFiles.h"
 #include "OVR_FileSys.h"
@@ -215,6 +233,30 @@ static char const* FontSingleTextureVertexShaderSrc = R"glsl(
 	}
 )glsl";
 
+// Expands the quad of a glyph from its instance record, the corners are counter clockwise from
+// the lower left.
+static char const* FontInstancedVertexShaderSrc = R"glsl(
+	attribute vec3 InstancePosition;
+	attribute vec3 InstanceRight;
+	attribute vec3 InstanceUp;
+	attribute vec4 InstanceUvRect;
+	attribute vec4 VertexColor;
+	attribute vec4 FontParms;
+	varying highp vec2 oTexCoord;
+	varying lowp vec4 oColor;
+	varying vec4 oFontParms;
+	void main()
+	{
+	    highp vec2 corner = vec2( ( gl_VertexID == 1 || gl_VertexID == 2 ) ? 1.0 : 0.0,
+	                              ( gl_VertexID >= 2 ) ? 1.0 : 0.0 );
+	    highp vec3 position = InstancePosition + InstanceRight * corner.x + InstanceUp * corner.y;
+	    gl_Position = TransformVertex( vec4( position, 1.0 ) );
+	    oTexCoord = mix( InstanceUvRect.xy, InstanceUvRect.zw, vec2( corner.x, 1.0 - corner.y ) );
+	    oColor = VertexColor;
+	    oFontParms = FontParms;
+	}
+)glsl";
+
 // Use derivatives to make the faded color and alpha boundaries a
 // consistent thickness regardless of font scale.
 static char const* SDFFontFragmentShaderSrc = R"glsl(
@@ -272,6 +314,7 @@ class ovrFontWeight {
 class FontInfoType {
    public:
     static const int FNT_FILE_VERSION;
+    static const int MAX_GLYPHS = 0xffff; // only the first unicode plane, see LoadFromBuffer()
 
     // This is used to scale the UVs to world units that work with the current scale values used
     // throughout the native code. Unfortunately the original code didn't account for the image size
@@ -296,8 +339,17 @@ class FontInfoType {
     bool Save(char const* filename);
 
     FontGlyphType const& GlyphForCharCode(uint32_t const charCode) const;
+    bool HasGlyph(uint32_t const charCode) const {
+        return charCode < CharCodeMap.size() && CharCodeMap[charCode] >= 0;
+    }
     ovrFontWeight GetFontWeight(int const index) const;
 
+    // Adds a glyph with normalized metrics, growing the character code map as needed.
+    void AddGlyph(FontGlyphType const& glyph);
+    // Sets ScaleFactorX / ScaleFactorY from the size of the 'O' glyph in pixels, so text is the
+    // same size regardless of the resolution of the font image.
+    void CalcScaleFactors(double const oWidth, double const oHeight);
+
     std::string FontName; // name of the font (not necessarily the file name)
     std::string CommandLine; // command line used to generate this font
     std::string ImageFileName; // the file name of the font image
@@ -333,13 +385,27 @@ const float FontInfoType::DEFAULT_SCALE_FACTOR = 512.0f;
 
 class BitmapFontLocal : public BitmapFont {
    public:
-    BitmapFontLocal() : FontTexture(), ImageWidth(0), ImageHeight(0) {}
+    BitmapFontLocal()
+        : FontTexture(),
+          ImageWidth(0),
+          ImageHeight(0),
+          Rasterizer(nullptr),
+          JobPool(nullptr),
+          GlyphPixelHeight(0),
+          GlyphSpread(0),
+          LoadGeneration(0) {}
     ~BitmapFontLocal() {
         FreeTexture(FontTexture);
         GlProgram::Free(FontProgram);
+        GlProgram::Free(FontInstancedProgram);
     }
 
     virtual bool Load(ovrFileSys& fileSys, const char* uri);
+    virtual bool LoadFromRasterizer(
+        const ovrGlyphRasterizer& rasterizer,
+        ovrJobPool* jobPool,
+        const int pixelHeight,
+        const int atlasSize);
 
     // Calculates the native (unscaled) width of the text string. Line endings are ignored.
     virtual float CalcTextWidth(char const* text) const;
@@ -410,6 +476,9 @@ class BitmapFontLocal : public BitmapFont {
     const GlProgram& GetFontProgram() const {
         return FontProgram;
     }
+    const GlProgram& GetFontInstancedProgram() const {
+        return FontInstancedProgram;
+    }
     int GetImageWidth() const {
         return ImageWidth;
     }
@@ -419,16 +488,44 @@ class BitmapFontLocal : public BitmapFont {
     const GlTexture& GetFontTexture() const {
         return FontTexture;
     }
+    // Uploads the glyphs generated since the last call to the texture, must be called on the GL
+    // thread before text that uses them is drawn.
+    void UploadGlyphs() const;
+    // Unique to each load, so cached text layouts of a reloaded font are never reused even if
+    // the font object, or a new one at the same address, is reloaded.
+    uint32_t GetLoadGeneration() const {
+        return LoadGeneration;
+    }
 
    private:
-    FontInfoType FontInfo;
+    // mutable because glyphs generated at runtime are added when text is measured
+    mutable FontInfoType FontInfo;
     GlTexture FontTexture;
     int ImageWidth;
     int ImageHeight;
 
     GlProgram FontProgram;
+    GlProgram FontInstancedProgram; // for glyph instance records
+
+    // only set for fonts loaded with LoadFromRasterizer()
+    const ovrGlyphRasterizer* Rasterizer;
+    ovrJobPool* JobPool;
+    int GlyphPixelHeight;
+    int GlyphSpread; // in pixels around each glyph
+    mutable ovrSdfGlyphAtlas GlyphAtlas;
+    // Glyphs are packed where text is measured and uploaded on the GL thread.
+    mutable std::mutex GlyphAtlasMutex;
+    mutable std::vector<bool> FailedGlyphs; // by character code, not retried
+    mutable std::vector<uint32_t> MissingGlyphs;
+    uint32_t LoadGeneration;
 
    private:
+    void CreatePrograms();
+    void NextLoadGeneration();
+    // Generates the glyphs for any character in the text that the font does not have yet. This is
+    // called before glyphs are looked up, so it never invalidates a glyph reference in use.
+    void EnsureGlyphs(char const* text) const;
+    void GenerateGlyphs(std::vector<uint32_t> const& charCodes) const;
     bool LoadImage(ovrFileSys& fileSys, char const* uri);
     bool LoadImageFromBuffer(
         char const* imageName,
@@ -560,81 +657,54 @@ static bool CheckForFormatEscape(char const** buffer, uint32_t& color, uint32_t&
 // world space and stuffed into the VBO before rendering (once the current MVP is known).
 // The vertices can be pivoted around the Pivot point to face the camera, then an additional
 // rotation applied.
+// The vertices are not owned by the block, the text layout cache of the surface keeps them
+// until Finish().  The cached vertices are shared by every color the text is drawn in, so the
+// color of the block replaces the color of the leading vertices that were not colored by an
+// escape in the text.
 class VertexBlockType {
    public:
     VertexBlockType()
         : Font(NULL),
           Verts(NULL),
           NumVerts(0),
+          Color(0),
+          NumColorVerts(0),
           Pivot(0.0f),
           Rotation(),
           Billboard(true),
           TrackRoll(false) {}
 
-    VertexBlockType(VertexBlockType const& other)
-        : Font(NULL),
-          Verts(NULL),
-          NumVerts(0),
-          Pivot(0.0f),
-          Rotation(),
-          Billboard(true),
-          TrackRoll(false) {
-        Copy(other);
-    }
-
-    VertexBlockType& operator=(VertexBlockType const& other) {
-        Copy(other);
-        return *this;
-    }
-
-    void Copy(VertexBlockType const& other) {
-        if (&other == this) {
-            return;
-        }
-        delete[] Verts;
-        Font = other.Font;
-        Verts = other.Verts;
-        NumVerts = other.NumVerts;
-        Pivot = other.Pivot;
-        Rotation = other.Rotation;
-        Billboard = other.Billboard;
-        TrackRoll = other.TrackRoll;
-
-        other.Font = NULL;
-        other.Verts = NULL;
-        other.NumVerts = 0;
-    }
-
     VertexBlockType(
         BitmapFont const& font,
+        fontVertex_t const* verts,
         int const numVerts,
+        uint32_t const color,
+        int const numColorVerts,
         Vector3f const& pivot,
         Quatf const& rot,
         bool const billboard,
         bool const trackRoll)
         : Font(&font),
+          Verts(verts),
           NumVerts(numVerts),
+          Color(color),
+          NumColorVerts(numColorVerts),
           Pivot(pivot),
           Rotation(rot),
           Billboard(billboard),
-          TrackRoll(trackRoll) {
-        Verts = new fontVertex_t[numVerts];
-    }
-
-    ~VertexBlockType() {
-        Free();
-    }
+          TrackRoll(trackRoll) {}
 
     void Free() {
         Font = NULL;
-        delete[] Verts;
         Verts = NULL;
         NumVerts = 0;
     }
 
-    mutable BitmapFont const* Font; // the font used to render text into this vertex block
-    mutable fontVertex_t* Verts; // the vertices
-    mutable int NumVerts; // the number of vertices in the block
+    BitmapFont const* Font; // the font used to render text into this vertex block
+    fontVertex_t const* Verts; // the vertices
+    int NumVerts; // the number of vertices in the block
+    uint32_t Color; // ABGR color of the block
+    int NumColorVerts; // the number of leading vertices that take Color instead of their own
     Vector3f Pivot; // postion this vertex block can be rotated around
     Quatf Rotation; // additional rotation to apply
     bool Billboard; // true to always face the camera
@@ -693,11 +763,9 @@ GlGeometry FontGeometry(int maxQuads, Bounds3f& localBounds) {
         sizeof(fontVertex_t),
         (void*)offsetof(fontVertex_t, fontParms));
 
-    fontIndex_t* indices = new fontIndex_t[Geo.indexCount];
-    const int indexByteCount = Geo.indexCount * sizeof(fontIndex_t);
-
-    // indices never change
-    fontIndex_t v = 0;
+    // indices never change, 32 bit ones are only needed beyond 16384 quads
+    std::vector<uint32_t> indices(Geo.indexCount);
+    uint32_t v = 0;
     for (int i = 0; i < maxQuads; i++) {
         indices[i * 6 + 0] = v + 2;
         indices[i * 6 + 1] = v + 1;
@@ -710,21 +778,77 @@ GlGeometry FontGeometry(int maxQuads, Bounds3f& localBounds) {
 
     glGenBuffers(1, &Geo.indexBuffer);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Geo.indexBuffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexByteCount, (void*)indices, GL_STATIC_DRAW);
+    if (Geo.vertexCount <= GlGeometry::MAX_GEOMETRY_VERTICES) {
+        const std::vector<fontIndex_t> shortIndices(indices.begin(), indices.end());
+        Geo.IndexType = GlGeometry::GetIndexType(sizeof(fontIndex_t));
+        glBufferData(
+            GL_ELEMENT_ARRAY_BUFFER,
+            shortIndices.size() * sizeof(fontIndex_t),
+            (void*)shortIndices.data(),
+            GL_STATIC_DRAW);
+    } else {
+        Geo.IndexType = GlGeometry::GetIndexType(sizeof(uint32_t));
+        glBufferData(
+            GL_ELEMENT_ARRAY_BUFFER,
+            indices.size() * sizeof(uint32_t),
+            (void*)indices.data(),
+            GL_STATIC_DRAW);
+    }
 
     glBindVertexArray(0);
 
-    delete[] indices;
+    return Geo;
+}
+
+// Sets up the instance buffer and VAO for drawing glyphs from ovrGlyphInstance records
+GlGeometry FontInstancedGeometry(int maxGlyphs) {
+    static const ovrInstanceAttribute attributes[] = {
+        {VERTEX_ATTRIBUTE_LOCATION_INSTANCE_POSITION,
+         3,
+         GL_FLOAT,
+         false,
+         offsetof(ovrGlyphInstance, Origin)},
+        {VERTEX_ATTRIBUTE_LOCATION_INSTANCE_RIGHT,
+         3,
+         GL_FLOAT,
+         false,
+         offsetof(ovrGlyphInstance, Right)},
+        {VERTEX_ATTRIBUTE_LOCATION_INSTANCE_UP, 3, GL_FLOAT, false, offsetof(ovrGlyphInstance, Up)},
+        {VERTEX_ATTRIBUTE_LOCATION_INSTANCE_UV_RECT,
+         4,
+         GL_SHORT,
+         true,
+         offsetof(ovrGlyphInstance, UvRect)},
+        {VERTEX_ATTRIBUTE_LOCATION_COLOR,
+         4,
+         GL_UNSIGNED_BYTE,
+         true,
+         offsetof(ovrGlyphInstance, Color)},
+        {VERTEX_ATTRIBUTE_LOCATION_FONT_PARMS,
+         4,
+         GL_UNSIGNED_BYTE,
+         true,
+         offsetof(ovrGlyphInstance, FontParms)},
+    };
 
+    GlGeometry Geo;
+    CreateBillboardGeometry(
+        Geo,
+        attributes,
+        sizeof(attributes) / sizeof(attributes[0]),
+        sizeof(ovrGlyphInstance),
+        maxGlyphs);
     return Geo;
 }
 
 struct ovrFormat {
-    ovrFormat(uint32_t const color) : Color(color), Weight(0xffffffff), LastWeight(0xffffffff) {}
+    ovrFormat(uint32_t const color)
+        : Color(color), Weight(0xffffffff), LastWeight(0xffffffff), ColorEscaped(false) {}
 
     uint32_t Color;
     uint32_t Weight;
     uint32_t LastWeight;
+    bool ColorEscaped; // true once an escape in the text has replaced the color
 };
 
 static void UpdateFormat(
@@ -733,8 +857,11 @@ static void UpdateFormat(
     char const** buffer,
     ovrFormat& format,
     uint8_t vertexParms[4]) {
-    while (CheckForFormatEscape(buffer, format.Color, format.Weight))
-        ;
+    for (char const* escape = *buffer; CheckForFormatEscape(buffer, format.Color, format.Weight);
+         escape = *buffer) {
+        // a hex digit after the ~~ means the escape was a color
+        format.ColorEscaped = format.ColorEscaped || IsHexDigit(escape[2]);
+    }
     if (format.Weight != format.LastWeight && format.Weight != 0xffffffff) {
         ovrFontWeight const& w = fontInfo.GetFontWeight(format.Weight);
         vertexParms[1] =
@@ -753,25 +880,33 @@ static void UpdateFormat(
 }
 
 //==============================
-// DrawText3D
-VertexBlockType DrawTextToVertexBlock(
+// LayoutText
+// Writes the quads of the glyphs in local space, relative to the position of the text.
+// If numDefaultColorVerts is given, it receives the number of leading vertices that use the
+// passed color; the vertices after it were colored by a format escape in the text.
+static void LayoutText(
     BitmapFont const& font,
     fontParms_t const& fontParms,
-    Vector3f const& pos,
     Vector3f const& normal,
     Vector3f const& up,
     float scale,
     Vector4f const& color,
     char const* text,
-    Vector3f* toNextLine = nullptr) {
+    std::vector<fontVertex_t>& verts,
+    Vector3f* toNextLine = nullptr,
+    int* numDefaultColorVerts = nullptr) {
+    verts.clear();
     if (toNextLine) {
         *toNextLine = Vector3f::ZERO;
     }
+    if (numDefaultColorVerts) {
+        *numDefaultColorVerts = 0;
+    }
     if (text == NULL || text[0] == '\0') {
 #if defined(OVR_BUILD_DEBUG)
-        ALOG("DrawTextToVertexBlock: null or empty text!");
+        ALOG("LayoutText: null or empty text!");
 #endif
-        return VertexBlockType(); // nothing to do here, move along
+        return; // nothing to do here, move along
     }
 
     // TODO: multiple line support -- we would need to calculate the horizontal width
@@ -799,14 +934,14 @@ VertexBlockType DrawTextToVertexBlock(
 
     if (len == 0) {
 #if defined(OVR_BUILD_DEBUG)
-        ALOG("DrawTextToVertexBlock: zero-length text after metrics!");
+        ALOG("LayoutText: zero-length text after metrics!");
 #endif
-        return VertexBlockType();
+        return;
     }
 
     if (!normal.IsNormalized()) {
         ALOG(
-            "DrawTextToVertexBlock: normal = ( %g, %g, %g ), text = '%s'",
+            "LayoutText: normal = ( %g, %g, %g ), text = '%s'",
             normal.x,
             normal.y,
             normal.z,
@@ -814,7 +949,7 @@ VertexBlockType DrawTextToVertexBlock(
         assert(normal.IsNormalized());
     }
     if (!up.IsNormalized()) {
-        ALOG("DrawTextToVertexBlock: up = ( %g, %g, %g ), text = '%s'", up.x, up.y, up.z, text);
+        ALOG("LayoutText: up = ( %g, %g, %g ), text = '%s'", up.x, up.y, up.z, text);
         assert(up.IsNormalized());
     }
 
@@ -824,9 +959,9 @@ VertexBlockType DrawTextToVertexBlock(
     float const xScale = AsLocal(font).GetFontInfo().ScaleFactorX * scale;
     float const yScale = AsLocal(font).GetFontInfo().ScaleFactorY * scale;
 
-    // allocate a vertex block
+    // allocate the vertices, reusing the capacity of the vector
     const int numVerts = 4 * static_cast<int>(len);
-    VertexBlockType vb(font, numVerts, pos, Quatf(), fontParms.Billboard, fontParms.TrackRoll);
+    verts.resize(numVerts);
 
     Vector3f const right = up.Cross(normal);
     Vector3f const r = (fontParms.Billboard) ? Vector3f(1.0f, 0.0f, 0.0f) : right;
@@ -904,11 +1039,17 @@ VertexBlockType DrawTextToVertexBlock(
     ovrFormat format(ColorToABGR(color));
 
     int curLine = 0;
-    fontVertex_t* v = vb.Verts;
+    fontVertex_t* v = verts.data();
     char const* p = text;
     size_t i = 0;
 
+    // escapes cannot restore the passed color, so everything after the first color escape keeps
+    // the color of the escape
+    int defaultColorVerts = numVerts;
     UpdateFormat(fontInfo, fontParms, &p, format, vertexParms);
+    if (format.ColorEscaped) {
+        defaultColorVerts = 0;
+    }
     uint32_t charCode = UTF8Util::DecodeNextChar(&p);
 
     for (; charCode != '\0'; i++, charCode = UTF8Util::DecodeNextChar(&p)) {
@@ -977,17 +1118,21 @@ VertexBlockType DrawTextToVertexBlock(
         curPos += r * (g.AdvanceX * xScale);
 
         UpdateFormat(fontInfo, fontParms, &p, format, vertexParms);
+        if (format.ColorEscaped && defaultColorVerts == numVerts) {
+            defaultColorVerts = static_cast<int>(i + 1) * 4;
+        }
     }
 
     if (toNextLine) {
         *toNextLine -= lineInc;
     }
+    if (numDefaultColorVerts) {
+        *numDefaultColorVerts = defaultColorVerts;
+    }
 
 #if defined(OVR_BUILD_DEBUG)
-///	ALOG( "DrawTextToVertexBlock: drawn %d vertices lineInc = ", vb.NumVerts );
+///	ALOG( "LayoutText: drawn %d vertices lineInc = ", numVerts );
 #endif
-
-    return vb;
 }
 
 ovrFontWeight FontInfoType::GetFontWeight(const int index) const {
@@ -1011,31 +1156,32 @@ ovrSurfaceDef BitmapFontLocal::TextSurface(
         fp.AlignHoriz = hjust;
         fp.AlignVert = vjust;
     }
-    VertexBlockType vb = DrawTextToVertexBlock(
+    std::vector<fontVertex_t> verts;
+    LayoutText(
         *this,
         fp,
-        Vector3f(0.0f), // origin
         Vector3f(0.0f, 0.0f, 1.0f), // normal
         Vector3f(0.0f, 1.0f, 0.0f), // up
         scale,
         color,
-        text);
+        text,
+        verts);
+    const int numVerts = static_cast<int>(verts.size());
+    UploadGlyphs();
 
     Bounds3f blockBounds(Bounds3f::Init);
-    for (int i = 0; i < vb.NumVerts; i++) {
-        blockBounds.AddPoint(vb.Verts[i].xyz);
+    for (int i = 0; i < numVerts; i++) {
+        blockBounds.AddPoint(verts[i].xyz);
     }
 
     ovrSurfaceDef s;
-    s.geo = FontGeometry(vb.NumVerts / 4, blockBounds);
+    s.geo = FontGeometry(numVerts / 4, blockBounds);
 
     glBindVertexArray(s.geo.vertexArrayObject);
     glBindBuffer(GL_ARRAY_BUFFER, s.geo.vertexBuffer);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, vb.NumVerts * sizeof(fontVertex_t), (void*)vb.Verts);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, numVerts * sizeof(fontVertex_t), (void*)verts.data());
     glBindVertexArray(0);
 
-    vb.Free();
-
     // for now we set up both the gpu state, program, and uniformdata.
 
     // Special blend mode to also work over underlay layers
@@ -1053,6 +1199,58 @@ ovrSurfaceDef BitmapFontLocal::TextSurface(
     return s;
 }
 
+//==============================================================
+// ovrTextLayoutParms
+// Everything that affects the layout of a string besides the string itself. Compared and hashed
+// as raw bytes, so it is cleared before it is filled in. The color is not part of it, it is
+// applied when the vertex blocks are copied in Finish().
+struct ovrTextLayoutParms {
+    BitmapFont const* Font;
+    uint32_t FontGeneration; // the address alone does not change when a font is reloaded
+    int32_t AlignHoriz;
+    int32_t AlignVert;
+    uint8_t Billboard;
+    uint8_t TrackRoll;
+    uint8_t Pad[2];
+    float AlphaCenter;
+    float ColorCenter;
+    float Normal[3];
+    float Up[3];
+    float Scale;
+};
+
+struct ovrTextLayoutKey {
+    ovrTextLayoutParms Parms;
+    std::string Text;
+
+    bool operator==(ovrTextLayoutKey const& other) const {
+        return memcmp(&Parms, &other.Parms, sizeof(Parms)) == 0 && Text == other.Text;
+    }
+};
+
+struct ovrTextLayoutKeyHash {
+    size_t operator()(ovrTextLayoutKey const& key) const {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ULL;
+        uint8_t const* parms = reinterpret_cast<uint8_t const*>(&key.Parms);
+        for (size_t i = 0; i < sizeof(key.Parms); i++) {
+            hash = (hash ^ parms[i]) * 1099511628211ULL;
+        }
+        for (char const c : key.Text) {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+// The laid out glyphs of a string, in the local space of the vertex blocks that draw it.
+struct ovrTextLayout {
+    std::vector<fontVertex_t> Verts;
+    int NumDefaultColorVerts; // the verts after these were colored by an escape in the text
+    Vector3f ToNextLine;
+    std::list<ovrTextLayoutKey const*>::iterator LruPosition;
+};
+
 //==================================================================================================
 // BitmapFontSurfaceLocal
 //
@@ -1061,7 +1259,7 @@ class BitmapFontSurfaceLocal : public BitmapFontSurface {
     BitmapFontSurfaceLocal();
     virtual ~BitmapFontSurfaceLocal();
 
-    virtual void Init(const int maxVertices);
+    virtual void Init(const int maxVertices, const bool instanced = false);
     void Free();
 
     // add text to the VBO that will render in a 2D pass.
@@ -1114,21 +1312,52 @@ class BitmapFontSurfaceLocal : public BitmapFontSurface {
 
     virtual void SetCullEnabled(const bool enabled);
 
+    virtual void SetLayoutCacheSize(const int maxLayouts);
+    virtual void ClearLayoutCache();
+    virtual ovrTextLayoutCacheStats GetLayoutCacheStats() const;
+    virtual void ResetLayoutCacheStats();
+
    private:
+    static const int DEFAULT_MAX_TEXT_LAYOUTS = 512;
+    static const size_t MAX_FREE_LAYOUT_VERTS = 64;
+
+    ovrTextLayout const& FindTextLayout(
+        BitmapFont const& font,
+        fontParms_t const& parms,
+        Vector3f const& normal,
+        Vector3f const& up,
+        float const scale,
+        char const* text);
+    void EvictTextLayouts(size_t const maxLayouts);
+
     // This limitation may not exist anymore now that ModelMatrix is no longer a member.
     BitmapFontSurfaceLocal& operator=(BitmapFontSurfaceLocal const& rhs);
 
     mutable ovrSurfaceDef FontSurfaceDef;
 
-    fontVertex_t* Vertices; // vertices that are written to the VBO. Fixed size to not overflow VBO
+    void Reserve(int const numVertices);
+
+    std::vector<fontVertex_t> Vertices; // vertices that are written to the VBO
+    std::vector<ovrGlyphInstance> GlyphInstances; // written instead of Vertices when instanced
     int MaxVertices;
     int MaxIndices;
     int CurVertex; // reset every Render()
     int CurIndex; // reset every Render()
     bool Initialized;
+    bool Instanced;
 
     std::vector<VertexBlockType>
         VertexBlocks; // each pointer in the array points to an allocated block ov
+    std::vector<ovrRadixSortItem> BlockSortItems; // vertex blocks by distance to the view
+    std::vector<ovrRadixSortItem> BlockSortScratch;
+
+    // Layouts are only evicted in Finish(), so the vertex blocks can point at their vertices.
+    std::unordered_map<ovrTextLayoutKey, ovrTextLayout, ovrTextLayoutKeyHash> Layouts;
+    std::list<ovrTextLayoutKey const*> LayoutLru; // most recently used first
+    std::vector<std::vector<fontVertex_t>> FreeLayoutVerts; // storage of evicted layouts
+    ovrTextLayoutKey LookupKey; // reused so lookups do not allocate
+    int MaxLayouts;
+    ovrTextLayoutCacheStats LayoutStats;
 };
 
 //==================================================================================================
@@ -1178,7 +1407,6 @@ bool FontInfoType::LoadFromBuffer(void const* buffer, size_t const bufferSize) {
     // character codes to glyphs and if that's the case we may just want to use a hash, or use a
     // combination of tables for the first 65K and hashes for the other, less-frequently-used
     // characters.
-    static const int MAX_GLYPHS = 0xffff;
 
     // load the glyphs
     const OVR::JsonReader jsonGlyphs(jsonRoot);
@@ -1319,20 +1547,7 @@ bool FontInfoType::LoadFromBuffer(void const* buffer, size_t const bufferSize) {
     ALOG("jsonGlyphArray DONE maxCharCode =%d", maxCharCode);
 #endif
 
-    float const DEFAULT_TEXT_SCALE = 0.0025f;
-
-    double const NATURAL_WIDTH_SCALE = NaturalWidth / 4096.0;
-    double const NATURAL_HEIGHT_SCALE = NaturalHeight / 3820.0;
-    double const DEFAULT_O_WIDTH = 325.0;
-    double const DEFAULT_O_HEIGHT = 322.0;
-    double const OLD_WIDTH_FACTOR = 1.04240608;
-    float const widthScaleFactor =
-        static_cast<float>(DEFAULT_O_WIDTH / oWidth * OLD_WIDTH_FACTOR * NATURAL_WIDTH_SCALE);
-    float const heightScaleFactor =
-        static_cast<float>(DEFAULT_O_HEIGHT / oHeight * OLD_WIDTH_FACTOR * NATURAL_HEIGHT_SCALE);
-
-    ScaleFactorX = DEFAULT_SCALE_FACTOR * DEFAULT_TEXT_SCALE * widthScaleFactor * TweakScale;
-    ScaleFactorY = DEFAULT_SCALE_FACTOR * DEFAULT_TEXT_SCALE * heightScaleFactor * TweakScale;
+    CalcScaleFactors(oWidth, oHeight);
 
     // This is not intended for wide or ucf character sets -- depending on the size range of
     // character codes lookups may need to be changed to use a hash.
@@ -1356,6 +1571,42 @@ bool FontInfoType::LoadFromBuffer(void const* buffer, size_t const bufferSize) {
     return true;
 }
 
+//==============================
+// FontInfoType::AddGlyph
+void FontInfoType::AddGlyph(FontGlyphType const& glyph) {
+    if (glyph.CharCode < 0 || glyph.CharCode >= MAX_GLYPHS) {
+        OVR_ASSERT(glyph.CharCode >= 0 && glyph.CharCode < MAX_GLYPHS);
+        return;
+    }
+    if (static_cast<size_t>(glyph.CharCode) >= CharCodeMap.size()) {
+        CharCodeMap.resize(glyph.CharCode + 1, -1);
+    }
+    CharCodeMap[glyph.CharCode] = static_cast<int32_t>(Glyphs.size());
+    Glyphs.push_back(glyph);
+
+    MaxAscent = std::max(MaxAscent, glyph.BearingY);
+    MaxDescent = std::max(MaxDescent, glyph.Height - glyph.BearingY);
+}
+
+//==============================
+// FontInfoType::CalcScaleFactors
+void FontInfoType::CalcScaleFactors(double const oWidth, double const oHeight) {
+    float const DEFAULT_TEXT_SCALE = 0.0025f;
+
+    double const NATURAL_WIDTH_SCALE = NaturalWidth / 4096.0;
+    double const NATURAL_HEIGHT_SCALE = NaturalHeight / 3820.0;
+    double const DEFAULT_O_WIDTH = 325.0;
+    double const DEFAULT_O_HEIGHT = 322.0;
+    double const OLD_WIDTH_FACTOR = 1.04240608;
+    float const widthScaleFactor =
+        static_cast<float>(DEFAULT_O_WIDTH / oWidth * OLD_WIDTH_FACTOR * NATURAL_WIDTH_SCALE);
+    float const heightScaleFactor =
+        static_cast<float>(DEFAULT_O_HEIGHT / oHeight * OLD_WIDTH_FACTOR * NATURAL_HEIGHT_SCALE);
+
+    ScaleFactorX = DEFAULT_SCALE_FACTOR * DEFAULT_TEXT_SCALE * widthScaleFactor * TweakScale;
+    ScaleFactorY = DEFAULT_SCALE_FACTOR * DEFAULT_TEXT_SCALE * heightScaleFactor * TweakScale;
+}
+
 class ovrGlyphSort {
    public:
     void SortGlyphIndicesByCharacterCode(
@@ -1523,6 +1774,13 @@ static bool ExtensionMatches(char const* fileName, char const* ext) {
     return OVR::OVR_stricmp(fileName + fileNameLen - extLen, ext) == 0;
 }
 
+//==============================
+// BitmapFontLocal::NextLoadGeneration
+void BitmapFontLocal::NextLoadGeneration() {
+    static std::atomic<uint32_t> generations(0);
+    LoadGeneration = ++generations;
+}
+
 //==============================
 // BitmapFontLocal::Load
 bool BitmapFontLocal::Load(ovrFileSys& fileSys, char const* uri) {
@@ -1531,6 +1789,8 @@ bool BitmapFontLocal::Load(ovrFileSys& fileSys, char const* uri) {
     int port;
     char path[1024];
 
+    NextLoadGeneration();
+
     ALOG("Load Uri = %s", uri);
 
     if (!ovrUri::ParseUri(
@@ -1581,6 +1841,94 @@ bool BitmapFontLocal::Load(ovrFileSys& fileSys, char const* uri) {
         return false;
     }
 
+    CreatePrograms();
+
+#if defined(OVR_BUILD_DEBUG)
+    ALOG("BitmapFont for uri = %s load SUCCESS", uri);
+#endif
+
+    return true;
+}
+
+//==============================
+// BitmapFontLocal::LoadFromRasterizer
+bool BitmapFontLocal::LoadFromRasterizer(
+    const ovrGlyphRasterizer& rasterizer,
+    ovrJobPool* jobPool,
+    const int pixelHeight,
+    const int atlasSize) {
+    double const startTime = GetTimeInSeconds();
+
+    NextLoadGeneration();
+    Rasterizer = &rasterizer;
+    JobPool = jobPool;
+    GlyphPixelHeight = pixelHeight;
+    // wide enough for outlines and drop shadows, which offset the distance from the edge
+    GlyphSpread = std::max(2, pixelHeight / 8);
+
+    float const atlasScale = 1.0f / atlasSize;
+    FontInfo = FontInfoType();
+    FontInfo.FontName = "runtime";
+    FontInfo.NaturalWidth = static_cast<float>(atlasSize);
+    FontInfo.NaturalHeight = static_cast<float>(atlasSize);
+    FontInfo.HorizontalPad = GlyphSpread * atlasScale;
+    FontInfo.VerticalPad = GlyphSpread * atlasScale;
+    FontInfo.FontHeight = rasterizer.GetLineHeight(pixelHeight) * atlasScale;
+
+    GlyphAtlas.Init(atlasSize, atlasSize);
+    FailedGlyphs.assign(FontInfoType::MAX_GLYPHS, false);
+
+    DeleteTexture(FontTexture);
+    FontTexture = LoadRTextureFromMemory(GlyphAtlas.GetPixels(), atlasSize, atlasSize);
+    if (FontTexture.IsValid() == false) {
+        ALOGW("BitmapFontLocal::LoadFromRasterizer: failed to create %d^2 atlas", atlasSize);
+        Rasterizer = nullptr;
+        return false;
+    }
+    ImageWidth = atlasSize;
+    ImageHeight = atlasSize;
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, FontTexture.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    std::vector<uint32_t> ascii;
+    for (uint32_t charCode = ' '; charCode <= '~'; charCode++) {
+        ascii.push_back(charCode);
+    }
+    GenerateGlyphs(ascii);
+
+    // size the text the same as a baked font with the same 'O'
+    double oWidth = pixelHeight;
+    double oHeight = pixelHeight;
+    if (FontInfo.HasGlyph('O')) {
+        FontGlyphType const& o = FontInfo.GlyphForCharCode('O');
+        oWidth = o.Width * atlasSize;
+        oHeight = o.Height * atlasSize;
+    }
+    FontInfo.CalcScaleFactors(oWidth, oHeight);
+
+    UploadGlyphs();
+    CreatePrograms();
+
+    ALOG(
+        "BitmapFontLocal::LoadFromRasterizer: %d glyphs at %d pixels in %.1f ms, "
+        "%d KB atlas %.0f%% used",
+        static_cast<int>(FontInfo.Glyphs.size()),
+        pixelHeight,
+        (GetTimeInSeconds() - startTime) * 1000.0,
+        atlasSize * atlasSize / 1024,
+        GlyphAtlas.GetUsage() * 100.0f);
+    return true;
+}
+
+//==============================
+// BitmapFontLocal::CreatePrograms
+void BitmapFontLocal::CreatePrograms() {
     // create the shaders for font rendering if not already created
     if (FontProgram.VertexShader == 0 || FontProgram.FragmentShader == 0) {
         static ovrProgramParm fontUniformParms[] = {
@@ -1591,13 +1939,134 @@ bool BitmapFontLocal::Load(ovrFileSys& fileSys, char const* uri) {
             SDFFontFragmentShaderSrc,
             fontUniformParms,
             sizeof(fontUniformParms) / sizeof(ovrProgramParm));
+        FontInstancedProgram = GlProgram::Build(
+            FontInstancedVertexShaderSrc,
+            SDFFontFragmentShaderSrc,
+            fontUniformParms,
+            sizeof(fontUniformParms) / sizeof(ovrProgramParm));
     }
+}
 
-#if defined(OVR_BUILD_DEBUG)
-    ALOG("BitmapFont for uri = %s load SUCCESS", uri);
-#endif
+//==============================
+// BitmapFontLocal::EnsureGlyphs
+void BitmapFontLocal::EnsureGlyphs(char const* text) const {
+    if (Rasterizer == nullptr || text == nullptr) {
+        return;
+    }
 
-    return true;
+    MissingGlyphs.clear();
+    char const* p = text;
+    for (uint32_t charCode = UTF8Util::DecodeNextChar(&p); charCode != '\0';
+         charCode = UTF8Util::DecodeNextChar(&p)) {
+        if (charCode < ' ' || charCode >= static_cast<uint32_t>(FontInfoType::MAX_GLYPHS)) {
+            continue;
+        }
+        if (FontInfo.HasGlyph(charCode) || FailedGlyphs[charCode]) {
+            continue;
+        }
+        if (std::find(MissingGlyphs.begin(), MissingGlyphs.end(), charCode) ==
+            MissingGlyphs.end()) {
+            MissingGlyphs.push_back(charCode);
+        }
+    }
+
+    if (!MissingGlyphs.empty()) {
+        GenerateGlyphs(MissingGlyphs);
+    }
+}
+
+//==============================
+// BitmapFontLocal::GenerateGlyphs
+void BitmapFontLocal::GenerateGlyphs(std::vector<uint32_t> const& charCodes) const {
+    struct ovrGeneratedGlyph {
+        ovrGeneratedGlyph() : Valid(false) {}
+
+        ovrGlyphBitmap Bitmap;
+        std::vector<uint8_t> Sdf;
+        bool Valid;
+    };
+
+    // rasterizing and the distance transform are independent per glyph and do not touch GL
+    std::vector<ovrGeneratedGlyph> generated(charCodes.size());
+    ovrJobPool::ParallelFor(
+        JobPool, static_cast<int>(charCodes.size()), [this, &charCodes, &generated](const int i) {
+            ovrGeneratedGlyph& g = generated[i];
+            g.Valid = Rasterizer->RasterizeGlyph(charCodes[i], GlyphPixelHeight, g.Bitmap);
+            if (g.Valid && g.Bitmap.Width > 0 && g.Bitmap.Height > 0) {
+                GenerateSdf(
+                    g.Bitmap.Coverage.data(),
+                    g.Bitmap.Width,
+                    g.Bitmap.Height,
+                    GlyphSpread,
+                    g.Sdf);
+            }
+        });
+
+    // packing is serial, in the order the characters were requested, and the GL thread may be
+    // uploading earlier glyphs meanwhile
+    float const atlasScale = 1.0f / GlyphAtlas.GetWidth();
+    std::lock_guard<std::mutex> lock(GlyphAtlasMutex);
+    for (size_t i = 0; i < charCodes.size(); i++) {
+        ovrGeneratedGlyph const& gen = generated[i];
+        if (!gen.Valid) {
+            FailedGlyphs[charCodes[i]] = true;
+            continue;
+        }
+
+        FontGlyphType g;
+        g.CharCode = static_cast<int32_t>(charCodes[i]);
+        g.AdvanceX = gen.Bitmap.AdvanceX * atlasScale;
+        if (!gen.Sdf.empty()) {
+            int const w = gen.Bitmap.Width + 2 * GlyphSpread;
+            int const h = gen.Bitmap.Height + 2 * GlyphSpread;
+            int x = 0;
+            int y = 0;
+            if (!GlyphAtlas.AddImage(gen.Sdf.data(), w, h, x, y)) {
+                ALOGW("BitmapFontLocal: glyph atlas is full, dropping glyph %u", charCodes[i]);
+                FailedGlyphs[charCodes[i]] = true;
+                continue;
+            }
+
+            g.X = x * atlasScale;
+            g.Y = y * atlasScale;
+            g.Width = w * atlasScale;
+            g.Height = h * atlasScale;
+            g.BearingX = (gen.Bitmap.BearingX - GlyphSpread) * atlasScale;
+            g.BearingY = (gen.Bitmap.BearingY + GlyphSpread) * atlasScale;
+        }
+        FontInfo.AddGlyph(g);
+    }
+}
+
+//==============================
+// BitmapFontLocal::UploadGlyphs
+void BitmapFontLocal::UploadGlyphs() const {
+    if (Rasterizer == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(GlyphAtlasMutex);
+    int y;
+    int height;
+    if (!GlyphAtlas.GetDirtyRows(y, height)) {
+        return;
+    }
+    // whole rows are contiguous in the copy of the atlas
+    int const width = GlyphAtlas.GetWidth();
+    glBindTexture(GL_TEXTURE_2D, FontTexture.texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(
+        GL_TEXTURE_2D,
+        0,
+        0,
+        y,
+        width,
+        height,
+        GL_RED,
+        GL_UNSIGNED_BYTE,
+        GlyphAtlas.GetPixels() + y * width);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    GlyphAtlas.ClearDirty();
 }
 
 //==============================
@@ -1653,6 +2122,11 @@ void BitmapFontLocal::GetGlyphMetrics(
     float& height,
     float& advanceX,
     float& advanceY) const {
+    char text[8] = {};
+    intptr_t offset = 0;
+    UTF8Util::EncodeChar(text, &offset, charCode);
+    EnsureGlyphs(text);
+
     FontGlyphType const& glyph = GlyphForCharCode(charCode);
     width = glyph.Width;
     height = glyph.Height;
@@ -1681,6 +2155,7 @@ bool BitmapFontLocal::WordWrapText(
         // ALOG( "Tried to word-wrap NULL text!" );
         return false;
     }
+    EnsureGlyphs(source);
 
 #if defined(OVR_BUILD_DEBUG)
 ///	ALOG( "Word-wrapping '%s' ... ", source );
@@ -1917,6 +2392,7 @@ float BitmapFontLocal::GetFirstFitChars(
     if (inOutText.empty()) {
         return 0;
     }
+    EnsureGlyphs(inOutText.c_str());
 
     float const xScale = FontInfo.ScaleFactorX * fontScale;
     float lineWidth = 0.0f;
@@ -1951,6 +2427,7 @@ float BitmapFontLocal::GetLastFitChars(
     if (inOutText.empty()) {
         return 0;
     }
+    EnsureGlyphs(inOutText.c_str());
 
     float const xScale = FontInfo.ScaleFactorX * fontScale;
     float lineWidth = 0.0f;
@@ -1972,6 +2449,8 @@ float BitmapFontLocal::GetLastFitChars(
 //==============================
 // BitmapFontLocal::CalcTextWidth
 float BitmapFontLocal::CalcTextWidth(char const* text) const {
+    EnsureGlyphs(text);
+
     float width = 0.0f;
     char const* p = text;
     uint32_t color;
@@ -2021,6 +2500,7 @@ void BitmapFontLocal::CalcTextMetrics(
     if (text == NULL || text[0] == '\0') {
         return;
     }
+    EnsureGlyphs(text);
 
     float maxLineAscent = 0.0f;
     float maxLineDescent = 0.0f;
@@ -2112,6 +2592,7 @@ void BitmapFontLocal::TruncateText(std::string& inOutText, int const maxLines) c
     if (p == nullptr || p[0] == '\0') {
         return;
     }
+    EnsureGlyphs(p);
 
     uint32_t color;
     uint32_t weight;
@@ -2148,45 +2629,48 @@ void BitmapFontLocal::TruncateText(std::string& inOutText, int const maxLines) c
 //==============================
 // BitmapFontSurfaceLocal::BitmapFontSurface
 BitmapFontSurfaceLocal::BitmapFontSurfaceLocal()
-    : Vertices(NULL),
-      MaxVertices(0),
+    : MaxVertices(0),
       MaxIndices(0),
       CurVertex(0),
       CurIndex(0),
-      Initialized(false) {}
+      Initialized(false),
+      Instanced(false),
+      MaxLayouts(DEFAULT_MAX_TEXT_LAYOUTS) {}
 
 //==============================
 // BitmapFontSurfaceLocal::~BitmapFontSurfaceLocal
 BitmapFontSurfaceLocal::~BitmapFontSurfaceLocal() {
     FontSurfaceDef.geo.Free();
-    delete[] Vertices;
-    Vertices = NULL;
 }
 
 //==============================
 // BitmapFontSurfaceLocal::Init
 // Initializes the surface VBO
-void BitmapFontSurfaceLocal::Init(const int maxVertices) {
+void BitmapFontSurfaceLocal::Init(const int maxVertices, const bool instanced) {
     OVR_ASSERT(
         FontSurfaceDef.geo.vertexBuffer == 0 && FontSurfaceDef.geo.indexBuffer == 0 &&
         FontSurfaceDef.geo.vertexArrayObject == 0);
-    OVR_ASSERT(Vertices == NULL);
-    if (Vertices != NULL) {
-        delete[] Vertices;
-        Vertices = NULL;
-    }
     OVR_ASSERT(maxVertices % 4 == 0);
 
     MaxVertices = maxVertices;
     MaxIndices = (maxVertices / 4) * 6;
 
-    Vertices = new fontVertex_t[maxVertices];
+    Instanced = instanced;
+    if (Instanced) {
+        GlyphInstances.resize(maxVertices / 4);
+    } else {
+        Vertices.resize(maxVertices);
+    }
 
     CurVertex = 0;
     CurIndex = 0;
 
     Bounds3f localBounds(Bounds3f::Init);
-    FontSurfaceDef.geo = FontGeometry(MaxVertices / 4, localBounds);
+    if (Instanced) {
+        FontSurfaceDef.geo = FontInstancedGeometry(MaxVertices / 4);
+    } else {
+        FontSurfaceDef.geo = FontGeometry(MaxVertices / 4, localBounds);
+    }
     FontSurfaceDef.geo.indexCount = 0; // if there's anything to render this will be modified
 
     FontSurfaceDef.surfaceName = "font";
@@ -2215,6 +2699,30 @@ void BitmapFontSurfaceLocal::Init(const int maxVertices) {
     ALOG("BitmapFontSurfaceLocal::Init: success");
 }
 
+//==============================
+// BitmapFontSurfaceLocal::Reserve
+// Grows the vertices and the VBO to hold at least numVertices vertices. The maximum passed to
+// Init() is only the initial size.
+void BitmapFontSurfaceLocal::Reserve(int const numVertices) {
+    if (numVertices <= MaxVertices) {
+        return;
+    }
+    // whole quads, doubling so a growing amount of text settles after a few frames
+    MaxVertices = std::max(((numVertices + 3) / 4) * 4, MaxVertices * 2);
+    MaxIndices = (MaxVertices / 4) * 6;
+    ALOG("BitmapFontSurfaceLocal::Reserve: growing to %d vertices", MaxVertices);
+
+    if (Instanced) {
+        // UpdateBillboardInstances() grows the instance buffer
+        GlyphInstances.resize(MaxVertices / 4);
+    } else {
+        Vertices.resize(MaxVertices);
+        FontSurfaceDef.geo.Free();
+        Bounds3f localBounds(Bounds3f::Init);
+        FontSurfaceDef.geo = FontGeometry(MaxVertices / 4, localBounds);
+    }
+}
+
 //==============================
 // BitmapFontSurfaceLocal::DrawText3D
 Vector3f BitmapFontSurfaceLocal::DrawText3D(
@@ -2233,14 +2741,125 @@ Vector3f BitmapFontSurfaceLocal::DrawText3D(
     if (text == NULL || text[0] == '\0') {
         return Vector3f::ZERO; // nothing to do here, move along
     }
-    Vector3f toNextLine;
-    VertexBlockType vb =
-        DrawTextToVertexBlock(font, parms, pos, normal, up, scale, color, text, &toNextLine);
+    ovrTextLayout const& layout = FindTextLayout(font, parms, normal, up, scale, text);
 
     // add the new vertex block to the array of vertex blocks
-    VertexBlocks.push_back(vb);
+    if (!layout.Verts.empty()) {
+        VertexBlocks.push_back(VertexBlockType(
+            font,
+            layout.Verts.data(),
+            static_cast<int>(layout.Verts.size()),
+            ColorToABGR(color),
+            layout.NumDefaultColorVerts,
+            pos,
+            Quatf(),
+            parms.Billboard,
+            parms.TrackRoll));
+    }
+
+    return layout.ToNextLine;
+}
+
+//==============================
+// BitmapFontSurfaceLocal::FindTextLayout
+ovrTextLayout const& BitmapFontSurfaceLocal::FindTextLayout(
+    BitmapFont const& font,
+    fontParms_t const& parms,
+    Vector3f const& normal,
+    Vector3f const& up,
+    float const scale,
+    char const* text) {
+    ovrTextLayoutParms& p = LookupKey.Parms;
+    memset(&p, 0, sizeof(p));
+    p.Font = &font;
+    p.FontGeneration = AsLocal(font).GetLoadGeneration();
+    p.AlignHoriz = parms.AlignHoriz;
+    p.AlignVert = parms.AlignVert;
+    p.Billboard = parms.Billboard ? 1 : 0;
+    p.TrackRoll = parms.TrackRoll ? 1 : 0;
+    p.AlphaCenter = parms.AlphaCenter;
+    p.ColorCenter = parms.ColorCenter;
+    p.Normal[0] = normal.x;
+    p.Normal[1] = normal.y;
+    p.Normal[2] = normal.z;
+    p.Up[0] = up.x;
+    p.Up[1] = up.y;
+    p.Up[2] = up.z;
+    p.Scale = scale;
+    LookupKey.Text.assign(text);
+
+    auto it = Layouts.find(LookupKey);
+    if (it != Layouts.end()) {
+        LayoutStats.Hits++;
+        LayoutLru.splice(LayoutLru.begin(), LayoutLru, it->second.LruPosition);
+        return it->second;
+    }
+
+    LayoutStats.Misses++;
+    it = Layouts.emplace(LookupKey, ovrTextLayout()).first;
+    ovrTextLayout& layout = it->second;
+    if (!FreeLayoutVerts.empty()) {
+        layout.Verts.swap(FreeLayoutVerts.back());
+        FreeLayoutVerts.pop_back();
+    }
+    LayoutText(
+        font,
+        parms,
+        normal,
+        up,
+        scale,
+        Vector4f(1.0f),
+        text,
+        layout.Verts,
+        &layout.ToNextLine,
+        &layout.NumDefaultColorVerts);
+    LayoutLru.push_front(&it->first);
+    layout.LruPosition = LayoutLru.begin();
+    return layout;
+}
+
+//==============================
+// BitmapFontSurfaceLocal::EvictTextLayouts
+void BitmapFontSurfaceLocal::EvictTextLayouts(size_t const maxLayouts) {
+    while (Layouts.size() > maxLayouts) {
+        auto it = Layouts.find(*LayoutLru.back());
+        OVR_ASSERT(it != Layouts.end());
+        // keep the storage around for the next layouts
+        if (FreeLayoutVerts.size() < MAX_FREE_LAYOUT_VERTS) {
+            FreeLayoutVerts.push_back(std::move(it->second.Verts));
+        }
+        LayoutLru.pop_back();
+        Layouts.erase(it);
+        LayoutStats.Evictions++;
+    }
+}
 
-    return toNextLine;
+//==============================
+// BitmapFontSurfaceLocal::SetLayoutCacheSize
+void BitmapFontSurfaceLocal::SetLayoutCacheSize(const int maxLayouts) {
+    MaxLayouts = std::max(maxLayouts, 0);
+}
+
+//==============================
+// BitmapFontSurfaceLocal::ClearLayoutCache
+void BitmapFontSurfaceLocal::ClearLayoutCache() {
+    // the vertex blocks of this frame point at the layouts
+    VertexBlocks.clear();
+    EvictTextLayouts(0);
+}
+
+//==============================
+// BitmapFontSurfaceLocal::GetLayoutCacheStats
+ovrTextLayoutCacheStats BitmapFontSurfaceLocal::GetLayoutCacheStats() const {
+    ovrTextLayoutCacheStats stats = LayoutStats;
+    stats.Entries = static_cast<int>(Layouts.size());
+    return stats;
+}
+
+//==============================
+// BitmapFontSurfaceLocal::ResetLayoutCacheStats
+void BitmapFontSurfaceLocal::ResetLayoutCacheStats() {
+    LayoutStats = ovrTextLayoutCacheStats();
 }
 
 //==============================
@@ -2303,20 +2922,111 @@ Vector3f BitmapFontSurfaceLocal::DrawTextBillboarded3Df(
     return DrawTextBillboarded3D(font, parms, pos, scale, color, buffer);
 }
 
-//==============================================================
-// vbSort_t
-// small structure that is used to sort vertex blocks by their distance to the camera
-//==============================================================
-struct vbSort_t {
-    int VertexBlockIndex;
-    float DistanceSquared;
-};
+#if defined(OVR_FONT_SSE2)
+typedef __m128 fontVec4_t;
+static inline fontVec4_t LoadVec4(float const* p) {
+    return _mm_loadu_ps(p);
+}
+static inline fontVec4_t AddVec4(fontVec4_t const a, fontVec4_t const b) {
+    return _mm_add_ps(a, b);
+}
+static inline fontVec4_t MinVec4(fontVec4_t const a, fontVec4_t const b) {
+    return _mm_min_ps(a, b);
+}
+static inline fontVec4_t MaxVec4(fontVec4_t const a, fontVec4_t const b) {
+    return _mm_max_ps(a, b);
+}
+static inline void StoreVec4(float* p, fontVec4_t const v) {
+    _mm_storeu_ps(p, v);
+}
+#elif defined(OVR_FONT_NEON)
+typedef float32x4_t fontVec4_t;
+static inline fontVec4_t LoadVec4(float const* p) {
+    return vld1q_f32(p);
+}
+static inline fontVec4_t AddVec4(fontVec4_t const a, fontVec4_t const b) {
+    return vaddq_f32(a, b);
+}
+static inline fontVec4_t MinVec4(fontVec4_t const a, fontVec4_t const b) {
+    return vminq_f32(a, b);
+}
+static inline fontVec4_t MaxVec4(fontVec4_t const a, fontVec4_t const b) {
+    return vmaxq_f32(a, b);
+}
+static inline void StoreVec4(float* p, fontVec4_t const v) {
+    vst1q_f32(p, v);
+}
+#endif
 
 //==============================
-// VertexBlockSortFn
-// sort function for vertex blocks
-int VertexBlockSortFn(void const* a, void const* b) {
-    return ftoi(((vbSort_t const*)a)->DistanceSquared - ((vbSort_t const*)b)->DistanceSquared);
+// CalcVertexBounds
+// The loads read the float after each position as a fourth component, which is ignored.
+static void CalcVertexBounds(fontVertex_t const* verts, int const count, Bounds3f& bounds) {
+    if (count <= 0) {
+        return;
+    }
+#if defined(OVR_FONT_SSE2) || defined(OVR_FONT_NEON)
+    fontVec4_t mins = LoadVec4(&verts[0].xyz.x);
+    fontVec4_t maxs = mins;
+    for (int i = 1; i < count; i++) {
+        fontVec4_t const p = LoadVec4(&verts[i].xyz.x);
+        mins = MinVec4(mins, p);
+        maxs = MaxVec4(maxs, p);
+    }
+    float lo[4];
+    float hi[4];
+    StoreVec4(lo, mins);
+    StoreVec4(hi, maxs);
+    bounds.AddPoint(Vector3f(lo[0], lo[1], lo[2]));
+    bounds.AddPoint(Vector3f(hi[0], hi[1], hi[2]));
+#else
+    for (int i = 0; i < count; i++) {
+        bounds.AddPoint(verts[i].xyz);
+    }
+#endif
+}
+
+//==============================
+// CalcGlyphInstanceBounds
+// Bounds of the corners of the glyph quads.
+static void CalcGlyphInstanceBounds(
+    ovrGlyphInstance const* glyphs,
+    int const count,
+    Bounds3f& bounds) {
+    if (count <= 0) {
+        return;
+    }
+#if defined(OVR_FONT_SSE2) || defined(OVR_FONT_NEON)
+    fontVec4_t mins = LoadVec4(glyphs[0].Origin);
+    fontVec4_t maxs = mins;
+    for (int i = 0; i < count; i++) {
+        fontVec4_t const lowerLeft = LoadVec4(glyphs[i].Origin);
+        fontVec4_t const lowerRight = AddVec4(lowerLeft, LoadVec4(glyphs[i].Right));
+        fontVec4_t const up = LoadVec4(glyphs[i].Up);
+        fontVec4_t const upperLeft = AddVec4(lowerLeft, up);
+        fontVec4_t const upperRight = AddVec4(lowerRight, up);
+        mins = MinVec4(MinVec4(mins, lowerLeft), MinVec4(lowerRight, upperLeft));
+        maxs = MaxVec4(MaxVec4(maxs, lowerLeft), MaxVec4(lowerRight, upperLeft));
+        mins = MinVec4(mins, upperRight);
+        maxs = MaxVec4(maxs, upperRight);
+    }
+    float lo[4];
+    float hi[4];
+    StoreVec4(lo, mins);
+    StoreVec4(hi, maxs);
+    bounds.AddPoint(Vector3f(lo[0], lo[1], lo[2]));
+    bounds.AddPoint(Vector3f(hi[0], hi[1], hi[2]));
+#else
+    for (int i = 0; i < count; i++) {
+        Vector3f const origin(glyphs[i].Origin[0], glyphs[i].Origin[1], glyphs[i].Origin[2]);
+        Vector3f const right(glyphs[i].Right[0], glyphs[i].Right[1], glyphs[i].Right[2]);
+        Vector3f const up(glyphs[i].Up[0], glyphs[i].Up[1], glyphs[i].Up[2]);
+        bounds.AddPoint(origin);
+        bounds.AddPoint(origin + right);
+        bounds.AddPoint(origin + up);
+        bounds.AddPoint(origin + right + up);
+    }
+#endif
 }
 
 //==============================
@@ -2334,17 +3044,29 @@ void BitmapFontSurfaceLocal::Finish(Matrix4f const& viewMatrix) {
     Vector3f viewPos = invViewMatrix.GetTranslation();
     Vector3f viewUp = GetViewMatrixUp(viewMatrix);
 
-    // sort vertex blocks indices based on distance to pivot
-    int const MAX_VERTEX_BLOCKS = 256;
-    vbSort_t vbSort[MAX_VERTEX_BLOCKS];
+    // sort vertex blocks indices based on distance to pivot, the bits of a non-negative float
+    // sort in the same order as its value
     int const n = VertexBlocks.size();
+    int numVertices = 0;
+    BlockSortItems.resize(n);
+    BitmapFont const* uploadedFont = nullptr;
     for (int i = 0; i < n; ++i) {
-        vbSort[i].VertexBlockIndex = i;
         VertexBlockType& vb = VertexBlocks[i];
-        vbSort[i].DistanceSquared = (vb.Pivot - viewPos).LengthSq();
+        // the glyphs of the text were generated where it was drawn, which may not be this thread
+        if (vb.Font != uploadedFont) {
+            uploadedFont = vb.Font;
+            AsLocal(*vb.Font).UploadGlyphs();
+        }
+        float const distanceSquared = (vb.Pivot - viewPos).LengthSq();
+        uint32_t key;
+        memcpy(&key, &distanceSquared, sizeof(key));
+        BlockSortItems[i].key = key;
+        BlockSortItems[i].value = static_cast<uint32_t>(i);
+        numVertices += vb.NumVerts;
     }
+    RadixSort(BlockSortItems, BlockSortScratch);
 
-    qsort(vbSort, n, sizeof(vbSort[0]), VertexBlockSortFn);
+    Reserve(numVertices);
 
     // transform the vertex blocks into the vertices array
     CurIndex = 0;
@@ -2355,7 +3077,7 @@ void BitmapFontSurfaceLocal::Finish(Matrix4f const& viewMatrix) {
     // then get the font for each vertex block, and set the texture index on each vertex in
     // the third texture coordinate.
     for (int i = 0; i < static_cast<int>(VertexBlocks.size()); ++i) {
-        VertexBlockType& vb = VertexBlocks[vbSort[i].VertexBlockIndex];
+        VertexBlockType& vb = VertexBlocks[BlockSortItems[i].value];
         Matrix4f transform;
         if (vb.Billboard) {
             if (vb.TrackRoll) {
@@ -2376,34 +3098,40 @@ void BitmapFontSurfaceLocal::Finish(Matrix4f const& viewMatrix) {
             transform.SetTranslation(vb.Pivot);
         }
 
+        if (Instanced) {
+            for (int j = 0; j + 3 < vb.NumVerts; j += 4) {
+                // lower left, upper left, upper right and lower right
+                fontVertex_t const* v = &vb.Verts[j];
+                Vector3f const origin = transform.Transform(v[0].xyz);
+                Vector3f const right = transform.Transform(v[3].xyz) - origin;
+                Vector3f const up = transform.Transform(v[1].xyz) - origin;
+                PackGlyphInstance(
+                    GlyphInstances[CurVertex / 4],
+                    origin,
+                    right,
+                    up,
+                    Vector2f(v[1].s, v[1].t),
+                    Vector2f(v[3].s, v[3].t),
+                    j < vb.NumColorVerts ? vb.Color : *(std::uint32_t*)(&v[0].rgba[0]),
+                    *(std::uint32_t*)(&v[0].fontParms[0]));
+                CurVertex += 4;
+            }
+            vb.Free();
+            continue;
+        }
+
         for (int j = 0; j < vb.NumVerts; j++) {
             fontVertex_t const& v = vb.Verts[j];
             Vector3f const position = transform.Transform(v.xyz);
 
-            // If you hit this assert you're likely trying to draw
-            // too much text for the current buffer size,
-            // most likely need to update the value
-            // passed to fontSurface->Init() in OvrGuiSysLocal::Init
-            //
-            // Note: Vertices is *not* a dynamic std::vector
-            // because it gets copies into GPU memory, which is reserved
-            // separately. If you decide to make this system dynamic
-            // remember to scale re-allocate the OpenGL VBOs as well
-            if (CurVertex >= MaxVertices) {
-                OVR_FAIL(
-                    "Application tried to draw more text than there is buffer for. "
-                    "This failure protects agains a buffer overflow");
-            }
-
             Vertices[CurVertex].xyz = position;
             Vertices[CurVertex].s = v.s;
             Vertices[CurVertex].t = v.t;
-            *(std::uint32_t*)(&Vertices[CurVertex].rgba[0]) = *(std::uint32_t*)(&v.rgba[0]);
+            *(std::uint32_t*)(&Vertices[CurVertex].rgba[0]) =
+                j < vb.NumColorVerts ? vb.Color : *(std::uint32_t*)(&v.rgba[0]);
             *(std::uint32_t*)(&Vertices[CurVertex].fontParms[0]) =
                 *(std::uint32_t*)(&v.fontParms[0]);
             CurVertex++;
-
-            FontSurfaceDef.geo.localBounds.AddPoint(position);
         }
         CurIndex += (vb.NumVerts / 2) * 3;
         // free this vertex block
@@ -2412,10 +3140,23 @@ void BitmapFontSurfaceLocal::Finish(Matrix4f const& viewMatrix) {
     // remove all elements from the vertex block (but don't free the memory since it's likely to be
     // needed on the next frame.
     VertexBlocks.clear();
+    EvictTextLayouts(static_cast<size_t>(MaxLayouts));
+
+    if (Instanced) {
+        int const glyphCount = CurVertex / 4;
+        CalcGlyphInstanceBounds(GlyphInstances.data(), glyphCount, FontSurfaceDef.geo.localBounds);
+        UpdateBillboardInstances(
+            FontSurfaceDef.geo, GlyphInstances.data(), glyphCount, sizeof(ovrGlyphInstance));
+        FontSurfaceDef.numInstances = glyphCount;
+        FontSurfaceDef.geo.indexCount = (glyphCount > 0) ? 6 : 0;
+        return;
+    }
+
+    CalcVertexBounds(Vertices.data(), CurVertex, FontSurfaceDef.geo.localBounds);
 
     glBindVertexArray(FontSurfaceDef.geo.vertexArrayObject);
     glBindBuffer(GL_ARRAY_BUFFER, FontSurfaceDef.geo.vertexBuffer);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, CurVertex * sizeof(fontVertex_t), (void*)Vertices);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, CurVertex * sizeof(fontVertex_t), (void*)Vertices.data());
     glBindVertexArray(0);
     FontSurfaceDef.geo.indexCount = CurIndex;
 }
@@ -2431,7 +3172,8 @@ void BitmapFontSurfaceLocal::AppendSurfaceList(
 
     ovrDrawSurface drawSurf;
 
-    FontSurfaceDef.graphicsCommand.Program = AsLocal(font).GetFontProgram();
+    FontSurfaceDef.graphicsCommand.Program =
+        Instanced ? AsLocal(font).GetFontInstancedProgram() : AsLocal(font).GetFontProgram();
     FontSurfaceDef.graphicsCommand.UniformData[0].Data = (void*)&AsLocal(font).GetFontTexture();
 
     drawSurf.surface = &FontSurfaceDef;
@@ -27,6 +27,7 @@ Authors     :   Jonathan E. Wright
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -36,6 +37,8 @@ Authors     :   Jonathan E. Wright
 namespace OVRFW {
 
 class ovrFileSys;
+class ovrJobPool;
+class ovrGlyphRasterizer;
 class BitmapFont;
 class BitmapFontSurface;
 
@@ -76,6 +79,19 @@ class BitmapFont {
     static void Free(BitmapFont*& font);
 
     virtual bool Load(ovrFileSys& fileSys, const char* uri) = 0;
+    // Generates signed distance field glyphs at runtime instead of loading a baked font image.
+    // Printable ASCII is generated here, any other glyph the first time text containing it is
+    // measured, so fonts with large character sets only pay for the glyphs that are used. The
+    // rasterizer must outlive the font, ovrTrueTypeRasterizer reads .ttf files. Must be called on
+    // the GL thread. Text may be measured on another thread, such as the simulation thread of
+    // XrApp::PipelinedFrames, but only one at a time; new glyphs are uploaded to the atlas by the
+    // next BitmapFontSurface::Finish() or TextSurface() on the GL thread. The glyphs are
+    // rasterized on the job pool, which may be nullptr.
+    virtual bool LoadFromRasterizer(
+        const ovrGlyphRasterizer& rasterizer,
+        ovrJobPool* jobPool,
+        const int pixelHeight,
+        const int atlasSize) = 0;
 
     // Calculates the native (unscaled) width of the text string. Line endings are ignored.
     virtual float CalcTextWidth(char const* text) const = 0;
@@ -155,6 +171,22 @@ class BitmapFont {
     virtual ~BitmapFont() {}
 };
 
+//==============================================================
+// ovrTextLayoutCacheStats
+// Counters of the text layout cache of a BitmapFontSurface, since the last reset.
+struct ovrTextLayoutCacheStats {
+    ovrTextLayoutCacheStats() : Hits(0), Misses(0), Evictions(0), Entries(0) {}
+
+    float GetHitRate() const {
+        return (Hits + Misses > 0) ? static_cast<float>(Hits) / (Hits + Misses) : 0.0f;
+    }
+
+    uint64_t Hits; // draw calls that reused a cached layout
+    uint64_t Misses; // draw calls that laid out their text
+    uint64_t Evictions; // least recently used layouts that were dropped
+    int Entries; // layouts currently cached
+};
+
 //==============================================================
 // BitmapFontSurface
 class BitmapFontSurface {
@@ -162,7 +194,9 @@ class BitmapFontSurface {
     static BitmapFontSurface* Create();
     static void Free(BitmapFontSurface*& fontSurface);
 
-    virtual void Init(const int maxVertices) = 0;
+    // With instanced set, one compact record is uploaded per glyph by Finish() and the vertex
+    // shader expands it to a quad, instead of uploading four vertices per glyph.
+    virtual void Init(const int maxVertices, const bool instanced = false) = 0;
     // Draw functions returns the amount to modify position by for the next draw call if you want to
     // render more lines and have them spaced normally. Will be along the vector up.
     virtual OVR::Vector3f DrawText3D(
@@ -210,6 +244,15 @@ class BitmapFontSurface {
 
     virtual void SetCullEnabled(const bool enabled) = 0;
 
+    // The draw calls reuse the layout of text that was drawn before with the same font, string
+    // and parameters, so text that does not change only costs a transform per frame. Finish()
+    // evicts the least recently used layouts beyond maxLayouts, 0 disables the cache.
+    virtual void SetLayoutCacheSize(const int maxLayouts) = 0;
+    // Must be called when a font the surface has drawn with is reloaded or freed.
+    virtual void ClearLayoutCache() = 0;
+    virtual ovrTextLayoutCacheStats GetLayoutCacheStats() const = 0;
+    virtual void ResetLayoutCacheStats() = 0;
+
    protected:
     virtual ~BitmapFontSurface() {}
 };
@@ -168,7 +168,7 @@ void OvrDebugLinesLocal::Init(float lineWidth) {
 
     for (int i = 0; i < 2; i++) {
         DebugLines_t& dl = i == 0 ? NonDepthTested : DepthTested;
-        dl.Surf.geo.Create(dl.Attr, indices);
+        dl.Surf.geo.CreateDynamic(dl.Attr, indices, MAX_INDICES);
         dl.Surf.geo.primitiveType = GlGeometry::kPrimitiveTypeLines;
         ovrGraphicsCommand& gc = dl.Surf.graphicsCommand;
         gc.GpuState.blendDst = ovrGpuState::kGL_ONE_MINUS_SRC_ALPHA;
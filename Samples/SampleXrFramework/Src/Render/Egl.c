@@ -36,16 +36,17 @@ Language 	:	C99
 // Implementation
 //==============================================================================
 
-#if defined(ANDROID)
+#if !defined(WIN32)
 PFNEGLCREATESYNCKHRPROC eglCreateSyncKHR_;
 PFNEGLDESTROYSYNCKHRPROC eglDestroySyncKHR_;
 PFNEGLCLIENTWAITSYNCKHRPROC eglClientWaitSyncKHR_;
 PFNEGLSIGNALSYNCKHRPROC eglSignalSyncKHR_;
 PFNEGLGETSYNCATTRIBKHRPROC eglGetSyncAttribKHR_;
 PFNEGLDUPNATIVEFENCEFDANDROIDPROC eglDupNativeFenceFDANDROID_;
-#endif // defined(ANDROID)
+#endif // !defined(WIN32)
 
 PFNGLINVALIDATEFRAMEBUFFER_ glInvalidateFramebuffer_;
+PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64vEXT_;
 
 /*
    ================================================================================
@@ -58,11 +59,11 @@ PFNGLINVALIDATEFRAMEBUFFER_ glInvalidateFramebuffer_;
 OpenGLExtensions_t glExtensions;
 
 void* EglGetExtensionProc(const char* functionName) {
-#if defined(ANDROID)
+#if !defined(WIN32)
     void* ptr = (void*)eglGetProcAddress(functionName);
-#elif defined(WIN32)
+#else
     void* ptr = (void*)wglGetProcAddress(functionName);
-#endif // defined(ANDROID)
+#endif // !defined(WIN32)
     if (ptr == NULL) {
         ALOG("NOT FOUND: %s", functionName);
     }
@@ -81,9 +82,13 @@ void EglInitExtensions() {
 
         glExtensions.EXT_texture_filter_anisotropic =
             strstr(allExtensions, "GL_EXT_texture_filter_anisotropic");
+
+        glExtensions.EXT_disjoint_timer_query =
+            strstr(allExtensions, "GL_EXT_disjoint_timer_query") ||
+            strstr(allExtensions, "GL_ARB_timer_query");
     }
 
-#if defined(ANDROID)
+#if !defined(WIN32)
     eglCreateSyncKHR_ = (PFNEGLCREATESYNCKHRPROC)EglGetExtensionProc("eglCreateSyncKHR");
     eglDestroySyncKHR_ = (PFNEGLDESTROYSYNCKHRPROC)EglGetExtensionProc("eglDestroySyncKHR");
     eglClientWaitSyncKHR_ =
@@ -92,12 +97,23 @@ void EglInitExtensions() {
     eglGetSyncAttribKHR_ = (PFNEGLGETSYNCATTRIBKHRPROC)EglGetExtensionProc("eglGetSyncAttribKHR");
     eglDupNativeFenceFDANDROID_ =
         (PFNEGLDUPNATIVEFENCEFDANDROIDPROC)EglGetExtensionProc("eglDupNativeFenceFDANDROID");
-#endif // defined(ANDROID)
+#endif // !defined(WIN32)
     glInvalidateFramebuffer_ =
         (PFNGLINVALIDATEFRAMEBUFFER_)EglGetExtensionProc("glInvalidateFramebuffer");
+
+    glGetQueryObjectui64vEXT_ = NULL;
+    if (glExtensions.EXT_disjoint_timer_query) {
+#if defined(WIN32)
+        glGetQueryObjectui64vEXT_ = (PFNGLGETQUERYOBJECTUI64VEXTPROC)glGetQueryObjectui64v;
+#else
+        glGetQueryObjectui64vEXT_ = (PFNGLGETQUERYOBJECTUI64VEXTPROC)EglGetExtensionProc(
+            "glGetQueryObjectui64vEXT");
+#endif // defined(WIN32)
+        glExtensions.EXT_disjoint_timer_query = glGetQueryObjectui64vEXT_ != NULL;
+    }
 }
 
-#if defined(ANDROID)
+#if !defined(WIN32)
 
 const char* EglErrorString(const EGLint error) {
     switch (error) {
@@ -142,7 +158,7 @@ const char* EglErrorString(const GLint err) {
     return ovrGl_ErrorString_Windows(err);
 }
 
-#endif // defined(ANDROID)
+#endif // !defined(WIN32)
 
 const char* GlFrameBufferStatusString(GLenum status) {
     switch (status) {
@@ -216,7 +232,7 @@ bool GLCheckErrorsWithTitle(const char* logTitle) {
     return hadError;
 }
 
-#if defined(ANDROID)
+#if !defined(WIN32)
 
 EGLint GL_FlushSync(int timeout) {
     // if extension not present, return NO_SYNC
@@ -439,4 +455,4 @@ void ovrEgl_DestroyContext(ovrEgl* egl) {
     ovrGl_DestroyContext_Windows();
 }
 
-#endif // defined(ANDROID)
+#endif // !defined(WIN32)
@@ -124,6 +124,16 @@ typedef void(GL_APIENTRY* PFNGLFRAMEBUFFERTEXTUREMULTISAMPLEMULTIVIEWOVRPROC)(
 #define GL_SAMPLER_EXTERNAL_OES 0x8D66
 #endif /* GL_OES_EGL_image_external */
 
+// EXT_disjoint_timer_query, or ARB_timer_query on desktop GL
+#if !defined(GL_EXT_disjoint_timer_query)
+#define GL_TIME_ELAPSED_EXT 0x88BF
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+typedef void(GL_APIENTRY* PFNGLGETQUERYOBJECTUI64VEXTPROC)(
+    GLuint id,
+    GLenum pname,
+    GLuint64* params);
+#endif
+
 typedef struct ovrEgl_s {
 #if !defined(WIN32)
     EGLint MajorVersion;
@@ -143,6 +153,7 @@ typedef struct {
     bool multi_view; // GL_OVR_multiview, GL_OVR_multiview2
     bool EXT_texture_border_clamp; // GL_EXT_texture_border_clamp, GL_OES_texture_border_clamp
     bool EXT_texture_filter_anisotropic; // GL_EXT_texture_filter_anisotropic
+    bool EXT_disjoint_timer_query; // GL_EXT_disjoint_timer_query, GL_ARB_timer_query
 } OpenGLExtensions_t;
 
 extern OpenGLExtensions_t glExtensions;
@@ -157,7 +168,7 @@ void ovrEgl_Clear(ovrEgl* egl);
 void ovrEgl_CreateContext(ovrEgl* egl, const ovrEgl* shareEgl);
 void ovrEgl_DestroyContext(ovrEgl* egl);
 
-#if defined(ANDROID)
+#if !defined(WIN32)
 // EGL_KHR_reusable_sync
 extern PFNEGLCREATESYNCKHRPROC eglCreateSyncKHR_;
 extern PFNEGLDESTROYSYNCKHRPROC eglDestroySyncKHR_;
@@ -167,7 +178,7 @@ extern PFNEGLGETSYNCATTRIBKHRPROC eglGetSyncAttribKHR_;
 
 // EGL_ANDROID_native_fence_sync
 extern PFNEGLDUPNATIVEFENCEFDANDROIDPROC eglDupNativeFenceFDANDROID_;
-#endif // defined(ANDROID)
+#endif // !defined(WIN32)
 
 typedef void(GL_APIENTRYP PFNGLINVALIDATEFRAMEBUFFER_)(
     GLenum target,
@@ -175,6 +186,9 @@ typedef void(GL_APIENTRYP PFNGLINVALIDATEFRAMEBUFFER_)(
     const GLenum* attachments);
 extern PFNGLINVALIDATEFRAMEBUFFER_ glInvalidateFramebuffer_;
 
+// Only set if glExtensions.EXT_disjoint_timer_query is.
+extern PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64vEXT_;
+
 // These use a KHR_Sync object if available, so drivers can't "optimize" the finish/flush away.
 void GL_Finish();
 void GL_Flush();
@@ -189,11 +203,11 @@ void GL_InvalidateFramebuffer(
     const bool depthBuffer);
 
 const char* GlFrameBufferStatusString(GLenum status);
-#if defined(ANDROID)
+#if !defined(WIN32)
 const char* EglErrorString(const EGLint error);
 #else
 const char* EglErrorString(const GLint error);
-#endif // defined(ANDROID)
+#endif // !defined(WIN32)
 
 #ifdef OVR_BUILD_DEBUG
 #define CHECK_GL_ERRORS 1
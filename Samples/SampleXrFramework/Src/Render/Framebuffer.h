@@ -72,6 +72,9 @@ typedef void(GL_APIENTRY* PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC)(
 #include <unknwn.h>
 #define XR_USE_GRAPHICS_API_OPENGL 1
 #define XR_USE_PLATFORM_WIN32 1
+#else
+#define XR_USE_GRAPHICS_API_OPENGL_ES 1
+#define XR_USE_PLATFORM_EGL 1
 #endif // defined(ANDROID)
 
 #include <openxr/openxr.h>
@@ -95,9 +95,10 @@ OVRFW::GlGeometry::Descriptor GeometryBuilder::ToGeometryDescriptor(
         const OVR::Matrix3f nt = OVR::Matrix3f(t).Inverse().Transposed();
 
         /// Vertices
-        for (size_t i = 0; i < node.geometry.attribs.position.size(); ++i) {
-            attribs.position[i + currentVertex] = t.Transform(node.geometry.attribs.position[i]);
-        }
+        t.TransformPoints(
+            node.geometry.attribs.position.data(),
+            attribs.position.data() + currentVertex,
+            static_cast<int>(node.geometry.attribs.position.size()));
         for (size_t i = 0; i < node.geometry.attribs.normal.size(); ++i) {
             attribs.normal[i + currentVertex] =
                 nt.Transform(node.geometry.attribs.normal[i]).Normalized();
@@ -0,0 +1,420 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   GeometryOptimizer.cpp
+Content     :   Load time triangle and vertex reordering for faster rendering.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "GeometryOptimizer.h"
+
+#include "Misc/Log.h"
+
+#include <math.h>
+#include <algorithm>
+
+using OVR::Vector3f;
+
+namespace OVRFW {
+
+ovrVertexCacheStats AnalyzeVertexCache(
+    const std::vector<uint32_t>& indices,
+    const int vertexCount,
+    const int cacheSize) {
+    ovrVertexCacheStats stats;
+    const int triangleCount = static_cast<int>(indices.size()) / 3;
+    if (triangleCount == 0) {
+        return stats;
+    }
+
+    // A vertex is in the FIFO if fewer than cacheSize vertices were added after it.
+    std::vector<int> addedAt(vertexCount, -1);
+    int numAdded = 0;
+    int numVertices = 0;
+    for (int i = 0; i < triangleCount * 3; i++) {
+        const uint32_t v = indices[i];
+        if (addedAt[v] < 0) {
+            numVertices++;
+        }
+        if (addedAt[v] < 0 || numAdded - addedAt[v] >= cacheSize) {
+            addedAt[v] = numAdded++;
+        }
+    }
+    stats.acmr = static_cast<float>(numAdded) / triangleCount;
+    stats.atvr = static_cast<float>(numAdded) / numVertices;
+    return stats;
+}
+
+//==============================================================
+// Vertex cache optimization
+
+static const int FORSYTH_CACHE_SIZE = 32;
+static const int FORSYTH_MAX_VALENCE = 32;
+
+struct ForsythScores {
+    ForsythScores() {
+        for (int i = 0; i < FORSYTH_CACHE_SIZE; i++) {
+            if (i < 3) {
+                // the vertices of the last triangle get a fixed score, so that the next
+                // triangle isn't simply the one that shares an edge with it
+                cache[i] = 0.75f;
+            } else {
+                cache[i] = powf(1.0f - (i - 3) * (1.0f / (FORSYTH_CACHE_SIZE - 3)), 1.5f);
+            }
+        }
+        valence[0] = 0.0f;
+        for (int i = 1; i <= FORSYTH_MAX_VALENCE; i++) {
+            // vertices with few triangles left are finished first
+            valence[i] = 2.0f / sqrtf(static_cast<float>(i));
+        }
+    }
+
+    float Vertex(const int cachePosition, const int remainingTriangles) const {
+        if (remainingTriangles == 0) {
+            return -1.0f;
+        }
+        return ((cachePosition >= 0) ? cache[cachePosition] : 0.0f) +
+            valence[std::min(remainingTriangles, FORSYTH_MAX_VALENCE)];
+    }
+
+    float cache[FORSYTH_CACHE_SIZE];
+    float valence[FORSYTH_MAX_VALENCE + 1];
+};
+
+void OptimizeVertexCache(std::vector<uint32_t>& indices, const int vertexCount) {
+    static const ForsythScores scores;
+
+    const int triangleCount = static_cast<int>(indices.size()) / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // The triangles of each vertex that were not emitted yet are at the start of its range.
+    std::vector<int> vertexTriangleStart(vertexCount + 1, 0);
+    for (int i = 0; i < triangleCount * 3; i++) {
+        vertexTriangleStart[indices[i] + 1]++;
+    }
+    for (int i = 0; i < vertexCount; i++) {
+        vertexTriangleStart[i + 1] += vertexTriangleStart[i];
+    }
+    std::vector<int> remaining(vertexCount, 0);
+    std::vector<int> vertexTriangles(triangleCount * 3);
+    for (int i = 0; i < triangleCount * 3; i++) {
+        const uint32_t v = indices[i];
+        vertexTriangles[vertexTriangleStart[v] + remaining[v]++] = i / 3;
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (int v = 0; v < vertexCount; v++) {
+        vertexScore[v] = scores.Vertex(-1, remaining[v]);
+    }
+    std::vector<float> triangleScore(triangleCount);
+    for (int t = 0; t < triangleCount; t++) {
+        triangleScore[t] = vertexScore[indices[t * 3 + 0]] + vertexScore[indices[t * 3 + 1]] +
+            vertexScore[indices[t * 3 + 2]];
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> optimized;
+    optimized.reserve(triangleCount * 3);
+
+    int cache[FORSYTH_CACHE_SIZE + 3];
+    int cacheSize = 0;
+    int nextUnemitted = 0;
+    int bestTriangle = -1;
+
+    for (int numEmitted = 0; numEmitted < triangleCount; numEmitted++) {
+        if (bestTriangle < 0) {
+            // nothing in the cache has triangles left, start over somewhere else
+            while (emitted[nextUnemitted]) {
+                nextUnemitted++;
+            }
+            bestTriangle = nextUnemitted;
+        }
+
+        const uint32_t* tri = &indices[bestTriangle * 3];
+        emitted[bestTriangle] = true;
+        int newCache[FORSYTH_CACHE_SIZE + 3];
+        int newCacheSize = 0;
+        for (int j = 0; j < 3; j++) {
+            const uint32_t v = tri[j];
+            optimized.push_back(v);
+
+            // remove the triangle from the triangles left on the vertex
+            const int start = vertexTriangleStart[v];
+            for (int k = start; k < start + remaining[v]; k++) {
+                if (vertexTriangles[k] == bestTriangle) {
+                    std::swap(vertexTriangles[k], vertexTriangles[start + remaining[v] - 1]);
+                    remaining[v]--;
+                    break;
+                }
+            }
+
+            if (cachePosition[v] != -2) {
+                cachePosition[v] = -2; // marks the vertex as already in the new cache
+                newCache[newCacheSize++] = v;
+            }
+        }
+        for (int i = 0; i < cacheSize; i++) {
+            const int v = cache[i];
+            if (cachePosition[v] != -2) {
+                newCache[newCacheSize++] = v;
+            }
+        }
+
+        // Update the scores of everything that was or is in the cache, and find the best
+        // triangle among those that use a cached vertex.
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (int i = 0; i < newCacheSize; i++) {
+            const int v = newCache[i];
+            cachePosition[v] = (i < FORSYTH_CACHE_SIZE) ? i : -1;
+            const float score = scores.Vertex(cachePosition[v], remaining[v]);
+            const float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+            const int start = vertexTriangleStart[v];
+            for (int k = start; k < start + remaining[v]; k++) {
+                const int t = vertexTriangles[k];
+                triangleScore[t] += delta;
+                if (cachePosition[v] >= 0 && triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        cacheSize = std::min(newCacheSize, FORSYTH_CACHE_SIZE);
+        std::copy(newCache, newCache + cacheSize, cache);
+    }
+
+    indices.swap(optimized);
+}
+
+//==============================================================
+// Overdraw optimization
+
+void OptimizeOverdraw(
+    std::vector<uint32_t>& indices,
+    const std::vector<Vector3f>& positions,
+    const float threshold) {
+    const int triangleCount = static_cast<int>(indices.size()) / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // Cut clusters where the FIFO cache would restart anyway, or where the cluster is good
+    // enough that flushing the whole cache after it keeps it below the target ACMR.
+    const int cacheSize = 16;
+    const float targetAcmr =
+        AnalyzeVertexCache(indices, static_cast<int>(positions.size()), cacheSize).acmr *
+        threshold;
+    std::vector<int> clusterStarts;
+    std::vector<int> addedAt(positions.size(), -1);
+    int numAdded = 0;
+    int clusterStart = 0; // numAdded when the cluster started
+    int clusterFirstTriangle = 0;
+    int clusterMisses = 0;
+    for (int t = 0; t < triangleCount; t++) {
+        int misses = 0;
+        for (int j = 0; j < 3; j++) {
+            const int at = addedAt[indices[t * 3 + j]];
+            if (at < clusterStart || numAdded - at >= cacheSize) {
+                misses++;
+            }
+        }
+        if (t == 0 || misses == 3 ||
+            clusterMisses + cacheSize <= targetAcmr * (t - clusterFirstTriangle)) {
+            clusterStarts.push_back(t);
+            clusterStart = numAdded;
+            clusterFirstTriangle = t;
+            clusterMisses = 0;
+        }
+        for (int j = 0; j < 3; j++) {
+            const uint32_t v = indices[t * 3 + j];
+            if (addedAt[v] < clusterStart || numAdded - addedAt[v] >= cacheSize) {
+                addedAt[v] = numAdded++;
+                clusterMisses++;
+            }
+        }
+    }
+    const int clusterCount = static_cast<int>(clusterStarts.size());
+    clusterStarts.push_back(triangleCount);
+    if (clusterCount == 1) {
+        return;
+    }
+
+    // area weighted centroids and normals
+    std::vector<Vector3f> clusterCentroids(clusterCount, Vector3f(0.0f));
+    std::vector<Vector3f> clusterNormals(clusterCount, Vector3f(0.0f));
+    Vector3f meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (int c = 0; c < clusterCount; c++) {
+        float clusterArea = 0.0f;
+        for (int t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+            const Vector3f& p0 = positions[indices[t * 3 + 0]];
+            const Vector3f& p1 = positions[indices[t * 3 + 1]];
+            const Vector3f& p2 = positions[indices[t * 3 + 2]];
+            const Vector3f normal = (p1 - p0).Cross(p2 - p0);
+            const float area = normal.Length();
+            clusterCentroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+            clusterNormals[c] += normal;
+            clusterArea += area;
+        }
+        meshCentroid += clusterCentroids[c];
+        meshArea += clusterArea;
+        if (clusterArea > 0.0f) {
+            clusterCentroids[c] /= clusterArea;
+        }
+    }
+    if (meshArea > 0.0f) {
+        meshCentroid /= meshArea;
+    }
+
+    std::vector<float> clusterSortKeys(clusterCount);
+    std::vector<int> clusterOrder(clusterCount);
+    for (int c = 0; c < clusterCount; c++) {
+        const float normalLength = clusterNormals[c].Length();
+        clusterSortKeys[c] = (normalLength > 0.0f)
+            ? (clusterCentroids[c] - meshCentroid).Dot(clusterNormals[c]) / normalLength
+            : 0.0f;
+        clusterOrder[c] = c;
+    }
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&clusterSortKeys](int a, int b) {
+        return clusterSortKeys[a] > clusterSortKeys[b];
+    });
+
+    std::vector<uint32_t> sorted;
+    sorted.reserve(indices.size());
+    for (const int c : clusterOrder) {
+        sorted.insert(
+            sorted.end(),
+            indices.begin() + clusterStarts[c] * 3,
+            indices.begin() + clusterStarts[c + 1] * 3);
+    }
+    indices.swap(sorted);
+}
+
+//==============================================================
+// Vertex fetch optimization
+
+template <typename _attrib_type_>
+static void RemapVertexAttribute(
+    std::vector<_attrib_type_>& attrib,
+    const std::vector<uint32_t>& remap) {
+    // attributes that don't have a value for every vertex are left alone
+    if (attrib.size() != remap.size()) {
+        return;
+    }
+    std::vector<_attrib_type_> remapped(attrib.size());
+    for (size_t i = 0; i < attrib.size(); i++) {
+        remapped[remap[i]] = attrib[i];
+    }
+    attrib.swap(remapped);
+}
+
+static void RemapVertexAttribs(VertexAttribs& attribs, const std::vector<uint32_t>& remap) {
+    RemapVertexAttribute(attribs.position, remap);
+    RemapVertexAttribute(attribs.normal, remap);
+    RemapVertexAttribute(attribs.tangent, remap);
+    RemapVertexAttribute(attribs.binormal, remap);
+    RemapVertexAttribute(attribs.color, remap);
+    RemapVertexAttribute(attribs.uv0, remap);
+    RemapVertexAttribute(attribs.uv1, remap);
+    RemapVertexAttribute(attribs.jointIndices, remap);
+    RemapVertexAttribute(attribs.jointWeights, remap);
+}
+
+void OptimizeVertexFetch(
+    VertexAttribs& attribs,
+    std::vector<uint32_t>& indices,
+    std::vector<VertexAttribs>* targets) {
+    const uint32_t unused = ~0u;
+    const size_t vertexCount = attribs.position.size();
+    std::vector<uint32_t> remap(vertexCount, unused);
+    uint32_t next = 0;
+    for (uint32_t& index : indices) {
+        if (remap[index] == unused) {
+            remap[index] = next++;
+        }
+        index = remap[index];
+    }
+    for (uint32_t& r : remap) {
+        if (r == unused) {
+            r = next++;
+        }
+    }
+
+    RemapVertexAttribs(attribs, remap);
+    if (targets != nullptr) {
+        for (VertexAttribs& target : *targets) {
+            RemapVertexAttribs(target, remap);
+        }
+    }
+}
+
+//==============================================================
+// All of it
+
+void OptimizeGeometry(
+    VertexAttribs& attribs,
+    std::vector<uint32_t>& indices,
+    std::vector<VertexAttribs>* targets,
+    const bool optimizeOverdraw,
+    ovrVertexCacheStats* before,
+    ovrVertexCacheStats* after) {
+    const int vertexCount = static_cast<int>(attribs.position.size());
+    const bool valid = indices.size() % 3 == 0 &&
+        std::all_of(indices.begin(), indices.end(), [vertexCount](const uint32_t index) {
+                           return index < static_cast<uint32_t>(vertexCount);
+                       });
+    if (!valid) {
+        ALOGW("OptimizeGeometry: not a valid triangle list, leaving it unchanged");
+    }
+    if (before != nullptr) {
+        *before = valid ? AnalyzeVertexCache(indices, vertexCount) : ovrVertexCacheStats();
+    }
+    if (valid) {
+        OptimizeVertexCache(indices, vertexCount);
+        if (optimizeOverdraw) {
+            OptimizeOverdraw(indices, attribs.position);
+        }
+        OptimizeVertexFetch(attribs, indices, targets);
+    }
+    if (after != nullptr) {
+        *after = valid ? AnalyzeVertexCache(indices, vertexCount) : ovrVertexCacheStats();
+    }
+}
+
+void OptimizeGeometry(
+    VertexAttribs& attribs,
+    std::vector<TriangleIndex>& indices,
+    std::vector<VertexAttribs>* targets,
+    const bool optimizeOverdraw,
+    ovrVertexCacheStats* before,
+    ovrVertexCacheStats* after) {
+    std::vector<uint32_t> wideIndices(indices.begin(), indices.end());
+    OptimizeGeometry(attribs, wideIndices, targets, optimizeOverdraw, before, after);
+    indices.assign(wideIndices.begin(), wideIndices.end());
+}
+
+} // namespace OVRFW
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   GeometryOptimizer.h
+Content     :   Load time triangle and vertex reordering for faster rendering.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "GlGeometry.h"
+
+namespace OVRFW {
+
+// Post-transform vertex cache efficiency of an indexed triangle list.
+struct ovrVertexCacheStats {
+    ovrVertexCacheStats() : acmr(0.0f), atvr(0.0f) {}
+
+    float acmr; // cache misses per triangle, 3 at worst and about 0.5 for a regular grid
+    float atvr; // cache misses per referenced vertex, 1 is optimal
+};
+
+// Simulates a FIFO post-transform cache with cacheSize entries.
+ovrVertexCacheStats AnalyzeVertexCache(
+    const std::vector<uint32_t>& indices,
+    const int vertexCount,
+    const int cacheSize = 16);
+
+// Reorders the triangles for post-transform vertex cache hits, with Tom Forsyth's
+// "Linear-Speed Vertex Cache Optimisation".  The result does well on any cache size.
+void OptimizeVertexCache(std::vector<uint32_t>& indices, const int vertexCount);
+
+// Splits cache optimized triangles into clusters and draws the clusters that face away from
+// the center of the mesh first, because they tend to occlude the others from most view
+// points (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+// Clusters are only cut where the ACMR stays within threshold times the ACMR of the input.
+void OptimizeOverdraw(
+    std::vector<uint32_t>& indices,
+    const std::vector<OVR::Vector3f>& positions,
+    const float threshold = 1.05f);
+
+// Reorders the vertices in the order the triangles first use them, so vertex fetches walk
+// through memory.  Vertices that no triangle uses are moved to the end.  The morph targets
+// are reordered along with the vertices.
+void OptimizeVertexFetch(
+    VertexAttribs& attribs,
+    std::vector<uint32_t>& indices,
+    std::vector<VertexAttribs>* targets = nullptr);
+
+// Runs the cache, optional overdraw and fetch optimizations on a triangle list, and returns
+// the cache statistics from before and after.
+void OptimizeGeometry(
+    VertexAttribs& attribs,
+    std::vector<uint32_t>& indices,
+    std::vector<VertexAttribs>* targets,
+    const bool optimizeOverdraw,
+    ovrVertexCacheStats* before = nullptr,
+    ovrVertexCacheStats* after = nullptr);
+void OptimizeGeometry(
+    VertexAttribs& attribs,
+    std::vector<TriangleIndex>& indices,
+    std::vector<VertexAttribs>* targets,
+    const bool optimizeOverdraw,
+    ovrVertexCacheStats* before = nullptr,
+    ovrVertexCacheStats* after = nullptr);
+
+} // namespace OVRFW
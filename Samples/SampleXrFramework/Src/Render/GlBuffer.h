@@ -27,6 +27,7 @@ Authors     :
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace OVRFW {
@@ -30,6 +30,8 @@ Authors     :   John Carmack, J.M.P. van Waveren
 #include "Misc/Log.h"
 #include "Egl.h"
 
+#include <algorithm>
+
 using OVR::Bounds3f;
 using OVR::Vector2f;
 using OVR::Vector3f;
@@ -58,97 +60,404 @@ GlGeometry::TransformScope::~TransformScope() {
     geometryTransfom = previousTransform;
 }
 
-unsigned GlGeometry::IndexType = (sizeof(TriangleIndex) == 2) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+unsigned GlGeometry::GetIndexType(const int indexSize) {
+    return (indexSize == 2) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+int GlGeometry::GetIndexSize() const {
+    return (IndexType == GL_UNSIGNED_SHORT) ? 2 : 4;
+}
+
+// The attributes in the order they are packed in the vertex buffer.
+struct VertexAttributeStream {
+    const void* data;
+    int count;
+    int elementSize;
+    int glLocation;
+    int glType;
+    int glComponents;
+};
+
+static const int NUM_VERTEX_ATTRIBUTE_STREAMS = 9;
 
 template <typename _attrib_type_>
-void PackVertexAttribute(
-    std::vector<uint8_t>& packed,
+static VertexAttributeStream MakeVertexAttributeStream(
     const std::vector<_attrib_type_>& attrib,
     const int glLocation,
     const int glType,
     const int glComponents) {
-    if (attrib.size() > 0) {
-        const size_t offset = packed.size();
-        const size_t size = attrib.size() * sizeof(attrib[0]);
+    return {
+        attrib.data(),
+        static_cast<int>(attrib.size()),
+        static_cast<int>(sizeof(_attrib_type_)),
+        glLocation,
+        glType,
+        glComponents};
+}
 
-        packed.resize(offset + size);
-        memcpy(&packed[offset], attrib.data(), size);
+static void GetVertexAttributeStreams(
+    const VertexAttribs& attribs,
+    VertexAttributeStream (&streams)[NUM_VERTEX_ATTRIBUTE_STREAMS]) {
+    // clang-format off
+    streams[0] = MakeVertexAttributeStream(attribs.position, VERTEX_ATTRIBUTE_LOCATION_POSITION, GL_FLOAT, 3);
+    streams[1] = MakeVertexAttributeStream(attribs.normal, VERTEX_ATTRIBUTE_LOCATION_NORMAL, GL_FLOAT, 3);
+    streams[2] = MakeVertexAttributeStream(attribs.tangent, VERTEX_ATTRIBUTE_LOCATION_TANGENT, GL_FLOAT, 3);
+    streams[3] = MakeVertexAttributeStream(attribs.binormal, VERTEX_ATTRIBUTE_LOCATION_BINORMAL, GL_FLOAT, 3);
+    streams[4] = MakeVertexAttributeStream(attribs.color, VERTEX_ATTRIBUTE_LOCATION_COLOR, GL_FLOAT, 4);
+    streams[5] = MakeVertexAttributeStream(attribs.uv0, VERTEX_ATTRIBUTE_LOCATION_UV0, GL_FLOAT, 2);
+    streams[6] = MakeVertexAttributeStream(attribs.uv1, VERTEX_ATTRIBUTE_LOCATION_UV1, GL_FLOAT, 2);
+    streams[7] = MakeVertexAttributeStream(attribs.jointIndices, VERTEX_ATTRIBUTE_LOCATION_JOINT_INDICES, GL_INT, 4);
+    streams[8] = MakeVertexAttributeStream(attribs.jointWeights, VERTEX_ATTRIBUTE_LOCATION_JOINT_WEIGHTS, GL_FLOAT, 4);
+    // clang-format on
+}
 
-        glEnableVertexAttribArray(glLocation);
-        glVertexAttribPointer(
-            glLocation, glComponents, glType, false, sizeof(attrib[0]), (void*)(offset));
-    } else {
-        glDisableVertexAttribArray(glLocation);
+static uint32_t GetVertexAttributeMask(
+    const VertexAttributeStream (&streams)[NUM_VERTEX_ATTRIBUTE_STREAMS]) {
+    uint32_t mask = 0;
+    for (int i = 0; i < NUM_VERTEX_ATTRIBUTE_STREAMS; i++) {
+        if (streams[i].count > 0) {
+            mask |= 1u << i;
+        }
     }
+    return mask;
 }
 
-void GlGeometry::Create(const VertexAttribs& attribs, const std::vector<TriangleIndex>& indices) {
-    vertexCount = attribs.position.size();
-    indexCount = indices.size();
+// Size of one copy of the vertices in the dynamic vertex buffer.
+static size_t GetDynamicBufferSize(
+    const VertexAttributeStream (&streams)[NUM_VERTEX_ATTRIBUTE_STREAMS],
+    const uint32_t attributeMask,
+    const int32_t vertexCapacity) {
+    size_t size = 0;
+    for (int i = 0; i < NUM_VERTEX_ATTRIBUTE_STREAMS; i++) {
+        if (attributeMask & (1u << i)) {
+            size += static_cast<size_t>(vertexCapacity) * streams[i].elementSize;
+        }
+    }
+    return size;
+}
 
-    const bool t = enableGeometryTransfom;
+const char* OctahedralDecodeShaderSrc = R"glsl(
+highp vec3 OctahedralDecode( highp vec2 e )
+{
+    highp vec3 v = vec3( e.xy, 1.0 - abs( e.x ) - abs( e.y ) );
+    if ( v.z < 0.0 )
+    {
+        v.xy = ( 1.0 - abs( v.yx ) ) * vec2( v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0 );
+    }
+    return normalize( v );
+}
+)glsl";
+
+VertexLayout VertexLayout::Compact() {
+    VertexLayout layout;
+    layout.normal = VERTEX_FORMAT_SNORM16;
+    layout.tangent = VERTEX_FORMAT_SNORM16;
+    layout.binormal = VERTEX_FORMAT_SNORM16;
+    layout.color = VERTEX_FORMAT_UNORM8;
+    layout.uv0 = VERTEX_FORMAT_HALF;
+    layout.uv1 = VERTEX_FORMAT_HALF;
+    layout.jointIndices = VERTEX_FORMAT_UINT8;
+    layout.jointWeights = VERTEX_FORMAT_UNORM16;
+    layout.interleaved = true;
+    return layout;
+}
 
-    std::vector<OVR::Vector3f> position;
-    std::vector<OVR::Vector3f> normal;
-    std::vector<OVR::Vector3f> tangent;
-    std::vector<OVR::Vector3f> binormal;
+bool VertexLayout::operator==(const VertexLayout& other) const {
+    return position == other.position && normal == other.normal && tangent == other.tangent &&
+        binormal == other.binormal && color == other.color && uv0 == other.uv0 &&
+        uv1 == other.uv1 && jointIndices == other.jointIndices &&
+        jointWeights == other.jointWeights && interleaved == other.interleaved;
+}
 
-    /// we asked for incoming transfom
-    if (t) {
-        position.resize(attribs.position.size());
-        normal.resize(attribs.normal.size());
-        tangent.resize(attribs.position.size());
-        binormal.resize(attribs.binormal.size());
+static void GetVertexAttributeFormats(
+    const VertexLayout& layout,
+    VertexAttributeFormat (&formats)[NUM_VERTEX_ATTRIBUTE_STREAMS]) {
+    formats[0] = layout.position;
+    formats[1] = layout.normal;
+    formats[2] = layout.tangent;
+    formats[3] = layout.binormal;
+    formats[4] = layout.color;
+    formats[5] = layout.uv0;
+    formats[6] = layout.uv1;
+    formats[7] = layout.jointIndices;
+    formats[8] = layout.jointWeights;
+}
 
-        /// Positions use 4x4
-        for (size_t i = 0; i < attribs.position.size(); ++i) {
-            position[i] = geometryTransfom.Transform(attribs.position[i]);
+// How an attribute is stored in the vertex buffer.
+struct PackedVertexAttribute {
+    VertexAttributeFormat format;
+    int glType;
+    int glComponents;
+    bool glNormalized;
+    int componentSize;
+    int elementSize; // padded to a multiple of 4 bytes
+};
+
+static PackedVertexAttribute GetPackedVertexAttribute(
+    const VertexAttributeStream& stream,
+    VertexAttributeFormat format) {
+    if (format == VERTEX_FORMAT_OCTAHEDRAL_SNORM16 && stream.glComponents != 3) {
+        ALOGW("GlGeometry: octahedral format on a %d component attribute", stream.glComponents);
+        format = VERTEX_FORMAT_SNORM16;
+    }
+    PackedVertexAttribute packed;
+    packed.format = format;
+    packed.glComponents = stream.glComponents;
+    packed.glNormalized = false;
+    switch (format) {
+        case VERTEX_FORMAT_FLOAT:
+            packed.glType = GL_FLOAT;
+            packed.componentSize = 4;
+            break;
+        case VERTEX_FORMAT_HALF:
+            packed.glType = GL_HALF_FLOAT;
+            packed.componentSize = 2;
+            break;
+        case VERTEX_FORMAT_SNORM16:
+            packed.glType = GL_SHORT;
+            packed.glNormalized = true;
+            packed.componentSize = 2;
+            break;
+        case VERTEX_FORMAT_UNORM16:
+            packed.glType = GL_UNSIGNED_SHORT;
+            packed.glNormalized = true;
+            packed.componentSize = 2;
+            break;
+        case VERTEX_FORMAT_SNORM8:
+            packed.glType = GL_BYTE;
+            packed.glNormalized = true;
+            packed.componentSize = 1;
+            break;
+        case VERTEX_FORMAT_UNORM8:
+            packed.glType = GL_UNSIGNED_BYTE;
+            packed.glNormalized = true;
+            packed.componentSize = 1;
+            break;
+        case VERTEX_FORMAT_INT32:
+            packed.glType = GL_INT;
+            packed.componentSize = 4;
+            break;
+        case VERTEX_FORMAT_UINT16:
+            packed.glType = GL_UNSIGNED_SHORT;
+            packed.componentSize = 2;
+            break;
+        case VERTEX_FORMAT_UINT8:
+            packed.glType = GL_UNSIGNED_BYTE;
+            packed.componentSize = 1;
+            break;
+        case VERTEX_FORMAT_OCTAHEDRAL_SNORM16:
+            packed.glType = GL_SHORT;
+            packed.glNormalized = true;
+            packed.glComponents = 2;
+            packed.componentSize = 2;
+            break;
+    }
+    packed.elementSize = (packed.glComponents * packed.componentSize + 3) & ~3;
+    return packed;
+}
+
+uint16_t FloatToHalf(const float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x007FFFFF;
+    if (exponent >= 31) {
+        // overflow to infinity, keep NaN a NaN
+        const bool isNaN = ((bits >> 23) & 0xFF) == 0xFF && mantissa != 0;
+        return static_cast<uint16_t>(sign | 0x7C00 | (isNaN ? 0x200 : 0));
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        // denormal, round to nearest even
+        mantissa |= 0x00800000;
+        const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1) != 0)) {
+            half++;
         }
+        return static_cast<uint16_t>(sign | half);
+    }
+    // round to nearest even, a carry into the exponent is still correct
+    uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    const uint32_t remainder = mantissa & 0x1FFF;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1) != 0)) {
+        half++;
+    }
+    return static_cast<uint16_t>(sign | half);
+}
 
-        /// TBN use 3x3
-        const OVR::Matrix3f nt = OVR::Matrix3f(geometryTransfom).Inverse().Transposed();
-        for (size_t i = 0; i < attribs.normal.size(); ++i) {
-            normal[i] = nt.Transform(attribs.normal[i]).Normalized();
+void OctahedralEncode(const float* v, float* e) {
+    const float l1 = fabsf(v[0]) + fabsf(v[1]) + fabsf(v[2]);
+    if (l1 <= 0.0f) {
+        e[0] = 0.0f;
+        e[1] = 0.0f;
+        return;
+    }
+    const float x = v[0] / l1;
+    const float y = v[1] / l1;
+    if (v[2] >= 0.0f) {
+        e[0] = x;
+        e[1] = y;
+    } else {
+        e[0] = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        e[1] = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+    }
+}
+
+template <typename _type_>
+static void StoreComponent(uint8_t* dst, const _type_ value) {
+    memcpy(dst, &value, sizeof(value));
+}
+
+static void PackVertexAttributeElement(
+    const VertexAttributeStream& stream,
+    const PackedVertexAttribute& packed,
+    const int index,
+    uint8_t* dst) {
+    float values[4];
+    const uint8_t* src = static_cast<const uint8_t*>(stream.data) + index * stream.elementSize;
+    for (int i = 0; i < stream.glComponents; i++) {
+        if (stream.glType == GL_INT) {
+            int32_t value;
+            memcpy(&value, src + i * sizeof(value), sizeof(value));
+            values[i] = static_cast<float>(value);
+        } else {
+            memcpy(&values[i], src + i * sizeof(values[i]), sizeof(values[i]));
         }
-        for (size_t i = 0; i < attribs.tangent.size(); ++i) {
-            tangent[i] = nt.Transform(attribs.tangent[i]).Normalized();
+    }
+    if (packed.format == VERTEX_FORMAT_OCTAHEDRAL_SNORM16) {
+        float encoded[2];
+        OctahedralEncode(values, encoded);
+        values[0] = encoded[0];
+        values[1] = encoded[1];
+    }
+
+    for (int i = 0; i < packed.glComponents; i++) {
+        const float v = values[i];
+        uint8_t* c = dst + i * packed.componentSize;
+        switch (packed.format) {
+            case VERTEX_FORMAT_FLOAT:
+                StoreComponent<float>(c, v);
+                break;
+            case VERTEX_FORMAT_HALF:
+                StoreComponent<uint16_t>(c, FloatToHalf(v));
+                break;
+            case VERTEX_FORMAT_SNORM16:
+            case VERTEX_FORMAT_OCTAHEDRAL_SNORM16:
+                StoreComponent<int16_t>(
+                    c, (int16_t)roundf(OVR::OVRMath_Clamp(v, -1.0f, 1.0f) * 32767.0f));
+                break;
+            case VERTEX_FORMAT_UNORM16:
+                StoreComponent<uint16_t>(
+                    c, (uint16_t)roundf(OVR::OVRMath_Clamp(v, 0.0f, 1.0f) * 65535.0f));
+                break;
+            case VERTEX_FORMAT_SNORM8:
+                StoreComponent<int8_t>(
+                    c, (int8_t)roundf(OVR::OVRMath_Clamp(v, -1.0f, 1.0f) * 127.0f));
+                break;
+            case VERTEX_FORMAT_UNORM8:
+                StoreComponent<uint8_t>(
+                    c, (uint8_t)roundf(OVR::OVRMath_Clamp(v, 0.0f, 1.0f) * 255.0f));
+                break;
+            case VERTEX_FORMAT_INT32:
+                StoreComponent<int32_t>(c, (int32_t)roundf(v));
+                break;
+            case VERTEX_FORMAT_UINT16:
+                StoreComponent<uint16_t>(
+                    c, (uint16_t)roundf(OVR::OVRMath_Clamp(v, 0.0f, 65535.0f)));
+                break;
+            case VERTEX_FORMAT_UINT8:
+                StoreComponent<uint8_t>(c, (uint8_t)roundf(OVR::OVRMath_Clamp(v, 0.0f, 255.0f)));
+                break;
         }
-        for (size_t i = 0; i < attribs.binormal.size(); ++i) {
-            binormal[i] = nt.Transform(attribs.binormal[i]).Normalized();
+    }
+}
+
+int VertexLayout::GetVertexSize(const uint32_t attributeMask) const {
+    // only the component counts are used
+    const VertexAttribs noAttribs;
+    VertexAttributeStream streams[NUM_VERTEX_ATTRIBUTE_STREAMS];
+    GetVertexAttributeStreams(noAttribs, streams);
+    VertexAttributeFormat formats[NUM_VERTEX_ATTRIBUTE_STREAMS];
+    GetVertexAttributeFormats(*this, formats);
+    int size = 0;
+    for (int i = 0; i < NUM_VERTEX_ATTRIBUTE_STREAMS; i++) {
+        if (attributeMask & (1u << i)) {
+            size += GetPackedVertexAttribute(streams[i], formats[i]).elementSize;
         }
     }
+    return size;
+}
+
+// True if the attribute is stored exactly as it is in VertexAttribs.
+static bool IsUnconvertedVertexAttribute(
+    const VertexAttributeStream& stream,
+    const PackedVertexAttribute& packed) {
+    return packed.glType == stream.glType && packed.elementSize == stream.elementSize &&
+        !packed.glNormalized;
+}
+
+void GlGeometry::Create(const VertexAttribs& attribs, const std::vector<TriangleIndex>& indices) {
+    Create(attribs, indices, VertexLayout());
+}
+
+void GlGeometry::Create(
+    const VertexAttribs& attribs,
+    const std::vector<TriangleIndex>& indices,
+    const VertexLayout& vertexLayout) {
+    CreateBuffers(
+        attribs,
+        indices.data(),
+        static_cast<int32_t>(indices.size()),
+        sizeof(TriangleIndex),
+        vertexLayout);
+}
+
+void GlGeometry::Create(
+    const VertexAttribs& attribs,
+    const std::vector<uint32_t>& indices,
+    const VertexLayout& vertexLayout) {
+    if (static_cast<int32_t>(attribs.position.size()) <= MAX_GEOMETRY_VERTICES) {
+        const std::vector<TriangleIndex> shortIndices(indices.begin(), indices.end());
+        Create(attribs, shortIndices, vertexLayout);
+        return;
+    }
+    CreateBuffers(
+        attribs,
+        indices.data(),
+        static_cast<int32_t>(indices.size()),
+        sizeof(uint32_t),
+        vertexLayout);
+}
+
+void GlGeometry::CreateBuffers(
+    const VertexAttribs& attribs,
+    const void* indices,
+    const int32_t numIndices,
+    const int indexSize,
+    const VertexLayout& vertexLayout) {
+    vertexCount = attribs.position.size();
+    indexCount = numIndices;
+    IndexType = GetIndexType(indexSize);
+    layout = vertexLayout;
 
     glGenBuffers(1, &vertexBuffer);
     glGenBuffers(1, &indexBuffer);
     glGenVertexArrays(1, &vertexArrayObject);
     glBindVertexArray(vertexArrayObject);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
 
-    std::vector<uint8_t> packed;
-    PackVertexAttribute(
-        packed, t ? position : attribs.position, VERTEX_ATTRIBUTE_LOCATION_POSITION, GL_FLOAT, 3);
-    PackVertexAttribute(
-        packed, t ? normal : attribs.normal, VERTEX_ATTRIBUTE_LOCATION_NORMAL, GL_FLOAT, 3);
-    PackVertexAttribute(
-        packed, t ? tangent : attribs.tangent, VERTEX_ATTRIBUTE_LOCATION_TANGENT, GL_FLOAT, 3);
-    PackVertexAttribute(
-        packed, t ? binormal : attribs.binormal, VERTEX_ATTRIBUTE_LOCATION_BINORMAL, GL_FLOAT, 3);
-    PackVertexAttribute(packed, attribs.color, VERTEX_ATTRIBUTE_LOCATION_COLOR, GL_FLOAT, 4);
-    PackVertexAttribute(packed, attribs.uv0, VERTEX_ATTRIBUTE_LOCATION_UV0, GL_FLOAT, 2);
-    PackVertexAttribute(packed, attribs.uv1, VERTEX_ATTRIBUTE_LOCATION_UV1, GL_FLOAT, 2);
-    PackVertexAttribute(
-        packed, attribs.jointIndices, VERTEX_ATTRIBUTE_LOCATION_JOINT_INDICES, GL_INT, 4);
-    PackVertexAttribute(
-        packed, attribs.jointWeights, VERTEX_ATTRIBUTE_LOCATION_JOINT_WEIGHTS, GL_FLOAT, 4);
-    // clang-format off
-
-    glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(packed[0]), packed.data(), GL_STATIC_DRAW);
+    PackVertices(attribs, enableGeometryTransfom);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
     glBufferData(
         GL_ELEMENT_ARRAY_BUFFER,
-        indices.size() * sizeof(indices[0]),
-        indices.data(),
+        static_cast<size_t>(numIndices) * indexSize,
+        indices,
         GL_STATIC_DRAW);
 
     glBindVertexArray(0);
@@ -170,26 +479,22 @@ void GlGeometry::Create(const VertexAttribs& attribs, const std::vector<Triangle
 }
 
 void GlGeometry::Update(const VertexAttribs& attribs, const bool updateBounds) {
+    if (IsDynamic()) {
+        UpdateDynamic(attribs);
+        if (updateBounds) {
+            localBounds.Clear();
+            for (int i = 0; i < vertexCount; i++) {
+                localBounds.AddPoint(attribs.position[i]);
+            }
+        }
+        return;
+    }
+
     vertexCount = attribs.position.size();
 
     glBindVertexArray(vertexArrayObject);
 
-    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-
-    std::vector<uint8_t> packed;
-    PackVertexAttribute(packed, attribs.position, VERTEX_ATTRIBUTE_LOCATION_POSITION, GL_FLOAT, 3);
-    PackVertexAttribute(packed, attribs.normal, VERTEX_ATTRIBUTE_LOCATION_NORMAL, GL_FLOAT, 3);
-    PackVertexAttribute(packed, attribs.tangent, VERTEX_ATTRIBUTE_LOCATION_TANGENT, GL_FLOAT, 3);
-    PackVertexAttribute(packed, attribs.binormal, VERTEX_ATTRIBUTE_LOCATION_BINORMAL, GL_FLOAT, 3);
-    PackVertexAttribute(packed, attribs.color, VERTEX_ATTRIBUTE_LOCATION_COLOR, GL_FLOAT, 4);
-    PackVertexAttribute(packed, attribs.uv0, VERTEX_ATTRIBUTE_LOCATION_UV0, GL_FLOAT, 2);
-    PackVertexAttribute(packed, attribs.uv1, VERTEX_ATTRIBUTE_LOCATION_UV1, GL_FLOAT, 2);
-    PackVertexAttribute(
-        packed, attribs.jointIndices, VERTEX_ATTRIBUTE_LOCATION_JOINT_INDICES, GL_INT, 4);
-    PackVertexAttribute(
-        packed, attribs.jointWeights, VERTEX_ATTRIBUTE_LOCATION_JOINT_WEIGHTS, GL_FLOAT, 4);
-
-    glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(packed[0]), packed.data(), GL_STATIC_DRAW);
+    PackVertices(attribs, false);
 
     if (updateBounds) {
         localBounds.Clear();
@@ -199,7 +504,312 @@ void GlGeometry::Update(const VertexAttribs& attribs, const bool updateBounds) {
     }
 }
 
+// Packs the attributes with the geometry's layout, uploads them to the vertex buffer and sets
+// up the attribute pointers of the bound VAO.
+void GlGeometry::PackVertices(const VertexAttribs& attribs, const bool useGeometryTransform) {
+    VertexAttribs transformed;
+    /// we asked for incoming transfom
+    if (useGeometryTransform) {
+        transformed.position.resize(attribs.position.size());
+        transformed.normal.resize(attribs.normal.size());
+        transformed.tangent.resize(attribs.tangent.size());
+        transformed.binormal.resize(attribs.binormal.size());
+
+        /// Positions use 4x4
+        geometryTransfom.TransformPoints(
+            attribs.position.data(),
+            transformed.position.data(),
+            static_cast<int>(attribs.position.size()));
+
+        /// TBN use 3x3
+        const OVR::Matrix3f nt = OVR::Matrix3f(geometryTransfom).Inverse().Transposed();
+        for (size_t i = 0; i < attribs.normal.size(); ++i) {
+            transformed.normal[i] = nt.Transform(attribs.normal[i]).Normalized();
+        }
+        for (size_t i = 0; i < attribs.tangent.size(); ++i) {
+            transformed.tangent[i] = nt.Transform(attribs.tangent[i]).Normalized();
+        }
+        for (size_t i = 0; i < attribs.binormal.size(); ++i) {
+            transformed.binormal[i] = nt.Transform(attribs.binormal[i]).Normalized();
+        }
+    }
+
+    VertexAttributeStream streams[NUM_VERTEX_ATTRIBUTE_STREAMS];
+    GetVertexAttributeStreams(attribs, streams);
+    if (useGeometryTransform) {
+        streams[0].data = transformed.position.data();
+        streams[1].data = transformed.normal.data();
+        streams[2].data = transformed.tangent.data();
+        streams[3].data = transformed.binormal.data();
+    }
+
+    VertexAttributeFormat formats[NUM_VERTEX_ATTRIBUTE_STREAMS];
+    GetVertexAttributeFormats(layout, formats);
+
+    // Interleaved vertices need every attribute for every vertex, a block holds as many
+    // elements as the attribute has.
+    PackedVertexAttribute packed[NUM_VERTEX_ATTRIBUTE_STREAMS];
+    size_t offsets[NUM_VERTEX_ATTRIBUTE_STREAMS];
+    size_t size = 0;
+    int stride = 0;
+    for (int i = 0; i < NUM_VERTEX_ATTRIBUTE_STREAMS; i++) {
+        packed[i] = GetPackedVertexAttribute(streams[i], formats[i]);
+        if (streams[i].count == 0) {
+            offsets[i] = 0;
+        } else if (layout.interleaved) {
+            offsets[i] = stride;
+            stride += packed[i].elementSize;
+        } else {
+            offsets[i] = size;
+            size += static_cast<size_t>(streams[i].count) * packed[i].elementSize;
+        }
+    }
+    if (layout.interleaved) {
+        size = static_cast<size_t>(vertexCount) * stride;
+    }
+
+    std::vector<uint8_t> buffer(size);
+    for (int i = 0; i < NUM_VERTEX_ATTRIBUTE_STREAMS; i++) {
+        const VertexAttributeStream& stream = streams[i];
+        if (stream.count == 0) {
+            continue;
+        }
+        if (!layout.interleaved && IsUnconvertedVertexAttribute(stream, packed[i])) {
+            memcpy(
+                &buffer[offsets[i]],
+                stream.data,
+                static_cast<size_t>(stream.count) * stream.elementSize);
+            continue;
+        }
+        const int count = layout.interleaved ? std::min(stream.count, vertexCount) : stream.count;
+        const int elementStride = layout.interleaved ? stride : packed[i].elementSize;
+        for (int j = 0; j < count; j++) {
+            PackVertexAttributeElement(
+                stream, packed[i], j, &buffer[offsets[i] + j * elementStride]);
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    for (int i = 0; i < NUM_VERTEX_ATTRIBUTE_STREAMS; i++) {
+        const VertexAttributeStream& stream = streams[i];
+        if (stream.count > 0) {
+            glEnableVertexAttribArray(stream.glLocation);
+            glVertexAttribPointer(
+                stream.glLocation,
+                packed[i].glComponents,
+                packed[i].glType,
+                packed[i].glNormalized,
+                layout.interleaved ? stride : packed[i].elementSize,
+                (void*)(offsets[i]));
+        } else {
+            glDisableVertexAttribArray(stream.glLocation);
+        }
+    }
+    glBufferData(GL_ARRAY_BUFFER, buffer.size(), buffer.data(), GL_STATIC_DRAW);
+
+    vertexAttributeMask = GetVertexAttributeMask(streams);
+    vertexBufferSize = static_cast<int32_t>(buffer.size());
+}
+
+void GlGeometry::CreateDynamic(
+    const VertexAttribs& attribs,
+    const std::vector<TriangleIndex>& indices,
+    const int maxVertices) {
+    CreateDynamicBuffers(
+        attribs,
+        indices.data(),
+        static_cast<int32_t>(indices.size()),
+        sizeof(TriangleIndex),
+        maxVertices);
+}
+
+void GlGeometry::CreateDynamic(
+    const VertexAttribs& attribs,
+    const std::vector<uint32_t>& indices,
+    const int maxVertices) {
+    const bool shortIndices = std::all_of(indices.begin(), indices.end(), [](const uint32_t i) {
+        return i < static_cast<uint32_t>(MAX_GEOMETRY_VERTICES);
+    });
+    if (shortIndices) {
+        CreateDynamic(
+            attribs, std::vector<TriangleIndex>(indices.begin(), indices.end()), maxVertices);
+        return;
+    }
+    CreateDynamicBuffers(
+        attribs,
+        indices.data(),
+        static_cast<int32_t>(indices.size()),
+        sizeof(uint32_t),
+        maxVertices);
+}
+
+void GlGeometry::CreateDynamicBuffers(
+    const VertexAttribs& attribs,
+    const void* indices,
+    const int32_t numIndices,
+    const int indexSize,
+    const int maxVertices) {
+    vertexCount = attribs.position.size();
+    indexCount = numIndices;
+    IndexType = GetIndexType(indexSize);
+
+    VertexAttributeStream streams[NUM_VERTEX_ATTRIBUTE_STREAMS];
+    GetVertexAttributeStreams(attribs, streams);
+
+    glGenBuffers(1, &vertexBuffer);
+    glGenBuffers(1, &indexBuffer);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(
+        GL_ELEMENT_ARRAY_BUFFER,
+        static_cast<size_t>(numIndices) * indexSize,
+        indices,
+        GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    AllocateDynamicBuffers(GetVertexAttributeMask(streams), std::max(maxVertices, vertexCount));
+    UpdateDynamic(attribs);
+
+    localBounds.Clear();
+    for (int i = 0; i < vertexCount; i++) {
+        localBounds.AddPoint(attribs.position[i]);
+    }
+}
+
+void GlGeometry::AllocateDynamicBuffers(
+    const uint32_t attributeMask,
+    const int32_t vertexCapacity) {
+    // Orphaning the old storage lets the GPU finish with it, so the fences are no longer needed.
+    for (int i = 0; i < DYNAMIC_BUFFER_COUNT; i++) {
+        if (dynamicFences[i] != nullptr) {
+            glDeleteSync((GLsync)dynamicFences[i]);
+            dynamicFences[i] = nullptr;
+        }
+    }
+
+    vertexAttributeMask = attributeMask;
+    dynamicVertexCapacity = vertexCapacity;
+    // the next update writes the first copy
+    dynamicBufferIndex = DYNAMIC_BUFFER_COUNT - 1;
+
+    // only the element sizes and locations are used
+    const VertexAttribs noAttribs;
+    VertexAttributeStream streams[NUM_VERTEX_ATTRIBUTE_STREAMS];
+    GetVertexAttributeStreams(noAttribs, streams);
+    const size_t bufferSize = GetDynamicBufferSize(streams, attributeMask, vertexCapacity);
+
+    vertexBufferSize = static_cast<int32_t>(bufferSize * DYNAMIC_BUFFER_COUNT);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertexBufferSize, nullptr, GL_DYNAMIC_DRAW);
+
+    for (int i = 0; i < DYNAMIC_BUFFER_COUNT; i++) {
+        if (dynamicVertexArrayObjects[i] == 0) {
+            glGenVertexArrays(1, &dynamicVertexArrayObjects[i]);
+        }
+        glBindVertexArray(dynamicVertexArrayObjects[i]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        size_t offset = bufferSize * i;
+        for (int j = 0; j < NUM_VERTEX_ATTRIBUTE_STREAMS; j++) {
+            const VertexAttributeStream& stream = streams[j];
+            if (attributeMask & (1u << j)) {
+                glEnableVertexAttribArray(stream.glLocation);
+                glVertexAttribPointer(
+                    stream.glLocation,
+                    stream.glComponents,
+                    stream.glType,
+                    false,
+                    stream.elementSize,
+                    (void*)(offset));
+                offset += static_cast<size_t>(vertexCapacity) * stream.elementSize;
+            } else {
+                glDisableVertexAttribArray(stream.glLocation);
+            }
+        }
+    }
+    glBindVertexArray(0);
+    vertexArrayObject = dynamicVertexArrayObjects[0];
+}
+
+void GlGeometry::UpdateDynamic(const VertexAttribs& attribs) {
+    vertexCount = attribs.position.size();
+    // An empty update has no attributes, which would otherwise reallocate the buffers with no
+    // storage and lose the layout that the next non-empty update will need again.
+    if (vertexCount == 0) {
+        return;
+    }
+
+    VertexAttributeStream streams[NUM_VERTEX_ATTRIBUTE_STREAMS];
+    GetVertexAttributeStreams(attribs, streams);
+    const uint32_t attributeMask = GetVertexAttributeMask(streams);
+    if (attributeMask != vertexAttributeMask || vertexCount > dynamicVertexCapacity) {
+        AllocateDynamicBuffers(
+            attributeMask,
+            (vertexCount > dynamicVertexCapacity) ? std::max(vertexCount, dynamicVertexCapacity * 2)
+                                                  : dynamicVertexCapacity);
+    } else {
+        // Everything that was submitted since the last update drew the current copy.
+        if (dynamicFences[dynamicBufferIndex] != nullptr) {
+            glDeleteSync((GLsync)dynamicFences[dynamicBufferIndex]);
+        }
+        dynamicFences[dynamicBufferIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    const int bufferIndex = (dynamicBufferIndex + 1) % DYNAMIC_BUFFER_COUNT;
+    if (dynamicFences[bufferIndex] != nullptr) {
+        // Only waits if the GPU is more than DYNAMIC_BUFFER_COUNT - 1 updates behind.
+        GLsync fence = (GLsync)dynamicFences[bufferIndex];
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000 * 1000 * 1000);
+        glDeleteSync(fence);
+        dynamicFences[bufferIndex] = nullptr;
+    }
+
+    const size_t bufferSize = GetDynamicBufferSize(streams, attributeMask, dynamicVertexCapacity);
+    if (bufferSize > 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        uint8_t* mapped = (uint8_t*)glMapBufferRange(
+            GL_ARRAY_BUFFER,
+            bufferSize * bufferIndex,
+            bufferSize,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (mapped == nullptr) {
+            ALOGW("GlGeometry::Update: failed to map the dynamic vertex buffer");
+            return;
+        }
+        size_t offset = 0;
+        for (int i = 0; i < NUM_VERTEX_ATTRIBUTE_STREAMS; i++) {
+            const VertexAttributeStream& stream = streams[i];
+            if (stream.count > 0) {
+                const size_t count = std::min(stream.count, dynamicVertexCapacity);
+                memcpy(mapped + offset, stream.data, count * stream.elementSize);
+                offset += static_cast<size_t>(dynamicVertexCapacity) * stream.elementSize;
+            }
+        }
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+
+    dynamicBufferIndex = bufferIndex;
+    vertexArrayObject = dynamicVertexArrayObjects[bufferIndex];
+}
+
 void GlGeometry::Free() {
+    if (IsDynamic()) {
+        for (int i = 0; i < DYNAMIC_BUFFER_COUNT; i++) {
+            if (dynamicFences[i] != nullptr) {
+                glDeleteSync((GLsync)dynamicFences[i]);
+                dynamicFences[i] = nullptr;
+            }
+        }
+        // vertexArrayObject is one of these
+        glDeleteVertexArrays(DYNAMIC_BUFFER_COUNT, dynamicVertexArrayObjects);
+        for (int i = 0; i < DYNAMIC_BUFFER_COUNT; i++) {
+            dynamicVertexArrayObjects[i] = 0;
+        }
+        vertexArrayObject = 0;
+        dynamicBufferIndex = -1;
+        dynamicVertexCapacity = 0;
+    }
+
     glDeleteVertexArrays(1, &vertexArrayObject);
     glDeleteBuffers(1, &indexBuffer);
     glDeleteBuffers(1, &vertexBuffer);
@@ -209,10 +819,146 @@ void GlGeometry::Free() {
     vertexArrayObject = 0;
     vertexCount = 0;
     indexCount = 0;
+    vertexAttributeMask = 0;
+    vertexBufferSize = 0;
 
     localBounds.Clear();
 }
 
+template <typename _attrib_type_>
+static void AppendMeshletAttribute(
+    std::vector<_attrib_type_>& meshletAttrib,
+    const std::vector<_attrib_type_>& attrib,
+    const uint32_t index) {
+    if (index < attrib.size()) {
+        meshletAttrib.push_back(attrib[index]);
+    }
+}
+
+std::vector<GlGeometry::Descriptor> BuildMeshletDescriptors(
+    const VertexAttribs& attribs,
+    const std::vector<uint32_t>& indices,
+    const int maxVertices,
+    const int maxTriangles) {
+    std::vector<GlGeometry::Descriptor> meshlets;
+
+    const int vertexCount = static_cast<int>(attribs.position.size());
+    const int triangleCount = static_cast<int>(indices.size()) / 3;
+    const int clusterVertices =
+        OVR::OVRMath_Clamp(maxVertices, 3, GlGeometry::MAX_GEOMETRY_VERTICES);
+    const int clusterTriangles = std::max(maxTriangles, 1);
+
+    // the triangles using each vertex
+    std::vector<int> vertexTriangleStart(vertexCount + 1, 0);
+    for (int i = 0; i < triangleCount * 3; i++) {
+        if (indices[i] >= static_cast<uint32_t>(vertexCount)) {
+            ALOGW("BuildMeshletDescriptors: index %u out of range", indices[i]);
+            return meshlets;
+        }
+        vertexTriangleStart[indices[i] + 1]++;
+    }
+    for (int i = 0; i < vertexCount; i++) {
+        vertexTriangleStart[i + 1] += vertexTriangleStart[i];
+    }
+    std::vector<int> vertexTriangles(triangleCount * 3);
+    {
+        std::vector<int> next(vertexTriangleStart.begin(), vertexTriangleStart.end() - 1);
+        for (int i = 0; i < triangleCount * 3; i++) {
+            vertexTriangles[next[indices[i]]++] = i / 3;
+        }
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<int> localIndices(vertexCount, -1);
+    std::vector<uint32_t> clusterVertexIndices;
+    std::vector<int> candidates;
+    int nextSeed = 0;
+
+    for (;;) {
+        while (nextSeed < triangleCount && emitted[nextSeed]) {
+            nextSeed++;
+        }
+        if (nextSeed == triangleCount) {
+            break;
+        }
+
+        GlGeometry::Descriptor meshlet;
+        clusterVertexIndices.clear();
+        candidates.clear();
+        candidates.push_back(nextSeed);
+        size_t nextCandidate = 0;
+        int numTriangles = 0;
+
+        // Grow the cluster breadth first across the vertices it already has, so it stays
+        // compact and consecutive triangles reuse recent vertices.
+        for (;;) {
+            if (nextCandidate == candidates.size()) {
+                // the connected part of the mesh is done, continue in the input order
+                while (nextSeed < triangleCount && emitted[nextSeed]) {
+                    nextSeed++;
+                }
+                if (nextSeed == triangleCount) {
+                    break;
+                }
+                candidates.push_back(nextSeed);
+            }
+            const int triangle = candidates[nextCandidate++];
+            if (emitted[triangle]) {
+                continue;
+            }
+
+            const uint32_t* tri = &indices[triangle * 3];
+            int newVertices = 0;
+            for (int j = 0; j < 3; j++) {
+                if (localIndices[tri[j]] < 0 && (j < 1 || tri[j] != tri[0]) &&
+                    (j < 2 || tri[j] != tri[1])) {
+                    newVertices++;
+                }
+            }
+            if (static_cast<int>(clusterVertexIndices.size()) + newVertices > clusterVertices) {
+                break;
+            }
+
+            emitted[triangle] = true;
+            for (int j = 0; j < 3; j++) {
+                const uint32_t v = tri[j];
+                if (localIndices[v] < 0) {
+                    localIndices[v] = static_cast<int>(clusterVertexIndices.size());
+                    clusterVertexIndices.push_back(v);
+
+                    VertexAttribs& a = meshlet.attribs;
+                    AppendMeshletAttribute(a.position, attribs.position, v);
+                    AppendMeshletAttribute(a.normal, attribs.normal, v);
+                    AppendMeshletAttribute(a.tangent, attribs.tangent, v);
+                    AppendMeshletAttribute(a.binormal, attribs.binormal, v);
+                    AppendMeshletAttribute(a.color, attribs.color, v);
+                    AppendMeshletAttribute(a.uv0, attribs.uv0, v);
+                    AppendMeshletAttribute(a.uv1, attribs.uv1, v);
+                    AppendMeshletAttribute(a.jointIndices, attribs.jointIndices, v);
+                    AppendMeshletAttribute(a.jointWeights, attribs.jointWeights, v);
+
+                    for (int k = vertexTriangleStart[v]; k < vertexTriangleStart[v + 1]; k++) {
+                        if (!emitted[vertexTriangles[k]]) {
+                            candidates.push_back(vertexTriangles[k]);
+                        }
+                    }
+                }
+                meshlet.indices.push_back(static_cast<TriangleIndex>(localIndices[v]));
+            }
+            if (++numTriangles == clusterTriangles) {
+                break;
+            }
+        }
+
+        for (const uint32_t v : clusterVertexIndices) {
+            localIndices[v] = -1;
+        }
+        meshlets.push_back(std::move(meshlet));
+    }
+
+    return meshlets;
+}
+
 GlGeometry::Descriptor BuildTesselatedQuadDescriptor(
     const TriangleIndex horizontal,
     const TriangleIndex vertical,
@@ -46,6 +46,74 @@ struct VertexAttribs {
 
 typedef uint16_t TriangleIndex;
 
+enum VertexAttributeFormat {
+    VERTEX_FORMAT_FLOAT, // 32 bit float per component
+    VERTEX_FORMAT_HALF, // 16 bit float per component
+    VERTEX_FORMAT_SNORM16, // [-1, 1] as 16 bit signed integers
+    VERTEX_FORMAT_UNORM16, // [0, 1] as 16 bit unsigned integers
+    VERTEX_FORMAT_SNORM8, // [-1, 1] as 8 bit signed integers
+    VERTEX_FORMAT_UNORM8, // [0, 1] as 8 bit unsigned integers
+    VERTEX_FORMAT_INT32, // integer values
+    VERTEX_FORMAT_UINT16, // integer values up to 65535
+    VERTEX_FORMAT_UINT8, // integer values up to 255, enough for joint indices
+    // Unit vectors folded onto an octahedron and stored as 2 16 bit signed integers.  The
+    // vertex shader has to decode the vec2 attribute with OctahedralDecodeShaderSrc.
+    VERTEX_FORMAT_OCTAHEDRAL_SNORM16
+};
+
+// How GlGeometry::Create() stores the attributes in the vertex buffer.  The default layout
+// stores 32 bit floats (and 32 bit integer joint indices) with each attribute in its own block
+// of the buffer.  Other than the octahedral format, the shaders see the same values with any
+// layout, up to the precision of the format.  The components of 8 and 16 bit formats are
+// padded to a multiple of 4 bytes.
+struct VertexLayout {
+    VertexLayout()
+        : position(VERTEX_FORMAT_FLOAT),
+          normal(VERTEX_FORMAT_FLOAT),
+          tangent(VERTEX_FORMAT_FLOAT),
+          binormal(VERTEX_FORMAT_FLOAT),
+          color(VERTEX_FORMAT_FLOAT),
+          uv0(VERTEX_FORMAT_FLOAT),
+          uv1(VERTEX_FORMAT_FLOAT),
+          jointIndices(VERTEX_FORMAT_INT32),
+          jointWeights(VERTEX_FORMAT_FLOAT),
+          interleaved(false) {}
+
+    // Interleaved, with snorm16 normals, tangents and binormals, unorm8 colors, half float
+    // texture coordinates, uint8 joint indices and unorm16 joint weights.  Works with the
+    // existing shaders.
+    static VertexLayout Compact();
+
+    // Bytes per vertex with the attributes in the mask, one bit per attribute in VertexAttribs
+    // order like GlGeometry::vertexAttributeMask.
+    int GetVertexSize(const uint32_t attributeMask) const;
+
+    bool operator==(const VertexLayout& other) const;
+    bool operator!=(const VertexLayout& other) const {
+        return !(*this == other);
+    }
+
+    VertexAttributeFormat position;
+    VertexAttributeFormat normal;
+    VertexAttributeFormat tangent;
+    VertexAttributeFormat binormal;
+    VertexAttributeFormat color;
+    VertexAttributeFormat uv0;
+    VertexAttributeFormat uv1;
+    VertexAttributeFormat jointIndices;
+    VertexAttributeFormat jointWeights;
+    bool interleaved; // all attributes of a vertex next to each other, instead of one per block
+};
+
+// GLSL for the vertex shader: highp vec3 OctahedralDecode( highp vec2 e )
+extern const char* OctahedralDecodeShaderSrc;
+
+// The conversions used to pack VERTEX_FORMAT_HALF and VERTEX_FORMAT_OCTAHEDRAL_SNORM16.
+// FloatToHalf rounds to nearest even.  OctahedralEncode folds the vector v onto the
+// octahedron as e[0], e[1] in [-1, 1], before quantization; a zero vector encodes to 0, 0.
+uint16_t FloatToHalf(const float f);
+void OctahedralEncode(const float* v, float* e);
+
 class GlGeometry {
    public:
     static constexpr uint32_t kPrimitiveTypePoints = 0x0000; /* GL_POINTS */
@@ -61,7 +129,14 @@ class GlGeometry {
           primitiveType(kPrimitiveTypeTriangles),
           vertexCount(0),
           indexCount(0),
-          localBounds(OVR::Bounds3f::Init) {}
+          localBounds(OVR::Bounds3f::Init),
+          IndexType(GetIndexType(sizeof(TriangleIndex))),
+          vertexAttributeMask(0),
+          vertexBufferSize(0),
+          dynamicVertexArrayObjects{},
+          dynamicFences{},
+          dynamicBufferIndex(-1),
+          dynamicVertexCapacity(0) {}
 
     GlGeometry(const VertexAttribs& attribs, const std::vector<TriangleIndex>& indices)
         : vertexBuffer(0),
@@ -70,14 +145,52 @@ class GlGeometry {
           primitiveType(kPrimitiveTypeTriangles),
           vertexCount(0),
           indexCount(0),
-          localBounds(OVR::Bounds3f::Init) {
+          localBounds(OVR::Bounds3f::Init),
+          IndexType(GetIndexType(sizeof(TriangleIndex))),
+          vertexAttributeMask(0),
+          vertexBufferSize(0),
+          dynamicVertexArrayObjects{},
+          dynamicFences{},
+          dynamicBufferIndex(-1),
+          dynamicVertexCapacity(0) {
         Create(attribs, indices);
     }
 
     // Create the VAO and vertex and index buffers from arrays of data.
     void Create(const VertexAttribs& attribs, const std::vector<TriangleIndex>& indices);
+    void Create(
+        const VertexAttribs& attribs,
+        const std::vector<TriangleIndex>& indices,
+        const VertexLayout& vertexLayout);
+    // Uses 16 bit indices when all vertices can be addressed with them, 32 bit indices
+    // otherwise, so meshes are not limited to MAX_GEOMETRY_VERTICES vertices.
+    void Create(
+        const VertexAttribs& attribs,
+        const std::vector<uint32_t>& indices,
+        const VertexLayout& vertexLayout = VertexLayout());
+    // Repacks the vertices with the layout the geometry was created with.
     void Update(const VertexAttribs& attribs, const bool updateBounds = true);
 
+    // For geometry that is rewritten every frame, like particles and debug lines.
+    // The vertex buffer holds DYNAMIC_BUFFER_COUNT copies of the vertices, each with its own
+    // VAO, so Update() never changes the attribute layout.  Update() writes the next copy
+    // through an unsynchronized mapping, after waiting on a fence in the unlikely case the GPU
+    // is still reading it.  Room is reserved for maxVertices vertices, or the initial vertex
+    // count if that is larger.  Updates with more vertices or a different set of attributes
+    // reallocate the buffer.
+    void CreateDynamic(
+        const VertexAttribs& attribs,
+        const std::vector<TriangleIndex>& indices,
+        const int maxVertices = 0);
+    // 32 bit indices are only used if some index does not fit in 16 bits.
+    void CreateDynamic(
+        const VertexAttribs& attribs,
+        const std::vector<uint32_t>& indices,
+        const int maxVertices = 0);
+    bool IsDynamic() const {
+        return dynamicBufferIndex >= 0;
+    }
+
     // Free the buffers and VAO, assuming that they are strictly for this geometry.
     // We could save some overhead by packing an entire model into a single buffer, but
     // it would add more coupling to the structures.
@@ -85,6 +198,7 @@ class GlGeometry {
     void Free();
 
    public:
+    // With 16 bit indices.
     static constexpr int32_t MAX_GEOMETRY_VERTICES = 1 << (sizeof(TriangleIndex) * 8);
     static constexpr int32_t MAX_GEOMETRY_INDICES = 1024 * 1024 * 3;
 
@@ -95,7 +209,11 @@ class GlGeometry {
         return MAX_GEOMETRY_INDICES;
     }
 
-    static unsigned IndexType; // GL_UNSIGNED_SHORT, GL_UNSIGNED_INT, etc.
+    // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT for 2 or 4 byte indices.
+    static unsigned GetIndexType(const int indexSize);
+    int GetIndexSize() const;
+
+    static constexpr int DYNAMIC_BUFFER_COUNT = 3;
 
     class TransformScope {
        public:
@@ -128,8 +246,46 @@ class GlGeometry {
     int32_t vertexCount;
     int32_t indexCount;
     OVR::Bounds3f localBounds;
+    unsigned IndexType; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+
+    VertexLayout layout; // dynamic geometry always uses the default layout
+    uint32_t vertexAttributeMask; // bit per attribute in VertexAttribs order
+    int32_t vertexBufferSize; // bytes, for all copies of dynamic geometry
+
+    // Only used by dynamic geometry, vertexArrayObject is the VAO of the last update.
+    uint32_t dynamicVertexArrayObjects[DYNAMIC_BUFFER_COUNT];
+    void* dynamicFences[DYNAMIC_BUFFER_COUNT]; // GLsync set after the copy was last drawn
+    int32_t dynamicBufferIndex; // -1 for static geometry
+    int32_t dynamicVertexCapacity;
+
+   private:
+    void CreateBuffers(
+        const VertexAttribs& attribs,
+        const void* indices,
+        const int32_t numIndices,
+        const int indexSize,
+        const VertexLayout& vertexLayout);
+    void CreateDynamicBuffers(
+        const VertexAttribs& attribs,
+        const void* indices,
+        const int32_t numIndices,
+        const int indexSize,
+        const int maxVertices);
+    void PackVertices(const VertexAttribs& attribs, const bool useGeometryTransform);
+    void AllocateDynamicBuffers(const uint32_t attributeMask, const int32_t vertexCapacity);
+    void UpdateDynamic(const VertexAttribs& attribs);
 };
 
+// Splits a triangle list into clusters of at most maxVertices vertices and maxTriangles
+// triangles, each with its own vertices and 16 bit indices.  Clusters grow across shared
+// vertices so they are spatially compact, which keeps their bounds tight for culling, and
+// each cluster's triangles are ordered for vertex cache reuse.
+std::vector<GlGeometry::Descriptor> BuildMeshletDescriptors(
+    const VertexAttribs& attribs,
+    const std::vector<uint32_t>& indices,
+    const int maxVertices = 4096,
+    const int maxTriangles = 8192);
+
 // Build it in a -1 to 1 range, which will be scaled to the appropriate
 // aspect ratio for each usage.
 //
@@ -67,7 +67,15 @@ static const char* VertexHeader =
   #define VIEW_ID ViewID
 #endif
 
+#if defined( INSTANCED_MODEL_MATRICES ) && INSTANCED_MODEL_MATRICES
+uniform InstanceMatrices
+{
+	highp mat4 InstanceModelMatrix[)glsl" MAX_INSTANCE_MATRICES_STRING R"glsl(];
+} im;
+#define ModelMatrix im.InstanceModelMatrix[gl_InstanceID]
+#else
 uniform highp mat4 ModelMatrix;
+#endif
 
 // Use a ubo in v300 path to workaround corruption issue on Adreno 420+v300
 // when uniform array of matrices used.
@@ -266,6 +274,13 @@ GlProgram GlProgram::Build(
     glBindAttribLocation(p.Program, VERTEX_ATTRIBUTE_LOCATION_JOINT_INDICES, "JointIndices");
     glBindAttribLocation(p.Program, VERTEX_ATTRIBUTE_LOCATION_JOINT_WEIGHTS, "JointWeights");
     glBindAttribLocation(p.Program, VERTEX_ATTRIBUTE_LOCATION_FONT_PARMS, "FontParms");
+    glBindAttribLocation(
+        p.Program, VERTEX_ATTRIBUTE_LOCATION_INSTANCE_POSITION, "InstancePosition");
+    glBindAttribLocation(p.Program, VERTEX_ATTRIBUTE_LOCATION_INSTANCE_RIGHT, "InstanceRight");
+    glBindAttribLocation(p.Program, VERTEX_ATTRIBUTE_LOCATION_INSTANCE_UP, "InstanceUp");
+    glBindAttribLocation(
+        p.Program, VERTEX_ATTRIBUTE_LOCATION_INSTANCE_ROTATION, "InstanceRotation");
+    glBindAttribLocation(p.Program, VERTEX_ATTRIBUTE_LOCATION_INSTANCE_UV_RECT, "InstanceUvRect");
 
     //--------------------------
     // Link Program
@@ -307,6 +322,14 @@ GlProgram GlProgram::Build(
             glUniformBlockBinding(p.Program, p.SceneMatrices.Location, p.SceneMatrices.Binding);
         }
 
+        p.InstanceMatrices.Type = ovrProgramParmType::BUFFER_UNIFORM;
+        p.InstanceMatrices.Location = glGetUniformBlockIndex(p.Program, "InstanceMatrices");
+        if (p.InstanceMatrices.Location >= 0) {
+            p.InstanceMatrices.Binding = p.numUniformBufferBindings++;
+            glUniformBlockBinding(
+                p.Program, p.InstanceMatrices.Location, p.InstanceMatrices.Binding);
+        }
+
         p.ModelMatrix.Type = ovrProgramParmType::FLOAT_MATRIX4;
         p.ModelMatrix.Location = glGetUniformLocation(p.Program, "ModelMatrix");
         p.ModelMatrix.Binding = p.ModelMatrix.Location;
@@ -56,6 +56,10 @@ class GlBuffer;
 #define MAX_JOINTS 64
 #define MAX_JOINTS_STRING STRINGIZE_VALUE(MAX_JOINTS)
 
+// 256 matrices fill the 16KB minimum GL_MAX_UNIFORM_BLOCK_SIZE.
+#define MAX_INSTANCE_MATRICES 256
+#define MAX_INSTANCE_MATRICES_STRING STRINGIZE_VALUE(MAX_INSTANCE_MATRICES)
+
 // No attempt is made to support sharing shaders between programs,
 // it isn't worth avoiding the duplication.
 
@@ -71,7 +75,13 @@ enum VertexAttributeLocation {
     VERTEX_ATTRIBUTE_LOCATION_UV1 = 6,
     VERTEX_ATTRIBUTE_LOCATION_JOINT_INDICES = 7,
     VERTEX_ATTRIBUTE_LOCATION_JOINT_WEIGHTS = 8,
-    VERTEX_ATTRIBUTE_LOCATION_FONT_PARMS = 9
+    VERTEX_ATTRIBUTE_LOCATION_FONT_PARMS = 9,
+    // per instance attributes of billboards expanded in the vertex shader
+    VERTEX_ATTRIBUTE_LOCATION_INSTANCE_POSITION = 10,
+    VERTEX_ATTRIBUTE_LOCATION_INSTANCE_RIGHT = 11,
+    VERTEX_ATTRIBUTE_LOCATION_INSTANCE_UP = 12,
+    VERTEX_ATTRIBUTE_LOCATION_INSTANCE_ROTATION = 13,
+    VERTEX_ATTRIBUTE_LOCATION_INSTANCE_UV_RECT = 14
 };
 
 enum class ovrProgramParmType : char {
@@ -155,6 +165,12 @@ struct GlProgram {
         return Program != 0;
     }
 
+    // True if the program reads its model matrices from the InstanceMatrices ubo,
+    // which lets ovrSurfaceRender merge consecutive draws of the same surface.
+    bool UsesInstanceMatrices() const {
+        return InstanceMatrices.Location >= 0;
+    }
+
     static const int MAX_VIEWS = 2;
     static const int SCENE_MATRICES_UBO_SIZE = 2 * sizeof(OVR::Matrix4f) * MAX_VIEWS;
 
@@ -170,6 +186,12 @@ struct GlProgram {
                               //   mat4 ViewMatrix[NUM_VIEWS];
                               //   mat4 ProjectionMatrix[NUM_VIEWS];
                               // } sm;
+    ovrUniform InstanceMatrices; // uniform for "InstanceMatrices" ubo, only present when the
+                                 // vertex shader is built with INSTANCED_MODEL_MATRICES defined:
+                                 // uniform InstanceMatrices {
+                                 //   mat4 InstanceModelMatrix[MAX_INSTANCE_MATRICES];
+                                 // } im;
+                                 // ModelMatrix then reads im.InstanceModelMatrix[gl_InstanceID].
 
     ovrUniform Uniforms[ovrUniform::MAX_UNIFORMS];
     int numTextureBindings;
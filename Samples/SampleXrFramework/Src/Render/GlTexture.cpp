@@ -33,14 +33,7 @@ Authors     :   John Carmack
 #include "CompilerUtils.h"
 #include "PackageFiles.h"
 #include "stb_image.h"
-
-// #define OVR_USE_PERF_TIMER
-#if defined(OVR_USE_PERF_TIMER)
 #include "OVR_PerfTimer.h"
-#else
-#define OVR_PERF_TIMER(x) \
-    { ; }
-#endif
 
 #include <algorithm>
 #include <fstream>
@@ -1539,6 +1532,43 @@ static int MipLevelsForSize(int width, int height) {
     return levels;
 }
 
+GlTexture LoadTextureFromRGBABuffer(
+    const char* fileName,
+    unsigned char* image,
+    const int width,
+    const int height,
+    const TextureFlags_t& flags) {
+    // Optionally outline the border alpha.
+    if (flags & TEXTUREFLAG_ALPHA_BORDER) {
+        for (int i = 0; i < width; i++) {
+            image[i * 4 + 3] = 0;
+            image[((height - 1) * width + i) * 4 + 3] = 0;
+        }
+        for (int i = 0; i < height; i++) {
+            image[i * width * 4 + 3] = 0;
+            image[(i * width + width - 1) * 4 + 3] = 0;
+        }
+    }
+
+    const size_t dataSize = GetOvrTextureSize(Texture_RGBA, width, height);
+    GlTexture texId = CreateGlTexture(
+        fileName,
+        Texture_RGBA,
+        width,
+        height,
+        image,
+        dataSize,
+        (flags & TEXTUREFLAG_NO_MIPMAPS) ? 1 : MipLevelsForSize(width, height),
+        flags & TEXTUREFLAG_USE_SRGB,
+        false);
+    if (!(flags & TEXTUREFLAG_NO_MIPMAPS)) {
+        glBindTexture(texId.target, texId.texture);
+        glGenerateMipmap(texId.target);
+        glTexParameteri(texId.target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    }
+    return texId;
+}
+
 GlTexture LoadTextureFromBuffer(
     const char* fileName,
     const uint8_t* buffer,
@@ -1572,35 +1602,8 @@ GlTexture LoadTextureFromBuffer(
         int comp;
         stbi_uc* image = stbi_load_from_memory(buffer, bufferSize, &width, &height, &comp, 4);
         if (image != NULL) {
-            // Optionally outline the border alpha.
-            if (flags & TEXTUREFLAG_ALPHA_BORDER) {
-                for (int i = 0; i < width; i++) {
-                    image[i * 4 + 3] = 0;
-                    image[((height - 1) * width + i) * 4 + 3] = 0;
-                }
-                for (int i = 0; i < height; i++) {
-                    image[i * width * 4 + 3] = 0;
-                    image[(i * width + width - 1) * 4 + 3] = 0;
-                }
-            }
-
-            const size_t dataSize = GetOvrTextureSize(Texture_RGBA, width, height);
-            texId = CreateGlTexture(
-                fileName,
-                Texture_RGBA,
-                width,
-                height,
-                image,
-                dataSize,
-                (flags & TEXTUREFLAG_NO_MIPMAPS) ? 1 : MipLevelsForSize(width, height),
-                flags & TEXTUREFLAG_USE_SRGB,
-                false);
+            texId = LoadTextureFromRGBABuffer(fileName, image, width, height, flags);
             free(image);
-            if (!(flags & TEXTUREFLAG_NO_MIPMAPS)) {
-                glBindTexture(texId.target, texId.texture);
-                glGenerateMipmap(texId.target);
-                glTexParameteri(texId.target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            }
         } else {
             ALOG("stbi_load_from_memory() failed!");
         }
@@ -200,6 +200,16 @@ unsigned char* LoadImageToRGBABuffer(
 // Free image data allocated by LoadImageToRGBABuffer
 void FreeRGBABuffer(const unsigned char* buffer);
 
+// Creates a texture from an image decoded by LoadImageToRGBABuffer, with the same
+// mipmaps and filtering LoadTextureFromBuffer sets up for uncompressed formats.
+// The image is not freed, but it is modified for TEXTUREFLAG_ALPHA_BORDER.
+GlTexture LoadTextureFromRGBABuffer(
+    const char* fileName,
+    unsigned char* image,
+    const int width,
+    const int height,
+    const TextureFlags_t& flags);
+
 // FileName's extension determines the file type, but the data is taken from an
 // already loaded buffer.
 //
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   GlTimerQuery.cpp
+Content     :   GPU time of a span of GL commands, read back without stalling.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "GlTimerQuery.h"
+
+#include "Misc/Log.h"
+
+namespace OVRFW {
+
+bool ovrGlTimerQuery::Init() {
+    Shutdown();
+    if (!glExtensions.EXT_disjoint_timer_query) {
+        ALOG("ovrGlTimerQuery::Init - no timer queries, GPU times will not be available");
+        return false;
+    }
+    glGenQueries(NUM_QUERIES, Queries);
+#if !defined(WIN32)
+    // reading the flag clears it
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+#endif // !defined(WIN32)
+    Available = true;
+    return true;
+}
+
+void ovrGlTimerQuery::Shutdown() {
+    if (!Available) {
+        return;
+    }
+    if (Active) {
+        glEndQuery(GL_TIME_ELAPSED_EXT);
+    }
+    glDeleteQueries(NUM_QUERIES, Queries);
+    Available = false;
+    Head = 0;
+    Tail = 0;
+    Active = false;
+}
+
+void ovrGlTimerQuery::Begin() {
+    if (!Available || Active || Head - Tail >= NUM_QUERIES) {
+        return;
+    }
+    glBeginQuery(GL_TIME_ELAPSED_EXT, Queries[Head % NUM_QUERIES]);
+    Active = true;
+}
+
+void ovrGlTimerQuery::End() {
+    if (!Active) {
+        return;
+    }
+    glEndQuery(GL_TIME_ELAPSED_EXT);
+    Active = false;
+    Head++;
+}
+
+double ovrGlTimerQuery::GetLatestSeconds() {
+    if (!Available) {
+        return -1.0;
+    }
+
+    double latest = -1.0;
+    while (Tail != Head) {
+        const GLuint query = Queries[Tail % NUM_QUERIES];
+        GLuint ready = GL_FALSE;
+        glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &ready);
+        if (ready == GL_FALSE) {
+            break;
+        }
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64vEXT_(query, GL_QUERY_RESULT, &nanoseconds);
+        latest = nanoseconds * 1e-9;
+        Tail++;
+    }
+
+#if !defined(WIN32)
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    if (disjoint) {
+        latest = -1.0;
+    }
+#endif // !defined(WIN32)
+
+    return latest;
+}
+
+} // namespace OVRFW
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   GlTimerQuery.h
+Content     :   GPU time of a span of GL commands, read back without stalling.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include "Egl.h"
+
+namespace OVRFW {
+
+// Times the GL commands between Begin() and End() with EXT_disjoint_timer_query. The results
+// arrive a few frames late, so a ring of queries is kept in flight and GetLatestSeconds()
+// only collects results that are ready. Must be used on the GL thread, and spans must not
+// nest or overlap with other elapsed time queries.
+class ovrGlTimerQuery {
+   public:
+    ovrGlTimerQuery() : Available(false), Head(0), Tail(0), Active(false) {}
+    ~ovrGlTimerQuery() {
+        Shutdown();
+    }
+
+    ovrGlTimerQuery(const ovrGlTimerQuery&) = delete;
+    ovrGlTimerQuery& operator=(const ovrGlTimerQuery&) = delete;
+
+    // Returns false if the context has no timer queries, the other calls then do nothing.
+    bool Init();
+    void Shutdown();
+
+    bool IsAvailable() const {
+        return Available;
+    }
+
+    // A span is skipped if all queries are still waiting for their result.
+    void Begin();
+    void End();
+
+    // Seconds of the most recent span whose result arrived since the last call, negative if
+    // none did. Results the GPU marked as disjoint, for instance after a frequency change, are
+    // dropped.
+    double GetLatestSeconds();
+
+   private:
+    static const int NUM_QUERIES = 4;
+
+    bool Available;
+    GLuint Queries[NUM_QUERIES];
+    int Head; // next query to begin
+    int Tail; // oldest query that has not been read back
+    bool Active;
+};
+
+} // namespace OVRFW
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   GlUploadQueue.cpp
+Content     :   Queue of GL object creation work, drained on the GL thread.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "GlUploadQueue.h"
+
+namespace OVRFW {
+
+void ovrGlUploadQueue::Push(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(TasksMutex);
+    Tasks.push_back(std::move(task));
+}
+
+void ovrGlUploadQueue::Append(ovrGlUploadQueue& other) {
+    if (&other == this) {
+        return;
+    }
+    std::deque<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(other.TasksMutex);
+        tasks.swap(other.Tasks);
+    }
+    std::lock_guard<std::mutex> lock(TasksMutex);
+    for (std::function<void()>& task : tasks) {
+        Tasks.push_back(std::move(task));
+    }
+}
+
+int ovrGlUploadQueue::Drain(const int maxTasks) {
+    int numTasks = 0;
+    while (numTasks < maxTasks) {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(TasksMutex);
+            if (Tasks.empty()) {
+                break;
+            }
+            task = std::move(Tasks.front());
+            Tasks.pop_front();
+        }
+        // run without the lock so tasks can push follow up work
+        task();
+        numTasks++;
+    }
+    return numTasks;
+}
+
+void ovrGlUploadQueue::DrainAll() {
+    while (Drain(64) > 0) {
+    }
+}
+
+void ovrGlUploadQueue::Clear() {
+    std::lock_guard<std::mutex> lock(TasksMutex);
+    Tasks.clear();
+}
+
+int ovrGlUploadQueue::GetPendingCount() const {
+    std::lock_guard<std::mutex> lock(TasksMutex);
+    return static_cast<int>(Tasks.size());
+}
+
+} // namespace OVRFW
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   GlUploadQueue.h
+Content     :   Queue of GL object creation work, drained on the GL thread.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace OVRFW {
+
+// Tasks can be pushed from any thread, but only run from the thread that owns
+// the GL context, in the order they were pushed.  Draining a few tasks each
+// frame spreads texture and buffer uploads over several frames.
+class ovrGlUploadQueue {
+   public:
+    ovrGlUploadQueue() {}
+
+    ovrGlUploadQueue(const ovrGlUploadQueue&) = delete;
+    ovrGlUploadQueue& operator=(const ovrGlUploadQueue&) = delete;
+
+    void Push(std::function<void()> task);
+
+    // Moves all tasks of the other queue to the end of this one.
+    void Append(ovrGlUploadQueue& other);
+
+    // Runs at most maxTasks tasks and returns the number of tasks that were run.
+    int Drain(const int maxTasks);
+    void DrainAll();
+
+    // Drops all pending tasks without running them.
+    void Clear();
+
+    int GetPendingCount() const;
+    bool IsEmpty() const {
+        return GetPendingCount() == 0;
+    }
+
+   private:
+    std::deque<std::function<void()>> Tasks;
+    mutable std::mutex TasksMutex;
+};
+
+} // namespace OVRFW
@@ -28,11 +28,24 @@ Authors     :   Jonathan E. Wright
 #include "ParticleSystem.h"
 
 #include "TextureAtlas.h"
+#include "Misc/JobPool.h"
 #include "Render/GeometryBuilder.h"
 #include "Render/GlGeometry.h"
+#include "Render/Egl.h"
+#include "OVR_PerfTimer.h"
 
+#include <math.h>
+#include <algorithm>
 #include <cassert>
 
+#if defined(OVR_CPU_X86_64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define OVR_PARTICLE_SSE2 1
+#elif defined(__aarch64__) && (defined(OVR_CPU_ARM_NEON) || defined(__ARM_NEON))
+#include <arm_neon.h>
+#define OVR_PARTICLE_NEON 1
+#endif
+
 using OVR::Matrix4f;
 using OVR::Posef;
 using OVR::Quatf;
@@ -44,6 +57,9 @@ inline Vector3f GetViewMatrixForward(Matrix4f const& m) {
     return Vector3f(-m.M[2][0], -m.M[2][1], -m.M[2][2]).Normalized();
 }
 
+// Particles per job, small enough for the per job arrays to stay in the cache.
+static const int PARTICLE_JOB_SIZE = 1024;
+
 namespace OVRFW {
 
 static const char* particleVertexSrc = R"glsl(
@@ -60,6 +76,42 @@ void main()
 }
 )glsl";
 
+// The quad of each particle is expanded from its instance record with the same billboard basis
+// as BuildParticleVertices(), the corners are counter clockwise from the lower left.
+static const char* particleInstancedVertexSrc = R"glsl(
+attribute vec4 InstancePosition;
+attribute vec2 InstanceRotation;
+attribute vec4 InstanceUvRect;
+attribute vec4 VertexColor;
+uniform highp vec3 ViewPosition;
+uniform highp vec3 ViewForward;
+varying highp vec2 oTexCoord;
+varying lowp vec4 oColor;
+void main()
+{
+    highp vec2 corner = vec2( ( gl_VertexID == 1 || gl_VertexID == 2 ) ? 1.0 : 0.0,
+                              ( gl_VertexID >= 2 ) ? 1.0 : 0.0 );
+    highp vec3 normal = ViewPosition - InstancePosition.xyz;
+    highp float lengthSq = dot( normal, normal );
+    normal = ( lengthSq > 0.0 ) ? normal * inversesqrt( lengthSq ) : ViewForward;
+    highp vec3 xBasis = vec3( 1.0, 0.0, 0.0 );
+    highp vec3 yBasis = vec3( 0.0, 1.0, 0.0 );
+    if ( abs( normal.y ) <= 0.9999 )
+    {
+        xBasis = normalize( vec3( normal.z, 0.0, -normal.x ) );
+        yBasis = cross( normal, xBasis );
+    }
+    highp vec2 rotation = InstanceRotation * InstancePosition.w;
+    highp vec3 right = xBasis * rotation.x + yBasis * rotation.y;
+    highp vec3 up = yBasis * rotation.x - xBasis * rotation.y;
+    highp vec2 offset = corner - vec2( 0.5 );
+    highp vec3 position = InstancePosition.xyz + right * offset.x + up * offset.y;
+    gl_Position = TransformVertex( vec4( position, 1.0 ) );
+    oTexCoord = mix( InstanceUvRect.xy, InstanceUvRect.zw, vec2( corner.x, 1.0 - corner.y ) );
+    oColor = VertexColor;
+}
+)glsl";
+
 static const char* particleFragmentSrc = R"glsl(
 uniform sampler2D Texture0;
 varying highp vec2 oTexCoord;
@@ -91,61 +143,139 @@ static Vector3f quadVertPos[4] = {
 
 static Vector2f quadUVs[4] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
 
-ovrParticleSystem::ovrParticleSystem() : maxParticles_(0) {}
+ovrParticleSystem::ovrParticleSystem()
+    : maxParticles_(0),
+      activeCount_(0),
+      JobPool(nullptr),
+      ViewForward(0.0f, 0.0f, -1.0f),
+      SortParticles(false),
+      Instanced(false) {}
 
 ovrParticleSystem::~ovrParticleSystem() {
     Shutdown();
 }
 
+void ovrParticleSystem::ovrParticleArrays::Resize(const size_t size) {
+    StartTime.resize(size);
+    LifeTime.resize(size);
+    PositionX.resize(size);
+    PositionY.resize(size);
+    PositionZ.resize(size);
+    VelocityX.resize(size);
+    VelocityY.resize(size);
+    VelocityZ.resize(size);
+    HalfAccelerationX.resize(size);
+    HalfAccelerationY.resize(size);
+    HalfAccelerationZ.resize(size);
+    Orientation.resize(size);
+    RotationRate.resize(size);
+    Color.resize(size);
+    Scale.resize(size);
+    SpriteIndex.resize(size);
+    EaseFunc.resize(size);
+}
+
+void ovrParticleSystem::ovrParticleArrays::Move(const int dst, const int src) {
+    StartTime[dst] = StartTime[src];
+    LifeTime[dst] = LifeTime[src];
+    PositionX[dst] = PositionX[src];
+    PositionY[dst] = PositionY[src];
+    PositionZ[dst] = PositionZ[src];
+    VelocityX[dst] = VelocityX[src];
+    VelocityY[dst] = VelocityY[src];
+    VelocityZ[dst] = VelocityZ[src];
+    HalfAccelerationX[dst] = HalfAccelerationX[src];
+    HalfAccelerationY[dst] = HalfAccelerationY[src];
+    HalfAccelerationZ[dst] = HalfAccelerationZ[src];
+    Orientation[dst] = Orientation[src];
+    RotationRate[dst] = RotationRate[src];
+    Color[dst] = Color[src];
+    Scale[dst] = Scale[src];
+    SpriteIndex[dst] = SpriteIndex[src];
+    EaseFunc[dst] = EaseFunc[src];
+}
+
+void ovrParticleSystem::ovrDerivedArrays::Resize(const size_t size) {
+    PositionX.resize(size);
+    PositionY.resize(size);
+    PositionZ.resize(size);
+    Orientation.resize(size);
+    Color.resize(size);
+    Distance.resize(size);
+}
+
 void ovrParticleSystem::Init(
     const size_t maxParticles,
     const ovrTextureAtlas* atlas,
     const ovrGpuState& gpuState,
-    bool const sortParticles) {
+    bool const sortParticles,
+    bool const instanced) {
     // this can be called multiple times
     Shutdown();
 
     maxParticles_ = maxParticles;
 
     // free any existing particles
-    particles_.reserve(maxParticles);
+    activeCount_ = 0;
+    particles_.Resize(maxParticles);
+    derived_.Resize(maxParticles);
+    handleSlots_.clear();
+    handleSlots_.reserve(maxParticles);
+    slotHandles_.resize(maxParticles);
+    freeParticles_.clear();
     freeParticles_.reserve(maxParticles);
-    activeParticles_.reserve(maxParticles);
+
+    Instanced = instanced;
 
     // create the geometry
-    CreateGeometry(maxParticles);
+    if (Instanced) {
+        CreateInstancedGeometry(maxParticles);
+    } else {
+        CreateGeometry(maxParticles);
+    }
 
     {
         OVRFW::ovrProgramParm uniformParms[] = {
-            /// Vertex
             /// Fragment
             {"Texture0", OVRFW::ovrProgramParmType::TEXTURE_SAMPLED},
+            /// Vertex, only used when instanced
+            {"ViewPosition", OVRFW::ovrProgramParmType::FLOAT_VECTOR3},
+            {"ViewForward", OVRFW::ovrProgramParmType::FLOAT_VECTOR3},
         };
-        const int uniformCount = sizeof(uniformParms) / sizeof(OVRFW::ovrProgramParm);
+        const int uniformCount =
+            Instanced ? sizeof(uniformParms) / sizeof(OVRFW::ovrProgramParm) : 1;
+        const char* vertexSrc = Instanced ? particleInstancedVertexSrc : particleVertexSrc;
         if (atlas != nullptr) {
             Program = OVRFW::GlProgram::Build(
-                particleVertexSrc, particleFragmentSrc, uniformParms, uniformCount);
+                vertexSrc, particleFragmentSrc, uniformParms, uniformCount);
             SurfaceDef.surfaceName = std::string("particles_") + atlas->GetTextureName();
             SurfaceDef.graphicsCommand.Textures[0] = atlas->GetTexture();
         } else {
             Program = OVRFW::GlProgram::Build(
-                particleVertexSrc, particleGeoFragmentSrc, uniformParms, uniformCount);
+                vertexSrc, particleGeoFragmentSrc, uniformParms, uniformCount);
         }
     }
 
     SurfaceDef.graphicsCommand.Program = Program;
     SurfaceDef.graphicsCommand.BindUniformTextures();
+    if (Instanced) {
+        SurfaceDef.graphicsCommand.UniformData[1].Data = &ViewPosition;
+        SurfaceDef.graphicsCommand.UniformData[2].Data = &ViewForward;
+    }
 
     SurfaceDef.graphicsCommand.GpuState = gpuState;
 
     SortParticles = sortParticles;
 
-    derived_.reserve(maxParticles);
-    sortIndices_.reserve(maxParticles);
-    attr_.position.reserve(maxParticles * 4);
-    attr_.color.reserve(maxParticles * 4);
-    attr_.uv0.reserve(maxParticles * 4);
-    packedAttr_.reserve(maxParticles * 12 * 16 * 8);
+    sortItems_.reserve(maxParticles);
+    sortScratch_.reserve(maxParticles);
+    if (Instanced) {
+        instances_.reserve(maxParticles);
+    } else {
+        attr_.position.reserve(maxParticles * 4);
+        attr_.color.reserve(maxParticles * 4);
+        attr_.uv0.reserve(maxParticles * 4);
+    }
 }
 
 ovrGpuState ovrParticleSystem::GetDefaultGpuState() {
@@ -159,129 +289,322 @@ ovrGpuState ovrParticleSystem::GetDefaultGpuState() {
     return s;
 }
 
-int ParticleSortFn(void const* a, void const* b) {
-    if (static_cast<const particleSort_t*>(b)->DistanceSq <
-        static_cast<const particleSort_t*>(a)->DistanceSq) {
-        return -1;
+// out = initial + rate * t + halfAcceleration * t^2, for count values.
+static void IntegrateParticles(
+    const float* initial,
+    const float* rate,
+    const float* halfAcceleration,
+    const float* t,
+    float* out,
+    const int count) {
+    int i = 0;
+#if defined(OVR_PARTICLE_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        const __m128 t4 = _mm_loadu_ps(t + i);
+        const __m128 v = _mm_add_ps(
+            _mm_loadu_ps(rate + i), _mm_mul_ps(_mm_loadu_ps(halfAcceleration + i), t4));
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(initial + i), _mm_mul_ps(v, t4)));
+    }
+#elif defined(OVR_PARTICLE_NEON)
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t t4 = vld1q_f32(t + i);
+        const float32x4_t v = vmlaq_f32(vld1q_f32(rate + i), vld1q_f32(halfAcceleration + i), t4);
+        vst1q_f32(out + i, vmlaq_f32(vld1q_f32(initial + i), v, t4));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = initial[i] + (rate[i] + halfAcceleration[i] * t[i]) * t[i];
     }
-    return 1;
 }
 
-void ovrParticleSystem::Frame(
-    const OVRFW::ovrApplFrameIn& frame,
-    const ovrTextureAtlas* atlas,
-    const Matrix4f& centerEyeViewMatrix) {
-    // OVR_PERF_TIMER( ovrParticleSystem_Frame );
+// out = initial + rate * t, for count values.
+static void IntegrateParticles(
+    const float* initial,
+    const float* rate,
+    const float* t,
+    float* out,
+    const int count) {
+    int i = 0;
+#if defined(OVR_PARTICLE_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        const __m128 r = _mm_mul_ps(_mm_loadu_ps(rate + i), _mm_loadu_ps(t + i));
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(initial + i), r));
+    }
+#elif defined(OVR_PARTICLE_NEON)
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t t4 = vld1q_f32(t + i);
+        vst1q_f32(out + i, vmlaq_f32(vld1q_f32(initial + i), vld1q_f32(rate + i), t4));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = initial[i] + rate[i] * t[i];
+    }
+}
 
-    if (activeParticles_.empty()) {
-        return;
+// Same as EaseFunctions[ easeFunc ], without the indirect call.
+static Vector4f EaseParticleColor(const ovrEaseFunc easeFunc, const Vector4f& c, const float t) {
+    switch (easeFunc) {
+        case IN_OUT_LINEAR:
+            return c * EaseInOut_Linear(t);
+        case IN_OUT_CUBIC:
+            return c * EaseInOut_Cubic(t);
+        case IN_OUT_QUADRIC:
+            return c * EaseInOut_Quadratic(t);
+        case ALPHA_IN_OUT_LINEAR:
+            return Vector4f(c.x, c.y, c.z, c.w * EaseInOut_Linear(t));
+        case ALPHA_IN_OUT_CUBIC:
+            return Vector4f(c.x, c.y, c.z, c.w * EaseInOut_Cubic(t));
+        case ALPHA_IN_OUT_QUADRIC:
+            return Vector4f(c.x, c.y, c.z, c.w * EaseInOut_Quadratic(t));
+        default:
+            return c;
     }
+}
 
-    // update particles
-    Matrix4f invViewMatrix = centerEyeViewMatrix.Inverted();
-    Vector3f viewPos = invViewMatrix.GetTranslation();
-
-    int activeCount = 0;
-
-    // update existing particles and its vertices, deriving the current state of each particle based
-    // on it's current age store the derived state of each particle in the derived array. Also, make
-    // another array that is just the index of each particle and its distance to the view position.
-    // This array will be sorted by distance and then used to index into the derived array the
-    // vertices are transformed.
-
-    std::vector<particleDerived_t>& derived = derived_;
-    std::vector<particleSort_t>& sortIndices = sortIndices_;
-    derived.resize(activeParticles_.size());
-    sortIndices.resize(activeParticles_.size());
-
-    for (size_t i = 0; i < activeParticles_.size(); ++i) {
-        const handle_t handle = activeParticles_[i];
-        ovrParticle& p = particles_[handle.Get()];
-
-        if (frame.PredictedDisplayTime - p.StartTime > p.LifeTime) {
-            // free expired particle
-            p.StartTime = -1.0; // mark as unused
-            freeParticles_.push_back(handle);
-            // Swap this slot with the last item, order doesn't matter
-            activeParticles_.at(i) = activeParticles_.back();
-            activeParticles_.pop_back();
-            i--; // last particle was moved into current slot, so don't skip it
+void ovrParticleSystem::FreeExpiredParticles(const double time) {
+    for (int i = 0; i < activeCount_; i++) {
+        if (time - particles_.StartTime[i] <= particles_.LifeTime[i]) {
             continue;
         }
+        // free expired particle
+        const handle_t handle = slotHandles_[i];
+        handleSlots_[handle.Get()] = -1;
+        freeParticles_.push_back(handle);
+        // Move the last particle into this slot, order doesn't matter
+        const int last = --activeCount_;
+        if (i != last) {
+            particles_.Move(i, last);
+            slotHandles_[i] = slotHandles_[last];
+            handleSlots_[slotHandles_[i].Get()] = i;
+        }
+        i--; // last particle was moved into current slot, so don't skip it
+    }
+}
 
-        float t = static_cast<float>(frame.PredictedDisplayTime - p.StartTime);
-        float tSq = t * t;
+// Derives the current state of count particles starting at first from their age.
+void ovrParticleSystem::SimulateParticles(
+    const int first,
+    const int count,
+    const double time,
+    const Vector3f& viewPos) {
+    float t[PARTICLE_JOB_SIZE];
+    for (int i = 0; i < count; i++) {
+        t[i] = static_cast<float>(time - particles_.StartTime[first + i]);
+    }
 
-        particleDerived_t& d = derived[activeCount];
-        // x = x0 + v0 * t + 0.5f * a * t^2
-        d.Pos = p.InitialPosition + p.InitialVelocity * t + p.HalfAcceleration * tSq;
-        d.Orientation = (p.RotationRate * t) + p.InitialOrientation;
+    const ovrParticleArrays& p = particles_;
+    ovrDerivedArrays& d = derived_;
+    // x = x0 + v0 * t + 0.5f * a * t^2
+    IntegrateParticles(
+        &p.PositionX[first],
+        &p.VelocityX[first],
+        &p.HalfAccelerationX[first],
+        t,
+        &d.PositionX[first],
+        count);
+    IntegrateParticles(
+        &p.PositionY[first],
+        &p.VelocityY[first],
+        &p.HalfAccelerationY[first],
+        t,
+        &d.PositionY[first],
+        count);
+    IntegrateParticles(
+        &p.PositionZ[first],
+        &p.VelocityZ[first],
+        &p.HalfAccelerationZ[first],
+        t,
+        &d.PositionZ[first],
+        count);
+    IntegrateParticles(
+        &p.Orientation[first], &p.RotationRate[first], t, &d.Orientation[first], count);
+
+    for (int i = 0; i < count; i++) {
+        const int j = first + i;
+        d.Color[j] = EaseParticleColor(p.EaseFunc[j], p.Color[j], t[i] / p.LifeTime[j]);
+    }
 
-        d.Color = EaseFunctions[p.EaseFunc](p.InitialColor, t / p.LifeTime);
+    if (SortParticles) {
+        for (int j = first; j < first + count; j++) {
+            const float dx = d.PositionX[j] - viewPos.x;
+            const float dy = d.PositionY[j] - viewPos.y;
+            const float dz = d.PositionZ[j] - viewPos.z;
+            d.Distance[j] = sqrtf(dx * dx + dy * dy + dz * dz);
+        }
+    }
+}
 
-        d.Scale = p.InitialScale;
-        d.SpriteIndex = p.SpriteIndex;
+// Writes the quads of sorted particles [first, first + count).
+void ovrParticleSystem::BuildParticleVertices(
+    const int first,
+    const int count,
+    const ovrTextureAtlas* atlas,
+    const Vector3f& viewPos,
+    const Vector3f& viewForward) {
+    const ovrDerivedArrays& d = derived_;
+    for (int i = first; i < first + count; ++i) {
+        const int j = SortParticles ? static_cast<int>(sortItems_[i].value) : i;
+        const Vector3f pos(d.PositionX[j], d.PositionY[j], d.PositionZ[j]);
+
+        // This always aligns the particle to the direction of the particle to the view
+        // position. This looks a little better but is more expensive and only really makes a
+        // difference for large particles.
+        Vector3f normal = (viewPos - pos).Normalized();
+        if (normal.LengthSq() < 0.999f) {
+            normal = viewForward;
+        }
+        // The basis Matrix4f::CreateFromBasisVectors( normal, up ) builds, rotated by the roll
+        // of the particle.
+        Vector3f xBasis(1.0f, 0.0f, 0.0f);
+        Vector3f yBasis(0.0f, 1.0f, 0.0f);
+        if (fabsf(normal.y) <= 0.9999f) {
+            xBasis = Vector3f(normal.z, 0.0f, -normal.x).Normalized();
+            yBasis = normal.Cross(xBasis);
+        }
+        const float scale = particles_.Scale[j];
+        const float sina = sinf(d.Orientation[j]) * scale;
+        const float cosa = cosf(d.Orientation[j]) * scale;
+        const Vector3f right = xBasis * cosa + yBasis * sina;
+        const Vector3f up = yBasis * cosa - xBasis * sina;
+
+        for (int v = 0; v < 4; ++v) {
+            attr_.position[i * 4 + v] = pos + right * quadVertPos[v].x + up * quadVertPos[v].y;
+            attr_.color[i * 4 + v] = d.Color[j];
+        }
 
-        particleSort_t& ps = sortIndices[activeCount];
-        ps.ActiveIndex = activeCount;
-        ps.DistanceSq =
-            (d.Pos - viewPos).LengthSq(); // Dot( centerEyeViewMatrix.GetZBasis() );//.LengthSq();
+        if (atlas != nullptr) {
+            // set UVs of this sprite in the atlas
+            const ovrTextureAtlas::ovrSpriteDef& sd =
+                atlas->GetSpriteDef(particles_.SpriteIndex[j]);
+            attr_.uv0[i * 4 + 0] = Vector2f(sd.uvMins.x, sd.uvMins.y);
+            attr_.uv0[i * 4 + 1] = Vector2f(sd.uvMaxs.x, sd.uvMins.y);
+            attr_.uv0[i * 4 + 2] = Vector2f(sd.uvMaxs.x, sd.uvMaxs.y);
+            attr_.uv0[i * 4 + 3] = Vector2f(sd.uvMins.x, sd.uvMaxs.y);
+        } else {
+            attr_.uv0[i * 4 + 0] = Vector2f(-1, -1);
+            attr_.uv0[i * 4 + 1] = Vector2f(1, -1);
+            attr_.uv0[i * 4 + 2] = Vector2f(1, 1);
+            attr_.uv0[i * 4 + 3] = Vector2f(-1, 1);
+        }
+    }
+}
 
-        activeCount++;
+// Packs the instance records of sorted particles [first, first + count).
+void ovrParticleSystem::BuildParticleInstances(
+    const int first,
+    const int count,
+    const ovrTextureAtlas* atlas) {
+    const ovrDerivedArrays& d = derived_;
+    for (int i = first; i < first + count; ++i) {
+        const int j = SortParticles ? static_cast<int>(sortItems_[i].value) : i;
+        Vector2f uvMins(-1.0f, -1.0f);
+        Vector2f uvMaxs(1.0f, 1.0f);
+        if (atlas != nullptr) {
+            const ovrTextureAtlas::ovrSpriteDef& sd =
+                atlas->GetSpriteDef(particles_.SpriteIndex[j]);
+            uvMins = sd.uvMins;
+            uvMaxs = sd.uvMaxs;
+        }
+        PackParticleInstance(
+            instances_[i],
+            Vector3f(d.PositionX[j], d.PositionY[j], d.PositionZ[j]),
+            particles_.Scale[j],
+            d.Orientation[j],
+            d.Color[j],
+            uvMins,
+            uvMaxs);
     }
+}
 
-    assert(activeParticles_.size() == (size_t)activeCount);
+void ovrParticleSystem::Frame(
+    const OVRFW::ovrApplFrameIn& frame,
+    const ovrTextureAtlas* atlas,
+    const Matrix4f& centerEyeViewMatrix) {
+    OVR_PERF_TIMER(ovrParticleSystem_Frame);
+
+    if (activeCount_ == 0) {
+        return;
+    }
 
-    if (activeCount > 0) {
-        // sort by distance to view pos
-        if (SortParticles) {
-            qsort(&sortIndices[0], activeCount, sizeof(sortIndices[0]), ParticleSortFn);
+    const double time = frame.PredictedDisplayTime;
+    FreeExpiredParticles(time);
+    // RenderEyeView skips the surface once the last particles expire, so it isn't updated
+    if (activeCount_ == 0) {
+        return;
+    }
+
+    const Matrix4f invViewMatrix = centerEyeViewMatrix.Inverted();
+    const Vector3f viewPos = invViewMatrix.GetTranslation();
+    const Vector3f viewForward = GetViewMatrixForward(centerEyeViewMatrix);
+
+    const int activeCount = activeCount_;
+    const int numJobs = (activeCount + PARTICLE_JOB_SIZE - 1) / PARTICLE_JOB_SIZE;
+
+    // derive the current state of each particle from its age
+    ovrJobPool::ParallelFor(JobPool, numJobs, [this, activeCount, time, &viewPos](const int job) {
+        const int first = job * PARTICLE_JOB_SIZE;
+        SimulateParticles(
+            first, std::min(PARTICLE_JOB_SIZE, activeCount - first), time, viewPos);
+    });
+
+    if (SortParticles) {
+        // Sort back to front on the distance to the view position, quantized to 16 bits over
+        // the range of this frame, which only takes two radix sort passes.
+        sortItems_.resize(activeCount);
+        const std::vector<float>& distance = derived_.Distance;
+        const float maxDistance =
+            *std::max_element(distance.begin(), distance.begin() + activeCount);
+        const float quantize = (maxDistance > 0.0f) ? 65535.0f / maxDistance : 0.0f;
+        for (int i = 0; i < activeCount; i++) {
+            const uint32_t depth = static_cast<uint32_t>(distance[i] * quantize);
+            sortItems_[i].key = 65535 - std::min(depth, 65535u);
+            sortItems_[i].value = static_cast<uint32_t>(i);
         }
+        RadixSort(sortItems_, sortScratch_);
+    }
 
-        attr_.position.resize(activeCount * 4);
-        attr_.color.resize(activeCount * 4);
-        attr_.uv0.resize(activeCount * 4);
-
-        // transform vertices for each particle quad
-        for (int i = 0; i < activeCount; ++i) {
-            particleSort_t const& si = sortIndices[i];
-            particleDerived_t const& p = derived[si.ActiveIndex];
-
-            // transform vertices on the CPU
-            Matrix4f rotMatrix = Matrix4f::RotationZ(p.Orientation);
-            // This always aligns the particle to the direction of the particle to the view
-            // position. This looks a little better but is more expensive and only really makes a
-            // difference for large particles.
-            Vector3f normal = (viewPos - p.Pos).Normalized();
-            if (normal.LengthSq() < 0.999f) {
-                normal = GetViewMatrixForward(centerEyeViewMatrix);
-            }
-            Matrix4f particleTransform =
-                Matrix4f::CreateFromBasisVectors(normal, Vector3f(0.0f, 1.0f, 0.0f));
-            particleTransform.SetTranslation(p.Pos);
-
-            for (int v = 0; v < 4; ++v) {
-                attr_.position[i * 4 + v] =
-                    particleTransform.Transform(rotMatrix.Transform(quadVertPos[v] * p.Scale));
-                attr_.color[i * 4 + v] = p.Color;
-            }
-
-            if (atlas != nullptr) {
-                // set UVs of this sprite in the atlas
-                const ovrTextureAtlas::ovrSpriteDef& sd = atlas->GetSpriteDef(p.SpriteIndex);
-                attr_.uv0[i * 4 + 0] = Vector2f(sd.uvMins.x, sd.uvMins.y);
-                attr_.uv0[i * 4 + 1] = Vector2f(sd.uvMaxs.x, sd.uvMins.y);
-                attr_.uv0[i * 4 + 2] = Vector2f(sd.uvMaxs.x, sd.uvMaxs.y);
-                attr_.uv0[i * 4 + 3] = Vector2f(sd.uvMins.x, sd.uvMaxs.y);
-            } else {
-                attr_.uv0[i * 4 + 0] = Vector2f(-1, -1);
-                attr_.uv0[i * 4 + 1] = Vector2f(1, -1);
-                attr_.uv0[i * 4 + 2] = Vector2f(1, 1);
-                attr_.uv0[i * 4 + 3] = Vector2f(-1, 1);
-            }
+    if (Instanced) {
+        instances_.resize(activeCount);
+        ovrJobPool::ParallelFor(JobPool, numJobs, [this, activeCount, atlas](const int job) {
+            const int first = job * PARTICLE_JOB_SIZE;
+            BuildParticleInstances(first, std::min(PARTICLE_JOB_SIZE, activeCount - first), atlas);
+        });
+
+        UpdateBillboardInstances(
+            SurfaceDef.geo, instances_.data(), activeCount, sizeof(ovrParticleInstance));
+        SurfaceDef.numInstances = activeCount;
+        ViewPosition = viewPos;
+        ViewForward = viewForward;
+
+        // the quads can face any direction, so bound them by their half diagonal
+        const ovrDerivedArrays& d = derived_;
+        OVR::Bounds3f& bounds = SurfaceDef.geo.localBounds;
+        bounds.Clear();
+        for (int i = 0; i < activeCount; i++) {
+            const Vector3f pos(d.PositionX[i], d.PositionY[i], d.PositionZ[i]);
+            const float radius = fabsf(particles_.Scale[i]) * 0.70710678f;
+            bounds.AddPoint(pos - Vector3f(radius));
+            bounds.AddPoint(pos + Vector3f(radius));
         }
+        return;
     }
 
+    attr_.position.resize(activeCount * 4);
+    attr_.color.resize(activeCount * 4);
+    attr_.uv0.resize(activeCount * 4);
+
+    // transform vertices for each particle quad
+    ovrJobPool::ParallelFor(
+        JobPool, numJobs, [this, activeCount, atlas, &viewPos, &viewForward](const int job) {
+            const int first = job * PARTICLE_JOB_SIZE;
+            BuildParticleVertices(
+                first,
+                std::min(PARTICLE_JOB_SIZE, activeCount - first),
+                atlas,
+                viewPos,
+                viewForward);
+        });
+
     // update the geometry with new vertex attributes
     SurfaceDef.geo.Update(attr_);
 }
@@ -299,7 +622,7 @@ void ovrParticleSystem::RenderEyeView(
     // OVR_UNUSED( projectionMatrix );
 
     // Don't even add a surface if not needed
-    if (activeParticles_.empty()) {
+    if (activeCount_ == 0) {
         return;
     }
 
@@ -322,37 +645,37 @@ ovrParticleSystem::handle_t ovrParticleSystem::AddParticle(
     const float scale,
     const float lifeTime,
     const uint16_t spriteIndex) {
-    ovrParticle* p;
-
     handle_t particleHandle;
     if (!freeParticles_.empty()) {
         particleHandle = handle_t(freeParticles_[freeParticles_.size() - 1]);
         freeParticles_.pop_back();
-        activeParticles_.push_back(particleHandle);
         assert(particleHandle.IsValid());
-        assert((size_t)particleHandle.Get() < particles_.size());
-        p = &particles_[particleHandle.Get()];
+        assert((size_t)particleHandle.Get() < handleSlots_.size());
     } else {
-        if (particles_.size() >= maxParticles_) {
+        if (handleSlots_.size() >= maxParticles_) {
             return handle_t(); // adding more would overflow the VAO
         }
-        particleHandle = handle_t(particles_.size());
-        particles_.emplace_back();
-        activeParticles_.push_back(particleHandle);
-        p = &particles_[particles_.size() - 1];
+        particleHandle = handle_t(static_cast<int32_t>(handleSlots_.size()));
+        handleSlots_.push_back(-1);
     }
 
-    p->StartTime = frame.PredictedDisplayTime;
-    p->LifeTime = lifeTime;
-    p->InitialPosition = initialPosition;
-    p->InitialOrientation = initialOrientation;
-    p->InitialVelocity = initialVelocity;
-    p->HalfAcceleration = acceleration * 0.5f;
-    p->InitialColor = initialColor;
-    p->EaseFunc = easeFunc;
-    p->RotationRate = rotationRate;
-    p->InitialScale = scale;
-    p->SpriteIndex = spriteIndex;
+    const int slot = activeCount_++;
+    handleSlots_[particleHandle.Get()] = slot;
+    slotHandles_[slot] = particleHandle;
+
+    UpdateParticle(
+        frame,
+        particleHandle,
+        initialPosition,
+        initialOrientation,
+        initialVelocity,
+        acceleration,
+        initialColor,
+        easeFunc,
+        rotationRate,
+        scale,
+        lifeTime,
+        spriteIndex);
 
     return particleHandle;
 }
@@ -370,31 +693,78 @@ void ovrParticleSystem::UpdateParticle(
     const float scale,
     const float lifeTime,
     const uint16_t spriteIndex) {
-    if (!handle.IsValid() || (size_t)handle.Get() >= particles_.size()) {
-        assert(handle.IsValid() && (size_t)handle.Get() < particles_.size());
+    if (!handle.IsValid() || (size_t)handle.Get() >= handleSlots_.size()) {
+        assert(handle.IsValid() && (size_t)handle.Get() < handleSlots_.size());
         return;
     }
-    ovrParticle& p = particles_[handle.Get()];
-    p.InitialPosition = position;
-    p.InitialOrientation = orientation;
-    p.InitialVelocity = velocity;
-    p.HalfAcceleration = acceleration * 0.5f;
-    p.InitialColor = color;
-    p.EaseFunc = easeFunc;
-    p.RotationRate = rotationRate;
-    p.InitialScale = scale;
-    p.SpriteIndex = spriteIndex;
-    p.StartTime = frame.PredictedDisplayTime;
-    p.LifeTime = lifeTime;
+    const int i = handleSlots_[handle.Get()];
+    if (i < 0) {
+        return; // the particle expired
+    }
+    ovrParticleArrays& p = particles_;
+    p.PositionX[i] = position.x;
+    p.PositionY[i] = position.y;
+    p.PositionZ[i] = position.z;
+    p.Orientation[i] = orientation;
+    p.VelocityX[i] = velocity.x;
+    p.VelocityY[i] = velocity.y;
+    p.VelocityZ[i] = velocity.z;
+    p.HalfAccelerationX[i] = acceleration.x * 0.5f;
+    p.HalfAccelerationY[i] = acceleration.y * 0.5f;
+    p.HalfAccelerationZ[i] = acceleration.z * 0.5f;
+    p.Color[i] = color;
+    p.EaseFunc[i] = easeFunc;
+    p.RotationRate[i] = rotationRate;
+    p.Scale[i] = scale;
+    p.SpriteIndex[i] = spriteIndex;
+    p.StartTime[i] = frame.PredictedDisplayTime;
+    p.LifeTime[i] = lifeTime;
 }
 
 void ovrParticleSystem::RemoveParticle(const handle_t handle) {
-    if (!handle.IsValid() || (size_t)handle.Get() >= particles_.size()) {
+    if (!handle.IsValid() || (size_t)handle.Get() >= handleSlots_.size()) {
+        return;
+    }
+    const int i = handleSlots_[handle.Get()];
+    if (i < 0) {
         return;
     }
     // particle will get removed in the next update
-    particles_[handle.Get()].StartTime = -1.0; // mark as unused
-    particles_[handle.Get()].LifeTime = 0.0;
+    particles_.StartTime[i] = -1.0; // mark as unused
+    particles_.LifeTime[i] = 0.0f;
+}
+
+void ovrParticleSystem::CreateInstancedGeometry(const int maxParticles) {
+    SurfaceDef.geo.Free();
+
+    static const ovrInstanceAttribute attributes[] = {
+        {VERTEX_ATTRIBUTE_LOCATION_INSTANCE_POSITION, // position and scale
+         4,
+         GL_FLOAT,
+         false,
+         offsetof(ovrParticleInstance, Position)},
+        {VERTEX_ATTRIBUTE_LOCATION_INSTANCE_ROTATION,
+         2,
+         GL_SHORT,
+         true,
+         offsetof(ovrParticleInstance, Rotation)},
+        {VERTEX_ATTRIBUTE_LOCATION_INSTANCE_UV_RECT,
+         4,
+         GL_SHORT,
+         true,
+         offsetof(ovrParticleInstance, UvRect)},
+        {VERTEX_ATTRIBUTE_LOCATION_COLOR,
+         4,
+         GL_UNSIGNED_BYTE,
+         true,
+         offsetof(ovrParticleInstance, Color)},
+    };
+    CreateBillboardGeometry(
+        SurfaceDef.geo,
+        attributes,
+        sizeof(attributes) / sizeof(attributes[0]),
+        sizeof(ovrParticleInstance),
+        maxParticles);
 }
 
 void ovrParticleSystem::CreateGeometry(const int maxParticles) {
@@ -408,7 +778,8 @@ void ovrParticleSystem::CreateGeometry(const int maxParticles) {
     attr.color.resize(numVerts);
     attr.uv0.resize(numVerts);
 
-    std::vector<TriangleIndex> indices;
+    // more than 16384 particles need 32 bit indices
+    std::vector<uint32_t> indices;
     const int numIndices = maxParticles * 6;
     indices.resize(numIndices);
 
@@ -420,15 +791,15 @@ void ovrParticleSystem::CreateGeometry(const int maxParticles) {
             attr.uv0[i * 4 + v] = quadUVs[v];
         }
 
-        indices[i * 6 + 0] = static_cast<uint16_t>(i * 4 + 0);
-        indices[i * 6 + 1] = static_cast<uint16_t>(i * 4 + 3);
-        indices[i * 6 + 2] = static_cast<uint16_t>(i * 4 + 1);
-        indices[i * 6 + 3] = static_cast<uint16_t>(i * 4 + 1);
-        indices[i * 6 + 4] = static_cast<uint16_t>(i * 4 + 3);
-        indices[i * 6 + 5] = static_cast<uint16_t>(i * 4 + 2);
+        indices[i * 6 + 0] = static_cast<uint32_t>(i * 4 + 0);
+        indices[i * 6 + 1] = static_cast<uint32_t>(i * 4 + 3);
+        indices[i * 6 + 2] = static_cast<uint32_t>(i * 4 + 1);
+        indices[i * 6 + 3] = static_cast<uint32_t>(i * 4 + 1);
+        indices[i * 6 + 4] = static_cast<uint32_t>(i * 4 + 3);
+        indices[i * 6 + 5] = static_cast<uint32_t>(i * 4 + 2);
     }
 
-    SurfaceDef.geo.Create(attr, indices);
+    SurfaceDef.geo.CreateDynamic(attr, indices);
 }
 
 } // namespace OVRFW
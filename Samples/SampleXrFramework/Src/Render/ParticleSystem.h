@@ -37,6 +37,8 @@ Authors     :   Jonathan E. Wright
 #include "OVR_FileSys.h"
 
 #include "EaseFunctions.h"
+#include "RadixSort.h"
+#include "BillboardInstances.h"
 
 #include <cstdint>
 #include <vector>
@@ -45,19 +47,7 @@ Authors     :   Jonathan E. Wright
 namespace OVRFW {
 
 class ovrTextureAtlas;
-
-struct particleDerived_t {
-    OVR::Vector3f Pos;
-    OVR::Vector4f Color;
-    float Orientation; // roll angle in radians
-    float Scale;
-    uint16_t SpriteIndex;
-};
-
-struct particleSort_t {
-    int ActiveIndex;
-    float DistanceSq;
-};
+class ovrJobPool;
 
 //==============================================================
 // ovrParticleSystem
@@ -71,11 +61,14 @@ class ovrParticleSystem {
     virtual ~ovrParticleSystem();
 
     // specify sprite locations as a regular grid
+    // With instanced set, one compact record is uploaded per particle and the vertex shader
+    // expands and billboards the quads, instead of writing four vertices per particle.
     void Init(
         size_t maxParticles,
         const ovrTextureAtlas* atlas,
         const ovrGpuState& gpuState,
-        bool const sortParticles);
+        bool const sortParticles,
+        bool const instanced = false);
 
     void Frame(
         const OVRFW::ovrApplFrameIn& frame,
@@ -118,45 +111,91 @@ class ovrParticleSystem {
 
     void RemoveParticle(const handle_t handle);
 
+    // Frame() splits the simulation and vertex generation across the pool's threads, nullptr
+    // does all of it on the calling thread.
+    void SetJobPool(ovrJobPool* jobPool) {
+        JobPool = jobPool;
+    }
+
+    int GetActiveParticleCount() const {
+        return activeCount_;
+    }
+
     static ovrGpuState GetDefaultGpuState();
 
    private:
     void CreateGeometry(const int maxParticles);
+    void CreateInstancedGeometry(const int maxParticles);
+    void FreeExpiredParticles(const double time);
+    void SimulateParticles(
+        const int first,
+        const int count,
+        const double time,
+        const OVR::Vector3f& viewPos);
+    void BuildParticleVertices(
+        const int first,
+        const int count,
+        const ovrTextureAtlas* atlas,
+        const OVR::Vector3f& viewPos,
+        const OVR::Vector3f& viewForward);
+    void BuildParticleInstances(const int first, const int count, const ovrTextureAtlas* atlas);
+
+    // Structure of arrays with the live particles packed in the first activeCount_ elements, so
+    // the simulation streams through memory and can integrate several particles at once.
+    struct ovrParticleArrays {
+        void Resize(const size_t size);
+        void Move(const int dst, const int src);
+
+        std::vector<double> StartTime; // time particle was created
+        std::vector<float> LifeTime; // time particle should die
+        std::vector<float> PositionX; // initial position of the particle
+        std::vector<float> PositionY;
+        std::vector<float> PositionZ;
+        std::vector<float> VelocityX; // initial velocity of the particle
+        std::vector<float> VelocityY;
+        std::vector<float> VelocityZ;
+        std::vector<float> HalfAccelerationX; // 1/2 the initial acceleration of the particle
+        std::vector<float> HalfAccelerationY;
+        std::vector<float> HalfAccelerationZ;
+        std::vector<float> Orientation; // initial orientation of the particle
+        std::vector<float> RotationRate; // rotation of the particle
+        std::vector<OVR::Vector4f> Color; // initial color of the particle
+        std::vector<float> Scale; // initial scale of the particle
+        std::vector<uint16_t> SpriteIndex; // index of the sprite for this particle
+        std::vector<ovrEaseFunc> EaseFunc; // parametric function used to compute alpha
+    };
 
-    int GetMaxParticles() const {
-        return SurfaceDef.geo.vertexCount / 4;
-    }
+    // The state of each live particle at the current frame time, in the same order.
+    struct ovrDerivedArrays {
+        void Resize(const size_t size);
 
-    class ovrParticle {
-       public:
-        // empty constructor so we don't pay the price for double initialization
-        ovrParticle() {}
-
-        double StartTime; // time particle was created, negative means this particle is invalid
-        float LifeTime; // time particle should die
-        OVR::Vector3f InitialPosition; // initial position of the particle
-        float InitialOrientation; // initial orientation of the particle
-        OVR::Vector3f InitialVelocity; // initial velocity of the particle
-        OVR::Vector3f HalfAcceleration; // 1/2 the initial acceleration of the particle
-        OVR::Vector4f InitialColor; // initial color of the particle
-        float RotationRate; // rotation of the particle
-        float InitialScale; // initial scale of the particle
-        uint16_t SpriteIndex; // index of the sprite for this particle
-        ovrEaseFunc EaseFunc; // parametric function used to compute alpha
+        std::vector<float> PositionX;
+        std::vector<float> PositionY;
+        std::vector<float> PositionZ;
+        std::vector<float> Orientation; // roll angle in radians
+        std::vector<OVR::Vector4f> Color;
+        std::vector<float> Distance; // to the view position, only when sorting
     };
 
     size_t maxParticles_; // maximum allowd particles
-    std::vector<ovrParticle> particles_; // all active particles
+    int activeCount_; // number of live particles
+    ovrParticleArrays particles_;
+    ovrDerivedArrays derived_;
+    std::vector<int> handleSlots_; // packed index of each handle, -1 if the handle is free
+    std::vector<handle_t> slotHandles_; // handle of each packed particle
     std::vector<handle_t> freeParticles_; // indices of free particles
-    std::vector<handle_t> activeParticles_; // indices of active particles
-    std::vector<particleDerived_t> derived_;
-    std::vector<particleSort_t> sortIndices_;
-    std::vector<uint8_t> packedAttr_;
+    std::vector<ovrRadixSortItem> sortItems_;
+    std::vector<ovrRadixSortItem> sortScratch_;
     OVRFW::VertexAttribs attr_;
+    std::vector<ovrParticleInstance> instances_;
+    ovrJobPool* JobPool;
     GlProgram Program;
     ovrSurfaceDef SurfaceDef;
     OVR::Matrix4f ModelMatrix;
+    OVR::Vector3f ViewPosition; // of the center eye, for billboarding in the vertex shader
+    OVR::Vector3f ViewForward;
     bool SortParticles;
+    bool Instanced;
 };
 
 } // namespace OVRFW
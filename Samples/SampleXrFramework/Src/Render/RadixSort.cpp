@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   RadixSort.cpp
+Content     :   Stable LSD radix sort for compact sort keys.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "RadixSort.h"
+
+#include <string.h>
+
+namespace OVRFW {
+
+void RadixSort(std::vector<ovrRadixSortItem>& items, std::vector<ovrRadixSortItem>& scratch) {
+    static const int NUM_PASSES = sizeof(uint64_t);
+    const size_t numItems = items.size();
+    if (numItems < 2) {
+        return;
+    }
+
+    // Build the histograms for all the passes in a single read of the keys.
+    uint32_t histograms[NUM_PASSES][256];
+    memset(histograms, 0, sizeof(histograms));
+    for (size_t i = 0; i < numItems; i++) {
+        const uint64_t key = items[i].key;
+        for (int pass = 0; pass < NUM_PASSES; pass++) {
+            histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+        }
+    }
+
+    scratch.resize(numItems);
+    ovrRadixSortItem* src = items.data();
+    ovrRadixSortItem* dst = scratch.data();
+
+    for (int pass = 0; pass < NUM_PASSES; pass++) {
+        uint32_t* histogram = histograms[pass];
+        const int shift = pass * 8;
+
+        // Nothing moves if all keys share this digit.
+        if (histogram[(src[0].key >> shift) & 0xFF] == numItems) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (int digit = 0; digit < 256; digit++) {
+            const uint32_t count = histogram[digit];
+            histogram[digit] = offset;
+            offset += count;
+        }
+
+        for (size_t i = 0; i < numItems; i++) {
+            dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+        }
+
+        ovrRadixSortItem* temp = src;
+        src = dst;
+        dst = temp;
+    }
+
+    if (src != items.data()) {
+        memcpy(items.data(), src, numItems * sizeof(ovrRadixSortItem));
+    }
+}
+
+} // namespace OVRFW
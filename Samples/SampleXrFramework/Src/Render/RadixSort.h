@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   RadixSort.h
+Content     :   Stable LSD radix sort for compact sort keys.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace OVRFW {
+
+struct ovrRadixSortItem {
+    uint64_t key;
+    uint32_t value; // typically the index of the sorted element
+};
+
+// Sorts items in increasing key order. Items with equal keys keep their relative order.
+// Byte passes where every key has the same digit are skipped, so keys that only use
+// a few of their bits are cheap to sort. The scratch vector is resized as needed and
+// should be kept around between calls to avoid allocations.
+void RadixSort(std::vector<ovrRadixSortItem>& items, std::vector<ovrRadixSortItem>& scratch);
+
+} // namespace OVRFW
@@ -116,7 +116,7 @@ ovrRibbon::ovrRibbon(const ovrPointList& pointList, const float width, const Vec
         v += 4;
     }
 
-    Surface.geo.Create(attr, indices);
+    Surface.geo.CreateDynamic(attr, indices);
     Surface.geo.primitiveType = GlGeometry::kPrimitiveTypeTriangles;
     Surface.geo.indexCount = 0;
 
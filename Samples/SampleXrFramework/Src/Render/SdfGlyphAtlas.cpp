@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   SdfGlyphAtlas.cpp
+Content     :   Signed distance field glyphs generated at runtime.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "SdfGlyphAtlas.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+namespace OVRFW {
+
+static const float SDF_INFINITY = 1e20f;
+
+// Exact squared Euclidean distance transform of a sampled function in one dimension, from
+// "Distance Transforms of Sampled Functions" by Felzenszwalb and Huttenlocher.
+// v and z are scratch arrays of n and n + 1 elements.
+static void DistanceTransform1D(const float* f, const int n, float* d, int* v, float* z) {
+    int k = 0;
+    v[0] = 0;
+    z[0] = -SDF_INFINITY;
+    z[1] = SDF_INFINITY;
+    for (int q = 1; q < n; q++) {
+        // pop the parabolas that the new one hides, z[0] is -infinity so this stops at k == 0
+        float s;
+        for (;;) {
+            const int p = v[k];
+            s = ((f[q] + q * q) - (f[p] + p * p)) / (2.0f * (q - p));
+            if (s > z[k]) {
+                break;
+            }
+            k--;
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = SDF_INFINITY;
+    }
+    k = 0;
+    for (int q = 0; q < n; q++) {
+        while (z[k + 1] < q) {
+            k++;
+        }
+        const int p = v[k];
+        d[q] = (q - p) * (q - p) + f[p];
+    }
+}
+
+// Squared distance of every pixel to the nearest pixel where seed is set.
+static void DistanceTransform2D(
+    const std::vector<bool>& seed,
+    const int width,
+    const int height,
+    std::vector<float>& dist) {
+    const int n = std::max(width, height);
+    std::vector<float> f(n);
+    std::vector<float> d(n);
+    std::vector<int> v(n);
+    std::vector<float> z(n + 1);
+
+    dist.resize(width * height);
+    for (int i = 0; i < width * height; i++) {
+        dist[i] = seed[i] ? 0.0f : SDF_INFINITY;
+    }
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) {
+            f[y] = dist[y * width + x];
+        }
+        DistanceTransform1D(f.data(), height, d.data(), v.data(), z.data());
+        for (int y = 0; y < height; y++) {
+            dist[y * width + x] = d[y];
+        }
+    }
+    for (int y = 0; y < height; y++) {
+        DistanceTransform1D(&dist[y * width], width, d.data(), v.data(), z.data());
+        memcpy(&dist[y * width], d.data(), width * sizeof(float));
+    }
+}
+
+void GenerateSdf(
+    const uint8_t* coverage,
+    const int width,
+    const int height,
+    const int spread,
+    std::vector<uint8_t>& sdf) {
+    const int w = width + 2 * spread;
+    const int h = height + 2 * spread;
+
+    std::vector<bool> inside(w * h, false);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            inside[(y + spread) * w + x + spread] = coverage[y * width + x] >= 128;
+        }
+    }
+    std::vector<bool> outside(inside.size());
+    for (size_t i = 0; i < inside.size(); i++) {
+        outside[i] = !inside[i];
+    }
+
+    std::vector<float> toInside;
+    std::vector<float> toOutside;
+    DistanceTransform2D(inside, w, h, toInside);
+    DistanceTransform2D(outside, w, h, toOutside);
+
+    // The edge is half way between the centers of an inside and an outside pixel.
+    const float scale = 127.0f / std::max(spread, 1);
+    sdf.resize(w * h);
+    for (int i = 0; i < w * h; i++) {
+        const float distance =
+            inside[i] ? (sqrtf(toOutside[i]) - 0.5f) : (0.5f - sqrtf(toInside[i]));
+        sdf[i] = static_cast<uint8_t>(std::clamp(128.0f + distance * scale, 0.0f, 255.0f));
+    }
+}
+
+void ovrSdfGlyphAtlas::Init(const int width, const int height) {
+    Width = width;
+    Height = height;
+    RowX = 0;
+    RowY = 0;
+    RowHeight = 0;
+    Pixels.assign(width * height, 0);
+    ClearDirty();
+}
+
+bool ovrSdfGlyphAtlas::AddImage(
+    const uint8_t* pixels,
+    const int width,
+    const int height,
+    int& x,
+    int& y) {
+    if (width + GLYPH_MARGIN > Width) {
+        return false;
+    }
+    if (RowX + width + GLYPH_MARGIN > Width) {
+        // start a new row
+        RowX = 0;
+        RowY += RowHeight;
+        RowHeight = 0;
+    }
+    if (RowY + height + GLYPH_MARGIN > Height) {
+        return false;
+    }
+
+    x = RowX + GLYPH_MARGIN;
+    y = RowY + GLYPH_MARGIN;
+    for (int row = 0; row < height; row++) {
+        memcpy(&Pixels[(y + row) * Width + x], &pixels[row * width], width);
+    }
+    RowX += width + GLYPH_MARGIN;
+    RowHeight = std::max(RowHeight, height + GLYPH_MARGIN);
+    DirtyTop = (DirtyBottom > DirtyTop) ? std::min(DirtyTop, y) : y;
+    DirtyBottom = std::max(DirtyBottom, y + height);
+    return true;
+}
+
+} // namespace OVRFW
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   SdfGlyphAtlas.h
+Content     :   Signed distance field glyphs generated at runtime.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace OVRFW {
+
+// A glyph rendered as coverage, with its metrics in pixels.
+struct ovrGlyphBitmap {
+    ovrGlyphBitmap() : Width(0), Height(0), BearingX(0.0f), BearingY(0.0f), AdvanceX(0.0f) {}
+
+    int Width;
+    int Height;
+    float BearingX; // from the pen position to the left edge of the bitmap
+    float BearingY; // from the baseline up to the top edge of the bitmap
+    float AdvanceX; // from the pen position to the pen position of the next glyph
+    std::vector<uint8_t> Coverage; // Width * Height rows from the top, 255 is inside
+};
+
+// Supplies the glyphs of a font that is generated at runtime, so the application can use
+// whichever font engine it ships (FreeType, stb_truetype, a platform API) without the
+// framework depending on one.
+class ovrGlyphRasterizer {
+   public:
+    virtual ~ovrGlyphRasterizer() {}
+
+    // Vertical distance between two baselines.
+    virtual float GetLineHeight(const int pixelHeight) const = 0;
+
+    // Returns false if the font has no glyph for the code point. This is called from several
+    // job pool threads at once.
+    virtual bool RasterizeGlyph(
+        const uint32_t codePoint,
+        const int pixelHeight,
+        ovrGlyphBitmap& bitmap) const = 0;
+};
+
+// Converts coverage to a signed distance field with spread pixels of padding on each side, so
+// sdf is ( width + 2 * spread ) x ( height + 2 * spread ) pixels. 128 is on the edge, values
+// increase inside the glyph and saturate spread pixels away from the edge.
+void GenerateSdf(
+    const uint8_t* coverage,
+    const int width,
+    const int height,
+    const int spread,
+    std::vector<uint8_t>& sdf);
+
+// Packs glyph images into rows of a single channel atlas, keeping a copy of the pixels. The rows
+// that changed are tracked, so the texture can be updated later on the GL thread.
+class ovrSdfGlyphAtlas {
+   public:
+    ovrSdfGlyphAtlas()
+        : Width(0), Height(0), RowX(0), RowY(0), RowHeight(0), DirtyTop(0), DirtyBottom(0) {}
+
+    void Init(const int width, const int height);
+
+    // Copies the image into the atlas, returns false if there is no room left.
+    bool AddImage(const uint8_t* pixels, const int width, const int height, int& x, int& y);
+
+    int GetWidth() const {
+        return Width;
+    }
+    int GetHeight() const {
+        return Height;
+    }
+    const uint8_t* GetPixels() const {
+        return Pixels.data();
+    }
+    // The rows changed by AddImage() since the last ClearDirty(), returns false if there are none.
+    bool GetDirtyRows(int& y, int& height) const {
+        y = DirtyTop;
+        height = DirtyBottom - DirtyTop;
+        return height > 0;
+    }
+    void ClearDirty() {
+        DirtyTop = 0;
+        DirtyBottom = 0;
+    }
+    // Fraction of the rows that have been started.
+    float GetUsage() const {
+        return (Height > 0) ? static_cast<float>(RowY + RowHeight) / Height : 0.0f;
+    }
+
+   private:
+    static const int GLYPH_MARGIN = 1; // keeps bilinear filtering from bleeding between glyphs
+
+    int Width;
+    int Height;
+    int RowX; // where the next image goes in the current row
+    int RowY;
+    int RowHeight; // of the tallest image in the current row
+    int DirtyTop;
+    int DirtyBottom; // one past the last dirty row, nothing is dirty if not below DirtyTop
+    std::vector<uint8_t> Pixels;
+};
+
+} // namespace OVRFW
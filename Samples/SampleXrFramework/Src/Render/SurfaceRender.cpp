@@ -136,7 +136,95 @@ ChangeGpuState(const ovrGpuState oldState, const ovrGpuState newState, bool forc
     // extend as needed
 }
 
-ovrSurfaceRender::ovrSurfaceRender() : CurrentSceneMatricesIdx(0) {}
+// Only opaque surfaces that write depth can be reordered without changing the image.
+static bool IsStateSortable(const ovrDrawSurface& drawSurface) {
+    const ovrGraphicsCommand& cmd = drawSurface.surface->graphicsCommand;
+    return cmd.Program.IsValid() && cmd.GpuState.blendEnable == ovrGpuState::BLEND_DISABLE &&
+        cmd.GpuState.depthEnable && cmd.GpuState.depthMaskEnable;
+}
+
+static uint64_t FoldSortKeyBits(const uint64_t value) {
+    return (value ^ (value >> 16) ^ (value >> 32) ^ (value >> 48)) & 0xFFFF;
+}
+
+// Builds a 64 bit key of 16 bit fields, most significant first:
+// program, texture set, uniform buffers, vertex array object.
+// Hash collisions only cost redundant state changes, never correctness.
+static uint64_t StateSortKey(const ovrDrawSurface& drawSurface) {
+    const ovrSurfaceDef& surfaceDef = *drawSurface.surface;
+    const ovrGraphicsCommand& cmd = surfaceDef.graphicsCommand;
+
+    uint64_t textureHash = 0;
+    uint64_t bufferHash = 0;
+    for (int i = 0; i < ovrUniform::MAX_UNIFORMS; ++i) {
+        const ovrProgramParmType type = cmd.Program.Uniforms[i].Type;
+        if (type == ovrProgramParmType::MAX) {
+            break;
+        }
+        if (cmd.UniformData[i].Data == NULL) {
+            continue;
+        }
+        if (type == ovrProgramParmType::TEXTURE_SAMPLED) {
+            const GlTexture& texture = *static_cast<GlTexture*>(cmd.UniformData[i].Data);
+            textureHash = textureHash * 31 + texture.texture;
+        } else if (type == ovrProgramParmType::BUFFER_UNIFORM) {
+            const GlBuffer& buffer = *static_cast<GlBuffer*>(cmd.UniformData[i].Data);
+            bufferHash = bufferHash * 31 + buffer.GetBuffer();
+        }
+    }
+
+    return (FoldSortKeyBits(cmd.Program.Program) << 48) | (FoldSortKeyBits(textureHash) << 32) |
+        (FoldSortKeyBits(bufferHash) << 16) | FoldSortKeyBits(surfaceDef.geo.vertexArrayObject);
+}
+
+int BuildInstanceBatches(
+    const std::vector<const ovrDrawSurface*>& drawOrder,
+    const int matrixAlignment,
+    std::vector<ovrInstanceBatch>& batches) {
+    assert(matrixAlignment >= 1);
+
+    batches.clear();
+    int numMatrices = 0;
+
+    const int numSurfaces = static_cast<int>(drawOrder.size());
+    for (int i = 0; i < numSurfaces;) {
+        const ovrSurfaceDef* surface = drawOrder[i]->surface;
+
+        ovrInstanceBatch batch;
+        batch.firstSurface = i;
+        batch.numSurfaces = 1;
+        batch.numInstances = std::max(surface->numInstances, 1);
+        batch.firstMatrix = -1;
+
+        if (surface->graphicsCommand.Program.UsesInstanceMatrices()) {
+            // Surfaces with their own instancing scheme are never merged.
+            if (surface->numInstances <= 1) {
+                while (i + batch.numSurfaces < numSurfaces &&
+                       drawOrder[i + batch.numSurfaces]->surface == surface &&
+                       batch.numSurfaces < MAX_INSTANCE_MATRICES) {
+                    batch.numSurfaces++;
+                }
+                batch.numInstances = batch.numSurfaces;
+            }
+            assert(batch.numInstances <= MAX_INSTANCE_MATRICES);
+            batch.numInstances = std::min(batch.numInstances, MAX_INSTANCE_MATRICES);
+            numMatrices = ((numMatrices + matrixAlignment - 1) / matrixAlignment) * matrixAlignment;
+            batch.firstMatrix = numMatrices;
+            numMatrices += batch.numInstances;
+        }
+
+        batches.push_back(batch);
+        i += batch.numSurfaces;
+    }
+
+    return numMatrices;
+}
+
+ovrSurfaceRender::ovrSurfaceRender()
+    : CurrentSceneMatricesIdx(0),
+      CurrentInstanceMatricesIdx(0),
+      InstanceMatrixAlignment(1),
+      SortMode(SURFACE_SORT_NONE) {}
 
 ovrSurfaceRender::~ovrSurfaceRender() {}
 
@@ -146,12 +234,22 @@ void ovrSurfaceRender::Init() {
     }
 
     CurrentSceneMatricesIdx = 0;
+
+    // The instance matrix buffers are created on first use and grown as needed.
+    CurrentInstanceMatricesIdx = 0;
+    GLint uniformBufferOffsetAlignment = 0;
+    GL(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferOffsetAlignment));
+    InstanceMatrixAlignment =
+        std::max<int>(1, uniformBufferOffsetAlignment / static_cast<int>(sizeof(Matrix4f)));
 }
 
 void ovrSurfaceRender::Shutdown() {
     for (int i = 0; i < MAX_SCENEMATRICES_UBOS; i++) {
         SceneMatrices[i].Destroy();
     }
+    for (int i = 0; i < MAX_INSTANCEMATRICES_UBOS; i++) {
+        InstanceMatrices[i].Destroy();
+    }
 }
 
 int ovrSurfaceRender::UpdateSceneMatrices(
@@ -213,6 +311,64 @@ int ovrSurfaceRender::UpdateSceneMatrices(
     return CurrentSceneMatricesIdx;
 }
 
+int ovrSurfaceRender::UpdateInstanceMatrices(const int numMatrices) {
+    // Advance to the next instance matrix ubo, and grow it if needed. The shader block
+    // always spans MAX_INSTANCE_MATRICES, so the last bound range needs room for all of them.
+    CurrentInstanceMatricesIdx = (CurrentInstanceMatricesIdx + 1) % MAX_INSTANCEMATRICES_UBOS;
+    GlBuffer& buffer = InstanceMatrices[CurrentInstanceMatricesIdx];
+    const size_t requiredSize = (numMatrices + MAX_INSTANCE_MATRICES) * sizeof(Matrix4f);
+    if (buffer.GetBuffer() == 0 || buffer.GetSize() < requiredSize) {
+        buffer.Destroy();
+        buffer.Create(GLBUFFER_TYPE_UNIFORM, requiredSize * 3 / 2, NULL);
+    }
+
+    Matrix4f* matrices = static_cast<Matrix4f*>(buffer.MapBuffer());
+    if (matrices != NULL) {
+        for (const ovrInstanceBatch& batch : Batches) {
+            if (batch.firstMatrix < 0) {
+                continue;
+            }
+            // a self instanced surface repeats its model matrix for each of its instances
+            for (int i = 0; i < batch.numInstances; i++) {
+                const int surface = batch.firstSurface + std::min(i, batch.numSurfaces - 1);
+                matrices[batch.firstMatrix + i] = DrawOrder[surface]->modelMatrix.Transposed();
+            }
+        }
+        buffer.UnmapBuffer();
+    }
+
+    return CurrentInstanceMatricesIdx;
+}
+
+void ovrSurfaceRender::SortSurfaceList(const std::vector<ovrDrawSurface>& surfaceList) {
+    DrawOrder.resize(surfaceList.size());
+    SortEntries.clear();
+
+    // Sort each run of sortable surfaces in place, and leave everything else where it was.
+    const int numSurfaces = static_cast<int>(surfaceList.size());
+    int outIndex = 0;
+    for (int i = 0; i <= numSurfaces; i++) {
+        if (i < numSurfaces && IsStateSortable(surfaceList[i])) {
+            SortEntries.push_back({StateSortKey(surfaceList[i]), i});
+            continue;
+        }
+        // Ties are broken by submission order so the result is stable.
+        std::sort(
+            SortEntries.begin(),
+            SortEntries.end(),
+            [](const ovrSurfaceSortEntry& a, const ovrSurfaceSortEntry& b) {
+                return (a.key < b.key) || (a.key == b.key && a.index < b.index);
+            });
+        for (const ovrSurfaceSortEntry& entry : SortEntries) {
+            DrawOrder[outIndex++] = &surfaceList[entry.index];
+        }
+        SortEntries.clear();
+        if (i < numSurfaces) {
+            DrawOrder[outIndex++] = &surfaceList[i];
+        }
+    }
+}
+
 // Renders a list of pointers to models in order.
 ovrDrawCounters ovrSurfaceRender::RenderSurfaceList(
     const std::vector<ovrDrawSurface>& surfaceList,
@@ -229,6 +385,12 @@ ovrDrawCounters ovrSurfaceRender::RenderSurfaceList(
     GLuint currentBuffers[ovrUniform::MAX_UNIFORMS] = {};
     GLuint currentTextures[ovrUniform::MAX_UNIFORMS] = {};
     GLuint currentProgramObject = 0;
+    GLuint currentVertexArrayObject = 0;
+
+    // Uniform values are program object state, so everything uploaded while the
+    // current program is bound stays valid until the next program change.
+    const void* currentUniformData[ovrUniform::MAX_UNIFORMS] = {};
+    const Matrix4f* currentModelMatrix = NULL;
 
     const int sceneMatricesIdx =
         UpdateSceneMatrices(&viewMatrix, &projectionMatrix, GlProgram::MAX_VIEWS /* num eyes */);
@@ -236,9 +398,26 @@ ovrDrawCounters ovrSurfaceRender::RenderSurfaceList(
     // counters
     ovrDrawCounters counters;
 
+    if (SortMode == SURFACE_SORT_STATE) {
+        SortSurfaceList(surfaceList);
+    } else {
+        DrawOrder.resize(surfaceList.size());
+        for (int i = 0; i < static_cast<int>(surfaceList.size()); i++) {
+            DrawOrder[i] = &surfaceList[i];
+        }
+    }
+
+    // Merge consecutive draws of the same surface into instanced draws.
+    const int numInstanceMatrices =
+        BuildInstanceBatches(DrawOrder, InstanceMatrixAlignment, Batches);
+    const int instanceMatricesIdx =
+        (numInstanceMatrices > 0) ? UpdateInstanceMatrices(numInstanceMatrices) : -1;
+
     // Loop through all the surfaces
-    for (const ovrDrawSurface& drawSurface : surfaceList) {
+    for (const ovrInstanceBatch& batch : Batches) {
+        const ovrDrawSurface& drawSurface = *DrawOrder[batch.firstSurface];
         const ovrSurfaceDef& surfaceDef = *drawSurface.surface;
+        const bool instanced = (batch.firstMatrix >= 0);
         const ovrGraphicsCommand& cmd = surfaceDef.graphicsCommand;
 
         if (cmd.Program.IsValid()) {
@@ -247,27 +426,67 @@ ovrDrawCounters ovrSurfaceRender::RenderSurfaceList(
             GLCheckErrorsWithTitle(surfaceDef.surfaceName.c_str());
 
             // update the program object
-            if (cmd.Program.Program != currentProgramObject) {
+            const bool programChanged = (cmd.Program.Program != currentProgramObject);
+            if (programChanged) {
                 counters.numProgramBinds++;
 
                 currentProgramObject = cmd.Program.Program;
                 GL(glUseProgram(cmd.Program.Program));
+
+                for (int i = 0; i < ovrUniform::MAX_UNIFORMS; ++i) {
+                    currentUniformData[i] = NULL;
+                }
+                currentModelMatrix = NULL;
+            } else {
+                counters.numSkippedProgramBinds++;
             }
 
             // Update globally defined system level uniforms.
             {
-                if (cmd.Program.ViewID.Location >= 0) // not defined when multiview enabled
+                if (programChanged &&
+                    cmd.Program.ViewID.Location >= 0) // not defined when multiview enabled
                 {
                     GL(glUniform1i(cmd.Program.ViewID.Location, eye));
                 }
-                GL(glUniformMatrix4fv(
-                    cmd.Program.ModelMatrix.Location, 1, GL_TRUE, drawSurface.modelMatrix.M[0]));
+                if (instanced) {
+                    // Each batch reads its own range of the instance matrix ubo.
+                    const int binding = cmd.Program.InstanceMatrices.Binding;
+                    counters.numBufferBinds++;
+                    if (binding >= 0 && binding < ovrUniform::MAX_UNIFORMS) {
+                        currentBuffers[binding] = 0;
+                    }
+                    GL(glBindBufferRange(
+                        GL_UNIFORM_BUFFER,
+                        binding,
+                        InstanceMatrices[instanceMatricesIdx].GetBuffer(),
+                        batch.firstMatrix * sizeof(Matrix4f),
+                        MAX_INSTANCE_MATRICES * sizeof(Matrix4f)));
+                } else if (
+                    currentModelMatrix == NULL ||
+                    !(*currentModelMatrix == drawSurface.modelMatrix)) {
+                    currentModelMatrix = &drawSurface.modelMatrix;
+                    counters.numParameterUpdates++;
+                    GL(glUniformMatrix4fv(
+                        cmd.Program.ModelMatrix.Location,
+                        1,
+                        GL_TRUE,
+                        drawSurface.modelMatrix.M[0]));
+                } else {
+                    counters.numSkippedParameterUpdates++;
+                }
 
                 if (cmd.Program.SceneMatrices.Location >= 0) {
-                    GL(glBindBufferBase(
-                        GL_UNIFORM_BUFFER,
-                        cmd.Program.SceneMatrices.Binding,
-                        SceneMatrices[sceneMatricesIdx].GetBuffer()));
+                    const int binding = cmd.Program.SceneMatrices.Binding;
+                    const GLuint buffer = SceneMatrices[sceneMatricesIdx].GetBuffer();
+                    if (binding >= 0 && binding < ovrUniform::MAX_UNIFORMS &&
+                        currentBuffers[binding] == buffer) {
+                        counters.numSkippedBufferBinds++;
+                    } else {
+                        if (binding >= 0 && binding < ovrUniform::MAX_UNIFORMS) {
+                            currentBuffers[binding] = buffer;
+                        }
+                        GL(glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer));
+                    }
                 }
             }
 
@@ -275,10 +494,23 @@ ovrDrawCounters ovrSurfaceRender::RenderSurfaceList(
             bool uniformsDone = false;
             {
                 for (int i = 0; i < ovrUniform::MAX_UNIFORMS && !uniformsDone; ++i) {
-                    counters.numParameterUpdates++;
                     const int parmLocation = cmd.Program.Uniforms[i].Location;
+                    const ovrProgramParmType parmType = cmd.Program.Uniforms[i].Type;
+
+                    // Skip values that were already uploaded to this program from the same data.
+                    if (parmType < ovrProgramParmType::TEXTURE_SAMPLED &&
+                        cmd.UniformData[i].Data != NULL) {
+                        if (currentUniformData[i] == cmd.UniformData[i].Data) {
+                            counters.numSkippedParameterUpdates++;
+                            continue;
+                        }
+                        currentUniformData[i] = cmd.UniformData[i].Data;
+                        if (parmLocation >= 0) {
+                            counters.numParameterUpdates++;
+                        }
+                    }
 
-                    switch (cmd.Program.Uniforms[i].Type) {
+                    switch (parmType) {
                         case ovrProgramParmType::INT: {
                             if (parmLocation >= 0 && cmd.UniformData[i].Data != NULL) {
                                 GL(glUniform1iv(
@@ -382,6 +614,8 @@ ovrDrawCounters ovrSurfaceRender::RenderSurfaceList(
                                     GL(glBindTexture(
                                         texture.target ? texture.target : GL_TEXTURE_2D,
                                         texture.texture));
+                                } else {
+                                    counters.numSkippedTextureBinds++;
                                 }
                             }
                         } break;
@@ -395,6 +629,8 @@ ovrDrawCounters ovrSurfaceRender::RenderSurfaceList(
                                     currentBuffers[parmBinding] = buffer.GetBuffer();
                                     GL(glBindBufferBase(
                                         GL_UNIFORM_BUFFER, parmBinding, buffer.GetBuffer()));
+                                } else {
+                                    counters.numSkippedBufferBinds++;
                                 }
                             }
                         } break;
@@ -411,11 +647,13 @@ ovrDrawCounters ovrSurfaceRender::RenderSurfaceList(
         }
 
         counters.numDrawCalls++;
+        counters.numMergedSurfaces += batch.numSurfaces - 1;
 
         if (LogRenderSurfaces) {
             ALOG(
-                "Drawing %s vao=%d vb=%d primitive=0x%04x indexCount=%d IndexType=0x%04x ",
+                "Drawing %s x%d vao=%d vb=%d primitive=0x%04x indexCount=%d IndexType=0x%04x ",
                 surfaceDef.surfaceName.c_str(),
+                batch.numSurfaces,
                 surfaceDef.geo.vertexArrayObject,
                 surfaceDef.geo.vertexBuffer,
                 surfaceDef.geo.primitiveType,
@@ -425,15 +663,21 @@ ovrDrawCounters ovrSurfaceRender::RenderSurfaceList(
 
         // Bind all the vertex and element arrays
         {
-            GL(glBindVertexArray(surfaceDef.geo.vertexArrayObject));
+            if (surfaceDef.geo.vertexArrayObject != currentVertexArrayObject) {
+                counters.numVertexArrayBinds++;
+                currentVertexArrayObject = surfaceDef.geo.vertexArrayObject;
+                GL(glBindVertexArray(surfaceDef.geo.vertexArrayObject));
+            } else {
+                counters.numSkippedVertexArrayBinds++;
+            }
 
-            if (surfaceDef.numInstances > 1) {
+            if (instanced || batch.numInstances > 1) {
                 GL(glDrawElementsInstanced(
                     surfaceDef.geo.primitiveType,
                     surfaceDef.geo.indexCount,
                     surfaceDef.geo.IndexType,
                     NULL,
-                    surfaceDef.numInstances));
+                    batch.numInstances));
             } else {
                 GL(glDrawElements(
                     surfaceDef.geo.primitiveType,
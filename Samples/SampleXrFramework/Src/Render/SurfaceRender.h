@@ -68,7 +68,14 @@ struct ovrDrawCounters {
           numProgramBinds(0),
           numParameterUpdates(0),
           numTextureBinds(0),
-          numBufferBinds(0) {}
+          numBufferBinds(0),
+          numVertexArrayBinds(0),
+          numSkippedProgramBinds(0),
+          numSkippedParameterUpdates(0),
+          numSkippedTextureBinds(0),
+          numSkippedBufferBinds(0),
+          numSkippedVertexArrayBinds(0),
+          numMergedSurfaces(0) {}
 
     int numElements;
     int numDrawCalls;
@@ -76,6 +83,22 @@ struct ovrDrawCounters {
     int numParameterUpdates; // MVP, etc
     int numTextureBinds;
     int numBufferBinds;
+    int numVertexArrayBinds;
+
+    // State changes that were elided because the bound state already matched.
+    int numSkippedProgramBinds;
+    int numSkippedParameterUpdates;
+    int numSkippedTextureBinds;
+    int numSkippedBufferBinds;
+    int numSkippedVertexArrayBinds;
+
+    // Draw surfaces that were folded into another surface's instanced draw call.
+    int numMergedSurfaces;
+};
+
+enum ovrSurfaceSortMode {
+    SURFACE_SORT_NONE, // draw surfaces in the order they are submitted
+    SURFACE_SORT_STATE // reorder runs of opaque surfaces to minimize state changes
 };
 
 struct ovrDrawSurface {
@@ -95,6 +118,27 @@ struct ovrDrawSurface {
     const ovrSurfaceDef* surface;
 };
 
+// A run of consecutive draw surfaces that share an ovrSurfaceDef whose program
+// uses InstanceMatrices, submitted with a single instanced draw call.
+// Surfaces whose program does not support it get a batch of one. A surface that
+// draws numInstances > 1 itself is never merged; if its program uses InstanceMatrices,
+// each of its instances reads its own slot, so its model matrix fills all of them.
+struct ovrInstanceBatch {
+    int firstSurface; // index into the draw order
+    int numSurfaces;
+    int numInstances; // instances in the draw call
+    int firstMatrix; // slot in the frame's instance matrix buffer, -1 if not instanced
+};
+
+// Splits the draw order into batches and assigns each instanced batch a range of
+// matrix slots, starting on a multiple of matrixAlignment. Returns the number of
+// slots used. This does not touch GL, so the merged command stream can be checked
+// without a context.
+int BuildInstanceBatches(
+    const std::vector<const ovrDrawSurface*>& drawOrder,
+    const int matrixAlignment,
+    std::vector<ovrInstanceBatch>& batches);
+
 class ovrSurfaceRender {
    public:
     ovrSurfaceRender();
@@ -104,8 +148,18 @@ class ovrSurfaceRender {
     void Init();
     void Shutdown();
 
-    // Draws a list of surfaces in order.
-    // Any sorting or culling should be performed before calling.
+    // With SURFACE_SORT_STATE, each contiguous run of opaque, depth-writing surfaces
+    // is reordered by program, texture set, uniform buffers and geometry before drawing.
+    // Blended surfaces keep their submitted position and act as barriers for the sort.
+    void SetSortMode(const ovrSurfaceSortMode mode) {
+        SortMode = mode;
+    }
+    ovrSurfaceSortMode GetSortMode() const {
+        return SortMode;
+    }
+
+    // Draws a list of surfaces in order, unless a sort mode is set.
+    // Any culling and back-to-front sorting should be performed before calling.
     ovrDrawCounters RenderSurfaceList(
         const std::vector<ovrDrawSurface>& surfaceList,
         const OVR::Matrix4f& viewMatrix,
@@ -119,6 +173,13 @@ class ovrSurfaceRender {
         const OVR::Matrix4f* projectionMatrix,
         const int numMatrices);
 
+    // Fills DrawOrder with the surfaces in state-sorted order.
+    void SortSurfaceList(const std::vector<ovrDrawSurface>& surfaceList);
+
+    // Writes the model matrices of all instanced batches to the next instance matrix
+    // UBO and returns its index.
+    int UpdateInstanceMatrices(const int numMatrices);
+
    private:
     // Use a ring-buffer to avoid rendering hazards with potential update
     // of the SceneMatrices UBO multiple times per frame.
@@ -130,6 +191,23 @@ class ovrSurfaceRender {
 
     OVR::Matrix4f CachedViewMatrix[GlProgram::MAX_VIEWS];
     OVR::Matrix4f CachedProjectionMatrix[GlProgram::MAX_VIEWS];
+
+    struct ovrSurfaceSortEntry {
+        uint64_t key;
+        int index;
+    };
+
+    // Per-instance model matrices, ring-buffered like SceneMatrices.
+    static const int MAX_INSTANCEMATRICES_UBOS = 8;
+    int CurrentInstanceMatricesIdx;
+    GlBuffer InstanceMatrices[MAX_INSTANCEMATRICES_UBOS];
+    int InstanceMatrixAlignment; // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT in matrices
+
+    ovrSurfaceSortMode SortMode;
+    // Persistent across frames to avoid per-frame allocations.
+    std::vector<ovrSurfaceSortEntry> SortEntries;
+    std::vector<const ovrDrawSurface*> DrawOrder;
+    std::vector<ovrInstanceBatch> Batches;
 };
 
 // Set this true for log spew from BuildDrawSurfaceList and RenderSurfaceList.
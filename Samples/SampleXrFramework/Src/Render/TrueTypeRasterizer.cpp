@@ -0,0 +1,576 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   TrueTypeRasterizer.cpp
+Content     :   Glyph rasterizer for TrueType fonts.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "TrueTypeRasterizer.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#include "Misc/Log.h"
+
+namespace OVRFW {
+
+// composite glyphs can nest, but not deeper than this
+static const int MAX_COMPOSITE_DEPTH = 8;
+// the largest distance of a flattened curve from the real one, in pixels
+static const float CURVE_TOLERANCE = 0.1f;
+// glyphs larger than this many times the pixel height are broken, not rendered
+static const int MAX_GLYPH_SIZE = 8;
+
+// glyf simple glyph flags
+static const uint8_t GLYF_ON_CURVE = 0x01;
+static const uint8_t GLYF_X_SHORT = 0x02;
+static const uint8_t GLYF_Y_SHORT = 0x04;
+static const uint8_t GLYF_REPEAT = 0x08;
+static const uint8_t GLYF_X_SAME_OR_POSITIVE = 0x10;
+static const uint8_t GLYF_Y_SAME_OR_POSITIVE = 0x20;
+
+// glyf composite glyph flags
+static const uint16_t GLYF_ARGS_ARE_WORDS = 0x0001;
+static const uint16_t GLYF_ARGS_ARE_XY_VALUES = 0x0002;
+static const uint16_t GLYF_HAVE_SCALE = 0x0008;
+static const uint16_t GLYF_MORE_COMPONENTS = 0x0020;
+static const uint16_t GLYF_HAVE_X_AND_Y_SCALE = 0x0040;
+static const uint16_t GLYF_HAVE_TWO_BY_TWO = 0x0080;
+
+// Big endian reads that return 0 past the end of the data, so a broken font draws garbage
+// instead of reading out of bounds.
+static uint32_t ReadU8(const std::vector<uint8_t>& data, const uint32_t offset) {
+    return (offset < data.size()) ? data[offset] : 0;
+}
+
+static uint32_t ReadU16(const std::vector<uint8_t>& data, const uint32_t offset) {
+    return (ReadU8(data, offset) << 8) | ReadU8(data, offset + 1);
+}
+
+static int32_t ReadS16(const std::vector<uint8_t>& data, const uint32_t offset) {
+    return static_cast<int16_t>(ReadU16(data, offset));
+}
+
+static uint32_t ReadU32(const std::vector<uint8_t>& data, const uint32_t offset) {
+    return (ReadU16(data, offset) << 16) | ReadU16(data, offset + 2);
+}
+
+// 2.14 fixed point
+static float ReadF2Dot14(const std::vector<uint8_t>& data, const uint32_t offset) {
+    return ReadS16(data, offset) / 16384.0f;
+}
+
+bool ovrTrueTypeRasterizer::LoadFromBuffer(std::vector<uint8_t>& buffer) {
+    Data.swap(buffer);
+    buffer.clear();
+
+    const uint32_t version = ReadU32(Data, 0);
+    if (version != 0x00010000 && version != 0x74727565) { // 1.0 or 'true'
+        ALOGW("ovrTrueTypeRasterizer: not a TrueType font, version 0x%08x", version);
+        return false;
+    }
+
+    const uint32_t head = FindTable("head");
+    const uint32_t hhea = FindTable("hhea");
+    const uint32_t maxp = FindTable("maxp");
+    Cmap = FindTable("cmap");
+    Loca = FindTable("loca");
+    Glyf = FindTable("glyf", &GlyfSize);
+    Hmtx = FindTable("hmtx");
+    if (head == 0 || hhea == 0 || maxp == 0 || Cmap == 0 || Loca == 0 || Glyf == 0 ||
+        Hmtx == 0) {
+        ALOGW("ovrTrueTypeRasterizer: missing tables, only glyf outlines are supported");
+        return false;
+    }
+
+    UnitsPerEm = ReadU16(Data, head + 18);
+    LongLoca = ReadS16(Data, head + 50) != 0;
+    NumGlyphs = ReadU16(Data, maxp + 4);
+    Ascent = ReadS16(Data, hhea + 4);
+    Descent = ReadS16(Data, hhea + 6);
+    LineGap = ReadS16(Data, hhea + 8);
+    NumHMetrics = ReadU16(Data, hhea + 34);
+    if (UnitsPerEm == 0 || NumGlyphs == 0 || NumHMetrics == 0 || Ascent - Descent <= 0) {
+        ALOGW("ovrTrueTypeRasterizer: invalid metrics");
+        return false;
+    }
+
+    // prefer the full Unicode subtable, then the basic multilingual plane
+    uint32_t bmp = 0;
+    uint32_t full = 0;
+    const uint32_t numSubtables = ReadU16(Data, Cmap + 2);
+    for (uint32_t i = 0; i < numSubtables; i++) {
+        const uint32_t record = Cmap + 4 + i * 8;
+        const uint32_t platform = ReadU16(Data, record);
+        const uint32_t encoding = ReadU16(Data, record + 2);
+        const uint32_t subtable = Cmap + ReadU32(Data, record + 4);
+        const bool unicode = platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+        if (!unicode) {
+            continue;
+        }
+        const uint32_t format = ReadU16(Data, subtable);
+        if (format == 12 && full == 0) {
+            full = subtable;
+        } else if (format == 4 && bmp == 0) {
+            bmp = subtable;
+        }
+    }
+    Cmap = (full != 0) ? full : bmp;
+    if (Cmap == 0) {
+        ALOGW("ovrTrueTypeRasterizer: no Unicode cmap of format 4 or 12");
+        return false;
+    }
+    CmapFormat = ReadU16(Data, Cmap);
+    return true;
+}
+
+uint32_t ovrTrueTypeRasterizer::FindTable(const char* tag, uint32_t* size) const {
+    const uint32_t numTables = ReadU16(Data, 4);
+    for (uint32_t i = 0; i < numTables; i++) {
+        const uint32_t record = 12 + i * 16;
+        if (record + 16 <= Data.size() && memcmp(&Data[record], tag, 4) == 0) {
+            const uint32_t offset = ReadU32(Data, record + 8);
+            const uint32_t length = ReadU32(Data, record + 12);
+            if (offset >= Data.size() || length > Data.size() - offset) {
+                return 0;
+            }
+            if (size != nullptr) {
+                *size = length;
+            }
+            return offset;
+        }
+    }
+    return 0;
+}
+
+float ovrTrueTypeRasterizer::GetScale(const int pixelHeight) const {
+    return static_cast<float>(pixelHeight) / (Ascent - Descent);
+}
+
+float ovrTrueTypeRasterizer::GetLineHeight(const int pixelHeight) const {
+    return (Ascent - Descent + LineGap) * GetScale(pixelHeight);
+}
+
+int ovrTrueTypeRasterizer::FindGlyphIndex(const uint32_t codePoint) const {
+    if (CmapFormat == 12) {
+        // sorted groups of consecutive code points
+        uint32_t low = 0;
+        uint32_t high = ReadU32(Data, Cmap + 12);
+        while (low < high) {
+            const uint32_t mid = (low + high) / 2;
+            const uint32_t group = Cmap + 16 + mid * 12;
+            const uint32_t start = ReadU32(Data, group);
+            const uint32_t end = ReadU32(Data, group + 4);
+            if (codePoint < start) {
+                high = mid;
+            } else if (codePoint > end) {
+                low = mid + 1;
+            } else {
+                return static_cast<int>(ReadU32(Data, group + 8) + codePoint - start);
+            }
+        }
+        return 0;
+    }
+    if (CmapFormat == 4 && codePoint <= 0xFFFF) {
+        // segments sorted by their end code
+        const uint32_t segCountX2 = ReadU16(Data, Cmap + 6);
+        const uint32_t endCodes = Cmap + 14;
+        const uint32_t startCodes = endCodes + segCountX2 + 2;
+        const uint32_t idDeltas = startCodes + segCountX2;
+        const uint32_t idRangeOffsets = idDeltas + segCountX2;
+        for (uint32_t seg = 0; seg < segCountX2; seg += 2) {
+            if (codePoint > ReadU16(Data, endCodes + seg)) {
+                continue;
+            }
+            const uint32_t start = ReadU16(Data, startCodes + seg);
+            if (codePoint < start) {
+                return 0;
+            }
+            const uint32_t delta = ReadU16(Data, idDeltas + seg);
+            const uint32_t rangeOffset = ReadU16(Data, idRangeOffsets + seg);
+            if (rangeOffset == 0) {
+                return static_cast<int>((codePoint + delta) & 0xFFFF);
+            }
+            // the offset is relative to where it is stored
+            const uint32_t glyph =
+                ReadU16(Data, idRangeOffsets + seg + rangeOffset + (codePoint - start) * 2);
+            return (glyph == 0) ? 0 : static_cast<int>((glyph + delta) & 0xFFFF);
+        }
+    }
+    return 0;
+}
+
+bool ovrTrueTypeRasterizer::GetGlyphRange(
+    const int glyphIndex,
+    uint32_t& offset,
+    uint32_t& size) const {
+    if (glyphIndex < 0 || glyphIndex >= NumGlyphs) {
+        return false;
+    }
+    uint32_t start;
+    uint32_t end;
+    if (LongLoca) {
+        start = ReadU32(Data, Loca + glyphIndex * 4);
+        end = ReadU32(Data, Loca + glyphIndex * 4 + 4);
+    } else {
+        start = ReadU16(Data, Loca + glyphIndex * 2) * 2;
+        end = ReadU16(Data, Loca + glyphIndex * 2 + 2) * 2;
+    }
+    if (start > end || end > GlyfSize) {
+        return false;
+    }
+    offset = Glyf + start;
+    size = end - start;
+    return true;
+}
+
+bool ovrTrueTypeRasterizer::GetGlyphOutline(
+    const int glyphIndex,
+    const float transform[6],
+    const int depth,
+    std::vector<ovrOutlinePoint>& points,
+    std::vector<int>& contourEnds) const {
+    uint32_t glyph;
+    uint32_t size;
+    if (!GetGlyphRange(glyphIndex, glyph, size)) {
+        return false;
+    }
+    if (size == 0) {
+        return true; // no outline, like a space
+    }
+
+    const int numContours = ReadS16(Data, glyph);
+    if (numContours >= 0) {
+        const uint32_t endPoints = glyph + 10;
+        const int numPoints =
+            (numContours > 0) ? ReadU16(Data, endPoints + (numContours - 1) * 2) + 1 : 0;
+        const uint32_t instructionLength = ReadU16(Data, endPoints + numContours * 2);
+        uint32_t p = endPoints + numContours * 2 + 2 + instructionLength;
+        if (p + numPoints > glyph + size) {
+            return false;
+        }
+
+        // flags are run length encoded, then come the x and y deltas
+        std::vector<uint8_t> flags(numPoints);
+        for (int i = 0; i < numPoints;) {
+            const uint8_t flag = static_cast<uint8_t>(ReadU8(Data, p++));
+            flags[i++] = flag;
+            if (flag & GLYF_REPEAT) {
+                for (uint32_t repeat = ReadU8(Data, p++); repeat > 0 && i < numPoints; repeat--) {
+                    flags[i++] = flag;
+                }
+            }
+        }
+        std::vector<int> x(numPoints);
+        int value = 0;
+        for (int i = 0; i < numPoints; i++) {
+            if (flags[i] & GLYF_X_SHORT) {
+                const int delta = ReadU8(Data, p++);
+                value += (flags[i] & GLYF_X_SAME_OR_POSITIVE) ? delta : -delta;
+            } else if (!(flags[i] & GLYF_X_SAME_OR_POSITIVE)) {
+                value += ReadS16(Data, p);
+                p += 2;
+            }
+            x[i] = value;
+        }
+        value = 0;
+        const size_t firstPoint = points.size();
+        for (int i = 0; i < numPoints; i++) {
+            if (flags[i] & GLYF_Y_SHORT) {
+                const int delta = ReadU8(Data, p++);
+                value += (flags[i] & GLYF_Y_SAME_OR_POSITIVE) ? delta : -delta;
+            } else if (!(flags[i] & GLYF_Y_SAME_OR_POSITIVE)) {
+                value += ReadS16(Data, p);
+                p += 2;
+            }
+            ovrOutlinePoint point;
+            point.X = transform[0] * x[i] + transform[2] * value + transform[4];
+            point.Y = transform[1] * x[i] + transform[3] * value + transform[5];
+            point.OnCurve = (flags[i] & GLYF_ON_CURVE) != 0;
+            points.push_back(point);
+        }
+        for (int i = 0; i < numContours; i++) {
+            const int end = ReadU16(Data, endPoints + i * 2) + 1;
+            if (end > numPoints) {
+                return false;
+            }
+            contourEnds.push_back(static_cast<int>(firstPoint) + end);
+        }
+        return true;
+    }
+
+    // a composite glyph places transformed copies of other glyphs
+    if (depth >= MAX_COMPOSITE_DEPTH) {
+        return false;
+    }
+    uint32_t p = glyph + 10;
+    for (;;) {
+        const uint32_t flags = ReadU16(Data, p);
+        const int component = ReadU16(Data, p + 2);
+        p += 4;
+        float dx = 0.0f;
+        float dy = 0.0f;
+        if (flags & GLYF_ARGS_ARE_WORDS) {
+            dx = static_cast<float>(ReadS16(Data, p));
+            dy = static_cast<float>(ReadS16(Data, p + 2));
+            p += 4;
+        } else {
+            dx = static_cast<float>(static_cast<int8_t>(ReadU8(Data, p)));
+            dy = static_cast<float>(static_cast<int8_t>(ReadU8(Data, p + 1)));
+            p += 2;
+        }
+        if (!(flags & GLYF_ARGS_ARE_XY_VALUES)) {
+            // matching points are not supported, the component is placed at the origin
+            dx = 0.0f;
+            dy = 0.0f;
+        }
+        float m[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+        if (flags & GLYF_HAVE_SCALE) {
+            m[0] = m[3] = ReadF2Dot14(Data, p);
+            p += 2;
+        } else if (flags & GLYF_HAVE_X_AND_Y_SCALE) {
+            m[0] = ReadF2Dot14(Data, p);
+            m[3] = ReadF2Dot14(Data, p + 2);
+            p += 4;
+        } else if (flags & GLYF_HAVE_TWO_BY_TWO) {
+            m[0] = ReadF2Dot14(Data, p);
+            m[1] = ReadF2Dot14(Data, p + 2);
+            m[2] = ReadF2Dot14(Data, p + 4);
+            m[3] = ReadF2Dot14(Data, p + 6);
+            p += 8;
+        }
+        // the component transform is applied before the one of the parent
+        const float t[6] = {
+            transform[0] * m[0] + transform[2] * m[1],
+            transform[1] * m[0] + transform[3] * m[1],
+            transform[0] * m[2] + transform[2] * m[3],
+            transform[1] * m[2] + transform[3] * m[3],
+            transform[0] * dx + transform[2] * dy + transform[4],
+            transform[1] * dx + transform[3] * dy + transform[5]};
+        if (!GetGlyphOutline(component, t, depth + 1, points, contourEnds)) {
+            return false;
+        }
+        if (!(flags & GLYF_MORE_COMPONENTS) || p >= glyph + size) {
+            return true;
+        }
+    }
+}
+
+// Adds the signed area that the line covers to the pixels of each row it crosses, so the
+// running sum along the rows is the coverage of the outline (as in font-rs by Raph Levien).
+// The points are in [0, width] x [0, height], accumulation has width * height + 2 entries.
+static void AccumulateLine(
+    float* accumulation,
+    const int width,
+    const int height,
+    float x0,
+    float y0,
+    float x1,
+    float y1) {
+    if (fabsf(y0 - y1) <= 1e-6f) {
+        return;
+    }
+    float dir = 1.0f;
+    if (y0 > y1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+        dir = -1.0f;
+    }
+    const float dxdy = (x1 - x0) / (y1 - y0);
+    const int yEnd = std::min(height, static_cast<int>(ceilf(y1)));
+    float x = x0;
+    for (int y = static_cast<int>(y0); y < yEnd; y++) {
+        float* row = accumulation + y * width;
+        const float dy =
+            std::min(static_cast<float>(y + 1), y1) - std::max(static_cast<float>(y), y0);
+        const float xNext = x + dxdy * dy;
+        const float d = dy * dir;
+        const float left = std::min(x, xNext);
+        const float right = std::max(x, xNext);
+        const float leftFloor = floorf(left);
+        const int leftPixel = static_cast<int>(leftFloor);
+        const float rightCeil = ceilf(right);
+        const int rightPixel = static_cast<int>(rightCeil);
+        if (rightPixel <= leftPixel + 1) {
+            // within a single pixel
+            const float fraction = 0.5f * (x + xNext) - leftFloor;
+            row[leftPixel] += d - d * fraction;
+            row[leftPixel + 1] += d * fraction;
+        } else {
+            const float slope = 1.0f / (right - left);
+            const float leftFraction = left - leftFloor;
+            const float areaLeft = 0.5f * slope * (1.0f - leftFraction) * (1.0f - leftFraction);
+            const float rightFraction = right - rightCeil + 1.0f;
+            const float areaRight = 0.5f * slope * rightFraction * rightFraction;
+            row[leftPixel] += d * areaLeft;
+            if (rightPixel == leftPixel + 2) {
+                row[leftPixel + 1] += d * (1.0f - areaLeft - areaRight);
+            } else {
+                const float area1 = slope * (1.5f - leftFraction);
+                row[leftPixel + 1] += d * (area1 - areaLeft);
+                for (int px = leftPixel + 2; px < rightPixel - 1; px++) {
+                    row[px] += d * slope;
+                }
+                const float area2 = area1 + (rightPixel - leftPixel - 3) * slope;
+                row[rightPixel - 1] += d * (1.0f - area2 - areaRight);
+            }
+            row[rightPixel] += d * areaRight;
+        }
+        x = xNext;
+    }
+}
+
+bool ovrTrueTypeRasterizer::RasterizeGlyph(
+    const uint32_t codePoint,
+    const int pixelHeight,
+    ovrGlyphBitmap& bitmap) const {
+    bitmap = ovrGlyphBitmap();
+    const int glyphIndex = FindGlyphIndex(codePoint);
+    if (glyphIndex == 0) {
+        return false;
+    }
+
+    const float scale = GetScale(pixelHeight);
+    const int metric = std::min(glyphIndex, NumHMetrics - 1);
+    bitmap.AdvanceX = ReadU16(Data, Hmtx + metric * 4) * scale;
+
+    // in pixels with y down, so the rows of the bitmap go from the top
+    const float transform[6] = {scale, 0.0f, 0.0f, -scale, 0.0f, 0.0f};
+    std::vector<ovrOutlinePoint> points;
+    std::vector<int> contourEnds;
+    if (!GetGlyphOutline(glyphIndex, transform, 0, points, contourEnds)) {
+        ALOGW("ovrTrueTypeRasterizer: invalid outline for glyph %d", glyphIndex);
+        return false;
+    }
+    if (points.empty()) {
+        return true;
+    }
+
+    // the control points bound the curves
+    float minX = points[0].X;
+    float minY = points[0].Y;
+    float maxX = minX;
+    float maxY = minY;
+    for (const ovrOutlinePoint& point : points) {
+        minX = std::min(minX, point.X);
+        minY = std::min(minY, point.Y);
+        maxX = std::max(maxX, point.X);
+        maxY = std::max(maxY, point.Y);
+    }
+    const float maxSize = static_cast<float>(MAX_GLYPH_SIZE * pixelHeight);
+    if (maxX - minX > maxSize || maxY - minY > maxSize) {
+        ALOGW("ovrTrueTypeRasterizer: glyph %d is too large", glyphIndex);
+        return false;
+    }
+    const int left = static_cast<int>(floorf(minX));
+    const int top = static_cast<int>(floorf(minY));
+    const int width = static_cast<int>(ceilf(maxX)) - left;
+    const int height = static_cast<int>(ceilf(maxY)) - top;
+    if (width <= 0 || height <= 0) {
+        return true;
+    }
+
+    std::vector<float> accumulation(width * height + 2, 0.0f);
+    auto line = [&](const float ax, const float ay, const float bx, const float by) {
+        AccumulateLine(
+            accumulation.data(),
+            width,
+            height,
+            std::clamp(ax - left, 0.0f, static_cast<float>(width)),
+            std::clamp(ay - top, 0.0f, static_cast<float>(height)),
+            std::clamp(bx - left, 0.0f, static_cast<float>(width)),
+            std::clamp(by - top, 0.0f, static_cast<float>(height)));
+    };
+
+    // Walks each contour as lines and quadratic curves. Two off curve points in a row imply an
+    // on curve point half way between them.
+    std::vector<ovrOutlinePoint> contour;
+    int contourStart = 0;
+    for (const int contourEnd : contourEnds) {
+        const int n = contourEnd - contourStart;
+        contour.clear();
+        for (int i = 0; i < n; i++) {
+            const ovrOutlinePoint& cur = points[contourStart + i];
+            const ovrOutlinePoint& next = points[contourStart + (i + 1) % n];
+            contour.push_back(cur);
+            if (!cur.OnCurve && !next.OnCurve) {
+                contour.push_back({(cur.X + next.X) * 0.5f, (cur.Y + next.Y) * 0.5f, true});
+            }
+        }
+        contourStart = contourEnd;
+        const auto first = std::find_if(contour.begin(), contour.end(), [](const auto& point) {
+            return point.OnCurve;
+        });
+        if (n < 2 || first == contour.end()) {
+            continue;
+        }
+        std::rotate(contour.begin(), first, contour.end());
+        contour.push_back(contour[0]); // close the contour
+
+        ovrOutlinePoint pen = contour[0];
+        for (size_t i = 1; i < contour.size(); i++) {
+            if (contour[i].OnCurve) {
+                line(pen.X, pen.Y, contour[i].X, contour[i].Y);
+                pen = contour[i];
+                continue;
+            }
+            // an off curve point is always followed by an on curve one
+            const ovrOutlinePoint& control = contour[i];
+            const ovrOutlinePoint& end = contour[++i];
+            const float ddx = pen.X - 2.0f * control.X + end.X;
+            const float ddy = pen.Y - 2.0f * control.Y + end.Y;
+            // a segment of 1 / n of the curve is at most |dd| / ( 4 * n^2 ) from its chord
+            const float dd = sqrtf(ddx * ddx + ddy * ddy);
+            const int segments =
+                std::clamp(static_cast<int>(ceilf(sqrtf(dd / (4.0f * CURVE_TOLERANCE)))), 1, 32);
+            float prevX = pen.X;
+            float prevY = pen.Y;
+            for (int s = 1; s <= segments; s++) {
+                const float t = static_cast<float>(s) / segments;
+                const float u = 1.0f - t;
+                const float px = u * u * pen.X + 2.0f * u * t * control.X + t * t * end.X;
+                const float py = u * u * pen.Y + 2.0f * u * t * control.Y + t * t * end.Y;
+                line(prevX, prevY, px, py);
+                prevX = px;
+                prevY = py;
+            }
+            pen = end;
+        }
+    }
+
+    bitmap.Width = width;
+    bitmap.Height = height;
+    bitmap.BearingX = static_cast<float>(left);
+    bitmap.BearingY = static_cast<float>(-top);
+    bitmap.Coverage.resize(width * height);
+    float sum = 0.0f;
+    for (int i = 0; i < width * height; i++) {
+        sum += accumulation[i];
+        const float coverage = std::min(fabsf(sum), 1.0f);
+        bitmap.Coverage[i] = static_cast<uint8_t>(coverage * 255.0f + 0.5f);
+    }
+    return true;
+}
+
+} // namespace OVRFW
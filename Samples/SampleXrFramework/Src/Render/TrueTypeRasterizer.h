@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   TrueTypeRasterizer.h
+Content     :   Glyph rasterizer for TrueType fonts.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "SdfGlyphAtlas.h"
+
+namespace OVRFW {
+
+// Rasterizes the quadratic outlines of a TrueType font (.ttf) for
+// BitmapFont::LoadFromRasterizer(). Only the tables needed for the outlines and horizontal
+// metrics are read: cmap formats 4 and 12, simple and composite glyf outlines. CFF based
+// OpenType fonts and hinting are not supported. Coverage is the exact area of each pixel
+// inside the outline, which is what the distance field is generated from.
+class ovrTrueTypeRasterizer : public ovrGlyphRasterizer {
+   public:
+    ovrTrueTypeRasterizer()
+        : UnitsPerEm(0),
+          NumGlyphs(0),
+          NumHMetrics(0),
+          Ascent(0),
+          Descent(0),
+          LineGap(0),
+          LongLoca(false),
+          Cmap(0),
+          CmapFormat(0),
+          Loca(0),
+          Glyf(0),
+          GlyfSize(0),
+          Hmtx(0) {}
+
+    // Takes the contents of the font file, buffer is left empty. Returns false if the font
+    // cannot be used.
+    bool LoadFromBuffer(std::vector<uint8_t>& buffer);
+
+    virtual float GetLineHeight(const int pixelHeight) const;
+    virtual bool RasterizeGlyph(
+        const uint32_t codePoint,
+        const int pixelHeight,
+        ovrGlyphBitmap& bitmap) const;
+
+    // Font units to pixels, the ascent to descent height of the font is pixelHeight.
+    float GetScale(const int pixelHeight) const;
+    // Returns 0, the missing glyph, if the font has no glyph for the code point.
+    int FindGlyphIndex(const uint32_t codePoint) const;
+
+   private:
+    struct ovrOutlinePoint {
+        float X;
+        float Y;
+        bool OnCurve;
+    };
+
+    std::vector<uint8_t> Data;
+    int UnitsPerEm;
+    int NumGlyphs;
+    int NumHMetrics;
+    int Ascent;
+    int Descent; // negative below the baseline
+    int LineGap;
+    bool LongLoca;
+    uint32_t Cmap; // offset of the subtable that is used
+    int CmapFormat;
+    uint32_t Loca;
+    uint32_t Glyf;
+    uint32_t GlyfSize;
+    uint32_t Hmtx;
+
+    uint32_t FindTable(const char* tag, uint32_t* size = nullptr) const;
+    bool GetGlyphRange(const int glyphIndex, uint32_t& offset, uint32_t& size) const;
+    // Appends the outline of the glyph in font units, contourEnds holds one past the last point
+    // of each contour.
+    bool GetGlyphOutline(
+        const int glyphIndex,
+        const float transform[6],
+        const int depth,
+        std::vector<ovrOutlinePoint>& points,
+        std::vector<int>& contourEnds) const;
+};
+
+} // namespace OVRFW
@@ -35,6 +35,8 @@ Language    :   c++
 #include <unistd.h>
 #include <pthread.h>
 #include <sys/prctl.h> // for prctl( PR_SET_NAME )
+#include <sys/system_properties.h>
+#include "JniUtils.h"
 #elif defined(WIN32)
 // Favor the high performance NVIDIA or AMD GPUs
 extern "C" {
@@ -245,6 +247,7 @@ void XrApp::HandleXrEvents() {
                 break;
             case XR_TYPE_EVENT_DATA_INTERACTION_PROFILE_CHANGED:
                 ALOGV("xrPollEvent: received XR_TYPE_EVENT_DATA_INTERACTION_PROFILE_CHANGED event");
+                RefreshInteractionProfiles();
                 break;
             case XR_TYPE_EVENT_DATA_PERF_SETTINGS_EXT: {
                 const XrEventDataPerfSettingsEXT* perf_settings_event =
@@ -273,6 +276,7 @@ void XrApp::HandleXrEvents() {
                 switch (session_state_changed_event->state) {
                     case XR_SESSION_STATE_FOCUSED:
                         Focused = true;
+                        RefreshInteractionProfiles();
                         break;
                     case XR_SESSION_STATE_VISIBLE:
                         Focused = false;
@@ -404,6 +408,8 @@ std::vector<const char*> XrApp::GetExtensions() {
 #if defined(XR_USE_PLATFORM_ANDROID)
         XR_EXT_PERFORMANCE_SETTINGS_EXTENSION_NAME,
         XR_KHR_ANDROID_THREAD_SETTINGS_EXTENSION_NAME,
+#elif defined(XR_USE_PLATFORM_EGL)
+        XR_MNDX_EGL_ENABLE_EXTENSION_NAME,
 #endif // defined(XR_USE_PLATFORM_ANDROID)
         XR_KHR_COMPOSITION_LAYER_CUBE_EXTENSION_NAME,
         XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME};
@@ -895,30 +901,45 @@ bool XrApp::Init(const xrJava& context) {
     }
     SurfaceRender.Init();
 
-    return AppInit(&context);
+    if (!AppInit(&context)) {
+        return false;
+    }
+    if (SortSurfacesByState) {
+        SurfaceRender.SetSortMode(OVRFW::SURFACE_SORT_STATE);
+    }
+    return true;
 }
 
 bool XrApp::InitSession() {
     // Create the OpenXR Session.
     const void* nextChain = GetSessionCreateInfoNextChain();
 
-#if defined(XR_USE_GRAPHICS_API_OPENGL_ES)
+#if defined(XR_USE_PLATFORM_ANDROID)
     XrGraphicsBindingOpenGLESAndroidKHR graphicsBindingAndroidGLES = {
         XR_TYPE_GRAPHICS_BINDING_OPENGL_ES_ANDROID_KHR};
     graphicsBindingAndroidGLES.next = nextChain;
     graphicsBindingAndroidGLES.display = Egl.Display;
     graphicsBindingAndroidGLES.config = Egl.Config;
     graphicsBindingAndroidGLES.context = Egl.Context;
+#elif defined(XR_USE_PLATFORM_EGL)
+    XrGraphicsBindingEGLMNDX graphicsBindingEGL = {XR_TYPE_GRAPHICS_BINDING_EGL_MNDX};
+    graphicsBindingEGL.next = nextChain;
+    graphicsBindingEGL.getProcAddress = (PFN_xrEglGetProcAddressMNDX)eglGetProcAddress;
+    graphicsBindingEGL.display = Egl.Display;
+    graphicsBindingEGL.config = Egl.Config;
+    graphicsBindingEGL.context = Egl.Context;
 #elif defined(XR_USE_GRAPHICS_API_OPENGL)
     XrGraphicsBindingOpenGLWin32KHR graphicsBindingGL = {XR_TYPE_GRAPHICS_BINDING_OPENGL_WIN32_KHR};
     graphicsBindingGL.next = nextChain;
     graphicsBindingGL.hDC = Egl.hDC;
     graphicsBindingGL.hGLRC = Egl.hGLRC;
-#endif // defined(XR_USE_GRAPHICS_API_OPENGL_ES)
+#endif // defined(XR_USE_PLATFORM_ANDROID)
 
     XrSessionCreateInfo sessionCreateInfo = {XR_TYPE_SESSION_CREATE_INFO};
-#if defined(XR_USE_GRAPHICS_API_OPENGL_ES)
+#if defined(XR_USE_PLATFORM_ANDROID)
     sessionCreateInfo.next = &graphicsBindingAndroidGLES;
+#elif defined(XR_USE_PLATFORM_EGL)
+    sessionCreateInfo.next = &graphicsBindingEGL;
 #elif defined(XR_USE_GRAPHICS_API_OPENGL)
     sessionCreateInfo.next = &graphicsBindingGL;
 #endif
@@ -1073,6 +1094,7 @@ bool XrApp::InitSession() {
             ViewConfigurationView[0].recommendedImageRectHeight * FramebufferResolutionScaleFactor,
             NUM_MULTI_SAMPLES);
     }
+    GpuTimer.Init();
 
     // xrAttachSessionActionSets can only be called once, so skip it if the application
     // is doing it manually
@@ -1088,6 +1110,7 @@ void XrApp::EndSession() {
     for (int eye = 0; eye < MAX_NUM_EYES; eye++) {
         ovrFramebuffer_Destroy(&FrameBuffer[eye]);
     }
+    GpuTimer.Shutdown();
 
     OXR(xrDestroySpace(HeadSpace));
     OXR(xrDestroySpace(LocalSpace));
@@ -1164,6 +1187,10 @@ void XrApp::Clear() {
     RightControllerGripSpace = XR_NULL_HANDLE;
     LastFrameAllButtons = 0u;
     LastFrameAllTouches = 0u;
+    HandInteractionProfile[0] = XR_NULL_PATH;
+    HandInteractionProfile[1] = XR_NULL_PATH;
+    InteractionProfilesKnown = false;
+    Input = {};
 }
 
 // Internal Input
@@ -1175,80 +1202,44 @@ void XrApp::AttachActionSets() {
 }
 
 void XrApp::SyncActionSets(ovrApplFrameIn& in) {
-    // sync action data
-    XrActiveActionSet activeActionSet{BaseActionSet};
-    XrActionsSyncInfo syncInfo{XR_TYPE_ACTIONS_SYNC_INFO};
-    syncInfo.countActiveActionSets = 1;
-    syncInfo.activeActionSets = &activeActionSet;
-    OXR(xrSyncActions(Session, &syncInfo));
-
-    // query input action states
-    XrActionStateGetInfo getInfo = {XR_TYPE_ACTION_STATE_GET_INFO};
-    getInfo.subactionPath = XR_NULL_PATH;
-
-    XrAction controller[] = {AimPoseAction, GripPoseAction, AimPoseAction, GripPoseAction};
-    XrPath subactionPath[] = {LeftHandPath, LeftHandPath, RightHandPath, RightHandPath};
-    XrSpace controllerSpace[] = {
-        LeftControllerAimSpace,
-        LeftControllerGripSpace,
-        RightControllerAimSpace,
-        RightControllerGripSpace,
-    };
-    bool ControllerPoseActive[] = {false, false, false, false};
-    XrPosef ControllerPose[] = {{}, {}, {}, {}};
-    for (int i = 0; i < 4; i++) {
-        if (ActionPoseIsActive(controller[i], subactionPath[i])) {
-            LocVel lv = GetSpaceLocVel(controllerSpace[i], ToXrTime(in.PredictedDisplayTime));
-            ControllerPoseActive[i] =
-                (lv.loc.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0;
-            ControllerPose[i] = lv.loc.pose;
-        } else {
-            ControllerPoseActive[i] = false;
-            XrPosef_CreateIdentity(&ControllerPose[i]);
-        }
-    }
+    // sync and query input action states
+    ReadInputSnapshot(ToXrTime(in.PredictedDisplayTime), Input);
 
-#if 0 // Enable for debugging current interaction profile issues
-    XrPath topLevelUserPath = XR_NULL_PATH;
-    OXR(xrStringToPath(Instance, "/user/hand/left", &topLevelUserPath));
-    XrInteractionProfileState ipState{XR_TYPE_INTERACTION_PROFILE_STATE};
-    xrGetCurrentInteractionProfile(Session, topLevelUserPath, &ipState);
-    uint32_t ipPathOutSize = 0;
-    char ipPath[256];
-    xrPathToString(Instance, ipState.interactionProfile, sizeof(ipPath), &ipPathOutSize, ipPath);
-    ALOG( "Current interaction profile is: '%s'", ipPath);
-#endif
+    const auto controllerPose = [](const XrSpaceLocation& loc) {
+        XrPosef pose = loc.pose;
+        if (loc.locationFlags == 0) {
+            XrPosef_CreateIdentity(&pose);
+        }
+        return FromXrPosef(pose);
+    };
+    const auto controllerTracked = [](const XrSpaceLocation& loc) {
+        return (loc.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0;
+    };
 
     /// Update pose
-    XrSpaceLocation loc = {XR_TYPE_SPACE_LOCATION};
-    OXR(xrLocateSpace(HeadSpace, CurrentSpace, ToXrTime(in.PredictedDisplayTime), &loc));
-    in.HeadPose = FromXrPosef(loc.pose);
+    in.HeadPose = FromXrPosef(Input.HeadLocation.pose);
     /// grip & point space
-    in.LeftRemotePointPose = FromXrPosef(ControllerPose[0]);
-    in.LeftRemotePose = FromXrPosef(ControllerPose[1]);
-    in.RightRemotePointPose = FromXrPosef(ControllerPose[2]);
-    in.RightRemotePose = FromXrPosef(ControllerPose[3]);
-    in.LeftRemoteTracked = ControllerPoseActive[1];
-    in.RightRemoteTracked = ControllerPoseActive[3];
-
-    in.LeftRemoteIndexTrigger = GetActionStateFloat(IndexTriggerAction, LeftHandPath).currentState;
-    in.RightRemoteIndexTrigger =
-        GetActionStateFloat(IndexTriggerAction, RightHandPath).currentState;
-    in.LeftRemoteGripTrigger = GetActionStateFloat(GripTriggerAction, LeftHandPath).currentState;
-    in.RightRemoteGripTrigger = GetActionStateFloat(GripTriggerAction, RightHandPath).currentState;
-    in.LeftRemoteJoystick =
-        FromXrVector2f(GetActionStateVector2(JoystickAction, LeftHandPath).currentState);
-    in.RightRemoteJoystick =
-        FromXrVector2f(GetActionStateVector2(JoystickAction, RightHandPath).currentState);
-
-    bool aPressed = GetActionStateBoolean(ButtonAAction).currentState;
-    bool bPressed = GetActionStateBoolean(ButtonBAction).currentState;
-    bool xPressed = GetActionStateBoolean(ButtonXAction).currentState;
-    bool yPressed = GetActionStateBoolean(ButtonYAction).currentState;
-    bool menuPressed = GetActionStateBoolean(ButtonMenuAction).currentState;
-    bool leftThumbPressed = GetActionStateBoolean(thumbstickClickAction, LeftHandPath).currentState;
-    bool rightThumbPressed =
-        GetActionStateBoolean(thumbstickClickAction, RightHandPath).currentState;
+    in.LeftRemotePointPose = controllerPose(Input.AimLocation[0]);
+    in.LeftRemotePose = controllerPose(Input.GripLocation[0]);
+    in.RightRemotePointPose = controllerPose(Input.AimLocation[1]);
+    in.RightRemotePose = controllerPose(Input.GripLocation[1]);
+    in.LeftRemoteTracked = controllerTracked(Input.GripLocation[0]);
+    in.RightRemoteTracked = controllerTracked(Input.GripLocation[1]);
+
+    in.LeftRemoteIndexTrigger = Input.IndexTrigger[0];
+    in.RightRemoteIndexTrigger = Input.IndexTrigger[1];
+    in.LeftRemoteGripTrigger = Input.GripTrigger[0];
+    in.RightRemoteGripTrigger = Input.GripTrigger[1];
+    in.LeftRemoteJoystick = FromXrVector2f(Input.Joystick[0]);
+    in.RightRemoteJoystick = FromXrVector2f(Input.Joystick[1]);
+
+    const bool aPressed = Input.ButtonA;
+    const bool bPressed = Input.ButtonB;
+    const bool xPressed = Input.ButtonX;
+    const bool yPressed = Input.ButtonY;
+    const bool menuPressed = Input.ButtonMenu;
+    const bool leftThumbPressed = Input.ThumbstickClick[0];
+    const bool rightThumbPressed = Input.ThumbstickClick[1];
 
     in.LastFrameAllButtons = LastFrameAllButtons;
     in.AllButtons = 0u;
@@ -1292,9 +1283,9 @@ void XrApp::SyncActionSets(ovrApplFrameIn& in) {
     in.LastFrameAllTouches = LastFrameAllTouches;
     in.AllTouches = 0u;
 
-    const bool thumbstickTouched = GetActionStateBoolean(ThumbStickTouchAction).currentState;
-    const bool thumbrestTouched = GetActionStateBoolean(ThumbRestTouchAction).currentState;
-    const bool triggerTouched = GetActionStateBoolean(TriggerTouchAction).currentState;
+    const bool thumbstickTouched = Input.ThumbstickTouch;
+    const bool thumbrestTouched = Input.ThumbRestTouch;
+    const bool triggerTouched = Input.TriggerTouch;
 
     if (thumbstickTouched) {
         in.AllTouches |= ovrApplFrameIn::kTouchJoystick;
@@ -1319,18 +1310,75 @@ void XrApp::SyncActionSets(ovrApplFrameIn& in) {
     */
 }
 
+void XrApp::ReadInputSnapshot(const XrTime time, InputSnapshot& snapshot) {
+    const bool handBound[] = {IsHandBound(0), IsHandBound(1)};
+    ReadXrInputSnapshot(GetInputHandles(), time, handBound, snapshot);
+}
+
+OVRFW::ovrXrInputHandles XrApp::GetInputHandles() const {
+    OVRFW::ovrXrInputHandles handles;
+    handles.Instance = Instance;
+    handles.Session = Session;
+    handles.ActionSet = BaseActionSet;
+    handles.BaseSpace = CurrentSpace;
+    handles.HeadSpace = HeadSpace;
+    handles.HandPath[0] = LeftHandPath;
+    handles.HandPath[1] = RightHandPath;
+    handles.AimSpace[0] = LeftControllerAimSpace;
+    handles.AimSpace[1] = RightControllerAimSpace;
+    handles.GripSpace[0] = LeftControllerGripSpace;
+    handles.GripSpace[1] = RightControllerGripSpace;
+    handles.IndexTrigger = IndexTriggerAction;
+    handles.GripTrigger = GripTriggerAction;
+    handles.Joystick = JoystickAction;
+    handles.ThumbstickClick = thumbstickClickAction;
+    handles.ButtonA = ButtonAAction;
+    handles.ButtonB = ButtonBAction;
+    handles.ButtonX = ButtonXAction;
+    handles.ButtonY = ButtonYAction;
+    handles.ButtonMenu = ButtonMenuAction;
+    handles.ThumbstickTouch = ThumbStickTouchAction;
+    handles.ThumbRestTouch = ThumbRestTouchAction;
+    handles.TriggerTouch = TriggerTouchAction;
+    return handles;
+}
+
+void XrApp::RefreshInteractionProfiles() {
+    if (SkipInputHandling || Session == XR_NULL_HANDLE) {
+        return;
+    }
+    // keep querying every action until the runtime answers
+    InteractionProfilesKnown =
+        QueryXrInteractionProfiles(GetInputHandles(), HandInteractionProfile);
+}
+
 void XrApp::HandleInput(ovrApplFrameIn& in) {
     if (!SkipInputHandling) {
+        ovrScopedFramePhase phase(FrameTiming, FRAME_PHASE_INPUT);
         // Sync default actions
         SyncActionSets(in);
     }
 
     // Call application Update function
+    ovrScopedFramePhase phase(FrameTiming, FRAME_PHASE_UPDATE);
     Update(in);
 }
 
 // Called once per frame to allow the application to render eye buffers.
 void XrApp::AppRenderFrame(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out) {
+    {
+        ovrScopedFramePhase phase(FrameTiming, FRAME_PHASE_UPDATE);
+        AppSimulateFrame(in, out);
+    }
+    ovrScopedFramePhase phase(FrameTiming, FRAME_PHASE_RENDER);
+    if (ShouldRender) {
+        Render(in, out);
+    }
+    RenderFrame(in, out);
+}
+
+// Called once per frame after Update() to advance the scene.
+void XrApp::AppSimulateFrame(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out) {
     Scene.SetFreeMove(FreeMove);
     /// create a local copy
     OVRFW::ovrApplFrameIn localIn = in;
@@ -1342,10 +1390,10 @@ void XrApp::AppRenderFrame(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOu
     }
     Scene.Frame(localIn);
     Scene.GenerateFrameSurfaceList(out.FrameMatrices, out.Surfaces);
-    if (ShouldRender) {
-        Render(in, out);
-    }
+}
 
+void XrApp::RenderFrame(const ovrApplFrameIn& in, ovrRendererOutput& out) {
+    GpuTimer.Begin();
     for (int eye = 0; eye < MAX_NUM_EYES; eye++) {
         ovrFramebuffer* frameBuffer = &FrameBuffer[eye];
         ovrFramebuffer_Acquire(frameBuffer);
@@ -1358,6 +1406,7 @@ void XrApp::AppRenderFrame(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOu
         ovrFramebuffer_Release(frameBuffer);
     }
     ovrFramebuffer_SetNone();
+    GpuTimer.End();
 }
 
 void XrApp::AppRenderEye(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out, int eye) {
@@ -1418,6 +1467,138 @@ void XrApp::Update(const ovrApplFrameIn& in) {}
 
 void XrApp::Render(const ovrApplFrameIn& in, ovrRendererOutput& out) {}
 
+// Starts simulating the frame that was just begun and renders the one simulated before it.
+void XrApp::RenderPipelinedFrame(const ovrApplFrameIn& in, const ovrRendererOutput& out) {
+    // The simulation thread is idle, so this is where world model loads are finished: they
+    // need GL and change the scene that the next simulation reads. Models replaced here are
+    // freed by the next call, once the frame rendered below no longer draws them.
+    Scene.UpdateWorldModelLoads();
+
+    // Render with the views this frame was begun with, which are newer than the simulated ones.
+    ovrFramePipeline::ovrFrame& frame = SimulationPipeline.Advance(in, out);
+    frame.In.HeadPose = in.HeadPose;
+    for (int eye = 0; eye < MAX_NUM_EYES; eye++) {
+        frame.In.Eye[eye] = in.Eye[eye];
+    }
+    frame.Out.FrameMatrices = out.FrameMatrices;
+
+    ovrScopedFramePhase phase(FrameTiming, FRAME_PHASE_RENDER);
+    if (ShouldRender) {
+        Render(frame.In, frame.Out);
+    }
+    RenderFrame(frame.In, frame.Out);
+}
+
+#if defined(ANDROID)
+// The string extra of the intent the activity was started with, false if there is none or the
+// context is not an activity.
+static bool GetIntentStringExtra(const xrJava& context, const char* name, std::string& value) {
+    JNIEnv* jni = context.Env;
+    if (jni == nullptr || context.ActivityObject == nullptr) {
+        return false;
+    }
+    JavaClass activityClass(jni, jni->GetObjectClass(context.ActivityObject));
+    const jmethodID getIntentMethod =
+        jni->GetMethodID(activityClass.GetJClass(), "getIntent", "()Landroid/content/Intent;");
+    if (getIntentMethod == 0) {
+        jni->ExceptionClear();
+        return false;
+    }
+    JavaObject intent(jni, jni->CallObjectMethod(context.ActivityObject, getIntentMethod));
+    if (intent.GetJObject() == 0) {
+        return false;
+    }
+    JavaClass intentClass(jni, jni->GetObjectClass(intent.GetJObject()));
+    const jmethodID getStringExtraMethod = jni->GetMethodID(
+        intentClass.GetJClass(), "getStringExtra", "(Ljava/lang/String;)Ljava/lang/String;");
+    if (getStringExtraMethod == 0) {
+        jni->ExceptionClear();
+        return false;
+    }
+    JavaString key(jni, name);
+    const jstring extra = static_cast<jstring>(
+        jni->CallObjectMethod(intent.GetJObject(), getStringExtraMethod, key.GetJString()));
+    if (extra == 0) {
+        return false;
+    }
+    value = JavaUTFChars(jni, extra).ToStr();
+    return true;
+}
+#endif // defined(ANDROID)
+
+// Reads a benchmark setting that overrides the one of the app. Apps started by the system on
+// Android do not see the environment of the shell, so there it is a string extra of the launch
+// intent, or else a debug.xrapp.<name> system property:
+//   adb shell am start -n <package>/<activity> --es benchmark_frames 500
+//   adb shell setprop debug.xrapp.benchmark_frames 500
+// Elsewhere it is the environment variable.
+static bool GetBenchmarkSetting(
+    const xrJava& context,
+    const char* name,
+    const char* environmentVariable,
+    std::string& value) {
+#if defined(ANDROID)
+    OVR_UNUSED(environmentVariable);
+    if (GetIntentStringExtra(context, name, value)) {
+        return true;
+    }
+    char property[PROP_VALUE_MAX] = {};
+    const std::string propertyName = std::string("debug.xrapp.") + name;
+    if (__system_property_get(propertyName.c_str(), property) > 0) {
+        value = property;
+        return true;
+    }
+    return false;
+#else
+    OVR_UNUSED(context);
+    OVR_UNUSED(name);
+    const char* environment = getenv(environmentVariable);
+    if (environment == nullptr) {
+        return false;
+    }
+    value = environment;
+    return true;
+#endif // defined(ANDROID)
+}
+
+void XrApp::StartBenchmark(const xrJava& context) {
+    std::string value;
+    if (GetBenchmarkSetting(context, "benchmark_frames", "OVR_XRAPP_BENCHMARK_FRAMES", value)) {
+        BenchmarkFrames = atoi(value.c_str());
+    }
+    if (GetBenchmarkSetting(context, "benchmark_trace", "OVR_XRAPP_BENCHMARK_TRACE", value)) {
+        BenchmarkTracePath = value;
+    }
+    if (BenchmarkFrames <= 0) {
+        return;
+    }
+
+    ALOG("Benchmark: running %d frames", BenchmarkFrames);
+    FrameTiming.Clear();
+    if (!BenchmarkTracePath.empty()) {
+        ovrPerfRecorder::SetEnabled(true);
+    }
+}
+
+void XrApp::EndBenchmark() {
+    const ovrTimingHistory& frames = FrameTiming.GetFrameHistory();
+    ALOG(
+        "Benchmark: %d frames, last %d frames mean %.2f ms max %.2f ms\n%s",
+        BenchmarkFrames,
+        frames.GetCount(),
+        frames.GetMean() * 1e3,
+        frames.GetMax() * 1e3,
+        FrameTiming.GetSummary().c_str());
+
+    if (!BenchmarkTracePath.empty()) {
+        ovrPerfRecorder::SetEnabled(false);
+        if (ovrPerfRecorder::WriteChromeTrace(BenchmarkTracePath.c_str())) {
+            ALOG("Benchmark: wrote trace to '%s'", BenchmarkTracePath.c_str());
+        }
+    }
+    ShouldExit = true;
+}
+
 #if defined(ANDROID)
 void ActivityMainLoopContext::HandleOsEvents() {
     // Read all pending events.
@@ -1470,13 +1651,21 @@ bool WindowsMainLoopContext::IsExitRequested() const {
     return xrApp_->GetShouldExit();
 }
 #else
-#error "Platform not supported!"
+void HeadlessMainLoopContext::HandleOsEvents() {}
+
+bool HeadlessMainLoopContext::ShouldExitMainLoop() const {
+    return false;
+}
+
+bool HeadlessMainLoopContext::IsExitRequested() const {
+    return xrApp_->GetShouldExit();
+}
 #endif // defined(ANDROID)
 
 // Main application loop. The MainLoopContext is a functor that allows
 // an application to overload exit condition and event polling within the
 // loop. This allows Android Activity-based apps, Android Service-based apps,
-// and Windows apps to all use the same thread loop.
+// Windows apps and headless apps to all use the same thread loop.
 void XrApp::MainLoop(MainLoopContext& loopContext) {
     if (!Init(loopContext.GetJavaContext())) {
         ALOGE("Application failed to initialize.");
@@ -1484,25 +1673,54 @@ void XrApp::MainLoop(MainLoopContext& loopContext) {
     }
 
     InitSession();
+    StartBenchmark(loopContext.GetJavaContext());
+
+    const bool pipelined = PipelinedFrames;
+    if (pipelined) {
+        // world model loads need GL, they are finished in RenderPipelinedFrame() instead
+        Scene.SetWorldModelLoadsInFrame(false);
+        SimulationPipeline.Start("XrApp::Simulate", [this](ovrFramePipeline::ovrFrame& frame) {
+            // counted in the frame that is being rendered meanwhile
+            ovrScopedFramePhase phase(FrameTiming, FRAME_PHASE_UPDATE);
+            Update(frame.In);
+            AppSimulateFrame(frame.In, frame.Out);
+        });
+    }
 
     bool stageBoundsDirty = true;
     int frameCount = -1;
+    int submittedFrames = 0;
+    ovrPerfRecorder::SetThreadName("XrApp::MainLoop");
 
     while (!loopContext.ShouldExitMainLoop()) {
         frameCount++;
 
-        loopContext.HandleOsEvents();
+        if (pipelined) {
+            // app callbacks must not race with Update()
+            SimulationPipeline.Wait();
+        }
+
+        {
+            ovrScopedFramePhase phase(FrameTiming, FRAME_PHASE_EVENTS);
+            loopContext.HandleOsEvents();
 
-        HandleXrEvents();
+            HandleXrEvents();
+        }
 
         if (loopContext.IsExitRequested()) {
             break;
         }
 
         if (SessionActive == false) {
+            // do not show a stale frame when the session becomes active again
+            SimulationPipeline.Discard();
+            // nor count the time spent paused
+            FrameTiming.SkipFrame();
             continue;
         }
 
+        const double waitStart = GetTimeInSeconds();
+
         if (stageBoundsDirty) {
             XrExtent2Df stageBounds = {};
             XrResult result;
@@ -1585,9 +1803,18 @@ void XrApp::MainLoop(MainLoopContext& loopContext) {
         XrMatrix4x4f viewMat{};
         XrMatrix4x4f_CreateFromRigidTransform(&viewMat, &centerView);
         out.FrameMatrices.CenterView = FromXrMatrix4x4f(viewMat);
+        FrameTiming.AddPhase(FRAME_PHASE_WAIT, waitStart, GetTimeInSeconds());
 
         // Input
-        HandleInput(in);
+        if (pipelined) {
+            // Update() is called on the simulation thread
+            if (!SkipInputHandling) {
+                ovrScopedFramePhase phase(FrameTiming, FRAME_PHASE_INPUT);
+                SyncActionSets(in);
+            }
+        } else {
+            HandleInput(in);
+        }
 
         LayerCount = 0;
         memset(Layers, 0, sizeof(xrCompositorLayerUnion) * MAX_NUM_LAYERS);
@@ -1596,7 +1823,12 @@ void XrApp::MainLoop(MainLoopContext& loopContext) {
         PreProjectionAddLayer(Layers, LayerCount);
 
         // Render the world-view layer (projection)
-        AppRenderFrame(in, out);
+        if (pipelined) {
+            RenderPipelinedFrame(in, out);
+        } else {
+            AppRenderFrame(in, out);
+        }
+        const double endFrameStart = GetTimeInSeconds();
         ProjectionAddLayer(Layers, LayerCount);
 
         // allow apps to submit a layer after the world view projection layer (uncommon)
@@ -1615,8 +1847,22 @@ void XrApp::MainLoop(MainLoopContext& loopContext) {
         endFrameInfo.layers = layers;
 
         OXR(xrEndFrame(Session, &endFrameInfo));
+
+        const double now = GetTimeInSeconds();
+        FrameTiming.AddPhase(FRAME_PHASE_END_FRAME, endFrameStart, now);
+        FrameTiming.EndFrame(GpuTimer.GetLatestSeconds());
+        if (FrameTimingLogInterval > 0.0f && now - FrameTimingLogTime >= FrameTimingLogInterval) {
+            FrameTimingLogTime = now;
+            ALOG("Frame timing:\n%s", FrameTiming.GetSummary().c_str());
+        }
+
+        submittedFrames++;
+        if (submittedFrames == BenchmarkFrames) {
+            EndBenchmark();
+        }
     }
 
+    SimulationPipeline.Stop();
     EndSession();
     Shutdown(loopContext.GetJavaContext());
 }
@@ -1685,7 +1931,12 @@ void XrApp::Run() {
 
     WindowsMainLoopContext loopContext(Context, this);
 #else
-#error "Platform not supported!"
+void XrApp::Run() {
+    Context.Vm = nullptr;
+    Context.Env = nullptr;
+    Context.ActivityObject = nullptr;
+
+    HeadlessMainLoopContext loopContext(Context, this);
 #endif // defined(ANDROID)
 
     MainLoop(loopContext);
@@ -38,7 +38,9 @@ Language    :   c++
 
 #include "System.h"
 #include "FrameParams.h"
+#include "FramePipeline.h"
 #include "OVR_FileSys.h"
+#include "OVR_PerfTimer.h"
 
 #include "Render/Egl.h"
 
@@ -97,14 +99,19 @@ typedef void(GL_APIENTRY* PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC)(
 #include <unknwn.h>
 #define XR_USE_GRAPHICS_API_OPENGL 1
 #define XR_USE_PLATFORM_WIN32 1
+#else
+#define XR_USE_GRAPHICS_API_OPENGL_ES 1
+#define XR_USE_PLATFORM_EGL 1
 #endif // defined(ANDROID)
 
 #include <openxr/openxr.h>
 #include <meta_openxr_preview/openxr_oculus_helpers.h>
 #include <openxr/openxr_platform.h>
 
+#include "Input/XrInput.h"
 #include "Model/SceneView.h"
 #include "Render/Framebuffer.h"
+#include "Render/GlTimerQuery.h"
 #include "Render/SurfaceRender.h"
 
 std::string OXR_ResultToString(XrInstance instance, XrResult result);
@@ -279,6 +286,18 @@ class WindowsMainLoopContext : public MainLoopContext {
     bool ShouldExitMainLoop() const override;
     bool IsExitRequested() const override;
 };
+#else
+// There is no window, the loop runs until the app or the runtime asks to exit.
+class HeadlessMainLoopContext : public MainLoopContext {
+   public:
+    HeadlessMainLoopContext(xrJava& javaContext, XrApp* xrApp)
+        : MainLoopContext(javaContext, xrApp) {}
+    ~HeadlessMainLoopContext() override {}
+
+    void HandleOsEvents() override;
+    bool ShouldExitMainLoop() const override;
+    bool IsExitRequested() const override;
+};
 #endif
 
 class XrApp {
@@ -340,6 +359,10 @@ class XrApp {
     OVRFW::OvrSceneView& GetScene() {
         return Scene;
     }
+    // CPU time of each phase of the recent frames and the GPU time of their eye buffers
+    const OVRFW::ovrFrameTiming& GetFrameTiming() const {
+        return FrameTiming;
+    }
 
     void SetRunWhilePaused(bool b) {
         RunWhilePaused = b;
@@ -413,6 +436,9 @@ class XrApp {
     virtual void AppGainedFocus();
     // Called once per frame to allow the application to render eye buffers.
     virtual void AppRenderFrame(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out);
+    // Called once per frame after Update() to advance the scene and collect the surfaces to
+    // render into out. With PipelinedFrames this runs on the simulation thread.
+    virtual void AppSimulateFrame(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out);
     // Called once per eye each frame for default renderer
     virtual void
     AppRenderEye(const OVRFW::ovrApplFrameIn& in, OVRFW::ovrRendererOutput& out, int eye);
@@ -517,9 +543,24 @@ class XrApp {
     };
     XrApp::LocVel GetSpaceLocVel(XrSpace space, XrTime time);
 
+    // States of the default actions, read once per frame by SyncActionSets().
+    typedef OVRFW::ovrXrInputSnapshot InputSnapshot;
+    const InputSnapshot& GetInputSnapshot() const {
+        return Input;
+    }
+
     /// XR Input state overrides
     virtual void AttachActionSets();
     virtual void SyncActionSets(ovrApplFrameIn& in);
+    // Syncs the base action set and reads the head and the default actions.
+    void ReadInputSnapshot(const XrTime time, InputSnapshot& snapshot);
+    OVRFW::ovrXrInputHandles GetInputHandles() const;
+    // Asks the runtime for the interaction profile of each hand. Called when the session gains
+    // focus and when the runtime reports a change, instead of every frame.
+    void RefreshInteractionProfiles();
+    bool IsHandBound(const int hand) const {
+        return !InteractionProfilesKnown || HandInteractionProfile[hand] != XR_NULL_PATH;
+    }
 
     // Called to deal with lifetime
     void HandleSessionStateChanges(XrSessionState state);
@@ -563,9 +604,16 @@ class XrApp {
     // Internal Input
     void HandleInput(ovrApplFrameIn& in);
 
-    // Internal Render
+    // Internal Render of the eye buffers
     void RenderFrame(const ovrApplFrameIn& in, ovrRendererOutput& out);
 
+    // Pipelined frames, see PipelinedFrames
+    void RenderPipelinedFrame(const ovrApplFrameIn& in, const ovrRendererOutput& out);
+
+    // Benchmark runs, see BenchmarkFrames
+    void StartBenchmark(const xrJava& context);
+    void EndBenchmark();
+
    public:
     OVR::Vector4f BackgroundColor;
     bool FreeMove{false};
@@ -601,6 +649,38 @@ class XrApp {
     // allocated by the framework.
     float FramebufferResolutionScaleFactor{1.0f};
 
+    // An app can set this in AppInit() to run Update() and AppSimulateFrame() for a frame on a
+    // simulation thread while this thread renders the previous frame, instead of calling
+    // AppRenderFrame(). All OpenXR frame calls and GL stay on this thread, so Update() and
+    // AppSimulateFrame() must not touch GL or the JNIEnv of the context, and must not change
+    // anything that Render() or the surfaces of the previous frame still read. Each frame is
+    // rendered with its own head pose, but with the app state simulated one frame earlier.
+    // Scene.Frame() then leaves world model loads to this thread, between two simulations.
+    bool PipelinedFrames = false;
+
+    // Convenience for SurfaceRender.SetSortMode(SURFACE_SORT_STATE): an app can set this in
+    // AppInit() to draw the surfaces with the framework's surface renderer sorted by GPU
+    // state. Only opaque, depth-writing surfaces are reordered, so the image only changes
+    // where such surfaces are coplanar.
+    bool SortSurfacesByState = false;
+
+    // An app can set this to log the frame timing percentiles every this many seconds,
+    // 0 disables the log. Scoped timers are only recorded for traces while
+    // ovrPerfRecorder::SetEnabled( true ).
+    float FrameTimingLogInterval = 0.0f;
+
+    // An app can set this in AppInit() to exit after this many frames were submitted, logging
+    // the frame timing and writing the recent scoped timer events as a Chrome trace to
+    // BenchmarkTracePath if it is set. Against a simulated runtime, such as Meta XR Simulator
+    // on Windows, this measures the CPU cost of the frame loop without a headset. So that any
+    // app can be measured without a rebuild, both can be overridden: on Android by the
+    // benchmark_frames and benchmark_trace string extras of the launch intent or else the
+    // debug.xrapp.benchmark_frames and debug.xrapp.benchmark_trace system properties,
+    // elsewhere by the OVR_XRAPP_BENCHMARK_FRAMES and OVR_XRAPP_BENCHMARK_TRACE environment
+    // variables.
+    int BenchmarkFrames = 0;
+    std::string BenchmarkTracePath;
+
     XrVersion OpenXRVersion = XR_API_VERSION_1_0;
     XrInstance Instance = XR_NULL_HANDLE;
     XrSession Session = XR_NULL_HANDLE;
@@ -642,6 +722,9 @@ class XrApp {
     XrSpace RightControllerGripSpace = XR_NULL_HANDLE;
     uint32_t LastFrameAllButtons = 0u;
     uint32_t LastFrameAllTouches = 0u;
+    XrPath HandInteractionProfile[2] = {XR_NULL_PATH, XR_NULL_PATH};
+    bool InteractionProfilesKnown = false;
+    InputSnapshot Input = {};
 
     OVRFW::ovrSurfaceRender SurfaceRender;
     OVRFW::OvrSceneView Scene;
@@ -664,6 +747,13 @@ class XrApp {
     bool IsAppFocused = false;
     bool RunWhilePaused = false;
     bool ShouldRender = true;
+
+    // Hands frames between this thread and the simulation thread
+    ovrFramePipeline SimulationPipeline;
+
+    OVRFW::ovrFrameTiming FrameTiming;
+    OVRFW::ovrGlTimerQuery GpuTimer;
+    double FrameTimingLogTime = 0.0;
 };
 
 } // namespace OVRFW
@@ -0,0 +1,447 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   AccessorConversionTest.cpp
+Content     :   glTF accessor component conversions against a scalar reference.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "Model/ModelFileLoading.h"
+
+#include "FrameworkTest.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+
+using OVR::Vector4f;
+
+namespace OVRFW {
+
+static const int ComponentTypes[] = {
+    MODEL_COMPONENT_TYPE_BYTE,
+    MODEL_COMPONENT_TYPE_UNSIGNED_BYTE,
+    MODEL_COMPONENT_TYPE_SHORT,
+    MODEL_COMPONENT_TYPE_UNSIGNED_SHORT,
+    MODEL_COMPONENT_TYPE_UNSIGNED_INT,
+    MODEL_COMPONENT_TYPE_FLOAT};
+
+static int ComponentSize(const int componentType) {
+    switch (componentType) {
+        case MODEL_COMPONENT_TYPE_BYTE:
+        case MODEL_COMPONENT_TYPE_UNSIGNED_BYTE:
+            return 1;
+        case MODEL_COMPONENT_TYPE_SHORT:
+        case MODEL_COMPONENT_TYPE_UNSIGNED_SHORT:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+template <typename _type_>
+static _type_ Read(const char* src) {
+    _type_ value;
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+template <typename _type_>
+static void Write(char* dst, const _type_ value) {
+    memcpy(dst, &value, sizeof(value));
+}
+
+// One component at a time, the way the loader converted before the per-type kernels.
+// Integers read as float are normalized, floats written as bytes are treated as
+// normalized, everything else is a change of storage.
+static void ReferenceConvert(
+    const char* src,
+    const int srcComponentType,
+    const int dstComponentType,
+    char* dst) {
+    if (dstComponentType == MODEL_COMPONENT_TYPE_FLOAT) {
+        float value = 0.0f;
+        switch (srcComponentType) {
+            case MODEL_COMPONENT_TYPE_BYTE:
+                value = std::max(static_cast<float>(Read<int8_t>(src)) / 127.0f, -1.0f);
+                break;
+            case MODEL_COMPONENT_TYPE_UNSIGNED_BYTE:
+                value = static_cast<float>(Read<uint8_t>(src)) / 255.0f;
+                break;
+            case MODEL_COMPONENT_TYPE_SHORT:
+                value = std::max(static_cast<float>(Read<int16_t>(src)) / 32767.0f, -1.0f);
+                break;
+            case MODEL_COMPONENT_TYPE_UNSIGNED_SHORT:
+                value = static_cast<float>(Read<uint16_t>(src)) / 65535.0f;
+                break;
+            case MODEL_COMPONENT_TYPE_UNSIGNED_INT:
+                value = static_cast<float>(static_cast<double>(Read<uint32_t>(src)) / 4294967295.0);
+                break;
+            case MODEL_COMPONENT_TYPE_FLOAT:
+                value = Read<float>(src);
+                break;
+        }
+        Write(dst, value);
+    } else if (srcComponentType == MODEL_COMPONENT_TYPE_FLOAT) {
+        const float value = Read<float>(src);
+        switch (dstComponentType) {
+            case MODEL_COMPONENT_TYPE_BYTE:
+                Write(dst, static_cast<int8_t>(value * 128.0f));
+                break;
+            case MODEL_COMPONENT_TYPE_UNSIGNED_BYTE:
+                Write(dst, static_cast<uint8_t>(value * 255.0f));
+                break;
+            case MODEL_COMPONENT_TYPE_SHORT:
+                Write(dst, static_cast<int16_t>(value));
+                break;
+            case MODEL_COMPONENT_TYPE_UNSIGNED_SHORT:
+                Write(dst, static_cast<uint16_t>(value));
+                break;
+            case MODEL_COMPONENT_TYPE_UNSIGNED_INT:
+                Write(dst, static_cast<uint32_t>(value));
+                break;
+        }
+    } else {
+        int64_t value = 0;
+        switch (srcComponentType) {
+            case MODEL_COMPONENT_TYPE_BYTE:
+                value = Read<int8_t>(src);
+                break;
+            case MODEL_COMPONENT_TYPE_UNSIGNED_BYTE:
+                value = Read<uint8_t>(src);
+                break;
+            case MODEL_COMPONENT_TYPE_SHORT:
+                value = Read<int16_t>(src);
+                break;
+            case MODEL_COMPONENT_TYPE_UNSIGNED_SHORT:
+                value = Read<uint16_t>(src);
+                break;
+            case MODEL_COMPONENT_TYPE_UNSIGNED_INT:
+                value = Read<uint32_t>(src);
+                break;
+        }
+        switch (dstComponentType) {
+            case MODEL_COMPONENT_TYPE_BYTE:
+                Write(dst, static_cast<int8_t>(value));
+                break;
+            case MODEL_COMPONENT_TYPE_UNSIGNED_BYTE:
+                Write(dst, static_cast<uint8_t>(value));
+                break;
+            case MODEL_COMPONENT_TYPE_SHORT:
+                Write(dst, static_cast<int16_t>(value));
+                break;
+            case MODEL_COMPONENT_TYPE_UNSIGNED_SHORT:
+                Write(dst, static_cast<uint16_t>(value));
+                break;
+            case MODEL_COMPONENT_TYPE_UNSIGNED_INT:
+                Write(dst, static_cast<uint32_t>(value));
+                break;
+        }
+    }
+}
+
+// Float sources are kept in the range the destination type can represent.
+static float RandomFloatFor(const int dstComponentType, std::mt19937& random) {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    switch (dstComponentType) {
+        case MODEL_COMPONENT_TYPE_BYTE:
+            return -1.0f + unit(random) * (1.0f + 127.0f / 128.0f);
+        case MODEL_COMPONENT_TYPE_UNSIGNED_BYTE:
+            return unit(random);
+        case MODEL_COMPONENT_TYPE_SHORT:
+            return -32768.0f + unit(random) * 65535.0f;
+        case MODEL_COMPONENT_TYPE_UNSIGNED_SHORT:
+            return unit(random) * 65535.0f;
+        case MODEL_COMPONENT_TYPE_UNSIGNED_INT:
+            return unit(random) * 16777216.0f;
+        default:
+            return -1000.0f + unit(random) * 2000.0f;
+    }
+}
+
+// Fills valueCount values spaced readStride apart.  The first two values hold the
+// smallest and largest integers of the source type.
+static std::vector<char> MakeSource(
+    const int srcComponentType,
+    const int dstComponentType,
+    const int componentCount,
+    const int readStride,
+    const int valueCount,
+    std::mt19937& random) {
+    std::vector<char> src(readStride * valueCount);
+    for (char& c : src) {
+        c = static_cast<char>(random());
+    }
+    const int componentSize = ComponentSize(srcComponentType);
+    for (int i = 0; i < valueCount; i++) {
+        for (int j = 0; j < componentCount; j++) {
+            char* component = src.data() + i * readStride + j * componentSize;
+            if (srcComponentType == MODEL_COMPONENT_TYPE_FLOAT) {
+                Write(component, RandomFloatFor(dstComponentType, random));
+            } else if (i < 2) {
+                const bool low = (i == 0);
+                switch (srcComponentType) {
+                    case MODEL_COMPONENT_TYPE_BYTE:
+                        Write(component, static_cast<int8_t>(low ? -128 : 127));
+                        break;
+                    case MODEL_COMPONENT_TYPE_UNSIGNED_BYTE:
+                        Write(component, static_cast<uint8_t>(low ? 0 : 255));
+                        break;
+                    case MODEL_COMPONENT_TYPE_SHORT:
+                        Write(component, static_cast<int16_t>(low ? -32768 : 32767));
+                        break;
+                    case MODEL_COMPONENT_TYPE_UNSIGNED_SHORT:
+                        Write(component, static_cast<uint16_t>(low ? 0 : 65535));
+                        break;
+                    case MODEL_COMPONENT_TYPE_UNSIGNED_INT:
+                        Write(component, static_cast<uint32_t>(low ? 0 : 4294967295u));
+                        break;
+                }
+            }
+        }
+    }
+    return src;
+}
+
+// Every pair of component types, 1 to 4 components, tightly packed and strided.
+static void TestAgainstReference() {
+    std::mt19937 random(7);
+    const int valueCount = 37;
+    for (const int srcComponentType : ComponentTypes) {
+        for (const int dstComponentType : ComponentTypes) {
+            for (int componentCount = 1; componentCount <= 4; componentCount++) {
+                const int srcValueSize = ComponentSize(srcComponentType) * componentCount;
+                const int dstValueSize = ComponentSize(dstComponentType) * componentCount;
+                const int strides[] = {srcValueSize, (srcValueSize + 3) / 4 * 4 + 8};
+                for (const int readStride : strides) {
+                    const std::vector<char> src = MakeSource(
+                        srcComponentType,
+                        dstComponentType,
+                        componentCount,
+                        readStride,
+                        valueCount,
+                        random);
+
+                    std::vector<char> expected(dstValueSize * valueCount);
+                    for (int i = 0; i < valueCount; i++) {
+                        for (int j = 0; j < componentCount; j++) {
+                            ReferenceConvert(
+                                src.data() + i * readStride + j * ComponentSize(srcComponentType),
+                                srcComponentType,
+                                dstComponentType,
+                                expected.data() + i * dstValueSize +
+                                    j * ComponentSize(dstComponentType));
+                        }
+                    }
+
+                    // a guard value after the output catches overruns
+                    std::vector<char> actual(dstValueSize * valueCount + 4, 0x5A);
+                    ConvertAccessorComponents(
+                        src.data(),
+                        readStride,
+                        valueCount,
+                        componentCount,
+                        srcComponentType,
+                        dstComponentType,
+                        actual.data());
+
+                    const bool match = memcmp(actual.data(), expected.data(), expected.size()) == 0;
+                    if (!match) {
+                        printf(
+                            "mismatch: src 0x%x dst 0x%x components %d stride %d\n",
+                            srcComponentType,
+                            dstComponentType,
+                            componentCount,
+                            readStride);
+                    }
+                    FW_EXPECT(match);
+                    FW_EXPECT(actual[expected.size()] == 0x5A);
+                    FW_EXPECT(actual[expected.size() + 3] == 0x5A);
+                }
+            }
+        }
+    }
+}
+
+// Integer to unsigned short used to store only the low byte.
+static void TestUnsignedShortKeepsHighByte() {
+    const uint32_t uints[3] = {0x1234, 300, 65535};
+    uint16_t shorts[3] = {};
+    ConvertAccessorComponents(
+        reinterpret_cast<const char*>(uints),
+        sizeof(uint32_t),
+        3,
+        1,
+        MODEL_COMPONENT_TYPE_UNSIGNED_INT,
+        MODEL_COMPONENT_TYPE_UNSIGNED_SHORT,
+        reinterpret_cast<char*>(shorts));
+    FW_EXPECT(shorts[0] == 0x1234);
+    FW_EXPECT(shorts[1] == 300);
+    FW_EXPECT(shorts[2] == 65535);
+
+    const int16_t signedShorts[2] = {1000, 0x7F00};
+    ConvertAccessorComponents(
+        reinterpret_cast<const char*>(signedShorts),
+        sizeof(int16_t),
+        2,
+        1,
+        MODEL_COMPONENT_TYPE_SHORT,
+        MODEL_COMPONENT_TYPE_UNSIGNED_SHORT,
+        reinterpret_cast<char*>(shorts));
+    FW_EXPECT(shorts[0] == 1000);
+    FW_EXPECT(shorts[1] == 0x7F00);
+}
+
+// A model file with one buffer holding the given bytes, one buffer view over all of them
+// with the given stride, and one accessor.
+static void MakeModelFile(
+    ModelFile& modelFile,
+    const std::vector<char>& data,
+    const int byteStride,
+    const int componentType,
+    const ModelAccessorType type,
+    const int count) {
+    modelFile.Buffers.resize(1);
+    modelFile.Buffers[0].bufferData.assign(data.begin(), data.end());
+    modelFile.Buffers[0].byteLength = data.size();
+    modelFile.BufferViews.resize(1);
+    modelFile.BufferViews[0].buffer = &modelFile.Buffers[0];
+    modelFile.BufferViews[0].byteLength = data.size();
+    modelFile.BufferViews[0].byteStride = byteStride;
+    modelFile.Accessors.resize(1);
+    modelFile.Accessors[0].bufferView = &modelFile.BufferViews[0];
+    modelFile.Accessors[0].componentType = componentType;
+    modelFile.Accessors[0].type = type;
+    modelFile.Accessors[0].count = count;
+}
+
+// Appending used to write the converted values over the start of the vector.
+static void TestAppend() {
+    const Vector4f first(0.5f, 0.25f, 0.125f, 1.0f);
+    const Vector4f second(-1.0f, -2.0f, -3.0f, -4.0f);
+
+    // converted, tightly packed
+    {
+        const std::vector<char> data = {0, 51, 102, (char)255, (char)255, 0, 0, 0};
+        ModelFile modelFile;
+        MakeModelFile(modelFile, data, 0, MODEL_COMPONENT_TYPE_UNSIGNED_BYTE, ACCESSOR_VEC4, 2);
+        std::vector<Vector4f> out = {first, second};
+        FW_EXPECT(ReadSurfaceDataFromAccessor(
+            out, modelFile, 0, ACCESSOR_VEC4, MODEL_COMPONENT_TYPE_FLOAT, -1, true));
+        FW_EXPECT(out.size() == 4);
+        FW_EXPECT(out[0] == first);
+        FW_EXPECT(out[1] == second);
+        FW_EXPECT(out[2] == Vector4f(0.0f, 51.0f / 255.0f, 102.0f / 255.0f, 1.0f));
+        FW_EXPECT(out[3] == Vector4f(1.0f, 0.0f, 0.0f, 0.0f));
+    }
+
+    // converted, strided
+    {
+        std::vector<char> data(24, 0);
+        const int16_t values[2][2] = {{32767, 0}, {16384, 1}};
+        memcpy(data.data(), values[0], 4);
+        memcpy(data.data() + 12, values[1], 4);
+        ModelFile modelFile;
+        MakeModelFile(modelFile, data, 12, MODEL_COMPONENT_TYPE_SHORT, ACCESSOR_VEC2, 2);
+        std::vector<OVR::Vector2f> out = {OVR::Vector2f(7.0f, 8.0f)};
+        FW_EXPECT(ReadSurfaceDataFromAccessor(
+            out, modelFile, 0, ACCESSOR_VEC2, MODEL_COMPONENT_TYPE_FLOAT, -1, true));
+        FW_EXPECT(out.size() == 3);
+        FW_EXPECT(out[0] == OVR::Vector2f(7.0f, 8.0f));
+        FW_EXPECT(out[1] == OVR::Vector2f(1.0f, 0.0f));
+        FW_EXPECT(out[2] == OVR::Vector2f(16384.0f / 32767.0f, 1.0f / 32767.0f));
+    }
+
+    // same type, strided copy and plain copy
+    for (const int byteStride : {0, 20}) {
+        std::vector<char> data(byteStride > 0 ? byteStride * 2 : 32, 0);
+        const Vector4f values[2] = {Vector4f(1, 2, 3, 4), Vector4f(5, 6, 7, 8)};
+        memcpy(data.data(), &values[0], sizeof(Vector4f));
+        memcpy(data.data() + (byteStride > 0 ? byteStride : 16), &values[1], sizeof(Vector4f));
+        ModelFile modelFile;
+        MakeModelFile(modelFile, data, byteStride, MODEL_COMPONENT_TYPE_FLOAT, ACCESSOR_VEC4, 2);
+        std::vector<Vector4f> out = {first};
+        FW_EXPECT(ReadSurfaceDataFromAccessor(
+            out, modelFile, 0, ACCESSOR_VEC4, MODEL_COMPONENT_TYPE_FLOAT, -1, true));
+        FW_EXPECT(out.size() == 3);
+        FW_EXPECT(out[0] == first);
+        FW_EXPECT(out[1] == values[0]);
+        FW_EXPECT(out[2] == values[1]);
+
+        // without append the vector is replaced
+        FW_EXPECT(ReadSurfaceDataFromAccessor(
+            out, modelFile, 0, ACCESSOR_VEC4, MODEL_COMPONENT_TYPE_FLOAT, -1, false));
+        FW_EXPECT(out.size() == 2);
+        FW_EXPECT(out[0] == values[0]);
+    }
+
+    // indices widened to 32 bits
+    {
+        const uint16_t indices[4] = {0, 1, 40000, 65535};
+        std::vector<char> data(sizeof(indices));
+        memcpy(data.data(), indices, sizeof(indices));
+        ModelFile modelFile;
+        MakeModelFile(
+            modelFile, data, 0, MODEL_COMPONENT_TYPE_UNSIGNED_SHORT, ACCESSOR_SCALAR, 4);
+        std::vector<uint32_t> out = {9};
+        FW_EXPECT(ReadSurfaceDataFromAccessor(
+            out, modelFile, 0, ACCESSOR_SCALAR, MODEL_COMPONENT_TYPE_UNSIGNED_INT, -1, true));
+        FW_EXPECT(out.size() == 5);
+        FW_EXPECT(out[0] == 9);
+        FW_EXPECT(out[3] == 40000);
+        FW_EXPECT(out[4] == 65535);
+    }
+}
+
+// Accessors that do not match the request, or do not fit their buffer, are rejected.
+static void TestRejected() {
+    const std::vector<char> data(32, 0);
+    ModelFile modelFile;
+    MakeModelFile(modelFile, data, 0, MODEL_COMPONENT_TYPE_FLOAT, ACCESSOR_VEC4, 2);
+    std::vector<Vector4f> out;
+    FW_EXPECT(!ReadSurfaceDataFromAccessor(
+        out, modelFile, 0, ACCESSOR_VEC4, MODEL_COMPONENT_TYPE_FLOAT, 3, false));
+    FW_EXPECT(!ReadSurfaceDataFromAccessor(
+        out, modelFile, 0, ACCESSOR_VEC3, MODEL_COMPONENT_TYPE_FLOAT, -1, false));
+    FW_EXPECT(!ReadSurfaceDataFromAccessor(
+        out, modelFile, 1, ACCESSOR_VEC4, MODEL_COMPONENT_TYPE_FLOAT, -1, false));
+    FW_EXPECT(out.empty());
+    // a missing accessor is not an error
+    FW_EXPECT(ReadSurfaceDataFromAccessor(
+        out, modelFile, -1, ACCESSOR_VEC4, MODEL_COMPONENT_TYPE_FLOAT, -1, false));
+
+    modelFile.Accessors[0].count = 3;
+    FW_EXPECT(!ReadSurfaceDataFromAccessor(
+        out, modelFile, 0, ACCESSOR_VEC4, MODEL_COMPONENT_TYPE_FLOAT, -1, false));
+    FW_EXPECT(out.empty());
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::TestAgainstReference();
+    OVRFW::TestUnsignedShortKeepsHighByte();
+    OVRFW::TestAppend();
+    OVRFW::TestRejected();
+    return FW_TEST_RESULT();
+}
@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   BillboardInstancesTest.cpp
+Content     :   Packing of the particle and glyph instance records, and the quads the
+                vertex shaders expand from them.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "Render/BillboardInstances.h"
+#include "Render/GlGeometry.h"
+#include "Render/GlProgram.h"
+
+#include "FakeGl.h"
+#include "FrameworkTest.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include <random>
+
+using OVR::Vector2f;
+using OVR::Vector3f;
+using OVR::Vector4f;
+
+namespace OVRFW {
+
+static float UnpackSnorm16(const int16_t value) {
+    return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+}
+
+static Vector4f UnpackColorUnorm8(const uint32_t color) {
+    return Vector4f(
+        static_cast<float>(color & 0xFF) / 255.0f,
+        static_cast<float>((color >> 8) & 0xFF) / 255.0f,
+        static_cast<float>((color >> 16) & 0xFF) / 255.0f,
+        static_cast<float>(color >> 24) / 255.0f);
+}
+
+static bool Near(const Vector3f& a, const Vector3f& b, const float epsilon) {
+    return fabsf(a.x - b.x) <= epsilon && fabsf(a.y - b.y) <= epsilon &&
+        fabsf(a.z - b.z) <= epsilon;
+}
+
+static bool Near(const Vector2f& a, const Vector2f& b, const float epsilon) {
+    return fabsf(a.x - b.x) <= epsilon && fabsf(a.y - b.y) <= epsilon;
+}
+
+// The corner of gl_VertexID in the vertex shaders, counter clockwise from the lower left.
+static Vector2f Corner(const int vertexId) {
+    return Vector2f(
+        (vertexId == 1 || vertexId == 2) ? 1.0f : 0.0f, (vertexId >= 2) ? 1.0f : 0.0f);
+}
+
+static Vector2f CornerUv(const int16_t uvRect[4], const Vector2f& corner) {
+    const Vector2f uv0(UnpackSnorm16(uvRect[0]), UnpackSnorm16(uvRect[1]));
+    const Vector2f uv1(UnpackSnorm16(uvRect[2]), UnpackSnorm16(uvRect[3]));
+    return Vector2f(
+        uv0.x + (uv1.x - uv0.x) * corner.x, uv0.y + (uv1.y - uv0.y) * (1.0f - corner.y));
+}
+
+static void TestPackScalars() {
+    FW_EXPECT(PackSnorm16(0.0f) == 0);
+    FW_EXPECT(PackSnorm16(1.0f) == 32767);
+    FW_EXPECT(PackSnorm16(-1.0f) == -32767);
+    FW_EXPECT(PackSnorm16(2.0f) == 32767);
+    FW_EXPECT(PackSnorm16(-2.0f) == -32767);
+    FW_EXPECT(PackSnorm16(0.5f) == 16384);
+    FW_EXPECT(PackSnorm16(-0.25f) == -8192);
+    for (int i = -1000; i <= 1000; i++) {
+        const float value = static_cast<float>(i) / 1000.0f;
+        FW_EXPECT(fabsf(UnpackSnorm16(PackSnorm16(value)) - value) <= 0.5f / 32767.0f + 1e-7f);
+    }
+
+    FW_EXPECT(PackColorUnorm8(Vector4f(1.0f, 0.5f, 0.0f, 1.0f)) == 0xFF0080FFu);
+    FW_EXPECT(PackColorUnorm8(Vector4f(-1.0f, 2.0f, 0.2f, 0.0f)) == 0x0033FF00u);
+    for (int i = 0; i <= 255; i++) {
+        const float value = static_cast<float>(i) / 255.0f;
+        FW_EXPECT(PackColorUnorm8(Vector4f(value, 0.0f, 0.0f, 0.0f)) == static_cast<uint32_t>(i));
+    }
+}
+
+// The quad BuildParticleVertices writes, upper left, upper right, lower right, lower left.
+static void ParticleQuad(
+    const Vector3f& pos,
+    const float scale,
+    const float orientation,
+    const Vector3f& viewPos,
+    Vector3f positions[4]) {
+    const Vector3f normal = (viewPos - pos).Normalized();
+    Vector3f xBasis(1.0f, 0.0f, 0.0f);
+    Vector3f yBasis(0.0f, 1.0f, 0.0f);
+    if (fabsf(normal.y) <= 0.9999f) {
+        xBasis = Vector3f(normal.z, 0.0f, -normal.x).Normalized();
+        yBasis = normal.Cross(xBasis);
+    }
+    const float sina = sinf(orientation) * scale;
+    const float cosa = cosf(orientation) * scale;
+    const Vector3f right = xBasis * cosa + yBasis * sina;
+    const Vector3f up = yBasis * cosa - xBasis * sina;
+    const Vector2f offsets[4] = {{-0.5f, 0.5f}, {0.5f, 0.5f}, {0.5f, -0.5f}, {-0.5f, -0.5f}};
+    for (int v = 0; v < 4; v++) {
+        positions[v] = pos + right * offsets[v].x + up * offsets[v].y;
+    }
+}
+
+// The instanced particle vertex shader, fed from the packed record.
+static void ExpandParticle(
+    const ovrParticleInstance& instance,
+    const Vector3f& viewPos,
+    const int vertexId,
+    Vector3f& position,
+    Vector2f& uv) {
+    const Vector2f corner = Corner(vertexId);
+    const Vector3f pos(instance.Position[0], instance.Position[1], instance.Position[2]);
+    Vector3f normal = viewPos - pos;
+    normal = normal * (1.0f / sqrtf(normal.LengthSq()));
+    Vector3f xBasis(1.0f, 0.0f, 0.0f);
+    Vector3f yBasis(0.0f, 1.0f, 0.0f);
+    if (fabsf(normal.y) <= 0.9999f) {
+        xBasis = Vector3f(normal.z, 0.0f, -normal.x).Normalized();
+        yBasis = normal.Cross(xBasis);
+    }
+    const Vector2f rotation = Vector2f(
+                                  UnpackSnorm16(instance.Rotation[0]),
+                                  UnpackSnorm16(instance.Rotation[1])) *
+        instance.Scale;
+    const Vector3f right = xBasis * rotation.x + yBasis * rotation.y;
+    const Vector3f up = yBasis * rotation.x - xBasis * rotation.y;
+    position = pos + right * (corner.x - 0.5f) + up * (corner.y - 0.5f);
+    uv = CornerUv(instance.UvRect, corner);
+}
+
+static void TestParticles() {
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    const Vector3f viewPos(0.0f, 1.6f, 0.0f);
+    for (int i = 0; i < 1000; i++) {
+        const Vector3f pos(value(random) * 5.0f, value(random) * 5.0f, value(random) * 5.0f);
+        const float scale = 0.01f + fabsf(value(random));
+        const float orientation = value(random) * 10.0f;
+        const Vector4f color(fabsf(value(random)), fabsf(value(random)), 0.5f, 1.0f);
+        const Vector2f uvMins(fabsf(value(random)) * 0.5f, fabsf(value(random)) * 0.5f);
+        const Vector2f uvMaxs(uvMins.x + 0.25f, uvMins.y + 0.25f);
+
+        ovrParticleInstance instance;
+        PackParticleInstance(instance, pos, scale, orientation, color, uvMins, uvMaxs);
+        FW_EXPECT(instance.Position[0] == pos.x);
+        FW_EXPECT(instance.Position[1] == pos.y);
+        FW_EXPECT(instance.Position[2] == pos.z);
+        FW_EXPECT(instance.Scale == scale);
+        FW_EXPECT(instance.Color == PackColorUnorm8(color));
+        const Vector4f unpacked = UnpackColorUnorm8(instance.Color);
+        for (int c = 0; c < 4; c++) {
+            FW_EXPECT(fabsf(unpacked[c] - color[c]) <= 0.5f / 255.0f + 1e-6f);
+        }
+
+        // the shader corners are counter clockwise from the lower left, the CPU quad is
+        // clockwise from the upper left
+        Vector3f quad[4];
+        ParticleQuad(pos, scale, orientation, viewPos, quad);
+        const int cpuVertex[4] = {3, 2, 1, 0};
+        const Vector2f cpuUv[4] = {
+            Vector2f(uvMins.x, uvMaxs.y),
+            Vector2f(uvMaxs.x, uvMaxs.y),
+            Vector2f(uvMaxs.x, uvMins.y),
+            Vector2f(uvMins.x, uvMins.y)};
+        bool match = true;
+        for (int v = 0; v < 4; v++) {
+            Vector3f position;
+            Vector2f uv;
+            ExpandParticle(instance, viewPos, v, position, uv);
+            // snorm16 rotation, about 3e-5 of the scale
+            match = match && Near(position, quad[cpuVertex[v]], 1e-4f * (1.0f + scale));
+            match = match && Near(uv, cpuUv[v], 1.0f / 32767.0f);
+        }
+        FW_EXPECT(match);
+    }
+}
+
+static void TestGlyphs() {
+    std::mt19937 random(2);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    for (int i = 0; i < 1000; i++) {
+        // a transformed glyph quad: lower left, upper left, upper right, lower right
+        const Vector3f origin(value(random), value(random), value(random));
+        const Vector3f right(value(random) * 0.1f, value(random) * 0.1f, value(random) * 0.1f);
+        const Vector3f up(value(random) * 0.1f, value(random) * 0.1f, value(random) * 0.1f);
+        const Vector3f quad[4] = {origin, origin + up, origin + right + up, origin + right};
+        const float s0 = fabsf(value(random)) * 0.9f;
+        const float t0 = fabsf(value(random)) * 0.9f;
+        const float s1 = s0 + 0.05f;
+        const float t1 = t0 + 0.07f;
+        const Vector2f uvs[4] = {{s0, t1}, {s0, t0}, {s1, t0}, {s1, t1}};
+        const uint32_t color = static_cast<uint32_t>(random());
+        const uint32_t fontParms = static_cast<uint32_t>(random());
+
+        ovrGlyphInstance instance;
+        PackGlyphInstance(instance, quad[0], quad[3] - quad[0], quad[1] - quad[0], uvs[1], uvs[3],
+                          color, fontParms);
+        FW_EXPECT(instance.Color == color);
+        FW_EXPECT(instance.FontParms == fontParms);
+
+        // the instanced font vertex shader
+        const Vector3f o(instance.Origin[0], instance.Origin[1], instance.Origin[2]);
+        const Vector3f r(instance.Right[0], instance.Right[1], instance.Right[2]);
+        const Vector3f u(instance.Up[0], instance.Up[1], instance.Up[2]);
+        const int cpuVertex[4] = {0, 3, 2, 1};
+        bool match = true;
+        for (int v = 0; v < 4; v++) {
+            const Vector2f corner = Corner(v);
+            const Vector3f position = o + r * corner.x + u * corner.y;
+            match = match && Near(position, quad[cpuVertex[v]], 1e-6f);
+            match = match &&
+                Near(CornerUv(instance.UvRect, corner), uvs[cpuVertex[v]], 1.0f / 32767.0f);
+        }
+        FW_EXPECT(match);
+    }
+}
+
+// The attributes step once per instance and read the records with the right stride and offsets.
+static void TestGeometry() {
+    FakeGlReset();
+    const ovrInstanceAttribute attributes[] = {
+        {VERTEX_ATTRIBUTE_LOCATION_POSITION,
+         4,
+         GL_FLOAT,
+         false,
+         offsetof(ovrParticleInstance, Position)},
+        {VERTEX_ATTRIBUTE_LOCATION_COLOR,
+         4,
+         GL_UNSIGNED_BYTE,
+         true,
+         offsetof(ovrParticleInstance, Color)},
+    };
+    GlGeometry geo;
+    CreateBillboardGeometry(geo, attributes, 2, sizeof(ovrParticleInstance), 4);
+    FW_EXPECT(geo.vertexCount == 4);
+    FW_EXPECT(geo.indexCount == 6);
+    FW_EXPECT(geo.vertexBufferSize == 4 * static_cast<int>(sizeof(ovrParticleInstance)));
+    FW_EXPECT(FakeGlCount("glVertexAttribDivisor") == 2);
+    int numPointers = 0;
+    for (const ovrFakeGlCall& call : FakeGlCalls()) {
+        if (strcmp(call.Name, "glVertexAttribPointer") == 0) {
+            const ovrInstanceAttribute& a = attributes[numPointers++];
+            FW_EXPECT(call.Args[0] == a.Location);
+            FW_EXPECT(call.Args[1] == a.Size);
+            FW_EXPECT(call.Args[2] == a.Type);
+            FW_EXPECT(call.Args[3] == (a.Normalized ? GL_TRUE : GL_FALSE));
+            FW_EXPECT(call.Args[4] == static_cast<int64_t>(sizeof(ovrParticleInstance)));
+            FW_EXPECT(call.Args[5] == a.Offset);
+        } else if (strcmp(call.Name, "glVertexAttribDivisor") == 0) {
+            FW_EXPECT(call.Args[1] == 1);
+        }
+    }
+    FW_EXPECT(numPointers == 2);
+    const std::vector<uint8_t>& indices = FakeGlBufferData(geo.indexBuffer);
+    const uint16_t expectedIndices[6] = {0, 1, 2, 0, 2, 3};
+    FW_EXPECT(indices.size() == sizeof(expectedIndices));
+    FW_EXPECT(
+        indices.size() == sizeof(expectedIndices) &&
+        memcmp(indices.data(), expectedIndices, sizeof(expectedIndices)) == 0);
+
+    // the records are uploaded as they are, and the buffer grows when they don't fit
+    std::vector<ovrParticleInstance> instances(10);
+    for (size_t i = 0; i < instances.size(); i++) {
+        PackParticleInstance(
+            instances[i],
+            Vector3f(static_cast<float>(i), 0.0f, 0.0f),
+            1.0f,
+            0.0f,
+            Vector4f(1.0f),
+            Vector2f(0.0f),
+            Vector2f(1.0f));
+    }
+    for (const int count : {3, 10, 0}) {
+        UpdateBillboardInstances(geo, instances.data(), count, sizeof(ovrParticleInstance));
+        const std::vector<uint8_t>& data = FakeGlBufferData(geo.vertexBuffer);
+        const size_t size = count * sizeof(ovrParticleInstance);
+        FW_EXPECT(data.size() == static_cast<size_t>(geo.vertexBufferSize));
+        FW_EXPECT(data.size() >= size && memcmp(data.data(), instances.data(), size) == 0);
+    }
+    FW_EXPECT(geo.vertexBufferSize == 10 * static_cast<int>(sizeof(ovrParticleInstance)));
+    geo.Free();
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::TestPackScalars();
+    OVRFW::TestParticles();
+    OVRFW::TestGlyphs();
+    OVRFW::TestGeometry();
+    return FW_TEST_RESULT();
+}
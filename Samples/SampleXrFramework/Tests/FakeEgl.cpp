@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   FakeEgl.cpp
+Content     :   Stands in for Egl.c: a context that is never created and no GL extensions.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "FakeGl.h"
+
+OpenGLExtensions_t glExtensions = {};
+
+PFNEGLCREATESYNCKHRPROC eglCreateSyncKHR_ = nullptr;
+PFNEGLDESTROYSYNCKHRPROC eglDestroySyncKHR_ = nullptr;
+PFNEGLCLIENTWAITSYNCKHRPROC eglClientWaitSyncKHR_ = nullptr;
+PFNEGLSIGNALSYNCKHRPROC eglSignalSyncKHR_ = nullptr;
+PFNEGLGETSYNCATTRIBKHRPROC eglGetSyncAttribKHR_ = nullptr;
+PFNEGLDUPNATIVEFENCEFDANDROIDPROC eglDupNativeFenceFDANDROID_ = nullptr;
+PFNGLINVALIDATEFRAMEBUFFER_ glInvalidateFramebuffer_ = nullptr;
+PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64vEXT_ = nullptr;
+
+extern "C" {
+
+// The runtime is handed this for the graphics binding, it finds nothing either.
+__eglMustCastToProperFunctionPointerType EGLAPIENTRY eglGetProcAddress(const char*) {
+    return nullptr;
+}
+
+} // extern "C"
+
+void* EglGetExtensionProc(const char*) {
+    return nullptr;
+}
+
+void EglInitExtensions() {}
+
+void ovrEgl_Clear(ovrEgl* egl) {
+    egl->MajorVersion = 0;
+    egl->MinorVersion = 0;
+    egl->Display = EGL_NO_DISPLAY;
+    egl->Config = 0;
+    egl->TinySurface = EGL_NO_SURFACE;
+    egl->MainSurface = EGL_NO_SURFACE;
+    egl->Context = EGL_NO_CONTEXT;
+}
+
+// The handles are never dereferenced, they only have to be set.
+void ovrEgl_CreateContext(ovrEgl* egl, const ovrEgl*) {
+    ovrEgl_Clear(egl);
+    egl->MajorVersion = 1;
+    egl->MinorVersion = 5;
+    egl->Display = reinterpret_cast<EGLDisplay>(1);
+    egl->Config = reinterpret_cast<EGLConfig>(1);
+    egl->Context = reinterpret_cast<EGLContext>(1);
+}
+
+void ovrEgl_DestroyContext(ovrEgl* egl) {
+    ovrEgl_Clear(egl);
+}
+
+void GL_Finish() {}
+
+void GL_Flush() {}
+
+void GL_InvalidateFramebuffer(const enum invalidateTarget_t, const bool, const bool) {}
+
+const char* GlFrameBufferStatusString(GLenum) {
+    return "GL_FRAMEBUFFER_COMPLETE";
+}
+
+const char* EglErrorString(const EGLint) {
+    return "EGL_SUCCESS";
+}
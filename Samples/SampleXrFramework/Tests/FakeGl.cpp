@@ -0,0 +1,676 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   FakeGl.cpp
+Content     :   GL ES entry points that record the command stream instead of rendering.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "FakeGl.h"
+
+#include <string.h>
+#include <map>
+
+namespace OVRFW {
+
+namespace {
+
+struct ovrFakeGlState {
+    std::vector<ovrFakeGlCall> Calls;
+    std::map<GLuint, std::vector<uint8_t>> Buffers;
+    std::map<GLenum, GLuint> BoundBuffers;
+    GLuint NextName = 1;
+    int UniformBufferOffsetAlignment = 256;
+};
+
+} // namespace
+
+static ovrFakeGlState& State() {
+    static ovrFakeGlState state;
+    return state;
+}
+
+static void Record(
+    const char* name,
+    const int64_t a0 = 0,
+    const int64_t a1 = 0,
+    const int64_t a2 = 0,
+    const int64_t a3 = 0,
+    const int64_t a4 = 0,
+    const int64_t a5 = 0) {
+    State().Calls.push_back({name, {a0, a1, a2, a3, a4, a5}});
+}
+
+static std::vector<uint8_t>* BoundBuffer(const GLenum target) {
+    auto bound = State().BoundBuffers.find(target);
+    if (bound == State().BoundBuffers.end()) {
+        return nullptr;
+    }
+    auto buffer = State().Buffers.find(bound->second);
+    return (buffer != State().Buffers.end()) ? &buffer->second : nullptr;
+}
+
+void FakeGlReset() {
+    const int alignment = State().UniformBufferOffsetAlignment;
+    State() = ovrFakeGlState();
+    State().UniformBufferOffsetAlignment = alignment;
+}
+
+const std::vector<ovrFakeGlCall>& FakeGlCalls() {
+    return State().Calls;
+}
+
+void FakeGlClearCalls() {
+    State().Calls.clear();
+}
+
+int FakeGlCount(const char* name) {
+    int count = 0;
+    for (const ovrFakeGlCall& call : State().Calls) {
+        count += (strcmp(call.Name, name) == 0) ? 1 : 0;
+    }
+    return count;
+}
+
+const std::vector<uint8_t>& FakeGlBufferData(const GLuint buffer) {
+    static const std::vector<uint8_t> empty;
+    auto it = State().Buffers.find(buffer);
+    return (it != State().Buffers.end()) ? it->second : empty;
+}
+
+int FakeGlNumBuffers() {
+    return static_cast<int>(State().Buffers.size());
+}
+
+void FakeGlSetUniformBufferOffsetAlignment(const int alignment) {
+    State().UniformBufferOffsetAlignment = alignment;
+}
+
+} // namespace OVRFW
+
+using OVRFW::Record;
+using OVRFW::State;
+
+extern "C" {
+
+bool GLCheckErrorsWithTitle(const char*) {
+    return false;
+}
+
+void GL_APIENTRY glGetIntegerv(GLenum pname, GLint* data) {
+    Record("glGetIntegerv", pname);
+    switch (pname) {
+        case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT:
+            *data = State().UniformBufferOffsetAlignment;
+            break;
+        case GL_MAJOR_VERSION:
+            *data = 3;
+            break;
+        case GL_MINOR_VERSION:
+            *data = 2;
+            break;
+        default:
+            *data = 0;
+            break;
+    }
+}
+
+GLenum GL_APIENTRY glGetError() {
+    return GL_NO_ERROR;
+}
+
+//--------------------------------------------------------------
+// buffers
+
+void GL_APIENTRY glGenBuffers(GLsizei n, GLuint* buffers) {
+    for (GLsizei i = 0; i < n; i++) {
+        buffers[i] = State().NextName++;
+        State().Buffers[buffers[i]];
+    }
+    Record("glGenBuffers", n);
+}
+
+void GL_APIENTRY glDeleteBuffers(GLsizei n, const GLuint* buffers) {
+    for (GLsizei i = 0; i < n; i++) {
+        State().Buffers.erase(buffers[i]);
+        Record("glDeleteBuffers", buffers[i]);
+    }
+}
+
+void GL_APIENTRY glBindBuffer(GLenum target, GLuint buffer) {
+    State().BoundBuffers[target] = buffer;
+    Record("glBindBuffer", target, buffer);
+}
+
+void GL_APIENTRY glBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    State().BoundBuffers[target] = buffer;
+    Record("glBindBufferBase", target, index, buffer);
+}
+
+void GL_APIENTRY
+glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    State().BoundBuffers[target] = buffer;
+    Record("glBindBufferRange", target, index, buffer, offset, size);
+}
+
+void GL_APIENTRY glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    std::vector<uint8_t>* buffer = OVRFW::BoundBuffer(target);
+    if (buffer != nullptr) {
+        buffer->assign(size, 0);
+        if (data != nullptr) {
+            memcpy(buffer->data(), data, size);
+        }
+    }
+    Record("glBufferData", target, size, usage);
+}
+
+void GL_APIENTRY
+glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    std::vector<uint8_t>* buffer = OVRFW::BoundBuffer(target);
+    if (buffer != nullptr && offset + size <= static_cast<GLintptr>(buffer->size())) {
+        memcpy(buffer->data() + offset, data, size);
+    }
+    Record("glBufferSubData", target, offset, size);
+}
+
+void* GL_APIENTRY
+glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    Record("glMapBufferRange", target, offset, length, access);
+    std::vector<uint8_t>* buffer = OVRFW::BoundBuffer(target);
+    if (buffer == nullptr || offset + length > static_cast<GLintptr>(buffer->size())) {
+        return nullptr;
+    }
+    return buffer->data() + offset;
+}
+
+GLboolean GL_APIENTRY glUnmapBuffer(GLenum target) {
+    Record("glUnmapBuffer", target);
+    return GL_TRUE;
+}
+
+//--------------------------------------------------------------
+// sync objects, which the fake completes immediately
+
+GLsync GL_APIENTRY glFenceSync(GLenum condition, GLbitfield flags) {
+    Record("glFenceSync", condition, flags);
+    return reinterpret_cast<GLsync>(static_cast<intptr_t>(State().NextName++));
+}
+
+GLenum GL_APIENTRY glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
+    Record("glClientWaitSync", reinterpret_cast<intptr_t>(sync), flags, timeout);
+    return GL_ALREADY_SIGNALED;
+}
+
+void GL_APIENTRY glDeleteSync(GLsync sync) {
+    Record("glDeleteSync", reinterpret_cast<intptr_t>(sync));
+}
+
+//--------------------------------------------------------------
+// vertex arrays
+
+void GL_APIENTRY glGenVertexArrays(GLsizei n, GLuint* arrays) {
+    for (GLsizei i = 0; i < n; i++) {
+        arrays[i] = State().NextName++;
+    }
+    Record("glGenVertexArrays", n);
+}
+
+void GL_APIENTRY glDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
+    for (GLsizei i = 0; i < n; i++) {
+        Record("glDeleteVertexArrays", arrays[i]);
+    }
+}
+
+void GL_APIENTRY glBindVertexArray(GLuint array) {
+    Record("glBindVertexArray", array);
+}
+
+void GL_APIENTRY glEnableVertexAttribArray(GLuint index) {
+    Record("glEnableVertexAttribArray", index);
+}
+
+void GL_APIENTRY glDisableVertexAttribArray(GLuint index) {
+    Record("glDisableVertexAttribArray", index);
+}
+
+void GL_APIENTRY glVertexAttribPointer(
+    GLuint index,
+    GLint size,
+    GLenum type,
+    GLboolean normalized,
+    GLsizei stride,
+    const void* pointer) {
+    Record(
+        "glVertexAttribPointer",
+        index,
+        size,
+        type,
+        normalized,
+        stride,
+        reinterpret_cast<intptr_t>(pointer));
+}
+
+void GL_APIENTRY glVertexAttribIPointer(
+    GLuint index,
+    GLint size,
+    GLenum type,
+    GLsizei stride,
+    const void* pointer) {
+    Record(
+        "glVertexAttribIPointer",
+        index,
+        size,
+        type,
+        stride,
+        reinterpret_cast<intptr_t>(pointer));
+}
+
+void GL_APIENTRY glVertexAttribDivisor(GLuint index, GLuint divisor) {
+    Record("glVertexAttribDivisor", index, divisor);
+}
+
+//--------------------------------------------------------------
+// draws
+
+void GL_APIENTRY glDrawElements(GLenum mode, GLsizei count, GLenum type, const void*) {
+    Record("glDrawElements", mode, count, type);
+}
+
+void GL_APIENTRY glDrawElementsInstanced(
+    GLenum mode,
+    GLsizei count,
+    GLenum type,
+    const void*,
+    GLsizei instancecount) {
+    Record("glDrawElementsInstanced", mode, count, type, instancecount);
+}
+
+//--------------------------------------------------------------
+// programs and textures
+
+void GL_APIENTRY glUseProgram(GLuint program) {
+    Record("glUseProgram", program);
+}
+
+void GL_APIENTRY glActiveTexture(GLenum texture) {
+    Record("glActiveTexture", texture);
+}
+
+void GL_APIENTRY glBindTexture(GLenum target, GLuint texture) {
+    Record("glBindTexture", target, texture);
+}
+
+void GL_APIENTRY glUniform1i(GLint location, GLint) {
+    Record("glUniform1i", location);
+}
+
+void GL_APIENTRY glUniform1f(GLint location, GLfloat) {
+    Record("glUniform1f", location);
+}
+
+void GL_APIENTRY glUniform1iv(GLint location, GLsizei count, const GLint*) {
+    Record("glUniform1iv", location, count);
+}
+
+void GL_APIENTRY glUniform2iv(GLint location, GLsizei count, const GLint*) {
+    Record("glUniform2iv", location, count);
+}
+
+void GL_APIENTRY glUniform3iv(GLint location, GLsizei count, const GLint*) {
+    Record("glUniform3iv", location, count);
+}
+
+void GL_APIENTRY glUniform4iv(GLint location, GLsizei count, const GLint*) {
+    Record("glUniform4iv", location, count);
+}
+
+void GL_APIENTRY glUniform2fv(GLint location, GLsizei count, const GLfloat*) {
+    Record("glUniform2fv", location, count);
+}
+
+void GL_APIENTRY glUniform3fv(GLint location, GLsizei count, const GLfloat*) {
+    Record("glUniform3fv", location, count);
+}
+
+void GL_APIENTRY glUniform4fv(GLint location, GLsizei count, const GLfloat*) {
+    Record("glUniform4fv", location, count);
+}
+
+void GL_APIENTRY
+glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat*) {
+    Record("glUniformMatrix4fv", location, count, transpose);
+}
+
+//--------------------------------------------------------------
+// fixed function state
+
+void GL_APIENTRY glEnable(GLenum cap) {
+    Record("glEnable", cap);
+}
+
+void GL_APIENTRY glDisable(GLenum cap) {
+    Record("glDisable", cap);
+}
+
+void GL_APIENTRY glBlendEquation(GLenum mode) {
+    Record("glBlendEquation", mode);
+}
+
+void GL_APIENTRY glBlendEquationSeparate(GLenum modeRGB, GLenum modeAlpha) {
+    Record("glBlendEquationSeparate", modeRGB, modeAlpha);
+}
+
+void GL_APIENTRY glBlendFunc(GLenum sfactor, GLenum dfactor) {
+    Record("glBlendFunc", sfactor, dfactor);
+}
+
+void GL_APIENTRY glBlendFuncSeparate(
+    GLenum sfactorRGB,
+    GLenum dfactorRGB,
+    GLenum sfactorAlpha,
+    GLenum dfactorAlpha) {
+    Record("glBlendFuncSeparate", sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
+}
+
+void GL_APIENTRY glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) {
+    Record("glColorMask", red, green, blue, alpha);
+}
+
+void GL_APIENTRY glDepthFunc(GLenum func) {
+    Record("glDepthFunc", func);
+}
+
+void GL_APIENTRY glDepthMask(GLboolean flag) {
+    Record("glDepthMask", flag);
+}
+
+void GL_APIENTRY glDepthRangef(GLfloat, GLfloat) {
+    Record("glDepthRangef");
+}
+
+void GL_APIENTRY glFrontFace(GLenum mode) {
+    Record("glFrontFace", mode);
+}
+
+void GL_APIENTRY glLineWidth(GLfloat) {
+    Record("glLineWidth");
+}
+
+void GL_APIENTRY glPolygonOffset(GLfloat, GLfloat) {
+    Record("glPolygonOffset");
+}
+
+//--------------------------------------------------------------
+// shaders, which always compile and link, every uniform has a location
+
+GLuint GL_APIENTRY glCreateShader(GLenum type) {
+    Record("glCreateShader", type);
+    return State().NextName++;
+}
+
+void GL_APIENTRY glDeleteShader(GLuint shader) {
+    Record("glDeleteShader", shader);
+}
+
+void GL_APIENTRY
+glShaderSource(GLuint shader, GLsizei count, const GLchar* const*, const GLint*) {
+    Record("glShaderSource", shader, count);
+}
+
+void GL_APIENTRY glCompileShader(GLuint shader) {
+    Record("glCompileShader", shader);
+}
+
+void GL_APIENTRY glGetShaderiv(GLuint shader, GLenum pname, GLint* params) {
+    Record("glGetShaderiv", shader, pname);
+    *params = (pname == GL_COMPILE_STATUS) ? GL_TRUE : 0;
+}
+
+void GL_APIENTRY glGetShaderInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+    if (length != nullptr) {
+        *length = 0;
+    }
+    if (bufSize > 0) {
+        infoLog[0] = '\0';
+    }
+}
+
+GLuint GL_APIENTRY glCreateProgram() {
+    Record("glCreateProgram");
+    return State().NextName++;
+}
+
+void GL_APIENTRY glDeleteProgram(GLuint program) {
+    Record("glDeleteProgram", program);
+}
+
+void GL_APIENTRY glAttachShader(GLuint program, GLuint shader) {
+    Record("glAttachShader", program, shader);
+}
+
+void GL_APIENTRY glBindAttribLocation(GLuint program, GLuint index, const GLchar*) {
+    Record("glBindAttribLocation", program, index);
+}
+
+void GL_APIENTRY glLinkProgram(GLuint program) {
+    Record("glLinkProgram", program);
+}
+
+void GL_APIENTRY glGetProgramiv(GLuint program, GLenum pname, GLint* params) {
+    Record("glGetProgramiv", program, pname);
+    *params = (pname == GL_LINK_STATUS) ? GL_TRUE : 0;
+}
+
+void GL_APIENTRY glGetProgramInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+    if (length != nullptr) {
+        *length = 0;
+    }
+    if (bufSize > 0) {
+        infoLog[0] = '\0';
+    }
+}
+
+GLint GL_APIENTRY glGetUniformLocation(GLuint program, const GLchar*) {
+    Record("glGetUniformLocation", program);
+    return static_cast<GLint>(State().NextName++);
+}
+
+GLuint GL_APIENTRY glGetUniformBlockIndex(GLuint program, const GLchar*) {
+    Record("glGetUniformBlockIndex", program);
+    return State().NextName++;
+}
+
+void GL_APIENTRY glUniformBlockBinding(GLuint program, GLuint blockIndex, GLuint binding) {
+    Record("glUniformBlockBinding", program, blockIndex, binding);
+}
+
+//--------------------------------------------------------------
+// texture objects, the image data is dropped
+
+void GL_APIENTRY glGenTextures(GLsizei n, GLuint* textures) {
+    for (GLsizei i = 0; i < n; i++) {
+        textures[i] = State().NextName++;
+    }
+    Record("glGenTextures", n);
+}
+
+void GL_APIENTRY glDeleteTextures(GLsizei n, const GLuint* textures) {
+    for (GLsizei i = 0; i < n; i++) {
+        Record("glDeleteTextures", textures[i]);
+    }
+}
+
+void GL_APIENTRY glTexImage2D(
+    GLenum target,
+    GLint level,
+    GLint internalformat,
+    GLsizei width,
+    GLsizei height,
+    GLint,
+    GLenum,
+    GLenum,
+    const void*) {
+    Record("glTexImage2D", target, level, internalformat, width, height);
+}
+
+void GL_APIENTRY glCompressedTexImage2D(
+    GLenum target,
+    GLint level,
+    GLenum internalformat,
+    GLsizei width,
+    GLsizei height,
+    GLint,
+    GLsizei imageSize,
+    const void*) {
+    Record("glCompressedTexImage2D", target, level, internalformat, width, height, imageSize);
+}
+
+void GL_APIENTRY glTexParameteri(GLenum target, GLenum pname, GLint param) {
+    Record("glTexParameteri", target, pname, param);
+}
+
+void GL_APIENTRY glTexParameterf(GLenum target, GLenum pname, GLfloat) {
+    Record("glTexParameterf", target, pname);
+}
+
+void GL_APIENTRY glGenerateMipmap(GLenum target) {
+    Record("glGenerateMipmap", target);
+}
+
+//--------------------------------------------------------------
+// framebuffers, always complete
+
+void GL_APIENTRY glGenFramebuffers(GLsizei n, GLuint* framebuffers) {
+    for (GLsizei i = 0; i < n; i++) {
+        framebuffers[i] = State().NextName++;
+    }
+    Record("glGenFramebuffers", n);
+}
+
+void GL_APIENTRY glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers) {
+    for (GLsizei i = 0; i < n; i++) {
+        Record("glDeleteFramebuffers", framebuffers[i]);
+    }
+}
+
+void GL_APIENTRY glBindFramebuffer(GLenum target, GLuint framebuffer) {
+    Record("glBindFramebuffer", target, framebuffer);
+}
+
+void GL_APIENTRY glFramebufferTexture2D(
+    GLenum target,
+    GLenum attachment,
+    GLenum textarget,
+    GLuint texture,
+    GLint level) {
+    Record("glFramebufferTexture2D", target, attachment, textarget, texture, level);
+}
+
+void GL_APIENTRY glFramebufferRenderbuffer(
+    GLenum target,
+    GLenum attachment,
+    GLenum renderbuffertarget,
+    GLuint renderbuffer) {
+    Record("glFramebufferRenderbuffer", target, attachment, renderbuffertarget, renderbuffer);
+}
+
+GLenum GL_APIENTRY glCheckFramebufferStatus(GLenum target) {
+    Record("glCheckFramebufferStatus", target);
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void GL_APIENTRY
+glInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenum*) {
+    Record("glInvalidateFramebuffer", target, numAttachments);
+}
+
+void GL_APIENTRY glGenRenderbuffers(GLsizei n, GLuint* renderbuffers) {
+    for (GLsizei i = 0; i < n; i++) {
+        renderbuffers[i] = State().NextName++;
+    }
+    Record("glGenRenderbuffers", n);
+}
+
+void GL_APIENTRY glDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) {
+    for (GLsizei i = 0; i < n; i++) {
+        Record("glDeleteRenderbuffers", renderbuffers[i]);
+    }
+}
+
+void GL_APIENTRY glBindRenderbuffer(GLenum target, GLuint renderbuffer) {
+    Record("glBindRenderbuffer", target, renderbuffer);
+}
+
+void GL_APIENTRY glRenderbufferStorage(
+    GLenum target,
+    GLenum internalformat,
+    GLsizei width,
+    GLsizei height) {
+    Record("glRenderbufferStorage", target, internalformat, width, height);
+}
+
+void GL_APIENTRY glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    Record("glViewport", x, y, width, height);
+}
+
+void GL_APIENTRY glScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+    Record("glScissor", x, y, width, height);
+}
+
+void GL_APIENTRY glClearColor(GLfloat, GLfloat, GLfloat, GLfloat) {
+    Record("glClearColor");
+}
+
+void GL_APIENTRY glClear(GLbitfield mask) {
+    Record("glClear", mask);
+}
+
+//--------------------------------------------------------------
+// queries, never available
+
+void GL_APIENTRY glGenQueries(GLsizei n, GLuint* ids) {
+    for (GLsizei i = 0; i < n; i++) {
+        ids[i] = State().NextName++;
+    }
+    Record("glGenQueries", n);
+}
+
+void GL_APIENTRY glDeleteQueries(GLsizei n, const GLuint* ids) {
+    for (GLsizei i = 0; i < n; i++) {
+        Record("glDeleteQueries", ids[i]);
+    }
+}
+
+void GL_APIENTRY glBeginQuery(GLenum target, GLuint id) {
+    Record("glBeginQuery", target, id);
+}
+
+void GL_APIENTRY glEndQuery(GLenum target) {
+    Record("glEndQuery", target);
+}
+
+void GL_APIENTRY glGetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params) {
+    Record("glGetQueryObjectuiv", id, pname);
+    *params = 0;
+}
+
+} // extern "C"
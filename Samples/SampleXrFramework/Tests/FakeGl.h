@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   FakeGl.h
+Content     :   GL ES entry points that record the command stream instead of rendering.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include "Render/Egl.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace OVRFW {
+
+// One recorded GL call. Args holds the integer arguments in order, pointers are dropped.
+struct ovrFakeGlCall {
+    const char* Name;
+    int64_t Args[6];
+};
+
+// Clears the recorded calls and all buffer and vertex array state.
+void FakeGlReset();
+
+const std::vector<ovrFakeGlCall>& FakeGlCalls();
+void FakeGlClearCalls();
+// Number of recorded calls of the named function.
+int FakeGlCount(const char* name);
+
+// Contents of a buffer object, empty if it does not exist.
+const std::vector<uint8_t>& FakeGlBufferData(const GLuint buffer);
+int FakeGlNumBuffers();
+
+// What GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT reports, 256 by default. The version reported is
+// GL ES 3.2, every other integer is 0.
+void FakeGlSetUniformBufferOffsetAlignment(const int alignment);
+
+} // namespace OVRFW
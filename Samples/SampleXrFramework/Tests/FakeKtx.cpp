@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   FakeKtx.cpp
+Content     :   libktx entry points for the host tests, which do not build libktx.
+                Every KTX2 texture fails to load, the loaders fall back to no texture.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include <ktx.h>
+
+extern "C" {
+
+KTX_error_code
+ktxTexture_CreateFromMemory(const ktx_uint8_t*, ktx_size_t, ktxTextureCreateFlags, ktxTexture**) {
+    return KTX_UNSUPPORTED_FEATURE;
+}
+
+KTX_error_code ktxTexture2_TranscodeBasis(ktxTexture2*, ktx_transcode_fmt_e, ktx_transcode_flags) {
+    return KTX_UNSUPPORTED_FEATURE;
+}
+
+KTX_error_code ktxTexture_GLUpload(ktxTexture*, GLuint*, GLenum*, GLenum*) {
+    return KTX_UNSUPPORTED_FEATURE;
+}
+
+} // extern "C"
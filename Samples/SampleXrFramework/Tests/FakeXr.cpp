@@ -0,0 +1,785 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   FakeXr.cpp
+Content     :   OpenXR entry points that stand in for the runtime and count the calls.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "FakeXr.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "OVR_Math.h"
+
+namespace OVRFW {
+
+namespace {
+
+// Handles and paths of the stub runtime start here, clear of the ones the tests make up.
+const uintptr_t FIRST_HANDLE = 0x10000;
+const XrPath FIRST_PATH = 0x10000;
+const uint32_t SWAPCHAIN_IMAGE_COUNT = 3;
+
+// XrSwapchainImageOpenGLKHR and XrSwapchainImageOpenGLESKHR share this layout.
+struct ovrFakeXrSwapchainImageGL {
+    XrStructureType type;
+    void* next;
+    uint32_t image;
+};
+
+// XrGraphicsRequirementsOpenGLKHR and XrGraphicsRequirementsOpenGLESKHR share this layout.
+struct ovrFakeXrGraphicsRequirementsGL {
+    XrStructureType type;
+    void* next;
+    XrVersion minApiVersionSupported;
+    XrVersion maxApiVersionSupported;
+};
+
+struct ovrFakeXrSwapchain {
+    std::vector<uint32_t> Images;
+    uint32_t NextImage = 0;
+};
+
+struct ovrFakeXrState {
+    std::vector<const char*> Calls;
+    std::map<std::pair<XrAction, XrPath>, float> ActionStates;
+    std::map<XrPath, XrPath> InteractionProfiles;
+    XrResult InteractionProfileResult = XR_SUCCESS;
+
+    uintptr_t NextHandle = FIRST_HANDLE;
+    uint32_t NextTexture = 0x100000;
+    std::vector<std::string> Paths; // path FIRST_PATH + i
+    std::map<std::string, ovrFakeXrPoseScript> PoseScripts;
+    // user path of the pose script, empty for LOCAL and STAGE
+    std::map<XrSpace, std::string> Spaces;
+    std::map<XrSwapchain, ovrFakeXrSwapchain> Swapchains;
+    XrSession Session = XR_NULL_HANDLE;
+    std::deque<XrSessionState> SessionStates; // not polled yet
+    bool SessionRunning = false;
+    bool FrameBegun = false;
+    XrTime DisplayTime = 1000000000;
+    int EndedFrames = 0;
+    uint32_t LastLayerCount = 0;
+    float Ipd = 0.064f;
+    uint32_t ViewWidth = 1024;
+    uint32_t ViewHeight = 1024;
+};
+
+} // namespace
+
+static ovrFakeXrState& State() {
+    static ovrFakeXrState state;
+    return state;
+}
+
+static void Record(const char* name) {
+    State().Calls.push_back(name);
+}
+
+static float ActionState(const XrActionStateGetInfo* getInfo) {
+    const auto it = State().ActionStates.find({getInfo->action, getInfo->subactionPath});
+    return (it != State().ActionStates.end()) ? it->second : 0.0f;
+}
+
+template <typename T>
+static T NewHandle() {
+    return FakeXrHandle<T>(State().NextHandle++);
+}
+
+static XrPath InternPath(const char* pathString) {
+    std::vector<std::string>& paths = State().Paths;
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (paths[i] == pathString) {
+            return FIRST_PATH + i;
+        }
+    }
+    paths.push_back(pathString);
+    return FIRST_PATH + paths.size() - 1;
+}
+
+static const std::string* FindPath(XrPath path) {
+    const std::vector<std::string>& paths = State().Paths;
+    if (path < FIRST_PATH || path - FIRST_PATH >= paths.size()) {
+        return nullptr;
+    }
+    return &paths[path - FIRST_PATH];
+}
+
+static OVR::Posef ScriptedPose(const std::string& userPath, XrTime time) {
+    const auto it = State().PoseScripts.find(userPath);
+    if (userPath.empty() || it == State().PoseScripts.end()) {
+        return OVR::Posef::Identity();
+    }
+    const XrPosef pose = it->second(time);
+    return OVR::Posef(
+        OVR::Quatf(pose.orientation.x, pose.orientation.y, pose.orientation.z, pose.orientation.w),
+        OVR::Vector3f(pose.position.x, pose.position.y, pose.position.z));
+}
+
+// Pose of a space created by the stub in LOCAL, false for the spaces the tests make up.
+static bool SpacePose(XrSpace space, XrTime time, OVR::Posef& pose) {
+    const auto it = State().Spaces.find(space);
+    if (it == State().Spaces.end()) {
+        return false;
+    }
+    pose = ScriptedPose(it->second, time);
+    return true;
+}
+
+static XrPosef ToXrPosef(const OVR::Posef& pose) {
+    XrPosef xrPose;
+    xrPose.orientation = {pose.Rotation.x, pose.Rotation.y, pose.Rotation.z, pose.Rotation.w};
+    xrPose.position = {pose.Translation.x, pose.Translation.y, pose.Translation.z};
+    return xrPose;
+}
+
+// The two call idiom of the enumerate functions.
+template <typename T>
+static XrResult Enumerate(
+    const std::vector<T>& values,
+    uint32_t capacityInput,
+    uint32_t* countOutput,
+    T* output) {
+    *countOutput = static_cast<uint32_t>(values.size());
+    if (capacityInput == 0) {
+        return XR_SUCCESS;
+    }
+    if (capacityInput < values.size()) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    for (size_t i = 0; i < values.size(); i++) {
+        output[i] = values[i];
+    }
+    return XR_SUCCESS;
+}
+
+static void QueueSessionStates(std::initializer_list<XrSessionState> states) {
+    State().SessionStates.insert(State().SessionStates.end(), states);
+}
+
+void FakeXrReset() {
+    State() = ovrFakeXrState();
+}
+
+const std::vector<const char*>& FakeXrCalls() {
+    return State().Calls;
+}
+
+void FakeXrClearCalls() {
+    State().Calls.clear();
+}
+
+int FakeXrCount(const char* name) {
+    int count = 0;
+    for (const char* call : State().Calls) {
+        if (strcmp(call, name) == 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void FakeXrSetActionState(XrAction action, XrPath subactionPath, const float value) {
+    State().ActionStates[{action, subactionPath}] = value;
+}
+
+void FakeXrSetInteractionProfile(XrPath topLevelUserPath, XrPath interactionProfile) {
+    State().InteractionProfiles[topLevelUserPath] = interactionProfile;
+}
+
+void FakeXrSetInteractionProfileResult(const XrResult result) {
+    State().InteractionProfileResult = result;
+}
+
+void FakeXrSetPoseScript(const char* userPath, ovrFakeXrPoseScript script) {
+    State().PoseScripts[userPath] = script;
+}
+
+void FakeXrSetIpd(const float ipd) {
+    State().Ipd = ipd;
+}
+
+void FakeXrSetViewSize(const uint32_t width, const uint32_t height) {
+    State().ViewWidth = width;
+    State().ViewHeight = height;
+}
+
+int FakeXrEndedFrames() {
+    return State().EndedFrames;
+}
+
+uint32_t FakeXrLastLayerCount() {
+    return State().LastLayerCount;
+}
+
+} // namespace OVRFW
+
+using namespace OVRFW;
+
+// The graphics extensions are spelled out, their names are in openxr_platform.h.
+static const char* const FAKE_XR_EXTENSIONS[] = {
+    "XR_KHR_opengl_es_enable",
+    "XR_MNDX_egl_enable",
+    XR_KHR_COMPOSITION_LAYER_CUBE_EXTENSION_NAME,
+    XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME,
+    XR_KHR_COMPOSITION_LAYER_COLOR_SCALE_BIAS_EXTENSION_NAME};
+
+static XRAPI_ATTR XrResult XRAPI_CALL EnumerateInstanceExtensionProperties(
+    const char*,
+    uint32_t propertyCapacityInput,
+    uint32_t* propertyCountOutput,
+    XrExtensionProperties* properties) {
+    Record("xrEnumerateInstanceExtensionProperties");
+    const uint32_t count = sizeof(FAKE_XR_EXTENSIONS) / sizeof(FAKE_XR_EXTENSIONS[0]);
+    *propertyCountOutput = count;
+    if (propertyCapacityInput == 0) {
+        return XR_SUCCESS;
+    }
+    if (propertyCapacityInput < count) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        snprintf(
+            properties[i].extensionName,
+            XR_MAX_EXTENSION_NAME_SIZE,
+            "%s",
+            FAKE_XR_EXTENSIONS[i]);
+        properties[i].extensionVersion = 1;
+    }
+    return XR_SUCCESS;
+}
+
+static XRAPI_ATTR XrResult XRAPI_CALL
+EnumerateApiLayerProperties(uint32_t, uint32_t* propertyCountOutput, XrApiLayerProperties*) {
+    Record("xrEnumerateApiLayerProperties");
+    *propertyCountOutput = 0;
+    return XR_SUCCESS;
+}
+
+static XRAPI_ATTR XrResult XRAPI_CALL GetOpenGLGraphicsRequirements(
+    XrInstance,
+    XrSystemId,
+    ovrFakeXrGraphicsRequirementsGL* graphicsRequirements) {
+    Record("xrGetOpenGLESGraphicsRequirementsKHR");
+    graphicsRequirements->minApiVersionSupported = XR_MAKE_VERSION(3, 0, 0);
+    graphicsRequirements->maxApiVersionSupported = XR_MAKE_VERSION(3, 2, 0);
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrGetInstanceProcAddr(XrInstance, const char* name, PFN_xrVoidFunction* function) {
+    Record("xrGetInstanceProcAddr");
+    if (strcmp(name, "xrEnumerateInstanceExtensionProperties") == 0) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(EnumerateInstanceExtensionProperties);
+    } else if (strcmp(name, "xrEnumerateApiLayerProperties") == 0) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(EnumerateApiLayerProperties);
+    } else if (
+        strcmp(name, "xrGetOpenGLESGraphicsRequirementsKHR") == 0 ||
+        strcmp(name, "xrGetOpenGLGraphicsRequirementsKHR") == 0) {
+        *function = reinterpret_cast<PFN_xrVoidFunction>(GetOpenGLGraphicsRequirements);
+    } else {
+        *function = nullptr;
+        return XR_ERROR_FUNCTION_UNSUPPORTED;
+    }
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrCreateInstance(const XrInstanceCreateInfo*, XrInstance* instance) {
+    Record("xrCreateInstance");
+    *instance = NewHandle<XrInstance>();
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrDestroyInstance(XrInstance) {
+    Record("xrDestroyInstance");
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrGetInstanceProperties(XrInstance, XrInstanceProperties* instanceProperties) {
+    Record("xrGetInstanceProperties");
+    instanceProperties->runtimeVersion = XR_MAKE_VERSION(1, 0, 0);
+    snprintf(instanceProperties->runtimeName, XR_MAX_RUNTIME_NAME_SIZE, "FakeXr");
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrResultToString(XrInstance, XrResult value, char buffer[XR_MAX_RESULT_STRING_SIZE]) {
+    snprintf(buffer, XR_MAX_RESULT_STRING_SIZE, "XrResult(%d)", static_cast<int>(value));
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrGetSystem(XrInstance, const XrSystemGetInfo* getInfo, XrSystemId* systemId) {
+    Record("xrGetSystem");
+    if (getInfo->formFactor != XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY) {
+        return XR_ERROR_FORM_FACTOR_UNAVAILABLE;
+    }
+    *systemId = 1;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrGetSystemProperties(XrInstance, XrSystemId systemId, XrSystemProperties* properties) {
+    Record("xrGetSystemProperties");
+    properties->systemId = systemId;
+    properties->vendorId = 0;
+    snprintf(properties->systemName, XR_MAX_SYSTEM_NAME_SIZE, "FakeXr");
+    properties->graphicsProperties.maxSwapchainImageWidth = 4096;
+    properties->graphicsProperties.maxSwapchainImageHeight = 4096;
+    properties->graphicsProperties.maxLayerCount = XR_MIN_COMPOSITION_LAYERS_SUPPORTED;
+    properties->trackingProperties.orientationTracking = XR_TRUE;
+    properties->trackingProperties.positionTracking = XR_TRUE;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrStringToPath(XrInstance, const char* pathString, XrPath* path) {
+    Record("xrStringToPath");
+    *path = InternPath(pathString);
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrPollEvent(XrInstance, XrEventDataBuffer* eventData) {
+    Record("xrPollEvent");
+    if (State().SessionStates.empty()) {
+        return XR_EVENT_UNAVAILABLE;
+    }
+    XrEventDataSessionStateChanged event = {XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED};
+    event.session = State().Session;
+    event.state = State().SessionStates.front();
+    event.time = State().DisplayTime;
+    State().SessionStates.pop_front();
+    memcpy(eventData, &event, sizeof(event));
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrCreateSession(XrInstance, const XrSessionCreateInfo*, XrSession* session) {
+    Record("xrCreateSession");
+    *session = NewHandle<XrSession>();
+    State().Session = *session;
+    QueueSessionStates({XR_SESSION_STATE_IDLE, XR_SESSION_STATE_READY});
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrDestroySession(XrSession) {
+    Record("xrDestroySession");
+    State().Session = XR_NULL_HANDLE;
+    State().SessionStates.clear();
+    State().SessionRunning = false;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrBeginSession(XrSession, const XrSessionBeginInfo*) {
+    Record("xrBeginSession");
+    if (State().SessionRunning) {
+        return XR_ERROR_SESSION_RUNNING;
+    }
+    State().SessionRunning = true;
+    QueueSessionStates(
+        {XR_SESSION_STATE_SYNCHRONIZED, XR_SESSION_STATE_VISIBLE, XR_SESSION_STATE_FOCUSED});
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrRequestExitSession(XrSession) {
+    Record("xrRequestExitSession");
+    if (!State().SessionRunning) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    QueueSessionStates(
+        {XR_SESSION_STATE_VISIBLE, XR_SESSION_STATE_SYNCHRONIZED, XR_SESSION_STATE_STOPPING});
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrEndSession(XrSession) {
+    Record("xrEndSession");
+    if (!State().SessionRunning) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    State().SessionRunning = false;
+    QueueSessionStates({XR_SESSION_STATE_IDLE, XR_SESSION_STATE_EXITING});
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateViewConfigurations(
+    XrInstance,
+    XrSystemId,
+    uint32_t viewConfigurationTypeCapacityInput,
+    uint32_t* viewConfigurationTypeCountOutput,
+    XrViewConfigurationType* viewConfigurationTypes) {
+    Record("xrEnumerateViewConfigurations");
+    return Enumerate<XrViewConfigurationType>(
+        {XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO},
+        viewConfigurationTypeCapacityInput,
+        viewConfigurationTypeCountOutput,
+        viewConfigurationTypes);
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrGetViewConfigurationProperties(
+    XrInstance,
+    XrSystemId,
+    XrViewConfigurationType viewConfigurationType,
+    XrViewConfigurationProperties* configurationProperties) {
+    Record("xrGetViewConfigurationProperties");
+    configurationProperties->viewConfigurationType = viewConfigurationType;
+    configurationProperties->fovMutable = XR_FALSE;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateViewConfigurationViews(
+    XrInstance,
+    XrSystemId,
+    XrViewConfigurationType,
+    uint32_t viewCapacityInput,
+    uint32_t* viewCountOutput,
+    XrViewConfigurationView* views) {
+    Record("xrEnumerateViewConfigurationViews");
+    *viewCountOutput = 2;
+    if (viewCapacityInput == 0) {
+        return XR_SUCCESS;
+    }
+    if (viewCapacityInput < 2) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    for (uint32_t i = 0; i < 2; i++) {
+        views[i].recommendedImageRectWidth = State().ViewWidth;
+        views[i].maxImageRectWidth = 4096;
+        views[i].recommendedImageRectHeight = State().ViewHeight;
+        views[i].maxImageRectHeight = 4096;
+        views[i].recommendedSwapchainSampleCount = 1;
+        views[i].maxSwapchainSampleCount = 4;
+    }
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateReferenceSpaces(
+    XrSession,
+    uint32_t spaceCapacityInput,
+    uint32_t* spaceCountOutput,
+    XrReferenceSpaceType* spaces) {
+    Record("xrEnumerateReferenceSpaces");
+    return Enumerate<XrReferenceSpaceType>(
+        {XR_REFERENCE_SPACE_TYPE_VIEW,
+         XR_REFERENCE_SPACE_TYPE_LOCAL,
+         XR_REFERENCE_SPACE_TYPE_STAGE},
+        spaceCapacityInput,
+        spaceCountOutput,
+        spaces);
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrCreateReferenceSpace(XrSession, const XrReferenceSpaceCreateInfo* createInfo, XrSpace* space) {
+    Record("xrCreateReferenceSpace");
+    *space = NewHandle<XrSpace>();
+    State().Spaces[*space] =
+        (createInfo->referenceSpaceType == XR_REFERENCE_SPACE_TYPE_VIEW) ? "/user/head" : "";
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrGetReferenceSpaceBoundsRect(XrSession, XrReferenceSpaceType, XrExtent2Df* bounds) {
+    Record("xrGetReferenceSpaceBoundsRect");
+    bounds->width = 2.0f;
+    bounds->height = 2.0f;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrCreateActionSpace(XrSession, const XrActionSpaceCreateInfo* createInfo, XrSpace* space) {
+    Record("xrCreateActionSpace");
+    *space = NewHandle<XrSpace>();
+    const std::string* userPath = FindPath(createInfo->subactionPath);
+    State().Spaces[*space] = (userPath != nullptr) ? *userPath : "";
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrDestroySpace(XrSpace space) {
+    Record("xrDestroySpace");
+    State().Spaces.erase(space);
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrCreateActionSet(XrInstance, const XrActionSetCreateInfo*, XrActionSet* actionSet) {
+    Record("xrCreateActionSet");
+    *actionSet = NewHandle<XrActionSet>();
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrCreateAction(XrActionSet, const XrActionCreateInfo*, XrAction* action) {
+    Record("xrCreateAction");
+    *action = NewHandle<XrAction>();
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrSuggestInteractionProfileBindings(XrInstance, const XrInteractionProfileSuggestedBinding*) {
+    Record("xrSuggestInteractionProfileBindings");
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrAttachSessionActionSets(XrSession, const XrSessionActionSetsAttachInfo*) {
+    Record("xrAttachSessionActionSets");
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrGetActionStatePose(XrSession, const XrActionStateGetInfo*, XrActionStatePose* state) {
+    Record("xrGetActionStatePose");
+    state->isActive = XR_TRUE;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrWaitFrame(XrSession, const XrFrameWaitInfo*, XrFrameState* frameState) {
+    Record("xrWaitFrame");
+    if (!State().SessionRunning) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    State().DisplayTime += FAKE_XR_DISPLAY_PERIOD;
+    frameState->predictedDisplayTime = State().DisplayTime;
+    frameState->predictedDisplayPeriod = FAKE_XR_DISPLAY_PERIOD;
+    frameState->shouldRender = XR_TRUE;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrBeginFrame(XrSession, const XrFrameBeginInfo*) {
+    Record("xrBeginFrame");
+    if (!State().SessionRunning) {
+        return XR_ERROR_SESSION_NOT_RUNNING;
+    }
+    State().FrameBegun = true;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrEndFrame(XrSession, const XrFrameEndInfo* frameEndInfo) {
+    Record("xrEndFrame");
+    if (!State().FrameBegun) {
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
+    State().FrameBegun = false;
+    State().EndedFrames++;
+    State().LastLayerCount = frameEndInfo->layerCount;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrLocateViews(
+    XrSession,
+    const XrViewLocateInfo* viewLocateInfo,
+    XrViewState* viewState,
+    uint32_t viewCapacityInput,
+    uint32_t* viewCountOutput,
+    XrView* views) {
+    Record("xrLocateViews");
+    *viewCountOutput = 2;
+    if (viewCapacityInput < 2) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    const XrTime time = viewLocateInfo->displayTime;
+    OVR::Posef base = OVR::Posef::Identity();
+    SpacePose(viewLocateInfo->space, time, base);
+    const OVR::Posef head = ScriptedPose("/user/head", time);
+    for (uint32_t eye = 0; eye < 2; eye++) {
+        const float x = (eye == 0 ? -0.5f : 0.5f) * State().Ipd;
+        const OVR::Posef eyeFromHead(OVR::Quatf(), OVR::Vector3f(x, 0.0f, 0.0f));
+        views[eye].pose = ToXrPosef(base.Inverted() * head * eyeFromHead);
+        views[eye].fov = {-0.8f, 0.8f, 0.8f, -0.8f};
+    }
+    viewState->viewStateFlags = XR_VIEW_STATE_ORIENTATION_VALID_BIT |
+        XR_VIEW_STATE_POSITION_VALID_BIT | XR_VIEW_STATE_ORIENTATION_TRACKED_BIT |
+        XR_VIEW_STATE_POSITION_TRACKED_BIT;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateSwapchainFormats(
+    XrSession,
+    uint32_t formatCapacityInput,
+    uint32_t* formatCountOutput,
+    int64_t* formats) {
+    Record("xrEnumerateSwapchainFormats");
+    // GL_SRGB8_ALPHA8, GL_RGBA8
+    return Enumerate<int64_t>({0x8C43, 0x8058}, formatCapacityInput, formatCountOutput, formats);
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrCreateSwapchain(XrSession, const XrSwapchainCreateInfo*, XrSwapchain* swapchain) {
+    Record("xrCreateSwapchain");
+    *swapchain = NewHandle<XrSwapchain>();
+    ovrFakeXrSwapchain& fakeSwapchain = State().Swapchains[*swapchain];
+    for (uint32_t i = 0; i < SWAPCHAIN_IMAGE_COUNT; i++) {
+        fakeSwapchain.Images.push_back(State().NextTexture++);
+    }
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrDestroySwapchain(XrSwapchain swapchain) {
+    Record("xrDestroySwapchain");
+    State().Swapchains.erase(swapchain);
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrEnumerateSwapchainImages(
+    XrSwapchain swapchain,
+    uint32_t imageCapacityInput,
+    uint32_t* imageCountOutput,
+    XrSwapchainImageBaseHeader* images) {
+    Record("xrEnumerateSwapchainImages");
+    const auto it = State().Swapchains.find(swapchain);
+    if (it == State().Swapchains.end()) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    const std::vector<uint32_t>& textures = it->second.Images;
+    *imageCountOutput = static_cast<uint32_t>(textures.size());
+    if (imageCapacityInput == 0) {
+        return XR_SUCCESS;
+    }
+    if (imageCapacityInput < textures.size()) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    ovrFakeXrSwapchainImageGL* glImages = reinterpret_cast<ovrFakeXrSwapchainImageGL*>(images);
+    for (size_t i = 0; i < textures.size(); i++) {
+        glImages[i].image = textures[i];
+    }
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrAcquireSwapchainImage(
+    XrSwapchain swapchain,
+    const XrSwapchainImageAcquireInfo*,
+    uint32_t* index) {
+    Record("xrAcquireSwapchainImage");
+    const auto it = State().Swapchains.find(swapchain);
+    if (it == State().Swapchains.end()) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    *index = it->second.NextImage;
+    it->second.NextImage = (it->second.NextImage + 1) % SWAPCHAIN_IMAGE_COUNT;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrWaitSwapchainImage(XrSwapchain, const XrSwapchainImageWaitInfo*) {
+    Record("xrWaitSwapchainImage");
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrReleaseSwapchainImage(XrSwapchain, const XrSwapchainImageReleaseInfo*) {
+    Record("xrReleaseSwapchainImage");
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrSyncActions(XrSession, const XrActionsSyncInfo*) {
+    Record("xrSyncActions");
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) {
+    Record("xrLocateSpace");
+    location->locationFlags = XR_SPACE_LOCATION_ORIENTATION_VALID_BIT |
+        XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT |
+        XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
+    OVR::Posef pose;
+    if (SpacePose(space, time, pose)) {
+        OVR::Posef base = OVR::Posef::Identity();
+        SpacePose(baseSpace, time, base);
+        location->pose = ToXrPosef(base.Inverted() * pose);
+        return XR_SUCCESS;
+    }
+    location->pose.orientation = {0.0f, 0.0f, 0.0f, 1.0f};
+    location->pose.position = {static_cast<float>(reinterpret_cast<uintptr_t>(space)), 0, 0};
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrGetActionStateBoolean(
+    XrSession,
+    const XrActionStateGetInfo* getInfo,
+    XrActionStateBoolean* state) {
+    Record("xrGetActionStateBoolean");
+    state->currentState = (ActionState(getInfo) != 0.0f) ? XR_TRUE : XR_FALSE;
+    state->isActive = XR_TRUE;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL
+xrGetActionStateFloat(XrSession, const XrActionStateGetInfo* getInfo, XrActionStateFloat* state) {
+    Record("xrGetActionStateFloat");
+    state->currentState = ActionState(getInfo);
+    state->isActive = XR_TRUE;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrGetActionStateVector2f(
+    XrSession,
+    const XrActionStateGetInfo* getInfo,
+    XrActionStateVector2f* state) {
+    Record("xrGetActionStateVector2f");
+    const float value = ActionState(getInfo);
+    state->currentState = {value, -value};
+    state->isActive = XR_TRUE;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrGetCurrentInteractionProfile(
+    XrSession,
+    XrPath topLevelUserPath,
+    XrInteractionProfileState* interactionProfile) {
+    Record("xrGetCurrentInteractionProfile");
+    if (XR_FAILED(State().InteractionProfileResult)) {
+        return State().InteractionProfileResult;
+    }
+    const auto it = State().InteractionProfiles.find(topLevelUserPath);
+    interactionProfile->interactionProfile =
+        (it != State().InteractionProfiles.end()) ? it->second : XR_NULL_PATH;
+    return XR_SUCCESS;
+}
+
+XRAPI_ATTR XrResult XRAPI_CALL xrPathToString(
+    XrInstance,
+    XrPath path,
+    uint32_t bufferCapacityInput,
+    uint32_t* bufferCountOutput,
+    char* buffer) {
+    Record("xrPathToString");
+    char name[XR_MAX_PATH_LENGTH];
+    const std::string* pathString = FindPath(path);
+    const int length = (pathString != nullptr)
+        ? snprintf(name, sizeof(name), "%s", pathString->c_str())
+        : snprintf(name, sizeof(name), "/interaction_profiles/fake/%llu", (unsigned long long)path);
+    *bufferCountOutput = static_cast<uint32_t>(length + 1);
+    if (bufferCapacityInput < *bufferCountOutput) {
+        return XR_ERROR_SIZE_INSUFFICIENT;
+    }
+    memcpy(buffer, name, length + 1);
+    return XR_SUCCESS;
+}
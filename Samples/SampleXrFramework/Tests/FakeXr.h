@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   FakeXr.h
+Content     :   OpenXR entry points that stand in for the runtime and count the calls.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include <openxr/openxr.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace OVRFW {
+
+// Handles are never dereferenced, so any non-zero value names an object. Handles are
+// pointers on the 64-bit hosts the tests run on.
+template <typename T>
+T FakeXrHandle(const uintptr_t value) {
+    return reinterpret_cast<T>(value);
+}
+
+// Clears the recorded calls, action states, interaction profiles, poses and every object of
+// the stub runtime.
+void FakeXrReset();
+
+// Names of the OpenXR functions called, in order.
+const std::vector<const char*>& FakeXrCalls();
+void FakeXrClearCalls();
+// Number of recorded calls of the named function.
+int FakeXrCount(const char* name);
+
+// State reported for the action and subaction path, 0 by default. Boolean actions report
+// value != 0, vector actions (value, -value).
+void FakeXrSetActionState(XrAction action, XrPath subactionPath, const float value);
+
+// Spaces made up with FakeXrHandle are located with every location bit set, at x = the handle
+// value of the space.
+
+// Interaction profile reported for the top level user path, XR_NULL_PATH by default.
+void FakeXrSetInteractionProfile(XrPath topLevelUserPath, XrPath interactionProfile);
+// Result of xrGetCurrentInteractionProfile, XR_SUCCESS by default.
+void FakeXrSetInteractionProfileResult(const XrResult result);
+
+// The rest of the entry points are a stub runtime, enough for XrApp::MainLoop to run without a
+// headset. The session is READY once created and FOCUSED once begun, xrRequestExitSession
+// takes it to STOPPING and xrEndSession to EXITING. xrWaitFrame does not block, it advances
+// the predicted display time by FAKE_XR_DISPLAY_PERIOD. Swapchain images are GL texture names
+// that are never created, so FakeGl.cpp is enough to render into them.
+
+// 90 Hz
+static const XrDuration FAKE_XR_DISPLAY_PERIOD = 11111111;
+
+typedef std::function<XrPosef(XrTime)> ovrFakeXrPoseScript;
+
+// Pose over the display time of the spaces created for the user path, in the LOCAL and STAGE
+// spaces, which coincide. "/user/head" is the VIEW reference space, other paths are the
+// subaction paths of action spaces, such as "/user/hand/left". Identity by default.
+void FakeXrSetPoseScript(const char* userPath, ovrFakeXrPoseScript script);
+
+// The views are located IPD apart on the x axis of the head, 0.064 by default.
+void FakeXrSetIpd(const float ipd);
+// Recommended size of the views, 1024 x 1024 by default.
+void FakeXrSetViewSize(const uint32_t width, const uint32_t height);
+
+// Frames ended with xrEndFrame, and the number of layers of the last one.
+int FakeXrEndedFrames();
+uint32_t FakeXrLastLayerCount();
+
+} // namespace OVRFW
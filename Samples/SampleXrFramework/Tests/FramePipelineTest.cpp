@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   FramePipelineTest.cpp
+Content     :   Handoff between the rendering and simulation threads of PipelinedFrames.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+// Drives ovrFramePipeline the way XrApp::RenderPipelinedFrame() does, with a scene that
+// replaces its world model like OvrSceneView: the replacement happens on the rendering thread
+// while the simulation thread is idle, and the replaced model is freed one handoff later.
+// Rendering checks that every surface of the frame it was handed belongs to a live model.
+
+#include "FramePipeline.h"
+
+#include "FrameworkTest.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace OVRFW {
+
+struct ovrTestModel {
+    ovrSurfaceDef Surface;
+    int Id = 0;
+};
+
+// Stands in for the world model handling of OvrSceneView.
+class ovrTestScene {
+   public:
+    ~ovrTestScene() {
+        FreeRetired();
+        delete World;
+    }
+
+    // Like OvrSceneView::UpdateWorldModelLoads(), called on the rendering thread.
+    void UpdateLoads(const bool replace) {
+        FreeRetired();
+        if (replace) {
+            if (World != nullptr) {
+                Retired.push_back(World);
+            }
+            World = new ovrTestModel();
+            World->Id = ++LastId;
+            Live[&World->Surface] = World->Id;
+        }
+    }
+
+    // Like OvrSceneView::Frame() and GenerateFrameSurfaceList(), called on the simulation
+    // thread. The model id goes in the matrix, since a freed model's address can be reused.
+    void Simulate(ovrFramePipeline::ovrFrame& frame) const {
+        OVR::Matrix4f modelMatrix;
+        modelMatrix.M[0][3] = static_cast<float>(World->Id);
+        frame.Out.Surfaces.push_back(ovrDrawSurface(modelMatrix, &World->Surface));
+    }
+
+    bool IsLive(const ovrDrawSurface& surface) const {
+        const auto it = Live.find(surface.surface);
+        return it != Live.end() && it->second == static_cast<int>(surface.modelMatrix.M[0][3]);
+    }
+
+   private:
+    void FreeRetired() {
+        for (ovrTestModel* model : Retired) {
+            Live.erase(&model->Surface);
+            delete model;
+        }
+        Retired.clear();
+    }
+
+    ovrTestModel* World = nullptr;
+    std::vector<ovrTestModel*> Retired;
+    std::map<const ovrSurfaceDef*, int> Live;
+    int LastId = 0;
+};
+
+static void SleepMicroseconds(const int microseconds) {
+    std::this_thread::sleep_for(std::chrono::microseconds(microseconds));
+}
+
+static void TestHandoff() {
+    ovrTestScene scene;
+    scene.UpdateLoads(true);
+
+    const std::thread::id mainThread = std::this_thread::get_id();
+    std::atomic<bool> simulating(false);
+    std::atomic<int> wrongThread(0);
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> delay(0, 200);
+    std::atomic<int> simulateDelay(0);
+
+    ovrFramePipeline pipeline;
+    pipeline.Start("Test::Simulate", [&](ovrFramePipeline::ovrFrame& frame) {
+        simulating = true;
+        if (std::this_thread::get_id() == mainThread) {
+            wrongThread++;
+        }
+        SleepMicroseconds(simulateDelay);
+        scene.Simulate(frame);
+        simulating = false;
+    });
+    FW_EXPECT(pipeline.IsRunning());
+
+    int notLive = 0;
+    int notIdle = 0;
+    int wrongFrame = 0;
+    int changed = 0;
+    for (int64_t frameIndex = 1; frameIndex <= 500; frameIndex++) {
+        pipeline.Wait();
+        if (simulating) {
+            notIdle++;
+        }
+        scene.UpdateLoads(frameIndex % 3 == 0);
+
+        ovrApplFrameIn in;
+        in.FrameIndex = frameIndex;
+        simulateDelay = delay(random);
+        ovrFramePipeline::ovrFrame& frame = pipeline.Advance(in, ovrRendererOutput());
+
+        // the first frame has nothing simulated before it
+        if (frame.In.FrameIndex != (frameIndex == 1 ? 1 : frameIndex - 1)) {
+            wrongFrame++;
+        }
+        const std::vector<ovrDrawSurface> surfaces = frame.Out.Surfaces;
+        SleepMicroseconds(delay(random));
+        for (const ovrDrawSurface& surface : frame.Out.Surfaces) {
+            if (!scene.IsLive(surface)) {
+                notLive++;
+            }
+        }
+        if (frame.Out.Surfaces.size() != 1 || surfaces.size() != 1 ||
+            frame.Out.Surfaces[0].surface != surfaces[0].surface) {
+            changed++;
+        }
+    }
+    pipeline.Stop();
+    FW_EXPECT(!pipeline.IsRunning());
+
+    FW_EXPECT(wrongThread == 0);
+    FW_EXPECT(notIdle == 0);
+    FW_EXPECT(wrongFrame == 0);
+    FW_EXPECT(notLive == 0);
+    FW_EXPECT(changed == 0);
+}
+
+static void TestDiscardAndRestart() {
+    std::atomic<int> simulated(0);
+    const ovrFramePipeline::SimulateFunc simulate = [&](ovrFramePipeline::ovrFrame& frame) {
+        frame.Out.Surfaces.resize(frame.In.FrameIndex);
+        simulated++;
+    };
+
+    ovrFramePipeline pipeline;
+    for (int run = 0; run < 2; run++) {
+        pipeline.Start("Test::Simulate", simulate);
+        ovrApplFrameIn in;
+        in.FrameIndex = 1;
+        FW_EXPECT(pipeline.Advance(in, ovrRendererOutput()).Out.Surfaces.size() == 1);
+        in.FrameIndex = 2;
+        FW_EXPECT(pipeline.Advance(in, ovrRendererOutput()).In.FrameIndex == 1);
+
+        // a discarded frame is not rendered, the next one is simulated first
+        pipeline.Wait();
+        pipeline.Discard();
+        in.FrameIndex = 3;
+        const ovrFramePipeline::ovrFrame& frame = pipeline.Advance(in, ovrRendererOutput());
+        FW_EXPECT(frame.In.FrameIndex == 3);
+        FW_EXPECT(frame.Out.Surfaces.size() == 3);
+        pipeline.Stop();
+    }
+    FW_EXPECT(simulated == 6);
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::TestHandoff();
+    OVRFW::TestDiscardAndRestart();
+    return FW_TEST_RESULT();
+}
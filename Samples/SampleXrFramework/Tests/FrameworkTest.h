@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   FrameworkTest.h
+Content     :   Minimal checks for the host unit tests.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include <stdio.h>
+
+namespace OVRFW {
+
+inline int& TestFailureCount() {
+    static int count = 0;
+    return count;
+}
+
+} // namespace OVRFW
+
+// Reports a failed condition and keeps running, so one run lists every failure.
+#define FW_EXPECT(cond)                                                     \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("%s(%d): FAILED: %s\n", __FILE__, __LINE__, #cond);      \
+            OVRFW::TestFailureCount()++;                                    \
+        }                                                                   \
+    } while (0)
+
+// Returned from main, non-zero fails the test.
+#define FW_TEST_RESULT() (OVRFW::TestFailureCount() == 0 ? 0 : 1)
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   GeometryOptimizerTest.cpp
+Content     :   The load time triangle and vertex reordering keeps the mesh intact.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "Render/GeometryOptimizer.h"
+
+#include "FrameworkTest.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+using OVR::Vector2f;
+using OVR::Vector3f;
+using OVR::Vector4f;
+
+namespace OVRFW {
+
+typedef std::array<uint32_t, 3> Triangle;
+
+// A grid of n by n vertices, with the triangles and the corners of each triangle in
+// random order.  uv0.x holds the original index of each vertex so remapped vertices
+// can be traced back.  The last unusedCount vertices are not used by any triangle.
+static void MakeShuffledGrid(
+    const int n,
+    const int unusedCount,
+    VertexAttribs& attribs,
+    std::vector<uint32_t>& indices,
+    std::mt19937& random) {
+    const int vertexCount = n * n + unusedCount;
+    attribs = VertexAttribs();
+    for (int i = 0; i < vertexCount; i++) {
+        const float x = static_cast<float>(i % n);
+        const float y = static_cast<float>(i / n);
+        attribs.position.push_back(Vector3f(x, y, 0.1f * static_cast<float>((i * 7) % 5)));
+        attribs.normal.push_back(Vector3f(0.0f, 0.0f, 1.0f));
+        attribs.color.push_back(Vector4f(x / n, y / n, 0.5f, 1.0f));
+        attribs.uv0.push_back(Vector2f(static_cast<float>(i), 0.0f));
+    }
+
+    std::vector<Triangle> triangles;
+    for (int y = 0; y < n - 1; y++) {
+        for (int x = 0; x < n - 1; x++) {
+            const uint32_t i0 = y * n + x;
+            triangles.push_back({i0, i0 + 1, i0 + n});
+            triangles.push_back({i0 + 1, i0 + n + 1, i0 + n});
+        }
+    }
+    std::shuffle(triangles.begin(), triangles.end(), random);
+    indices.clear();
+    for (const Triangle& t : triangles) {
+        const int r = static_cast<int>(random() % 3);
+        indices.push_back(t[r]);
+        indices.push_back(t[(r + 1) % 3]);
+        indices.push_back(t[(r + 2) % 3]);
+    }
+}
+
+// The triangles as original vertex indices, each rotated to start at its smallest index so
+// the winding is kept, and sorted.
+static std::vector<Triangle> CanonicalTriangles(
+    const std::vector<uint32_t>& indices,
+    const VertexAttribs& attribs) {
+    std::vector<Triangle> triangles;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        Triangle t;
+        for (int j = 0; j < 3; j++) {
+            t[j] = static_cast<uint32_t>(attribs.uv0[indices[i + j]].x);
+        }
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+        triangles.push_back(t);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+static void TestVertexCache() {
+    std::mt19937 random(1);
+    VertexAttribs attribs;
+    std::vector<uint32_t> indices;
+    MakeShuffledGrid(32, 0, attribs, indices, random);
+    const int vertexCount = static_cast<int>(attribs.position.size());
+    const std::vector<Triangle> original = CanonicalTriangles(indices, attribs);
+    const std::vector<uint32_t> shuffled = indices;
+    const ovrVertexCacheStats before = AnalyzeVertexCache(indices, vertexCount);
+
+    OptimizeVertexCache(indices, vertexCount);
+    FW_EXPECT(CanonicalTriangles(indices, attribs) == original);
+    const ovrVertexCacheStats after = AnalyzeVertexCache(indices, vertexCount);
+    printf("shuffled grid ACMR %.3f -> %.3f\n", before.acmr, after.acmr);
+    FW_EXPECT(after.acmr < before.acmr);
+    // a regular grid can get down to about 0.5 with a 16 entry cache
+    FW_EXPECT(after.acmr < 0.8f);
+    // and it does not depend on the cache size
+    for (const int cacheSize : {8, 12, 24, 32}) {
+        FW_EXPECT(
+            AnalyzeVertexCache(indices, vertexCount, cacheSize).acmr <
+            AnalyzeVertexCache(shuffled, vertexCount, cacheSize).acmr);
+    }
+
+    // optimizing again must not make it worse
+    OptimizeVertexCache(indices, vertexCount);
+    FW_EXPECT(AnalyzeVertexCache(indices, vertexCount).acmr <= after.acmr * 1.01f);
+    FW_EXPECT(CanonicalTriangles(indices, attribs) == original);
+
+    std::vector<uint32_t> empty;
+    OptimizeVertexCache(empty, 0);
+    FW_EXPECT(empty.empty());
+}
+
+static void TestOverdraw() {
+    std::mt19937 random(2);
+    VertexAttribs attribs;
+    std::vector<uint32_t> indices;
+    MakeShuffledGrid(48, 0, attribs, indices, random);
+    const int vertexCount = static_cast<int>(attribs.position.size());
+    const std::vector<Triangle> original = CanonicalTriangles(indices, attribs);
+    OptimizeVertexCache(indices, vertexCount);
+    const float cacheAcmr = AnalyzeVertexCache(indices, vertexCount).acmr;
+
+    for (const float threshold : {1.0f, 1.05f, 1.5f}) {
+        std::vector<uint32_t> reordered = indices;
+        OptimizeOverdraw(reordered, attribs.position, threshold);
+        FW_EXPECT(CanonicalTriangles(reordered, attribs) == original);
+        const float acmr = AnalyzeVertexCache(reordered, vertexCount).acmr;
+        printf("overdraw threshold %.2f ACMR %.3f -> %.3f\n", threshold, cacheAcmr, acmr);
+        // clusters are only cut where the ACMR stays within the threshold
+        FW_EXPECT(acmr <= cacheAcmr * threshold + 1e-4f);
+    }
+}
+
+static void TestVertexFetch() {
+    std::mt19937 random(3);
+    VertexAttribs attribs;
+    std::vector<uint32_t> indices;
+    const int unusedCount = 5;
+    MakeShuffledGrid(16, unusedCount, attribs, indices, random);
+    const int vertexCount = static_cast<int>(attribs.position.size());
+    const VertexAttribs originalAttribs = attribs;
+    const std::vector<Triangle> original = CanonicalTriangles(indices, attribs);
+
+    // two morph targets, one with normals, and an attribute that is only partly filled
+    std::vector<VertexAttribs> targets(2);
+    for (int i = 0; i < vertexCount; i++) {
+        targets[0].position.push_back(Vector3f(0.0f, 0.0f, static_cast<float>(i)));
+        targets[1].position.push_back(Vector3f(static_cast<float>(i), 0.0f, 0.0f));
+        targets[1].normal.push_back(Vector3f(0.0f, static_cast<float>(i), 0.0f));
+    }
+    targets[1].uv1.push_back(Vector2f(1.0f, 2.0f));
+
+    OptimizeVertexFetch(attribs, indices, &targets);
+    FW_EXPECT(static_cast<int>(attribs.position.size()) == vertexCount);
+    FW_EXPECT(CanonicalTriangles(indices, attribs) == original);
+
+    // vertices are numbered in the order the triangles first use them
+    uint32_t next = 0;
+    for (const uint32_t index : indices) {
+        FW_EXPECT(index <= next);
+        if (index == next) {
+            next++;
+        }
+    }
+    FW_EXPECT(static_cast<int>(next) == vertexCount - unusedCount);
+
+    // every attribute and morph target moved with its vertex
+    bool moved = true;
+    std::vector<int> seen(vertexCount, 0);
+    for (int i = 0; i < vertexCount; i++) {
+        const int o = static_cast<int>(attribs.uv0[i].x);
+        seen[o]++;
+        moved = moved && attribs.position[i] == originalAttribs.position[o];
+        moved = moved && attribs.normal[i] == originalAttribs.normal[o];
+        moved = moved && attribs.color[i] == originalAttribs.color[o];
+        moved = moved && targets[0].position[i].z == static_cast<float>(o);
+        moved = moved && targets[1].position[i].x == static_cast<float>(o);
+        moved = moved && targets[1].normal[i].y == static_cast<float>(o);
+    }
+    FW_EXPECT(moved);
+    FW_EXPECT(std::count(seen.begin(), seen.end(), 1) == vertexCount);
+    // the unused vertices went to the end
+    for (int i = vertexCount - unusedCount; i < vertexCount; i++) {
+        FW_EXPECT(static_cast<int>(attribs.uv0[i].x) >= vertexCount - unusedCount);
+    }
+    FW_EXPECT(targets[1].uv1.size() == 1);
+}
+
+static void TestOptimizeGeometry() {
+    std::mt19937 random(4);
+    VertexAttribs attribs;
+    std::vector<uint32_t> indices;
+    MakeShuffledGrid(24, 0, attribs, indices, random);
+    const std::vector<Triangle> original = CanonicalTriangles(indices, attribs);
+
+    for (const bool overdraw : {false, true}) {
+        VertexAttribs a = attribs;
+        std::vector<TriangleIndex> shortIndices(indices.begin(), indices.end());
+        ovrVertexCacheStats before;
+        ovrVertexCacheStats after;
+        OptimizeGeometry(a, shortIndices, nullptr, overdraw, &before, &after);
+        FW_EXPECT(after.acmr < before.acmr);
+        FW_EXPECT(CanonicalTriangles(
+                      std::vector<uint32_t>(shortIndices.begin(), shortIndices.end()), a) ==
+                  original);
+    }
+
+    // not a triangle list, left alone
+    std::vector<uint32_t> broken = indices;
+    broken.push_back(0);
+    const std::vector<uint32_t> copy = broken;
+    VertexAttribs a = attribs;
+    OptimizeGeometry(a, broken, nullptr, false);
+    FW_EXPECT(broken == copy);
+    broken.pop_back();
+    broken[0] = 100000;
+    const std::vector<uint32_t> outOfRange = broken;
+    OptimizeGeometry(a, broken, nullptr, false);
+    FW_EXPECT(broken == outOfRange);
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::TestVertexCache();
+    OVRFW::TestOverdraw();
+    OVRFW::TestVertexFetch();
+    OVRFW::TestOptimizeGeometry();
+    return FW_TEST_RESULT();
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   GlGeometryBenchmark.cpp
+Content     :   CPU cost of GlGeometry::Update for static and dynamic geometry.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+// Runs against FakeGl, so the times cover the packing, copies and allocations done on the
+// CPU but not the driver. Not run by ctest; run GlGeometryBenchmark directly.
+
+#include "Render/GlGeometry.h"
+
+#include "FakeGl.h"
+
+#include <stdio.h>
+#include <chrono>
+
+using OVR::Vector2f;
+using OVR::Vector3f;
+using OVR::Vector4f;
+
+namespace OVRFW {
+
+static VertexAttribs MakeParticleAttribs(const int numVertices) {
+    VertexAttribs attribs;
+    attribs.position.resize(numVertices);
+    attribs.color.resize(numVertices);
+    attribs.uv0.resize(numVertices);
+    for (int i = 0; i < numVertices; i++) {
+        attribs.position[i] = Vector3f(i * 0.01f, 1.0f, -2.0f);
+        attribs.color[i] = Vector4f(1.0f, 0.5f, 0.25f, 1.0f);
+        attribs.uv0[i] = Vector2f((i & 1) ? 1.0f : 0.0f, (i & 2) ? 1.0f : 0.0f);
+    }
+    return attribs;
+}
+
+// Returns the average microseconds per Update.
+static double TimeUpdates(GlGeometry& geo, const VertexAttribs& attribs, const int iterations) {
+    // warm up, and let dynamic geometry reach its steady state capacity
+    geo.Update(attribs, false);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        geo.Update(attribs, false);
+        FakeGlClearCalls();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+}
+
+static void BenchmarkVertexCount(const int numVertices) {
+    const VertexAttribs attribs = MakeParticleAttribs(numVertices);
+    std::vector<uint32_t> indices(numVertices);
+    for (int i = 0; i < numVertices; i++) {
+        indices[i] = i;
+    }
+    const int iterations = std::max(10, 2000000 / numVertices);
+
+    FakeGlReset();
+    GlGeometry staticGeo;
+    staticGeo.Create(attribs, indices);
+    const double staticTime = TimeUpdates(staticGeo, attribs, iterations);
+    staticGeo.Free();
+
+    FakeGlReset();
+    GlGeometry dynamicGeo;
+    dynamicGeo.CreateDynamic(attribs, indices);
+    const double dynamicTime = TimeUpdates(dynamicGeo, attribs, iterations);
+    dynamicGeo.Free();
+
+    printf(
+        "%7d vertices: static %9.2f us  dynamic %9.2f us  (%.1fx)\n",
+        numVertices,
+        staticTime,
+        dynamicTime,
+        staticTime / dynamicTime);
+}
+
+} // namespace OVRFW
+
+int main() {
+    printf("GlGeometry::Update, position + color + uv0\n");
+    OVRFW::BenchmarkVertexCount(1000);
+    OVRFW::BenchmarkVertexCount(10000);
+    OVRFW::BenchmarkVertexCount(100000);
+    return 0;
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   GlGeometryTest.cpp
+Content     :   Checks the buffer updates of dynamic GlGeometry against a recording fake.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "Render/GlGeometry.h"
+
+#include "FakeGl.h"
+#include "FrameworkTest.h"
+
+#include <new>
+
+using OVR::Vector2f;
+using OVR::Vector3f;
+using OVR::Vector4f;
+
+// Counts heap allocations, so the test can check that updates do not allocate.
+static int NumAllocations = 0;
+
+void* operator new(size_t size) {
+    NumAllocations++;
+    void* p = malloc(size > 0 ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+namespace OVRFW {
+
+static VertexAttribs MakeAttribs(const int numVertices, const float offset) {
+    VertexAttribs attribs;
+    attribs.position.resize(numVertices);
+    attribs.color.resize(numVertices);
+    attribs.uv0.resize(numVertices);
+    for (int i = 0; i < numVertices; i++) {
+        attribs.position[i] = Vector3f(offset + i, 0.0f, 0.0f);
+        attribs.color[i] = Vector4f(1.0f, 1.0f, 1.0f, 1.0f);
+        attribs.uv0[i] = Vector2f(0.0f, 0.0f);
+    }
+    return attribs;
+}
+
+// Updates write the next copy in the ring with one mapping and no allocations.
+static void TestRingUpdates() {
+    FakeGlReset();
+    const std::vector<TriangleIndex> indices = {0, 1, 2};
+    GlGeometry geo;
+    geo.CreateDynamic(MakeAttribs(3, 0.0f), indices, 100);
+    FW_EXPECT(geo.IsDynamic());
+    const uint32_t mask = geo.vertexAttributeMask;
+    const int32_t bufferSize = geo.vertexBufferSize;
+
+    VertexAttribs attribs = MakeAttribs(50, 10.0f);
+    for (int i = 0; i < 2 * GlGeometry::DYNAMIC_BUFFER_COUNT; i++) {
+        FakeGlClearCalls();
+        const uint32_t previousVao = geo.vertexArrayObject;
+        const int allocations = NumAllocations;
+        geo.Update(attribs, false);
+        FW_EXPECT(NumAllocations == allocations);
+        FW_EXPECT(FakeGlCount("glBufferData") == 0);
+        FW_EXPECT(FakeGlCount("glVertexAttribPointer") == 0);
+        FW_EXPECT(FakeGlCount("glMapBufferRange") == 1);
+        FW_EXPECT(geo.vertexArrayObject != previousVao);
+        FW_EXPECT(geo.vertexCount == 50);
+    }
+    FW_EXPECT(geo.vertexAttributeMask == mask);
+    FW_EXPECT(geo.vertexBufferSize == bufferSize);
+
+    // The first copy starts with the positions of the last update written to it.
+    const std::vector<uint8_t>& data = FakeGlBufferData(geo.vertexBuffer);
+    FW_EXPECT(static_cast<int32_t>(data.size()) == bufferSize);
+    const int copy = (2 * GlGeometry::DYNAMIC_BUFFER_COUNT) % GlGeometry::DYNAMIC_BUFFER_COUNT;
+    const Vector3f* positions = reinterpret_cast<const Vector3f*>(
+        data.data() + copy * bufferSize / GlGeometry::DYNAMIC_BUFFER_COUNT);
+    FW_EXPECT(positions[0] == Vector3f(10.0f, 0.0f, 0.0f));
+    FW_EXPECT(positions[49] == Vector3f(59.0f, 0.0f, 0.0f));
+
+    geo.Free();
+}
+
+// An empty update keeps the buffers and attribute layout, instead of reallocating them
+// with zero size.
+static void TestEmptyUpdate() {
+    FakeGlReset();
+    const std::vector<TriangleIndex> indices = {0, 1, 2};
+    GlGeometry geo;
+    geo.CreateDynamic(MakeAttribs(3, 0.0f), indices, 100);
+    const uint32_t mask = geo.vertexAttributeMask;
+    const int32_t bufferSize = geo.vertexBufferSize;
+    FW_EXPECT(mask != 0);
+
+    FakeGlClearCalls();
+    geo.Update(VertexAttribs(), false);
+    FW_EXPECT(FakeGlCalls().empty());
+    FW_EXPECT(geo.vertexCount == 0);
+    FW_EXPECT(geo.vertexAttributeMask == mask);
+    FW_EXPECT(geo.vertexBufferSize == bufferSize);
+    FW_EXPECT(static_cast<int32_t>(FakeGlBufferData(geo.vertexBuffer).size()) == bufferSize);
+
+    // The next non-empty update reuses the buffers.
+    FakeGlClearCalls();
+    geo.Update(MakeAttribs(20, 0.0f), false);
+    FW_EXPECT(FakeGlCount("glBufferData") == 0);
+    FW_EXPECT(geo.vertexCount == 20);
+
+    geo.Free();
+}
+
+// Growing past the reserved capacity reallocates once, doubling the capacity.
+static void TestGrowth() {
+    FakeGlReset();
+    const std::vector<TriangleIndex> indices = {0, 1, 2};
+    GlGeometry geo;
+    geo.CreateDynamic(MakeAttribs(3, 0.0f), indices, 10);
+    FW_EXPECT(geo.dynamicVertexCapacity == 10);
+
+    FakeGlClearCalls();
+    geo.Update(MakeAttribs(15, 0.0f), false);
+    FW_EXPECT(FakeGlCount("glBufferData") == 1);
+    FW_EXPECT(geo.dynamicVertexCapacity == 20);
+
+    FakeGlClearCalls();
+    geo.Update(MakeAttribs(18, 0.0f), false);
+    FW_EXPECT(FakeGlCount("glBufferData") == 0);
+
+    geo.Free();
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::TestRingUpdates();
+    OVRFW::TestEmptyUpdate();
+    OVRFW::TestGrowth();
+    return FW_TEST_RESULT();
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   GlUploadQueueTest.cpp
+Content     :   ovrGlUploadQueue ordering, and the glB loader deferring its GL work to it.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "Render/GlUploadQueue.h"
+#include "Model/ModelFileLoading.h"
+#include "Misc/JobPool.h"
+
+#include "FakeGl.h"
+#include "FrameworkTest.h"
+#include "SyntheticGlb.h"
+
+#include <thread>
+#include <vector>
+
+namespace OVRFW {
+
+static void TestOrder() {
+    ovrGlUploadQueue queue;
+    FW_EXPECT(queue.IsEmpty());
+    std::vector<int> order;
+    for (int i = 0; i < 5; i++) {
+        queue.Push([&order, i]() { order.push_back(i); });
+    }
+    FW_EXPECT(queue.GetPendingCount() == 5);
+
+    FW_EXPECT(queue.Drain(2) == 2);
+    FW_EXPECT(order == std::vector<int>({0, 1}));
+    FW_EXPECT(queue.GetPendingCount() == 3);
+    FW_EXPECT(queue.Drain(0) == 0);
+    FW_EXPECT(queue.Drain(10) == 3);
+    FW_EXPECT(order == std::vector<int>({0, 1, 2, 3, 4}));
+    FW_EXPECT(queue.IsEmpty());
+    FW_EXPECT(queue.Drain(10) == 0);
+}
+
+// A task can push follow up work, which runs after the tasks already queued.
+static void TestFollowUpTasks() {
+    ovrGlUploadQueue queue;
+    std::vector<int> order;
+    queue.Push([&]() {
+        order.push_back(0);
+        queue.Push([&order]() { order.push_back(2); });
+    });
+    queue.Push([&order]() { order.push_back(1); });
+    FW_EXPECT(queue.Drain(2) == 2);
+    FW_EXPECT(queue.GetPendingCount() == 1);
+    queue.DrainAll();
+    FW_EXPECT(order == std::vector<int>({0, 1, 2}));
+}
+
+static void TestAppendAndClear() {
+    ovrGlUploadQueue queue;
+    ovrGlUploadQueue other;
+    std::vector<int> order;
+    queue.Push([&order]() { order.push_back(0); });
+    other.Push([&order]() { order.push_back(1); });
+    other.Push([&order]() { order.push_back(2); });
+    queue.Append(other);
+    FW_EXPECT(other.IsEmpty());
+    FW_EXPECT(queue.GetPendingCount() == 3);
+    queue.Append(queue);
+    FW_EXPECT(queue.GetPendingCount() == 3);
+    queue.DrainAll();
+    FW_EXPECT(order == std::vector<int>({0, 1, 2}));
+
+    queue.Push([&order]() { order.push_back(3); });
+    queue.Clear();
+    FW_EXPECT(queue.IsEmpty());
+    queue.DrainAll();
+    FW_EXPECT(order.size() == 3);
+}
+
+// Tasks pushed from several threads all run, each thread's in its own order.
+static void TestPushFromThreads() {
+    ovrGlUploadQueue queue;
+    const int numThreads = 4;
+    const int numTasks = 1000;
+    std::vector<std::vector<int>> order(numThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++) {
+        threads.emplace_back([&queue, &order, t]() {
+            for (int i = 0; i < numTasks; i++) {
+                queue.Push([&order, t, i]() { order[t].push_back(i); });
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    FW_EXPECT(queue.GetPendingCount() == numThreads * numTasks);
+    queue.DrainAll();
+    for (int t = 0; t < numThreads; t++) {
+        FW_EXPECT(static_cast<int>(order[t].size()) == numTasks);
+        for (int i = 0; i < static_cast<int>(order[t].size()); i++) {
+            FW_EXPECT(order[t][i] == i);
+        }
+    }
+}
+
+// With MaterialParms::UploadQueue the loader returns before creating any GL objects, and
+// draining the queue creates the same objects a load without the queue does.
+static void TestDeferredModelUploads() {
+    ovrSyntheticGlbParms parms;
+    parms.NumMeshes = 3;
+    parms.GridSize = 8;
+    parms.NumImages = 2;
+    parms.ImageSize = 16;
+    const std::vector<char> glb = MakeSyntheticGlb(parms);
+    GlProgram program;
+    const ModelGlPrograms programs(&program);
+    ovrJobPool jobPool(2);
+
+    MaterialParms immediateParms;
+    immediateParms.JobPool = &jobPool;
+    FakeGlReset();
+    ModelFile* immediate = LoadModelFile_glB(
+        "immediate.glb", glb.data(), static_cast<int>(glb.size()), programs, immediateParms);
+    FW_EXPECT(immediate != nullptr);
+    const int numTextures = FakeGlCount("glTexImage2D");
+    const int numBuffers = FakeGlNumBuffers();
+    FW_EXPECT(numTextures >= parms.NumImages);
+    FW_EXPECT(numBuffers >= parms.NumMeshes * 2);
+    delete immediate;
+
+    ovrGlUploadQueue queue;
+    MaterialParms deferredParms;
+    deferredParms.JobPool = &jobPool;
+    deferredParms.UploadQueue = &queue;
+    FakeGlReset();
+    ModelFile* deferred = LoadModelFile_glB(
+        "deferred.glb", glb.data(), static_cast<int>(glb.size()), programs, deferredParms);
+    FW_EXPECT(deferred != nullptr);
+    FW_EXPECT(!queue.IsEmpty());
+    FW_EXPECT(FakeGlCount("glTexImage2D") == 0);
+    FW_EXPECT(FakeGlNumBuffers() == 0);
+    queue.DrainAll();
+    FW_EXPECT(FakeGlCount("glTexImage2D") == numTextures);
+    FW_EXPECT(FakeGlNumBuffers() == numBuffers);
+    if (deferred != nullptr) {
+        FW_EXPECT(deferred->Models.size() == 3);
+        for (const Model& model : deferred->Models) {
+            for (const ModelSurface& surface : model.surfaces) {
+                FW_EXPECT(surface.surfaceDef.geo.indexCount == 7 * 7 * 6);
+                FW_EXPECT(surface.surfaceDef.geo.indexBuffer != 0);
+            }
+        }
+    }
+    delete deferred;
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::TestOrder();
+    OVRFW::TestFollowUpTasks();
+    OVRFW::TestAppendAndClear();
+    OVRFW::TestPushFromThreads();
+    OVRFW::TestDeferredModelUploads();
+
+    return FW_TEST_RESULT();
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   GlyphRasterizerBenchmark.cpp
+Content     :   Cost of runtime generated glyphs compared to loading the prebaked font.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+// Times what BitmapFont::LoadFromRasterizer() and the first use of a new character do on the CPU:
+// rasterizing with ovrTrueTypeRasterizer, the distance field and packing into the atlas, on one
+// thread (the job pool divides the first two by its thread count). The prebaked path is timed
+// as reading efigs.fnt and efigs_sdf.ktx, its glyph table is parsed with OVR::JSON, which does
+// not build on the host. No GL is timed; the bytes the next upload sends are reported instead.
+// The framework ships no .ttf, so pass one: GlyphRasterizerBenchmark font.ttf. Not run by ctest.
+
+#include "Render/TrueTypeRasterizer.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace OVRFW {
+
+static bool ReadFile(const std::string& path, std::vector<uint8_t>& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static double MillisecondsSince(const std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+// Generates the glyphs like BitmapFontLocal::GenerateGlyphs(), returns the number added.
+static int GenerateGlyphs(
+    const ovrTrueTypeRasterizer& font,
+    const int pixelHeight,
+    const uint32_t first,
+    const uint32_t last,
+    ovrSdfGlyphAtlas& atlas) {
+    const int spread = std::max(2, pixelHeight / 8);
+    int count = 0;
+    ovrGlyphBitmap bitmap;
+    std::vector<uint8_t> sdf;
+    for (uint32_t codePoint = first; codePoint <= last; codePoint++) {
+        if (!font.RasterizeGlyph(codePoint, pixelHeight, bitmap) || bitmap.Width == 0) {
+            continue;
+        }
+        GenerateSdf(bitmap.Coverage.data(), bitmap.Width, bitmap.Height, spread, sdf);
+        int x;
+        int y;
+        if (atlas.AddImage(
+                sdf.data(), bitmap.Width + 2 * spread, bitmap.Height + 2 * spread, x, y)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static void BenchmarkPrebaked(const std::string& resPath) {
+    const int iterations = 20;
+    std::vector<uint8_t> fnt;
+    std::vector<uint8_t> ktx;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        if (!ReadFile(resPath + "efigs.fnt", fnt) || !ReadFile(resPath + "efigs_sdf.ktx", ktx)) {
+            printf("prebaked: cannot read %s\n", resPath.c_str());
+            return;
+        }
+    }
+    printf(
+        "prebaked efigs:      read %4zu KB in %7.2f ms, no cost per new character\n",
+        (fnt.size() + ktx.size()) / 1024,
+        MillisecondsSince(start) / iterations);
+}
+
+static void BenchmarkRuntime(
+    const ovrTrueTypeRasterizer& font,
+    const int pixelHeight,
+    const int atlasSize) {
+    const int iterations = 5;
+    ovrSdfGlyphAtlas atlas;
+    int ascii = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        atlas.Init(atlasSize, atlasSize);
+        ascii = GenerateGlyphs(font, pixelHeight, ' ', '~', atlas);
+    }
+    const double asciiTime = MillisecondsSince(start) / iterations;
+    int y;
+    int height;
+    atlas.GetDirtyRows(y, height);
+    const int asciiUpload = atlasSize * height;
+
+    // the characters after ASCII are generated on first use, one at a time
+    atlas.ClearDirty();
+    int latin1 = 0;
+    const auto latin1Start = std::chrono::steady_clock::now();
+    for (uint32_t codePoint = 0xA1; codePoint <= 0xFF; codePoint++) {
+        latin1 += GenerateGlyphs(font, pixelHeight, codePoint, codePoint, atlas);
+    }
+    const double latin1Time = MillisecondsSince(latin1Start);
+    atlas.GetDirtyRows(y, height);
+
+    printf(
+        "runtime %3d px %4d^2: %2d ASCII glyphs in %7.2f ms, upload %4d KB; "
+        "%.3f ms per new glyph, %.0f%% of the atlas used, %d KB upload for %d more\n",
+        pixelHeight,
+        atlasSize,
+        ascii,
+        asciiTime,
+        asciiUpload / 1024,
+        latin1 > 0 ? latin1Time / latin1 : 0.0,
+        atlas.GetUsage() * 100.0f,
+        atlasSize * height / 1024,
+        latin1);
+}
+
+} // namespace OVRFW
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printf("usage: GlyphRasterizerBenchmark font.ttf [res/raw path]\n");
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    OVRFW::ovrTrueTypeRasterizer font;
+    if (!OVRFW::ReadFile(argv[1], data) || !font.LoadFromBuffer(data)) {
+        printf("cannot load %s\n", argv[1]);
+        return 1;
+    }
+    std::string resPath = std::string(__FILE__);
+    resPath = resPath.substr(0, resPath.find_last_of("/\\") + 1) + "../res/raw/";
+    OVRFW::BenchmarkPrebaked(argc > 2 ? std::string(argv[2]) + "/" : resPath);
+    OVRFW::BenchmarkRuntime(font, 32, 512);
+    OVRFW::BenchmarkRuntime(font, 64, 1024);
+    OVRFW::BenchmarkRuntime(font, 96, 1024);
+    return 0;
+}
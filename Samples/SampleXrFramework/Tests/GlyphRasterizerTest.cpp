@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   GlyphRasterizerTest.cpp
+Content     :   ovrTrueTypeRasterizer coverage and the dirty rows of ovrSdfGlyphAtlas.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "Render/TrueTypeRasterizer.h"
+
+#include "FrameworkTest.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace OVRFW {
+
+struct ovrTestPoint {
+    int X;
+    int Y;
+    bool OnCurve;
+};
+
+static void PutU16(std::vector<uint8_t>& data, const uint32_t value) {
+    data.push_back(static_cast<uint8_t>(value >> 8));
+    data.push_back(static_cast<uint8_t>(value));
+}
+
+static void PutU32(std::vector<uint8_t>& data, const uint32_t value) {
+    PutU16(data, value >> 16);
+    PutU16(data, value & 0xFFFF);
+}
+
+static void SetU16(std::vector<uint8_t>& data, const size_t offset, const uint32_t value) {
+    data[offset] = static_cast<uint8_t>(value >> 8);
+    data[offset + 1] = static_cast<uint8_t>(value);
+}
+
+// A glyf entry with uncompressed flags and 16 bit coordinates.
+static std::vector<uint8_t> SimpleGlyph(const std::vector<std::vector<ovrTestPoint>>& contours) {
+    std::vector<uint8_t> glyph;
+    PutU16(glyph, static_cast<uint32_t>(contours.size()));
+    for (int i = 0; i < 4; i++) {
+        PutU16(glyph, 0); // the bounds are not read
+    }
+    int numPoints = 0;
+    for (const auto& contour : contours) {
+        numPoints += static_cast<int>(contour.size());
+        PutU16(glyph, numPoints - 1);
+    }
+    PutU16(glyph, 0); // no instructions
+    for (const auto& contour : contours) {
+        for (const ovrTestPoint& p : contour) {
+            glyph.push_back(p.OnCurve ? 1 : 0);
+        }
+    }
+    int last = 0;
+    for (const auto& contour : contours) {
+        for (const ovrTestPoint& p : contour) {
+            PutU16(glyph, static_cast<uint16_t>(p.X - last));
+            last = p.X;
+        }
+    }
+    last = 0;
+    for (const auto& contour : contours) {
+        for (const ovrTestPoint& p : contour) {
+            PutU16(glyph, static_cast<uint16_t>(p.Y - last));
+            last = p.Y;
+        }
+    }
+    return glyph;
+}
+
+static std::vector<ovrTestPoint> Square(const int x0, const int y0, const int x1, const int y1) {
+    return {{x0, y0, true}, {x0, y1, true}, {x1, y1, true}, {x1, y0, true}};
+}
+
+// 1000 units per em, ascent 800, descent -200, line gap 200. Glyphs:
+// 1 'a' a square from ( 150, 0 ) to ( 450, 300 )
+// 2 'b' only off curve points on the corners of ( 100, 100 ) to ( 500, 500 )
+// 3 'c' glyph 1 moved right by 200
+// 4 'd' a square from ( 100, 100 ) to ( 500, 500 ) with a hole from ( 200, 200 ) to ( 400, 400 )
+// 5 ' ' no outline
+static std::vector<uint8_t> BuildTestFont(const bool fullCmap) {
+    std::vector<std::vector<uint8_t>> glyphs(6);
+    glyphs[1] = SimpleGlyph({Square(150, 0, 450, 300)});
+    glyphs[2] = SimpleGlyph(
+        {{{100, 100, false}, {100, 500, false}, {500, 500, false}, {500, 100, false}}});
+    PutU16(glyphs[3], 0xFFFF); // -1 contours
+    for (int i = 0; i < 4; i++) {
+        PutU16(glyphs[3], 0);
+    }
+    PutU16(glyphs[3], 0x0003); // args are words and xy values, no more components
+    PutU16(glyphs[3], 1);
+    PutU16(glyphs[3], 200);
+    PutU16(glyphs[3], 0);
+    std::vector<ovrTestPoint> hole = Square(200, 200, 400, 400);
+    std::swap(hole[1], hole[3]); // the other direction
+    glyphs[4] = SimpleGlyph({Square(100, 100, 500, 500), hole});
+    const uint32_t advances[6] = {500, 600, 600, 800, 600, 250};
+
+    std::vector<uint8_t> head(54, 0);
+    SetU16(head, 18, 1000); // units per em
+    SetU16(head, 50, 1); // long loca
+
+    std::vector<uint8_t> hhea(36, 0);
+    SetU16(hhea, 4, 800);
+    SetU16(hhea, 6, static_cast<uint16_t>(-200));
+    SetU16(hhea, 8, 200);
+    SetU16(hhea, 34, 6);
+
+    std::vector<uint8_t> maxp;
+    PutU32(maxp, 0x00005000);
+    PutU16(maxp, 6);
+
+    std::vector<uint8_t> hmtx;
+    std::vector<uint8_t> loca;
+    std::vector<uint8_t> glyf;
+    for (int i = 0; i < 6; i++) {
+        PutU16(hmtx, advances[i]);
+        PutU16(hmtx, 0);
+        PutU32(loca, static_cast<uint32_t>(glyf.size()));
+        glyf.insert(glyf.end(), glyphs[i].begin(), glyphs[i].end());
+    }
+    PutU32(loca, static_cast<uint32_t>(glyf.size()));
+
+    std::vector<uint8_t> cmap;
+    PutU16(cmap, 0);
+    PutU16(cmap, 1); // one subtable
+    PutU16(cmap, 3);
+    if (fullCmap) {
+        PutU16(cmap, 10);
+        PutU32(cmap, 12);
+        PutU16(cmap, 12); // format
+        PutU16(cmap, 0);
+        PutU32(cmap, 16 + 3 * 12);
+        PutU32(cmap, 0);
+        PutU32(cmap, 3); // groups
+        const uint32_t groups[3][3] = {{0x20, 0x20, 5}, {0x61, 0x64, 1}, {0x1F600, 0x1F600, 1}};
+        for (const auto& group : groups) {
+            PutU32(cmap, group[0]);
+            PutU32(cmap, group[1]);
+            PutU32(cmap, group[2]);
+        }
+    } else {
+        PutU16(cmap, 1);
+        PutU32(cmap, 12);
+        const int segments[3][3] = {
+            {0x20, 0x20, 5 - 0x20}, {0x61, 0x64, 1 - 0x61}, {0xFFFF, 0xFFFF, 1}};
+        PutU16(cmap, 4); // format
+        PutU16(cmap, 16 + 3 * 8);
+        PutU16(cmap, 0);
+        PutU16(cmap, 3 * 2);
+        PutU16(cmap, 0);
+        PutU16(cmap, 0);
+        PutU16(cmap, 0);
+        for (const auto& segment : segments) {
+            PutU16(cmap, segment[1]);
+        }
+        PutU16(cmap, 0);
+        for (const auto& segment : segments) {
+            PutU16(cmap, segment[0]);
+        }
+        for (const auto& segment : segments) {
+            PutU16(cmap, segment[2] & 0xFFFF);
+        }
+        for (int i = 0; i < 3; i++) {
+            PutU16(cmap, 0);
+        }
+    }
+
+    const std::pair<const char*, const std::vector<uint8_t>*> tables[] = {
+        {"cmap", &cmap},
+        {"glyf", &glyf},
+        {"head", &head},
+        {"hhea", &hhea},
+        {"hmtx", &hmtx},
+        {"loca", &loca},
+        {"maxp", &maxp}};
+    const uint32_t numTables = sizeof(tables) / sizeof(tables[0]);
+    std::vector<uint8_t> font;
+    PutU32(font, 0x00010000);
+    PutU16(font, numTables);
+    PutU16(font, 0);
+    PutU16(font, 0);
+    PutU16(font, 0);
+    uint32_t offset = 12 + 16 * numTables;
+    for (const auto& table : tables) {
+        font.insert(font.end(), table.first, table.first + 4);
+        PutU32(font, 0);
+        PutU32(font, offset);
+        PutU32(font, static_cast<uint32_t>(table.second->size()));
+        offset += static_cast<uint32_t>(table.second->size());
+    }
+    for (const auto& table : tables) {
+        font.insert(font.end(), table.second->begin(), table.second->end());
+    }
+    return font;
+}
+
+static float CoveredArea(const ovrGlyphBitmap& bitmap) {
+    float area = 0.0f;
+    for (const uint8_t c : bitmap.Coverage) {
+        area += c / 255.0f;
+    }
+    return area;
+}
+
+static void TestRasterizer(const bool fullCmap) {
+    std::vector<uint8_t> data = BuildTestFont(fullCmap);
+    ovrTrueTypeRasterizer font;
+    FW_EXPECT(font.LoadFromBuffer(data));
+    FW_EXPECT(data.empty());
+    FW_EXPECT(font.GetLineHeight(100) == 120.0f);
+    FW_EXPECT(font.FindGlyphIndex('a') == 1);
+    FW_EXPECT(font.FindGlyphIndex(' ') == 5);
+    FW_EXPECT(font.FindGlyphIndex('z') == 0);
+    FW_EXPECT(font.FindGlyphIndex(0x1F600) == (fullCmap ? 1 : 0));
+
+    // whole pixels
+    ovrGlyphBitmap a;
+    FW_EXPECT(font.RasterizeGlyph('a', 100, a));
+    FW_EXPECT(a.Width == 30 && a.Height == 30);
+    FW_EXPECT(a.BearingX == 15.0f && a.BearingY == 30.0f && a.AdvanceX == 60.0f);
+    FW_EXPECT(a.Coverage.size() == 900);
+    FW_EXPECT(CoveredArea(a) == 900.0f);
+
+    // the left and right edges cut the pixels in half
+    ovrGlyphBitmap small;
+    FW_EXPECT(font.RasterizeGlyph('a', 10, small));
+    FW_EXPECT(small.Width == 4 && small.Height == 3 && small.BearingX == 1.0f);
+    for (int y = 0; small.Width == 4 && y < small.Height; y++) {
+        const uint8_t* row = &small.Coverage[y * small.Width];
+        FW_EXPECT(row[0] == 128 && row[1] == 255 && row[2] == 255 && row[3] == 128);
+    }
+
+    // Four quadratic curves enclose 5 / 6 of the square of their control points. The flattened
+    // curves are inside by at most 0.1 pixels along the roughly 140 pixel outline.
+    ovrGlyphBitmap b;
+    FW_EXPECT(font.RasterizeGlyph('b', 100, b));
+    FW_EXPECT(b.Width == 40 && b.Height == 40);
+    const float curveArea = 1600.0f * 5.0f / 6.0f;
+    FW_EXPECT(CoveredArea(b) < curveArea + 0.5f && CoveredArea(b) > curveArea - 10.0f);
+    FW_EXPECT(b.Coverage.size() == 1600 && b.Coverage[0] == 0);
+    FW_EXPECT(b.Coverage.size() == 1600 && b.Coverage[20 * 40 + 20] == 255);
+
+    // a component with an offset
+    ovrGlyphBitmap c;
+    FW_EXPECT(font.RasterizeGlyph('c', 100, c));
+    FW_EXPECT(c.BearingX == 35.0f && c.BearingY == 30.0f && c.AdvanceX == 80.0f);
+    FW_EXPECT(c.Coverage == a.Coverage);
+
+    // a contour in the other direction cuts a hole
+    ovrGlyphBitmap d;
+    FW_EXPECT(font.RasterizeGlyph('d', 100, d));
+    FW_EXPECT(CoveredArea(d) == 1200.0f);
+    FW_EXPECT(d.Coverage.size() == 1600 && d.Coverage[5 * 40 + 5] == 255);
+    FW_EXPECT(d.Coverage.size() == 1600 && d.Coverage[20 * 40 + 20] == 0);
+
+    ovrGlyphBitmap space;
+    FW_EXPECT(font.RasterizeGlyph(' ', 100, space));
+    FW_EXPECT(space.Width == 0 && space.Height == 0 && space.AdvanceX == 25.0f);
+
+    ovrGlyphBitmap missing;
+    FW_EXPECT(!font.RasterizeGlyph('z', 100, missing));
+}
+
+static void TestInvalidFonts() {
+    std::vector<uint8_t> garbage = {1, 2, 3};
+    ovrTrueTypeRasterizer font;
+    FW_EXPECT(!font.LoadFromBuffer(garbage));
+
+    // tables past the end of the file
+    std::vector<uint8_t> truncated = BuildTestFont(false);
+    truncated.resize(truncated.size() / 2);
+    ovrTrueTypeRasterizer truncatedFont;
+    FW_EXPECT(!truncatedFont.LoadFromBuffer(truncated));
+}
+
+static void TestAtlasDirtyRows() {
+    ovrSdfGlyphAtlas atlas;
+    atlas.Init(64, 64);
+    int y = 0;
+    int height = 0;
+    FW_EXPECT(!atlas.GetDirtyRows(y, height));
+
+    const std::vector<uint8_t> pixels(60 * 8, 200);
+    int x0, y0, x1, y1;
+    FW_EXPECT(atlas.AddImage(pixels.data(), 10, 5, x0, y0));
+    FW_EXPECT(atlas.AddImage(pixels.data(), 60, 8, x1, y1));
+    FW_EXPECT(y1 > y0);
+    FW_EXPECT(atlas.GetDirtyRows(y, height));
+    FW_EXPECT(y == y0 && height == y1 + 8 - y0);
+
+    atlas.ClearDirty();
+    FW_EXPECT(!atlas.GetDirtyRows(y, height));
+    int x2, y2;
+    FW_EXPECT(atlas.AddImage(pixels.data(), 2, 2, x2, y2));
+    FW_EXPECT(atlas.GetDirtyRows(y, height));
+    FW_EXPECT(y == y2 && height == 2);
+    FW_EXPECT(atlas.GetPixels()[y2 * 64 + x2] == 200);
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::TestRasterizer(false);
+    OVRFW::TestRasterizer(true);
+    OVRFW::TestInvalidFonts();
+    OVRFW::TestAtlasDirtyRows();
+    return FW_TEST_RESULT();
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   JobPoolTest.cpp
+Content     :   ovrJobPool must run every job exactly once and always make progress.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "Misc/JobPool.h"
+
+#include "FrameworkTest.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace OVRFW {
+
+static void ExpectEachIndexOnce(ovrJobPool* pool, const int count) {
+    std::vector<std::atomic<int>> calls(count);
+    for (std::atomic<int>& call : calls) {
+        call = 0;
+    }
+    ovrJobPool::ParallelFor(pool, count, [&calls](const int i) { calls[i]++; });
+    for (int i = 0; i < count; i++) {
+        FW_EXPECT(calls[i] == 1);
+    }
+}
+
+static void TestParallelForCoversRange() {
+    const int counts[] = {0, 1, 2, 7, 1000, 100000};
+    for (const int count : counts) {
+        ExpectEachIndexOnce(nullptr, count);
+    }
+    for (int numThreads = 1; numThreads <= 4; numThreads++) {
+        ovrJobPool pool(numThreads);
+        FW_EXPECT(pool.GetThreadCount() == numThreads);
+        for (const int count : counts) {
+            ExpectEachIndexOnce(&pool, count);
+        }
+    }
+    // negative counts do nothing
+    ovrJobPool pool(2);
+    bool called = false;
+    pool.ParallelFor(-1, [&called](const int) { called = true; });
+    FW_EXPECT(!called);
+}
+
+// The pool threads take part in the work.
+static void TestParallelForUsesThreads() {
+    ovrJobPool pool(3);
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    pool.ParallelFor(64, [&](const int) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.insert(std::this_thread::get_id());
+    });
+    FW_EXPECT(threads.size() > 1);
+}
+
+// With every pool thread blocked the calling thread does all the work, and the helpers that
+// run once the pool is free again find the range finished.
+static void TestParallelForBusyPool() {
+    // the mutex outlives the pool, whose threads finish the blocked jobs when it is destroyed
+    std::mutex blockMutex;
+    std::unique_lock<std::mutex> block(blockMutex);
+    ovrJobPool pool(2);
+    std::atomic<int> numBlocked(0);
+    for (int i = 0; i < pool.GetThreadCount(); i++) {
+        pool.Submit([&blockMutex, &numBlocked]() {
+            numBlocked++;
+            std::lock_guard<std::mutex> wait(blockMutex);
+        });
+    }
+    while (numBlocked < pool.GetThreadCount()) {
+        std::this_thread::yield();
+    }
+
+    const std::thread::id caller = std::this_thread::get_id();
+    int numCalls = 0;
+    bool otherThread = false;
+    pool.ParallelFor(100, [&](const int) {
+        numCalls++;
+        otherThread |= (std::this_thread::get_id() != caller);
+    });
+    FW_EXPECT(numCalls == 100);
+    FW_EXPECT(!otherThread);
+    block.unlock();
+}
+
+// Nested ParallelFor calls from inside a job finish as well.
+static void TestNestedParallelFor() {
+    ovrJobPool pool(2);
+    std::atomic<int> numCalls(0);
+    pool.ParallelFor(8, [&](const int) {
+        pool.ParallelFor(8, [&numCalls](const int) { numCalls++; });
+    });
+    FW_EXPECT(numCalls == 64);
+}
+
+// Jobs still queued when the pool is destroyed are run first.
+static void TestSubmitFinishesOnDestroy() {
+    std::atomic<int> numJobs(0);
+    {
+        ovrJobPool pool(2);
+        for (int i = 0; i < 100; i++) {
+            pool.Submit([&numJobs]() { numJobs++; });
+        }
+    }
+    FW_EXPECT(numJobs == 100);
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::TestParallelForCoversRange();
+    OVRFW::TestParallelForUsesThreads();
+    OVRFW::TestParallelForBusyPool();
+    OVRFW::TestNestedParallelFor();
+    OVRFW::TestSubmitFinishesOnDestroy();
+
+    return FW_TEST_RESULT();
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   MathBenchmark.cpp
+Content     :   Per operation cost of the SSE2 / NEON paths of OVR_Math.h against the scalar code.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+// Each operation runs over batches of 1024 random unit quaternions, poses, affine matrices and
+// points that stay in the L1 cache. The scalar column is the same loop over the templates
+// built with OVR_MATH_DISABLE_SIMD in ScalarMath.cpp. Not run by ctest; run MathBenchmark
+// directly.
+
+#include "OVR_Math.h"
+
+#include "ScalarMath.h"
+
+#include <stdio.h>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <vector>
+
+using OVR::Matrix4f;
+using OVR::Posef;
+using OVR::Quatf;
+using OVR::Vector3f;
+
+namespace OVRFW {
+
+static const int BatchSize = 1024;
+static const int NumBatches = 2000;
+
+// Returns the nanoseconds per operation of the fastest of a few runs.
+static double TimeBatches(const std::function<void()>& batch) {
+    double best = 1e30;
+    for (int run = 0; run < 3; run++) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < NumBatches; i++) {
+            batch();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    return best / (static_cast<double>(NumBatches) * BatchSize);
+}
+
+static void Report(const char* name, const double simd, const double scalar) {
+    printf("  %-28s %8.2f ns  %8.2f ns  (%.2fx)\n", name, simd, scalar, scalar / simd);
+}
+
+} // namespace OVRFW
+
+int main() {
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::vector<Quatf> quats(OVRFW::BatchSize);
+    std::vector<Posef> poses(OVRFW::BatchSize);
+    std::vector<Matrix4f> matrices(OVRFW::BatchSize);
+    std::vector<Vector3f> points(OVRFW::BatchSize);
+    for (int i = 0; i < OVRFW::BatchSize; i++) {
+        quats[i] = Quatf(value(random), value(random), value(random), value(random)).Normalized();
+        points[i] = Vector3f(value(random), value(random), value(random)) * 10.0f;
+        poses[i] = Posef(quats[i], points[(i * 7) % (i + 1)]);
+        matrices[i] = Matrix4f(poses[i]);
+    }
+    std::vector<Quatf> quatsOut(OVRFW::BatchSize);
+    std::vector<Posef> posesOut(OVRFW::BatchSize);
+    std::vector<Matrix4f> matricesOut(OVRFW::BatchSize);
+    std::vector<Vector3f> pointsOut(OVRFW::BatchSize);
+    // the second operand is the batch rotated by one
+    const int n = OVRFW::BatchSize - 1;
+
+#if defined(OVR_MATH_SSE2)
+    printf("OVR_Math, SSE2 against scalar, %d values per batch\n", OVRFW::BatchSize);
+#elif defined(OVR_MATH_NEON)
+    printf("OVR_Math, NEON against scalar, %d values per batch\n", OVRFW::BatchSize);
+#else
+    printf("OVR_Math, no SIMD paths on this target, %d values per batch\n", OVRFW::BatchSize);
+#endif
+    printf("  operation                        simd        scalar\n");
+
+    OVRFW::Report(
+        "Matrix4f * Matrix4f",
+        OVRFW::TimeBatches([&]() {
+            for (int i = 0; i < n; i++) {
+                matricesOut[i] = matrices[i] * matrices[i + 1];
+            }
+        }),
+        OVRFW::TimeBatches([&]() {
+            OVRFW::ScalarMatrix4fMultiply(
+                &matrices[0].M[0][0], &matrices[1].M[0][0], &matricesOut[0].M[0][0], n);
+        }));
+    OVRFW::Report(
+        "Matrix4f::TransformPoints",
+        OVRFW::TimeBatches(
+            [&]() { matrices[0].TransformPoints(points.data(), pointsOut.data(), n); }),
+        OVRFW::TimeBatches([&]() {
+            OVRFW::ScalarMatrix4fTransformPoints(
+                &matrices[0].M[0][0], &points[0].x, &pointsOut[0].x, n);
+        }));
+    OVRFW::Report(
+        "Quatf * Quatf",
+        OVRFW::TimeBatches([&]() {
+            for (int i = 0; i < n; i++) {
+                quatsOut[i] = quats[i] * quats[i + 1];
+            }
+        }),
+        OVRFW::TimeBatches(
+            [&]() { OVRFW::ScalarQuatfMultiply(&quats[0].x, &quats[1].x, &quatsOut[0].x, n); }));
+    OVRFW::Report(
+        "Quatf::Rotate",
+        OVRFW::TimeBatches([&]() {
+            for (int i = 0; i < n; i++) {
+                pointsOut[i] = quats[i].Rotate(points[i + 1]);
+            }
+        }),
+        OVRFW::TimeBatches(
+            [&]() { OVRFW::ScalarQuatfRotate(&quats[0].x, &points[1].x, &pointsOut[0].x, n); }));
+    OVRFW::Report(
+        "Posef * Posef",
+        OVRFW::TimeBatches([&]() {
+            for (int i = 0; i < n; i++) {
+                posesOut[i] = poses[i] * poses[i + 1];
+            }
+        }),
+        OVRFW::TimeBatches([&]() {
+            OVRFW::ScalarPosefMultiply(
+                &poses[0].Rotation.x, &poses[1].Rotation.x, &posesOut[0].Rotation.x, n);
+        }));
+    OVRFW::Report(
+        "Posef::Transform",
+        OVRFW::TimeBatches([&]() {
+            for (int i = 0; i < n; i++) {
+                pointsOut[i] = poses[i].Transform(points[i + 1]);
+            }
+        }),
+        OVRFW::TimeBatches([&]() {
+            OVRFW::ScalarPosefTransform(&poses[0].Rotation.x, &points[1].x, &pointsOut[0].x, n);
+        }));
+
+    // keeps the results alive
+    float sum = 0.0f;
+    for (int i = 0; i < n; i++) {
+        sum += matricesOut[i].M[0][0] + quatsOut[i].w + posesOut[i].Translation.x + pointsOut[i].x;
+    }
+    printf("  (checksum %g)\n", sum);
+    return 0;
+}
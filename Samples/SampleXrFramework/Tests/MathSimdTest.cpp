@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   MathSimdTest.cpp
+Content     :   The SSE2 / NEON paths of OVR_Math.h must match the scalar code bit for bit.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "OVR_Math.h"
+
+#include "FrameworkTest.h"
+#include "ScalarMath.h"
+
+#include <string.h>
+#include <random>
+#include <vector>
+
+using OVR::Matrix4f;
+using OVR::Posef;
+using OVR::Quatf;
+using OVR::Vector3f;
+
+namespace OVRFW {
+
+static const int NumValues = 20000;
+
+// Generated NaNs are the default NaN on both paths, but two NaNs are counted as equal rather
+// than relying on it.
+static bool SameBits(const float* a, const float* b, const int count) {
+    for (int i = 0; i < count; i++) {
+        if (memcmp(&a[i], &b[i], sizeof(float)) != 0 && !(a[i] != a[i] && b[i] != b[i])) {
+            printf("float %d: %.9g expected %.9g\n", i, a[i], b[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Values over a wide range of magnitudes, with zeros of both signs, denormals and a few that
+// overflow in the products.
+static std::vector<float> RandomFloats(const int count, const uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> mantissa(1.0f, 2.0f);
+    std::uniform_int_distribution<int> exponent(-24, 24);
+    const float specials[] = {0.0f, -0.0f, 1.0f, -1.0f, 1e-40f, -1e-40f, 3e38f, -3e38f};
+    std::vector<float> values(count);
+    for (float& value : values) {
+        const uint32_t r = static_cast<uint32_t>(random());
+        if (r % 64 == 0) {
+            value = specials[(r >> 6) % 8];
+        } else {
+            value = ldexpf(mantissa(random), exponent(random)) * ((r & 0x100) ? -1.0f : 1.0f);
+        }
+    }
+    return values;
+}
+
+static void TestMatrix4fMultiply() {
+    const std::vector<float> a = RandomFloats(NumValues * 16, 1);
+    const std::vector<float> b = RandomFloats(NumValues * 16, 2);
+    std::vector<float> expected(a.size());
+    ScalarMatrix4fMultiply(a.data(), b.data(), expected.data(), NumValues);
+
+    std::vector<Matrix4f> out(NumValues);
+    const Matrix4f* ma = reinterpret_cast<const Matrix4f*>(a.data());
+    const Matrix4f* mb = reinterpret_cast<const Matrix4f*>(b.data());
+    for (int i = 0; i < NumValues; i++) {
+        out[i] = ma[i] * mb[i];
+    }
+    FW_EXPECT(SameBits(&out[0].M[0][0], expected.data(), NumValues * 16));
+
+    // operator*= copies the left side first
+    for (int i = 0; i < NumValues; i++) {
+        out[i] = ma[i];
+        out[i] *= mb[i];
+    }
+    FW_EXPECT(SameBits(&out[0].M[0][0], expected.data(), NumValues * 16));
+}
+
+static void TestMatrix4fTransformPoints() {
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> angle(-3.14159f, 3.14159f);
+    std::uniform_real_distribution<float> offset(-100.0f, 100.0f);
+    const std::vector<float> points = RandomFloats(NumValues * 3, 4);
+    Matrix4f matrices[] = {
+        Matrix4f::Identity(),
+        Matrix4f::Translation(offset(random), offset(random), offset(random)) *
+            Matrix4f::RotationY(angle(random)) * Matrix4f::Scaling(0.5f, 2.0f, 3.0f),
+        Matrix4f::PerspectiveRH(1.5f, 1.0f, 0.1f, 100.0f) * Matrix4f::RotationX(angle(random)),
+        Matrix4f(),
+    };
+    memcpy(&matrices[3].M[0][0], RandomFloats(16, 5).data(), sizeof(matrices[3].M));
+    for (const Matrix4f& m : matrices) {
+        // odd counts, and in place
+        for (const int count : {0, 1, 7, NumValues}) {
+            std::vector<float> expected(count * 3);
+            ScalarMatrix4fTransformPoints(&m.M[0][0], points.data(), expected.data(), count);
+            std::vector<Vector3f> out(count);
+            m.TransformPoints(reinterpret_cast<const Vector3f*>(points.data()), out.data(), count);
+            FW_EXPECT(count == 0 || SameBits(&out[0].x, expected.data(), count * 3));
+            std::vector<Vector3f> inPlace(
+                reinterpret_cast<const Vector3f*>(points.data()),
+                reinterpret_cast<const Vector3f*>(points.data()) + count);
+            m.TransformPoints(inPlace.data(), inPlace.data(), count);
+            FW_EXPECT(count == 0 || SameBits(&inPlace[0].x, expected.data(), count * 3));
+            // and like Transform() one point at a time
+            bool same = true;
+            for (int i = 0; i < count; i++) {
+                const Vector3f v = m.Transform(reinterpret_cast<const Vector3f*>(points.data())[i]);
+                same = same && SameBits(&v.x, &expected[i * 3], 3);
+            }
+            FW_EXPECT(same);
+        }
+    }
+}
+
+static void TestQuatf() {
+    const std::vector<float> a = RandomFloats(NumValues * 4, 6);
+    const std::vector<float> b = RandomFloats(NumValues * 4, 7);
+    const std::vector<float> v = RandomFloats(NumValues * 3, 8);
+    const Quatf* qa = reinterpret_cast<const Quatf*>(a.data());
+    const Quatf* qb = reinterpret_cast<const Quatf*>(b.data());
+    const Vector3f* vv = reinterpret_cast<const Vector3f*>(v.data());
+
+    std::vector<float> expected(NumValues * 4);
+    ScalarQuatfMultiply(a.data(), b.data(), expected.data(), NumValues);
+    std::vector<Quatf> out(NumValues);
+    for (int i = 0; i < NumValues; i++) {
+        out[i] = qa[i] * qb[i];
+    }
+    FW_EXPECT(SameBits(&out[0].x, expected.data(), NumValues * 4));
+
+    // unit quaternions as well as the raw values
+    std::vector<Quatf> units(qa, qa + NumValues);
+    for (Quatf& q : units) {
+        q.Normalize();
+    }
+    for (const Quatf* q : {qa, static_cast<const Quatf*>(units.data())}) {
+        std::vector<float> rotated(NumValues * 3);
+        ScalarQuatfRotate(&q[0].x, v.data(), rotated.data(), NumValues);
+        std::vector<Vector3f> outRotated(NumValues);
+        for (int i = 0; i < NumValues; i++) {
+            outRotated[i] = q[i].Rotate(vv[i]);
+        }
+        FW_EXPECT(SameBits(&outRotated[0].x, rotated.data(), NumValues * 3));
+    }
+}
+
+static void TestPosef() {
+    std::vector<float> a = RandomFloats(NumValues * 7, 9);
+    std::vector<float> b = RandomFloats(NumValues * 7, 10);
+    const std::vector<float> v = RandomFloats(NumValues * 3, 11);
+    Posef* pa = reinterpret_cast<Posef*>(a.data());
+    Posef* pb = reinterpret_cast<Posef*>(b.data());
+    for (int i = 0; i < NumValues; i++) {
+        pa[i].Rotation.Normalize();
+        pb[i].Rotation.Normalize();
+    }
+    const Vector3f* vv = reinterpret_cast<const Vector3f*>(v.data());
+
+    std::vector<float> expected(NumValues * 7);
+    ScalarPosefMultiply(a.data(), b.data(), expected.data(), NumValues);
+    std::vector<Posef> out(NumValues);
+    for (int i = 0; i < NumValues; i++) {
+        out[i] = pa[i] * pb[i];
+    }
+    FW_EXPECT(SameBits(&out[0].Rotation.x, expected.data(), NumValues * 7));
+
+    std::vector<float> transformed(NumValues * 3);
+    ScalarPosefTransform(a.data(), v.data(), transformed.data(), NumValues);
+    std::vector<Vector3f> outTransformed(NumValues);
+    for (int i = 0; i < NumValues; i++) {
+        outTransformed[i] = pa[i].Transform(vv[i]);
+    }
+    FW_EXPECT(SameBits(&outTransformed[0].x, transformed.data(), NumValues * 3));
+}
+
+} // namespace OVRFW
+
+int main() {
+    static_assert(sizeof(Posef) == 7 * sizeof(float), "Posef layout");
+#if defined(OVR_MATH_SSE2)
+    printf("Comparing the SSE2 paths with the scalar code\n");
+#elif defined(OVR_MATH_NEON)
+    printf("Comparing the NEON paths with the scalar code\n");
+#else
+    printf("No SIMD paths on this target, comparing the scalar code with itself\n");
+#endif
+#if (defined(__x86_64__) || defined(_M_X64) || defined(__aarch64__) || defined(_M_ARM64)) && \
+    !defined(OVR_MATH_SSE2) && !defined(OVR_MATH_NEON)
+    // these always have SSE2 or NEON, a test that compares nothing should not pass quietly
+    FW_EXPECT(!"the SIMD paths are disabled");
+#endif
+    OVRFW::TestMatrix4fMultiply();
+    OVRFW::TestMatrix4fTransformPoints();
+    OVRFW::TestQuatf();
+    OVRFW::TestPosef();
+    return FW_TEST_RESULT();
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   MeshletTest.cpp
+Content     :   BuildMeshletDescriptors must emit every triangle once, within the limits.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "Render/GlGeometry.h"
+
+#include "FrameworkTest.h"
+
+#include <math.h>
+#include <algorithm>
+#include <array>
+
+using OVR::Bounds3f;
+using OVR::Vector2f;
+using OVR::Vector3f;
+
+namespace OVRFW {
+
+// A grid of quads in the xy plane, with each vertex position unique.
+static void BuildGrid(const int size, VertexAttribs& attribs, std::vector<uint32_t>& indices) {
+    for (int y = 0; y <= size; y++) {
+        for (int x = 0; x <= size; x++) {
+            attribs.position.push_back(Vector3f(x, y, 0));
+            attribs.uv0.push_back(Vector2f(x, y));
+        }
+    }
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            const uint32_t v = y * (size + 1) + x;
+            indices.insert(indices.end(), {v, v + 1, v + size + 1});
+            indices.insert(indices.end(), {v + 1, v + size + 2, v + size + 1});
+        }
+    }
+}
+
+using Triangle = std::array<float, 6>;
+
+static Triangle MakeTriangle(const Vector3f& a, const Vector3f& b, const Vector3f& c) {
+    return {a.x, a.y, b.x, b.y, c.x, c.y};
+}
+
+static void TestGrid(const int size, const int maxVertices, const int maxTriangles) {
+    VertexAttribs attribs;
+    std::vector<uint32_t> indices;
+    BuildGrid(size, attribs, indices);
+
+    const std::vector<GlGeometry::Descriptor> meshlets =
+        BuildMeshletDescriptors(attribs, indices, maxVertices, maxTriangles);
+
+    std::vector<Triangle> expected;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        expected.push_back(MakeTriangle(
+            attribs.position[indices[i]],
+            attribs.position[indices[i + 1]],
+            attribs.position[indices[i + 2]]));
+    }
+
+    std::vector<Triangle> emitted;
+    float sumExtent = 0.0f;
+    for (const GlGeometry::Descriptor& meshlet : meshlets) {
+        const VertexAttribs& a = meshlet.attribs;
+        FW_EXPECT(static_cast<int>(a.position.size()) <= maxVertices);
+        FW_EXPECT(static_cast<int>(meshlet.indices.size()) <= maxTriangles * 3);
+        FW_EXPECT(a.uv0.size() == a.position.size());
+        Bounds3f bounds(Bounds3f::Init);
+        for (size_t i = 0; i < meshlet.indices.size(); i += 3) {
+            const Vector3f& p0 = a.position[meshlet.indices[i]];
+            const Vector3f& p1 = a.position[meshlet.indices[i + 1]];
+            const Vector3f& p2 = a.position[meshlet.indices[i + 2]];
+            emitted.push_back(MakeTriangle(p0, p1, p2));
+            bounds.AddPoint(p0);
+            bounds.AddPoint(p1);
+            bounds.AddPoint(p2);
+        }
+        for (size_t i = 0; i < a.position.size(); i++) {
+            // the attributes stay together
+            FW_EXPECT(a.uv0[i].x == a.position[i].x && a.uv0[i].y == a.position[i].y);
+        }
+        const Vector3f extent = bounds.GetSize();
+        sumExtent += std::max(extent.x, extent.y);
+    }
+
+    std::sort(expected.begin(), expected.end());
+    std::sort(emitted.begin(), emitted.end());
+    FW_EXPECT(emitted == expected);
+
+    // Clusters grown across shared vertices are roughly square, with sides near the square
+    // root of their vertex count.  Rows taken in input order would span the whole grid.
+    FW_EXPECT(sumExtent / meshlets.size() <= 2.0f * sqrtf(static_cast<float>(maxVertices)));
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::TestGrid(8, 4096, 8192);
+    OVRFW::TestGrid(100, 256, 512);
+    OVRFW::TestGrid(300, 4096, 8192);
+    OVRFW::TestGrid(50, 64, 40);
+    return FW_TEST_RESULT();
+}
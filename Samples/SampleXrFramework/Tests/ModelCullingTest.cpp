@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   ModelCullingTest.cpp
+Content     :   BoundsSortCullKeys must match BoundsSortCullKey bit for bit.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "Model/ModelCulling.h"
+
+#include "FrameworkTest.h"
+
+#include <string.h>
+#include <limits>
+#include <random>
+
+using OVR::Bounds3f;
+using OVR::Matrix4f;
+using OVR::Vector3f;
+
+namespace OVRFW {
+
+static uint32_t FloatBits(const float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+static int NumVisible = 0;
+
+static void ExpectSameKeys(const ovrBoundsCullList& list, const std::vector<Matrix4f>& mvps) {
+    std::vector<float> keys;
+    BoundsSortCullKeys(list, mvps.data(), keys);
+    FW_EXPECT(static_cast<int>(keys.size()) == list.GetCount());
+    for (int i = 0; i < list.GetCount(); i++) {
+        const Bounds3f bounds(
+            Vector3f(list.MinX[i], list.MinY[i], list.MinZ[i]),
+            Vector3f(list.MaxX[i], list.MaxY[i], list.MaxZ[i]));
+        const float expected = BoundsSortCullKey(bounds, mvps[list.MatrixIndex[i]]);
+        if (FloatBits(keys[i]) != FloatBits(expected)) {
+            printf("bounds %d: key %.9g expected %.9g\n", i, keys[i], expected);
+        }
+        FW_EXPECT(FloatBits(keys[i]) == FloatBits(expected));
+        NumVisible += (keys[i] != 0.0f) ? 1 : 0;
+    }
+}
+
+// Views and models placed so that bounds land inside, across and outside of every plane.
+static void TestRandomScenes() {
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> extent(0.0f, 5.0f);
+    std::uniform_real_distribution<float> angle(-3.14159f, 3.14159f);
+
+    const Matrix4f projection = Matrix4f::PerspectiveRH(1.5f, 1.0f, 0.1f, 100.0f);
+    NumVisible = 0;
+    for (int scene = 0; scene < 200; scene++) {
+        const Matrix4f view = Matrix4f::RotationY(angle(rng)) * Matrix4f::RotationX(angle(rng));
+        std::vector<Matrix4f> mvps;
+        ovrBoundsCullList list;
+        // Odd counts leave a remainder for the scalar tail.
+        const int numModels = 1 + scene % 7;
+        for (int model = 0; model < numModels; model++) {
+            const Matrix4f modelMatrix =
+                Matrix4f::Translation(position(rng), position(rng), position(rng)) *
+                Matrix4f::RotationZ(angle(rng)) * Matrix4f::Scaling(1.0f + extent(rng));
+            mvps.push_back(projection * view * modelMatrix);
+            const int numSurfaces = 1 + (scene + model) % 6;
+            for (int surface = 0; surface < numSurfaces; surface++) {
+                const Vector3f center(position(rng), position(rng), position(rng));
+                const Vector3f size(extent(rng), extent(rng), extent(rng));
+                list.Add(Bounds3f(center - size, center + size), model);
+            }
+        }
+        ExpectSameKeys(list, mvps);
+    }
+    // The scenes must not be trivially culled.
+    FW_EXPECT(NumVisible > 100);
+}
+
+// Empty bounds, billboards, bounds through the eye plane, bounds touching a plane and NaNs.
+static void TestSpecialBounds() {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    std::vector<Matrix4f> mvps;
+    mvps.push_back(Matrix4f::PerspectiveRH(1.5f, 1.0f, 0.1f, 100.0f));
+    mvps.push_back(mvps[0] * Matrix4f::Translation(0.0f, 0.0f, 5.0f));
+    mvps.push_back(Matrix4f());
+
+    ovrBoundsCullList list;
+    list.Add(Bounds3f(Vector3f(0, 0, 0), Vector3f(0, 0, 0)), 0);
+    list.Add(Bounds3f(Vector3f(1, 1, 1), Vector3f(1, 1, 5)), 1);
+    list.Add(Bounds3f(Vector3f(-1, -1, 0), Vector3f(1, 1, 0)), 1);
+    list.Add(Bounds3f(Vector3f(-1, -1, -1), Vector3f(1, 1, 1)), 0);
+    list.Add(Bounds3f(Vector3f(-1, -1, 2), Vector3f(1, 1, 3)), 0);
+    list.Add(Bounds3f(Vector3f(-1, -1, -3), Vector3f(1, 1, -2)), 0);
+    list.Add(Bounds3f(Vector3f(nan, 0, 2), Vector3f(1, 1, 3)), 0);
+    list.Add(Bounds3f(Vector3f(-1, -1, 2), Vector3f(1, nan, 3)), 1);
+    list.Add(Bounds3f(Vector3f(-inf, -1, 2), Vector3f(inf, 1, 3)), 0);
+    list.Add(Bounds3f(Vector3f(-1, -1, -3), Vector3f(1, 1, nan)), 0);
+    list.Add(Bounds3f(Vector3f(-1, -1, nan), Vector3f(1, 1, -2)), 0);
+    list.Add(Bounds3f(Vector3f(-2, -0.5f, -0.5f), Vector3f(-1, 0.5f, 0.5f)), 2);
+    list.Add(Bounds3f(Vector3f(-0.5f, 1, -0.5f), Vector3f(0.5f, 2, 0.5f)), 2);
+    list.Add(Bounds3f(Vector3f(-0.5f, -0.5f, -0.5f), Vector3f(0.5f, 0.5f, 0.5f)), 2);
+    list.Add(Bounds3f(Vector3f(2, 2, 2), Vector3f(3, 3, 3)), 2);
+    ExpectSameKeys(list, mvps);
+
+    // Cleared lists are reused between frames.
+    list.Clear();
+    ExpectSameKeys(list, mvps);
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::TestRandomScenes();
+    OVRFW::TestSpecialBounds();
+    return FW_TEST_RESULT();
+}
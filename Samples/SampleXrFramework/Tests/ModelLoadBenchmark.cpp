@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   ModelLoadBenchmark.cpp
+Content     :   Wall time of loading a glB with the decoding spread over a job pool.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+// The glB has 64 meshes of 64x64 vertices and 16 PNG images of 512x512 noise. Textures and
+// geometry are created in FakeGl, so the times cover the parsing, image decoding, accessor
+// decoding and vertex packing but not the driver. Not run by ctest; run ModelLoadBenchmark
+// directly.
+
+#include "Model/ModelFileLoading.h"
+#include "Misc/JobPool.h"
+
+#include "FakeGl.h"
+#include "SyntheticGlb.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace OVRFW {
+
+// Returns the average milliseconds per load.
+static double TimeLoads(const std::vector<char>& glb, ovrJobPool* jobPool) {
+    GlProgram program;
+    const ModelGlPrograms programs(&program);
+    MaterialParms materialParms;
+    materialParms.JobPool = jobPool;
+
+    const int iterations = 5;
+    double total = 0.0;
+    for (int i = 0; i <= iterations; i++) {
+        FakeGlReset();
+        const auto start = std::chrono::steady_clock::now();
+        ModelFile* model = LoadModelFile_glB(
+            "synthetic.glb", glb.data(), static_cast<int>(glb.size()), programs, materialParms);
+        const auto end = std::chrono::steady_clock::now();
+        if (model == nullptr) {
+            printf("load failed\n");
+            return 0.0;
+        }
+        delete model;
+        // the first load warms up
+        if (i > 0) {
+            total += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+    }
+    return total / iterations;
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::ovrSyntheticGlbParms parms;
+    parms.NumMeshes = 64;
+    parms.GridSize = 64;
+    parms.NumImages = 16;
+    parms.ImageSize = 512;
+    const std::vector<char> glb = OVRFW::MakeSyntheticGlb(parms);
+
+    const int numCores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    printf("LoadModelFile_glB, %d KB, %d cores\n", static_cast<int>(glb.size() / 1024), numCores);
+    const double baseTime = OVRFW::TimeLoads(glb, nullptr);
+    printf("  no job pool: %8.2f ms\n", baseTime);
+    // The calling thread works on the jobs too, so a pool of N threads uses N + 1 cores.
+    for (int numThreads = 1; numThreads < numCores * 2; numThreads *= 2) {
+        OVRFW::ovrJobPool jobPool(numThreads);
+        const double time = OVRFW::TimeLoads(glb, &jobPool);
+        printf("  %2d threads:  %8.2f ms  (%.2fx)\n", numThreads, time, baseTime / time);
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   ModelMemoryBenchmark.cpp
+Content     :   Peak and resident memory and load time of a glB with and without
+                MaterialParms::UseBuffersInPlace.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+// The glB is geometry heavy (96 meshes of 128x128 vertices, about 70 MB of binary chunk) so
+// the copy of the binary chunk shows up next to the decoded vertex data. FakeGl keeps a copy
+// of every buffer object it is given, which counts the same in both modes. Peak memory is
+// VmHWM after resetting it through /proc/self/clear_refs, so this only runs on Linux. Not run
+// by ctest; run ModelMemoryBenchmark directly.
+
+#include "Model/ModelFileLoading.h"
+
+#include "FakeGl.h"
+#include "SyntheticGlb.h"
+
+#include <malloc.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <memory>
+
+namespace OVRFW {
+
+// Returns the named field of /proc/self/status in KB, or -1.
+static long ReadStatusKb(const char* field) {
+    FILE* f = fopen("/proc/self/status", "r");
+    if (f == nullptr) {
+        return -1;
+    }
+    char line[256];
+    long value = -1;
+    const size_t length = strlen(field);
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        if (strncmp(line, field, length) == 0 && line[length] == ':') {
+            value = strtol(line + length + 1, nullptr, 10);
+            break;
+        }
+    }
+    fclose(f);
+    return value;
+}
+
+static bool ResetPeakRss() {
+    FILE* f = fopen("/proc/self/clear_refs", "w");
+    if (f == nullptr) {
+        return false;
+    }
+    const bool ok = fputs("5", f) >= 0;
+    return fclose(f) == 0 && ok;
+}
+
+static void Measure(const std::shared_ptr<const std::vector<char>>& glb, const bool inPlace) {
+    GlProgram program;
+    const ModelGlPrograms programs(&program);
+    MaterialParms materialParms;
+    materialParms.UseBuffersInPlace = inPlace;
+
+    const auto load = [&]() {
+        return LoadModelFile_glB(
+            "synthetic.glb",
+            glb->data(),
+            static_cast<int>(glb->size()),
+            programs,
+            materialParms,
+            nullptr,
+            glb);
+    };
+
+    // Time first, then measure memory on a load of its own so the heap starts out trimmed.
+    const int iterations = 3;
+    double total = 0.0;
+    for (int i = 0; i <= iterations; i++) {
+        FakeGlReset();
+        const auto start = std::chrono::steady_clock::now();
+        ModelFile* model = load();
+        const auto end = std::chrono::steady_clock::now();
+        if (model == nullptr) {
+            printf("load failed\n");
+            return;
+        }
+        delete model;
+        // the first load warms up
+        if (i > 0) {
+            total += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+    }
+
+    FakeGlReset();
+    malloc_trim(0);
+    const bool resetPeak = ResetPeakRss();
+    const long before = ReadStatusKb("VmRSS");
+    ModelFile* model = load();
+    const long peak = ReadStatusKb("VmHWM");
+    const long after = ReadStatusKb("VmRSS");
+    delete model;
+    FakeGlReset();
+
+    printf(
+        "  %-10s %8.2f ms   peak +%7.1f MB   resident +%7.1f MB%s\n",
+        inPlace ? "in place" : "copied",
+        total / iterations,
+        (peak - before) / 1024.0,
+        (after - before) / 1024.0,
+        resetPeak ? "" : "   (peak not reset)");
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::ovrSyntheticGlbParms parms;
+    parms.NumMeshes = 96;
+    parms.GridSize = 128;
+    parms.NumImages = 2;
+    parms.ImageSize = 256;
+    const auto glb =
+        std::make_shared<const std::vector<char>>(OVRFW::MakeSyntheticGlb(parms));
+
+    printf("LoadModelFile_glB, %d KB\n", static_cast<int>(glb->size() / 1024));
+    OVRFW::Measure(glb, false);
+    OVRFW::Measure(glb, true);
+    return 0;
+}
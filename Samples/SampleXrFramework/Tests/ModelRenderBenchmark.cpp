@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   ModelRenderBenchmark.cpp
+Content     :   CPU cost of BuildModelSurfaceList for scenes of 1k to 100k nodes.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+// The nodes are scattered around the viewer so roughly a quarter of them are in view, and one
+// in eight is transparent. Besides the whole call, the culling and the radix sort are timed on
+// their own with the data the call left in the sort list. Not run by ctest; run
+// ModelRenderBenchmark directly.
+
+#include "Model/ModelRender.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+using OVR::Bounds3f;
+using OVR::Matrix4f;
+using OVR::Vector3f;
+
+namespace OVRFW {
+
+static Model MakeCube(const unsigned program, const bool transparent) {
+    Model model;
+    model.surfaces.resize(1);
+    ovrSurfaceDef& surfaceDef = model.surfaces[0].surfaceDef;
+    surfaceDef.geo.indexCount = 36;
+    surfaceDef.geo.localBounds = Bounds3f(Vector3f(-0.5f), Vector3f(0.5f));
+    surfaceDef.graphicsCommand.Program.Program = program;
+    if (transparent) {
+        surfaceDef.graphicsCommand.GpuState.blendEnable = ovrGpuState::BLEND_ENABLE;
+    }
+    return model;
+}
+
+template <typename Function>
+static double TimeCalls(const int iterations, Function function) {
+    function(); // warm up, the storage reaches its steady state size
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        function();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+}
+
+static void BenchmarkNodeCount(const int numNodes) {
+    Model models[] = {MakeCube(1, false), MakeCube(2, false), MakeCube(3, true)};
+
+    ModelFile modelFile;
+    modelFile.Nodes.resize(numNodes);
+    std::mt19937 random(numNodes);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    for (int i = 0; i < numNodes; i++) {
+        ModelNode& node = modelFile.Nodes[i];
+        node.model = &models[(i % 8 == 7) ? 2 : (i & 1)];
+        node.translation = Vector3f(position(random), position(random) * 0.1f, position(random));
+    }
+    ModelState state;
+    state.GenerateStateFromModelFile(&modelFile);
+    for (ModelNodeState& nodeState : state.nodeStates) {
+        nodeState.CalculateLocalTransform();
+    }
+    state.UpdateTransforms();
+
+    std::vector<ModelNodeState*> emitNodes;
+    for (ModelNodeState& nodeState : state.nodeStates) {
+        emitNodes.push_back(&nodeState);
+    }
+    const std::vector<ovrDrawSurface> emitSurfaces;
+    const Matrix4f viewMatrix = Matrix4f::Identity();
+    const Matrix4f projectionMatrix =
+        Matrix4f::PerspectiveRH(OVR::DegreeToRad(90.0f), 1.0f, 0.1f, 1000.0f);
+
+    const int iterations = std::max(10, 10000000 / numNodes);
+    ovrModelSurfaceSortList sortList;
+    std::vector<ovrDrawSurface> surfaceList;
+    const double buildTime = TimeCalls(iterations, [&]() {
+        BuildModelSurfaceList(
+            surfaceList, emitNodes, emitSurfaces, viewMatrix, projectionMatrix, sortList);
+    });
+
+    std::vector<float> cullKeys;
+    const double cullTime = TimeCalls(iterations, [&]() {
+        BoundsSortCullKeys(sortList.cullList, sortList.mvps.data(), cullKeys);
+    });
+
+    // the sort items in the order they were gathered in, before the sort
+    std::vector<ovrRadixSortItem> unsorted = sortList.sortItems;
+    std::sort(unsorted.begin(), unsorted.end(), [](const auto& a, const auto& b) {
+        return a.value < b.value;
+    });
+    std::vector<ovrRadixSortItem> sortItems;
+    std::vector<ovrRadixSortItem> sortScratch;
+    const double sortTime = TimeCalls(iterations, [&]() {
+        sortItems = unsorted;
+        RadixSort(sortItems, sortScratch);
+    });
+
+    printf(
+        "%7d nodes, %6d drawn: build %9.2f us (%6.1f ns/node)  cull %9.2f us  sort %9.2f us\n",
+        numNodes,
+        static_cast<int>(surfaceList.size()),
+        buildTime,
+        buildTime * 1000.0 / numNodes,
+        cullTime,
+        sortTime);
+}
+
+} // namespace OVRFW
+
+int main() {
+    printf("BuildModelSurfaceList, one surface per node\n");
+    OVRFW::BenchmarkNodeCount(1000);
+    OVRFW::BenchmarkNodeCount(10000);
+    OVRFW::BenchmarkNodeCount(100000);
+    return 0;
+}
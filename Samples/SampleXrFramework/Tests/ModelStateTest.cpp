@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   ModelStateTest.cpp
+Content     :   Flattened ModelState transforms against the recursive node update.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "Model/ModelFile.h"
+
+#include "FrameworkTest.h"
+
+#include <algorithm>
+#include <random>
+
+using OVR::Matrix4f;
+using OVR::Vector3f;
+
+namespace OVRFW {
+
+static Matrix4f RandomTransform(std::mt19937& random) {
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    return Matrix4f::Translation(Vector3f(value(random), value(random), value(random))) *
+        Matrix4f::RotationY(value(random) * 3.0f) * Matrix4f::RotationX(value(random) * 3.0f) *
+        Matrix4f::Scaling(1.0f + 0.1f * value(random));
+}
+
+// Gives every node a random local transform, and sets the children from the parents the
+// way the glTF loader does.
+static void MakeNodes(ModelFile& mf, const std::vector<int>& parents, std::mt19937& random) {
+    const int numNodes = static_cast<int>(parents.size());
+    mf.Nodes.clear();
+    mf.Nodes.resize(numNodes);
+    for (int i = 0; i < numNodes; i++) {
+        mf.Nodes[i].SetLocalTransform(RandomTransform(random));
+        mf.Nodes[i].parentIndex = parents[i];
+        if (parents[i] >= 0 && parents[i] < numNodes) {
+            mf.Nodes[parents[i]].children.push_back(i);
+        }
+    }
+}
+
+static bool IsValidParent(const ModelFile& mf, const int i) {
+    const int parent = mf.Nodes[i].parentIndex;
+    return parent >= 0 && parent < static_cast<int>(mf.Nodes.size()) && parent != i;
+}
+
+// True if the parents of the node lead into a cycle.
+static bool IsCyclic(const ModelFile& mf, const int node) {
+    int i = node;
+    for (size_t step = 0; step <= mf.Nodes.size(); step++) {
+        if (!IsValidParent(mf, i)) {
+            return false;
+        }
+        i = mf.Nodes[i].parentIndex;
+    }
+    return true;
+}
+
+// The recursive update the flattened transforms replaced: the global transform of a node
+// is the global transform of its parent, or of the model for a root node, times its local
+// transform.  Only defined for nodes whose parents do not form a cycle.
+static Matrix4f ReferenceGlobal(
+    const ModelFile& mf,
+    const std::vector<Matrix4f>& locals,
+    const Matrix4f& modelMatrix,
+    const int i) {
+    const Matrix4f parent = IsValidParent(mf, i)
+        ? ReferenceGlobal(mf, locals, modelMatrix, mf.Nodes[i].parentIndex)
+        : modelMatrix;
+    return parent * locals[i];
+}
+
+static bool IsAncestor(const ModelFile& mf, const int ancestor, const int node) {
+    int i = node;
+    for (size_t step = 0; step < mf.Nodes.size() && IsValidParent(mf, i); step++) {
+        i = mf.Nodes[i].parentIndex;
+        if (i == ancestor) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Checks every global transform against the recursive update.  A node that leads into
+// a cycle is transformed by its parent, except one node per cycle that is a root.
+static void ExpectTransforms(
+    const ModelFile& mf,
+    const ModelState& state,
+    const std::vector<Matrix4f>& locals,
+    const Matrix4f& modelMatrix) {
+    for (int i = 0; i < static_cast<int>(mf.Nodes.size()); i++) {
+        const Matrix4f& global = state.nodeStates[i].GetGlobalTransform();
+        if (!IsCyclic(mf, i)) {
+            FW_EXPECT(global == ReferenceGlobal(mf, locals, modelMatrix, i));
+        } else {
+            const Matrix4f& parent =
+                state.nodeStates[mf.Nodes[i].parentIndex].GetGlobalTransform();
+            FW_EXPECT(global == parent * locals[i] || global == modelMatrix * locals[i]);
+        }
+    }
+}
+
+// Every node has a transform, and the descendants of a node directly follow it.
+static void ExpectContiguousSubtrees(const ModelFile& mf, const ModelState& state) {
+    const int numNodes = static_cast<int>(mf.Nodes.size());
+    std::vector<int> used(numNodes, 0);
+    for (int i = 0; i < numNodes; i++) {
+        const int transformIndex = state.nodeStates[i].transformIndex;
+        FW_EXPECT(transformIndex >= 0 && transformIndex < numNodes);
+        if (transformIndex >= 0 && transformIndex < numNodes) {
+            used[transformIndex]++;
+        }
+    }
+    FW_EXPECT(std::count(used.begin(), used.end(), 1) == numNodes);
+
+    for (int i = 0; i < numNodes; i++) {
+        if (IsCyclic(mf, i)) {
+            continue;
+        }
+        const int begin = state.nodeStates[i].transformIndex;
+        int numDescendants = 0;
+        bool inRange = true;
+        for (int j = 0; j < numNodes; j++) {
+            if (IsAncestor(mf, i, j)) {
+                numDescendants++;
+                inRange = inRange && state.nodeStates[j].transformIndex > begin;
+            }
+        }
+        for (int j = 0; j < numNodes; j++) {
+            if (IsAncestor(mf, i, j)) {
+                inRange = inRange && state.nodeStates[j].transformIndex <= begin + numDescendants;
+            }
+        }
+        FW_EXPECT(inRange);
+    }
+}
+
+static std::vector<Matrix4f> NodeLocals(const ModelFile& mf) {
+    std::vector<Matrix4f> locals;
+    for (const ModelNode& node : mf.Nodes) {
+        locals.push_back(node.GetLocalTransform());
+    }
+    return locals;
+}
+
+// Marks random nodes as changed, and checks that only their subtrees are recalculated.
+static void TestPartialUpdates(const ModelFile& mf, ModelState& state, std::mt19937& random) {
+    const int numNodes = static_cast<int>(mf.Nodes.size());
+    std::vector<Matrix4f> locals = NodeLocals(mf);
+    const Matrix4f modelMatrix = RandomTransform(random);
+    state.SetMatrix(modelMatrix);
+    ExpectTransforms(mf, state, locals, modelMatrix);
+    FW_EXPECT(state.UpdateTransforms() == 0);
+
+    for (int round = 0; round < 20; round++) {
+        std::vector<int> changed;
+        const int numChanged = 1 + static_cast<int>(random() % 8);
+        for (int c = 0; c < numChanged; c++) {
+            const int i = static_cast<int>(random() % numNodes);
+            if (IsCyclic(mf, i)) {
+                continue;
+            }
+            locals[i] = RandomTransform(random);
+            state.nodeStates[i].SetLocalTransform(locals[i]);
+            changed.push_back(i);
+        }
+        int expectedUpdates = 0;
+        for (int j = 0; j < numNodes; j++) {
+            for (const int i : changed) {
+                if (i == j || IsAncestor(mf, i, j)) {
+                    expectedUpdates++;
+                    break;
+                }
+            }
+        }
+        FW_EXPECT(state.UpdateTransforms() == expectedUpdates);
+        ExpectTransforms(mf, state, locals, modelMatrix);
+    }
+
+    // RecalculateMatrix updates the subtree right away
+    const int node = static_cast<int>(random() % numNodes);
+    if (!IsCyclic(mf, node)) {
+        locals[node] = RandomTransform(random);
+        state.SetLocalTransform(state.nodeStates[node].transformIndex, locals[node]);
+        state.nodeStates[node].RecalculateMatrix();
+        ExpectTransforms(mf, state, locals, modelMatrix);
+        FW_EXPECT(state.UpdateTransforms() == 0);
+    }
+}
+
+// Random forests, with the nodes in random order so parents often come after children.
+static void TestRandomHierarchy() {
+    std::mt19937 random(3);
+    for (int iteration = 0; iteration < 10; iteration++) {
+        const int numNodes = 50 + static_cast<int>(random() % 200);
+        std::vector<int> treeParents(numNodes);
+        for (int i = 0; i < numNodes; i++) {
+            const bool isRoot = (i == 0) || (random() % 20 == 0);
+            treeParents[i] = isRoot ? -1 : static_cast<int>(random() % i);
+        }
+        std::vector<int> order(numNodes);
+        for (int i = 0; i < numNodes; i++) {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), random);
+        std::vector<int> parents(numNodes);
+        for (int i = 0; i < numNodes; i++) {
+            parents[order[i]] = (treeParents[i] < 0) ? -1 : order[treeParents[i]];
+        }
+
+        ModelFile mf;
+        MakeNodes(mf, parents, random);
+        ModelState state;
+        state.GenerateStateFromModelFile(&mf);
+        ExpectContiguousSubtrees(mf, state);
+        ExpectTransforms(mf, state, NodeLocals(mf), Matrix4f::Identity());
+        TestPartialUpdates(mf, state, random);
+    }
+}
+
+// Hierarchies the recursive update got wrong or never finished.
+static void TestBrokenHierarchy() {
+    std::mt19937 random(5);
+    //  0 -> 1 -> 2, 0 -> 3
+    //  4 is listed by 1 but its parent is 3
+    //  5 has parent 0 but nobody lists it
+    //  6 <-> 7 are each others parent, 8 hangs off 7
+    //  9 is its own parent, 10 has a parent out of range
+    // 11 -> 12, and 12 lists 11 as its child
+    const std::vector<int> parents = {-1, 0, 1, 0, 3, 0, 7, 6, 7, 9, 99, -1, 11};
+    ModelFile mf;
+    MakeNodes(mf, parents, random);
+    mf.Nodes[1].children.push_back(4);
+    mf.Nodes[0].children.erase(
+        std::find(mf.Nodes[0].children.begin(), mf.Nodes[0].children.end(), 5));
+    mf.Nodes[12].children.push_back(11);
+    mf.Nodes[2].children.push_back(-1);
+    mf.Nodes[2].children.push_back(1000);
+
+    ModelState state;
+    state.GenerateStateFromModelFile(&mf);
+    ExpectContiguousSubtrees(mf, state);
+    ExpectTransforms(mf, state, NodeLocals(mf), Matrix4f::Identity());
+    TestPartialUpdates(mf, state, random);
+
+    // the cycle is transformed as a whole
+    const Matrix4f& g6 = state.nodeStates[6].GetGlobalTransform();
+    const Matrix4f& g7 = state.nodeStates[7].GetGlobalTransform();
+    const Matrix4f& g8 = state.nodeStates[8].GetGlobalTransform();
+    FW_EXPECT(g6 == g7 * mf.Nodes[6].GetLocalTransform() ||
+              g7 == g6 * mf.Nodes[7].GetLocalTransform());
+    FW_EXPECT(g8 == g7 * mf.Nodes[8].GetLocalTransform());
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::TestRandomHierarchy();
+    OVRFW::TestBrokenHierarchy();
+    return FW_TEST_RESULT();
+}
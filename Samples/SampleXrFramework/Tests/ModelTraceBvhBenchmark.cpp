@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   ModelTraceBvhBenchmark.cpp
+Content     :   Ray tracing cost of ModelTraceBvh against ModelTrace on the same meshes.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+// ModelTrace::Trace needs a kd-tree with ropes, which the ovrscene exporter builds offline.
+// This builds one whose leaves are the cells of a uniform grid, which is not as tight as an
+// exported tree but traverses the same way. Incoherent rays come from all around the mesh,
+// coherent rays fan out from one point as from a controller. Not run by ctest; run
+// ModelTraceBvhBenchmark directly.
+
+#include "Model/ModelTraceBvh.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+using OVR::Bounds3f;
+using OVR::Vector2f;
+using OVR::Vector3f;
+
+namespace OVRFW {
+
+static void FinishHeader(ModelTrace& trace) {
+    trace.header.numVertices = static_cast<int>(trace.vertices.size());
+    trace.header.numUvs = static_cast<int>(trace.uvs.size());
+    trace.header.numIndices = static_cast<int>(trace.indices.size());
+    trace.header.numNodes = static_cast<int>(trace.nodes.size());
+    trace.header.numLeafs = static_cast<int>(trace.leafs.size());
+    trace.header.numOverflow = static_cast<int>(trace.overflow.size());
+}
+
+// A sphere of radius 1 with outward facing triangles.
+static void MakeSphere(const int numTriangles, ModelTrace& trace) {
+    const int rings = static_cast<int>(sqrtf(numTriangles / 4.0f));
+    const int segments = rings * 2;
+    for (int r = 0; r <= rings; r++) {
+        const float theta = MATH_FLOAT_PI * r / rings;
+        for (int s = 0; s <= segments; s++) {
+            const float phi = MATH_FLOAT_TWOPI * s / segments;
+            trace.vertices.push_back(
+                Vector3f(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi)));
+            trace.uvs.push_back(Vector2f(
+                static_cast<float>(s) / segments, static_cast<float>(r) / rings));
+        }
+    }
+    for (int r = 0; r < rings; r++) {
+        for (int s = 0; s < segments; s++) {
+            const int i0 = r * (segments + 1) + s;
+            const int i1 = i0 + segments + 1;
+            const int quad[6] = {i0, i0 + 1, i1, i0 + 1, i1 + 1, i1};
+            trace.indices.insert(trace.indices.end(), quad, quad + 6);
+        }
+    }
+}
+
+// Small triangles scattered through a box, facing every way.
+static void MakeTriangleSoup(const int numTriangles, ModelTrace& trace) {
+    std::mt19937 random(numTriangles);
+    std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> offset(-0.1f, 0.1f);
+    for (int i = 0; i < numTriangles; i++) {
+        const Vector3f center(position(random), position(random), position(random));
+        for (int j = 0; j < 3; j++) {
+            const Vector3f corner(offset(random), offset(random), offset(random));
+            trace.indices.push_back(static_cast<int>(trace.vertices.size()));
+            trace.vertices.push_back(center + corner);
+            trace.uvs.push_back(Vector2f(0.0f));
+        }
+    }
+}
+
+// Fills in nodeIndex for the cells from lo to hi, splitting the longest side in half.
+static void BuildGridNode(
+    ModelTrace& trace,
+    const int nodeIndex,
+    const Bounds3f& bounds,
+    const float cellSize,
+    const int lo[3],
+    const int hi[3],
+    const int cellsPerAxis,
+    std::vector<int>& cellNodes) {
+    int axis = 0;
+    for (int i = 1; i < 3; i++) {
+        if (hi[i] - lo[i] > hi[axis] - lo[axis]) {
+            axis = i;
+        }
+    }
+    if (hi[axis] - lo[axis] == 1) {
+        // the leafs are stored in cell order
+        const int cell = (lo[2] * cellsPerAxis + lo[1]) * cellsPerAxis + lo[0];
+        trace.nodes[nodeIndex].data = (static_cast<unsigned int>(cell) << 3) | 1;
+        cellNodes[cell] = nodeIndex;
+        return;
+    }
+    const int mid = (lo[axis] + hi[axis]) / 2;
+    const int children = static_cast<int>(trace.nodes.size());
+    trace.nodes.resize(children + 2);
+    trace.nodes[nodeIndex].data = (static_cast<unsigned int>(children) << 3) | (axis << 1);
+    trace.nodes[nodeIndex].dist = bounds.GetMins()[axis] + mid * cellSize;
+    int leftHi[3] = {hi[0], hi[1], hi[2]};
+    int rightLo[3] = {lo[0], lo[1], lo[2]};
+    leftHi[axis] = mid;
+    rightLo[axis] = mid;
+    BuildGridNode(trace, children, bounds, cellSize, lo, leftHi, cellsPerAxis, cellNodes);
+    BuildGridNode(trace, children + 1, bounds, cellSize, rightLo, hi, cellsPerAxis, cellNodes);
+}
+
+static void BuildGridKdTree(ModelTrace& trace) {
+    const int numTriangles = static_cast<int>(trace.indices.size()) / 3;
+    int cellsPerAxis = 1;
+    while (cellsPerAxis < 32 && cellsPerAxis * cellsPerAxis * cellsPerAxis * 4 < numTriangles) {
+        cellsPerAxis *= 2;
+    }
+
+    Bounds3f bounds(Bounds3f::Init);
+    for (const Vector3f& v : trace.vertices) {
+        bounds.AddPoint(v);
+    }
+    const Vector3f size = bounds.GetSize();
+    const float cellSize = std::max(size.x, std::max(size.y, size.z)) * 1.001f / cellsPerAxis;
+    bounds = Bounds3f(bounds.GetMins(), bounds.GetMins() + Vector3f(cellSize * cellsPerAxis));
+    trace.header.bounds = bounds;
+
+    const int numCells = cellsPerAxis * cellsPerAxis * cellsPerAxis;
+    std::vector<std::vector<int>> cellTriangles(numCells);
+    for (int t = 0; t < numTriangles; t++) {
+        Bounds3f triBounds(Bounds3f::Init);
+        for (int j = 0; j < 3; j++) {
+            triBounds.AddPoint(trace.vertices[trace.indices[t * 3 + j]]);
+        }
+        int lo[3];
+        int hi[3];
+        for (int i = 0; i < 3; i++) {
+            lo[i] = static_cast<int>((triBounds.GetMins()[i] - bounds.GetMins()[i]) / cellSize);
+            hi[i] = static_cast<int>((triBounds.GetMaxs()[i] - bounds.GetMins()[i]) / cellSize);
+            lo[i] = std::max(0, std::min(lo[i], cellsPerAxis - 1));
+            hi[i] = std::max(0, std::min(hi[i], cellsPerAxis - 1));
+        }
+        for (int z = lo[2]; z <= hi[2]; z++) {
+            for (int y = lo[1]; y <= hi[1]; y++) {
+                for (int x = lo[0]; x <= hi[0]; x++) {
+                    cellTriangles[(z * cellsPerAxis + y) * cellsPerAxis + x].push_back(t);
+                }
+            }
+        }
+    }
+
+    trace.leafs.resize(numCells);
+    for (int cell = 0; cell < numCells; cell++) {
+        kdtree_leaf_t& leaf = trace.leafs[cell];
+        const std::vector<int>& tris = cellTriangles[cell];
+        if (static_cast<int>(tris.size()) <= RT_KDTREE_MAX_LEAF_TRIANGLES) {
+            for (int j = 0; j < RT_KDTREE_MAX_LEAF_TRIANGLES; j++) {
+                leaf.triangles[j] = (j < static_cast<int>(tris.size())) ? tris[j] : -1;
+            }
+        } else {
+            leaf.triangles[0] =
+                static_cast<int>(0x80000000u | static_cast<unsigned int>(trace.overflow.size()));
+            trace.overflow.insert(trace.overflow.end(), tris.begin(), tris.end());
+            trace.overflow.push_back(-1);
+        }
+        const Vector3f c(
+            cell % cellsPerAxis,
+            (cell / cellsPerAxis) % cellsPerAxis,
+            cell / (cellsPerAxis * cellsPerAxis));
+        const Vector3f mins = bounds.GetMins() + c * cellSize;
+        leaf.bounds = Bounds3f(mins, mins + Vector3f(cellSize));
+    }
+
+    std::vector<int> cellNodes(numCells, -1);
+    const int lo[3] = {0, 0, 0};
+    const int hi[3] = {cellsPerAxis, cellsPerAxis, cellsPerAxis};
+    trace.nodes.resize(1);
+    BuildGridNode(trace, 0, bounds, cellSize, lo, hi, cellsPerAxis, cellNodes);
+
+    // The ropes of the faces on the min and max side of each axis lead to the neighbor cells.
+    const int strides[3] = {1, cellsPerAxis, cellsPerAxis * cellsPerAxis};
+    for (int cell = 0; cell < numCells; cell++) {
+        for (int axis = 0; axis < 3; axis++) {
+            const int c = (cell / strides[axis]) % cellsPerAxis;
+            trace.leafs[cell].ropes[axis * 2 + 0] = (c > 0) ? cellNodes[cell - strides[axis]] : -1;
+            trace.leafs[cell].ropes[axis * 2 + 1] =
+                (c < cellsPerAxis - 1) ? cellNodes[cell + strides[axis]] : -1;
+        }
+    }
+
+    FinishHeader(trace);
+}
+
+static void MakeIncoherentRays(
+    const int numRays,
+    std::vector<Vector3f>& starts,
+    std::vector<Vector3f>& ends) {
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    for (int i = 0; i < numRays; i++) {
+        const Vector3f dir = Vector3f(value(random), value(random), value(random)).Normalized();
+        const Vector3f target(value(random) * 0.8f, value(random) * 0.8f, value(random) * 0.8f);
+        starts.push_back(dir * 3.0f);
+        ends.push_back(dir * 3.0f + (target - dir * 3.0f) * 2.0f);
+    }
+}
+
+static void MakeCoherentRays(
+    const int numRays,
+    std::vector<Vector3f>& starts,
+    std::vector<Vector3f>& ends) {
+    const int side = static_cast<int>(sqrtf(static_cast<float>(numRays)));
+    for (int i = 0; i < numRays; i++) {
+        starts.push_back(Vector3f(0.2f, 0.1f, 3.0f));
+        const float x = (i % side) * 0.6f / side - 0.3f;
+        const float y = (i / side) * 0.6f / side - 0.3f;
+        ends.push_back(Vector3f(x, y, -3.0f));
+    }
+}
+
+// Returns the average microseconds per ray.
+template <typename TraceRays>
+static double TimeRays(const int numRays, TraceRays traceRays) {
+    traceRays();
+    const int iterations = 5;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        traceRays();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / (iterations * numRays);
+}
+
+static void BenchmarkRays(
+    const ModelTrace& trace,
+    const ModelTraceBvh& bvh,
+    const char* rayName,
+    const std::vector<Vector3f>& starts,
+    const std::vector<Vector3f>& ends) {
+    const int numRays = static_cast<int>(starts.size());
+    // the exhaustive trace is only timed on the first rays
+    const int numExhaustiveRays = std::min(numRays, 256);
+    std::vector<traceResult_t> results(numRays);
+    int numHits = 0;
+    int numMismatches = 0;
+    for (int i = 0; i < numRays; i++) {
+        const traceResult_t expected = trace.Trace_Exhaustive(starts[i], ends[i]);
+        numHits += (expected.triangleIndex >= 0) ? 1 : 0;
+        numMismatches += (trace.Trace(starts[i], ends[i]).triangleIndex != expected.triangleIndex);
+        numMismatches += (bvh.Trace(starts[i], ends[i]).triangleIndex != expected.triangleIndex);
+    }
+
+    const double exhaustiveTime = TimeRays(numExhaustiveRays, [&]() {
+        for (int i = 0; i < numExhaustiveRays; i++) {
+            results[i] = trace.Trace_Exhaustive(starts[i], ends[i]);
+        }
+    });
+    const double kdTreeTime = TimeRays(numRays, [&]() {
+        for (int i = 0; i < numRays; i++) {
+            results[i] = trace.Trace(starts[i], ends[i]);
+        }
+    });
+    const double bvhTime = TimeRays(numRays, [&]() {
+        for (int i = 0; i < numRays; i++) {
+            results[i] = bvh.Trace(starts[i], ends[i]);
+        }
+    });
+    const double packetTime = TimeRays(numRays, [&]() {
+        bvh.TracePacket(starts.data(), ends.data(), numRays, results.data());
+    });
+
+    printf(
+        "  %-10s %5d hits: exhaustive %9.2f us  kd-tree %6.3f us  bvh %6.3f us  packet %6.3f us"
+        "%s\n",
+        rayName,
+        numHits,
+        exhaustiveTime,
+        kdTreeTime,
+        bvhTime,
+        packetTime,
+        (numMismatches > 0) ? "  MISMATCH" : "");
+}
+
+static void BenchmarkMesh(const char* name, ModelTrace& trace) {
+    FinishHeader(trace);
+    const auto kdTreeStart = std::chrono::steady_clock::now();
+    BuildGridKdTree(trace);
+    const auto kdTreeEnd = std::chrono::steady_clock::now();
+    ModelTraceBvh bvh;
+    bvh.Build(trace);
+    const auto bvhEnd = std::chrono::steady_clock::now();
+
+    printf(
+        "%s, %d triangles: grid kd-tree build %.1f ms, bvh build %.1f ms, %d nodes\n",
+        name,
+        static_cast<int>(trace.indices.size()) / 3,
+        std::chrono::duration<double, std::milli>(kdTreeEnd - kdTreeStart).count(),
+        std::chrono::duration<double, std::milli>(bvhEnd - kdTreeEnd).count(),
+        static_cast<int>(bvh.nodes.size()));
+
+    std::vector<Vector3f> starts;
+    std::vector<Vector3f> ends;
+    MakeIncoherentRays(4096, starts, ends);
+    BenchmarkRays(trace, bvh, "incoherent", starts, ends);
+    starts.clear();
+    ends.clear();
+    MakeCoherentRays(4096, starts, ends);
+    BenchmarkRays(trace, bvh, "coherent", starts, ends);
+}
+
+} // namespace OVRFW
+
+int main() {
+    printf("Time per ray\n");
+    {
+        OVRFW::ModelTrace trace;
+        OVRFW::MakeSphere(10000, trace);
+        OVRFW::BenchmarkMesh("sphere", trace);
+    }
+    {
+        OVRFW::ModelTrace trace;
+        OVRFW::MakeSphere(100000, trace);
+        OVRFW::BenchmarkMesh("sphere", trace);
+    }
+    {
+        OVRFW::ModelTrace trace;
+        OVRFW::MakeTriangleSoup(10000, trace);
+        OVRFW::BenchmarkMesh("soup", trace);
+    }
+    return 0;
+}
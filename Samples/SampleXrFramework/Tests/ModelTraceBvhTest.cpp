@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   ModelTraceBvhTest.cpp
+Content     :   ModelTraceBvh must find the same hits as ModelTrace::Trace_Exhaustive.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "Model/ModelTraceBvh.h"
+
+#include "FrameworkTest.h"
+
+#include <math.h>
+#include <random>
+
+using OVR::Vector2f;
+using OVR::Vector3f;
+
+namespace OVRFW {
+
+// Small triangles scattered through a box, facing every way, so rays hit both sides of them.
+static void MakeTriangleSoup(const int numTriangles, std::mt19937& random, ModelTrace& trace) {
+    std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> offset(-0.15f, 0.15f);
+    std::uniform_real_distribution<float> uv(0.0f, 1.0f);
+    for (int i = 0; i < numTriangles; i++) {
+        const Vector3f center(position(random), position(random), position(random));
+        for (int j = 0; j < 3; j++) {
+            const Vector3f corner(offset(random), offset(random), offset(random));
+            trace.indices.push_back(static_cast<int>(trace.vertices.size()));
+            trace.vertices.push_back(center + corner);
+            trace.uvs.push_back(Vector2f(uv(random), uv(random)));
+        }
+    }
+    trace.header.numVertices = static_cast<int>(trace.vertices.size());
+    trace.header.numUvs = static_cast<int>(trace.uvs.size());
+    trace.header.numIndices = static_cast<int>(trace.indices.size());
+    trace.header.numNodes = 0;
+    trace.header.numLeafs = 0;
+    trace.header.numOverflow = 0;
+}
+
+// Rays from outside the box through it, rays that start inside it, rays that stop short of
+// every triangle, and axis aligned rays with zero direction components.
+static void MakeRays(
+    const int numRays,
+    std::mt19937& random,
+    std::vector<Vector3f>& starts,
+    std::vector<Vector3f>& ends) {
+    std::uniform_real_distribution<float> position(-1.2f, 1.2f);
+    std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+    for (int i = 0; i < numRays; i++) {
+        Vector3f start(position(random), position(random), position(random));
+        Vector3f dir(direction(random), direction(random), direction(random));
+        switch (i % 4) {
+            case 0: // from outside the box
+                start = dir.Normalized() * 3.0f;
+                dir = Vector3f(position(random), position(random), position(random)) - start;
+                break;
+            case 1: // short
+                dir *= 0.05f;
+                break;
+            case 2: // axis aligned
+                dir = Vector3f(0.0f);
+                dir[i % 3] = (i & 8) ? 4.0f : -4.0f;
+                break;
+            default:
+                dir *= 4.0f;
+                break;
+        }
+        starts.push_back(start);
+        ends.push_back(start + dir);
+    }
+}
+
+static bool Near(const float a, const float b) {
+    return fabsf(a - b) <= 1e-5f;
+}
+
+static void ExpectSameResult(const traceResult_t& result, const traceResult_t& expected) {
+    FW_EXPECT(result.triangleIndex == expected.triangleIndex);
+    if (result.triangleIndex != expected.triangleIndex || expected.triangleIndex < 0) {
+        return;
+    }
+    FW_EXPECT(Near(result.fraction, expected.fraction));
+    FW_EXPECT(Near(result.uv.x, expected.uv.x) && Near(result.uv.y, expected.uv.y));
+    FW_EXPECT(
+        Near(result.normal.x, expected.normal.x) && Near(result.normal.y, expected.normal.y) &&
+        Near(result.normal.z, expected.normal.z));
+}
+
+static void TestTrace() {
+    std::mt19937 random(5);
+    ModelTrace trace;
+    MakeTriangleSoup(3000, random, trace);
+    ModelTraceBvh bvh;
+    bvh.Build(trace);
+
+    std::vector<Vector3f> starts;
+    std::vector<Vector3f> ends;
+    MakeRays(4000, random, starts, ends);
+
+    int numHits = 0;
+    for (int i = 0; i < static_cast<int>(starts.size()); i++) {
+        const traceResult_t expected = trace.Trace_Exhaustive(starts[i], ends[i]);
+        ExpectSameResult(bvh.Trace(starts[i], ends[i]), expected);
+        numHits += (expected.triangleIndex >= 0) ? 1 : 0;
+    }
+    // Both hits and misses are covered.
+    FW_EXPECT(numHits > 1000 && numHits < 3000);
+}
+
+// Packets of 4, with a partial packet at the end, give the same results as single rays.
+static void TestTracePacket() {
+    std::mt19937 random(6);
+    ModelTrace trace;
+    MakeTriangleSoup(3000, random, trace);
+    ModelTraceBvh bvh;
+    bvh.Build(trace);
+
+    std::vector<Vector3f> starts;
+    std::vector<Vector3f> ends;
+    MakeRays(1001, random, starts, ends);
+    // a coherent fan, as from a controller
+    for (int i = 0; i < 64; i++) {
+        starts.push_back(Vector3f(0.0f, 0.0f, 3.0f));
+        ends.push_back(Vector3f((i % 8) * 0.1f - 0.4f, (i / 8) * 0.1f - 0.4f, -3.0f));
+    }
+
+    std::vector<traceResult_t> results(starts.size());
+    bvh.TracePacket(starts.data(), ends.data(), static_cast<int>(starts.size()), results.data());
+    for (int i = 0; i < static_cast<int>(starts.size()); i++) {
+        ExpectSameResult(results[i], trace.Trace_Exhaustive(starts[i], ends[i]));
+    }
+}
+
+static void TestEmpty() {
+    ModelTraceBvh bvh;
+    bvh.Build(std::vector<Vector3f>(), std::vector<Vector2f>(), std::vector<int>());
+    const Vector3f start(0.0f, 0.0f, 1.0f);
+    const Vector3f end(0.0f, 0.0f, -1.0f);
+    FW_EXPECT(bvh.Trace(start, end).triangleIndex == -1);
+    traceResult_t result;
+    bvh.TracePacket(&start, &end, 1, &result);
+    FW_EXPECT(result.triangleIndex == -1);
+    FW_EXPECT(result.fraction == 1.0f);
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::TestTrace();
+    OVRFW::TestTracePacket();
+    OVRFW::TestEmpty();
+
+    return FW_TEST_RESULT();
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   ModelTransformBenchmark.cpp
+Content     :   ModelState::UpdateTransforms cost against the share of changed nodes.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+// A 10k node hierarchy shaped like a few skinned characters: chains of joints with
+// occasional branches.  Each round marks a random share of the nodes as changed and times
+// UpdateTransforms, next to the recursive per node update it replaced, which recalculates
+// a subtree once for every changed node in it.  Not run by ctest; run ModelTransformBenchmark
+// directly.
+
+#include "Model/ModelFile.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+using OVR::Matrix4f;
+using OVR::Vector3f;
+
+namespace OVRFW {
+
+static void RecursiveUpdate(
+    const ModelFile& mf,
+    const std::vector<Matrix4f>& locals,
+    std::vector<Matrix4f>& globals,
+    const int i) {
+    const int parent = mf.Nodes[i].parentIndex;
+    globals[i] = (parent < 0 ? Matrix4f::Identity() : globals[parent]) * locals[i];
+    for (const int child : mf.Nodes[i].children) {
+        RecursiveUpdate(mf, locals, globals, child);
+    }
+}
+
+} // namespace OVRFW
+
+int main() {
+    using namespace OVRFW;
+    const int numNodes = 10000;
+    std::mt19937 random(1);
+    ModelFile mf;
+    mf.Nodes.resize(numNodes);
+    for (int i = 0; i < numNodes; i++) {
+        const float angle = static_cast<float>(i % 17) * 0.1f;
+        mf.Nodes[i].SetLocalTransform(
+            Matrix4f::Translation(Vector3f(0.0f, 0.1f, 0.0f)) * Matrix4f::RotationZ(angle));
+        // mostly continue the chain, sometimes branch off an earlier joint
+        int parent = -1;
+        if (i % 500 != 0) {
+            parent = (random() % 8 != 0) ? i - 1 : i - 1 - static_cast<int>(random() % 20);
+            parent = std::max(parent, i - i % 500);
+        }
+        mf.Nodes[i].parentIndex = parent;
+        if (parent >= 0) {
+            mf.Nodes[parent].children.push_back(i);
+        }
+    }
+
+    ModelState state;
+    state.GenerateStateFromModelFile(&mf);
+    std::vector<Matrix4f> locals(numNodes);
+    std::vector<Matrix4f> globals(numNodes);
+    for (int i = 0; i < numNodes; i++) {
+        locals[i] = mf.Nodes[i].GetLocalTransform();
+    }
+
+    printf("UpdateTransforms, %d nodes\n", numNodes);
+    printf("  changed   updated   flattened   recursive\n");
+    const int rounds = 50;
+    for (const int percent : {0, 1, 5, 10, 25, 50, 100}) {
+        double flatTime = 0.0;
+        double recursiveTime = 0.0;
+        long long numUpdated = 0;
+        for (int round = 0; round < rounds; round++) {
+            std::vector<int> changed;
+            for (int i = 0; i < numNodes; i++) {
+                if (static_cast<int>(random() % 100) < percent) {
+                    changed.push_back(i);
+                }
+            }
+
+            for (const int i : changed) {
+                state.SetTransformDirty(state.nodeStates[i].transformIndex);
+            }
+            auto start = std::chrono::steady_clock::now();
+            numUpdated += state.UpdateTransforms();
+            auto end = std::chrono::steady_clock::now();
+            flatTime += std::chrono::duration<double, std::micro>(end - start).count();
+
+            start = std::chrono::steady_clock::now();
+            for (const int i : changed) {
+                RecursiveUpdate(mf, locals, globals, i);
+            }
+            end = std::chrono::steady_clock::now();
+            recursiveTime += std::chrono::duration<double, std::micro>(end - start).count();
+        }
+        printf(
+            "  %6d%%   %7lld   %8.1f us   %8.1f us\n",
+            percent,
+            numUpdated / rounds,
+            flatTime / rounds,
+            recursiveTime / rounds);
+    }
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   PackageIndexBenchmark.cpp
+Content     :   Lookup and read throughput of ovrPackageIndex against minizip over threads.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+// The package has 4096 files in 64 directories, half stored 16 KB noise and half deflated
+// 64 KB of compressible data, in a temp file that stays in the page cache. Every thread
+// count does the same total work, split between the threads. The minizip numbers go through
+// ovr_*OtherApplicationPackage on one shared handle, which serializes them behind the package
+// lock, and cover an eighth of the files. Not run by ctest; run PackageIndexBenchmark directly.
+
+#include "PackageFiles.h"
+
+#include "SyntheticZip.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <thread>
+
+namespace OVRFW {
+
+static std::vector<ovrSyntheticZipEntry> MakeEntries() {
+    std::mt19937 random(1);
+    std::vector<ovrSyntheticZipEntry> entries(4096);
+    for (size_t i = 0; i < entries.size(); i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "assets/Dir%02d/File%04d.bin", int(i % 64), int(i));
+        entries[i].Name = name;
+        entries[i].Deflate = (i % 2) != 0;
+        entries[i].Data.resize(entries[i].Deflate ? 65536 : 16384);
+        for (uint8_t& value : entries[i].Data) {
+            value = static_cast<uint8_t>(entries[i].Deflate ? random() % 8 : random());
+        }
+    }
+    return entries;
+}
+
+// Runs work(name) for every name, passes times, split over numThreads threads. Returns the
+// seconds it took.
+static double TimeThreads(
+    const std::vector<std::string>& names,
+    const int numThreads,
+    const int passes,
+    const std::function<bool(const char* name)>& work) {
+    std::atomic<int> failures(0);
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++) {
+        threads.emplace_back([&, t]() {
+            for (int pass = 0; pass < passes; pass++) {
+                for (size_t i = t; i < names.size(); i += numThreads) {
+                    failures += work(names[i].c_str()) ? 0 : 1;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    if (failures != 0) {
+        printf("  %d failures\n", failures.load());
+    }
+    return std::chrono::duration<double>(end - start).count();
+}
+
+} // namespace OVRFW
+
+int main() {
+    const std::vector<OVRFW::ovrSyntheticZipEntry> entries = OVRFW::MakeEntries();
+    const std::vector<uint8_t> zip = OVRFW::MakeSyntheticZip(entries);
+    const std::string path = OVRFW::WriteTempFile("PackageIndexBenchmark.zip", zip);
+    if (path.empty()) {
+        printf("failed to write the package\n");
+        return 1;
+    }
+    // read in a different order than the package is laid out
+    std::vector<size_t> order(entries.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(2));
+    // minizip is slow enough that it only reads the first eighth of the files
+    const size_t numZipNames = entries.size() / 8;
+    size_t totalBytes = 0;
+    size_t zipBytes = 0;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < order.size(); i++) {
+        const OVRFW::ovrSyntheticZipEntry& entry = entries[order[i]];
+        totalBytes += entry.Data.size();
+        zipBytes += (i < numZipNames) ? entry.Data.size() : 0;
+        // ask for the names in another case, like asset paths written by hand
+        std::string name = entry.Name;
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        names.push_back(name);
+    }
+    const std::vector<std::string> zipNames(names.begin(), names.begin() + numZipNames);
+
+    const auto openStart = std::chrono::steady_clock::now();
+    OVRFW::ovrPackageIndex index;
+    if (!index.Open(path.c_str())) {
+        printf("failed to index the package\n");
+        return 1;
+    }
+    const auto openEnd = std::chrono::steady_clock::now();
+    void* zipFile = OVRFW::ovr_OpenOtherApplicationPackage(path.c_str());
+
+    const int numCores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    printf(
+        "%d files, %d KB zip, %d MB uncompressed, %d cores, indexed in %.2f ms\n",
+        static_cast<int>(entries.size()),
+        static_cast<int>(zip.size() / 1024),
+        static_cast<int>(totalBytes >> 20),
+        numCores,
+        std::chrono::duration<double, std::milli>(openEnd - openStart).count());
+
+    const double numLookups = static_cast<double>(names.size());
+    const double totalMegabytes = static_cast<double>(totalBytes) / (1024.0 * 1024.0);
+    const double zipMegabytes = static_cast<double>(zipBytes) / (1024.0 * 1024.0);
+    const int lookupPasses = 100;
+    const int readPasses = 2;
+    printf("             lookups / s              MB / s read\n");
+    printf("threads     index      minizip        index  minizip\n");
+    for (int numThreads = 1; numThreads <= numCores * 2; numThreads *= 2) {
+        const double indexLookup =
+            OVRFW::TimeThreads(names, numThreads, lookupPasses, [&](const char* name) {
+                return index.FileExists(name);
+            });
+        const double zipLookup = OVRFW::TimeThreads(zipNames, numThreads, 1, [&](const char* name) {
+            return OVRFW::ovr_OtherPackageFileExists(zipFile, name);
+        });
+        const double indexRead =
+            OVRFW::TimeThreads(names, numThreads, readPasses, [&](const char* name) {
+                std::vector<uint8_t> buffer;
+                return index.ReadFile(name, buffer);
+            });
+        const double zipRead = OVRFW::TimeThreads(zipNames, numThreads, 1, [&](const char* name) {
+            std::vector<uint8_t> buffer;
+            return OVRFW::ovr_ReadFileFromOtherApplicationPackage(zipFile, name, buffer);
+        });
+        printf(
+            "%4d    %10.0f   %10.0f   %10.1f %8.1f\n",
+            numThreads,
+            numLookups * lookupPasses / indexLookup,
+            zipNames.size() / zipLookup,
+            totalMegabytes * readPasses / indexRead,
+            zipMegabytes / zipRead);
+    }
+
+    OVRFW::ovr_CloseOtherApplicationPackage(zipFile);
+    index.Close();
+    remove(path.c_str());
+    return 0;
+}
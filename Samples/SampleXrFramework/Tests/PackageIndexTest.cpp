@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   PackageIndexTest.cpp
+Content     :   ovrPackageIndex parsing of the central directory, checked against minizip.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "PackageFiles.h"
+
+#include "FrameworkTest.h"
+#include "SyntheticZip.h"
+
+#include <unzip.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <thread>
+
+namespace OVRFW {
+
+static std::vector<uint8_t> Bytes(const char* text) {
+    return std::vector<uint8_t>(text, text + strlen(text));
+}
+
+static std::vector<uint8_t> Noise(const size_t size, const uint32_t seed, const int range) {
+    std::mt19937 random(seed);
+    std::vector<uint8_t> data(size);
+    for (uint8_t& value : data) {
+        value = static_cast<uint8_t>(random() % range);
+    }
+    return data;
+}
+
+static std::vector<ovrSyntheticZipEntry> MakeEntries() {
+    std::vector<ovrSyntheticZipEntry> entries(8);
+    entries[0].Name = "assets/stored.bin";
+    entries[0].Data = Noise(5000, 1, 256);
+    entries[1].Name = "assets/deflated.bin";
+    entries[1].Data = Noise(20000, 2, 4);
+    entries[1].Deflate = true;
+    entries[2].Name = "Assets/Textures/Stone.KTX2";
+    entries[2].Data = Noise(3000, 3, 256);
+    entries[3].Name = "assets/Models/Mixed.GLB";
+    entries[3].Data = Noise(7000, 4, 16);
+    entries[3].Deflate = true;
+    entries[4].Name = "res/raw/dup.txt";
+    entries[4].Data = Bytes("first");
+    entries[5].Name = "RES/raw/DUP.txt";
+    entries[5].Data = Bytes("second");
+    entries[5].Deflate = true;
+    entries[6].Name = "assets/empty.txt";
+    entries[7].Name = "assets/secret.bin";
+    entries[7].Data = Bytes("encrypted");
+    entries[7].Encrypt = true;
+    return entries;
+}
+
+static bool OpenZip(ovrPackageIndex& index, const std::vector<uint8_t>& zip) {
+    const std::string path = WriteTempFile("PackageIndexTest.zip", zip);
+    FW_EXPECT(!path.empty());
+    const bool opened = index.Open(path.c_str());
+    remove(path.c_str());
+    return opened;
+}
+
+static bool
+ReadsAs(const ovrPackageIndex& index, const char* name, const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> buffer;
+    return index.ReadFile(name, buffer) && buffer == data;
+}
+
+// Stored, deflated, mixed case and duplicate names read back the way minizip reads them.
+static void TestRead() {
+    const std::vector<ovrSyntheticZipEntry> entries = MakeEntries();
+    const std::vector<uint8_t> zip = MakeSyntheticZip(entries, "package comment");
+    const std::string path = WriteTempFile("PackageIndexTest.zip", zip);
+    FW_EXPECT(!path.empty());
+
+    ovrPackageIndex index;
+    FW_EXPECT(!index.IsOpen());
+    FW_EXPECT(!index.FileExists(entries[0].Name.c_str()));
+    FW_EXPECT(index.Open(path.c_str()));
+    FW_EXPECT(index.IsOpen());
+    // the duplicate collapses and the encrypted entry is left out
+    FW_EXPECT(index.GetNumFiles() == 6);
+
+    void* zipFile = ovr_OpenOtherApplicationPackage(path.c_str());
+    FW_EXPECT(zipFile != nullptr);
+    for (size_t i = 0; i < entries.size() - 1; i++) {
+        const char* name = entries[i].Name.c_str();
+        std::vector<uint8_t> expected;
+        FW_EXPECT(ovr_ReadFileFromOtherApplicationPackage(zipFile, name, expected));
+        FW_EXPECT(index.FileExists(name));
+        FW_EXPECT(ReadsAs(index, name, expected));
+    }
+    ovr_CloseOtherApplicationPackage(zipFile);
+
+    FW_EXPECT(ReadsAs(index, "assets/stored.bin", entries[0].Data));
+    FW_EXPECT(ReadsAs(index, "assets/deflated.bin", entries[1].Data));
+    FW_EXPECT(ReadsAs(index, "assets/empty.txt", std::vector<uint8_t>()));
+
+    // names are case insensitive
+    FW_EXPECT(ReadsAs(index, "assets/textures/stone.ktx2", entries[2].Data));
+    FW_EXPECT(ReadsAs(index, "ASSETS/TEXTURES/STONE.KTX2", entries[2].Data));
+    FW_EXPECT(ReadsAs(index, "Assets/models/mixed.glb", entries[3].Data));
+
+    // the first of the duplicates wins, whichever case it is asked for in
+    FW_EXPECT(ReadsAs(index, "res/raw/dup.txt", entries[4].Data));
+    FW_EXPECT(ReadsAs(index, "RES/raw/DUP.txt", entries[4].Data));
+
+    FW_EXPECT(!index.FileExists("assets/secret.bin"));
+    FW_EXPECT(!index.FileExists("assets/missing.bin"));
+    FW_EXPECT(!index.FileExists("assets/stored"));
+    FW_EXPECT(!index.FileExists(nullptr));
+    std::vector<uint8_t> buffer(4);
+    FW_EXPECT(!index.ReadFile("assets/missing.bin", buffer) && buffer.empty());
+
+    // stored files are views of the mapping, compressed ones are not
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+    FW_EXPECT(index.GetStoredFile("Assets/Stored.bin", data, length));
+    FW_EXPECT(length == entries[0].Data.size());
+    FW_EXPECT(data != nullptr && memcmp(data, entries[0].Data.data(), length) == 0);
+    FW_EXPECT(!index.GetStoredFile("assets/deflated.bin", data, length));
+    FW_EXPECT(data == nullptr && length == 0);
+
+    // any number of threads read at once
+    std::vector<std::thread> threads;
+    std::vector<int> failures(4, 0);
+    for (size_t t = 0; t < failures.size(); t++) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 200; i++) {
+                const ovrSyntheticZipEntry& entry = entries[(t + i) % 4];
+                failures[t] += ReadsAs(index, entry.Name.c_str(), entry.Data) ? 0 : 1;
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (const int count : failures) {
+        FW_EXPECT(count == 0);
+    }
+
+    index.Close();
+    FW_EXPECT(!index.IsOpen());
+    FW_EXPECT(index.GetNumFiles() == 0);
+    FW_EXPECT(!index.FileExists("assets/stored.bin"));
+    remove(path.c_str());
+}
+
+static void WriteU16(std::vector<uint8_t>& zip, const size_t offset, const uint32_t value) {
+    zip[offset] = static_cast<uint8_t>(value);
+    zip[offset + 1] = static_cast<uint8_t>(value >> 8);
+}
+
+static void WriteU32(std::vector<uint8_t>& zip, const size_t offset, const uint32_t value) {
+    WriteU16(zip, offset, value & 0xffff);
+    WriteU16(zip, offset + 2, value >> 16);
+}
+
+static uint32_t ReadU32(const std::vector<uint8_t>& zip, const size_t offset) {
+    return zip[offset] | (zip[offset + 1] << 8) | (zip[offset + 2] << 16) |
+        (static_cast<uint32_t>(zip[offset + 3]) << 24);
+}
+
+// Truncated and damaged packages fail to open, damaged entries fail to read.
+static void TestDamaged() {
+    const std::vector<ovrSyntheticZipEntry> entries = MakeEntries();
+    const std::vector<uint8_t> zip = MakeSyntheticZip(entries);
+    const size_t eocd = zip.size() - 22;
+    const size_t centralDir = ReadU32(zip, eocd + 16);
+    ovrPackageIndex index;
+    FW_EXPECT(OpenZip(index, zip));
+
+    FW_EXPECT(!index.Open("/nonexistent/package.apk"));
+    FW_EXPECT(!index.IsOpen());
+    FW_EXPECT(!OpenZip(index, std::vector<uint8_t>()));
+    FW_EXPECT(!OpenZip(index, Noise(1000, 5, 256)));
+
+    // cut off anywhere, the end record or the central directory it points to is missing
+    for (const size_t length : {size_t(0), size_t(21), centralDir, eocd, eocd + 21}) {
+        FW_EXPECT(!OpenZip(index, std::vector<uint8_t>(zip.begin(), zip.begin() + length)));
+    }
+
+    std::vector<uint8_t> damaged = zip;
+    WriteU32(damaged, eocd + 16, static_cast<uint32_t>(zip.size()));
+    FW_EXPECT(!OpenZip(index, damaged)); // central directory past the end
+
+    damaged = zip;
+    WriteU32(damaged, eocd + 12, ReadU32(zip, eocd + 12) - 1);
+    FW_EXPECT(!OpenZip(index, damaged)); // central directory one byte short
+
+    damaged = zip;
+    WriteU16(damaged, eocd + 10, static_cast<uint32_t>(entries.size() + 1));
+    FW_EXPECT(!OpenZip(index, damaged)); // more entries than the directory holds
+
+    damaged = zip;
+    WriteU16(damaged, eocd + 10, 0xffff);
+    FW_EXPECT(!OpenZip(index, damaged)); // zip64
+
+    damaged = zip;
+    damaged[centralDir + 46 + entries[0].Name.size()] ^= 0xff;
+    FW_EXPECT(!OpenZip(index, damaged)); // second central header signature
+
+    damaged = zip;
+    WriteU16(damaged, centralDir + 28, 0xfff0);
+    FW_EXPECT(!OpenZip(index, damaged)); // name runs past the directory
+
+    // a bad local header or data only fails the entry
+    damaged = zip;
+    WriteU32(damaged, centralDir + 42, 1);
+    FW_EXPECT(OpenZip(index, damaged));
+    FW_EXPECT(index.FileExists(entries[0].Name.c_str()));
+    std::vector<uint8_t> buffer;
+    FW_EXPECT(!index.ReadFile(entries[0].Name.c_str(), buffer) && buffer.empty());
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+    FW_EXPECT(!index.GetStoredFile(entries[0].Name.c_str(), data, length));
+    FW_EXPECT(ReadsAs(index, entries[1].Name.c_str(), entries[1].Data));
+
+    damaged = zip;
+    const size_t deflatedHeader = 30 + entries[0].Name.size() + entries[0].Data.size();
+    const size_t deflatedData = deflatedHeader + 30 + entries[1].Name.size();
+    for (size_t i = 0; i < 16; i++) {
+        damaged[deflatedData + i] = 0xff;
+    }
+    FW_EXPECT(OpenZip(index, damaged));
+    FW_EXPECT(!index.ReadFile(entries[1].Name.c_str(), buffer));
+    FW_EXPECT(ReadsAs(index, entries[0].Name.c_str(), entries[0].Data));
+
+    damaged = zip;
+    const size_t secondCentralHeader = centralDir + 46 + entries[0].Name.size();
+    WriteU32(damaged, secondCentralHeader + 24, ReadU32(zip, secondCentralHeader + 24) + 1);
+    FW_EXPECT(OpenZip(index, damaged));
+    FW_EXPECT(!index.ReadFile(entries[1].Name.c_str(), buffer)); // uncompressed size is wrong
+
+    damaged = zip;
+    WriteU32(damaged, centralDir + 20, ReadU32(zip, centralDir + 20) - 1);
+    FW_EXPECT(OpenZip(index, damaged));
+    FW_EXPECT(!index.ReadFile(entries[0].Name.c_str(), buffer)); // stored sizes differ
+
+    // the last entry's data runs past the end of the file
+    damaged = zip;
+    const size_t lastCentralHeader = eocd - 46 - entries.back().Name.size();
+    WriteU32(damaged, lastCentralHeader + 20, static_cast<uint32_t>(zip.size()));
+    WriteU32(damaged, lastCentralHeader + 24, static_cast<uint32_t>(zip.size()));
+    WriteU32(damaged, lastCentralHeader + 16, 0);
+    WriteU16(damaged, lastCentralHeader + 8, 0);
+    FW_EXPECT(OpenZip(index, damaged));
+    FW_EXPECT(!index.ReadFile(entries.back().Name.c_str(), buffer));
+    index.Close();
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::TestRead();
+    OVRFW::TestDamaged();
+    return FW_TEST_RESULT();
+}
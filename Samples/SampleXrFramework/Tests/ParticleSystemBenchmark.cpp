@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   ParticleSystemBenchmark.cpp
+Content     :   ovrParticleSystem::Frame cost against particle and thread count.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+// Times Frame for 1k to 100k live particles, with no job pool and with pools of 1, 2, 4...
+// threads, for the quad vertices and the instanced records, with and without sorting.  The
+// geometry updates go to FakeGl, which copies the data like a driver would but does no
+// other work.  The target was 50k particles in about 1 ms.  Not run by ctest; run
+// ParticleSystemBenchmark directly.
+
+#include "Render/ParticleSystem.h"
+#include "Misc/JobPool.h"
+
+#include "FakeGl.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+
+using OVR::Matrix4f;
+using OVR::Vector3f;
+using OVR::Vector4f;
+
+namespace OVRFW {
+
+// Returns the average milliseconds per Frame call.
+static double TimeFrames(
+    const int numParticles,
+    ovrJobPool* jobPool,
+    const bool sorted,
+    const bool instanced) {
+    FakeGlReset();
+    ovrParticleSystem particles;
+    particles.Init(
+        numParticles, nullptr, ovrParticleSystem::GetDefaultGpuState(), sorted, instanced);
+    particles.SetJobPool(jobPool);
+
+    ovrApplFrameIn frame;
+    frame.PredictedDisplayTime = 1.0;
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    for (int i = 0; i < numParticles; i++) {
+        particles.AddParticle(
+            frame,
+            Vector3f(value(random), value(random), value(random) - 3.0f),
+            value(random) * 3.0f,
+            Vector3f(value(random), value(random) + 1.0f, value(random)) * 0.1f,
+            Vector3f(0.0f, -0.2f, 0.0f),
+            Vector4f(1.0f, 0.5f, 0.25f, 1.0f),
+            ovrEaseFunc::ALPHA_IN_OUT_LINEAR,
+            value(random),
+            0.05f,
+            1000.0f,
+            0);
+    }
+
+    const Matrix4f view = Matrix4f::LookAtRH(
+        Vector3f(0.0f, 1.6f, 0.0f), Vector3f(0.0f, 1.0f, -3.0f), Vector3f(0.0f, 1.0f, 0.0f));
+    const int frames = 40;
+    double total = 0.0;
+    for (int i = 0; i <= frames; i++) {
+        frame.PredictedDisplayTime += 1.0 / 72.0;
+        const auto start = std::chrono::steady_clock::now();
+        particles.Frame(frame, nullptr, view);
+        const auto end = std::chrono::steady_clock::now();
+        // the first frame warms up
+        if (i > 0) {
+            total += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+    }
+    particles.Shutdown();
+    return total / frames;
+}
+
+} // namespace OVRFW
+
+int main() {
+    const int numCores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    // 0 is no job pool, the calling thread works on the jobs too
+    std::vector<int> threadCounts = {0};
+    for (int numThreads = 1; numThreads < numCores * 2; numThreads *= 2) {
+        threadCounts.push_back(numThreads);
+    }
+    std::vector<std::unique_ptr<OVRFW::ovrJobPool>> jobPools;
+    for (const int numThreads : threadCounts) {
+        jobPools.emplace_back(numThreads > 0 ? new OVRFW::ovrJobPool(numThreads) : nullptr);
+    }
+
+    printf("ovrParticleSystem::Frame, ms per frame, %d cores\n", numCores);
+    for (const bool instanced : {false, true}) {
+        for (const bool sorted : {false, true}) {
+            printf(
+                "%s, %s\n  particles",
+                instanced ? "instanced" : "quads",
+                sorted ? "sorted" : "unsorted");
+            for (const int numThreads : threadCounts) {
+                printf("  %2d threads", numThreads);
+            }
+            printf("\n");
+            for (const int numParticles : {1000, 10000, 50000, 100000}) {
+                printf("  %9d", numParticles);
+                for (size_t i = 0; i < threadCounts.size(); i++) {
+                    const double time = OVRFW::TimeFrames(
+                        numParticles, jobPools[i].get(), sorted, instanced);
+                    printf("  %7.3f   ", time);
+                }
+                printf("\n");
+            }
+        }
+    }
+    return 0;
+}
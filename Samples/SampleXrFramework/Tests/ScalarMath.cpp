@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   ScalarMath.cpp
+Content     :   The scalar code of OVR_Math.h for the operations that have SIMD paths.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "ScalarMath.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits>
+#include <type_traits>
+
+#define OVR_MATH_DISABLE_SIMD
+#define OVR OVR_Scalar
+#include "OVR_Math.h"
+#undef OVR
+
+#if defined(OVR_MATH_SSE2) || defined(OVR_MATH_NEON)
+#error "ScalarMath.cpp must be built without the SIMD paths"
+#endif
+
+namespace OVRFW {
+
+using OVR_Scalar::Matrix4f;
+using OVR_Scalar::Posef;
+using OVR_Scalar::Quatf;
+using OVR_Scalar::Vector3f;
+
+static_assert(sizeof(Matrix4f) == 16 * sizeof(float), "Matrix4f layout");
+static_assert(sizeof(Quatf) == 4 * sizeof(float), "Quatf layout");
+static_assert(sizeof(Vector3f) == 3 * sizeof(float), "Vector3f layout");
+static_assert(sizeof(Posef) == 7 * sizeof(float), "Posef layout");
+
+void ScalarMatrix4fMultiply(const float* a, const float* b, float* out, const int count) {
+    const Matrix4f* ma = reinterpret_cast<const Matrix4f*>(a);
+    const Matrix4f* mb = reinterpret_cast<const Matrix4f*>(b);
+    Matrix4f* mout = reinterpret_cast<Matrix4f*>(out);
+    for (int i = 0; i < count; i++) {
+        mout[i] = ma[i] * mb[i];
+    }
+}
+
+void ScalarMatrix4fTransformPoints(
+    const float* m,
+    const float* points,
+    float* out,
+    const int count) {
+    reinterpret_cast<const Matrix4f*>(m)->TransformPoints(
+        reinterpret_cast<const Vector3f*>(points), reinterpret_cast<Vector3f*>(out), count);
+}
+
+void ScalarQuatfMultiply(const float* a, const float* b, float* out, const int count) {
+    const Quatf* qa = reinterpret_cast<const Quatf*>(a);
+    const Quatf* qb = reinterpret_cast<const Quatf*>(b);
+    Quatf* qout = reinterpret_cast<Quatf*>(out);
+    for (int i = 0; i < count; i++) {
+        qout[i] = qa[i] * qb[i];
+    }
+}
+
+void ScalarQuatfRotate(const float* q, const float* v, float* out, const int count) {
+    const Quatf* qq = reinterpret_cast<const Quatf*>(q);
+    const Vector3f* vv = reinterpret_cast<const Vector3f*>(v);
+    Vector3f* vout = reinterpret_cast<Vector3f*>(out);
+    for (int i = 0; i < count; i++) {
+        vout[i] = qq[i].Rotate(vv[i]);
+    }
+}
+
+void ScalarPosefMultiply(const float* a, const float* b, float* out, const int count) {
+    const Posef* pa = reinterpret_cast<const Posef*>(a);
+    const Posef* pb = reinterpret_cast<const Posef*>(b);
+    Posef* pout = reinterpret_cast<Posef*>(out);
+    for (int i = 0; i < count; i++) {
+        pout[i] = pa[i] * pb[i];
+    }
+}
+
+void ScalarPosefTransform(const float* p, const float* v, float* out, const int count) {
+    const Posef* pp = reinterpret_cast<const Posef*>(p);
+    const Vector3f* vv = reinterpret_cast<const Vector3f*>(v);
+    Vector3f* vout = reinterpret_cast<Vector3f*>(out);
+    for (int i = 0; i < count; i++) {
+        vout[i] = pp[i].Transform(vv[i]);
+    }
+}
+
+} // namespace OVRFW
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   ScalarMath.h
+Content     :   The scalar code of OVR_Math.h for the operations that have SIMD paths.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+// ScalarMath.cpp includes OVR_Math.h with OVR_MATH_DISABLE_SIMD in a namespace of its own, so
+// the scalar templates can be called next to the SIMD specializations without breaking the one
+// definition rule. The arguments are arrays of count values with the layout of the OVR types:
+// Matrix4f is 16 floats, Quatf is x, y, z, w, Vector3f is 3 floats and Posef is a Quatf
+// followed by a Vector3f.
+
+namespace OVRFW {
+
+void ScalarMatrix4fMultiply(const float* a, const float* b, float* out, const int count);
+void ScalarMatrix4fTransformPoints(
+    const float* m,
+    const float* points,
+    float* out,
+    const int count);
+void ScalarQuatfMultiply(const float* a, const float* b, float* out, const int count);
+void ScalarQuatfRotate(const float* q, const float* v, float* out, const int count);
+void ScalarPosefMultiply(const float* a, const float* b, float* out, const int count);
+void ScalarPosefTransform(const float* p, const float* v, float* out, const int count);
+
+} // namespace OVRFW
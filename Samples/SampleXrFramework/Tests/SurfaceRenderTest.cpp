@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   SurfaceRenderTest.cpp
+Content     :   Checks the GL command stream of ovrSurfaceRender against a recording fake.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "Render/SurfaceRender.h"
+
+#include "FakeGl.h"
+#include "FrameworkTest.h"
+
+#include <string.h>
+
+using OVR::Matrix4f;
+using OVR::Vector3f;
+
+namespace OVRFW {
+
+static const GLuint InstancedProgram = 11;
+static const GLuint PlainProgram = 12;
+static const int InstanceBinding = 1;
+
+static void InitSurface(ovrSurfaceDef& surface, const GLuint program, const GLuint vao) {
+    surface.geo.vertexArrayObject = vao;
+    surface.geo.indexCount = 36;
+    surface.geo.primitiveType = GL_TRIANGLES;
+    surface.geo.IndexType = GL_UNSIGNED_SHORT;
+    surface.graphicsCommand.Program.Program = program;
+    if (program == InstancedProgram) {
+        // What GlProgram::Build finds for a shader built with INSTANCED_MODEL_MATRICES.
+        surface.graphicsCommand.Program.InstanceMatrices.Type = ovrProgramParmType::BUFFER_UNIFORM;
+        surface.graphicsCommand.Program.InstanceMatrices.Location = 0;
+        surface.graphicsCommand.Program.InstanceMatrices.Binding = InstanceBinding;
+    } else {
+        surface.graphicsCommand.Program.ModelMatrix.Location = 3;
+    }
+}
+
+static std::vector<const ovrFakeGlCall*> CallsNamed(const char* name) {
+    std::vector<const ovrFakeGlCall*> calls;
+    for (const ovrFakeGlCall& call : FakeGlCalls()) {
+        if (strcmp(call.Name, name) == 0) {
+            calls.push_back(&call);
+        }
+    }
+    return calls;
+}
+
+static ovrDrawCounters Render(ovrSurfaceRender& render, const std::vector<ovrDrawSurface>& list) {
+    FakeGlClearCalls();
+    return render.RenderSurfaceList(list, Matrix4f(), Matrix4f(), 0);
+}
+
+// Consecutive draws of one surface become a single instanced draw that reads transposed
+// model matrices from an aligned range of the instance matrix ubo.
+static void TestMergedDraws(ovrSurfaceRender& render) {
+    ovrSurfaceDef surface;
+    InitSurface(surface, InstancedProgram, 5);
+
+    std::vector<ovrDrawSurface> list;
+    for (int i = 0; i < 10; i++) {
+        list.push_back(ovrDrawSurface(Matrix4f::Translation(Vector3f(i, 0, 0)), &surface));
+    }
+    const ovrDrawCounters counters = Render(render, list);
+
+    FW_EXPECT(FakeGlCount("glDrawElements") == 0);
+    const std::vector<const ovrFakeGlCall*> draws = CallsNamed("glDrawElementsInstanced");
+    FW_EXPECT(draws.size() == 1);
+    if (draws.size() == 1) {
+        FW_EXPECT(draws[0]->Args[0] == GL_TRIANGLES);
+        FW_EXPECT(draws[0]->Args[1] == 36);
+        FW_EXPECT(draws[0]->Args[3] == 10);
+    }
+    FW_EXPECT(counters.numDrawCalls == 1);
+    FW_EXPECT(counters.numMergedSurfaces == 9);
+    FW_EXPECT(FakeGlCount("glUniformMatrix4fv") == 0);
+
+    const std::vector<const ovrFakeGlCall*> binds = CallsNamed("glBindBufferRange");
+    FW_EXPECT(binds.size() == 1);
+    if (binds.size() == 1) {
+        FW_EXPECT(binds[0]->Args[0] == GL_UNIFORM_BUFFER);
+        FW_EXPECT(binds[0]->Args[1] == InstanceBinding);
+        FW_EXPECT(binds[0]->Args[3] == 0);
+        FW_EXPECT(binds[0]->Args[4] == MAX_INSTANCE_MATRICES * sizeof(Matrix4f));
+
+        const std::vector<uint8_t>& data = FakeGlBufferData(static_cast<GLuint>(binds[0]->Args[2]));
+        FW_EXPECT(data.size() >= 10 * sizeof(Matrix4f));
+        if (data.size() >= 10 * sizeof(Matrix4f)) {
+            const Matrix4f* matrices = reinterpret_cast<const Matrix4f*>(data.data());
+            for (int i = 0; i < 10; i++) {
+                FW_EXPECT(matrices[i] == list[i].modelMatrix.Transposed());
+            }
+        }
+    }
+}
+
+// Each instanced batch starts on a GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT boundary, and runs
+// longer than the shader's matrix array are split.
+static void TestSplitBatches(ovrSurfaceRender& render) {
+    ovrSurfaceDef first;
+    ovrSurfaceDef second;
+    InitSurface(first, InstancedProgram, 5);
+    InitSurface(second, InstancedProgram, 6);
+
+    std::vector<ovrDrawSurface> list;
+    for (int i = 0; i < MAX_INSTANCE_MATRICES + 3; i++) {
+        list.push_back(ovrDrawSurface(Matrix4f::Translation(Vector3f(0, i, 0)), &first));
+    }
+    list.push_back(ovrDrawSurface(Matrix4f::Translation(Vector3f(0, 0, 1)), &second));
+    const ovrDrawCounters counters = Render(render, list);
+
+    const std::vector<const ovrFakeGlCall*> draws = CallsNamed("glDrawElementsInstanced");
+    FW_EXPECT(draws.size() == 3);
+    if (draws.size() == 3) {
+        FW_EXPECT(draws[0]->Args[3] == MAX_INSTANCE_MATRICES);
+        FW_EXPECT(draws[1]->Args[3] == 3);
+        FW_EXPECT(draws[2]->Args[3] == 1);
+    }
+    FW_EXPECT(counters.numMergedSurfaces == MAX_INSTANCE_MATRICES + 1);
+
+    // 256 byte alignment is 4 matrices.
+    const std::vector<const ovrFakeGlCall*> binds = CallsNamed("glBindBufferRange");
+    FW_EXPECT(binds.size() == 3);
+    if (binds.size() == 3) {
+        FW_EXPECT(binds[0]->Args[3] == 0);
+        FW_EXPECT(binds[1]->Args[3] == MAX_INSTANCE_MATRICES * sizeof(Matrix4f));
+        FW_EXPECT(binds[2]->Args[3] == (MAX_INSTANCE_MATRICES + 4) * sizeof(Matrix4f));
+        for (const ovrFakeGlCall* bind : binds) {
+            FW_EXPECT(bind->Args[3] % 256 == 0);
+        }
+    }
+}
+
+// Programs without InstanceMatrices, and surfaces that do their own instancing, keep one
+// draw per surface.
+static void TestUnmergedDraws(ovrSurfaceRender& render) {
+    ovrSurfaceDef plain;
+    ovrSurfaceDef particles;
+    InitSurface(plain, PlainProgram, 5);
+    InitSurface(particles, PlainProgram, 6);
+    particles.numInstances = 7;
+
+    std::vector<ovrDrawSurface> list;
+    for (int i = 0; i < 3; i++) {
+        list.push_back(ovrDrawSurface(Matrix4f::Translation(Vector3f(i, 0, 0)), &plain));
+    }
+    for (int i = 0; i < 2; i++) {
+        list.push_back(ovrDrawSurface(Matrix4f::Translation(Vector3f(i, 0, 0)), &particles));
+    }
+    const ovrDrawCounters counters = Render(render, list);
+
+    FW_EXPECT(FakeGlCount("glDrawElements") == 3);
+    FW_EXPECT(FakeGlCount("glBindBufferRange") == 0);
+    const std::vector<const ovrFakeGlCall*> draws = CallsNamed("glDrawElementsInstanced");
+    FW_EXPECT(draws.size() == 2);
+    for (const ovrFakeGlCall* draw : draws) {
+        FW_EXPECT(draw->Args[3] == 7);
+    }
+    FW_EXPECT(counters.numDrawCalls == 5);
+    FW_EXPECT(counters.numMergedSurfaces == 0);
+}
+
+// A surface that draws several instances with a program that reads InstanceMatrices is not
+// merged, but gets a range of its own in which every instance reads its model matrix.
+static void TestSelfInstancedMatrices(ovrSurfaceRender& render) {
+    ovrSurfaceDef instances;
+    InitSurface(instances, InstancedProgram, 5);
+    instances.numInstances = 7;
+
+    std::vector<ovrDrawSurface> list;
+    for (int i = 0; i < 2; i++) {
+        list.push_back(ovrDrawSurface(Matrix4f::Translation(Vector3f(i, 0, 0)), &instances));
+    }
+    const ovrDrawCounters counters = Render(render, list);
+
+    FW_EXPECT(FakeGlCount("glDrawElements") == 0);
+    FW_EXPECT(FakeGlCount("glUniformMatrix4fv") == 0);
+    const std::vector<const ovrFakeGlCall*> draws = CallsNamed("glDrawElementsInstanced");
+    FW_EXPECT(draws.size() == 2);
+    for (const ovrFakeGlCall* draw : draws) {
+        FW_EXPECT(draw->Args[3] == 7);
+    }
+    FW_EXPECT(counters.numDrawCalls == 2);
+    FW_EXPECT(counters.numMergedSurfaces == 0);
+
+    // 7 matrices round up to 8 with the 256 byte alignment.
+    const std::vector<const ovrFakeGlCall*> binds = CallsNamed("glBindBufferRange");
+    FW_EXPECT(binds.size() == 2);
+    for (int i = 0; i < static_cast<int>(binds.size()); i++) {
+        FW_EXPECT(binds[i]->Args[1] == InstanceBinding);
+        FW_EXPECT(binds[i]->Args[3] == i * 8 * static_cast<int64_t>(sizeof(Matrix4f)));
+
+        const std::vector<uint8_t>& data = FakeGlBufferData(static_cast<GLuint>(binds[i]->Args[2]));
+        FW_EXPECT(data.size() >= (i * 8 + 7) * sizeof(Matrix4f));
+        if (data.size() >= (i * 8 + 7) * sizeof(Matrix4f)) {
+            const Matrix4f* matrices = reinterpret_cast<const Matrix4f*>(data.data()) + i * 8;
+            for (int j = 0; j < 7; j++) {
+                FW_EXPECT(matrices[j] == list[i].modelMatrix.Transposed());
+            }
+        }
+    }
+}
+
+static std::vector<int64_t> CallArgs(const char* name) {
+    std::vector<int64_t> args;
+    for (const ovrFakeGlCall* call : CallsNamed(name)) {
+        args.push_back(call->Args[0]);
+    }
+    return args;
+}
+
+// SURFACE_SORT_STATE orders each run of opaque surfaces by program, then geometry, and keeps
+// blended surfaces in place as barriers. The skip counters report the elided state changes.
+static void TestStateSort(ovrSurfaceRender& render) {
+    const GLuint otherProgram = PlainProgram + 1;
+    ovrSurfaceDef a5;
+    ovrSurfaceDef a6;
+    ovrSurfaceDef b7;
+    ovrSurfaceDef b8;
+    ovrSurfaceDef blended;
+    InitSurface(a5, PlainProgram, 5);
+    InitSurface(a6, PlainProgram, 6);
+    InitSurface(b7, otherProgram, 7);
+    InitSurface(b8, otherProgram, 8);
+    InitSurface(blended, PlainProgram, 5);
+    blended.graphicsCommand.GpuState.blendEnable = ovrGpuState::BLEND_ENABLE;
+
+    const std::vector<ovrDrawSurface> list = {
+        ovrDrawSurface(&b7),
+        ovrDrawSurface(&a5),
+        ovrDrawSurface(&b8),
+        ovrDrawSurface(&blended),
+        ovrDrawSurface(&b7),
+        ovrDrawSurface(&a6)};
+
+    // submission order, every surface changes the program
+    ovrDrawCounters counters = Render(render, list);
+    FW_EXPECT(counters.numProgramBinds == 6);
+    FW_EXPECT(counters.numSkippedProgramBinds == 0);
+
+    render.SetSortMode(SURFACE_SORT_STATE);
+    counters = Render(render, list);
+    render.SetSortMode(SURFACE_SORT_NONE);
+
+    const int64_t a = PlainProgram;
+    const int64_t b = otherProgram;
+    // the last call resets the program
+    FW_EXPECT((CallArgs("glUseProgram") == std::vector<int64_t>{a, b, a, b, 0}));
+    FW_EXPECT((CallArgs("glBindVertexArray") == std::vector<int64_t>{5, 7, 8, 5, 6, 7, 0}));
+    FW_EXPECT(counters.numDrawCalls == 6);
+    FW_EXPECT(counters.numProgramBinds == 4);
+    FW_EXPECT(counters.numSkippedProgramBinds == 2);
+    FW_EXPECT(counters.numVertexArrayBinds == 6);
+    FW_EXPECT(counters.numSkippedVertexArrayBinds == 0);
+    // one identity model matrix, uploaded once per program bind
+    FW_EXPECT(counters.numParameterUpdates == 4);
+    FW_EXPECT(counters.numSkippedParameterUpdates == 2);
+    FW_EXPECT(FakeGlCount("glUniformMatrix4fv") == 4);
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::FakeGlReset();
+    OVRFW::FakeGlSetUniformBufferOffsetAlignment(256);
+
+    OVRFW::ovrSurfaceRender render;
+    render.Init();
+    OVRFW::TestMergedDraws(render);
+    OVRFW::TestSplitBatches(render);
+    OVRFW::TestUnmergedDraws(render);
+    OVRFW::TestSelfInstancedMatrices(render);
+    OVRFW::TestStateSort(render);
+    render.Shutdown();
+
+    return FW_TEST_RESULT();
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   SyntheticGlb.cpp
+Content     :   Builds glB files in memory for the loader tests and benchmarks.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "SyntheticGlb.h"
+
+#include "stb_image_write.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <random>
+#include <string>
+
+namespace OVRFW {
+
+static void AppendPng(void* context, void* data, int size) {
+    std::vector<char>& bin = *static_cast<std::vector<char>*>(context);
+    bin.insert(bin.end(), static_cast<char*>(data), static_cast<char*>(data) + size);
+}
+
+template <typename _type_>
+static void AppendValues(std::vector<char>& bin, const std::vector<_type_>& values) {
+    const char* data = reinterpret_cast<const char*>(values.data());
+    bin.insert(bin.end(), data, data + values.size() * sizeof(_type_));
+    while (bin.size() % 4 != 0) {
+        bin.push_back(0);
+    }
+}
+
+static void AppendChunk(std::vector<char>& glb, const std::vector<char>& data, uint32_t type) {
+    const uint32_t length = static_cast<uint32_t>(data.size());
+    const uint32_t header[2] = {length, type};
+    const char* headerBytes = reinterpret_cast<const char*>(header);
+    glb.insert(glb.end(), headerBytes, headerBytes + sizeof(header));
+    glb.insert(glb.end(), data.begin(), data.end());
+}
+
+std::vector<char> MakeSyntheticGlb(const ovrSyntheticGlbParms& parms) {
+    std::vector<char> bin;
+    std::string bufferViews;
+    std::string accessors;
+    int numBufferViews = 0;
+    const auto addBufferView = [&](const size_t offset) {
+        bufferViews += std::string(numBufferViews > 0 ? "," : "") +
+            "{\"buffer\":0,\"byteOffset\":" + std::to_string(offset) + ",\"byteLength\":" +
+            std::to_string(bin.size() - offset) + "}";
+        return numBufferViews++;
+    };
+
+    std::mt19937 random(1);
+    std::string images;
+    for (int i = 0; i < parms.NumImages; i++) {
+        std::vector<uint8_t> pixels(parms.ImageSize * parms.ImageSize * 4);
+        for (uint8_t& pixel : pixels) {
+            pixel = static_cast<uint8_t>(random());
+        }
+        const size_t offset = bin.size();
+        const int size = parms.ImageSize;
+        stbi_write_png_to_func(AppendPng, &bin, size, size, 4, pixels.data(), size * 4);
+        while (bin.size() % 4 != 0) {
+            bin.push_back(0);
+        }
+        images += std::string(i > 0 ? "," : "") + "{\"bufferView\":" +
+            std::to_string(addBufferView(offset)) + ",\"mimeType\":\"image/png\"}";
+    }
+
+    const int n = parms.GridSize;
+    std::string meshes;
+    std::string nodes;
+    std::string sceneNodes;
+    std::string materials;
+    int numAccessors = 0;
+    for (int m = 0; m < parms.NumMeshes; m++) {
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<float> uvs;
+        for (int y = 0; y < n; y++) {
+            for (int x = 0; x < n; x++) {
+                const float u = static_cast<float>(x) / (n - 1);
+                const float v = static_cast<float>(y) / (n - 1);
+                positions.insert(positions.end(), {u, v, 0.05f * (x & 1)});
+                normals.insert(normals.end(), {0.0f, 0.0f, 1.0f});
+                uvs.insert(uvs.end(), {u, v});
+            }
+        }
+        std::vector<uint16_t> indices;
+        for (int y = 0; y < n - 1; y++) {
+            for (int x = 0; x < n - 1; x++) {
+                const uint16_t i0 = static_cast<uint16_t>(y * n + x);
+                const uint16_t i1 = static_cast<uint16_t>(i0 + n);
+                const uint16_t i2 = static_cast<uint16_t>(i0 + 1);
+                const uint16_t i3 = static_cast<uint16_t>(i1 + 1);
+                indices.insert(indices.end(), {i0, i2, i1});
+                indices.insert(indices.end(), {i2, i3, i1});
+            }
+        }
+
+        size_t offset = bin.size();
+        AppendValues(bin, positions);
+        const int positionView = addBufferView(offset);
+        offset = bin.size();
+        AppendValues(bin, normals);
+        const int normalView = addBufferView(offset);
+        offset = bin.size();
+        AppendValues(bin, uvs);
+        const int uvView = addBufferView(offset);
+        offset = bin.size();
+        AppendValues(bin, indices);
+        const int indexView = addBufferView(offset);
+
+        const std::string count = std::to_string(n * n);
+        accessors += std::string(m > 0 ? "," : "") + "{\"bufferView\":" +
+            std::to_string(positionView) +
+            ",\"componentType\":5126,\"count\":" + count +
+            ",\"type\":\"VEC3\",\"min\":[0,0,0],\"max\":[1,1,0.05]}," + "{\"bufferView\":" +
+            std::to_string(normalView) + ",\"componentType\":5126,\"count\":" + count +
+            ",\"type\":\"VEC3\"}," + "{\"bufferView\":" + std::to_string(uvView) +
+            ",\"componentType\":5126,\"count\":" + count + ",\"type\":\"VEC2\"}," +
+            "{\"bufferView\":" + std::to_string(indexView) +
+            ",\"componentType\":5123,\"count\":" + std::to_string(indices.size()) +
+            ",\"type\":\"SCALAR\"}";
+        const int a = numAccessors;
+        numAccessors += 4;
+
+        const std::string sep = (m > 0) ? "," : "";
+        meshes += sep + "{\"primitives\":[{\"attributes\":{\"POSITION\":" + std::to_string(a) +
+            ",\"NORMAL\":" + std::to_string(a + 1) + ",\"TEXCOORD_0\":" + std::to_string(a + 2) +
+            "},\"indices\":" + std::to_string(a + 3) + ",\"material\":" + std::to_string(m) + "}]}";
+        nodes += sep + "{\"mesh\":" + std::to_string(m) + ",\"translation\":[" +
+            std::to_string(m % 8) + ",0," + std::to_string(-m / 8) + "]}";
+        sceneNodes += sep + std::to_string(m);
+        if (parms.NumImages > 0) {
+            materials += sep + "{\"pbrMetallicRoughness\":{\"baseColorTexture\":{\"index\":" +
+                std::to_string(m % parms.NumImages) + "}}}";
+        } else {
+            materials += sep + "{\"pbrMetallicRoughness\":{}}";
+        }
+    }
+
+    std::string textures;
+    for (int i = 0; i < parms.NumImages; i++) {
+        textures += std::string(i > 0 ? "," : "") + "{\"source\":" + std::to_string(i) + "}";
+    }
+
+    std::string json = "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[" +
+        sceneNodes + "]}],\"nodes\":[" + nodes + "],\"meshes\":[" + meshes +
+        "],\"materials\":[" + materials + "],\"textures\":[" + textures + "],\"images\":[" +
+        images + "],\"accessors\":[" + accessors + "],\"bufferViews\":[" + bufferViews +
+        "],\"buffers\":[{\"byteLength\":" + std::to_string(bin.size()) + "}]}";
+    while (json.size() % 4 != 0) {
+        json += ' ';
+    }
+
+    std::vector<char> glb;
+    const uint32_t header[3] = {
+        0x46546C67, // glTF
+        2,
+        static_cast<uint32_t>(12 + 8 + json.size() + 8 + bin.size())};
+    const char* headerBytes = reinterpret_cast<const char*>(header);
+    glb.insert(glb.end(), headerBytes, headerBytes + sizeof(header));
+    AppendChunk(glb, std::vector<char>(json.begin(), json.end()), 0x4E4F534A);
+    AppendChunk(glb, bin, 0x004E4942);
+    return glb;
+}
+
+} // namespace OVRFW
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   SyntheticGlb.h
+Content     :   Builds glB files in memory for the loader tests and benchmarks.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+namespace OVRFW {
+
+struct ovrSyntheticGlbParms {
+    int NumMeshes = 16;
+    int GridSize = 64; // each mesh is a GridSize x GridSize grid of vertices
+    int NumImages = 4; // PNG images of noise, spread over the mesh materials
+    int ImageSize = 256;
+};
+
+// Every mesh has its own node and material, and positions, normals, uvs and 16 bit indices
+// in one binary chunk.
+std::vector<char> MakeSyntheticGlb(const ovrSyntheticGlbParms& parms);
+
+} // namespace OVRFW
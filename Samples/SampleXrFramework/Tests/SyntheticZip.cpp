@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   SyntheticZip.cpp
+Content     :   Builds zip files in memory for the package tests and benchmarks.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "SyntheticZip.h"
+
+#include <zlib.h>
+
+#include <stdio.h>
+#include <filesystem>
+
+namespace OVRFW {
+
+static void AppendU16(std::vector<uint8_t>& zip, const uint32_t value) {
+    zip.push_back(static_cast<uint8_t>(value));
+    zip.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+static void AppendU32(std::vector<uint8_t>& zip, const uint32_t value) {
+    AppendU16(zip, value & 0xffff);
+    AppendU16(zip, value >> 16);
+}
+
+static std::vector<uint8_t> Deflate(const std::vector<uint8_t>& data) {
+    z_stream stream = {};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    std::vector<uint8_t> compressed(deflateBound(&stream, static_cast<uLong>(data.size())));
+    stream.next_in = const_cast<Bytef*>(data.data());
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = compressed.data();
+    stream.avail_out = static_cast<uInt>(compressed.size());
+    deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+    return compressed;
+}
+
+std::vector<uint8_t> MakeSyntheticZip(
+    const std::vector<ovrSyntheticZipEntry>& entries,
+    const std::string& comment) {
+    std::vector<uint8_t> zip;
+    std::vector<uint8_t> centralDir;
+    for (const ovrSyntheticZipEntry& entry : entries) {
+        const std::vector<uint8_t> data = entry.Deflate ? Deflate(entry.Data) : entry.Data;
+        const uint32_t crc = static_cast<uint32_t>(
+            crc32(0, entry.Data.data(), static_cast<uInt>(entry.Data.size())));
+        const uint32_t flags = entry.Encrypt ? 1 : 0;
+        const uint32_t method = entry.Deflate ? Z_DEFLATED : 0;
+        const uint32_t localHeaderOffset = static_cast<uint32_t>(zip.size());
+
+        AppendU32(zip, 0x04034b50);
+        AppendU16(zip, 20); // version needed to extract
+        AppendU16(zip, flags);
+        AppendU16(zip, method);
+        AppendU32(zip, 0); // time and date
+        AppendU32(zip, crc);
+        AppendU32(zip, static_cast<uint32_t>(data.size()));
+        AppendU32(zip, static_cast<uint32_t>(entry.Data.size()));
+        AppendU16(zip, static_cast<uint32_t>(entry.Name.size()));
+        AppendU16(zip, 0); // extra field length
+        zip.insert(zip.end(), entry.Name.begin(), entry.Name.end());
+        zip.insert(zip.end(), data.begin(), data.end());
+
+        AppendU32(centralDir, 0x02014b50);
+        AppendU16(centralDir, 20); // version made by
+        AppendU16(centralDir, 20); // version needed to extract
+        AppendU16(centralDir, flags);
+        AppendU16(centralDir, method);
+        AppendU32(centralDir, 0); // time and date
+        AppendU32(centralDir, crc);
+        AppendU32(centralDir, static_cast<uint32_t>(data.size()));
+        AppendU32(centralDir, static_cast<uint32_t>(entry.Data.size()));
+        AppendU16(centralDir, static_cast<uint32_t>(entry.Name.size()));
+        AppendU16(centralDir, 0); // extra field length
+        AppendU16(centralDir, 0); // comment length
+        AppendU16(centralDir, 0); // disk number
+        AppendU16(centralDir, 0); // internal attributes
+        AppendU32(centralDir, 0); // external attributes
+        AppendU32(centralDir, localHeaderOffset);
+        centralDir.insert(centralDir.end(), entry.Name.begin(), entry.Name.end());
+    }
+
+    const uint32_t centralDirOffset = static_cast<uint32_t>(zip.size());
+    zip.insert(zip.end(), centralDir.begin(), centralDir.end());
+    AppendU32(zip, 0x06054b50);
+    AppendU16(zip, 0); // this disk
+    AppendU16(zip, 0); // disk with the central directory
+    AppendU16(zip, static_cast<uint32_t>(entries.size()));
+    AppendU16(zip, static_cast<uint32_t>(entries.size()));
+    AppendU32(zip, static_cast<uint32_t>(centralDir.size()));
+    AppendU32(zip, centralDirOffset);
+    AppendU16(zip, static_cast<uint32_t>(comment.size()));
+    zip.insert(zip.end(), comment.begin(), comment.end());
+    return zip;
+}
+
+std::string WriteTempFile(const char* name, const std::vector<uint8_t>& data) {
+    std::error_code error;
+    const std::filesystem::path dir = std::filesystem::temp_directory_path(error);
+    if (error) {
+        return std::string();
+    }
+    const std::string path = (dir / name).string();
+    FILE* f = fopen(path.c_str(), "wb");
+    if (f == nullptr) {
+        return std::string();
+    }
+    const bool written = fwrite(data.data(), 1, data.size(), f) == data.size();
+    if (fclose(f) != 0 || !written) {
+        return std::string();
+    }
+    return path;
+}
+
+} // namespace OVRFW
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   SyntheticZip.h
+Content     :   Builds zip files in memory for the package tests and benchmarks.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace OVRFW {
+
+struct ovrSyntheticZipEntry {
+    std::string Name;
+    std::vector<uint8_t> Data;
+    bool Deflate = false; // raw deflate, otherwise stored
+    bool Encrypt = false; // only sets the encrypted flag, the data is not encrypted
+};
+
+// The entries are written in order with local headers, followed by the central directory and
+// the end of central directory record with the given comment.
+std::vector<uint8_t> MakeSyntheticZip(
+    const std::vector<ovrSyntheticZipEntry>& entries,
+    const std::string& comment = std::string());
+
+// Writes data to a new file in the temp directory and returns its path, or an empty string.
+std::string WriteTempFile(const char* name, const std::vector<uint8_t>& data);
+
+} // namespace OVRFW
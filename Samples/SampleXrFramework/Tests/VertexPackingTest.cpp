@@ -0,0 +1,395 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   VertexPackingTest.cpp
+Content     :   Round trip precision of the quantized GlGeometry vertex formats.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "Render/GlGeometry.h"
+#include "Render/GlProgram.h"
+
+#include "FakeGl.h"
+#include "FrameworkTest.h"
+
+#include <math.h>
+#include <string.h>
+#include <random>
+
+using OVR::Vector2f;
+using OVR::Vector3f;
+using OVR::Vector4f;
+using OVR::Vector4i;
+
+namespace OVRFW {
+
+static float HalfToFloat(const uint16_t h) {
+    const uint32_t sign = (h & 0x8000u) << 16;
+    const uint32_t exponent = (h >> 10) & 0x1F;
+    const uint32_t mantissa = h & 0x3FF;
+    uint32_t bits;
+    if (exponent == 0) {
+        // zero or denormal
+        const float f = ldexpf(static_cast<float>(mantissa), -24);
+        return sign ? -f : f;
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// What the GPU sees for a normalized snorm16 component.
+static float Snorm16ToFloat(const int16_t v) {
+    return std::max(static_cast<float>(v) / 32767.0f, -1.0f);
+}
+
+// C++ version of OctahedralDecodeShaderSrc.
+static Vector3f OctahedralDecode(const float ex, const float ey) {
+    Vector3f v(ex, ey, 1.0f - fabsf(ex) - fabsf(ey));
+    if (v.z < 0.0f) {
+        const float x = (1.0f - fabsf(v.y)) * (v.x >= 0.0f ? 1.0f : -1.0f);
+        const float y = (1.0f - fabsf(v.x)) * (v.y >= 0.0f ? 1.0f : -1.0f);
+        v.x = x;
+        v.y = y;
+    }
+    return v.Normalized();
+}
+
+static float AngleBetween(const Vector3f& a, const Vector3f& b) {
+    return atan2f(a.Cross(b).Length(), a.Dot(b));
+}
+
+// Every finite half survives a round trip through float, and other floats round to the
+// nearest half, ties to even.
+static void TestFloatToHalf() {
+    for (uint32_t h = 0; h < 0x10000; h++) {
+        if (((h >> 10) & 0x1F) == 0x1F) {
+            continue;
+        }
+        const uint16_t result = FloatToHalf(HalfToFloat(static_cast<uint16_t>(h)));
+        if (result != h) {
+            printf("half 0x%04x round trips to 0x%04x\n", h, result);
+            FW_EXPECT(result == h);
+            break;
+        }
+    }
+
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> mantissa(1.0f, 2.0f);
+    std::uniform_int_distribution<int> exponent(-14, 15);
+    float maxRelativeError = 0.0f;
+    for (int i = 0; i < 100000; i++) {
+        const float f = ldexpf(mantissa(rng), exponent(rng)) * ((i & 1) ? -1.0f : 1.0f);
+        if (fabsf(f) >= 65504.0f) {
+            continue;
+        }
+        const float r = HalfToFloat(FloatToHalf(f));
+        maxRelativeError = std::max(maxRelativeError, fabsf(r - f) / fabsf(f));
+    }
+    // half of the 10 bit mantissa step
+    FW_EXPECT(maxRelativeError <= ldexpf(1.0f, -11));
+
+    // ties go to the even mantissa
+    FW_EXPECT(FloatToHalf(1.0f + ldexpf(1.0f, -11)) == 0x3C00);
+    FW_EXPECT(FloatToHalf(1.0f + 3.0f * ldexpf(1.0f, -11)) == 0x3C02);
+    FW_EXPECT(FloatToHalf(ldexpf(1.0f, -25)) == 0x0000);
+    FW_EXPECT(FloatToHalf(3.0f * ldexpf(1.0f, -25)) == 0x0002);
+    FW_EXPECT(FloatToHalf(ldexpf(1.0f, -24)) == 0x0001);
+    FW_EXPECT(FloatToHalf(-0.0f) == 0x8000);
+
+    // overflow and special values
+    FW_EXPECT(FloatToHalf(65504.0f) == 0x7BFF);
+    FW_EXPECT(FloatToHalf(65519.0f) == 0x7BFF);
+    FW_EXPECT(FloatToHalf(65520.0f) == 0x7C00);
+    FW_EXPECT(FloatToHalf(-1e10f) == 0xFC00);
+    FW_EXPECT(FloatToHalf(INFINITY) == 0x7C00);
+    const uint16_t nan = FloatToHalf(NAN);
+    FW_EXPECT((nan & 0x7C00) == 0x7C00 && (nan & 0x3FF) != 0);
+}
+
+static void EncodeOctahedralSnorm16(const Vector3f& v, int16_t* e) {
+    float encoded[2];
+    OctahedralEncode(&v.x, encoded);
+    for (int i = 0; i < 2; i++) {
+        e[i] = static_cast<int16_t>(roundf(OVR::OVRMath_Clamp(encoded[i], -1.0f, 1.0f) * 32767.0f));
+    }
+}
+
+static Vector3f DecodeOctahedralSnorm16(const int16_t* e) {
+    return OctahedralDecode(Snorm16ToFloat(e[0]), Snorm16ToFloat(e[1]));
+}
+
+// Unit vectors quantized to two snorm16 values come back within a small angle.
+static void TestOctahedral() {
+    // A 16 bit grid over the octahedron is about 4.3e-5 radians at its coarsest.
+    const float maxAngle = 1e-4f;
+
+    std::mt19937 rng(6789);
+    std::normal_distribution<float> normal;
+    float worstAngle = 0.0f;
+    for (int i = 0; i < 100000; i++) {
+        const Vector3f v = Vector3f(normal(rng), normal(rng), normal(rng)).Normalized();
+        int16_t e[2];
+        EncodeOctahedralSnorm16(v, e);
+        worstAngle = std::max(worstAngle, AngleBetween(v, DecodeOctahedralSnorm16(e)));
+    }
+    FW_EXPECT(worstAngle < maxAngle);
+
+    // the axes, and the fold at z = 0, are exact
+    const Vector3f exact[] = {
+        Vector3f(1, 0, 0),
+        Vector3f(-1, 0, 0),
+        Vector3f(0, 1, 0),
+        Vector3f(0, -1, 0),
+        Vector3f(0, 0, 1),
+        Vector3f(0, 0, -1),
+    };
+    for (const Vector3f& v : exact) {
+        int16_t e[2];
+        EncodeOctahedralSnorm16(v, e);
+        FW_EXPECT(DecodeOctahedralSnorm16(e) == v);
+    }
+    const Vector3f folds[] = {
+        Vector3f(1, 1, 0).Normalized(),
+        Vector3f(-1, 1, 0).Normalized(),
+        Vector3f(1, -1, -1e-6f).Normalized(),
+        Vector3f(-1, -1, -1e-6f).Normalized(),
+    };
+    for (const Vector3f& v : folds) {
+        int16_t e[2];
+        EncodeOctahedralSnorm16(v, e);
+        FW_EXPECT(AngleBetween(v, DecodeOctahedralSnorm16(e)) < maxAngle);
+    }
+
+    float zero[2] = {1.0f, 1.0f};
+    const Vector3f nullVector(0.0f, 0.0f, 0.0f);
+    OctahedralEncode(&nullVector.x, zero);
+    FW_EXPECT(zero[0] == 0.0f && zero[1] == 0.0f);
+}
+
+// Reads a component as the GPU would, from the attribute pointer recorded for its location.
+static float ReadComponent(const ovrFakeGlCall& pointer, const uint8_t* vertex, const int c) {
+    const GLenum type = static_cast<GLenum>(pointer.Args[2]);
+    const bool normalized = pointer.Args[3] != 0;
+    switch (type) {
+        case GL_FLOAT: {
+            float v;
+            memcpy(&v, vertex + c * 4, 4);
+            return v;
+        }
+        case GL_HALF_FLOAT: {
+            uint16_t v;
+            memcpy(&v, vertex + c * 2, 2);
+            return HalfToFloat(v);
+        }
+        case GL_SHORT: {
+            int16_t v;
+            memcpy(&v, vertex + c * 2, 2);
+            return normalized ? Snorm16ToFloat(v) : v;
+        }
+        case GL_UNSIGNED_SHORT: {
+            uint16_t v;
+            memcpy(&v, vertex + c * 2, 2);
+            return normalized ? v / 65535.0f : v;
+        }
+        case GL_UNSIGNED_BYTE:
+            return normalized ? vertex[c] / 255.0f : vertex[c];
+        case GL_INT: {
+            int32_t v;
+            memcpy(&v, vertex + c * 4, 4);
+            return static_cast<float>(v);
+        }
+    }
+    FW_EXPECT(false);
+    return 0.0f;
+}
+
+struct ovrPackedAttribute {
+    const ovrFakeGlCall* Pointer = nullptr;
+    const uint8_t* Data = nullptr;
+
+    Vector4f Read(const int vertex, const int numComponents) const {
+        float v[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        const int stride = static_cast<int>(Pointer->Args[4]);
+        const uint8_t* element = Data + Pointer->Args[5] + vertex * stride;
+        for (int c = 0; c < numComponents; c++) {
+            v[c] = ReadComponent(*Pointer, element, c);
+        }
+        return Vector4f(v[0], v[1], v[2], v[3]);
+    }
+};
+
+static ovrPackedAttribute FindAttribute(const GlGeometry& geo, const int location) {
+    ovrPackedAttribute attribute;
+    for (const ovrFakeGlCall& call : FakeGlCalls()) {
+        if (strcmp(call.Name, "glVertexAttribPointer") == 0 && call.Args[0] == location) {
+            attribute.Pointer = &call;
+        }
+    }
+    attribute.Data = FakeGlBufferData(geo.vertexBuffer).data();
+    return attribute;
+}
+
+static VertexAttribs MakeSkinnedAttribs(const int numVertices) {
+    std::mt19937 rng(4242);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::normal_distribution<float> normal;
+    std::uniform_int_distribution<int> joint(0, 63);
+
+    VertexAttribs attribs;
+    for (int i = 0; i < numVertices; i++) {
+        attribs.position.push_back(Vector3f(unit(rng), unit(rng), unit(rng)) * 10.0f);
+        attribs.normal.push_back(Vector3f(normal(rng), normal(rng), normal(rng)).Normalized());
+        attribs.tangent.push_back(Vector3f(normal(rng), normal(rng), normal(rng)).Normalized());
+        attribs.color.push_back(Vector4f(unit(rng), unit(rng), unit(rng), unit(rng)));
+        attribs.uv0.push_back(Vector2f(unit(rng), unit(rng)) * 4.0f);
+        attribs.jointIndices.push_back(Vector4i(joint(rng), joint(rng), joint(rng), joint(rng)));
+        Vector4f weights(unit(rng), unit(rng), unit(rng), unit(rng));
+        weights /= weights.x + weights.y + weights.z + weights.w;
+        attribs.jointWeights.push_back(weights);
+    }
+    return attribs;
+}
+
+static float MaxDifference(const Vector4f& a, const Vector4f& b) {
+    return std::max(
+        std::max(fabsf(a.x - b.x), fabsf(a.y - b.y)), std::max(fabsf(a.z - b.z), fabsf(a.w - b.w)));
+}
+
+// Create() packs every attribute within the precision of its format, with the compact
+// interleaved layout and with octahedral normals in separate blocks.
+static void TestPackVertices(const VertexLayout& layout) {
+    const int numVertices = 500;
+    const VertexAttribs attribs = MakeSkinnedAttribs(numVertices);
+    std::vector<TriangleIndex> indices(numVertices);
+    for (int i = 0; i < numVertices; i++) {
+        indices[i] = static_cast<TriangleIndex>(i);
+    }
+
+    FakeGlReset();
+    GlGeometry geo;
+    geo.Create(attribs, indices, layout);
+    FW_EXPECT(geo.vertexBufferSize == numVertices * layout.GetVertexSize(geo.vertexAttributeMask));
+    FW_EXPECT(
+        static_cast<int>(FakeGlBufferData(geo.vertexBuffer).size()) == geo.vertexBufferSize);
+
+    const ovrPackedAttribute position = FindAttribute(geo, VERTEX_ATTRIBUTE_LOCATION_POSITION);
+    const ovrPackedAttribute normal = FindAttribute(geo, VERTEX_ATTRIBUTE_LOCATION_NORMAL);
+    const ovrPackedAttribute tangent = FindAttribute(geo, VERTEX_ATTRIBUTE_LOCATION_TANGENT);
+    const ovrPackedAttribute color = FindAttribute(geo, VERTEX_ATTRIBUTE_LOCATION_COLOR);
+    const ovrPackedAttribute uv0 = FindAttribute(geo, VERTEX_ATTRIBUTE_LOCATION_UV0);
+    const ovrPackedAttribute joints = FindAttribute(geo, VERTEX_ATTRIBUTE_LOCATION_JOINT_INDICES);
+    const ovrPackedAttribute weights = FindAttribute(geo, VERTEX_ATTRIBUTE_LOCATION_JOINT_WEIGHTS);
+    FW_EXPECT(position.Pointer && normal.Pointer && tangent.Pointer && color.Pointer);
+    FW_EXPECT(uv0.Pointer && joints.Pointer && weights.Pointer);
+    if (!(position.Pointer && normal.Pointer && tangent.Pointer && color.Pointer &&
+          uv0.Pointer && joints.Pointer && weights.Pointer)) {
+        return;
+    }
+
+    const bool octahedral = layout.normal == VERTEX_FORMAT_OCTAHEDRAL_SNORM16;
+    float positionError = 0.0f;
+    float normalAngle = 0.0f;
+    float tangentAngle = 0.0f;
+    float colorError = 0.0f;
+    float uvRelativeError = 0.0f;
+    float weightError = 0.0f;
+    int jointMismatches = 0;
+    for (int i = 0; i < numVertices; i++) {
+        const Vector4f p = position.Read(i, 3);
+        positionError = std::max(
+            positionError, MaxDifference(p, Vector4f(attribs.position[i], 0.0f)));
+
+        Vector3f n;
+        if (octahedral) {
+            const Vector4f e = normal.Read(i, 2);
+            n = OctahedralDecode(e.x, e.y);
+        } else {
+            const Vector4f e = normal.Read(i, 3);
+            n = Vector3f(e.x, e.y, e.z).Normalized();
+        }
+        normalAngle = std::max(normalAngle, AngleBetween(n, attribs.normal[i]));
+        const Vector4f t = tangent.Read(i, 3);
+        tangentAngle = std::max(
+            tangentAngle, AngleBetween(Vector3f(t.x, t.y, t.z).Normalized(), attribs.tangent[i]));
+
+        colorError = std::max(colorError, MaxDifference(color.Read(i, 4), attribs.color[i]));
+        const Vector4f uv = uv0.Read(i, 2);
+        for (int c = 0; c < 2; c++) {
+            const float expected = (c == 0) ? attribs.uv0[i].x : attribs.uv0[i].y;
+            const float actual = (c == 0) ? uv.x : uv.y;
+            if (expected != 0.0f) {
+                uvRelativeError = std::max(uvRelativeError, fabsf(actual - expected) / expected);
+            }
+        }
+        const Vector4f j = joints.Read(i, 4);
+        jointMismatches += (j.x != attribs.jointIndices[i].x || j.y != attribs.jointIndices[i].y ||
+                            j.z != attribs.jointIndices[i].z || j.w != attribs.jointIndices[i].w)
+            ? 1
+            : 0;
+        weightError =
+            std::max(weightError, MaxDifference(weights.Read(i, 4), attribs.jointWeights[i]));
+    }
+
+    FW_EXPECT(positionError == 0.0f);
+    // snorm16 moves each component up to half a step, 1.5e-5, which tilts a unit vector by
+    // at most about 2.6e-5 radians.
+    FW_EXPECT(normalAngle < 1e-4f);
+    FW_EXPECT(tangentAngle < 1e-4f);
+    FW_EXPECT(colorError <= 0.5f / 255.0f + 1e-6f);
+    FW_EXPECT(uvRelativeError <= ldexpf(1.0f, -11));
+    FW_EXPECT(jointMismatches == 0);
+    FW_EXPECT(weightError <= 0.5f / 65535.0f + 1e-6f);
+
+    geo.Free();
+}
+
+// The compact layout is about half the size of the default one for a skinned vertex.
+static void TestCompactSize() {
+    const uint32_t skinnedMask = (1u << 0) | (1u << 1) | (1u << 2) | (1u << 4) | (1u << 5) |
+        (1u << 7) | (1u << 8);
+    const int defaultSize = VertexLayout().GetVertexSize(skinnedMask);
+    const int compactSize = VertexLayout::Compact().GetVertexSize(skinnedMask);
+    FW_EXPECT(defaultSize == 12 + 12 + 12 + 16 + 8 + 16 + 16);
+    FW_EXPECT(compactSize == 12 + 8 + 8 + 4 + 4 + 4 + 8);
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::TestFloatToHalf();
+    OVRFW::TestOctahedral();
+
+    OVRFW::TestPackVertices(OVRFW::VertexLayout());
+    OVRFW::TestPackVertices(OVRFW::VertexLayout::Compact());
+    OVRFW::VertexLayout octahedral = OVRFW::VertexLayout::Compact();
+    octahedral.normal = OVRFW::VERTEX_FORMAT_OCTAHEDRAL_SNORM16;
+    octahedral.interleaved = false;
+    OVRFW::TestPackVertices(octahedral);
+
+    OVRFW::TestCompactSize();
+    return FW_TEST_RESULT();
+}
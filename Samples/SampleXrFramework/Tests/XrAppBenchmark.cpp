@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   XrAppBenchmark.cpp
+Content     :   Wall time of XrApp::MainLoop frames against the stub OpenXR runtime.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+// The app renders a glB of 16 or 256 meshes of 32x32 vertices, laid out in rows of 8 going
+// away from the head, while the head turns and bobs and the hands circle in front of it, with
+// and without PipelinedFrames. xrWaitFrame of the stub returns at once and GL calls only
+// record into FakeGl, so the times are the CPU cost of the frame loop: input, scene update,
+// surface culling and sorting, and the GL command stream. The frame timing summary is logged
+// by XrApp at the end of each run. Not run by ctest; run XrAppBenchmark directly.
+
+#include "XrApp.h"
+#include "Model/ModelFileLoading.h"
+
+#include "FakeGl.h"
+#include "FakeXr.h"
+#include "SyntheticGlb.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <memory>
+
+namespace OVRFW {
+
+static float Seconds(const XrTime time) {
+    return static_cast<float>(time % 60000000000LL) * 1e-9f;
+}
+
+static XrPosef YawPose(const float yaw, const XrVector3f position) {
+    XrPosef pose;
+    pose.orientation = {0.0f, sinf(yaw * 0.5f), 0.0f, cosf(yaw * 0.5f)};
+    pose.position = position;
+    return pose;
+}
+
+static XrPosef HeadPose(const XrTime time) {
+    const float t = Seconds(time);
+    return YawPose(sinf(t * 0.5f) * 0.6f, {3.5f, 1.6f + 0.02f * sinf(t * 4.0f), 2.0f});
+}
+
+static XrPosef HandPose(const XrTime time, const float side) {
+    const float t = Seconds(time);
+    return YawPose(
+        0.0f, {3.5f + side * 0.2f + 0.1f * cosf(t * 2.0f), 1.2f + 0.1f * sinf(t * 2.0f), 1.6f});
+}
+
+class ovrBenchmarkApp : public XrApp {
+   public:
+    ovrBenchmarkApp(const std::vector<char>& glb, const bool pipelined, const int frames)
+        : Glb(glb), Pipelined(pipelined), Frames(frames) {}
+
+    double GetMillisecondsPerFrame() const {
+        return std::chrono::duration<double, std::milli>(LastFrameEnd - FirstFrameStart)
+                   .count() /
+            Frames;
+    }
+
+   protected:
+    void GetInitialSceneUri(std::string& sceneUri) const override {
+        sceneUri = "";
+    }
+
+    bool AppInit(const xrJava*) override {
+        PipelinedFrames = Pipelined;
+        BenchmarkFrames = Frames;
+        MaterialParms materialParms;
+        materialParms.UseSrgbTextureFormats = false;
+        Model.reset(LoadModelFile_glB(
+            "synthetic.glb",
+            Glb.data(),
+            static_cast<int>(Glb.size()),
+            Scene.GetDefaultGLPrograms(),
+            materialParms));
+        if (Model == nullptr) {
+            return false;
+        }
+        Scene.SetWorldModel(*Model);
+        return true;
+    }
+
+    void AppShutdown(const xrJava* context) override {
+        XrApp::AppShutdown(context);
+        Model.reset();
+    }
+
+    void PreWaitFrame(XrFrameWaitInfo&) override {
+        if (FirstFrameStart == std::chrono::steady_clock::time_point()) {
+            FirstFrameStart = std::chrono::steady_clock::now();
+        }
+    }
+
+    void SessionEnd() override {
+        LastFrameEnd = std::chrono::steady_clock::now();
+    }
+
+   private:
+    const std::vector<char>& Glb;
+    const bool Pipelined;
+    const int Frames;
+    std::unique_ptr<ModelFile> Model;
+    std::chrono::steady_clock::time_point FirstFrameStart;
+    std::chrono::steady_clock::time_point LastFrameEnd;
+};
+
+static void RunFrames(const std::vector<char>& glb, const int numMeshes, const bool pipelined) {
+    const int frames = 600;
+    FakeXrReset();
+    FakeGlReset();
+    FakeXrSetPoseScript("/user/head", HeadPose);
+    FakeXrSetPoseScript("/user/hand/left", [](XrTime time) { return HandPose(time, -1.0f); });
+    FakeXrSetPoseScript("/user/hand/right", [](XrTime time) { return HandPose(time, 1.0f); });
+
+    ovrBenchmarkApp app(glb, pipelined, frames);
+    xrJava context = {};
+    HeadlessMainLoopContext loopContext(context, &app);
+    app.MainLoop(loopContext);
+
+    printf(
+        "%4d meshes, pipelined %-3s: %8.3f ms/frame, %5.1f draws/frame, %d frames ended\n",
+        numMeshes,
+        pipelined ? "on" : "off",
+        app.GetMillisecondsPerFrame(),
+        static_cast<double>(
+            FakeGlCount("glDrawElements") + FakeGlCount("glDrawElementsInstanced")) /
+            frames,
+        FakeXrEndedFrames());
+}
+
+} // namespace OVRFW
+
+int main() {
+    for (const int numMeshes : {16, 256}) {
+        OVRFW::ovrSyntheticGlbParms parms;
+        parms.NumMeshes = numMeshes;
+        parms.GridSize = 32;
+        parms.NumImages = 4;
+        parms.ImageSize = 64;
+        const std::vector<char> glb = OVRFW::MakeSyntheticGlb(parms);
+        OVRFW::RunFrames(glb, numMeshes, false);
+        OVRFW::RunFrames(glb, numMeshes, true);
+    }
+    return 0;
+}
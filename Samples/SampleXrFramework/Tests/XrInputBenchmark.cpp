@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   XrInputBenchmark.cpp
+Content     :   OpenXR runtime calls per frame of the XrApp input reads.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+// Runs the per-frame input reads of XrApp against FakeXr, which counts the calls that would
+// cross into the runtime. The times cover the framework side and the fake only. Not run by
+// ctest; run XrInputBenchmark directly.
+
+#include "Input/XrInput.h"
+
+#include "FakeXr.h"
+
+#include <stdio.h>
+#include <chrono>
+
+namespace OVRFW {
+
+static const char* const FUNCTIONS[] = {
+    "xrSyncActions",
+    "xrLocateSpace",
+    "xrGetActionStateFloat",
+    "xrGetActionStateVector2f",
+    "xrGetActionStateBoolean",
+    "xrGetCurrentInteractionProfile",
+    "xrPathToString"};
+
+static ovrXrInputHandles MakeHandles() {
+    ovrXrInputHandles handles;
+    handles.Session = FakeXrHandle<XrSession>(1);
+    handles.HandPath[0] = 1001;
+    handles.HandPath[1] = 1002;
+    return handles;
+}
+
+// Prints the calls recorded since the last reset, averaged over count.
+static void PrintCalls(const char* name, const int count) {
+    printf("%-28s %5.1f calls:", name, static_cast<double>(FakeXrCalls().size()) / count);
+    for (const char* function : FUNCTIONS) {
+        const int calls = FakeXrCount(function);
+        if (calls > 0) {
+            printf(" %s %g", function, static_cast<double>(calls) / count);
+        }
+    }
+    printf("\n");
+}
+
+static void BenchmarkFrames(const char* name, const bool left, const bool right) {
+    const int frames = 100000;
+    const ovrXrInputHandles handles = MakeHandles();
+    const bool handBound[] = {left, right};
+    ovrXrInputSnapshot snapshot;
+
+    FakeXrReset();
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        ReadXrInputSnapshot(handles, i, handBound, snapshot);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    PrintCalls(name, frames);
+    printf(
+        "%-28s %5.2f us per frame\n",
+        "",
+        std::chrono::duration<double, std::micro>(end - start).count() / frames);
+}
+
+} // namespace OVRFW
+
+int main() {
+    printf("ReadXrInputSnapshot, once per frame\n");
+    OVRFW::BenchmarkFrames("both hands bound", true, true);
+    OVRFW::BenchmarkFrames("one hand bound", false, true);
+    OVRFW::BenchmarkFrames("no interaction profile", false, false);
+
+    // only when the session gains focus or the runtime reports a profile change
+    printf("QueryXrInteractionProfiles, once per profile change\n");
+    OVRFW::FakeXrReset();
+    const OVRFW::ovrXrInputHandles handles = OVRFW::MakeHandles();
+    OVRFW::FakeXrSetInteractionProfile(handles.HandPath[0], 2001);
+    OVRFW::FakeXrSetInteractionProfile(handles.HandPath[1], 2001);
+    XrPath profiles[2] = {XR_NULL_PATH, XR_NULL_PATH};
+    OVRFW::QueryXrInteractionProfiles(handles, profiles);
+    OVRFW::PrintCalls("both hands with a profile", 1);
+    return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ * All rights reserved.
+ *
+ * Licensed under the Oculus SDK License Agreement (the "License");
+ * you may not use the Oculus SDK except in compliance with the License,
+ * which is provided at the time of installation or download, or which
+ * otherwise accompanies this software in either electronic or hard copy form.
+ *
+ * You may obtain a copy of the License at
+ * https://developer.oculus.com/licenses/oculussdk/
+ *
+ * Unless required by applicable law or agreed to in writing, the Oculus SDK
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/************************************************************************************
+
+Filename    :   XrInputTest.cpp
+Content     :   Runtime calls and results of the per-frame input reads of XrApp.
+Created     :
+Authors     :
+
+*************************************************************************************/
+
+#include "Input/XrInput.h"
+
+#include "FakeXr.h"
+#include "FrameworkTest.h"
+
+namespace OVRFW {
+
+static const XrPath LEFT_HAND_PATH = 1001;
+static const XrPath RIGHT_HAND_PATH = 1002;
+static const XrPath TOUCH_PROFILE = 2001;
+
+static ovrXrInputHandles MakeHandles() {
+    ovrXrInputHandles handles;
+    handles.Instance = FakeXrHandle<XrInstance>(1);
+    handles.Session = FakeXrHandle<XrSession>(2);
+    handles.ActionSet = FakeXrHandle<XrActionSet>(3);
+    handles.BaseSpace = FakeXrHandle<XrSpace>(10);
+    handles.HeadSpace = FakeXrHandle<XrSpace>(11);
+    handles.HandPath[0] = LEFT_HAND_PATH;
+    handles.HandPath[1] = RIGHT_HAND_PATH;
+    handles.AimSpace[0] = FakeXrHandle<XrSpace>(12);
+    handles.AimSpace[1] = FakeXrHandle<XrSpace>(13);
+    handles.GripSpace[0] = FakeXrHandle<XrSpace>(14);
+    handles.GripSpace[1] = FakeXrHandle<XrSpace>(15);
+    XrAction* actions[] = {
+        &handles.IndexTrigger,
+        &handles.GripTrigger,
+        &handles.Joystick,
+        &handles.ThumbstickClick,
+        &handles.ButtonA,
+        &handles.ButtonB,
+        &handles.ButtonX,
+        &handles.ButtonY,
+        &handles.ButtonMenu,
+        &handles.ThumbstickTouch,
+        &handles.ThumbRestTouch,
+        &handles.TriggerTouch};
+    for (int i = 0; i < static_cast<int>(sizeof(actions) / sizeof(actions[0])); i++) {
+        *actions[i] = FakeXrHandle<XrAction>(100 + i);
+    }
+    return handles;
+}
+
+static int NumRuntimeCalls(const ovrXrInputHandles& handles, const bool handBound[2]) {
+    FakeXrClearCalls();
+    ovrXrInputSnapshot snapshot;
+    ReadXrInputSnapshot(handles, 0, handBound, snapshot);
+    FW_EXPECT(FakeXrCount("xrSyncActions") == 1);
+    return static_cast<int>(FakeXrCalls().size());
+}
+
+// The per-frame budget with two controllers: the action sync, the head, two spaces and four
+// actions per hand and eight shared buttons and touches. No pose action is queried.
+static void TestCallsPerFrame() {
+    FakeXrReset();
+    const ovrXrInputHandles handles = MakeHandles();
+
+    const bool bothHands[] = {true, true};
+    FW_EXPECT(NumRuntimeCalls(handles, bothHands) == 22);
+    FW_EXPECT(FakeXrCount("xrLocateSpace") == 5);
+    FW_EXPECT(FakeXrCount("xrGetActionStateFloat") == 4);
+    FW_EXPECT(FakeXrCount("xrGetActionStateVector2f") == 2);
+    FW_EXPECT(FakeXrCount("xrGetActionStateBoolean") == 10);
+    FW_EXPECT(FakeXrCount("xrGetCurrentInteractionProfile") == 0);
+    FW_EXPECT(FakeXrCount("xrPathToString") == 0);
+
+    const bool rightHand[] = {false, true};
+    FW_EXPECT(NumRuntimeCalls(handles, rightHand) == 16);
+
+    const bool noHand[] = {false, false};
+    FW_EXPECT(NumRuntimeCalls(handles, noHand) == 2);
+    FW_EXPECT(FakeXrCount("xrLocateSpace") == 1);
+}
+
+static void TestSnapshot() {
+    FakeXrReset();
+    const ovrXrInputHandles handles = MakeHandles();
+    FakeXrSetActionState(handles.IndexTrigger, LEFT_HAND_PATH, 0.25f);
+    FakeXrSetActionState(handles.IndexTrigger, RIGHT_HAND_PATH, 0.75f);
+    FakeXrSetActionState(handles.GripTrigger, RIGHT_HAND_PATH, 0.5f);
+    FakeXrSetActionState(handles.Joystick, LEFT_HAND_PATH, 0.125f);
+    FakeXrSetActionState(handles.ThumbstickClick, RIGHT_HAND_PATH, 1.0f);
+    FakeXrSetActionState(handles.ButtonB, XR_NULL_PATH, 1.0f);
+    FakeXrSetActionState(handles.TriggerTouch, XR_NULL_PATH, 1.0f);
+
+    const bool bothHands[] = {true, true};
+    ovrXrInputSnapshot snapshot;
+    ReadXrInputSnapshot(handles, 0, bothHands, snapshot);
+    FW_EXPECT(snapshot.HeadLocation.pose.position.x == 11.0f);
+    FW_EXPECT(snapshot.AimLocation[0].pose.position.x == 12.0f);
+    FW_EXPECT(snapshot.AimLocation[1].pose.position.x == 13.0f);
+    FW_EXPECT(snapshot.GripLocation[0].pose.position.x == 14.0f);
+    FW_EXPECT(snapshot.GripLocation[1].pose.position.x == 15.0f);
+    FW_EXPECT(snapshot.IndexTrigger[0] == 0.25f && snapshot.IndexTrigger[1] == 0.75f);
+    FW_EXPECT(snapshot.GripTrigger[0] == 0.0f && snapshot.GripTrigger[1] == 0.5f);
+    FW_EXPECT(snapshot.Joystick[0].x == 0.125f && snapshot.Joystick[0].y == -0.125f);
+    FW_EXPECT(snapshot.Joystick[1].x == 0.0f);
+    FW_EXPECT(!snapshot.ThumbstickClick[0] && snapshot.ThumbstickClick[1]);
+    FW_EXPECT(!snapshot.ButtonA && snapshot.ButtonB && snapshot.TriggerTouch);
+
+    // the actions of an unbound hand are left at rest and its spaces unlocated
+    const bool leftHand[] = {true, false};
+    ReadXrInputSnapshot(handles, 0, leftHand, snapshot);
+    FW_EXPECT(snapshot.IndexTrigger[0] == 0.25f && snapshot.IndexTrigger[1] == 0.0f);
+    FW_EXPECT(!snapshot.ThumbstickClick[1]);
+    FW_EXPECT(snapshot.AimLocation[1].type == XR_TYPE_SPACE_LOCATION);
+    FW_EXPECT(snapshot.AimLocation[1].locationFlags == 0);
+    FW_EXPECT(snapshot.ButtonB);
+
+    const bool noHand[] = {false, false};
+    ReadXrInputSnapshot(handles, 0, noHand, snapshot);
+    FW_EXPECT(!snapshot.ButtonB && !snapshot.TriggerTouch);
+    FW_EXPECT(snapshot.HeadLocation.locationFlags != 0);
+}
+
+static void TestInteractionProfiles() {
+    FakeXrReset();
+    const ovrXrInputHandles handles = MakeHandles();
+
+    XrPath profiles[2] = {XR_NULL_PATH, XR_NULL_PATH};
+    FakeXrSetInteractionProfile(RIGHT_HAND_PATH, TOUCH_PROFILE);
+    FW_EXPECT(QueryXrInteractionProfiles(handles, profiles));
+    FW_EXPECT(profiles[0] == XR_NULL_PATH && profiles[1] == TOUCH_PROFILE);
+    FW_EXPECT(FakeXrCount("xrGetCurrentInteractionProfile") == 2);
+    // only to log the profile that is set
+    FW_EXPECT(FakeXrCount("xrPathToString") == 1);
+
+    // a failed query keeps the last known profile
+    FakeXrSetInteractionProfileResult(XR_ERROR_SESSION_NOT_RUNNING);
+    FW_EXPECT(!QueryXrInteractionProfiles(handles, profiles));
+    FW_EXPECT(profiles[0] == XR_NULL_PATH && profiles[1] == TOUCH_PROFILE);
+}
+
+} // namespace OVRFW
+
+int main() {
+    OVRFW::TestCallsPerFrame();
+    OVRFW::TestSnapshot();
+    OVRFW::TestInteractionProfiles();
+    return FW_TEST_RESULT();
+}
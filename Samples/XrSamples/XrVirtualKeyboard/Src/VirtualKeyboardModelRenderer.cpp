@@ -322,11 +322,9 @@ void VirtualKeyboardModelRenderer::SetAnimationState(int animationIndex, float f
     }
 
     ApplyAnimation(*keyboardModelState_, animationIndex);
+    keyboardModelState_->UpdateTransforms();
 
     for (const OVRFW::ModelAnimationChannel& channel : animation.channels) {
-        OVRFW::ModelNodeState& nodeState = keyboardModelState_->nodeStates[channel.nodeIndex];
-        nodeState.RecalculateMatrix();
-
         // If animation controls weights, cache the node index so we can update the surface geo once
         // all the weights are applied
         if (channel.path == OVRFW::MODEL_ANIMATION_PATH_WEIGHTS) {